@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 37
+#define CINDEX_VERSION_MINOR 45
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -1228,7 +1228,29 @@ enum CXTranslationUnit_Flags {
    * purposes of an IDE, this is undesirable behavior and as much information
    * as possible should be reported. Use this flag to enable this behavior.
    */
-  CXTranslationUnit_KeepGoing = 0x200
+  CXTranslationUnit_KeepGoing = 0x200,
+
+  /**
+   * \brief Keep the precompiled preamble in memory.
+   *
+   * By default, the precompiled preamble (see
+   * \c CXTranslationUnit_PrecompiledPreamble) is written to a temporary file
+   * and read back from there. With this flag it is kept in memory instead, so
+   * that building and using it never touches the disk, at the cost of holding
+   * the whole preamble in memory for the lifetime of the translation unit.
+   */
+  CXTranslationUnit_StorePreamblesInMemory = 0x400,
+
+  /**
+   * \brief Only record the macro expansions and inclusion directives of the
+   * main file in the detailed preprocessing record.
+   *
+   * This implies \c CXTranslationUnit_DetailedPreprocessingRecord. The macro
+   * definitions of all files are still recorded, so that the macro expansions
+   * of the main file can refer to them, but the expansions in headers, which
+   * dominate the record in macro-heavy code, are dropped.
+   */
+  CXTranslationUnit_DetailedPreprocessingRecordMainFileOnly = 0x800
 };
 
 /**
@@ -1505,12 +1527,14 @@ enum CXTUResourceUsageKind {
   CXTUResourceUsage_PreprocessingRecord = 12,
   CXTUResourceUsage_SourceManager_DataStructures = 13,
   CXTUResourceUsage_Preprocessor_HeaderSearch = 14,
+  CXTUResourceUsage_StoredDiagnostics = 15,
+  CXTUResourceUsage_GlobalCompletionResultsIndex = 16,
   CXTUResourceUsage_MEMORY_IN_BYTES_BEGIN = CXTUResourceUsage_AST,
   CXTUResourceUsage_MEMORY_IN_BYTES_END =
-    CXTUResourceUsage_Preprocessor_HeaderSearch,
+    CXTUResourceUsage_GlobalCompletionResultsIndex,
 
   CXTUResourceUsage_First = CXTUResourceUsage_AST,
-  CXTUResourceUsage_Last = CXTUResourceUsage_Preprocessor_HeaderSearch
+  CXTUResourceUsage_Last = CXTUResourceUsage_GlobalCompletionResultsIndex
 };
 
 /**
@@ -1552,6 +1576,38 @@ CINDEX_LINKAGE CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU
 
 CINDEX_LINKAGE void clang_disposeCXTUResourceUsage(CXTUResourceUsage usage);
 
+/**
+ * \brief Flags that control clang_trimTranslationUnitMemory().
+ */
+enum CXTrimMemory_Flags {
+  /**
+   * \brief Only release the state which is rebuilt by the next reparse
+   * without changing any result, such as the cached global code-completion
+   * results.
+   */
+  CXTrimMemory_None = 0x0,
+
+  /**
+   * \brief Also release the diagnostics of the translation unit. Until the
+   * next reparse, it reports no diagnostics, and the diagnostics previously
+   * retrieved from it are invalidated.
+   */
+  CXTrimMemory_Diagnostics = 0x1
+};
+
+/**
+ * \brief Release the memory a translation unit only keeps to speed up later
+ * requests, for translation units which are kept alive but rarely used.
+ *
+ * The translation unit stays usable and can be reparsed.
+ *
+ * \param options a bitwise OR of \c CXTrimMemory_Flags.
+ *
+ * \returns an estimate of the number of bytes released.
+ */
+CINDEX_LINKAGE unsigned long
+clang_trimTranslationUnitMemory(CXTranslationUnit TU, unsigned options);
+
 /**
  * @}
  */
@@ -3772,6 +3828,75 @@ CINDEX_LINKAGE unsigned clang_visitChildrenWithBlock(CXCursor parent,
 #  endif
 #endif
 
+/**
+ * \brief A compact description of a cursor, as produced by
+ * clang_visitChildrenBatched().
+ */
+typedef struct {
+  enum CXCursorKind kind;
+
+  /**
+   * \brief The index of the record of the parent cursor, or ~0U for the
+   * children of the cursor the traversal started from.
+   */
+  unsigned parent;
+
+  /**
+   * \brief The index of the first record with the same USR, or ~0U if the
+   * cursor has no USR or USRs were not requested.
+   */
+  unsigned usr;
+
+  /**
+   * \brief The file containing the start of the cursor's extent, or NULL.
+   */
+  CXFile file;
+
+  /**
+   * \brief The file offsets of the start and the end of the cursor's extent.
+   */
+  unsigned start_offset;
+  unsigned end_offset;
+} CXCursorRecord;
+
+/**
+ * \brief Flags that control clang_visitChildrenBatched().
+ */
+enum CXCursorRecord_Flags {
+  CXCursorRecord_None = 0x0,
+
+  /**
+   * \brief Compute the USR of every cursor, to fill \c CXCursorRecord::usr.
+   */
+  CXCursorRecord_IncludeUSRs = 0x1
+};
+
+/**
+ * \brief Describe all the descendants of a cursor in one call.
+ *
+ * The subtree of \p parent is traversed like clang_visitChildren() does with
+ * a visitor which always returns \c CXChildVisit_Recurse, and a record is
+ * stored for every cursor found, in traversal order. This avoids a callback
+ * per cursor, which dominates the traversal for clients in other languages.
+ *
+ * \param records an array of \p num_records records to fill.
+ *
+ * \param cursors if not NULL, an array of \p num_records cursors which
+ * receives the cursor of each record, e.g. to query the records of interest
+ * further.
+ *
+ * \param options a bitwise OR of \c CXCursorRecord_Flags.
+ *
+ * \returns the number of cursors in the subtree. When it is greater than
+ * \p num_records, only the first \p num_records records were stored and the
+ * call can be repeated with a larger array.
+ */
+CINDEX_LINKAGE unsigned clang_visitChildrenBatched(CXCursor parent,
+                                                   CXCursorRecord *records,
+                                                   CXCursor *cursors,
+                                                   unsigned num_records,
+                                                   unsigned options);
+
 /**
  * @}
  */
@@ -4459,6 +4584,65 @@ CINDEX_LINKAGE void clang_annotateTokens(CXTranslationUnit TU,
 CINDEX_LINKAGE void clang_disposeTokens(CXTranslationUnit TU,
                                         CXToken *Tokens, unsigned NumTokens);
 
+/**
+ * \brief A token with the semantic information needed to highlight it, as
+ * produced by clang_getSemanticTokens().
+ */
+typedef struct {
+  CXTokenKind token_kind;
+
+  /**
+   * \brief The kind of the cursor clang_annotateTokens() would provide for
+   * the token, or \c CXCursor_InvalidFile if there is none.
+   */
+  enum CXCursorKind cursor_kind;
+
+  /**
+   * \brief The kind of the cursor referenced by that cursor, as returned by
+   * clang_getCursorReferenced(), or \c CXCursor_InvalidFile if there is none.
+   */
+  enum CXCursorKind referenced_kind;
+
+  /**
+   * \brief The file offset and the length of the token.
+   */
+  unsigned offset;
+  unsigned length;
+} CXSemanticToken;
+
+/**
+ * \brief Tokenize and annotate the tokens of a range of a file in one call.
+ *
+ * This is equivalent to clang_tokenize(), clang_annotateTokens() and a call
+ * to clang_getCursorReferenced() for every annotated token, but it never
+ * creates a cursor for the client and only looks up the referenced entity
+ * once for a run of tokens with the same cursor.
+ *
+ * \param TU the translation unit containing \p file.
+ *
+ * \param begin_offset the offset at which lexing starts. It should not be
+ * inside a token.
+ *
+ * \param end_offset the offset past the range. As with clang_tokenize(),
+ * lexing continues as long as the previous token ends before it, so the last
+ * token may start after \p end_offset if whitespace precedes it.
+ *
+ * \param[out] tokens set to an array of the tokens, to be freed with
+ * clang_disposeSemanticTokens(), or NULL if there are none.
+ *
+ * \returns the number of tokens in \c *tokens.
+ */
+CINDEX_LINKAGE unsigned clang_getSemanticTokens(CXTranslationUnit TU,
+                                                CXFile file,
+                                                unsigned begin_offset,
+                                                unsigned end_offset,
+                                                CXSemanticToken **tokens);
+
+/**
+ * \brief Free the tokens returned by clang_getSemanticTokens().
+ */
+CINDEX_LINKAGE void clang_disposeSemanticTokens(CXSemanticToken *tokens);
+
 /**
  * @}
  */
@@ -4894,7 +5078,18 @@ enum CXCodeComplete_Flags {
    * \brief Whether to include brief documentation within the set of code
    * completions returned.
    */
-  CXCodeComplete_IncludeBriefComments = 0x04
+  CXCodeComplete_IncludeBriefComments = 0x04,
+
+  /**
+   * \brief Whether the completion location may follow a partially typed
+   * identifier, which the results are then filtered by.
+   *
+   * Completion happens at the start of the identifier, and only results whose
+   * names contain its characters in order, ignoring case and starting with
+   * its first character, are returned. This saves building the results that
+   * the client would filter out anyway.
+   */
+  CXCodeComplete_FilterByTypedPrefix = 0x08
 };
 
 /**
@@ -5939,7 +6134,18 @@ typedef enum {
    * indexing session associated with a \c CXIndexAction object.
    * Bodies in system headers are always skipped.
    */
-  CXIndexOpt_SkipParsedBodiesInSession = 0x10
+  CXIndexOpt_SkipParsedBodiesInSession = 0x10,
+
+  /**
+   * \brief Skip the declarations of a header that was already indexed during
+   * an indexing session associated with a \c CXIndexAction object, by a
+   * translation unit with the same predefined and command line macros.
+   *
+   * Only headers guarded against multiple inclusion are skipped. Headers
+   * whose declarations depend on macros defined by the files including them
+   * should not be indexed with this option.
+   */
+  CXIndexOpt_SkipIndexedFilesInSession = 0x20
 
 } CXIndexOptFlags;
 
@@ -5993,6 +6199,48 @@ CINDEX_LINKAGE int clang_indexSourceFileFullArgv(
     int num_command_line_args, struct CXUnsavedFile *unsaved_files,
     unsigned num_unsaved_files, CXTranslationUnit *out_TU, unsigned TU_options);
 
+/**
+ * \brief A source file to index with #clang_indexSourceFiles.
+ *
+ * The fields have the same meaning as the corresponding parameters of
+ * #clang_indexSourceFileFullArgv.
+ */
+typedef struct {
+  const char *source_filename;
+  const char *const *command_line_args;
+  int num_command_line_args;
+  struct CXUnsavedFile *unsaved_files;
+  unsigned num_unsaved_files;
+} CXIndexSourceFile;
+
+/**
+ * \brief Index a batch of source files on \p num_threads threads.
+ *
+ * Every source file is indexed as if by #clang_indexSourceFileFullArgv,
+ * without producing a translation unit. The translation units of the batch
+ * share the state of the \c CXIndexAction, such as the bodies skipped by
+ * \c CXIndexOpt_SkipParsedBodiesInSession, and the results of the file
+ * system lookups they make, so the file system must not change while the
+ * batch is being indexed.
+ *
+ * \param client_data an array of \p num_threads client data pointers. The
+ * callbacks invoked on the i-th indexing thread receive \c client_data[i], so
+ * a client can keep separate state per thread and needs no locking of its
+ * own. The callbacks of one source file all run on the same thread.
+ *
+ * \param[out] results if not \c NULL, an array of \p num_source_files
+ * elements receiving what #clang_indexSourceFileFullArgv would have returned
+ * for each source file.
+ *
+ * \returns 0 if the batch was indexed, or a non-zero \c CXErrorCode if the
+ * arguments are invalid.
+ */
+CINDEX_LINKAGE int clang_indexSourceFiles(
+    CXIndexAction, CXClientData *client_data, unsigned num_threads,
+    IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
+    unsigned index_options, const CXIndexSourceFile *source_files,
+    unsigned num_source_files, unsigned TU_options, int *results);
+
 /**
  * \brief Index the given translation unit via callbacks implemented through
  * #IndexerCallbacks.
@@ -208,6 +208,22 @@ class ASTContext : public RefCountedBase<ASTContext> {
   /// interface.
   llvm::DenseMap<const ObjCMethodDecl*,const ObjCMethodDecl*> ObjCMethodRedecls;
 
+  /// \brief The key of a cached Objective-C method lookup: the class
+  /// definition, whether an instance method is looked up, and the selector.
+  typedef std::pair<llvm::PointerIntPair<const ObjCInterfaceDecl *, 1, bool>,
+                    Selector> ObjCMethodLookupKey;
+
+  /// \brief The results of ObjCInterfaceDecl::lookupMethod.
+  llvm::DenseMap<ObjCMethodLookupKey, ObjCMethodDecl *> ObjCMethodLookups;
+
+  /// \brief Incremented whenever the methods visible through an Objective-C
+  /// class may have changed.
+  unsigned ObjCMethodLookupGeneration = 0;
+
+  /// \brief The generations of this context and of the external source at
+  /// which \c ObjCMethodLookups was valid.
+  std::pair<unsigned, uint32_t> ObjCMethodLookupsGeneration;
+
   /// \brief Mapping from __block VarDecls to their copy initialization expr.
   llvm::DenseMap<const VarDecl*, Expr*> BlockVarCopyInits;
     
@@ -222,6 +238,15 @@ class ASTContext : public RefCountedBase<ASTContext> {
   llvm::DenseMap<const MaterializeTemporaryExpr *, APValue *>
     MaterializedTemporaryValues;
 
+  /// \brief The results of constexpr function calls remembered by the
+  /// constant evaluator, keyed by the callee and its argument values.
+  llvm::StringMap<APValue> MemoizedConstexprCalls;
+
+  /// \brief The number of constexpr function calls whose result was found
+  /// in, or was missing from, MemoizedConstexprCalls.
+  unsigned NumMemoizedConstexprCallHits = 0;
+  unsigned NumMemoizedConstexprCallMisses = 0;
+
   /// \brief Representation of a "canonical" template template parameter that
   /// is used in canonical template names.
   class CanonicalTemplateTemplateParm : public llvm::FoldingSetNode {
@@ -500,6 +525,11 @@ private:
   const TargetInfo *Target;
   const TargetInfo *AuxTarget;
   clang::PrintingPolicy PrintingPolicy;
+
+  /// \brief Long type names printed with \c PrintingPolicy, keyed by the
+  /// type and the limit on nested template argument lists.
+  mutable llvm::DenseMap<std::pair<void *, unsigned>, std::string>
+    PrintedTypeNames;
   
 public:
   IdentifierTable &Idents;
@@ -597,13 +627,40 @@ public:
 
   DynTypedNodeList getParents(const ast_type_traits::DynTypedNode &Node);
 
+  /// \brief Limit the nodes getParents() knows about to those within
+  /// \p TopLevelDecls.
+  ///
+  /// The parent map is then computed by traversing only these declarations,
+  /// which is much cheaper than traversing the whole translation unit when
+  /// only the parents of nodes in, for example, the main file are needed.
+  /// Nodes outside the traversal scope have no parents, and neither do the
+  /// declarations in \p TopLevelDecls themselves. An empty scope means the
+  /// whole translation unit. Any parent map already computed is discarded.
+  void setTraversalScope(const std::vector<Decl *> &TopLevelDecls);
+
+  /// \brief Get the declarations the parent map is computed over, or an empty
+  /// list if it covers the whole translation unit.
+  const std::vector<Decl *> &getTraversalScope() const {
+    return TraversalScope;
+  }
+
   const clang::PrintingPolicy &getPrintingPolicy() const {
     return PrintingPolicy;
   }
 
   void setPrintingPolicy(const clang::PrintingPolicy &Policy) {
     PrintingPolicy = Policy;
+    PrintedTypeNames.clear();
   }
+
+  /// \brief Print \p T with the printing policy of this context, showing at
+  /// most \p TemplateArgDepth nested template argument lists (zero for no
+  /// limit).
+  ///
+  /// Diagnostics print the same types over and over again, so long names are
+  /// remembered.
+  std::string getPrintedTypeName(QualType T,
+                                 unsigned TemplateArgDepth = 0) const;
   
   SourceManager& getSourceManager() { return SourceMgr; }
   const SourceManager& getSourceManager() const { return SourceMgr; }
@@ -2438,6 +2495,21 @@ public:
   void setObjCMethodRedeclaration(const ObjCMethodDecl *MD,
                                   const ObjCMethodDecl *Redecl);
 
+  /// \brief Note that a method, category, protocol or superclass has been
+  /// added to an Objective-C class or protocol, or has become visible, which
+  /// invalidates the cached method lookups.
+  void invalidateObjCMethodLookups() { ++ObjCMethodLookupGeneration; }
+
+  /// \brief Retrieve the cached result of looking up \p Sel in the class
+  /// \p ID and its superclasses.  Returns false if it is not cached.
+  bool getCachedObjCMethodLookup(const ObjCInterfaceDecl *ID, Selector Sel,
+                                 bool IsInstance, ObjCMethodDecl *&Method);
+
+  /// \brief Cache the result of looking up \p Sel in the class \p ID and its
+  /// superclasses.
+  void setCachedObjCMethodLookup(const ObjCInterfaceDecl *ID, Selector Sel,
+                                 bool IsInstance, ObjCMethodDecl *Method);
+
   /// \brief Returns the Objective-C interface that \p ND belongs to if it is
   /// an Objective-C method/property/ivar etc. that is part of an interface,
   /// otherwise returns null.
@@ -2528,6 +2600,16 @@ public:
   APValue *getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
                                          bool MayCreate);
 
+  /// \brief Get the remembered result of a constexpr function call, given
+  /// the key the constant evaluator computed for it, or null if there is
+  /// none.
+  const APValue *getMemoizedConstexprCall(StringRef Key);
+
+  /// \brief Remember the result of a constexpr function call.
+  void setMemoizedConstexprCall(StringRef Key, const APValue &Result) {
+    MemoizedConstexprCalls[Key] = Result;
+  }
+
   //===--------------------------------------------------------------------===//
   //                    Statistics
   //===--------------------------------------------------------------------===//
@@ -2654,12 +2736,21 @@ private:
   friend class DeclContext;
   friend class DeclarationNameTable;
 
+  /// \brief The number of lookups into small declaration contexts which were
+  /// answered by scanning their declarations, without building a lookup
+  /// table.
+  unsigned NumLinearScanLookups = 0;
+
   void ReleaseDeclContextMaps();
   void ReleaseParentMapEntries();
 
   std::unique_ptr<ParentMapPointers> PointerParents;
   std::unique_ptr<ParentMapOtherNodes> OtherParents;
 
+  /// \brief The declarations the parent map is computed over; see
+  /// setTraversalScope().
+  std::vector<Decl *> TraversalScope;
+
   std::unique_ptr<VTableContextBase> VTContext;
 
 public:
@@ -19,6 +19,7 @@
 #include "clang/Basic/Specifiers.h"
 #include "clang/Basic/VersionTuple.h"
 #include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Support/Compiler.h"
@@ -894,6 +895,12 @@ public:
   static void EnableStatistics();
   static void PrintStats();
 
+  /// \brief Calls \p Callback with the name, the count and the size of each
+  /// kind of declaration created since statistics were enabled.
+  static void
+  forEachKindStat(llvm::function_ref<void(StringRef Name, unsigned Count,
+                                          size_t Size)> Callback);
+
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
   bool isTemplateParameter() const;
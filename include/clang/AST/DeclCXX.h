@@ -458,12 +458,19 @@ class CXXRecordDecl : public RecordDecl {
     /// \brief Whether we are currently parsing base specifiers.
     unsigned IsParsingBaseSpecifiers : 1;
 
+    /// \brief Whether ODRHash has been computed (or read from an AST file).
+    unsigned HasODRHash : 1;
+
     /// \brief The number of base class specifiers in Bases.
     unsigned NumBases;
 
     /// \brief The number of virtual base class specifiers in VBases.
     unsigned NumVBases;
 
+    /// \brief A hash of the members and bases of this class, used to detect
+    /// differing definitions when merging them from AST files.
+    unsigned ODRHash;
+
     /// \brief Base classes of this class.
     ///
     /// FIXME: This is wasted space for a union.
@@ -1657,6 +1664,14 @@ public:
   /// actually abstract.
   bool mayBeAbstract() const;
 
+  /// \brief Retrieve a hash of the bases and the explicitly-declared members
+  /// of this class definition, computed on first use.
+  ///
+  /// The hash depends only on the spelling of the definition, not on the
+  /// order in which it was processed, so identical definitions of a class
+  /// from different modules produce the same hash.
+  unsigned getODRHash() const;
+
   /// \brief If this is the closure type of a lambda expression, retrieve the
   /// number to be used for name mangling in the Itanium C++ ABI.
   ///
@@ -1401,9 +1401,7 @@ public:
   /// setProtocolList - Set the list of protocols that this interface
   /// implements.
   void setProtocolList(ObjCProtocolDecl *const* List, unsigned Num,
-                       const SourceLocation *Locs, ASTContext &C) {
-    data().ReferencedProtocols.set(List, Num, Locs, C);
-  }
+                       const SourceLocation *Locs, ASTContext &C);
 
   /// mergeClassExtensionProtocolList - Merge class extension's protocol list
   /// into the protocol list for this class.
@@ -1496,9 +1494,7 @@ public:
   // does not include any type arguments that apply to the superclass.
   ObjCInterfaceDecl *getSuperClass() const;
 
-  void setSuperClass(TypeSourceInfo *superClass) { 
-    data().SuperClassTInfo = superClass;
-  }
+  void setSuperClass(TypeSourceInfo *superClass);
 
   /// \brief Iterator that walks over the list of categories, filtering out
   /// those that do not meet specific criteria.
@@ -1702,9 +1698,7 @@ public:
 
   /// \brief Set the raw pointer to the start of the category/extension
   /// list.
-  void setCategoryListRaw(ObjCCategoryDecl *category) {
-    data().CategoryList = category;
-  }
+  void setCategoryListRaw(ObjCCategoryDecl *category);
 
   ObjCPropertyDecl
     *FindPropertyVisibleInPrimaryClass(IdentifierInfo *PropertyId,
@@ -2071,10 +2065,7 @@ public:
   /// setProtocolList - Set the list of protocols that this interface
   /// implements.
   void setProtocolList(ObjCProtocolDecl *const*List, unsigned Num,
-                       const SourceLocation *Locs, ASTContext &C) {
-    assert(hasDefinition() && "Protocol is not defined");
-    data().ReferencedProtocols.set(List, Num, Locs, C);
-  }
+                       const SourceLocation *Locs, ASTContext &C);
 
   ObjCProtocolDecl *lookupProtocolNamed(IdentifierInfo *PName);
 
@@ -2237,9 +2228,7 @@ public:
   /// setProtocolList - Set the list of protocols that this interface
   /// implements.
   void setProtocolList(ObjCProtocolDecl *const*List, unsigned Num,
-                       const SourceLocation *Locs, ASTContext &C) {
-    ReferencedProtocols.set(List, Num, Locs, C);
-  }
+                       const SourceLocation *Locs, ASTContext &C);
 
   const ObjCProtocolList &getReferencedProtocols() const {
     return ReferencedProtocols;
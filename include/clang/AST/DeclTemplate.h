@@ -18,6 +18,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/Redeclarable.h"
 #include "clang/AST/TemplateBase.h"
+#include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/TrailingObjects.h"
@@ -38,6 +39,59 @@ class TemplateTemplateParmDecl;
 class TypeAliasTemplateDecl;
 class VarTemplateDecl;
 class VarTemplatePartialSpecializationDecl;
+class FunctionTemplateSpecializationInfo;
+class ClassTemplateSpecializationDecl;
+
+/// \brief The number of bits of the hash of a specialization's template
+/// arguments that the specialization caches.
+const unsigned SpecializationProfileHashBits = 28;
+
+/// \brief Reduce the hash of a specialization's template arguments to the
+/// bits that the specialization caches.
+inline unsigned truncateSpecializationProfileHash(unsigned Hash) {
+  return Hash & ((1u << SpecializationProfileHashBits) - 1);
+}
+
+} // end namespace clang
+
+namespace llvm {
+/// \brief FoldingSet traits for template specializations, which cache the
+/// hash of their template arguments.
+///
+/// Looking up a specialization only profiles the template arguments of the
+/// specializations in its bucket whose hash matches, and growing the set
+/// needs no profiling at all. Since the set uses no more hash bits than are
+/// cached, placing a specialization by its truncated hash puts it in the
+/// same bucket as its full hash would.
+template <typename T>
+struct CachedHashSpecializationFoldingSetTrait : DefaultFoldingSetTrait<T> {
+  static bool Equals(T &X, const FoldingSetNodeID &ID, unsigned IDHash,
+                     FoldingSetNodeID &TempID) {
+    if (X.getProfileHash() != clang::truncateSpecializationProfileHash(IDHash))
+      return false;
+    X.Profile(TempID);
+    return TempID == ID;
+  }
+  static unsigned ComputeHash(T &X, FoldingSetNodeID &TempID) {
+    return X.getProfileHash();
+  }
+};
+
+template <>
+struct FoldingSetTrait<clang::FunctionTemplateSpecializationInfo>
+    : CachedHashSpecializationFoldingSetTrait<
+          clang::FunctionTemplateSpecializationInfo> {};
+template <>
+struct FoldingSetTrait<clang::ClassTemplateSpecializationDecl>
+    : CachedHashSpecializationFoldingSetTrait<
+          clang::ClassTemplateSpecializationDecl> {};
+template <>
+struct FoldingSetTrait<clang::ClassTemplatePartialSpecializationDecl>
+    : CachedHashSpecializationFoldingSetTrait<
+          clang::ClassTemplatePartialSpecializationDecl> {};
+} // end namespace llvm
+
+namespace clang {
 
 /// \brief Stores a template parameter of any kind.
 typedef llvm::PointerUnion3<TemplateTypeParmDecl*, NonTypeTemplateParmDecl*,
@@ -434,7 +488,7 @@ class FunctionTemplateSpecializationInfo : public llvm::FoldingSetNode {
     Template(Template, TSK - 1),
     TemplateArguments(TemplateArgs),
     TemplateArgumentsAsWritten(TemplateArgsAsWritten),
-    PointOfInstantiation(POI) { }
+    PointOfInstantiation(POI), HasProfileHash(false), ProfileHash(0) { }
 
 public:
   static FunctionTemplateSpecializationInfo *
@@ -465,6 +519,14 @@ public:
   /// first instantiated.
   SourceLocation PointOfInstantiation;
 
+private:
+  /// \brief Whether ProfileHash has been computed.
+  unsigned HasProfileHash : 1;
+
+  /// \brief The truncated hash of the profile of TemplateArguments.
+  unsigned ProfileHash : SpecializationProfileHashBits;
+
+public:
   /// \brief Retrieve the template from which this function was specialized.
   FunctionTemplateDecl *getTemplate() const { return Template.getPointer(); }
 
@@ -519,6 +581,10 @@ public:
     for (const TemplateArgument &TemplateArg : TemplateArgs)
       TemplateArg.Profile(ID, Context);
   }
+
+  /// \brief Retrieve the truncated hash of this specialization's profile,
+  /// computing it on first use.
+  unsigned getProfileHash();
 };
 
 /// \brief Provides information a specialization of a member of a class
@@ -1600,6 +1666,12 @@ class ClassTemplateSpecializationDecl
   /// Really a value of type TemplateSpecializationKind.
   unsigned SpecializationKind : 3;
 
+  /// \brief Whether ProfileHash has been computed.
+  mutable unsigned HasProfileHash : 1;
+
+  /// \brief The truncated hash of the profile of TemplateArgs.
+  mutable unsigned ProfileHash : SpecializationProfileHashBits;
+
 protected:
   ClassTemplateSpecializationDecl(ASTContext &Context, Kind DK, TagKind TK,
                                   DeclContext *DC, SourceLocation StartLoc,
@@ -1796,6 +1868,10 @@ public:
       TemplateArg.Profile(ID, Context);
   }
 
+  /// \brief Retrieve the truncated hash of this specialization's profile,
+  /// computing it on first use.
+  unsigned getProfileHash() const;
+
   static bool classof(const Decl *D) { return classofKind(D->getKind()); }
   static bool classofKind(Kind K) {
     return K >= firstClassTemplateSpecialization &&
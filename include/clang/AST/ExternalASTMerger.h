@@ -0,0 +1,86 @@
+//===--- ExternalASTMerger.h - Merging External AST Interface ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares the ExternalASTMerger, which vends a combination of
+//  ASTs from several different ASTContext/FileManager pairs
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_CLANG_AST_EXTERNALASTMERGER_H
+#define LLVM_CLANG_AST_EXTERNALASTMERGER_H
+
+#include "clang/AST/ASTImporter.h"
+#include "clang/AST/ExternalASTSource.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <memory>
+#include <vector>
+
+namespace clang {
+
+/// \brief An external AST source which imports declarations from several
+/// source ASTs into a target AST on demand.
+///
+/// Declarations are imported with minimal imports: a declaration context is
+/// created empty and is only populated when name lookup or iteration over
+/// its members reaches it, at which point the merger imports the matching
+/// declarations from every source the context came from.
+class ExternalASTMerger : public ExternalASTSource {
+public:
+  /// \brief An ASTContext and the FileManager its source locations refer to.
+  struct ImporterEndpoint {
+    ASTContext &AST;
+    FileManager &FM;
+  };
+
+  /// \brief Create a merger which imports from each of \p Sources into
+  /// \p Target.
+  ///
+  /// The translation unit of the target context must be marked as having
+  /// external visible storage for top-level lookups to reach the sources.
+  ExternalASTMerger(const ImporterEndpoint &Target,
+                    llvm::ArrayRef<ImporterEndpoint> Sources);
+  ~ExternalASTMerger() override;
+
+  bool FindExternalVisibleDeclsByName(const DeclContext *DC,
+                                      DeclarationName Name) override;
+
+  void
+  FindExternalLexicalDecls(const DeclContext *DC,
+                           llvm::function_ref<bool(Decl::Kind)> IsKindWeWant,
+                           SmallVectorImpl<Decl *> &Result) override;
+
+  using ExternalASTSource::CompleteType;
+
+  void CompleteType(TagDecl *Tag) override;
+
+private:
+  class LazyImporter;
+
+  /// \brief The importers into and out of one source context.
+  struct ImporterPair {
+    std::unique_ptr<ASTImporter> Forward;
+    std::unique_ptr<ASTImporter> Reverse;
+  };
+
+  std::vector<ImporterPair> Importers;
+
+  /// \brief A declaration context in a source AST, along with the index of
+  /// the importers for that source.
+  typedef std::pair<DeclContext *, unsigned> Origin;
+
+  /// \brief The contexts that each declaration context in the target AST was
+  /// imported from.
+  llvm::DenseMap<const DeclContext *, SmallVector<Origin, 1>> Origins;
+
+  void addOrigin(DeclContext *ToDC, DeclContext *FromDC, unsigned Source);
+};
+
+} // end namespace clang
+
+#endif
@@ -21,6 +21,7 @@
 namespace clang {
 
 class ASTConsumer;
+class ASTRecordLayout;
 class CXXBaseSpecifier;
 class CXXCtorInitializer;
 class DeclarationName;
@@ -84,6 +85,14 @@ public:
   /// The default implementation of this method is a no-op.
   virtual Decl *GetExternalDecl(uint32_t ID);
 
+  /// \brief Resolve each of the given declaration IDs into a declaration.
+  ///
+  /// This is the same as calling GetExternalDecl for each ID, but lets the
+  /// source load the declarations in whatever order is cheapest for it.
+  ///
+  /// The default implementation calls GetExternalDecl for each ID in turn.
+  virtual void PrefetchExternalDecls(ArrayRef<uint32_t> IDs);
+
   /// \brief Resolve a selector ID into a selector.
   ///
   /// This operation only needs to be implemented if the AST source
@@ -275,6 +284,17 @@ public:
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets);
 
+  /// \brief Load the complete layout of the given record type, as it was
+  /// computed when the external source was built, so that the record need
+  /// not be laid out again.
+  ///
+  /// Unlike layoutRecordType, which only provides offsets for the record
+  /// layout builder to follow, this is consulted before the builder runs.
+  ///
+  /// \returns the layout, allocated in the ASTContext, or null if the record
+  /// has to be laid out.
+  virtual const ASTRecordLayout *loadRecordLayout(const RecordDecl *Record);
+
   //===--------------------------------------------------------------------===//
   // Queries for performance analysis.
   //===--------------------------------------------------------------------===//
@@ -13,6 +13,7 @@
 #include "clang/Basic/CommentOptions.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang {
 
@@ -177,21 +178,42 @@ public:
   }
 };
 
-/// \brief This class represents all comments included in the translation unit,
-/// sorted in order of appearance in the translation unit.
+/// \brief This class represents all comments included in the translation unit.
+///
+/// Comments are kept per file, sorted by their offset in the file.  Adjacent
+/// documentation comments are only merged the first time the comments of a
+/// file are looked up, so no work is done for files without documented
+/// declarations.
 class RawCommentList {
 public:
   RawCommentList(SourceManager &SourceMgr) : SourceMgr(SourceMgr) {}
 
   void addComment(const RawComment &RC, llvm::BumpPtrAllocator &Allocator);
 
-  ArrayRef<RawComment *> getComments() const {
-    return Comments;
-  }
+  /// \brief Returns the comments in the given file, sorted by offset.
+  ArrayRef<RawComment *> getCommentsInFile(FileID File) const;
+
+  /// \brief Returns all of the comments, sorted in order of appearance in the
+  /// translation unit.
+  std::vector<RawComment *> getComments() const;
+
+  /// \brief Returns the comment which was added last, or null if there is
+  /// none.
+  const RawComment *getLastComment() const { return LastComment; }
 
 private:
+  struct FileComments {
+    std::vector<RawComment *> Comments;
+    /// \brief The number of comments at the front of \c Comments which have
+    /// already been merged with their neighbours.
+    unsigned NumMerged = 0;
+  };
+
   SourceManager &SourceMgr;
-  std::vector<RawComment *> Comments;
+  mutable llvm::DenseMap<FileID, FileComments> CommentsByFile;
+  mutable RawComment *LastComment = nullptr;
+
+  void mergeComments(FileComments &FC) const;
 
   void addDeserializedComments(ArrayRef<RawComment *> DeserializedComments);
 
@@ -20,6 +20,7 @@
 
 namespace clang {
   class ASTContext;
+  class ASTReader;
   class FieldDecl;
   class RecordDecl;
   class CXXRecordDecl;
@@ -131,6 +132,7 @@ private:
   CXXRecordLayoutInfo *CXXInfo;
 
   friend class ASTContext;
+  friend class ASTReader;
 
   ASTRecordLayout(const ASTContext &Ctx, CharUnits size, CharUnits alignment,
                   CharUnits requiredAlignment, CharUnits datasize,
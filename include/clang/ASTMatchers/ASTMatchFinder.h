@@ -45,6 +45,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
+#include <functional>
 
 namespace clang {
 
@@ -133,6 +134,39 @@ public:
     ///
     /// It prints a report after match.
     llvm::Optional<Profiling> CheckProfiling;
+
+    /// \brief Counters for the memoized results of traversal matchers like
+    /// \c has(), \c hasDescendant() and \c hasAncestor().
+    struct MemoizationStatistics {
+      MemoizationStatistics() : Hits(0), Misses(0), Evictions(0) {}
+
+      /// \brief Lookups answered from the cache.
+      unsigned Hits;
+      /// \brief Lookups that ran the matcher and stored its result.
+      unsigned Misses;
+      /// \brief Times the cache was emptied, because it grew too large or a
+      /// top-level declaration was done.
+      unsigned Evictions;
+    };
+
+    MatchFinderOptions() : MemoizationStats(nullptr) {}
+
+    /// \brief If set, the memoization counters of every match are added to
+    /// these.
+    MemoizationStatistics *MemoizationStats;
+
+    /// \brief If set, only the top-level declarations in the files this
+    /// returns true for are traversed and matched.
+    ///
+    /// Declarations are checked by the file of their expansion location, and
+    /// those in other files are skipped without being traversed. Those of an
+    /// external source, like a PCH, are only deserialized for the files that
+    /// are matched. While matching, the traversal scope of the \c ASTContext
+    /// is set to the matched declarations, so that the parent map only
+    /// covers them too; if it already has a traversal scope, that is
+    /// filtered instead. Typedefs in skipped files are not seen by
+    /// \c isDerivedFrom().
+    std::function<bool(const SourceManager &SM, FileID FID)> ShouldMatchFile;
   };
 
   MatchFinder(MatchFinderOptions Options = MatchFinderOptions());
@@ -190,6 +224,9 @@ public:
   /// @}
 
   /// \brief Finds all matches in the given AST.
+  ///
+  /// Only the declarations in the traversal scope of \p Context are
+  /// traversed, if it has one; see \c ASTContext::setTraversalScope().
   void matchAST(ASTContext &Context);
 
   /// \brief Registers a callback to notify the end of parsing.
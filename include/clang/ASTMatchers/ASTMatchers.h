@@ -2647,10 +2647,16 @@ AST_MATCHER_P(CallExpr, callee, internal::Matcher<Stmt>,
 ///   class Y { public: void x(); };
 ///   void z() { Y y; y.x(); }
 /// \endcode
-AST_MATCHER_P_OVERLOAD(CallExpr, callee, internal::Matcher<Decl>, InnerMatcher,
-                       1) {
-  return callExpr(hasDeclaration(InnerMatcher)).matches(Node, Finder, Builder);
+///
+/// Spelled out rather than defined with AST_MATCHER_P_OVERLOAD so that the
+/// \c hasDeclaration() matcher is built once, and \c MatchFinder can see the
+/// name guard of \p InnerMatcher through it.
+inline internal::Matcher<CallExpr>
+callee(const internal::Matcher<Decl> &InnerMatcher) {
+  return hasDeclaration(InnerMatcher);
 }
+typedef internal::Matcher<CallExpr> (&callee_Type1)(
+    const internal::Matcher<Decl> &InnerMatcher);
 
 /// \brief Matches if the expression's or declaration's type matches a type
 /// matcher.
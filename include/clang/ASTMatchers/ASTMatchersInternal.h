@@ -48,6 +48,7 @@
 #include "clang/AST/Type.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ManagedStatic.h"
 #include <map>
@@ -152,6 +153,9 @@ public:
   bool operator<(const BoundNodesMap &Other) const {
     return NodeMap < Other.NodeMap;
   }
+  bool operator==(const BoundNodesMap &Other) const {
+    return NodeMap == Other.NodeMap;
+  }
 
   /// \brief A map from IDs to the bound nodes.
   ///
@@ -223,6 +227,15 @@ public:
   bool operator<(const BoundNodesTreeBuilder &Other) const {
     return Bindings < Other.Bindings;
   }
+  bool operator==(const BoundNodesTreeBuilder &Other) const {
+    return Bindings == Other.Bindings;
+  }
+
+  /// \brief Returns a hash of the bindings that is consistent with
+  /// \c operator==.
+  ///
+  /// Only valid if \c isComparable().
+  unsigned getHashValue() const;
 
   /// \brief Returns \c true if this \c BoundNodesTreeBuilder can be compared,
   /// i.e. all stored node maps have memoization data.
@@ -240,6 +253,32 @@ private:
 
 class ASTMatchFinder;
 
+/// \brief A necessary condition on the name of a declaration for a matcher
+/// to match.
+///
+/// Lets \c MatchFinder skip all top-level matchers whose guard rules out the
+/// current node after a single hash lookup of its name, instead of running
+/// each of them.
+struct NameGuard {
+  enum GuardSource {
+    /// \brief The name of the matched \c NamedDecl itself.
+    NS_Decl,
+    /// \brief The name of the callee declaration of the matched \c CallExpr.
+    NS_CalleeDecl
+  };
+
+  GuardSource Source;
+
+  /// \brief The names the declaration may have, as returned by
+  /// \c getNodeName().
+  std::vector<std::string> Names;
+};
+
+/// \brief Returns the unqualified name of \p Node as \c hasName() sees it.
+///
+/// \p Scratch is used as storage for names that need to be printed.
+StringRef getNodeName(const NamedDecl &Node, llvm::SmallString<128> &Scratch);
+
 /// \brief Generic interface for all matchers.
 ///
 /// Used by the implementation of Matcher<T> and DynTypedMatcher.
@@ -257,6 +296,10 @@ public:
   virtual bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// \brief Returns true and sets \p Guard if this matcher can only match
+  /// nodes whose name satisfies \p Guard.
+  virtual bool getNameGuard(NameGuard &Guard) const { return false; }
 };
 
 /// \brief Generic interface for matchers on an AST node of type T.
@@ -370,6 +413,12 @@ public:
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const;
 
+  /// \brief Returns true and sets \p Guard if this matcher can only match
+  /// nodes whose name satisfies \p Guard.
+  bool getNameGuard(NameGuard &Guard) const {
+    return Implementation->getNameGuard(Guard);
+  }
+
   /// \brief Bind the specified \p ID to the matcher.
   /// \return A new matcher with the \p ID bound to it if this matcher supports
   ///   binding. Otherwise, returns an empty \c Optional<>.
@@ -673,13 +722,48 @@ private:
 /// \brief Matches named declarations with a specific name.
 ///
 /// See \c hasName() and \c hasAnyName() in ASTMatchers.h for details.
-class HasNameMatcher : public SingleNodeMatcherInterface<NamedDecl> {
+class HasNameMatcher : public MatcherInterface<NamedDecl> {
  public:
   explicit HasNameMatcher(std::vector<std::string> Names);
 
-  bool matchesNode(const NamedDecl &Node) const override;
+  /// \brief The patterns of the matcher resolved to the identifiers of one
+  /// AST, so that they can be matched by comparing \c IdentifierInfo
+  /// pointers instead of strings.
+  struct ResolvedNames {
+    struct Pattern {
+      /// \brief The parts of the pattern, innermost first.
+      SmallVector<IdentifierInfo *, 4> Parts;
+      bool IsFullyQualified;
+    };
+
+    /// \brief False if some pattern is not a plain qualified identifier, in
+    /// which case the patterns are matched as strings.
+    bool AllResolved;
+    std::vector<Pattern> Patterns;
+  };
+
+  /// \brief Resolves the patterns of this matcher in \p Context.
+  ResolvedNames resolveNames(ASTContext &Context) const;
+
+  /// \brief Returns an ID that is unique to this matcher, unlike its
+  /// address, which may be reused after it is destroyed.
+  uint64_t getID() const { return ID; }
+
+  bool matches(const NamedDecl &Node, ASTMatchFinder *Finder,
+               BoundNodesTreeBuilder *Builder) const override;
+
+  bool matchesNode(const NamedDecl &Node) const;
+
+  bool getNameGuard(NameGuard &Guard) const override;
 
  private:
+  /// \brief Match routine on patterns resolved to identifiers.
+  ///
+  /// Equivalent to matchesNodeFullFast(), but only compares pointers. Only
+  /// works for nodes that have an identifier.
+  bool matchesNodeResolved(const NamedDecl &Node,
+                           const ResolvedNames &Resolved) const;
+
   /// \brief Unqualified match routine.
   ///
   /// It is much faster than the full match, but it only works for unqualified
@@ -703,6 +787,7 @@ class HasNameMatcher : public SingleNodeMatcherInterface<NamedDecl> {
 
   const bool UseUnqualifiedMatch;
   const std::vector<std::string> Names;
+  const uint64_t ID;
 };
 
 /// \brief Trampoline function to use VariadicFunction<> to construct a
@@ -727,6 +812,17 @@ public:
     return matchesSpecialized(Node, Finder, Builder);
   }
 
+  bool getNameGuard(NameGuard &Guard) const override {
+    // The declaration of a call is its callee, so a guard on the name of the
+    // declaration is one on the name of the callee.
+    if (!std::is_same<T, CallExpr>::value ||
+        !this->InnerMatcher.getNameGuard(Guard) ||
+        Guard.Source != NameGuard::NS_Decl)
+      return false;
+    Guard.Source = NameGuard::NS_CalleeDecl;
+    return true;
+  }
+
 private:
   /// \brief If getDecl exists as a member of U, returns whether the inner
   /// matcher matches Node.getDecl().
@@ -943,6 +1039,13 @@ public:
 
   virtual ASTContext &getASTContext() const = 0;
 
+  /// \brief Returns the patterns of \p Matcher resolved in the AST that is
+  /// being matched, or null if they are to be matched as strings.
+  virtual const HasNameMatcher::ResolvedNames *
+  getResolvedNames(const HasNameMatcher &Matcher) {
+    return nullptr;
+  }
+
 protected:
   virtual bool matchesChildOf(const ast_type_traits::DynTypedNode &Node,
                               const DynTypedMatcher &Matcher,
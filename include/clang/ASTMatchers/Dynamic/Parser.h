@@ -40,7 +40,9 @@
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include <mutex>
 
 namespace clang {
 namespace ast_matchers {
@@ -250,6 +252,43 @@ private:
   std::vector<MatcherCompletion> Completions;
 };
 
+/// \brief A cache of the matchers parsed from matcher expressions.
+///
+/// Matchers are immutable, so a matcher expression that was parsed once
+/// does not need to be parsed, nor its overloads resolved, again. Expressions
+/// that only differ in whitespace share an entry. Expressions are parsed with
+/// the default registry, and only those without errors are cached.
+///
+/// The cache can be used from several threads at once.
+class MatcherExpressionCache {
+public:
+  /// \param NamedValues The named values to parse expressions with, see
+  ///   \c Parser::parseMatcherExpression(). If null, there are none. They
+  ///   must outlive the cache and not change.
+  explicit MatcherExpressionCache(
+      const Parser::NamedValueMap *NamedValues = nullptr)
+      : NamedValues(NamedValues) {}
+
+  /// \brief Returns the matcher of \p MatcherCode, parsing it if it is not
+  /// in the cache.
+  ///
+  /// \return The matcher, or an empty Optional if \p MatcherCode has an
+  ///   error. In that case, \c Error will contain a description of the error.
+  llvm::Optional<DynTypedMatcher> parse(StringRef MatcherCode,
+                                        Diagnostics *Error);
+
+  /// \brief Returns the number of cached matchers.
+  size_t size() const;
+
+  /// \brief Drops all cached matchers.
+  void clear();
+
+private:
+  const Parser::NamedValueMap *const NamedValues;
+  mutable std::mutex Mutex;
+  llvm::StringMap<DynTypedMatcher> Matchers;
+};
+
 }  // namespace dynamic
 }  // namespace ast_matchers
 }  // namespace clang
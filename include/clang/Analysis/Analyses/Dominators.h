@@ -46,6 +46,10 @@ public:
 
   ~DominatorTree() override { delete DT; }
 
+  static const void *getTag();
+
+  static DominatorTree *create(AnalysisDeclContext &Ctx);
+
   llvm::DominatorTreeBase<CFGBlock>& getBase() { return *DT; }
 
   /// \brief This method returns the root CFGBlock of the dominators tree.
@@ -20,6 +20,10 @@
 #define LLVM_CLANG_ANALYSIS_ANALYSES_FORMATSTRING_H
 
 #include "clang/AST/CanonicalType.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace clang {
 
@@ -684,6 +688,55 @@ bool ParsePrintfString(FormatStringHandler &H,
                        const char *beg, const char *end, const LangOptions &LO,
                        const TargetInfo &Target, bool isFreeBSDKPrintf);
 
+/// A printf format string parsed once, whose specifiers can then be handed
+/// to any number of handlers without parsing the string again.
+///
+/// Only the strings for which parsing reports nothing but the specifiers
+/// themselves can be replayed; the others have to be parsed again with the
+/// handler, to report their problems at the location of every use.
+class ParsedPrintfString {
+public:
+  ParsedPrintfString(StringRef FormatStr, const LangOptions &LO,
+                     const TargetInfo &Target, bool isFreeBSDKPrintf);
+  ParsedPrintfString(const ParsedPrintfString &) = delete;
+  ParsedPrintfString &operator=(const ParsedPrintfString &) = delete;
+
+  bool isReplayable() const { return Replayable; }
+
+  /// The copy of the format string the specifiers point into, which is what
+  /// the handlers given to replay must take as the start of the string.
+  const char *getBegin() const { return Str.data(); }
+
+  /// Hand the specifiers to \p H, as ParsePrintfString would. Returns true
+  /// if \p H stopped the processing of the string.
+  bool replay(FormatStringHandler &H) const;
+
+private:
+  struct Specifier {
+    analyze_printf::PrintfSpecifier FS;
+    unsigned Start;
+    unsigned Length;
+  };
+
+  std::string Str;
+  std::vector<Specifier> Specifiers;
+  bool Replayable;
+};
+
+/// The printf format strings parsed so far in a translation unit, by their
+/// contents.
+class PrintfStringCache {
+public:
+  /// Return the parsed format string \p Str, only parsing it the first time.
+  const ParsedPrintfString &get(StringRef Str, const LangOptions &LO,
+                                const TargetInfo &Target,
+                                bool isFreeBSDKPrintf);
+
+private:
+  /// The parsed strings, by whether they are FreeBSD kernel format strings.
+  llvm::StringMap<std::unique_ptr<ParsedPrintfString>> Strings[2];
+};
+
 bool ParseFormatStringHasSArg(const char *beg, const char *end,
                               const LangOptions &LO, const TargetInfo &Target);
 
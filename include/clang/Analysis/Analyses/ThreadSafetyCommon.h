@@ -368,6 +368,11 @@ public:
   til::SCFG *getCFG() { return Scfg; }
 
 private:
+  CapabilityExpr translateAttrExprAtDecl(const Expr *AttrExp,
+                                         const NamedDecl *D,
+                                         const Expr *DeclExp,
+                                         VarDecl *SelfD);
+
   til::SExpr *translateDeclRefExpr(const DeclRefExpr *DRE,
                                    CallingContext *Ctx) ;
   til::SExpr *translateCXXThisExpr(const CXXThisExpr *TE, CallingContext *Ctx);
@@ -402,6 +407,12 @@ private:
   // Map from clang local variables to indices in a LVarDefinitionMap.
   typedef llvm::DenseMap<const ValueDecl *, unsigned> LVarIndexMap;
 
+  // Map from an attribute expression, the decl it is attached to, the
+  // expression involving that decl and the self decl, to its translation.
+  typedef std::pair<std::pair<const Expr *, const NamedDecl *>,
+                    std::pair<const Expr *, const VarDecl *>> AttrExprKey;
+  typedef llvm::DenseMap<AttrExprKey, CapabilityExpr> AttrExprMap;
+
   // Map from local variable indices to SSA variables (or constants).
   typedef std::pair<const ValueDecl *, til::SExpr *> NameVarPair;
   typedef CopyOnWriteVector<NameVarPair> LVarDefinitionMap;
@@ -464,6 +475,7 @@ private:
   til::SCFG *Scfg;
   StatementMap SMap;                       // Map from Stmt to TIL Variables
   LVarIndexMap LVarIdxMap;                 // Indices of clang local vars.
+  AttrExprMap AttrExprCache;               // Translated attribute exprs.
   std::vector<til::BasicBlock *> BlockMap; // Map from clang to til BBs.
   std::vector<BlockInfo> BBInfo;           // Extra information per BB.
                                            // Indexed by clang BlockID.
@@ -192,21 +192,22 @@ public:
 
   /// Return the specified analysis object, lazily running the analysis if
   /// necessary.  Return NULL if the analysis could not run.
+  ///
+  /// The analysis objects are shared by all the clients of the context.
   template <typename T>
   T *getAnalysis() {
-    const void *tag = T::getTag();
-    ManagedAnalysis *&data = getAnalysisImpl(tag);
-    if (!data) {
-      data = T::create(*this);
-    }
-    return static_cast<T*>(data);
+    return static_cast<T *>(getAnalysisImpl(
+        T::getTag(), [](AnalysisDeclContext &Ctx) -> ManagedAnalysis * {
+          return T::create(Ctx);
+        }));
   }
 
   /// Returns true if the root namespace of the given declaration is the 'std'
   /// C++ namespace.
   static bool isInStdNamespace(const Decl *D);
 private:
-  ManagedAnalysis *&getAnalysisImpl(const void* tag);
+  typedef ManagedAnalysis *(*AnalysisCreator)(AnalysisDeclContext &);
+  ManagedAnalysis *getAnalysisImpl(const void *Tag, AnalysisCreator Create);
 
   LocationContextManager &getLocationContextManager();
 };
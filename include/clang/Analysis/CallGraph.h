@@ -22,6 +22,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 
 namespace clang {
 class CallGraphNode;
@@ -31,6 +32,11 @@ class CallGraphNode;
 /// The call graph extends itself with the given declarations by implementing
 /// the recursive AST visitor, which constructs the graph by visiting the given
 /// declarations.
+///
+/// The graph can be built incrementally, e.g. from
+/// ASTConsumer::HandleTopLevelDecl: every body is only walked once, and the
+/// calls to functions which are not defined yet get their edges once the
+/// definitions are added.
 class CallGraph : public RecursiveASTVisitor<CallGraph> {
   friend class CallGraphNode;
 
@@ -43,6 +49,15 @@ class CallGraph : public RecursiveASTVisitor<CallGraph> {
   /// This is a virtual root node that has edges to all the functions.
   CallGraphNode *Root;
 
+  /// The declarations whose callees have been added already, by the
+  /// declaration their node is keyed by.
+  llvm::SmallPtrSet<const Decl *, 32> DeclsWithCallees;
+
+  /// The callers of the declarations which had no body when they were called,
+  /// by the canonical declaration.
+  llvm::DenseMap<const Decl *, SmallVector<CallGraphNode *, 2>>
+      DeferredCallers;
+
 public:
   CallGraph();
   ~CallGraph();
@@ -65,6 +80,10 @@ public:
   /// one into the graph.
   CallGraphNode *getOrInsertNode(Decl *);
 
+  /// \brief Add an edge from \p Caller to the node of \p Callee, or, if
+  /// \p Callee has no body yet, once it gets one.
+  void addCall(CallGraphNode *Caller, Decl *Callee);
+
   /// Iterators through all the elements in the graph. Note, this gives
   /// non-deterministic order.
   typedef FunctionMapTy::iterator iterator;
@@ -127,6 +146,11 @@ private:
   /// \brief Add the given declaration to the call graph.
   void addNodeForDecl(Decl *D, bool IsGlobal);
 
+  /// \brief Returns the declaration the node of \p D is keyed by.
+  static const Decl *getNodeKey(const Decl *D) {
+    return D && !isa<ObjCMethodDecl>(D) ? D->getCanonicalDecl() : D;
+  }
+
   /// \brief Allocate a new node in the graph.
   CallGraphNode *allocateNewNode(Decl *);
 };
@@ -278,6 +278,18 @@ public:
   void findSuspiciousClones(std::vector<SuspiciousClonePair> &Result,
                             unsigned MinGroupComplexity);
 
+  /// \brief Writes an index of the provided statements, which can be merged
+  ///        with the indexes of other translation units to search for clones
+  ///        across all of them.
+  ///
+  /// Every StmtSequence with at least \p MinComplexity gets a line with the
+  /// tab-separated hash code, complexity, file and start and end line:column
+  /// of the sequence, followed by the comma-separated hash codes of its parts
+  /// (the statements of a sequence, or the children of a single statement).
+  /// The parts describe sequences which differ only in some of them, so that
+  /// near-miss clones can be found too.
+  void exportIndex(llvm::raw_ostream &OS, unsigned MinComplexity) const;
+
 private:
   /// Stores all encountered StmtSequences alongside their CloneSignature.
   std::vector<std::pair<CloneSignature, StmtSequence>> Sequences;
@@ -17,6 +17,8 @@
 #define LLVM_CLANG_BASIC_BUILTINS_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
 #include <cstring>
 
 // VC++ defines 'alloca' as an object-like macro, which interferes with our
@@ -67,6 +69,9 @@ class Context {
   llvm::ArrayRef<Info> TSRecords;
   llvm::ArrayRef<Info> AuxTSRecords;
 
+  /// \brief The IDs of the builtins supported by the language, by name.
+  llvm::DenseMap<StringRef, unsigned> BuiltinIDs;
+
 public:
   Context() {}
 
@@ -75,10 +80,31 @@ public:
   void InitializeTarget(const TargetInfo &Target, const TargetInfo *AuxTarget);
 
   /// \brief Mark the identifiers for all the builtins with their
-  /// appropriate builtin ID # and mark any non-portable builtin identifiers as
-  /// such.
+  /// appropriate builtin ID #.
+  ///
+  /// The identifiers already in \p Table are marked right away, and the
+  /// others only once the table creates them, so that the thousands of
+  /// builtins which are never referenced cost no identifiers.
   void initializeBuiltins(IdentifierTable &Table, const LangOptions& LangOpts);
 
+  /// \brief Like initializeBuiltins, but leave the identifiers already in
+  /// \p Table alone, since they come from an AST file which records whether
+  /// they are builtins.
+  void initializeBuiltinsForAST(IdentifierTable &Table,
+                                const LangOptions &LangOpts);
+
+  /// \brief Return the builtin ID # of the builtin called \p Name if it is
+  /// supported by the language, or 0.
+  unsigned getBuiltinID(StringRef Name) const {
+    return BuiltinIDs.lookup(Name);
+  }
+
+  /// \brief The builtins supported by the language, by name, whether or not
+  /// they have an identifier yet.
+  const llvm::DenseMap<StringRef, unsigned> &getSupportedBuiltins() const {
+    return BuiltinIDs;
+  }
+
   /// \brief Return the identifier name for the specified builtin,
   /// e.g. "__builtin_abs".
   const char *getName(unsigned ID) const {
@@ -191,6 +191,8 @@ private:
   unsigned ErrorLimit;           // Cap of # errors emitted, 0 -> no limit.
   unsigned TemplateBacktraceLimit; // Cap on depth of template backtrace stack,
                                    // 0 -> no limit.
+  unsigned TemplateArgDepth;     // Cap on nesting of template argument lists
+                                 // in printed types, 0 -> no limit.
   unsigned ConstexprBacktraceLimit; // Cap on depth of constexpr evaluation
                                     // backtrace stack, 0 -> no limit.
   diag::Severity ExtBehavior;       // Map extensions to warnings or errors?
@@ -286,6 +288,76 @@ private:
   /// the given source location.
   DiagStatePointsTy::iterator GetDiagStatePointForLoc(SourceLocation Loc) const;
 
+  /// \brief The DiagStatePoints that affect one FileID, keyed by offset.
+  ///
+  /// A point in the file itself is keyed by twice its offset, and a point in
+  /// a file included from it by twice the offset of the #include plus one, so
+  /// that the latter only applies after the #include.  Keys and point indices
+  /// both grow with the position in the translation unit.
+  struct FileDiagStatePoints {
+    std::vector<std::pair<uint64_t, unsigned>> Points;
+
+    /// \brief The index of the point active at the start of the file;
+    /// computed on first use.
+    int EntryPoint;
+
+    FileDiagStatePoints() : EntryPoint(UnknownEntryPoint) {}
+
+    enum { UnknownEntryPoint = -1, NoEntryPoint = -2 };
+  };
+
+  /// \brief An index of DiagStatePoints by FileID, so that the point for a
+  /// location can be found by comparing offsets instead of locations.
+  ///
+  /// It is extended lazily with the points added since the last lookup, and
+  /// dropped when a point is inserted in the middle of DiagStatePoints.
+  mutable llvm::DenseMap<FileID, FileDiagStatePoints> DiagStatePointsByFile;
+
+  /// \brief The number of DiagStatePoints in \c DiagStatePointsByFile.
+  mutable unsigned NumIndexedDiagStatePoints;
+
+  /// \brief Set when a point is not part of the main file's inclusion tree;
+  /// lookups then compare whole locations.
+  mutable bool DiagStatePointIndexUnusable;
+
+  /// \brief The range of keys in a file, between two of its DiagStatePoints,
+  /// in which the last lookup landed.
+  ///
+  /// Consecutive queries, such as the \c isIgnored() check and the report of
+  /// the same diagnostic, usually fall into the same range.
+  struct DiagStatePointBucket {
+    FileID FID;
+    uint64_t BeginKey;
+    uint64_t EndKey;
+    unsigned Point;
+  };
+  mutable DiagStatePointBucket LastDiagStatePointBucket;
+
+  /// \brief Drops the index of DiagStatePoints by FileID.
+  void invalidateDiagStatePointIndex() const {
+    DiagStatePointsByFile.clear();
+    NumIndexedDiagStatePoints = 0;
+    DiagStatePointIndexUnusable = false;
+    LastDiagStatePointBucket.FID = FileID();
+  }
+
+  /// \brief Adds the DiagStatePoints pushed since the last lookup to
+  /// \c DiagStatePointsByFile.
+  void updateDiagStatePointIndex() const;
+
+  /// \brief Returns the index of the DiagStatePoint active at the start of
+  /// \p FID, or \c FileDiagStatePoints::NoEntryPoint if \p FID is not in the
+  /// inclusion tree of the main file.
+  int getDiagStatePointAtFileEntry(FileID FID) const;
+
+  /// \brief Returns the index of the last DiagStatePoint with a key up to
+  /// \p Key in \p FID, or -1 if the file has none.
+  ///
+  /// \param Bucket If non-null, receives the range of keys in \p FID around
+  /// \p Key that have the same result.
+  int findDiagStatePointInFile(FileID FID, uint64_t Key,
+                               DiagStatePointBucket *Bucket = nullptr) const;
+
   /// \brief Sticky flag set to \c true when an error is emitted.
   bool ErrorOccurred;
 
@@ -312,6 +384,7 @@ private:
 
   unsigned NumWarnings;         ///< Number of warnings reported
   unsigned NumErrors;           ///< Number of errors reported
+  unsigned NumIgnored;          ///< Number of diagnostics built but ignored
 
   /// \brief A function pointer that converts an opaque diagnostic
   /// argument to a strings.
@@ -390,7 +463,10 @@ public:
     assert(SourceMgr && "SourceManager not set!");
     return *SourceMgr;
   }
-  void setSourceManager(SourceManager *SrcMgr) { SourceMgr = SrcMgr; }
+  void setSourceManager(SourceManager *SrcMgr) {
+    SourceMgr = SrcMgr;
+    invalidateDiagStatePointIndex();
+  }
 
   //===--------------------------------------------------------------------===//
   //  DiagnosticsEngine characterization methods, used by a client to customize
@@ -432,6 +508,14 @@ public:
     return TemplateBacktraceLimit;
   }
 
+  /// \brief Specify the maximum number of nested template argument
+  /// lists to print in the name of a type.
+  void setTemplateArgDepth(unsigned Depth) { TemplateArgDepth = Depth; }
+
+  /// \brief Retrieve the maximum number of nested template argument
+  /// lists to print in the name of a type.
+  unsigned getTemplateArgDepth() const { return TemplateArgDepth; }
+
   /// \brief Specify the maximum number of constexpr evaluation
   /// notes to emit along with a given diagnostic.
   void setConstexprBacktraceLimit(unsigned Limit) {
@@ -602,6 +686,13 @@ public:
   
   unsigned getNumWarnings() const { return NumWarnings; }
 
+  /// \brief Returns the number of diagnostics that were built and then
+  /// dropped because they were ignored.
+  ///
+  /// A diagnostic that is often ignored is worth guarding with
+  /// \c isIgnored() before its arguments are computed.
+  unsigned getNumIgnored() const { return NumIgnored; }
+
   void setNumWarnings(unsigned NumWarnings) {
     this->NumWarnings = NumWarnings;
   }
@@ -28,7 +28,9 @@
 #include <ctime>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <string>
+#include <tuple>
 
 namespace llvm {
 
@@ -106,6 +108,37 @@ public:
 
 struct FileData;
 
+/// \brief The contents of the files read by several FileManagers, e.g. those
+/// of the translation units of an indexing session.
+///
+/// Files are identified by their unique ID, modification time and size, so a
+/// file changed since another FileManager read it is read again. A buffer is
+/// freed once no FileManager's client uses it any more. It may be used from
+/// several threads.
+class SharedFileContents {
+  typedef std::tuple<uint64_t, uint64_t, time_t, off_t> Key;
+
+  std::mutex Mutex;
+  std::map<Key, std::weak_ptr<llvm::MemoryBuffer>> Buffers;
+  /// The number of buffers at which to drop the entries of freed ones.
+  size_t NextSweep = 64;
+
+  static Key getKey(const FileEntry &Entry);
+
+public:
+  /// \brief Whether the contents of \p Entry can be shared.
+  static bool canShare(const FileEntry &Entry);
+
+  /// \brief Retrieve a buffer with the shared contents of \p Entry, or null
+  /// if no FileManager read them.
+  std::unique_ptr<llvm::MemoryBuffer> lookup(const FileEntry &Entry);
+
+  /// \brief Share \p Contents, which were just read from \p Entry, and
+  /// return a buffer with them.
+  std::unique_ptr<llvm::MemoryBuffer>
+  insert(const FileEntry &Entry, std::unique_ptr<llvm::MemoryBuffer> Contents);
+};
+
 /// \brief Implements support for file system lookup, file system caching,
 /// and directory search management.
 ///
@@ -171,6 +204,11 @@ class FileManager : public RefCountedBase<FileManager> {
   /// or a directory) as virtual directories.
   void addAncestorsAsVirtualDirs(StringRef Path);
 
+  /// Read the contents of \p Entry from the file system.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  readBufferForFile(const FileEntry *Entry, bool isVolatile,
+                    bool ShouldCloseOpenFile);
+
 public:
   FileManager(const FileSystemOptions &FileSystemOpts,
               IntrusiveRefCntPtr<vfs::FileSystem> FS = nullptr);
@@ -222,6 +260,9 @@ public:
   FileSystemOptions &getFileSystemOpts() { return FileSystemOpts; }
   const FileSystemOptions &getFileSystemOpts() const { return FileSystemOpts; }
 
+  /// \brief Whether any file was added with \c getVirtualFile.
+  bool hasVirtualFiles() const { return !VirtualFileEntries.empty(); }
+
   IntrusiveRefCntPtr<vfs::FileSystem> getVirtualFileSystem() const {
     return FS;
   }
@@ -15,16 +15,31 @@
 #ifndef LLVM_CLANG_BASIC_FILESYSTEMOPTIONS_H
 #define LLVM_CLANG_BASIC_FILESYSTEMOPTIONS_H
 
+#include <memory>
 #include <string>
 
 namespace clang {
 
+class SharedFileContents;
+
 /// \brief Keeps track of options that affect how file operations are performed.
 class FileSystemOptions {
 public:
   /// \brief If set, paths are resolved as if the working directory was
   /// set to the value of WorkingDir.
   std::string WorkingDir;
+
+  /// \brief If set, the path to a persistent cache of files which are known
+  /// not to exist, consulted before going to the file system.
+  std::string StatCacheFile;
+
+  /// \brief Whether to write the files found missing by this compilation
+  /// back to StatCacheFile.
+  bool UpdateStatCache = false;
+
+  /// \brief If set, the contents of the files read by a FileManager are
+  /// shared with the other FileManagers using the same object.
+  std::shared_ptr<SharedFileContents> SharedContents;
 };
 
 } // end namespace clang
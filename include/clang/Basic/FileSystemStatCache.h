@@ -16,10 +16,16 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Mutex.h"
 #include <memory>
 
+namespace llvm {
+class MemoryBuffer;
+}
+
 namespace clang {
 
 namespace vfs {
@@ -126,6 +132,118 @@ public:
                        vfs::FileSystem &FS) override;
 };
 
+/// \brief A stat cache backed by a memory-mapped file listing paths which are
+/// known not to exist, written by an earlier compilation or by a build server.
+///
+/// Every entry is stamped with the modification time its parent directory had
+/// when the entry was recorded. Creating a file changes the modification time
+/// of its directory, so an entry is trusted only while its parent directory is
+/// unchanged. Each directory is checked at most once per cache instance, which
+/// turns a failed lookup in every header search path into one 'stat' per
+/// directory. Lookups of paths which exist are always forwarded to the next
+/// cache in the chain.
+class PersistentStatCache : public FileSystemStatCache {
+public:
+  class OnDiskTable;
+
+private:
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<OnDiskTable> Table;
+
+  /// \brief Whether the entries for a directory can be trusted, by directory.
+  llvm::StringMap<bool> ValidDirectories;
+
+  PersistentStatCache(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                      std::unique_ptr<OnDiskTable> Table);
+
+public:
+  ~PersistentStatCache() override;
+
+  /// \brief Load the cache stored in \p Path.
+  ///
+  /// \returns null if the file cannot be read or has an incompatible format.
+  static std::unique_ptr<PersistentStatCache> create(StringRef Path);
+
+  /// \brief Call \p Visit with every path in the cache and the directory
+  /// stamp it was recorded with.
+  void forEachEntry(
+      llvm::function_ref<void(StringRef Path, uint64_t DirStamp)> Visit) const;
+
+  LookupResult getStat(StringRef Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+
+  /// \brief Compute the stamp identifying the current state of \p Dir.
+  static uint64_t getDirectoryStamp(StringRef Dir, vfs::FileSystem &FS);
+};
+
+/// \brief A stat "cache" which records the absolute paths that did not exist
+/// during the compilation, so they can be written out for use by a
+/// \c PersistentStatCache.
+class PersistentStatCacheWriter : public FileSystemStatCache {
+  /// \brief The directory stamp of each missing path.
+  llvm::StringMap<uint64_t> MissingPaths;
+
+  /// \brief The stamp of each directory containing a missing path.
+  llvm::StringMap<uint64_t> DirectoryStamps;
+
+public:
+  /// \brief Add the entries of \p Cache which are still valid according to
+  /// \p FS, so that a cache file can be updated instead of being replaced.
+  void addValidEntries(const PersistentStatCache &Cache, vfs::FileSystem &FS);
+
+  LookupResult getStat(StringRef Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+
+  /// \brief Write the recorded entries to \p Path.
+  ///
+  /// The file is written to a temporary file first and then renamed, so that
+  /// concurrent readers never observe a partially written cache.
+  ///
+  /// \returns true if an error occurred.
+  bool write(StringRef Path) const;
+};
+
+/// \brief The results of the 'stat' calls on absolute paths made by the
+/// FileManagers of several translation units, which may run on different
+/// threads at once.
+///
+/// Each FileManager still has its own FileEntry and DirectoryEntry objects,
+/// and reaches the shared results through its own \c SharedStatCache. The
+/// results are only valid for FileManagers with the same view of the file
+/// system for absolute paths.
+class SharedStatResults {
+  llvm::sys::Mutex Mux;
+  llvm::StringMap<std::pair<bool, FileData>> Entries;
+
+public:
+  SharedStatResults() : Mux(/*recursive=*/false) {}
+
+  /// \brief Retrieve the result recorded for \p Path.
+  ///
+  /// \returns false if there is none.
+  bool lookup(StringRef Path, bool &Exists, FileData &Data);
+
+  /// \brief Record the result of a 'stat' call on \p Path, unless another
+  /// thread already did.
+  void insert(StringRef Path, bool Exists, const FileData &Data);
+};
+
+/// \brief The stat cache of a single FileManager, forwarding lookups of
+/// absolute paths to the \c SharedStatResults it shares with others.
+class SharedStatCache : public FileSystemStatCache {
+  std::shared_ptr<SharedStatResults> Results;
+
+public:
+  explicit SharedStatCache(std::shared_ptr<SharedStatResults> Results)
+      : Results(std::move(Results)) {}
+
+  LookupResult getStat(StringRef Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
 } // end namespace clang
 
 #endif
@@ -0,0 +1,46 @@
+//===--- FileUtilities.h - Writing Files Shared Between Jobs ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Helpers for the caches, indexes and summaries which concurrent
+/// compilations and analyses read and write in a shared directory.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_FILEUTILITIES_H
+#define LLVM_CLANG_BASIC_FILEUTILITIES_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <system_error>
+
+namespace clang {
+
+/// \brief Writes \p Contents to \p Path through a uniquely named temporary
+/// file which is then renamed into place, so that concurrent readers see
+/// either the old or the new file, never a partially written one.
+///
+/// The temporary file is removed if anything fails.
+std::error_code writeFileAtomically(StringRef Path, StringRef Contents);
+
+/// \brief Returns the name "<Name>-<Hash><Extension>", for a file in a shared
+/// directory whose name must identify its key or its contents.
+std::string getHashedFileName(StringRef Name, StringRef Hash,
+                              StringRef Extension = StringRef());
+
+/// \brief Returns the name of the file in a shared directory for the
+/// translation unit whose main file is \p MainFile: its file name followed by
+/// a hash of the whole path, so that main files with the same name in
+/// different directories get different files.
+std::string getMainFileHashedName(StringRef MainFile, StringRef Extension);
+
+} // end namespace clang
+
+#endif
@@ -45,6 +45,10 @@ namespace clang {
   class MultiKeywordSelector; // private class used by Selector
   class DeclarationName;      // AST class that stores declaration names
 
+  namespace Builtin {
+  class Context;
+  }
+
   /// \brief A simple pair of identifier info and location.
   typedef std::pair<IdentifierInfo*, SourceLocation> IdentifierLocPair;
 
@@ -458,6 +462,13 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief The builtins whose identifiers are marked with their builtin ID
+  /// as they are created, if any.
+  const Builtin::Context *BuiltinInfo;
+
+  /// \brief Mark \p II with its builtin ID, if it names a builtin.
+  void markBuiltin(IdentifierInfo &II);
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -473,6 +484,9 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Set the builtins to mark the identifiers of as they are created.
+  void setBuiltinInfo(const Builtin::Context *Info) { BuiltinInfo = Info; }
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -489,8 +503,13 @@ public:
     // No entry; if we have an external lookup, look there first.
     if (ExternalLookup) {
       II = ExternalLookup->get(Name);
-      if (II)
+      if (II) {
+        // Identifiers from an AST file already know whether they are
+        // builtins.
+        if (BuiltinInfo && !II->isFromAST())
+          markBuiltin(*II);
         return *II;
+      }
     }
 
     // Lookups failed, make a new IdentifierInfo.
@@ -501,6 +520,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (BuiltinInfo)
+      markBuiltin(*II);
+
     return *II;
   }
 
@@ -532,6 +554,11 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    // Identifiers from a module don't record their builtin ID; those from a
+    // precompiled header overwrite it when they do.
+    if (BuiltinInfo)
+      markBuiltin(*II);
+
     // If this is the 'import' contextual keyword, mark it as such.
     if (Name.equals("import"))
       II->setModulesImport(true);
@@ -17,6 +17,8 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/SpecialCaseList.h"
 #include <memory>
@@ -27,6 +29,12 @@ class SanitizerBlacklist {
   std::unique_ptr<llvm::SpecialCaseList> SCL;
   SourceManager &SM;
 
+  /// \brief Whether the file of each FileID is blacklisted, by category.
+  ///
+  /// Every function and global in a file asks about the same file name, and
+  /// each question runs the regular expressions of the whole "src" section.
+  mutable llvm::StringMap<llvm::DenseMap<FileID, bool>> BlacklistedFileIDs;
+
 public:
   SanitizerBlacklist(const std::vector<std::string> &BlacklistPaths,
                      SourceManager &SM);
@@ -37,6 +45,8 @@ public:
   bool isBlacklistedFunction(StringRef FunctionName) const;
   bool isBlacklistedFile(StringRef FileName,
                          StringRef Category = StringRef()) const;
+  bool isBlacklistedFileID(FileID FID,
+                           StringRef Category = StringRef()) const;
   bool isBlacklistedLocation(SourceLocation Loc,
                              StringRef Category = StringRef()) const;
 };
@@ -118,13 +118,15 @@ namespace SrcMgr {
 
     /// \brief A bump pointer allocated array of offsets for each source line.
     ///
-    /// This is lazily computed.  This is owned by the SourceManager
-    /// BumpPointerAllocator object.
+    /// This is lazily computed, and only as far into the buffer as line
+    /// numbers have been asked for, unless SourceLineCacheComplete is set.
+    /// This is owned by the SourceManager BumpPointerAllocator object.
     unsigned *SourceLineCache;
 
     /// \brief The number of lines in this ContentCache.
     ///
-    /// This is only valid if SourceLineCache is non-null.
+    /// This is only valid if SourceLineCache is non-null, and is the number
+    /// of lines found so far unless SourceLineCacheComplete is set.
     unsigned NumLines;
 
     /// \brief Indicates whether the buffer itself was provided to override
@@ -143,19 +145,25 @@ namespace SrcMgr {
     /// after serialization and deserialization.
     unsigned IsTransient : 1;
 
+    /// \brief True if SourceLineCache holds the offsets of every line in the
+    /// buffer.
+    unsigned SourceLineCacheComplete : 1;
+
     ContentCache(const FileEntry *Ent = nullptr) : ContentCache(Ent, Ent) {}
 
     ContentCache(const FileEntry *Ent, const FileEntry *contentEnt)
       : Buffer(nullptr, false), OrigEntry(Ent), ContentsEntry(contentEnt),
         SourceLineCache(nullptr), NumLines(0), BufferOverridden(false),
-        IsSystemFile(false), IsTransient(false) {}
+        IsSystemFile(false), IsTransient(false),
+        SourceLineCacheComplete(false) {}
     
     /// The copy ctor does not allow copies where source object has either
     /// a non-NULL Buffer or SourceLineCache.  Ownership of allocated memory
     /// is not transferred, so this is a logical error.
     ContentCache(const ContentCache &RHS)
       : Buffer(nullptr, false), SourceLineCache(nullptr),
-        BufferOverridden(false), IsSystemFile(false), IsTransient(false) {
+        BufferOverridden(false), IsSystemFile(false), IsTransient(false),
+        SourceLineCacheComplete(false) {
       OrigEntry = RHS.OrigEntry;
       ContentsEntry = RHS.ContentsEntry;
 
@@ -633,6 +641,15 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// starts at 2^31.
   static const unsigned MaxLoadedOffset = 1U << 31U;
 
+  /// \brief The first SLocEntry offset and LoadedSLocEntryTable index of each
+  /// batch of loaded SLocEntries, in allocation order.
+  ///
+  /// Batches are allocated downwards from MaxLoadedOffset, so the offsets
+  /// decrease and the indices increase. Each batch usually corresponds to one
+  /// module or PCH, and getFileIDLoaded first finds the batch containing an
+  /// offset so that it only probes (and thus loads) entries from that batch.
+  SmallVector<std::pair<unsigned, unsigned>, 0> LoadedSLocEntryAllocations;
+
   /// \brief A bitmap that indicates whether the entries of LoadedSLocEntryTable
   /// have already been loaded from the external source.
   ///
@@ -668,6 +685,7 @@ class SourceManager : public RefCountedBase<SourceManager> {
 
   // Statistics for -print-stats.
   mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLastFileIDHits, NumLastFileIDMisses;
 
   /// \brief Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -692,6 +710,50 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// for isBeforeInTranslationUnit.
   InBeforeInTUCacheEntry &getInBeforeInTUCache(FileID LFID, FileID RFID) const;
 
+  /// \brief A local file entry in the preorder numbering of the \#include
+  /// tree.
+  struct IncludeTreeNode {
+    /// \brief The ordinal of the including file, or ~0U for a root.
+    unsigned Parent;
+    /// \brief The ordinal of the root of the tree this file is in.
+    unsigned Root;
+    /// \brief The offset of the \#include in the parent.
+    unsigned IncludeOffset;
+    /// \brief One past the ordinal of the last file in this file's subtree,
+    /// or ~0U while files may still be added to it.
+    unsigned Exit;
+    /// \brief For a root, the most recently numbered file of its tree.
+    unsigned Deepest;
+    /// \brief The ordinals of the included files, in include order.
+    SmallVector<unsigned, 2> Children;
+  };
+
+  /// \brief The local file entries in preorder, i.e. in the order the files
+  /// were entered, which lets isBeforeInTranslationUnit order locations in
+  /// different files without walking their include stacks.
+  ///
+  /// Extended lazily up to the newest file queried. Files whose include
+  /// location would break the preorder (e.g. it lies in a loaded file, or
+  /// before the include of an earlier sibling) and their descendants are not
+  /// numbered; queries involving them take the slow path.
+  mutable std::vector<IncludeTreeNode> IncludeTree;
+
+  /// \brief The ordinal in \c IncludeTree of each local SLocEntry that was
+  /// scanned, or ~0U for expansions and files that were not numbered.
+  mutable std::vector<unsigned> IncludeTreeOrdinals;
+
+  /// \brief Returns the ordinal of the local file \p FID in \c IncludeTree,
+  /// or ~0U if it has none.
+  unsigned getIncludeTreeOrdinal(FileID FID) const;
+
+  /// \brief Orders \p LOffs and \p ROffs by the \#include tree.
+  ///
+  /// \returns false if the include tree can not order the locations, e.g.
+  /// because they are in the same file after leaving macro expansions.
+  bool isBeforeInIncludeTree(std::pair<FileID, unsigned> LOffs,
+                             std::pair<FileID, unsigned> ROffs,
+                             bool &Result) const;
+
   // Cache for the "fake" buffer used for error-recovery purposes.
   mutable std::unique_ptr<llvm::MemoryBuffer> FakeBufferForRecovery;
 
@@ -995,9 +1057,12 @@ public:
     unsigned SLocOffset = SpellingLoc.getOffset();
 
     // If our one-entry cache covers this offset, just return it.
-    if (isOffsetInFileID(LastFileIDLookup, SLocOffset))
+    if (isOffsetInFileID(LastFileIDLookup, SLocOffset)) {
+      ++NumLastFileIDHits;
       return LastFileIDLookup;
+    }
 
+    ++NumLastFileIDMisses;
     return getFileIDSlow(SLocOffset);
   }
 
@@ -1420,6 +1485,11 @@ public:
     return ContentCacheAlloc.getTotalMemory();
   }
 
+  /// \brief Return the allocator of the ContentCaches.
+  const llvm::BumpPtrAllocator &getContentCacheAllocator() const {
+    return ContentCacheAlloc;
+  }
+
   struct MemoryBufferSizes {
     const size_t malloc_bytes;
     const size_t mmap_bytes;
@@ -0,0 +1,96 @@
+//===--- TimeTrace.h - Trace of Compiler Phases -----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Records the time spent in scopes of the compiler, such as parsing
+/// an included file or instantiating a template, for -ftime-trace=.
+///
+/// The trace is written in the Chrome trace event format, which
+/// chrome://tracing and similar viewers display as a flame chart, followed by
+/// the total time spent in each kind of scope.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+
+class TimeTraceProfiler;
+
+/// \brief The trace being recorded, if any.
+///
+/// Traces are recorded by a single thread at a time.
+extern TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// \brief Starts recording a trace, which leaves out the scopes which took
+/// less than \p GranularityUS microseconds.
+void timeTraceProfilerInitialize(unsigned GranularityUS);
+
+/// \brief Stops recording the trace, and drops it.
+void timeTraceProfilerCleanup();
+
+/// \brief Returns whether a trace is being recorded.
+inline bool timeTraceProfilerEnabled() {
+  return TimeTraceProfilerInstance != nullptr;
+}
+
+/// \brief Writes the trace recorded so far to \p OS as JSON.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// \brief Calls \p Fn with the name of each kind of scope which ended so far,
+/// the number of times it was entered, and the total time spent in it in
+/// microseconds.
+void timeTraceProfilerForEachTotal(
+    llvm::function_ref<void(StringRef Name, unsigned Count,
+                            uint64_t DurationUS)> Fn);
+
+/// \brief Starts a scope of the kind \p Name. \p Detail names what it is
+/// about; it is called right away, so that callers only pay for it when a
+/// trace is being recorded.
+void timeTraceProfilerBegin(StringRef Name,
+                            llvm::function_ref<std::string()> Detail);
+
+/// \brief Ends the scope started last.
+void timeTraceProfilerEnd();
+
+/// \brief Records the lifetime of the object as a scope of the trace, if one
+/// is being recorded.
+class TimeTraceScope {
+  bool Active;
+
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  void operator=(const TimeTraceScope &) = delete;
+
+public:
+  explicit TimeTraceScope(StringRef Name) : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, [] { return std::string(); });
+  }
+
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail)
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+
+  ~TimeTraceScope() {
+    if (Active && timeTraceProfilerEnabled())
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace clang
+
+#endif
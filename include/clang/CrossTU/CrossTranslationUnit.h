@@ -0,0 +1,150 @@
+//===--- CrossTranslationUnit.h - Cross translation unit support *- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file provides an interface to load the definitions of
+/// functions from the ASTs of other translation units.
+///
+/// An index file maps the USR of each function definition to the AST file
+/// (as written by -emit-ast or -emit-pch) of the translation unit which
+/// defines it. Each line of the index holds a USR and a path, separated by a
+/// space; relative paths are relative to the directory of the index.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_CROSSTU_CROSSTRANSLATIONUNIT_H
+#define LLVM_CLANG_CROSSTU_CROSSTRANSLATIONUNIT_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
+#include <list>
+#include <memory>
+#include <string>
+
+namespace clang {
+class ASTContext;
+class ASTImporter;
+class ASTUnit;
+class CompilerInstance;
+class DeclContext;
+class FunctionDecl;
+class NamedDecl;
+
+namespace cross_tu {
+
+enum class index_error_code {
+  unspecified = 1,
+  missing_index_file,
+  invalid_index_format,
+  multiple_definitions,
+  missing_definition,
+  failed_import,
+  failed_to_get_external_ast,
+  failed_to_generate_usr
+};
+
+/// \brief An error in loading a definition from another translation unit.
+class IndexError : public llvm::ErrorInfo<IndexError> {
+public:
+  static char ID;
+  IndexError(index_error_code C) : Code(C), LineNo(0) {}
+  IndexError(index_error_code C, std::string FileName, int LineNo = 0)
+      : Code(C), FileName(std::move(FileName)), LineNo(LineNo) {}
+  void log(raw_ostream &OS) const override;
+  std::error_code convertToErrorCode() const override;
+  index_error_code getCode() const { return Code; }
+  int getLineNum() const { return LineNo; }
+  std::string getFileName() const { return FileName; }
+
+private:
+  index_error_code Code;
+  std::string FileName;
+  int LineNo;
+};
+
+/// \brief Parse the index file at \p IndexPath.
+///
+/// \returns a map from the USR of each function to the path of the AST
+/// file which defines it, with relative paths resolved against
+/// \p CrossTUDir.
+llvm::Expected<llvm::StringMap<std::string>>
+parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir);
+
+/// \brief Format \p Index as the contents of an index file.
+std::string createCrossTUIndexString(const llvm::StringMap<std::string> &Index);
+
+/// \brief Loads the definitions of functions from the ASTs of other
+/// translation units and imports them into the AST of the current one.
+///
+/// At most a fixed number of external ASTs are kept in memory; the least
+/// recently used one is released when another one needs to be loaded.
+/// Definitions which were already imported stay valid, because the importer
+/// copies everything they refer to into the current AST.
+class CrossTranslationUnitContext {
+public:
+  CrossTranslationUnitContext(CompilerInstance &CI, unsigned MaxLoadedTUs);
+  ~CrossTranslationUnitContext();
+
+  /// \brief Get the definition of \p FD from another translation unit, and
+  /// import it into the current AST.
+  ///
+  /// The index is read from \p IndexName in \p CrossTUDir the first time it
+  /// is needed.
+  ///
+  /// \returns the imported definition, or an error if the definition could
+  /// not be found or imported.
+  llvm::Expected<const FunctionDecl *>
+  getCrossTUDefinition(const FunctionDecl *FD, StringRef CrossTUDir,
+                       StringRef IndexName);
+
+  /// \brief Load the AST of the translation unit which defines the function
+  /// with the USR \p LookupName, according to the index.
+  llvm::Expected<ASTUnit *> loadExternalAST(StringRef LookupName,
+                                            StringRef CrossTUDir,
+                                            StringRef IndexName);
+
+  /// \brief Import the definition \p FD from \p Unit into the current AST.
+  llvm::Expected<const FunctionDecl *> importDefinition(const FunctionDecl *FD,
+                                                        ASTUnit *Unit);
+
+  /// \brief Get the name which identifies \p ND in the index, or an empty
+  /// string if it has none.
+  static std::string getLookupName(const NamedDecl *ND);
+
+private:
+  ASTImporter &getOrCreateASTImporter(ASTUnit *Unit);
+  const FunctionDecl *findFunctionInDeclContext(const DeclContext *DC,
+                                                StringRef LookupFnName);
+
+  CompilerInstance &CI;
+  ASTContext &Context;
+  unsigned MaxLoadedTUs;
+
+  /// The index, mapping the USRs of functions to AST files.
+  llvm::StringMap<std::string> FunctionFileMap;
+  /// The errors from the index files which could not be read.
+  llvm::StringMap<IndexError> IndexFileErrors;
+
+  typedef std::pair<std::string, std::unique_ptr<ASTUnit>> LoadedUnit;
+
+  /// The loaded external ASTs, most recently used first.
+  std::list<LoadedUnit> LoadedUnits;
+  llvm::StringMap<std::list<LoadedUnit>::iterator> FileASTUnitMap;
+  llvm::DenseMap<ASTUnit *, std::unique_ptr<ASTImporter>> ASTUnitImporterMap;
+
+  /// The definitions imported so far, by USR.
+  llvm::StringMap<const FunctionDecl *> ImportedFunctions;
+};
+
+} // end namespace cross_tu
+} // end namespace clang
+
+#endif
@@ -105,6 +105,43 @@ class Compilation {
   /// Whether we're compiling for diagnostic purposes.
   bool ForDiagnostics;
 
+  /// Returns how many of \p Jobs ExecuteJobs runs at a time.
+  unsigned getNumParallelJobs(const JobList &Jobs) const;
+
+  /// Whether \p C can be run through the driver's CC1Runner hook.
+  bool canRunWithCC1Runner(const Command &C) const;
+
+  /// Whether \p C can be run through the compile cache.
+  bool canRunWithCompileCache(const Command &C) const;
+
+  /// Print the command line of \p C if -v or CC_PRINT_OPTIONS asked for it.
+  ///
+  /// \return False if the options log could not be opened.
+  bool PrintCommandIfRequested(const Command &C) const;
+
+  /// Run \p C through the driver's CC1Runner hook, if it has one and \p C is a
+  /// clang -cc1 job that can be run that way.
+  ///
+  /// \return False if \p C still needs to be executed.
+  bool RunWithCC1Runner(const Command &C, int &Res, std::string *ErrMsg) const;
+
+  /// Run \p C through the cache of compile job results selected with
+  /// -fcompile-cache-dir=, if there is one and \p C is a clang -cc1 job whose
+  /// result can be cached.
+  ///
+  /// \return False if \p C still needs to be executed.
+  bool RunWithCompileCache(const Command &C, int &Res, std::string *ErrMsg,
+                           bool *ExecutionFailed) const;
+
+  /// Execute the jobs in \p Jobs on up to \p NumThreads threads, starting a
+  /// job only once all the jobs producing its inputs have finished.
+  ///
+  /// No new jobs are started once any job fails; jobs which are already
+  /// running are allowed to complete. Failures are reported in job order.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs, unsigned NumThreads,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -267,6 +304,10 @@ public:
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
 
+  /// Whether executing \p C, one of the jobs of this compilation, would hand
+  /// it to the driver's CC1Runner hook rather than spawn a process for it.
+  bool isRunWithCC1Runner(const Command &C) const;
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
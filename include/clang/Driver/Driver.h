@@ -90,6 +90,14 @@ class Driver {
   /// LTO mode selected via -f(no-)?lto(=.*)? options.
   LTOKind LTOMode;
 
+  /// Maximum number of jobs to run concurrently, selected via
+  /// -fparallel-jobs=.
+  unsigned NumParallelJobs;
+
+  /// Directory of the cache of compile job results, selected via
+  /// -fcompile-cache-dir=, or empty if caching is disabled.
+  std::string CompileCacheDir;
+
 public:
   enum OpenMPRuntimeKind {
     /// An unknown OpenMP runtime. We can't generate effective OpenMP code
@@ -200,6 +208,27 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// A hook which runs a clang -cc1 job without spawning a new process for
+  /// it. \p Argv holds the job's arguments, starting with "-cc1".
+  ///
+  /// \returns false if the job could not be handed off, in which case it is
+  /// run normally. Otherwise \p Result is set to its exit code, and \p ErrMsg
+  /// describes any failure to get that code.
+  typedef bool (*CC1RunnerTy)(ArrayRef<const char *> Argv, int &Result,
+                              std::string *ErrMsg);
+
+  /// If set, used to run clang -cc1 jobs in place of executing the clang
+  /// binary for each of them.
+  CC1RunnerTy CC1Runner;
+
+  /// Whether CC1Runner may run several jobs at once, from different threads.
+  /// If not, jobs run in parallel are executed as separate processes.
+  bool CC1RunnerIsThreadSafe;
+
+  /// How -### describes the jobs which would be run through CC1Runner, such
+  /// as "in-process".
+  const char *CC1RunnerName;
+
 private:
   /// Default target triple.
   std::string DefaultTargetTriple;
@@ -303,6 +332,12 @@ public:
   bool isSaveTempsEnabled() const { return SaveTemps != SaveTempsNone; }
   bool isSaveTempsObj() const { return SaveTemps == SaveTempsObj; }
 
+  /// Maximum number of independent jobs to execute concurrently.
+  unsigned getNumParallelJobs() const { return NumParallelJobs; }
+
+  /// Directory to cache the results of compile jobs in, if not empty.
+  StringRef getCompileCacheDir() const { return CompileCacheDir; }
+
   bool embedBitcodeEnabled() const { return BitcodeEmbed != EmbedNone; }
   bool embedBitcodeInObject() const {
     // LTO has no object file output so ignore embed bitcode option in LTO.
@@ -115,6 +115,11 @@ public:
 
   const llvm::opt::ArgStringList &getArguments() const { return Arguments; }
 
+  /// Replace the arguments the command is launched with.
+  void replaceArguments(llvm::opt::ArgStringList List) {
+    Arguments = std::move(List);
+  }
+
   /// Print a command argument, and optionally quote it.
   static void printArg(llvm::raw_ostream &OS, StringRef Arg, bool Quote);
 };
@@ -16,7 +16,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Allocator.h"
-#include <map>
+#include <vector>
 
 namespace clang {
   class LangOptions;
@@ -38,7 +38,9 @@ class EditedSource {
     FileEdit() : RemoveLen(0) {}
   };
 
-  typedef std::map<FileOffset, FileEdit> FileEditsTy;
+  /// \brief The edits, sorted by offset.  Edits are mostly made in source
+  /// order, so a sorted vector is cheaper than a map.
+  typedef std::vector<std::pair<FileOffset, FileEdit>> FileEditsTy;
   FileEditsTy FileEdits;
 
   llvm::DenseMap<unsigned, llvm::TinyPtrVector<IdentifierInfo*>>
@@ -82,6 +84,8 @@ private:
   StringRef getSourceText(FileOffset BeginOffs, FileOffset EndOffs,
                           bool &Invalid);
   FileEditsTy::iterator getActionForOffset(FileOffset Offs);
+  FileEditsTy::iterator getFirstEditAfter(FileOffset Offs);
+  FileEdit &getOrCreateEdit(FileOffset Offs);
   void deconstructMacroArgLoc(SourceLocation Loc,
                               SourceLocation &ExpansionLoc,
                               IdentifierInfo *&II);
@@ -18,6 +18,9 @@
 #include "clang/Basic/LangOptions.h"
 #include "clang/Tooling/Core/Replacement.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Chrono.h"
+#include <mutex>
 #include <system_error>
 
 namespace clang {
@@ -865,6 +868,42 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
                      StringRef FallbackStyle, StringRef Code = "",
                      vfs::FileSystem *FS = nullptr);
 
+/// \brief Remembers the styles ``getStyle()`` finds in configuration files, so
+/// that files of the same language in the same directory don't look for and
+/// parse the configuration file again.
+///
+/// A style is reused as long as the configuration file it was read from has
+/// the same modification time and size. Configuration files created after the
+/// style was cached, in directories that were searched before, aren't noticed.
+/// Can be used from several threads at once.
+class FormatStyleCache {
+public:
+  /// \brief Like ``getStyle()``, but reuses the style of an earlier call for
+  /// a file in the same directory if possible.
+  FormatStyle getStyle(StringRef StyleName, StringRef FileName,
+                       StringRef FallbackStyle, StringRef Code = "",
+                       vfs::FileSystem *FS = nullptr);
+
+private:
+  struct Entry {
+    FormatStyle Style;
+    /// The configuration file the style was read from, or empty if there is
+    /// none.
+    std::string ConfigFile;
+    llvm::sys::TimePoint<> ModificationTime;
+    uint64_t Size = 0;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+};
+
+/// \brief Returns the language the code in \p FileName is assumed to be in,
+/// looking at \p Code only if the file name isn't sufficient.
+///
+/// This is the language ``getStyle()`` picks the style for.
+FormatStyle::LanguageKind guessLanguage(StringRef FileName, StringRef Code);
+
 // \brief Returns a string representation of ``Language``.
 inline StringRef getLanguageName(FormatStyle::LanguageKind Language) {
   switch (Language) {
@@ -179,6 +179,13 @@ private:
   /// some number of calls.
   unsigned PreambleRebuildCounter;
 
+  class PreambleFileSystem;
+
+  /// \brief When the precompiled preamble is kept in memory rather than
+  /// written to a temporary file, the file system that serves it to the file
+  /// managers this unit creates.
+  IntrusiveRefCntPtr<PreambleFileSystem> PreambleFS;
+
 public:
   class PreambleData {
     const FileEntry *File;
@@ -440,6 +447,11 @@ private:
       std::shared_ptr<PCHContainerOperations> PCHContainerOps,
       const CompilerInvocation &PreambleInvocationIn, bool AllowRebuild = true,
       unsigned MaxLines = 0);
+
+  /// \brief Lay the file system serving the in-memory precompiled preamble,
+  /// if there is one, over \p VFS.
+  IntrusiveRefCntPtr<vfs::FileSystem>
+  overlayPreambleFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> VFS);
   void RealizeTopLevelDeclsFromPreamble();
 
   /// \brief Transfers ownership of the objects (like SourceManager) from
@@ -668,6 +680,21 @@ public:
     return CachedCompletionResults.size(); 
   }
 
+  /// \brief Estimate the memory used by the stored diagnostics.
+  size_t getStoredDiagnosticsMemory() const;
+
+  /// \brief Release the state which is only kept to speed up later requests,
+  /// for translation units which are kept alive but rarely used.
+  ///
+  /// The cached global code-completion results are dropped, and rebuilt by
+  /// the next reparse. The translation unit stays complete and reparseable.
+  ///
+  /// \param ClearDiagnostics also drop the stored diagnostics, which are not
+  /// recomputed until the next reparse.
+  ///
+  /// \returns an estimate of the number of bytes released.
+  size_t trimMemory(bool ClearDiagnostics);
+
   /// \brief Returns an iterator range for the local preprocessing entities
   /// of the local Preprocessor, if this is a parsed source file, or the loaded
   /// preprocessing entities of the primary module if this is an AST file.
@@ -828,6 +855,14 @@ public:
   /// (e.g. because the PCH could not be loaded), this accepts the ASTUnit
   /// mainly to allow the caller to see the diagnostics.
   ///
+  /// \param StorePreamblesInMemory - If true, the precompiled preamble is kept
+  /// in memory instead of being written to a temporary file. It is only
+  /// visible through this unit's own file manager, so code completion must be
+  /// given that file manager to make use of it.
+  ///
+  /// \param SharedContents - If non-null, the contents of the files read for
+  /// this unit are shared with the other units using the same object.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -844,7 +879,9 @@ public:
       bool AllowPCHWithCompilerErrors = false, bool SkipFunctionBodies = false,
       bool UserFilesAreVolatile = false, bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
-      std::unique_ptr<ASTUnit> *ErrAST = nullptr);
+      std::unique_ptr<ASTUnit> *ErrAST = nullptr,
+      bool StorePreamblesInMemory = false,
+      std::shared_ptr<SharedFileContents> SharedContents = nullptr);
 
   /// \brief Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
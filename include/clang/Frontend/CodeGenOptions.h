@@ -175,6 +175,10 @@ public:
   /// importing.
   std::string ThinLTOIndexFile;
 
+  /// Name of the directory in which the object files built by ThinLTO
+  /// backend compiles are cached.
+  std::string ThinLTOCacheDir;
+
   /// A list of file names passed with -fcuda-include-gpubinary options to
   /// forward to CUDA runtime back-end for incorporating them into host-side
   /// object file.
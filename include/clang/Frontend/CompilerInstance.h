@@ -45,6 +45,8 @@ class FileEntry;
 class FileManager;
 class FrontendAction;
 class Module;
+class ModuleBuildScheduler;
+class PersistentStatCacheWriter;
 class Preprocessor;
 class Sema;
 class SourceManager;
@@ -87,6 +89,10 @@ class CompilerInstance : public ModuleLoader {
   /// The file manager.
   IntrusiveRefCntPtr<FileManager> FileMgr;
 
+  /// The stat cache of FileMgr recording the files found missing, if the
+  /// persistent stat cache is being updated.
+  PersistentStatCacheWriter *StatCacheWriter;
+
   /// The source manager.
   IntrusiveRefCntPtr<SourceManager> SourceMgr;
 
@@ -120,6 +126,10 @@ class CompilerInstance : public ModuleLoader {
   /// \brief The module dependency collector for crashdumps
   std::shared_ptr<ModuleDependencyCollector> ModuleDepCollector;
 
+  /// \brief The threads building modules in the background, shared with the
+  /// instances which build modules for this one.
+  std::shared_ptr<ModuleBuildScheduler> ModuleScheduler;
+
   /// \brief The module provider.
   std::shared_ptr<PCHContainerOperations> ThePCHContainerOperations;
 
@@ -150,6 +160,11 @@ class CompilerInstance : public ModuleLoader {
   /// \brief One or more modules failed to build.
   bool ModuleBuildFailed;
 
+  /// \brief The number of times we waited for another process to finish
+  /// building a module, and the total time spent waiting.
+  unsigned NumModuleLockWaits;
+  double ModuleLockWaitSeconds;
+
   /// \brief Holds information about the output file.
   ///
   /// If TempFilename is not empty we must rename it to Filename at the end.
@@ -174,6 +189,13 @@ class CompilerInstance : public ModuleLoader {
 
   CompilerInstance(const CompilerInstance &) = delete;
   void operator=(const CompilerInstance &) = delete;
+
+  /// \brief Find or build a precompiled header of the builtin headers
+  /// included at the start of \p Input, when -fbuiltin-headers-pch-path is
+  /// given, and make it the implicit PCH of the input.
+  ///
+  /// \returns true if a precompiled header is used.
+  bool setUpBuiltinHeadersPCH(const FrontendInputFile &Input);
 public:
   explicit CompilerInstance(
       std::shared_ptr<PCHContainerOperations> PCHContainerOps =
@@ -507,6 +529,28 @@ public:
   void setModuleDepCollector(
       std::shared_ptr<ModuleDependencyCollector> Collector);
 
+  std::shared_ptr<ModuleBuildScheduler> getModuleBuildScheduler() const {
+    return ModuleScheduler;
+  }
+  void setModuleBuildScheduler(
+      std::shared_ptr<ModuleBuildScheduler> Scheduler) {
+    ModuleScheduler = std::move(Scheduler);
+  }
+
+  /// \brief Wait for the modules being built in the background, if any, to
+  /// be done.
+  void waitForModuleBuilds();
+
+  /// \brief Record that we waited \p Seconds for another process to build a
+  /// module.
+  void noteModuleLockWait(double Seconds) {
+    ++NumModuleLockWaits;
+    ModuleLockWaitSeconds += Seconds;
+  }
+
+  /// \brief Print statistics about the modules built and loaded.
+  void PrintStats() const;
+
   std::shared_ptr<PCHContainerOperations> getPCHContainerOperations() const {
     return ThePCHContainerOperations;
   }
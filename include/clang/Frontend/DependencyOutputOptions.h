@@ -43,6 +43,9 @@ public:
   /// stderr.
   std::string HeaderIncludeOutputFile;
 
+  /// The file to add the cost of each header to (-fheader-cost-file=).
+  std::string HeaderCostFile;
+
   /// A list of names to use as the targets in the dependency file; this list
   /// must contain at least one entry.
   std::vector<std::string> Targets;
@@ -132,6 +132,8 @@ public:
                                            /// metrics and statistics.
   unsigned ShowTimers : 1;                 ///< Show timers for individual
                                            /// actions.
+  unsigned ShowTemplateProfile : 1;        ///< Show the cost of the
+                                           /// instantiations of each template.
   unsigned ShowVersion : 1;                ///< Show the -version text.
   unsigned FixWhatYouCan : 1;              ///< Apply fixes even if there are
                                            /// unfixable errors.
@@ -158,6 +160,9 @@ public:
                                            ///< files into the PCM file.
   unsigned IncludeTimestamps : 1;          ///< Whether timestamps should be
                                            ///< written to the produced PCH file.
+  unsigned SerializeRecordLayouts : 1;     ///< Whether record layouts should
+                                           ///< be written to the produced PCH
+                                           ///< or module file.
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -258,6 +263,10 @@ public:
   /// \brief The list of AST files to merge.
   std::vector<std::string> ASTMergeFiles;
 
+  /// \brief The index store to write the symbols of the translation unit to,
+  /// if any.
+  std::string IndexStorePath;
+
   /// \brief A list of arguments to forward to LLVM's option processing; this
   /// should only be used for debugging and experimental features.
   std::vector<std::string> LLVMArgs;
@@ -276,16 +285,28 @@ public:
   /// Filename to write statistics to.
   std::string StatsFile;
 
+  /// \brief If non-empty, the directory in which to cache precompiled headers
+  /// of the builtin headers included at the start of a source file.
+  std::string BuiltinHeadersPCHPath;
+
+  /// Filename to write the -ftime-trace= trace to.
+  std::string TimeTracePath;
+
+  /// Minimum duration, in microseconds, of the scopes in the trace.
+  unsigned TimeTraceGranularity = 500;
+
 public:
   FrontendOptions() :
     DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-    ShowStats(false), ShowTimers(false), ShowVersion(false),
+    ShowStats(false), ShowTimers(false), ShowTemplateProfile(false),
+    ShowVersion(false),
     FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
     BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
-    IncludeTimestamps(true), ARCMTAction(ARCMT_None),
+    IncludeTimestamps(true), SerializeRecordLayouts(false),
+    ARCMTAction(ARCMT_None),
     ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly)
   {}
 
@@ -13,6 +13,8 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include <string>
+#include <system_error>
 
 namespace llvm {
 class raw_ostream;
@@ -37,6 +39,15 @@ std::unique_ptr<DiagnosticConsumer> create(StringRef OutputFile,
                                            DiagnosticOptions *Diags,
                                            bool MergeChildRecords = false);
 
+/// \brief Writes the diagnostics of the serialized diagnostics files
+/// \p InputFiles, in order, to a single file \p OutputFile.
+///
+/// This is meant for build systems that collect the diagnostics of many
+/// translation units. Each file name, category and flag is written once,
+/// however many inputs refer to it.
+std::error_code mergeFiles(ArrayRef<std::string> InputFiles,
+                           StringRef OutputFile);
+
 } // end serialized_diags namespace
 } // end clang namespace
 
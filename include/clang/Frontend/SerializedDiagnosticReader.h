@@ -63,6 +63,9 @@ public:
   /// \brief Read the diagnostics in \c File
   std::error_code readDiagnostics(StringRef File);
 
+  /// \brief Read the diagnostics in \c Buffer.
+  std::error_code readDiagnostics(llvm::MemoryBufferRef Buffer);
+
 private:
   enum class Cursor;
 
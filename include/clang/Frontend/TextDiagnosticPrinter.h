@@ -21,11 +21,17 @@
 #include <memory>
 
 namespace clang {
+class BufferedDiagnosticStream;
 class DiagnosticOptions;
 class LangOptions;
 class TextDiagnostic;
 
 class TextDiagnosticPrinter : public DiagnosticConsumer {
+  /// \brief The buffer in front of the output stream, with
+  /// -fdiagnostics-buffered-output.
+  std::unique_ptr<BufferedDiagnosticStream> Buffer;
+
+  /// \brief The stream diagnostics are printed to; the buffer if any.
   raw_ostream &OS;
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
 
@@ -49,8 +55,14 @@ public:
 
   void BeginSourceFile(const LangOptions &LO, const Preprocessor *PP) override;
   void EndSourceFile() override;
+  void finish() override;
   void HandleDiagnostic(DiagnosticsEngine::Level Level,
                         const Diagnostic &Info) override;
+
+private:
+  /// \brief Makes the diagnostic just printed visible, or leaves it in the
+  /// buffer until the end of the source file.
+  void flushDiagnostic(DiagnosticsEngine::Level Level);
 };
 
 } // end namespace clang
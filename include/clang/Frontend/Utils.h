@@ -170,6 +170,14 @@ void AttachHeaderIncludeGen(Preprocessor &PP,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// CreateHeaderCostConsumer - Create an AST consumer which records, for each
+/// header entered by the given preprocessor, the time spent in it, the tokens
+/// lexed from it, the declarations it contains, the template instantiations
+/// it triggered and the AST memory allocated while in it. At the end of the
+/// translation unit, these are added to the totals in \p OutputPath.
+std::unique_ptr<ASTConsumer> CreateHeaderCostConsumer(Preprocessor &PP,
+                                                      StringRef OutputPath);
+
 /// Cache tokens for use with PCH. Note that this requires a seekable stream.
 void CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS);
 
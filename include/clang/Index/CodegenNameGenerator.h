@@ -35,6 +35,9 @@ public:
   bool writeName(const Decl *D, raw_ostream &OS);
 
   /// Version of \c writeName function that returns a string.
+  ///
+  /// The names are remembered, so asking again for the name of the same decl
+  /// won't mangle it again.
   std::string getName(const Decl *D);
 
   /// This can return multiple mangled names when applicable, e.g. for C++
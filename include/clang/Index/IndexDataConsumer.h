@@ -52,6 +52,10 @@ public:
                                      SymbolRoleSet Roles,
                                      FileID FID, unsigned Offset);
 
+  /// \returns false to skip the top-level declarations in \p FID, e.g.
+  /// because the file was already indexed in an identical context.
+  virtual bool shouldIndexFile(FileID FID);
+
   virtual void finish() {}
 
 private:
@@ -30,6 +30,9 @@ struct IndexingOptions {
   SystemSymbolFilterKind SystemSymbolFilter
     = SystemSymbolFilterKind::DeclarationsOnly;
   bool IndexFunctionLocals = false;
+  /// Skip parsing the bodies of functions that are not in the main file,
+  /// where possible, so that only the main file's code is indexed in full.
+  bool SkipFunctionBodiesOutsideMainFile = false;
 };
 
 /// \param WrappedAction another frontend action to wrap over or null.
@@ -38,6 +41,19 @@ createIndexingAction(std::shared_ptr<IndexDataConsumer> DataConsumer,
                      IndexingOptions Opts,
                      std::unique_ptr<FrontendAction> WrappedAction);
 
+/// \brief Creates an action that runs \p WrappedAction and, as a side effect,
+/// writes the symbol occurrences of the translation unit to the index store
+/// at \p StorePath.
+///
+/// The symbols of each file are written to a record file under
+/// 'v1/records', named after the file and the hash of its contents, so a
+/// header indexed the same way by many translation units is written once.
+/// A unit file under 'v1/units', named after \p OutputFile or the main file
+/// when there is no output, lists the records of the translation unit.
+std::unique_ptr<FrontendAction>
+createIndexDataRecordingAction(StringRef StorePath, StringRef OutputFile,
+                               std::unique_ptr<FrontendAction> WrappedAction);
+
 void indexASTUnit(ASTUnit &Unit,
                   std::shared_ptr<IndexDataConsumer> DataConsumer,
                   IndexingOptions Opts);
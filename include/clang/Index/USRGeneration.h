@@ -11,7 +11,9 @@
 #define LLVM_CLANG_INDEX_USRGENERATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class Decl;
@@ -55,6 +57,24 @@ void generateUSRForObjCProtocol(StringRef Prot, raw_ostream &OS);
 bool generateUSRForMacro(const MacroDefinitionRecord *MD,
                          const SourceManager &SM, SmallVectorImpl<char> &Buf);
 
+/// \brief Caches the USRs generated for the declarations of an ASTContext.
+///
+/// Indexers request the USR of the same declarations over and over; the
+/// cache generates each of them once. It must not outlive the declarations
+/// it was queried with.
+class USRCache {
+  llvm::BumpPtrAllocator Alloc;
+  /// \brief The USR of each declaration, empty if it should be ignored.
+  llvm::DenseMap<const Decl *, StringRef> USRs;
+
+public:
+  /// \brief Returns the USR of \p D, or an empty string if \c
+  /// generateUSRForDecl() says the result should be ignored.
+  ///
+  /// The string is null-terminated and stays valid as long as the cache.
+  StringRef getUSR(const Decl *D);
+};
+
 } // namespace index
 } // namespace clang
 
@@ -22,6 +22,7 @@
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Allocator.h"
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace clang {
@@ -131,7 +132,54 @@ public:
   /// default-constructed \c HeaderFileInfo.
   virtual HeaderFileInfo GetHeaderFileInfo(const FileEntry *FE) = 0;
 };
-  
+
+/// \brief The results of \c HeaderSearch::LookupFile shared by translation
+/// units that use the same FileManager, e.g. the files of a ClangTool.
+///
+/// A result records the search directory a spelled name was found in when
+/// searching from a given directory of a given search path, or that it was
+/// not found at all. Translation units with the same search path can then
+/// skip the directories before it, including their framework and header map
+/// lookups. The FileManager never forgets the files it has or has not seen,
+/// so the skipped lookups would have failed again.
+///
+/// The cache binds to the FileManager of the first lookup it records, and
+/// ignores lookups made with any other. It may be used from several threads.
+class SharedLookupFileCache {
+public:
+  /// \brief The result of a lookup.
+  struct Entry {
+    /// The index of the search directory the file was found in, or the size
+    /// of the search path if it was not found.
+    unsigned HitIdx;
+    /// The name a header map mapped the spelled name to, if any.
+    std::string MappedName;
+  };
+
+  SharedLookupFileCache();
+  ~SharedLookupFileCache();
+
+  /// \brief Retrieve the result of looking up \p Filename with \p FileMgr,
+  /// starting at the search directory \p StartIdx of the search path
+  /// identified by \p SearchPathKey.
+  ///
+  /// \returns true and sets \p Result if that lookup was recorded.
+  bool lookup(FileManager &FileMgr, StringRef SearchPathKey, unsigned StartIdx,
+              StringRef Filename, Entry &Result);
+
+  /// \brief Record the result of a lookup, see \c lookup().
+  void insert(FileManager &FileMgr, StringRef SearchPathKey, unsigned StartIdx,
+              StringRef Filename, Entry Result);
+
+private:
+  std::mutex Mutex;
+  /// The FileManager all results were found with, kept alive so that it is
+  /// never mistaken for another one.
+  IntrusiveRefCntPtr<FileManager> FileMgr;
+  /// The results for each search path, by start index and spelled name.
+  llvm::StringMap<llvm::StringMap<Entry>> Lookups;
+};
+
 /// \brief Encapsulates the information needed to find the file referenced
 /// by a \#include or \#include_next, (sub-)framework lookup, etc.
 class HeaderSearch {
@@ -220,6 +268,12 @@ class HeaderSearch {
   /// \brief Describes whether a given directory has a module map in it.
   llvm::DenseMap<const DirectoryEntry *, bool> DirectoryHasModuleMap;
 
+  /// \brief The lowercased names of the entries of each search directory
+  /// listed so far, for -index-header-search-dirs. A null set means that the
+  /// directory could not be listed.
+  llvm::DenseMap<const DirectoryEntry *, std::unique_ptr<llvm::StringSet<>>>
+      DirectoryEntryNames;
+
   /// \brief Set of module map files we've already loaded, and a flag indicating
   /// whether they were valid or not.
   llvm::DenseMap<const FileEntry *, bool> LoadedModuleMaps;
@@ -240,6 +294,15 @@ class HeaderSearch {
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
+  unsigned NumIndexedDirectories, NumLookupsSkippedByIndex;
+  unsigned NumSharedLookupHits;
+
+  /// \brief Identifies the search directories for the shared lookup cache;
+  /// empty until first needed.
+  std::string SearchPathKey;
+
+  /// \brief Retrieve \c SearchPathKey, computing it if needed.
+  StringRef getSearchPathKey();
 
   // HeaderSearch doesn't support default or copy construction.
   HeaderSearch(const HeaderSearch&) = delete;
@@ -259,6 +322,15 @@ public:
   
   FileManager &getFileMgr() const { return FileMgr; }
 
+  /// \brief Determine whether the search directory \p Dir may contain the
+  /// relative path \p Filename.
+  ///
+  /// Unless search directory indexing is enabled this always returns true.
+  /// Otherwise \p Dir is listed the first time it is queried, and the first
+  /// component of \p Filename is checked against that listing. False
+  /// positives are possible, false negatives are not.
+  bool directoryMayContain(const DirectoryEntry *Dir, StringRef Filename);
+
   /// \brief Interface for setting the file search paths.
   void SetSearchPaths(const std::vector<DirectoryLookup> &dirs,
                       unsigned angledDirIdx, unsigned systemDirIdx,
@@ -269,6 +341,7 @@ public:
     AngledDirIdx = angledDirIdx;
     SystemDirIdx = systemDirIdx;
     NoCurDirSearch = noCurDirSearch;
+    SearchPathKey.clear();
     //LookupFileCache.clear();
   }
 
@@ -279,6 +352,7 @@ public:
     if (!isAngled)
       AngledDirIdx++;
     SystemDirIdx++;
+    SearchPathKey.clear();
   }
 
   /// \brief Set the list of system header prefixes.
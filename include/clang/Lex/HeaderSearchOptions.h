@@ -15,11 +15,14 @@
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringRef.h"
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace clang {
 
+class SharedLookupFileCache;
+
 namespace frontend {
   /// IncludeDirGroup - Identifies the group an include Entry belongs to,
   /// representing its relative positive in the search list.
@@ -137,12 +140,21 @@ public:
   /// regenerated often.
   unsigned ModuleCachePruneAfter;
 
+  /// \brief The number of threads which build modules that are likely to be
+  /// imported soon, while the module needed right now is being built. Zero
+  /// builds every module when it is imported.
+  unsigned ModulesBuildThreads;
+
   /// \brief The time in seconds when the build session started.
   ///
   /// This time is used by other optimizations in header search and module
   /// loading.
   uint64_t BuildSessionTimestamp;
 
+  /// \brief The file listing the module files, with their signatures, whose
+  /// input files the build system guarantees to be up to date.
+  std::string ModulesTrustedManifest;
+
   /// \brief The set of macro names that should be ignored for the purposes
   /// of computing the module hash.
   llvm::SmallSetVector<llvm::CachedHashString, 16> ModulesIgnoreMacros;
@@ -178,16 +190,26 @@ public:
 
   unsigned ModulesValidateDiagnosticOptions : 1;
 
+  /// \brief Whether to list each normal search directory once and skip the
+  /// lookups of names it cannot contain.
+  unsigned IndexSearchDirectories : 1;
+
+  /// \brief The results of header search shared with the other translation
+  /// units of a tool or server, if any. See \c SharedLookupFileCache.
+  std::shared_ptr<SharedLookupFileCache> SharedLookupCache;
+
   HeaderSearchOptions(StringRef _Sysroot = "/")
       : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(0),
         ImplicitModuleMaps(0), ModuleMapFileHomeIsCwd(0),
         ModuleCachePruneInterval(7 * 24 * 60 * 60),
-        ModuleCachePruneAfter(31 * 24 * 60 * 60), BuildSessionTimestamp(0),
+        ModuleCachePruneAfter(31 * 24 * 60 * 60), ModulesBuildThreads(0),
+        BuildSessionTimestamp(0),
         UseBuiltinIncludes(true), UseStandardSystemIncludes(true),
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
         ModulesValidateSystemHeaders(false),
-        UseDebugInfo(false), ModulesValidateDiagnosticOptions(true) {}
+        UseDebugInfo(false), ModulesValidateDiagnosticOptions(true),
+        IndexSearchDirectories(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
@@ -224,6 +224,14 @@ public:
 
   /// \brief Return the current location in the buffer.
   const char *getBufferLocation() const { return BufferPtr; }
+
+  /// \brief Return true if the next token lexed will have the "start of line"
+  /// flag set on it.
+  bool isAtStartOfLine() const { return IsAtStartOfLine; }
+
+  /// \brief Move the lexer to \p Offset in the buffer, which must be the start
+  /// of a token, as if it had just lexed everything before it.
+  void seek(unsigned Offset, bool IsAtStartOfLine);
   
   /// Stringify - Convert the specified string into a C string by escaping '\'
   /// and " characters.  This does not add surrounding ""'s to the string.
@@ -449,6 +457,20 @@ public:
                                                    const LangOptions &LangOpts,
                                                    unsigned MaxLines = 0);
 
+  /// \brief Reduce the given file to its preprocessor directives.
+  ///
+  /// Everything but the directives is dropped, keeping the line and column
+  /// of every directive, so that preprocessing the result includes the same
+  /// files as preprocessing the original would.
+  ///
+  /// \param Buffer The memory buffer containing the file's contents.
+  ///
+  /// \param Minimized Receives the reduced contents, which are never longer
+  /// than \p Buffer.
+  static void MinimizeToDirectives(StringRef Buffer,
+                                   const LangOptions &LangOpts,
+                                   SmallVectorImpl<char> &Minimized);
+
   /// \brief Checks that the given token is the first token that occurs after
   /// the given location (this excludes comments and whitespace). Returns the
   /// location immediately after the specified token. If the token is not found
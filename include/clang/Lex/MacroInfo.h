@@ -84,6 +84,10 @@ class MacroInfo {
   /// \brief Whether this macro contains the sequence ", ## __VA_ARGS__"
   bool HasCommaPasting : 1;
 
+  /// \brief Whether the replacement list contains a '##' or a comment token,
+  /// which need special handling when expanded.
+  bool HasPasteOrComment : 1;
+
   //===--------------------------------------------------------------------===//
   // State that changes as the macro is used.
 
@@ -214,6 +218,10 @@ public:
   bool hasCommaPasting() const { return HasCommaPasting; }
   void setHasCommaPasting() { HasCommaPasting = true; }
 
+  /// \brief Return true if the replacement list contains a '##' or a
+  /// comment token.
+  bool hasPasteOrComment() const { return HasPasteOrComment; }
+
   /// \brief Return false if this macro is defined in the main file and has
   /// not yet been used.
   bool isUsed() const { return IsUsed; }
@@ -247,6 +255,8 @@ public:
         !IsDefinitionLengthCached &&
         "Changing replacement tokens after definition length got calculated");
     ReplacementTokens.push_back(Tok);
+    if (Tok.isOneOf(tok::hashhash, tok::comment))
+      HasPasteOrComment = true;
   }
 
   /// \brief Return true if this macro is enabled.
@@ -39,6 +39,10 @@ class MultipleIncludeOpt {
   /// the detection of header guards in a file.
   bool ImmediatelyAfterTopLevelIfndef;
 
+  /// ReadAnyTokensBeforeDirective - The value of ReadAnyTokens when the
+  /// directive being handled started.
+  bool ReadAnyTokensBeforeDirective;
+
   /// ReadAnyTokens - This is set to false when a file is first opened and true
   /// any time a token is returned to the client or a (non-multiple-include)
   /// directive is parsed.  When the final #endif is parsed this is reset back
@@ -59,6 +63,7 @@ public:
   MultipleIncludeOpt() {
     ReadAnyTokens = false;
     ImmediatelyAfterTopLevelIfndef = false;
+    ReadAnyTokensBeforeDirective = false;
     DidMacroExpansion = false;
     TheMacro = nullptr;
     DefinedMacro = nullptr;
@@ -109,6 +114,17 @@ public:
     ImmediatelyAfterTopLevelIfndef = false;
   }
 
+  /// EnterDirective - Called when a preprocessor directive starts, before any
+  /// of its tokens are read.
+  void EnterDirective() { ReadAnyTokensBeforeDirective = ReadAnyTokens; }
+
+  /// ReadFileLocalDirective - Called once a directive that only affects the
+  /// file it is in, such as \#pragma once, has been read.  It does not count
+  /// as reading tokens, so it may precede or follow the controlling \#ifndef.
+  void ReadFileLocalDirective() {
+    ReadAnyTokens = ReadAnyTokensBeforeDirective;
+  }
+
   /// ExpandedMacro - When a macro is expanded with this lexer as the current
   /// buffer, this method is called to disable the MIOpt if needed.
   void ExpandedMacro() { DidMacroExpansion = true; }
@@ -17,6 +17,7 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Lex/PPCallbacks.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/iterator.h"
@@ -287,6 +288,20 @@ namespace clang {
   /// including the various preprocessing directives processed, macros 
   /// expanded, etc.
   class PreprocessingRecord : public PPCallbacks {
+  public:
+    /// \brief A local preprocessed entity together with the offsets of its
+    /// begin and end in its file.
+    struct FileEntityInfo {
+      unsigned BeginOffset;
+      unsigned EndOffset;
+      PreprocessedEntity *Entity;
+
+      bool operator<(const FileEntityInfo &RHS) const {
+        return BeginOffset < RHS.BeginOffset;
+      }
+    };
+
+  private:
     SourceManager &SourceMgr;
     
     /// \brief Allocator used to store preprocessing objects.
@@ -333,6 +348,30 @@ namespace clang {
     /// \brief External source of preprocessed entities.
     ExternalPreprocessingRecordSource *ExternalSource;
 
+    /// \brief Whether only the macro expansions and inclusion directives of
+    /// the main file are recorded.
+    bool MainFileOnly;
+
+    /// \brief The local preprocessed entities of each file, sorted by offset.
+    ///
+    /// Built lazily by the first \see getLocalPreprocessedEntitiesInFile query
+    /// and rebuilt when entities were added since, so that queries compare
+    /// plain offsets instead of calling
+    /// \c SourceManager::isBeforeInTranslationUnit.
+    llvm::DenseMap<FileID, std::vector<FileEntityInfo>> LocalEntitiesByFile;
+
+    /// \brief The number of local entities when \c LocalEntitiesByFile was
+    /// built.
+    unsigned NumEntitiesByFile;
+
+    /// \brief (Re)builds \c LocalEntitiesByFile if it is out of date.
+    void updateLocalEntitiesByFile();
+
+    /// \brief Whether an entity starting at \p Loc should be recorded.
+    bool shouldRecordEntityAt(SourceLocation Loc) const {
+      return !MainFileOnly || SourceMgr.isInMainFile(Loc);
+    }
+
     /// \brief Retrieve the preprocessed entity at the given ID.
     PreprocessedEntity *getPreprocessedEntity(PPEntityID PPID);
 
@@ -377,6 +416,14 @@ namespace clang {
 
     SourceManager &getSourceManager() const { return SourceMgr; }
 
+    /// \brief Sets whether only the macro expansions and inclusion directives
+    /// of the main file are recorded.
+    ///
+    /// Macro definitions are still recorded in every file, so that the macro
+    /// expansions of the main file can refer to them.
+    void setMainFileOnly(bool Value) { MainFileOnly = Value; }
+    bool isMainFileOnly() const { return MainFileOnly; }
+
     /// Iteration over the preprocessed entities.
     ///
     /// In a complete iteration, the iterator walks the range [-M, N),
@@ -464,6 +511,17 @@ namespace clang {
     /// \see getPreprocessedEntitiesInRange.
     bool isEntityInFileID(iterator PPEI, FileID FID);
 
+    /// \brief Returns the local preprocessed entities of the file \p FID that
+    /// intersect the offsets [\p BeginOffset, \p EndOffset], in source order.
+    ///
+    /// Unlike \see getPreprocessedEntitiesInRange, this leaves out the entities
+    /// of files \#included in the range, and does not need to compare source
+    /// locations across files. Entities loaded from an external source are
+    /// never returned; their files are loaded file IDs.
+    ArrayRef<FileEntityInfo>
+    getLocalPreprocessedEntitiesInFile(FileID FID, unsigned BeginOffset,
+                                       unsigned EndOffset);
+
     /// \brief Add a new preprocessed entity to this record.
     PPEntityID addPreprocessedEntity(PreprocessedEntity *Entity);
 
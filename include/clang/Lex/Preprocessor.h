@@ -353,6 +353,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   };
   std::vector<IncludeStackInfo> IncludeMacroStack;
 
+  /// \brief The lexers of the entered files with an open "Source" scope in
+  /// the -ftime-trace trace, innermost last.
+  SmallVector<PreprocessorLexer *, 8> TimeTracedLexers;
+
   /// \brief Actions invoked when some preprocessor activity is
   /// encountered (e.g. a file is \#included, etc).
   std::unique_ptr<PPCallbacks> Callbacks;
@@ -572,13 +576,30 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// we keep a MacroInfo stack used to restore the previous macro value.
   llvm::DenseMap<IdentifierInfo*, std::vector<MacroInfo*> > PragmaPushMacroInfo;
 
+  /// \brief Where skipping an excluded conditional block found the next
+  /// '#' at the start of a line, keyed by the offset lexing resumed at (times
+  /// two, plus one if it resumed at the start of a line).
+  typedef llvm::DenseMap<unsigned, unsigned> SkippedDirectiveTable;
+
+  /// \brief The skipped directive tables for each distinct file content seen
+  /// so far, keyed by a hash of the content and its size.
+  llvm::DenseMap<std::pair<size_t, size_t>,
+                 std::unique_ptr<SkippedDirectiveTable>> SkippedDirectiveTables;
+
+  /// \brief The skipped directive table for each buffer lexed, so that each
+  /// buffer is only hashed once.
+  llvm::DenseMap<const char *, SkippedDirectiveTable *>
+      SkippedDirectiveTableForBuffer;
+
   // Various statistics we track for performance analysis.
   unsigned NumDirectives, NumDefined, NumUndefined, NumPragma;
   unsigned NumIf, NumElse, NumEndif;
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
   unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
-  unsigned NumSkipped;
+  unsigned NumElidedMacroExpansions;
+  unsigned NumSkipped, NumSkippedByTable;
+  unsigned NumLexedFileTokens;
 
   /// \brief The predefined macros that preprocessor should use from the
   /// command line etc.
@@ -1030,6 +1051,15 @@ public:
   void EnterMacro(Token &Identifier, SourceLocation ILEnd, MacroInfo *Macro,
                   MacroArgs *Args);
 
+  /// \brief Returns true if the tokens of a macro defined at \p DefLoc and
+  /// expanded at \p ExpandLoc should keep their spelling locations instead of
+  /// being given locations in a new macro expansion SLocEntry, and counts the
+  /// expansion if so.
+  ///
+  /// \sa PreprocessorOptions::ElideSystemMacroExpansionLocs
+  bool shouldElideMacroExpansionLocs(SourceLocation ExpandLoc,
+                                     SourceLocation DefLoc);
+
   /// \brief Add a "macro" context to the top of the include stack,
   /// which will cause the lexer to start returning the specified tokens.
   ///
@@ -1528,6 +1558,10 @@ public:
 
   size_t getTotalMemory() const;
 
+  /// \brief Returns the number of tokens lexed from source files so far, not
+  /// counting the tokens of macro expansions and of skipped blocks.
+  unsigned getNumLexedFileTokens() const { return NumLexedFileTokens; }
+
   /// When the macro expander pastes together a comment (/##/) in Microsoft
   /// mode, this method handles updating the current state, returning the
   /// token on the next source line.
@@ -1723,6 +1757,12 @@ private:
 
   void PropagateLineStartLeadingSpaceInfo(Token &Result);
 
+  /// \brief Replace the contents of \p File by just its preprocessor
+  /// directives, if sources are minimized for a dependency scan.
+  ///
+  /// \sa PreprocessorOptions::MinimizeSourcesToDirectives
+  void minimizeFileToDirectives(const FileEntry *File);
+
   void EnterSubmodule(Module *M, SourceLocation ImportLoc);
   void LeaveSubmodule();
 
@@ -1777,6 +1817,10 @@ private:
   /// \brief A fast PTH version of SkipExcludedConditionalBlock.
   void PTHSkipExcludedConditionalBlock();
 
+  /// \brief Return the table of previously found directive offsets for the
+  /// current lexer's buffer, or null if the current lexer can't use one.
+  SkippedDirectiveTable *getSkippedDirectiveTable();
+
   /// \brief Evaluate an integer constant expression that may occur after a
   /// \#if or \#elif directive and return it as a bool.
   ///
@@ -1836,6 +1880,10 @@ private:
   /// start getting tokens from it using the PTH cache.
   void EnterSourceFileWithPTH(PTHLexer *PL, const DirectoryLookup *Dir);
 
+  /// \brief Start the -ftime-trace scope of the file just entered from
+  /// \p Loc, if a trace is being recorded.
+  void beginTimeTracedFile(SourceLocation Loc);
+
   /// \brief Set the FileID for the preprocessor predefines.
   void setPredefinesFileID(FileID FID) {
     assert(PredefinesFileID.isInvalid() && "PredefinesFileID already set!");
@@ -54,6 +54,10 @@ public:
   /// definitions and expansions.
   unsigned DetailedRecord : 1;
 
+  /// \brief Whether the detailed record should only hold the macro expansions
+  /// and inclusion directives of the main file.
+  unsigned DetailedRecordMainFileOnly : 1;
+
   /// The implicit PCH included at the start of the translation unit, or empty.
   std::string ImplicitPCHInclude;
 
@@ -67,9 +71,30 @@ public:
   /// \brief When true, a PCH with compiler errors will not be rejected.
   bool AllowPCHWithCompilerErrors;
 
+  /// \brief When true, only the macros from a PCH or module whose names are
+  /// looked up are ever deserialized. Code completion, -dM and other clients
+  /// which enumerate all macros see only those loaded so far.
+  bool StrictLazyPCHLoading;
+
   /// \brief Dump declarations that are deserialized from PCH, for testing.
   bool DumpDeserializedPCHDecls;
 
+  /// \brief When true, the tokens of macros defined and expanded in system
+  /// headers keep their spelling locations, so that no source location
+  /// address space is used for the expansion. Only the names of macros and
+  /// builtins within the expansion get expansion locations, which keeps
+  /// __LINE__, _Pragma and nested expansions accurate.
+  ///
+  /// The tokens of such an expansion are ordered by isBeforeInTranslationUnit
+  /// as if they appeared at the macro definition, not where it is expanded.
+  bool ElideSystemMacroExpansionLocs;
+
+  /// \brief When true, each source file is reduced to its preprocessor
+  /// directives before it is preprocessed. The result has the same includes
+  /// as the full file, so this speeds up scanning for dependencies, but no
+  /// other output is meaningful. It has no effect when modules are enabled.
+  bool MinimizeSourcesToDirectives;
+
   /// \brief This is a set of names for decls that we do not want to be
   /// deserialized, and we emit an error if they are; for testing purposes.
   std::set<std::string> DeserializedPCHDeclsToErrorOn;
@@ -140,9 +165,13 @@ public:
 
 public:
   PreprocessorOptions() : UsePredefines(true), DetailedRecord(false),
+                          DetailedRecordMainFileOnly(false),
                           DisablePCHValidation(false),
                           AllowPCHWithCompilerErrors(false),
+                          StrictLazyPCHLoading(false),
                           DumpDeserializedPCHDecls(false),
+                          ElideSystemMacroExpansionLocs(false),
+                          MinimizeSourcesToDirectives(false),
                           PrecompiledPreambleBytes(0, true),
                           RemappedFilesKeepOriginalName(true),
                           RetainRemappedFileBuffers(false),
@@ -99,6 +99,16 @@ class TokenLexer {
   /// should not be subject to further macro expansion.
   bool DisableMacroExpansion : 1;
 
+  /// IsDefinitionExpansion - This is true when the tokens are the replacement
+  /// list of the macro, without '##' or comments.  Each token then only needs
+  /// its location moved into the macro expansion chunk.
+  bool IsDefinitionExpansion : 1;
+
+  /// ElideExpansionLocs - This is true when the tokens keep their spelling
+  /// locations, and the macro expansion chunk is only reserved once a token
+  /// naming a macro needs a location in it.
+  bool ElideExpansionLocs : 1;
+
   TokenLexer(const TokenLexer &) = delete;
   void operator=(const TokenLexer &) = delete;
 public:
@@ -179,8 +189,8 @@ private:
 
   /// \brief If \p loc is a FileID and points inside the current macro
   /// definition, returns the appropriate source location pointing at the
-  /// macro expansion source location entry.
-  SourceLocation getExpansionLocForMacroDefLoc(SourceLocation loc) const;
+  /// macro expansion source location entry, reserving that entry if needed.
+  SourceLocation getExpansionLocForMacroDefLoc(SourceLocation loc);
 
   /// \brief Creates SLocEntries and updates the locations of macro argument
   /// tokens to their new expanded locations.
@@ -237,6 +237,14 @@ class Parser : public CodeCompletionHandler {
   /// \brief Identifiers which have been declared within a tentative parse.
   SmallVector<IdentifierInfo *, 8> TentativelyDeclaredIdentifiers;
 
+  /// \brief The outcomes of the tentative parses which disambiguate without
+  /// consuming any tokens, by getTentativeParseKey. Nested ambiguous
+  /// constructs, and the parse which follows a disambiguation, go back over
+  /// the same tokens with the same question, which would otherwise take time
+  /// exponential in their depth. Cleared at every top-level declaration.
+  llvm::DenseMap<std::pair<unsigned, unsigned>, unsigned char>
+      TentativeParseCache;
+
   IdentifierInfo *getSEHExceptKeyword();
 
   /// True if we are within an Objective-C container while parsing C-like decls.
@@ -1985,6 +1993,30 @@ private:
     return isTypeSpecifierQualifier();
   }
 
+  /// \brief The disambiguations whose outcome is kept in TentativeParseCache.
+  enum TentativeParseKind {
+    TPK_SimpleDeclaration,
+    TPK_ForRangeDeclaration,
+    TPK_FunctionDeclarator,
+    /// Followed by one kind for each TentativeCXXTypeIdContext.
+    TPK_TypeId
+  };
+
+  typedef std::pair<unsigned, unsigned> TentativeParseKey;
+
+  /// \brief Returns the key in TentativeParseCache of the disambiguation of
+  /// kind \p Kind which starts at the current token.
+  TentativeParseKey getTentativeParseKey(unsigned Kind) const;
+
+  /// \brief Looks up the outcome of the disambiguation \p Key. Returns false
+  /// if it is not known yet.
+  bool lookupTentativeParse(TentativeParseKey Key, bool &Result,
+                            bool &IsAmbiguous) const;
+
+  /// \brief Records the outcome of the disambiguation \p Key.
+  void rememberTentativeParse(TentativeParseKey Key, bool Result,
+                              bool IsAmbiguous);
+
   /// isCXXDeclarationStatement - C++-specialized function that disambiguates
   /// between a declaration or an expression statement, when parsing function
   /// bodies. Returns true for declaration, false for expression.
@@ -16,6 +16,7 @@
 #define LLVM_CLANG_REWRITE_CORE_HTMLREWRITE_H
 
 #include "clang/Basic/SourceLocation.h"
+#include <memory>
 #include <string>
 
 namespace clang {
@@ -26,6 +27,16 @@ class Preprocessor;
 
 namespace html {
 
+  /// \brief Remembers the highlighting that SyntaxHighlight and
+  /// HighlightMacros computed for each file, so that rendering the same file
+  /// again, e.g. for another report on it, does not lex and preprocess it
+  /// again. A cache is only valid for the preprocessor it was used with.
+  struct RelexRewriteCache;
+  typedef std::shared_ptr<RelexRewriteCache> RelexRewriteCacheRef;
+
+  /// \brief Creates an empty cache for SyntaxHighlight and HighlightMacros.
+  RelexRewriteCacheRef instantiateRelexRewriteCache();
+
   /// HighlightRange - Highlight a range in the source code with the specified
   /// start/end tags.  B/E must be in the same file.  This ensures that
   /// start/end tags are placed at the start/end of each line if the range is
@@ -67,13 +78,15 @@ namespace html {
 
   /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
   /// information about keywords, comments, etc.
-  void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP);
+  void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP,
+                       RelexRewriteCacheRef Cache = nullptr);
 
   /// HighlightMacros - This uses the macro table state from the end of the
   /// file, to reexpand macros and insert (into the HTML) information about the
   /// macro expansions.  This won't be perfectly perfect, but it will be
   /// reasonably close.
-  void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
+  void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP,
+                       RelexRewriteCacheRef Cache = nullptr);
 
 } // end html namespace
 } // end clang namespace
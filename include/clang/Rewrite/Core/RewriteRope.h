@@ -97,6 +97,9 @@ namespace clang {
   public:
     // begin iterator.
     RopePieceBTreeIterator(const void /*RopePieceBTreeNode*/ *N);
+    // iterator pointing to the byte at Offset, which must be in the tree.
+    RopePieceBTreeIterator(const void /*RopePieceBTreeNode*/ *N,
+                           unsigned Offset);
     // end iterator
     RopePieceBTreeIterator()
       : CurNode(nullptr), CurPiece(nullptr), CurChar(0) {}
@@ -127,6 +130,9 @@ namespace clang {
       return llvm::StringRef(&(*CurPiece)[0], CurPiece->size());
     }
 
+    /// getPieceOffset - Return the offset in piece() of the current byte.
+    unsigned getPieceOffset() const { return CurChar; }
+
     void MoveToNextPiece();
   };
 
@@ -145,6 +151,11 @@ namespace clang {
     typedef RopePieceBTreeIterator iterator;
     iterator begin() const { return iterator(Root); }
     iterator end() const { return iterator(); }
+    /// find - Return an iterator pointing to the byte at Offset, or end() if
+    /// Offset is the size of the tree.  This takes O(log N) time.
+    iterator find(unsigned Offset) const {
+      return Offset == size() ? end() : iterator(Root, Offset);
+    }
     unsigned size() const;
     unsigned empty() const { return size() == 0; }
 
@@ -181,6 +192,7 @@ public:
   typedef RopePieceBTree::iterator const_iterator;
   iterator begin() const { return Chunks.begin(); }
   iterator end() const  { return Chunks.end(); }
+  iterator find(unsigned Offset) const { return Chunks.find(Offset); }
   unsigned size() const { return Chunks.size(); }
 
   void clear() {
@@ -19,6 +19,7 @@
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/VersionTuple.h"
 #include "clang/Sema/Ownership.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
@@ -247,7 +248,6 @@ private:
       HasParsedType(false), HasProcessingCache(false),
       NextInPosition(nullptr), NextInPool(nullptr) {
     if (numArgs) memcpy(getArgsBuffer(), args, numArgs * sizeof(ArgsUnion));
-    AttrKind = getKind(getName(), getScopeName(), syntaxUsed);
   }
 
   /// Constructor for availability attributes.
@@ -270,7 +270,6 @@ private:
     memcpy(getArgsBuffer(), &PVal, sizeof(ArgsUnion));
     new (getAvailabilityData()) AvailabilityData(
         introduced, deprecated, obsoleted, strict, replacementExpr);
-    AttrKind = getKind(getName(), getScopeName(), syntaxUsed);
   }
 
   /// Constructor for objc_bridge_related attributes.
@@ -289,7 +288,6 @@ private:
     Args[0] = Parm1;
     Args[1] = Parm2;
     Args[2] = Parm3;
-    AttrKind = getKind(getName(), getScopeName(), syntaxUsed);
   }
   
   /// Constructor for type_tag_for_datatype attribute.
@@ -308,7 +306,6 @@ private:
     new (&ExtraData.MatchingCType) ParsedType(matchingCType);
     ExtraData.LayoutCompatible = layoutCompatible;
     ExtraData.MustBeNull = mustBeNull;
-    AttrKind = getKind(getName(), getScopeName(), syntaxUsed);
   }
 
   /// Constructor for attributes with a single type argument.
@@ -321,7 +318,6 @@ private:
         IsTypeTagForDatatype(false), IsProperty(false), HasParsedType(true),
         HasProcessingCache(false), NextInPosition(nullptr), NextInPool(nullptr){
     new (&getTypeBuffer()) ParsedType(typeArg);
-    AttrKind = getKind(getName(), getScopeName(), syntaxUsed);
   }
 
   /// Constructor for microsoft __declspec(property) attribute.
@@ -335,7 +331,6 @@ private:
       IsTypeTagForDatatype(false), IsProperty(true), HasParsedType(false),
       HasProcessingCache(false), NextInPosition(nullptr), NextInPool(nullptr) {
     new (&getPropertyDataBuffer()) PropertyData(getterId, setterId);
-    AttrKind = getKind(getName(), getScopeName(), syntaxUsed);
   }
 
   friend class AttributePool;
@@ -559,6 +554,12 @@ private:
 
   llvm::BumpPtrAllocator Alloc;
 
+  /// The kinds of the attributes created so far, keyed by the name, the
+  /// scope and the syntax used, so that each spelling is only matched once.
+  llvm::DenseMap<std::pair<std::pair<const IdentifierInfo *,
+                                     const IdentifierInfo *>, unsigned>,
+                 AttributeList::Kind> Kinds;
+
   /// Free lists.  The index is determined by the following formula:
   ///   (size - sizeof(AttributeList)) / sizeof(void*)
   SmallVector<AttributeList*, InlineFreeListsCapacity> FreeLists;
@@ -579,6 +580,12 @@ private:
 public:
   AttributeFactory();
   ~AttributeFactory();
+
+  /// \brief Determine the kind of an attribute, like AttributeList::getKind,
+  /// remembering the result for the next attribute with the same spelling.
+  AttributeList::Kind getKind(const IdentifierInfo *Name,
+                              const IdentifierInfo *Scope,
+                              AttributeList::Syntax SyntaxUsed);
 };
 
 class AttributePool {
@@ -590,6 +597,8 @@ class AttributePool {
   }
 
   AttributeList *add(AttributeList *attr) {
+    attr->AttrKind = Factory.getKind(attr->getName(), attr->getScopeName(),
+                                     AttributeList::Syntax(attr->SyntaxUsed));
     // We don't care about the order of the pool.
     attr->NextInPool = Head;
     Head = attr;
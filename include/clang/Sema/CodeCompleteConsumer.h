@@ -147,6 +147,14 @@ unsigned getMacroUsagePriority(StringRef MacroName,
 /// declaration.
 CXCursorKind getCursorKindForDecl(const Decl *D);
 
+/// \brief Determine whether a result named \p Name should be shown when the
+/// user has typed \p Filter.
+///
+/// The filter matches when its characters appear in \p Name in order,
+/// ignoring case, and its first character starts \p Name. An empty filter
+/// matches every name.
+bool isCodeCompletionFilterMatch(StringRef Filter, StringRef Name);
+
 class FunctionDecl;
 class FunctionType;
 class FunctionTemplateDecl;
@@ -763,6 +771,10 @@ public:
     return Keyword;
   }
 
+  /// \brief Whether the name of this result matches the partially typed
+  /// name \p Filter, without building its code-completion string.
+  bool matchesFilter(StringRef Filter) const;
+
   /// \brief Create a new code-completion string that describes how to insert
   /// this result into a program.
   ///
@@ -911,6 +923,9 @@ public:
     return CodeCompleteOpts.IncludeBriefComments;
   }
 
+  /// \brief The partially typed name that results must match, if any.
+  StringRef getFilter() const { return CodeCompleteOpts.Filter; }
+
   /// \brief Determine whether the output of this consumer is binary.
   bool isOutputBinary() const { return OutputIsBinary; }
 
@@ -10,6 +10,8 @@
 #ifndef LLVM_CLANG_SEMA_CODECOMPLETEOPTIONS_H
 #define LLVM_CLANG_SEMA_CODECOMPLETEOPTIONS_H
 
+#include <string>
+
 namespace clang {
 
 /// Options controlling the behavior of code completion.
@@ -27,6 +29,10 @@ public:
   /// Show brief documentation comments in code completion results.
   unsigned IncludeBriefComments : 1;
 
+  /// Only show results whose name matches this partially typed name, as
+  /// determined by \c isCodeCompletionFilterMatch().
+  std::string Filter;
+
   CodeCompleteOptions() :
       IncludeMacros(0),
       IncludeCodePatterns(0),
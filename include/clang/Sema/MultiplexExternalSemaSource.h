@@ -67,6 +67,9 @@ public:
   /// building a new declaration.
   Decl *GetExternalDecl(uint32_t ID) override;
 
+  /// \brief Resolve each of the given declaration IDs into a declaration.
+  void PrefetchExternalDecls(ArrayRef<uint32_t> IDs) override;
+
   /// \brief Complete the redeclaration chain if it's been extended since the
   /// previous generation of the AST source.
   void CompleteRedeclChain(const Decl *D) override;
@@ -183,6 +186,10 @@ public:
                  llvm::DenseMap<const CXXRecordDecl *,
                                 CharUnits> &VirtualBaseOffsets) override;
 
+  /// \brief Load the complete layout of the given record type from the first
+  /// source that has it.
+  const ASTRecordLayout *loadRecordLayout(const RecordDecl *Record) override;
+
   /// Return the amount of memory used by memory buffers, breaking down
   /// by heap-backed versus mmap'ed memory.
   void getMemoryBufferSizes(MemoryBufferSizes &sizes) const override;
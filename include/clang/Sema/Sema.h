@@ -45,6 +45,7 @@
 #include "clang/Sema/Ownership.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/ScopeInfo.h"
+#include "clang/Sema/TemplateProfiler.h"
 #include "clang/Sema/TypoCorrection.h"
 #include "clang/Sema/Weak.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -208,6 +209,10 @@ namespace sema {
   class TemplateDeductionInfo;
 }
 
+namespace analyze_format_string {
+  class PrintfStringCache;
+}
+
 namespace threadSafety {
   class BeforeSet;
   void threadSafetyCleanup(BeforeSet* Cache);
@@ -968,6 +973,24 @@ public:
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief The number of function and variable definitions instantiated by
+  /// PerformPendingInstantiations, and the largest number of instantiations
+  /// that were pending at once.
+  unsigned NumPendingFunctionInstantiations = 0;
+  unsigned NumPendingVariableInstantiations = 0;
+  unsigned MaxPendingInstantiations = 0;
+
+  /// \brief The number of function candidates considered by overload
+  /// resolution, and of those, the number rejected for their number of
+  /// parameters and the number for which template argument deduction
+  /// failed, before any conversion sequence was computed.
+  unsigned NumOverloadCandidates = 0;
+  unsigned NumOverloadCandidatesBadArity = 0;
+  unsigned NumOverloadCandidatesBadDeduction = 0;
+
+  /// \brief The number of attributes applied to declarations.
+  unsigned NumDeclAttributesProcessed = 0;
+
   typedef llvm::DenseMap<ParmVarDecl *, llvm::TinyPtrVector<ParmVarDecl *>>
     UnparsedDefaultArgInstantiationsMap;
 
@@ -6873,6 +6896,10 @@ public:
   SmallVector<ActiveTemplateInstantiation, 16>
     ActiveTemplateInstantiations;
 
+  /// \brief The costs of the instantiations of each template, recorded for
+  /// -ftemplate-profile; null unless that was given.
+  std::unique_ptr<TemplateProfiler> TemplateProfile;
+
   /// Specializations whose definitions are currently being instantiated.
   llvm::DenseSet<std::pair<Decl *, unsigned>> InstantiatingSpecializations;
 
@@ -7172,6 +7199,13 @@ public:
   /// \brief The number of typos corrected by CorrectTypo.
   unsigned TyposCorrected;
 
+  /// \brief The number of names considered as typo corrections.
+  unsigned NumTypoCorrectionCandidates;
+
+  /// \brief The wall time, in seconds, spent in CorrectTypo and
+  /// CorrectTypoDelayed.
+  double TypoCorrectionTime;
+
   typedef llvm::SmallSet<SourceLocation, 2> SrcLocSet;
   typedef llvm::DenseMap<IdentifierInfo *, SrcLocSet> IdentifierSourceLocations;
 
@@ -9986,6 +10020,10 @@ public:
 
   static bool GetFormatNSStringIdx(const FormatAttr *Format, unsigned &Idx);
 
+  /// The printf format strings checked so far, so that each distinct string
+  /// is only parsed once.
+  std::unique_ptr<analyze_format_string::PrintfStringCache> PrintfStrings;
+
 private:
   bool CheckFormatArguments(const FormatAttr *Format,
                             ArrayRef<const Expr *> Args,
@@ -123,7 +123,8 @@ public:
                          std::unique_ptr<CorrectionCandidateCallback> CCC,
                          DeclContext *MemberContext,
                          bool EnteringContext)
-      : Typo(TypoName.getName().getAsIdentifierInfo()), CurrentTCIndex(0),
+      : Typo(TypoName.getName().getAsIdentifierInfo()), TypoCharCounts(),
+        CurrentTCIndex(0),
         SavedTCIndex(0), SemaRef(SemaRef), S(S),
         SS(SS ? llvm::make_unique<CXXScopeSpec>(*SS) : nullptr),
         CorrectionValidator(std::move(CCC)), MemberContext(MemberContext),
@@ -131,6 +132,8 @@ public:
         Namespaces(SemaRef.Context, SemaRef.CurContext, SS),
         EnteringContext(EnteringContext), SearchNamespaces(false) {
     Result.suppressDiagnostics();
+    for (unsigned char C : Typo->getName())
+      ++TypoCharCounts[C];
     // Arrange for ValidatedCorrections[0] to always be an empty correction.
     ValidatedCorrections.push_back(TypoCorrection());
   }
@@ -318,6 +321,10 @@ private:
   /// \brief The name written that is a typo in the source.
   IdentifierInfo *Typo;
 
+  /// \brief The number of occurrences of each character in the typo, used to
+  /// reject candidate names without computing their edit distance.
+  int TypoCharCounts[256];
+
   /// \brief The results found that have the smallest edit distance
   /// found (so far) with the typo name.
   ///
@@ -0,0 +1,101 @@
+//===--- TemplateProfiler.h - Cost of Template Instantiations ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the TemplateProfiler class, which attributes the cost of
+//  instantiating template definitions to the templates, for
+//  -ftemplate-profile.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_TEMPLATEPROFILER_H
+#define LLVM_CLANG_SEMA_TEMPLATEPROFILER_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <chrono>
+
+namespace clang {
+
+class ASTContext;
+class NamedDecl;
+class SourceManager;
+
+/// \brief Records, for each template, how often its definition was
+/// instantiated, where from, and how much time and AST memory that took.
+class TemplateProfiler {
+  typedef std::chrono::steady_clock ClockType;
+  typedef std::chrono::microseconds DurationType;
+
+  struct TemplateCost {
+    unsigned Count = 0;
+    /// Time spent instantiating the template, including the instantiations
+    /// it triggered.
+    DurationType Time = DurationType::zero();
+    /// Time spent instantiating the template, excluding the instantiations
+    /// it triggered.
+    DurationType SelfTime = DurationType::zero();
+    /// AST memory allocated while instantiating the template, excluding the
+    /// instantiations it triggered.
+    size_t SelfBytes = 0;
+    /// The number of instantiations from each point of instantiation.
+    llvm::DenseMap<unsigned, unsigned> Sites;
+  };
+
+  struct ActiveInstantiation {
+    const NamedDecl *Pattern;
+    ClockType::time_point Start;
+    size_t StartBytes;
+    DurationType NestedTime;
+    size_t NestedBytes;
+  };
+
+  ASTContext &Context;
+  llvm::DenseMap<const NamedDecl *, TemplateCost> Costs;
+  SmallVector<ActiveInstantiation, 16> Active;
+
+public:
+  explicit TemplateProfiler(ASTContext &Context) : Context(Context) {}
+
+  /// \brief Note the start of the instantiation of a definition from
+  /// \p Pattern at \p PointOfInstantiation.
+  void begin(const NamedDecl *Pattern, SourceLocation PointOfInstantiation);
+
+  /// \brief Note the end of the instantiation started last.
+  void end();
+
+  /// \brief Print the costs as a table, costliest template first.
+  void print(raw_ostream &OS, const SourceManager &SM) const;
+
+  /// \brief Profiles a template instantiation for the lifetime of the
+  /// object, if \p Profiler is non-null.
+  class Scope {
+    TemplateProfiler *Profiler;
+
+    Scope(const Scope &) = delete;
+    void operator=(const Scope &) = delete;
+
+  public:
+    Scope(TemplateProfiler *Profiler, const NamedDecl *Pattern,
+          SourceLocation PointOfInstantiation)
+        : Profiler(Profiler) {
+      if (Profiler)
+        Profiler->begin(Pattern, PointOfInstantiation);
+    }
+    ~Scope() {
+      if (Profiler)
+        Profiler->end();
+    }
+  };
+};
+
+} // end namespace clang
+
+#endif
@@ -41,6 +41,7 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Timer.h"
 #include <deque>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -817,6 +818,16 @@ private:
   /// \brief Extensions required by an OpenCL declaration.
   llvm::DenseMap<const Decl *, std::set<std::string>> OpenCLDeclExtMap;
 
+  /// \brief The layouts of record types stored in the loaded AST files,
+  /// keyed by the global ID of the record's definition.
+  ///
+  /// Each layout is kept as it was read from the RECORD_LAYOUTS record of the
+  /// given module file, until loadRecordLayout turns it into an
+  /// ASTRecordLayout.
+  llvm::DenseMap<serialization::DeclID,
+                 std::pair<ModuleFile *, SmallVector<uint64_t, 16>>>
+      RecordLayouts;
+
   /// \brief A list of the namespaces we've seen.
   SmallVector<uint64_t, 4> KnownNamespaces;
 
@@ -875,6 +886,9 @@ private:
   ///\brief Whether we are currently processing update records.
   bool ProcessingUpdateRecords;
 
+  /// \brief Whether to record the AST file pages read, for -print-stats.
+  bool CountPagesRead;
+
   typedef llvm::DenseMap<unsigned, SwitchCase *> SwitchCaseMapTy;
   /// \brief Mapping from switch-case IDs in the chain to switch-case statements
   ///
@@ -891,6 +905,13 @@ private:
   /// \brief The number of source location entries in the chain.
   unsigned TotalNumSLocEntries;
 
+  /// \brief The number of compressed file buffers embedded in the chain that
+  /// have been decompressed, and their total compressed and uncompressed
+  /// sizes.
+  unsigned NumBuffersDecompressed;
+  uint64_t NumCompressedBufferBytes;
+  uint64_t NumDecompressedBufferBytes;
+
   /// \brief The number of statements (and expressions) de-serialized
   /// from the chain.
   unsigned NumStatementsRead;
@@ -905,6 +926,12 @@ private:
   /// \brief The total number of macros stored in the chain.
   unsigned TotalNumMacros;
 
+  /// \brief The number of record layouts de-serialized from the chain.
+  unsigned NumRecordLayoutsRead;
+
+  /// \brief The total number of record layouts stored in the chain.
+  unsigned TotalNumRecordLayouts;
+
   /// \brief The number of lookups into identifier tables.
   unsigned NumIdentifierLookups;
 
@@ -1243,6 +1270,14 @@ private:
   RecordLocation getLocalBitOffset(uint64_t GlobalOffset);
   uint64_t getGlobalBitOffset(ModuleFile &M, uint32_t LocalOffset);
 
+  /// \brief Note that a record at \p BitOffset in \p F is being read, for the
+  /// count of AST file pages touched.
+  void noteRecordRead(ModuleFile &F, uint64_t BitOffset) {
+    if (CountPagesRead)
+      notePageRead(F, BitOffset);
+  }
+  void notePageRead(ModuleFile &F, uint64_t BitOffset);
+
   /// \brief Returns the first preprocessed entity ID that begins or ends after
   /// \arg Loc.
   serialization::PreprocessedEntityID
@@ -1701,6 +1736,10 @@ public:
   Decl *GetDecl(serialization::DeclID ID);
   Decl *GetExternalDecl(uint32_t ID) override;
 
+  /// \brief Load the declarations with the given IDs in the order of their
+  /// records in the AST files.
+  void PrefetchExternalDecls(ArrayRef<uint32_t> IDs) override;
+
   /// \brief Resolve a declaration ID into a declaration. Return 0 if it's not
   /// been loaded yet.
   Decl *GetExistingDecl(serialization::DeclID ID);
@@ -1799,6 +1838,10 @@ public:
   void FindFileRegionDecls(FileID File, unsigned Offset, unsigned Length,
                            SmallVectorImpl<Decl *> &Decls) override;
 
+  /// \brief Load the layout of a record type defined in an AST file that was
+  /// built with its record layouts.
+  const ASTRecordLayout *loadRecordLayout(const RecordDecl *Record) override;
+
   /// \brief Notify ASTReader that we started deserialization of
   /// a decl or type so until FinishedDeserializing is called there may be
   /// decls that are initializing. Must be paired with FinishedDeserializing.
@@ -2057,11 +2100,20 @@ public:
   /// location space into ours.
   SourceLocation TranslateSourceLocation(ModuleFile &ModuleFile,
                                          SourceLocation Loc) const {
-    assert(ModuleFile.SLocRemap.find(Loc.getOffset()) !=
-               ModuleFile.SLocRemap.end() &&
-           "Cannot find offset to remap.");
-    int Remap = ModuleFile.SLocRemap.find(Loc.getOffset())->second;
-    return Loc.getLocWithOffset(Remap);
+    uint32_t Offset = Loc.getOffset();
+    auto &Last = ModuleFile.LastSLocRemap;
+    if (Offset < Last.Begin || Offset >= Last.End) {
+      auto I = ModuleFile.SLocRemap.find(Offset);
+      assert(I != ModuleFile.SLocRemap.end() &&
+             "Cannot find offset to remap.");
+      auto Next = I + 1;
+      Last.Begin = I->first;
+      Last.End = Next == ModuleFile.SLocRemap.end()
+                     ? std::numeric_limits<uint32_t>::max()
+                     : Next->first;
+      Last.Offset = I->second;
+    }
+    return Loc.getLocWithOffset(Last.Offset);
   }
 
   /// \brief Read a source location.
@@ -127,6 +127,11 @@ private:
   /// file is up to date, but not otherwise.
   bool IncludeTimestamps;
 
+  /// \brief Indicates whether the layouts of the record types defined in the
+  /// produced AST file should be written to it, so that the translation units
+  /// importing it don't have to compute them again.
+  bool SerializeRecordLayouts;
+
   /// \brief Indicates when the AST writing is actively performing
   /// serialization, rather than just queueing updates.
   bool WritingAST;
@@ -364,6 +369,10 @@ private:
   /// record.
   SmallVector<uint64_t, 16> EagerlyDeserializedDecls;
 
+  /// \brief The record type definitions whose layouts will be written to a
+  /// RECORD_LAYOUTS record, if we are serializing record layouts.
+  SmallVector<const RecordDecl *, 16> RecordsToLayOut;
+
   /// \brief DeclContexts that have received extensions since their serialized
   /// form.
   ///
@@ -462,6 +471,7 @@ private:
   void WriteOpenCLExtensionTypes(Sema &SemaRef);
   void WriteOpenCLExtensionDecls(Sema &SemaRef);
   void WriteCUDAPragmas(Sema &SemaRef);
+  void WriteRecordLayouts(ASTContext &Context);
   void WriteObjCCategories();
   void WriteLateParsedTemplates(Sema &SemaRef);
   void WriteOptimizePragmaOptions(Sema &SemaRef);
@@ -499,7 +509,8 @@ public:
   /// the given bitstream.
   ASTWriter(llvm::BitstreamWriter &Stream,
             ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-            bool IncludeTimestamps = true);
+            bool IncludeTimestamps = true,
+            bool SerializeRecordLayouts = false);
   ~ASTWriter() override;
 
   const LangOptions &getLangOpts() const;
@@ -940,7 +951,8 @@ public:
     std::shared_ptr<PCHBuffer> Buffer,
     ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
     bool AllowASTWithErrors = false,
-    bool IncludeTimestamps = true);
+    bool IncludeTimestamps = true,
+    bool SerializeRecordLayouts = false);
   ~PCHGenerator() override;
   void InitializeSema(Sema &S) override { SemaPtr = &S; }
   void HandleTranslationUnit(ASTContext &Ctx) override;
@@ -20,6 +20,7 @@
 #include "clang/Serialization/ASTBitCodes.h"
 #include "clang/Serialization/ContinuousRangeMap.h"
 #include "clang/Serialization/ModuleFileExtension.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/Endian.h"
@@ -170,6 +171,10 @@ public:
   /// \brief The size of this file, in bits.
   uint64_t SizeInBits;
 
+  /// \brief The pages of this file in which records have been read, so that
+  /// -print-stats can report how much of it is actually used.
+  llvm::BitVector PagesRead;
+
   /// \brief The global bit offset (or base) of this module
   uint64_t GlobalBitOffset;
 
@@ -216,6 +221,11 @@ public:
   /// The time is specified in seconds since the start of the Epoch.
   uint64_t InputFilesValidationTimestamp;
 
+  /// \brief Whether this module file is listed in the trusted module manifest
+  /// with its signature, so that its input files need not be checked for
+  /// changes.
+  bool InputFilesTrusted;
+
   // === Source Locations ===
 
   /// \brief Cursor used to read source location entries.
@@ -230,6 +240,9 @@ public:
   /// \brief The base offset in the source manager's view of this module.
   unsigned SLocEntryBaseOffset;
 
+  /// \brief The amount of source location address space used by this module.
+  unsigned SLocSpaceSize;
+
   /// \brief Offsets for all of the source location entries in the
   /// AST file.
   const uint32_t *SLocEntryOffsets;
@@ -240,6 +253,24 @@ public:
   /// \brief Remapping table for source locations in this module.
   ContinuousRangeMap<uint32_t, int, 2> SLocRemap;
 
+  /// \brief The range of SLocRemap that was used last, [Begin, End), and
+  /// its offset.
+  ///
+  /// Consecutive locations in a record nearly always fall in the same range,
+  /// so this saves a search per location. It is empty when Begin > End.
+  struct {
+    uint32_t Begin, End;
+    int Offset;
+  } LastSLocRemap;
+
+  /// \brief Forget the range of SLocRemap that was used last; called whenever
+  /// SLocRemap changes.
+  void clearLastSLocRemap() {
+    LastSLocRemap.Begin = 1;
+    LastSLocRemap.End = 0;
+    LastSLocRemap.Offset = 0;
+  }
+
   // === Identifiers ===
 
   /// \brief The number of identifiers in this AST file.
@@ -19,6 +19,12 @@
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+
+namespace llvm {
+class ThreadPool;
+}
 
 namespace clang { 
 
@@ -57,6 +63,26 @@ class ModuleManager {
   llvm::DenseMap<const FileEntry *, std::unique_ptr<llvm::MemoryBuffer>>
       InMemoryBuffers;
 
+  /// \brief A module file being read on another thread ahead of loading it.
+  struct PrefetchedFile;
+
+  /// \brief Module files whose contents are being read ahead of time, so that
+  /// the I/O for all of a module's imports overlaps with loading the first.
+  llvm::DenseMap<const FileEntry *, std::shared_ptr<PrefetchedFile>>
+      PrefetchedFiles;
+
+  /// \brief The threads reading PrefetchedFiles, created on first use.
+  std::unique_ptr<llvm::ThreadPool> PrefetchThreads;
+
+  /// \brief Take the contents of \p Entry read by prefetchModuleFile, if they
+  /// are still those of the file.
+  std::unique_ptr<llvm::MemoryBuffer>
+  takePrefetchedBuffer(const FileEntry *Entry);
+
+  /// \brief The signatures of the module files listed in the trusted module
+  /// manifest, indexed by the name used to load them.
+  llvm::StringMap<ASTFileSignature> TrustedSignatures;
+
   /// \brief The visitation order.
   SmallVector<ModuleFile *, 4> VisitOrder;
       
@@ -229,6 +255,20 @@ public:
   void addInMemoryBuffer(StringRef FileName,
                          std::unique_ptr<llvm::MemoryBuffer> Buffer);
 
+  /// \brief Start reading the module file \p FileName on another thread, if
+  /// it isn't loaded already, so that a later addModule for it doesn't have to
+  /// wait for the I/O.
+  void prefetchModuleFile(StringRef FileName);
+
+  /// \brief Read a trusted module manifest: each line holds the signature of
+  /// a module file followed by its name. Module files loaded by that name
+  /// must have that signature, and their input files are not validated.
+  /// Signatures must be nonzero; module files written without one, such as
+  /// explicitly built modules, are always validated.
+  ///
+  /// \returns true on success; otherwise \p ErrorStr describes the problem.
+  bool readTrustedManifest(StringRef FileName, std::string &ErrorStr);
+
   /// \brief Set the global module index.
   void setGlobalIndex(GlobalModuleIndex *Index);
 
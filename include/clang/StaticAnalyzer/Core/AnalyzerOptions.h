@@ -121,6 +121,26 @@ enum IPAKind {
   IPAK_DynamicDispatchBifurcate = 5
 };
 
+/// \brief Describes the order in which the paths through a function are
+/// explored.
+enum ExplorationStrategyKind {
+  ESK_NotSet = 0,
+
+  /// Explore the most recently reached program point first.
+  ESK_DFS = 1,
+
+  /// Explore the program points in the order they were reached.
+  ESK_BFS = 2,
+
+  /// Explore the basic blocks in the order they were reached, but each basic
+  /// block to completion before moving on to the next one.
+  ESK_BFSBlockDFSContents = 3,
+
+  /// Explore the basic blocks which haven't been visited yet first, then those
+  /// visited the fewest times along their path.
+  ESK_CoverageGuided = 4
+};
+
 class AnalyzerOptions : public RefCountedBase<AnalyzerOptions> {
 public:
   typedef llvm::StringMap<std::string> ConfigTable;
@@ -202,6 +222,10 @@ private:
   /// Controls the mode of inter-procedural analysis.
   IPAKind IPAMode;
 
+  /// Controls the order in which paths are explored.
+  /// \sa getExplorationStrategy
+  ExplorationStrategyKind ExplorationStrategy;
+
   /// Controls which C++ member functions will be considered for inlining.
   CXXInlineableMemberKind CXXMemberInliningMode;
   
@@ -254,6 +278,9 @@ private:
   /// \sa getGraphTrimInterval
   Optional<unsigned> GraphTrimInterval;
 
+  /// \sa shouldTrimGraphAggressively
+  Optional<bool> TrimGraphAggressively;
+
   /// \sa getMaxTimesInlineLarge
   Optional<unsigned> MaxTimesInlineLarge;
 
@@ -263,6 +290,9 @@ private:
   /// \sa getMaxNodesPerTopLevelFunction
   Optional<unsigned> MaxNodesPerTopLevelFunction;
 
+  /// \sa getMaxLoadedCTUs
+  Optional<unsigned> MaxLoadedCTUs;
+
   /// \sa shouldInlineLambdas
   Optional<bool> InlineLambdas;
 
@@ -377,6 +407,14 @@ public:
   /// \brief Returns the inter-procedural analysis mode.
   IPAKind getIPAMode();
 
+  /// \brief Returns the order in which the paths through a function are
+  /// explored.
+  ///
+  /// This is controlled by the 'exploration-strategy' option, one of 'dfs',
+  /// 'bfs', 'bfs-block-dfs-contents' and 'coverage-guided', which defaults to
+  /// 'dfs' when unset.
+  ExplorationStrategyKind getExplorationStrategy();
+
   /// Returns the option controlling which C++ member functions will be
   /// considered for inlining.
   ///
@@ -513,6 +551,14 @@ public:
   /// node reclamation, set the option to "0".
   unsigned getGraphTrimInterval();
 
+  /// Returns true if the recycling of ExplodedGraph nodes should also reclaim
+  /// the nodes which don't change the program state but would make
+  /// diagnostics more precise.
+  ///
+  /// This is controlled by the 'graph-trim-aggressive' config option, which
+  /// defaults to false when unset.
+  bool shouldTrimGraphAggressively();
+
   /// Returns the maximum times a large function could be inlined.
   ///
   /// This is controlled by the 'max-times-inline-large' config option.
@@ -548,6 +594,52 @@ public:
   /// to false when unset.
   bool shouldDisplayNotesAsEvents();
 
+  /// Returns the directory in which the analyses of different translation
+  /// units share summaries of the functions they define, or an empty string
+  /// if summaries aren't shared.
+  ///
+  /// This is controlled by the 'summaries-dir' option, which is unset by
+  /// default.
+  StringRef getSummariesDir();
+
+  /// Returns the directory in which each analysis records the fingerprints
+  /// of the functions it checks, so that the next analysis of the same
+  /// translation unit can skip the unchanged ones, or an empty string if every
+  /// function is always analyzed.
+  ///
+  /// This is controlled by the 'incremental-dir' option, which is unset by
+  /// default.
+  StringRef getIncrementalDir();
+
+  /// Returns the directory in which each analysis writes the call graph of
+  /// its translation unit, for composing whole-program call graphs, or an
+  /// empty string if the call graphs aren't written.
+  ///
+  /// This is controlled by the 'callgraph-dir' option, which is unset by
+  /// default.
+  StringRef getCallGraphDir();
+
+  /// Returns the directory which holds the index and the ASTs used to inline
+  /// functions defined in other translation units, or an empty string if
+  /// only the functions of this translation unit are inlined.
+  ///
+  /// This is controlled by the 'ctu-dir' option, which is unset by default.
+  StringRef getCTUDir();
+
+  /// Returns the name of the index file in the 'ctu-dir' directory, which
+  /// maps the USRs of functions to the ASTs which define them.
+  ///
+  /// This is controlled by the 'ctu-index-name' option, which defaults to
+  /// "externalFnMap.txt".
+  StringRef getCTUIndexName();
+
+  /// Returns the maximum number of ASTs of other translation units which are
+  /// kept in memory at the same time.
+  ///
+  /// This is controlled by the 'ctu-max-loaded-tus' option, which defaults
+  /// to 8.
+  unsigned getMaxLoadedCTUs();
+
 public:
   AnalyzerOptions() :
     AnalysisStoreOpt(RegionStoreModel),
@@ -572,6 +664,7 @@ public:
     InliningMode(NoRedundancy),
     UserMode(UMK_NotSet),
     IPAMode(IPAK_NotSet),
+    ExplorationStrategy(ESK_NotSet),
     CXXMemberInliningMode() {}
 
 };
@@ -28,6 +28,10 @@
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
 
+namespace llvm {
+class Timer;
+}
+
 namespace clang {
 
 class ASTContext;
@@ -396,6 +400,10 @@ public:
   virtual ASTContext &getASTContext() = 0;
   virtual SourceManager& getSourceManager() = 0;
   virtual AnalyzerOptions& getAnalyzerOptions() = 0;
+
+  /// Returns the timer for the generation of path diagnostics, if they are
+  /// to be timed.
+  virtual llvm::Timer *getPathGenerationTimer() { return nullptr; }
 };
 
 /// BugReporter is a utility class for generating PathDiagnostics for analysis.
@@ -501,12 +509,24 @@ private:
                              StringRef category);
 };
 
+class TrimmedGraphData;
+
 // FIXME: Get rid of GRBugReporter.  It's the wrong abstraction.
 class GRBugReporter : public BugReporter {
   ExprEngine& Eng;
+
+  /// The trimmed graph of the error nodes of all the equivalence classes,
+  /// shared by their path generation.
+  std::unique_ptr<TrimmedGraphData> SharedTrimmedGraph;
+  bool TriedSharedTrimmedGraph = false;
+
+  /// Returns the trimmed graph of the error nodes of all the equivalence
+  /// classes, creating it on first use, or null if there's no point in
+  /// sharing one.
+  const TrimmedGraphData *getSharedTrimmedGraph();
+
 public:
-  GRBugReporter(BugReporterData& d, ExprEngine& eng)
-    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+  GRBugReporter(BugReporterData& d, ExprEngine& eng);
 
   ~GRBugReporter() override;
 
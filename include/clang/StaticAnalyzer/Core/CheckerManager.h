@@ -572,8 +572,12 @@ private:
   std::vector<StmtCheckerInfo> StmtCheckers;
 
   typedef SmallVector<CheckStmtFunc, 4> CachedStmtCheckers;
-  typedef llvm::DenseMap<unsigned, CachedStmtCheckers> CachedStmtCheckersMapTy;
-  CachedStmtCheckersMapTy CachedStmtCheckersMap;
+
+  /// The checkers to run for each statement class, before and after the
+  /// statement, indexed by getCachedStmtCheckersFor. Each entry is computed
+  /// the first time a statement of its class is visited.
+  std::vector<CachedStmtCheckers> CachedStmtCheckersTable;
+  std::vector<bool> CachedStmtCheckersComputed;
 
   const CachedStmtCheckers &getCachedStmtCheckersFor(const Stmt *S,
                                                      bool isPreVisit);
@@ -20,11 +20,17 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Timer.h"
 
 namespace clang {
 
 class CodeInjector;
 
+namespace cross_tu {
+class CrossTranslationUnitContext;
+}
+
 namespace ento {
   class CheckerManager;
 
@@ -43,6 +49,17 @@ class AnalysisManager : public BugReporterData {
 
   CheckerManager *CheckerMgr;
 
+  /// Functions without a body here which the analysis of another translation
+  /// unit found to have no side effects.
+  llvm::DenseSet<const Decl *> SideEffectFreeFunctions;
+
+  /// Loads the definitions of functions from other translation units, if
+  /// they are to be inlined.
+  cross_tu::CrossTranslationUnitContext *CTUCtx = nullptr;
+
+  /// Times the generation of path diagnostics under -analyzer-stats.
+  std::unique_ptr<llvm::Timer> PathGenerationTimer;
+
 public:
   AnalyzerOptions &options;
   
@@ -99,6 +116,10 @@ public:
     return PathConsumers;
   }
 
+  llvm::Timer *getPathGenerationTimer() override {
+    return PathGenerationTimer.get();
+  }
+
   void FlushDiagnostics();
 
   bool shouldVisualize() const {
@@ -126,6 +147,24 @@ public:
   AnalysisDeclContext *getAnalysisDeclContext(const Decl *D) {
     return AnaCtxMgr.getContext(D);
   }
+
+  void addSideEffectFreeFunction(const FunctionDecl *FD) {
+    SideEffectFreeFunctions.insert(FD->getCanonicalDecl());
+  }
+
+  /// Returns true if calls to \p D don't need to invalidate anything.
+  bool isSideEffectFreeFunction(const Decl *D) const {
+    return D && SideEffectFreeFunctions.count(D->getCanonicalDecl());
+  }
+
+  void setCrossTranslationUnitContext(
+      cross_tu::CrossTranslationUnitContext *Ctx) {
+    CTUCtx = Ctx;
+  }
+
+  cross_tu::CrossTranslationUnitContext *getCrossTranslationUnitContext() {
+    return CTUCtx;
+  }
 };
 
 } // enAnaCtxMgrspace
@@ -284,6 +284,10 @@ protected:
   /// Counter to determine when to reclaim nodes.
   unsigned ReclaimCounter;
 
+  /// Whether to also reclaim nodes which are only kept around to make
+  /// diagnostics more precise.
+  bool AggressiveReclamation;
+
 public:
 
   /// \brief Retrieve the node associated with a (Location,State) pair,
@@ -386,8 +390,12 @@ public:
 
   /// Enable tracking of recently allocated nodes for potential reclamation
   /// when calling reclaimRecentlyAllocatedNodes().
-  void enableNodeReclamation(unsigned Interval) {
+  ///
+  /// With \p Aggressive, nodes which don't change the program state are
+  /// reclaimed even when they would make diagnostics more precise.
+  void enableNodeReclamation(unsigned Interval, bool Aggressive = false) {
     ReclaimCounter = ReclaimNodeInterval = Interval;
+    AggressiveReclamation = Aggressive;
   }
 
   /// Reclaim "uninteresting" nodes created since the last time this method
@@ -523,6 +523,10 @@ protected:
   /// Call PointerEscape callback when a value escapes as a result of bind.
   ProgramStateRef processPointerEscapedOnBind(ProgramStateRef State,
                                               SVal Loc, SVal Val) override;
+  /// Call PointerEscape callback for the symbols reachable from the arguments
+  /// of a call that is evaluated without invalidating any regions.
+  ProgramStateRef processPointerEscapedOnCall(ProgramStateRef State,
+                                              const CallEvent &Call);
   /// Call PointerEscape callback when a value escapes as a result of
   /// region invalidation.
   /// \param[in] ITraits Specifies invalidation traits for regions/symbols.
@@ -102,6 +102,14 @@ public:
     Blocks.set(ID);
   }
 
+  bool isVisitedBasicBlock(unsigned ID, const Decl *D) const {
+    MapTy::const_iterator I = Map.find(D);
+    if (I != Map.end())
+      return ID < I->second.VisitedBasicBlocks.size() &&
+             I->second.VisitedBasicBlocks.test(ID);
+    return false;
+  }
+
   unsigned getNumVisitedBasicBlocks(const Decl* D) {
     MapTy::const_iterator I = Map.find(D);
     if (I != Map.end())
@@ -25,6 +25,8 @@ class CFGBlock;
 
 namespace ento {
 
+class FunctionSummariesTy;
+
 class WorkListUnit {
   ExplodedNode *node;
   BlockCounter counter;
@@ -91,6 +93,7 @@ public:
   static WorkList *makeDFS();
   static WorkList *makeBFS();
   static WorkList *makeBFSBlockDFSContents();
+  static WorkList *makeCoverageGuided(const FunctionSummariesTy &FS);
 };
 
 } // end GR namespace
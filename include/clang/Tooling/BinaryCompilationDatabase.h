@@ -0,0 +1,103 @@
+//===--- BinaryCompilationDatabase.h - ---------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  The BinaryCompilationDatabase finds compilation databases supplied as a
+//  file 'compile_commands.bin'.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_BINARYCOMPILATIONDATABASE_H
+#define LLVM_CLANG_TOOLING_BINARYCOMPILATIONDATABASE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tooling {
+
+/// \brief A compilation database in a compact binary file, which can be
+/// queried without reading all of it.
+///
+/// The file is memory mapped. It holds every distinct string once, the
+/// compile commands as lists of references to those strings, and an on-disk
+/// hash table from file paths to the commands for them. Loading the database
+/// only checks the header, and a lookup only reads the commands it returns.
+///
+/// Binary databases are written from any other compilation database with
+/// \c writeToFile(). A 'compile_commands.bin' is ignored while there is a
+/// newer 'compile_commands.json' next to it.
+class BinaryCompilationDatabase : public CompilationDatabase {
+public:
+  class OnDiskTable;
+
+  ~BinaryCompilationDatabase() override;
+
+  /// \brief Loads a binary compilation database from the specified file.
+  ///
+  /// Returns NULL and sets ErrorMessage if the database could not be
+  /// loaded from the given file.
+  static std::unique_ptr<BinaryCompilationDatabase>
+  loadFromFile(StringRef FilePath, std::string &ErrorMessage);
+
+  /// \brief Loads the 'compile_commands.bin' in \p Directory, unless there
+  /// is a newer 'compile_commands.json' next to it.
+  ///
+  /// The JSON compilation database plugin tries this before reading the JSON
+  /// file, so that a binary database always takes precedence.
+  ///
+  /// Returns NULL and sets ErrorMessage if there is no such database or it
+  /// could not be loaded.
+  static std::unique_ptr<BinaryCompilationDatabase>
+  loadFromDirectory(StringRef Directory, std::string &ErrorMessage);
+
+  /// \brief Writes all compile commands of \p Database to \p FilePath as a
+  /// binary compilation database.
+  ///
+  /// Returns true and sets ErrorMessage if the file could not be written.
+  static bool writeToFile(const CompilationDatabase &Database,
+                          StringRef FilePath, std::string &ErrorMessage);
+
+  /// \brief Returns all compile commands in which the specified file was
+  /// compiled.
+  ///
+  /// Unlike the JSON compilation database, \p FilePath must be spelled like
+  /// the file of the command, made absolute against its directory.
+  std::vector<CompileCommand>
+  getCompileCommands(StringRef FilePath) const override;
+
+  /// \brief Returns the list of all files available in the compilation database.
+  std::vector<std::string> getAllFiles() const override;
+
+  /// \brief Returns all compile commands for all the files in the compilation
+  /// database.
+  std::vector<CompileCommand> getAllCompileCommands() const override;
+
+private:
+  BinaryCompilationDatabase(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                            std::unique_ptr<OnDiskTable> Table);
+
+  /// \brief Returns the string with the given index in the string table.
+  StringRef getString(uint32_t Index) const;
+
+  /// \brief Reads the command at \p Offset in the file.
+  CompileCommand readCommand(uint32_t Offset) const;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<OnDiskTable> Table;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif
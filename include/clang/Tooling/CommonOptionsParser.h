@@ -102,11 +102,16 @@ public:
     return SourcePathList;
   }
 
+  /// Returns the number of translation units to process concurrently, as
+  /// requested with -j.
+  unsigned getNumThreads() const { return NumThreads; }
+
   static const char *const HelpMessage;
 
 private:
   std::unique_ptr<CompilationDatabase> Compilations;
   std::vector<std::string> SourcePathList;
+  unsigned NumThreads = 1;
   std::vector<std::string> ExtraArgsBefore;
   std::vector<std::string> ExtraArgsAfter;
 };
@@ -253,6 +253,16 @@ class Replacements {
   /// category of replacements.
   llvm::Error add(const Replacement &R);
 
+  /// \brief Adds all of \p NewReplaces, which may be in any order, as if by
+  /// calling add() for each of them.
+  ///
+  /// The replacements are sorted once, and each one that doesn't overlap the
+  /// ones before it is appended directly, so adding many replacements to an
+  /// empty set takes O(n log n) time. Returns the error of the first
+  /// replacement, in offset order, that fails to be added; the ones before it
+  /// remain added.
+  llvm::Error addAll(std::vector<Replacement> NewReplaces);
+
   /// \brief Merges \p Replaces into the current replacements. \p Replaces
   /// refers to code after applying the current replacements.
   Replacements merge(const Replacements &Replaces) const;
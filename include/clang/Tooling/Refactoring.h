@@ -45,6 +45,14 @@ public:
 
   /// \brief Returns the file path to replacements map to which replacements
   /// should be added during the run of the tool.
+  ///
+  /// When the files are processed on several threads, this returns a map of
+  /// the translation unit being processed on the calling thread, so it must
+  /// be called each time replacements are added rather than once before the
+  /// run. Once all translation units are done, their maps are merged in the
+  /// order the translation units would have been processed on one thread,
+  /// and replacements which conflict with those of an earlier translation
+  /// unit are dropped.
   std::map<std::string, Replacements> &getReplacements();
 
   /// \brief Call run(), apply all generated replacements, and immediately save
@@ -68,8 +76,15 @@ private:
   /// \brief Write all refactored files to disk.
   int saveRewrittenFiles(Rewriter &Rewrite);
 
+  void beginParallelRun(unsigned NumJobs) override;
+  void beginParallelJob(unsigned Job) override;
+  void endParallelRun() override;
+
 private:
   std::map<std::string, Replacements> FileToReplaces;
+
+  /// \brief The replacements of each translation unit of a parallel run.
+  std::vector<std::map<std::string, Replacements>> JobReplaces;
 };
 
 /// \brief Groups \p Replaces by the file path and applies each group of
@@ -56,6 +56,7 @@ class Compilation;
 class CompilerInvocation;
 class SourceManager;
 class FrontendAction;
+class SharedLookupFileCache;
 
 namespace tooling {
 
@@ -251,6 +252,12 @@ public:
   // FIXME: remove this when all users have migrated!
   void mapVirtualFile(StringRef FilePath, StringRef Content);
 
+  /// \brief Share the results of header search with the other invocations
+  /// that use \p Cache and the same FileManager.
+  void setSharedLookupCache(std::shared_ptr<SharedLookupFileCache> Cache) {
+    SharedLookupCache = std::move(Cache);
+  }
+
   /// \brief Run the clang invocation.
   ///
   /// \returns True if there were no errors during execution.
@@ -272,6 +279,7 @@ public:
   // Maps <file name> -> <file content>.
   llvm::StringMap<StringRef> MappedFileContents;
   DiagnosticConsumer *DiagConsumer;
+  std::shared_ptr<SharedLookupFileCache> SharedLookupCache;
 };
 
 /// \brief Utility to run a FrontendAction over a set of files.
@@ -296,7 +304,7 @@ class ClangTool {
             std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                 std::make_shared<PCHContainerOperations>());
 
-  ~ClangTool();
+  virtual ~ClangTool();
 
   /// \brief Set a \c DiagnosticConsumer to use during parsing.
   void setDiagnosticConsumer(DiagnosticConsumer *DiagConsumer) {
@@ -318,6 +326,29 @@ class ClangTool {
   /// \brief Clear the command line arguments adjuster chain.
   void clearArgumentsAdjusters();
 
+  /// \brief Set the number of translation units to process concurrently.
+  ///
+  /// When more than one thread is used, every translation unit gets its own
+  /// \c FileManager and file system view, which share the results of 'stat'
+  /// calls on absolute paths. \p Action (along with any callbacks it invokes)
+  /// must be safe to call from several threads at once.
+  /// Diagnostics are printed in source path order once all translation units
+  /// have been processed.
+  void setNumThreads(unsigned NumThreads) { this->NumThreads = NumThreads; }
+
+  /// \brief Precompile the system headers shared by translation units with
+  /// the same command line into \p Directory, and reuse them across those
+  /// translation units.
+  ///
+  /// Translation units are grouped by their compile command, ignoring the
+  /// main file and output. For every group of at least two, the
+  /// '#include <...>' directives that all main files of the group start with
+  /// are built into a precompiled header once, which each translation unit of
+  /// the group then loads as if passed with -include-pch. Headers included
+  /// that way must be guarded against multiple inclusion. Translation units
+  /// whose precompiled header fails to build are processed without one.
+  void setSharedPCHDirectory(StringRef Directory);
+
   /// Runs an action over all files specified in the command line.
   ///
   /// \param Action Tool action.
@@ -329,9 +360,22 @@ class ClangTool {
 
   /// \brief Returns the file manager used in the tool.
   ///
-  /// The file manager is shared between all translation units.
+  /// The file manager is shared between all translation units, and so are
+  /// the results of header search when running on a single thread.
   FileManager &getFiles() { return *Files; }
 
+ protected:
+  /// \brief Called before the commands for the files are run on several
+  /// threads, with the number of commands.
+  virtual void beginParallelRun(unsigned NumJobs) {}
+
+  /// \brief Called on the thread about to run command \p Job of a parallel
+  /// run. Commands are numbered in the order they would be run on one thread.
+  virtual void beginParallelJob(unsigned Job) {}
+
+  /// \brief Called once all commands of a parallel run have finished.
+  virtual void endParallelRun() {}
+
  private:
   const CompilationDatabase &Compilations;
   std::vector<std::string> SourcePaths;
@@ -340,6 +384,7 @@ class ClangTool {
   llvm::IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFileSystem;
   llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem;
   llvm::IntrusiveRefCntPtr<FileManager> Files;
+  std::shared_ptr<SharedLookupFileCache> LookupCache;
   // Contains a list of pairs (<file name>, <file content>).
   std::vector< std::pair<StringRef, StringRef> > MappedFileContents;
   llvm::StringSet<> SeenWorkingDirectories;
@@ -347,6 +392,13 @@ class ClangTool {
   ArgumentsAdjuster ArgsAdjuster;
 
   DiagnosticConsumer *DiagConsumer;
+
+  unsigned NumThreads;
+
+  std::string SharedPCHDirectory;
+
+  /// \brief Runs \p Action over all files on \c NumThreads threads.
+  int runInParallel(ToolAction *Action);
 };
 
 template <typename T>
@@ -63,13 +63,6 @@ enum FloatingRank {
 RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (!CommentsLoaded && ExternalSource) {
     ExternalSource->ReadComments();
-
-#ifndef NDEBUG
-    ArrayRef<RawComment *> RawComments = Comments.getComments();
-    assert(std::is_sorted(RawComments.begin(), RawComments.end(),
-                          BeforeThanCompare<RawComment>(SourceMgr)));
-#endif
-
     CommentsLoaded = true;
   }
 
@@ -125,12 +118,6 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
       isa<TemplateTemplateParmDecl>(D))
     return nullptr;
 
-  ArrayRef<RawComment *> RawComments = Comments.getComments();
-
-  // If there are no comments anywhere, we won't find anything.
-  if (RawComments.empty())
-    return nullptr;
-
   // Find declaration location.
   // For Objective-C declarations we generally don't expect to have multiple
   // declarators, thus use declaration starting location as the "declaration
@@ -169,53 +156,37 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (DeclLoc.isInvalid() || !DeclLoc.isFileID())
     return nullptr;
 
-  // Find the comment that occurs just after this declaration.
-  ArrayRef<RawComment *>::iterator Comment;
-  {
-    // When searching for comments during parsing, the comment we are looking
-    // for is usually among the last two comments we parsed -- check them
-    // first.
-    RawComment CommentAtDeclLoc(
-        SourceMgr, SourceRange(DeclLoc), false,
-        LangOpts.CommentOpts.ParseAllComments);
-    BeforeThanCompare<RawComment> Compare(SourceMgr);
-    ArrayRef<RawComment *>::iterator MaybeBeforeDecl = RawComments.end() - 1;
-    bool Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
-    if (!Found && RawComments.size() >= 2) {
-      MaybeBeforeDecl--;
-      Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
-    }
-
-    if (Found) {
-      Comment = MaybeBeforeDecl + 1;
-      assert(Comment == std::lower_bound(RawComments.begin(), RawComments.end(),
-                                         &CommentAtDeclLoc, Compare));
-    } else {
-      // Slow path.
-      Comment = std::lower_bound(RawComments.begin(), RawComments.end(),
-                                 &CommentAtDeclLoc, Compare);
-    }
-  }
-
   // Decompose the location for the declaration and find the beginning of the
   // file buffer.
   std::pair<FileID, unsigned> DeclLocDecomp = SourceMgr.getDecomposedLoc(DeclLoc);
 
+  // A comment is only attached to a declaration in the same file, so only the
+  // comments of that file need to be searched.
+  ArrayRef<RawComment *> RawComments =
+      Comments.getCommentsInFile(DeclLocDecomp.first);
+  if (RawComments.empty())
+    return nullptr;
+
+  // Find the comment that occurs just after this declaration.  Locations in
+  // the same file are ordered by their raw encoding.
+  ArrayRef<RawComment *>::iterator Comment = std::lower_bound(
+      RawComments.begin(), RawComments.end(), DeclLoc,
+      [](const RawComment *C, SourceLocation Loc) {
+        return C->getLocStart().getRawEncoding() < Loc.getRawEncoding();
+      });
+
   // First check whether we have a trailing comment.
   if (Comment != RawComments.end() &&
       (*Comment)->isDocumentation() && (*Comment)->isTrailingComment() &&
       (isa<FieldDecl>(D) || isa<EnumConstantDecl>(D) || isa<VarDecl>(D) ||
        isa<ObjCMethodDecl>(D) || isa<ObjCPropertyDecl>(D))) {
-    std::pair<FileID, unsigned> CommentBeginDecomp
-      = SourceMgr.getDecomposedLoc((*Comment)->getSourceRange().getBegin());
-    // Check that Doxygen trailing comment comes after the declaration, starts
-    // on the same line and in the same file as the declaration.
-    if (DeclLocDecomp.first == CommentBeginDecomp.first &&
-        SourceMgr.getLineNumber(DeclLocDecomp.first, DeclLocDecomp.second)
-          == SourceMgr.getLineNumber(CommentBeginDecomp.first,
-                                     CommentBeginDecomp.second)) {
+    // Check that Doxygen trailing comment comes after the declaration and
+    // starts on the same line as the declaration.
+    unsigned CommentBeginOffset =
+        SourceMgr.getFileOffset((*Comment)->getSourceRange().getBegin());
+    if (SourceMgr.getLineNumber(DeclLocDecomp.first, DeclLocDecomp.second) ==
+        SourceMgr.getLineNumber(DeclLocDecomp.first, CommentBeginOffset))
       return *Comment;
-    }
   }
 
   // The comment just after the declaration was not a trailing comment.
@@ -228,14 +199,8 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (!(*Comment)->isDocumentation() || (*Comment)->isTrailingComment())
     return nullptr;
 
-  // Decompose the end of the comment.
-  std::pair<FileID, unsigned> CommentEndDecomp
-    = SourceMgr.getDecomposedLoc((*Comment)->getSourceRange().getEnd());
-
-  // If the comment and the declaration aren't in the same file, then they
-  // aren't related.
-  if (DeclLocDecomp.first != CommentEndDecomp.first)
-    return nullptr;
+  unsigned CommentEndOffset =
+      SourceMgr.getFileOffset((*Comment)->getSourceRange().getEnd());
 
   // Get the corresponding buffer.
   bool Invalid = false;
@@ -245,8 +210,8 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
     return nullptr;
 
   // Extract text between the comment and declaration.
-  StringRef Text(Buffer + CommentEndDecomp.second,
-                 DeclLocDecomp.second - CommentEndDecomp.second);
+  StringRef Text(Buffer + CommentEndOffset,
+                 DeclLocDecomp.second - CommentEndOffset);
 
   // There should be no other declarations or preprocessor directives between
   // comment and declaration.
@@ -873,6 +838,37 @@ void ASTContext::PrintStats() const {
   llvm::errs() << NumImplicitDestructorsDeclared << "/"
                << NumImplicitDestructors
                << " implicit destructors created\n";
+  if (getLangOpts().CPlusPlus11)
+    llvm::errs() << NumMemoizedConstexprCallHits << "/"
+                 << (NumMemoizedConstexprCallHits +
+                     NumMemoizedConstexprCallMisses)
+                 << " memoized constexpr function calls reused\n";
+
+  llvm::errs() << NumLinearScanLookups
+               << " lookups answered without building a lookup table\n";
+
+  if (PointerParents) {
+    size_t NumParentVectors = 0;
+    size_t ParentMapBytes =
+        PointerParents->getMemorySize() + OtherParents->getMemorySize();
+    auto CountEntry = [&](ParentMapPointers::mapped_type Entry) {
+      if (Entry.is<ast_type_traits::DynTypedNode *>()) {
+        ParentMapBytes += sizeof(ast_type_traits::DynTypedNode);
+      } else if (auto *Vector = Entry.dyn_cast<ParentVector *>()) {
+        ++NumParentVectors;
+        ParentMapBytes += sizeof(ParentVector) + Vector->capacity_in_bytes();
+      }
+    };
+    for (const auto &Entry : *PointerParents)
+      CountEntry(Entry.second);
+    for (const auto &Entry : *OtherParents)
+      CountEntry(Entry.second);
+    llvm::errs() << "  "
+                 << PointerParents->size() + OtherParents->size()
+                 << " nodes in the parent map (" << NumParentVectors
+                 << " with several parents), " << ParentMapBytes
+                 << " bytes\n";
+  }
 
   if (ExternalSource) {
     llvm::errs() << "\n";
@@ -2164,6 +2160,28 @@ void ASTContext::setObjCImplementation(ObjCCategoryDecl *CatD,
   ObjCImpls[CatD] = ImplD;
 }
 
+std::string ASTContext::getPrintedTypeName(QualType T,
+                                           unsigned TemplateArgDepth) const {
+  // The policy abbreviates the lists nested one deeper than the ones we
+  // print, and only has room for a depth of 255.
+  if (TemplateArgDepth)
+    TemplateArgDepth = std::min(TemplateArgDepth, 254u) + 1;
+  std::pair<void *, unsigned> Key(T.getAsOpaquePtr(), TemplateArgDepth);
+  auto Known = PrintedTypeNames.find(Key);
+  if (Known != PrintedTypeNames.end())
+    return Known->second;
+
+  clang::PrintingPolicy Policy = getPrintingPolicy();
+  Policy.TemplateArgDepth = TemplateArgDepth;
+  std::string Name = T.getAsString(Policy);
+
+  // Short names are cheap to print again. An anonymous type is printed
+  // differently once it gets a typedef name, so it isn't remembered.
+  if (Name.size() >= 32 && StringRef(Name).find("anonymous") == StringRef::npos)
+    PrintedTypeNames[Key] = Name;
+  return Name;
+}
+
 const ObjCMethodDecl *
 ASTContext::getObjCMethodRedeclaration(const ObjCMethodDecl *MD) const {
   return ObjCMethodRedecls.lookup(MD);
@@ -2175,6 +2193,42 @@ void ASTContext::setObjCMethodRedeclaration(const ObjCMethodDecl *MD,
   ObjCMethodRedecls[MD] = Redecl;
 }
 
+bool ASTContext::getCachedObjCMethodLookup(const ObjCInterfaceDecl *ID,
+                                           Selector Sel, bool IsInstance,
+                                           ObjCMethodDecl *&Method) {
+  // New modules can add methods and categories to existing classes.
+  std::pair<unsigned, uint32_t> Generation(
+      ObjCMethodLookupGeneration,
+      ExternalSource ? ExternalSource->getGeneration() : 0);
+  if (Generation != ObjCMethodLookupsGeneration) {
+    ObjCMethodLookups.clear();
+    ObjCMethodLookupsGeneration = Generation;
+    return false;
+  }
+
+  auto Known = ObjCMethodLookups.find(
+      ObjCMethodLookupKey(ObjCMethodLookupKey::first_type(ID, IsInstance),
+                          Sel));
+  if (Known == ObjCMethodLookups.end())
+    return false;
+  Method = Known->second;
+  return true;
+}
+
+void ASTContext::setCachedObjCMethodLookup(const ObjCInterfaceDecl *ID,
+                                           Selector Sel, bool IsInstance,
+                                           ObjCMethodDecl *Method) {
+  // Don't cache a result if the lookup itself changed the class.
+  std::pair<unsigned, uint32_t> Generation(
+      ObjCMethodLookupGeneration,
+      ExternalSource ? ExternalSource->getGeneration() : 0);
+  if (Generation != ObjCMethodLookupsGeneration)
+    return;
+
+  ObjCMethodLookups[ObjCMethodLookupKey(
+      ObjCMethodLookupKey::first_type(ID, IsInstance), Sel)] = Method;
+}
+
 const ObjCInterfaceDecl *ASTContext::getObjContainingInterface(
                                               const NamedDecl *ND) const {
   if (const ObjCInterfaceDecl *ID =
@@ -9104,6 +9158,7 @@ size_t ASTContext::getSideTableAllocatedMemory() const {
          llvm::capacity_in_bytes(ObjCLayouts) +
          llvm::capacity_in_bytes(KeyFunctions) +
          llvm::capacity_in_bytes(ObjCImpls) +
+         llvm::capacity_in_bytes(ObjCMethodLookups) +
          llvm::capacity_in_bytes(BlockVarCopyInits) +
          llvm::capacity_in_bytes(DeclAttrs) +
          llvm::capacity_in_bytes(TemplateOrInstantiation) +
@@ -9242,6 +9297,16 @@ ASTContext::getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
   return MaterializedTemporaryValues.lookup(E);
 }
 
+const APValue *ASTContext::getMemoizedConstexprCall(StringRef Key) {
+  auto It = MemoizedConstexprCalls.find(Key);
+  if (It == MemoizedConstexprCalls.end()) {
+    ++NumMemoizedConstexprCallMisses;
+    return nullptr;
+  }
+  ++NumMemoizedConstexprCallHits;
+  return &It->second;
+}
+
 bool ASTContext::AtomicUsesUnsupportedLibcall(const AtomicExpr *E) const {
   const llvm::Triple &T = getTargetInfo().getTriple();
   if (!T.isOSDarwin())
@@ -9298,15 +9363,17 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
   /// FIXME: Currently only builds up the map using \c Stmt and \c Decl nodes.
   class ParentMapASTVisitor : public RecursiveASTVisitor<ParentMapASTVisitor> {
   public:
-    /// \brief Builds and returns the translation unit's parent map.
+    /// \brief Builds and returns the parent map of the nodes within
+    /// \p TopLevelDecls.
     ///
     ///  The caller takes ownership of the returned \c ParentMap.
     static std::pair<ASTContext::ParentMapPointers *,
                      ASTContext::ParentMapOtherNodes *>
-    buildMap(TranslationUnitDecl &TU) {
+    buildMap(ArrayRef<Decl *> TopLevelDecls) {
       ParentMapASTVisitor Visitor(new ASTContext::ParentMapPointers,
                                   new ASTContext::ParentMapOtherNodes);
-      Visitor.TraverseDecl(&TU);
+      for (Decl *D : TopLevelDecls)
+        Visitor.TraverseDecl(D);
       return std::make_pair(Visitor.Parents, Visitor.OtherParents);
     }
 
@@ -9417,6 +9484,13 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
 
 } // anonymous namespace
 
+void ASTContext::setTraversalScope(const std::vector<Decl *> &TopLevelDecls) {
+  TraversalScope = TopLevelDecls;
+  ReleaseParentMapEntries();
+  PointerParents.reset();
+  OtherParents.reset();
+}
+
 template <typename NodeTy, typename MapTy>
 static ASTContext::DynTypedNodeList getDynNodeFromMap(const NodeTy &Node,
                                                       const MapTy &Map) {
@@ -9433,9 +9507,11 @@ static ASTContext::DynTypedNodeList getDynNodeFromMap(const NodeTy &Node,
 ASTContext::DynTypedNodeList
 ASTContext::getParents(const ast_type_traits::DynTypedNode &Node) {
   if (!PointerParents) {
-    // We always need to run over the whole translation unit, as
-    // hasAncestor can escape any subtree.
-    auto Maps = ParentMapASTVisitor::buildMap(*getTranslationUnitDecl());
+    // We need to run over the whole traversal scope, as hasAncestor can
+    // escape any subtree.
+    Decl *TU = getTranslationUnitDecl();
+    auto Maps = ParentMapASTVisitor::buildMap(
+        TraversalScope.empty() ? makeArrayRef(TU) : TraversalScope);
     PointerParents.reset(Maps.first);
     OtherParents.reset(Maps.second);
   }
@@ -230,9 +230,10 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
                             ArrayRef<intptr_t> QualTypeVals) {
   // FIXME: Playing with std::string is really slow.
   bool ForceAKA = false;
+  unsigned Depth = Context.getDiagnostics().getTemplateArgDepth();
   QualType CanTy = Ty.getCanonicalType();
-  std::string S = Ty.getAsString(Context.getPrintingPolicy());
-  std::string CanS = CanTy.getAsString(Context.getPrintingPolicy());
+  std::string S = Context.getPrintedTypeName(Ty, Depth);
+  std::string CanS = Context.getPrintedTypeName(CanTy, Depth);
 
   for (unsigned I = 0, E = QualTypeVals.size(); I != E; ++I) {
     QualType CompareTy =
@@ -244,16 +245,16 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
     QualType CompareCanTy = CompareTy.getCanonicalType();
     if (CompareCanTy == CanTy)
       continue;  // Same canonical types
-    std::string CompareS = CompareTy.getAsString(Context.getPrintingPolicy());
+    std::string CompareS = Context.getPrintedTypeName(CompareTy, Depth);
     bool ShouldAKA = false;
     QualType CompareDesugar = Desugar(Context, CompareTy, ShouldAKA);
     std::string CompareDesugarStr =
-        CompareDesugar.getAsString(Context.getPrintingPolicy());
+        Context.getPrintedTypeName(CompareDesugar, Depth);
     if (CompareS != S && CompareDesugarStr != S)
       continue;  // The type string is different than the comparison string
                  // and the desugared comparison string.
     std::string CompareCanS =
-        CompareCanTy.getAsString(Context.getPrintingPolicy());
+        Context.getPrintedTypeName(CompareCanTy, Depth);
     
     if (CompareCanS == CanS)
       continue;  // No new info from canonical type
@@ -286,7 +287,7 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
       if (DesugaredTy == Ty) {
         DesugaredTy = Ty.getCanonicalType();
       }
-      std::string akaStr = DesugaredTy.getAsString(Context.getPrintingPolicy());
+      std::string akaStr = Context.getPrintedTypeName(DesugaredTy, Depth);
       if (akaStr != S) {
         S = "'" + S + "' (aka '" + akaStr + "')";
         return S;
@@ -302,7 +303,7 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
       llvm::raw_string_ostream OS(DecoratedString);
       const char *Values = VTy->getNumElements() > 1 ? "values" : "value";
       OS << "'" << S << "' (vector of " << VTy->getNumElements() << " '"
-         << VTy->getElementType().getAsString(Context.getPrintingPolicy())
+         << Context.getPrintedTypeName(VTy->getElementType(), Depth)
          << "' " << Values << ")";
       return OS.str();
     }
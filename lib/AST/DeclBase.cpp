@@ -167,6 +167,15 @@ void Decl::PrintStats() {
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
 }
 
+void Decl::forEachKindStat(
+    llvm::function_ref<void(StringRef, unsigned, size_t)> Callback) {
+#define DECL(DERIVED, BASE)                                                    \
+  if (n##DERIVED##s > 0)                                                       \
+    Callback(#DERIVED "Decl", n##DERIVED##s, sizeof(DERIVED##Decl));
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+}
+
 void Decl::add(Kind k) {
   switch (k) {
 #define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
@@ -1331,6 +1340,11 @@ void DeclContext::addHiddenDecl(Decl *D) {
   if (CXXRecordDecl *Record = dyn_cast<CXXRecordDecl>(this))
     Record->addedMember(D);
 
+  // A new method or category may change the result of method lookups in
+  // Objective-C classes.
+  if (isa<ObjCMethodDecl>(D) || isa<ObjCCategoryDecl>(D))
+    D->getASTContext().invalidateObjCMethodLookups();
+
   // If this is a newly-created (not de-serialized) import declaration, wire
   // it in to the list of local import declarations.
   if (!D->isFromASTFile()) {
@@ -1447,6 +1461,43 @@ void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
   }
 }
 
+/// The largest number of declarations DeclContext::lookup scans through
+/// rather than building a lookup table.
+static const unsigned MaxLinearScanLookupDecls = 8;
+
+/// Look for a declaration named \p Name within \p DCtx by scanning its
+/// declarations, finding exactly those buildLookupImpl would have added to
+/// the lookup table. At most \p Budget declarations are examined. Returns
+/// false if the budget runs out or more than one declaration is found; the
+/// answer then has to come from a lookup table.
+static bool lookupByLinearScan(DeclContext *DCtx, DeclarationName Name,
+                               unsigned &Budget, NamedDecl *&Found) {
+  if (DCtx->hasExternalLexicalStorage())
+    return false;
+
+  for (Decl *D : DCtx->noload_decls()) {
+    if (!Budget--)
+      return false;
+
+    if (NamedDecl *ND = dyn_cast<NamedDecl>(D)) {
+      if (ND->isFromASTFile())
+        return false;
+      if (ND->getDeclName() == Name && ND->getDeclContext() == DCtx &&
+          !shouldBeHidden(ND)) {
+        if (Found)
+          return false;
+        Found = ND;
+      }
+    }
+
+    if (DeclContext *InnerCtx = dyn_cast<DeclContext>(D))
+      if (InnerCtx->isTransparentContext() || InnerCtx->isInlineNamespace())
+        if (!lookupByLinearScan(InnerCtx, Name, Budget, Found))
+          return false;
+  }
+  return true;
+}
+
 NamedDecl *const DeclContextLookupResult::SingleElementDummyList = nullptr;
 
 DeclContext::lookup_result
@@ -1498,6 +1549,25 @@ DeclContext::lookup(DeclarationName Name) const {
   }
 
   StoredDeclsMap *Map = LookupPtr;
+
+  // Don't build a lookup table for a context with only a handful of
+  // declarations if a scan of them finds the answer.
+  if (!Map && HasLazyLocalLexicalLookups && !HasLazyExternalLexicalLookups) {
+    SmallVector<DeclContext *, 2> Contexts;
+    const_cast<DeclContext*>(this)->collectAllContexts(Contexts);
+
+    unsigned Budget = MaxLinearScanLookupDecls;
+    NamedDecl *Found = nullptr;
+    bool Scanned = true;
+    for (auto *DC : Contexts)
+      if (!(Scanned = lookupByLinearScan(DC, Name, Budget, Found)))
+        break;
+    if (Scanned) {
+      ++getParentASTContext().NumLinearScanLookups;
+      return Found ? lookup_result(Found) : lookup_result();
+    }
+  }
+
   if (HasLazyLocalLexicalLookups || HasLazyExternalLexicalLookups)
     Map = const_cast<DeclContext*>(this)->buildLookup();
 
@@ -22,6 +22,8 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -71,7 +73,8 @@ CXXRecordDecl::DefinitionData::DefinitionData(CXXRecordDecl *D)
       ImplicitCopyAssignmentHasConstParam(true),
       HasDeclaredCopyConstructorWithConstParam(false),
       HasDeclaredCopyAssignmentWithConstParam(false), IsLambda(false),
-      IsParsingBaseSpecifiers(false), NumBases(0), NumVBases(0), Bases(),
+      IsParsingBaseSpecifiers(false), HasODRHash(false), NumBases(0),
+      NumVBases(0), ODRHash(0), Bases(),
       VBases(), Definition(D), FirstFriend() {}
 
 CXXBaseSpecifier *CXXRecordDecl::DefinitionData::getBasesSlowCase() const {
@@ -1472,6 +1475,74 @@ bool CXXRecordDecl::mayBeAbstract() const {
   return false;
 }
 
+/// Write a description of the explicitly-declared member \p D to \p OS for
+/// CXXRecordDecl::getODRHash.
+static void describeMemberForODRHash(const Decl *D,
+                                     const PrintingPolicy &Policy,
+                                     raw_ostream &OS) {
+  OS << D->getDeclKindName() << ' ' << unsigned(D->getAccessUnsafe());
+  if (const auto *ND = dyn_cast<NamedDecl>(D))
+    OS << ' ' << ND->getDeclName();
+
+  // Describe a function by its signature rather than its type, so that the
+  // hash does not depend on whether its exception specification or deduced
+  // return type has been computed yet.
+  if (const FunctionDecl *FD = D->getAsFunction()) {
+    QualType ReturnType = FD->getReturnType();
+    OS << ' '
+       << (ReturnType->getContainedAutoType()
+               ? "auto"
+               : ReturnType.getCanonicalType().getAsString(Policy))
+       << '(';
+    for (const ParmVarDecl *Param : FD->parameters())
+      OS << Param->getType().getCanonicalType().getAsString(Policy) << ',';
+    OS << (FD->isVariadic() ? "...)" : ")");
+    if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+      OS << ' ' << MD->getTypeQualifiers() << ' '
+         << unsigned(MD->getRefQualifier()) << ' ' << MD->isVirtualAsWritten()
+         << MD->isPure() << MD->isStatic();
+    OS << ' ' << FD->isDeleted() << FD->isExplicitlyDefaulted();
+  } else if (const auto *Field = dyn_cast<FieldDecl>(D)) {
+    OS << ' ' << Field->getType().getCanonicalType().getAsString(Policy)
+       << ' ' << Field->isBitField() << Field->isMutable();
+  } else if (const auto *VD = dyn_cast<ValueDecl>(D)) {
+    OS << ' ' << VD->getType().getCanonicalType().getAsString(Policy);
+  } else if (const auto *TD = dyn_cast<TypedefNameDecl>(D)) {
+    OS << ' '
+       << TD->getUnderlyingType().getCanonicalType().getAsString(Policy);
+  }
+  OS << ';';
+}
+
+unsigned CXXRecordDecl::getODRHash() const {
+  auto &DD = data();
+  if (DD.HasODRHash)
+    return DD.ODRHash;
+
+  // Only describe what was explicitly written: implicit members are declared
+  // on demand, so two modules with identical definitions can differ in which
+  // of them they declared. Anonymous types print without their location, so
+  // that the same definition reached through different paths matches.
+  const CXXRecordDecl *Def = DD.Definition;
+  PrintingPolicy Policy(Def->getASTContext().getLangOpts());
+  Policy.AnonymousTagLocations = false;
+
+  SmallString<256> Description;
+  llvm::raw_svector_ostream OS(Description);
+  for (const CXXBaseSpecifier &Base : Def->bases())
+    OS << Base.getType().getCanonicalType().getAsString(Policy) << ' '
+       << Base.isVirtual() << unsigned(Base.getAccessSpecifierAsWritten())
+       << Base.isPackExpansion() << ';';
+  OS << '{';
+  for (const Decl *Member : Def->decls())
+    if (!Member->isImplicit() && !isa<AccessSpecDecl>(Member))
+      describeMemberForODRHash(Member, Policy, OS);
+
+  DD.ODRHash = llvm::HashString(OS.str());
+  DD.HasODRHash = true;
+  return DD.ODRHash;
+}
+
 void CXXMethodDecl::anchor() { }
 
 bool CXXMethodDecl::isStatic() const {
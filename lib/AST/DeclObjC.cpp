@@ -407,10 +407,30 @@ const ObjCInterfaceDecl *ObjCInterfaceDecl::isObjCRequiresPropertyDefs() const {
   return nullptr;
 }
 
+void ObjCInterfaceDecl::setProtocolList(ObjCProtocolDecl *const* List,
+                                        unsigned Num,
+                                        const SourceLocation *Locs,
+                                        ASTContext &C) {
+  data().ReferencedProtocols.set(List, Num, Locs, C);
+  C.invalidateObjCMethodLookups();
+}
+
+void ObjCInterfaceDecl::setSuperClass(TypeSourceInfo *superClass) {
+  data().SuperClassTInfo = superClass;
+  getASTContext().invalidateObjCMethodLookups();
+}
+
+void ObjCInterfaceDecl::setCategoryListRaw(ObjCCategoryDecl *category) {
+  data().CategoryList = category;
+  getASTContext().invalidateObjCMethodLookups();
+}
+
 void ObjCInterfaceDecl::mergeClassExtensionProtocolList(
                               ObjCProtocolDecl *const* ExtList, unsigned ExtNum,
                               ASTContext &C)
 {
+  C.invalidateObjCMethodLookups();
+
   if (data().ExternallyCompleted)
     LoadExternalDefinition();
 
@@ -650,22 +670,13 @@ ObjCInterfaceDecl::lookupNestedProtocol(IdentifierInfo *Name) {
 /// the class, its categories, and its super classes (using a linear search).
 /// When argument category "C" is specified, any implicit method found
 /// in this category is ignored.
-ObjCMethodDecl *ObjCInterfaceDecl::lookupMethod(Selector Sel, 
-                                                bool isInstance,
-                                                bool shallowCategoryLookup,
-                                                bool followSuper,
-                                                const ObjCCategoryDecl *C) const
-{
-  // FIXME: Should make sure no callers ever do this.
-  if (!hasDefinition())
-    return nullptr;
-
-  const ObjCInterfaceDecl* ClassDecl = this;
+static ObjCMethodDecl *lookupMethodInHierarchy(const ObjCInterfaceDecl *ClassDecl,
+                                               Selector Sel, bool isInstance,
+                                               bool shallowCategoryLookup,
+                                               bool followSuper,
+                                               const ObjCCategoryDecl *C) {
   ObjCMethodDecl *MethodDecl = nullptr;
 
-  if (data().ExternallyCompleted)
-    LoadExternalDefinition();
-
   while (ClassDecl) {
     // 1. Look through primary class.
     if ((MethodDecl = ClassDecl->getMethod(Sel, isInstance)))
@@ -705,6 +716,37 @@ ObjCMethodDecl *ObjCInterfaceDecl::lookupMethod(Selector Sel,
   return nullptr;
 }
 
+ObjCMethodDecl *ObjCInterfaceDecl::lookupMethod(Selector Sel, 
+                                                bool isInstance,
+                                                bool shallowCategoryLookup,
+                                                bool followSuper,
+                                                const ObjCCategoryDecl *C) const
+{
+  // FIXME: Should make sure no callers ever do this.
+  if (!hasDefinition())
+    return nullptr;
+
+  if (data().ExternallyCompleted)
+    LoadExternalDefinition();
+
+  // Only lookups through the whole hierarchy are common enough to cache.
+  if (shallowCategoryLookup || !followSuper || C)
+    return lookupMethodInHierarchy(this, Sel, isInstance, shallowCategoryLookup,
+                                   followSuper, C);
+
+  ASTContext &Context = getASTContext();
+  const ObjCInterfaceDecl *Def = getDefinition();
+  ObjCMethodDecl *MethodDecl = nullptr;
+  if (Context.getCachedObjCMethodLookup(Def, Sel, isInstance, MethodDecl))
+    return MethodDecl;
+
+  MethodDecl = lookupMethodInHierarchy(this, Sel, isInstance,
+                                       /*shallowCategoryLookup=*/false,
+                                       /*followSuper=*/true, /*C=*/nullptr);
+  Context.setCachedObjCMethodLookup(Def, Sel, isInstance, MethodDecl);
+  return MethodDecl;
+}
+
 // Will search "local" class/category implementations for a method decl.
 // If failed, then we search in class's root for an instance method.
 // Returns 0 if no method is found.
@@ -1863,6 +1905,15 @@ void ObjCProtocolDecl::startDefinition() {
     RD->Data = this->Data;
 }
 
+void ObjCProtocolDecl::setProtocolList(ObjCProtocolDecl *const*List,
+                                       unsigned Num,
+                                       const SourceLocation *Locs,
+                                       ASTContext &C) {
+  assert(hasDefinition() && "Protocol is not defined");
+  data().ReferencedProtocols.set(List, Num, Locs, C);
+  C.invalidateObjCMethodLookups();
+}
+
 void ObjCProtocolDecl::collectPropertiesToImplement(PropertyMap &PM,
                                                     PropertyDeclOrder &PO) const {
   
@@ -1973,6 +2024,14 @@ void ObjCCategoryDecl::setImplementation(ObjCCategoryImplDecl *ImplD) {
   getASTContext().setObjCImplementation(this, ImplD);
 }
 
+void ObjCCategoryDecl::setProtocolList(ObjCProtocolDecl *const*List,
+                                       unsigned Num,
+                                       const SourceLocation *Locs,
+                                       ASTContext &C) {
+  ReferencedProtocols.set(List, Num, Locs, C);
+  C.invalidateObjCMethodLookups();
+}
+
 void ObjCCategoryDecl::setTypeParamList(ObjCTypeParamList *TPL) {
   TypeParamList = TPL;
   if (!TPL)
@@ -245,8 +245,8 @@ void FunctionTemplateDecl::LoadLazySpecializations() const {
     ASTContext &Context = getASTContext();
     uint32_t *Specs = CommonPtr->LazySpecializations;
     CommonPtr->LazySpecializations = nullptr;
-    for (uint32_t I = 0, N = *Specs++; I != N; ++I)
-      (void)Context.getExternalSource()->GetExternalDecl(Specs[I]);
+    Context.getExternalSource()->PrefetchExternalDecls(
+        llvm::makeArrayRef(Specs + 1, *Specs));
   }
 }
 
@@ -322,8 +322,8 @@ void ClassTemplateDecl::LoadLazySpecializations() const {
     ASTContext &Context = getASTContext();
     uint32_t *Specs = CommonPtr->LazySpecializations;
     CommonPtr->LazySpecializations = nullptr;
-    for (uint32_t I = 0, N = *Specs++; I != N; ++I)
-      (void)Context.getExternalSource()->GetExternalDecl(Specs[I]);
+    Context.getExternalSource()->PrefetchExternalDecls(
+        llvm::makeArrayRef(Specs + 1, *Specs));
   }
 }
 
@@ -663,6 +663,16 @@ FunctionTemplateSpecializationInfo::Create(ASTContext &C, FunctionDecl *FD,
                                                     POI);
 }
 
+unsigned FunctionTemplateSpecializationInfo::getProfileHash() {
+  if (!HasProfileHash) {
+    llvm::FoldingSetNodeID ID;
+    Profile(ID);
+    ProfileHash = truncateSpecializationProfileHash(ID.ComputeHash());
+    HasProfileHash = true;
+  }
+  return ProfileHash;
+}
+
 //===----------------------------------------------------------------------===//
 // TemplateDecl Implementation
 //===----------------------------------------------------------------------===//
@@ -685,14 +695,16 @@ ClassTemplateSpecializationDecl(ASTContext &Context, Kind DK, TagKind TK,
     SpecializedTemplate(SpecializedTemplate),
     ExplicitInfo(nullptr),
     TemplateArgs(TemplateArgumentList::CreateCopy(Context, Args)),
-    SpecializationKind(TSK_Undeclared) {
+    SpecializationKind(TSK_Undeclared), HasProfileHash(false),
+    ProfileHash(0) {
 }
 
 ClassTemplateSpecializationDecl::ClassTemplateSpecializationDecl(ASTContext &C,
                                                                  Kind DK)
     : CXXRecordDecl(DK, TTK_Struct, C, nullptr, SourceLocation(),
                     SourceLocation(), nullptr, nullptr),
-      ExplicitInfo(nullptr), SpecializationKind(TSK_Undeclared) {}
+      ExplicitInfo(nullptr), SpecializationKind(TSK_Undeclared),
+      HasProfileHash(false), ProfileHash(0) {}
 
 ClassTemplateSpecializationDecl *
 ClassTemplateSpecializationDecl::Create(ASTContext &Context, TagKind TK,
@@ -712,6 +724,16 @@ ClassTemplateSpecializationDecl::Create(ASTContext &Context, TagKind TK,
   return Result;
 }
 
+unsigned ClassTemplateSpecializationDecl::getProfileHash() const {
+  if (!HasProfileHash) {
+    llvm::FoldingSetNodeID ID;
+    Profile(ID);
+    ProfileHash = truncateSpecializationProfileHash(ID.ComputeHash());
+    HasProfileHash = true;
+  }
+  return ProfileHash;
+}
+
 ClassTemplateSpecializationDecl *
 ClassTemplateSpecializationDecl::CreateDeserialized(ASTContext &C,
                                                     unsigned ID) {
@@ -948,8 +970,8 @@ void VarTemplateDecl::LoadLazySpecializations() const {
     ASTContext &Context = getASTContext();
     uint32_t *Specs = CommonPtr->LazySpecializations;
     CommonPtr->LazySpecializations = nullptr;
-    for (uint32_t I = 0, N = *Specs++; I != N; ++I)
-      (void)Context.getExternalSource()->GetExternalDecl(Specs[I]);
+    Context.getExternalSource()->PrefetchExternalDecls(
+        llvm::makeArrayRef(Specs + 1, *Specs));
   }
 }
 
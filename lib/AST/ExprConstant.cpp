@@ -44,6 +44,7 @@
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 #include <functional>
@@ -564,6 +565,10 @@ namespace {
     /// \brief Whether or not we're currently speculatively evaluating.
     bool IsSpeculativelyEvaluating;
 
+    /// \brief Whether calls to functions which are not constexpr are
+    /// evaluated, when folding an initializer for static initialization.
+    bool CallNonConstexprFunctions = false;
+
     enum EvaluationMode {
       /// Evaluate as a constant expression. Stop if we find that the expression
       /// is not a constant expression.
@@ -3545,9 +3550,15 @@ enum EvalStmtResult {
 }
 
 static bool EvaluateVarDecl(EvalInfo &Info, const VarDecl *VD) {
-  // We don't need to evaluate the initializer for a static local.
-  if (!VD->hasLocalStorage())
+  // We don't need to evaluate the initializer for a static local. Outside
+  // of a constexpr function, its dynamic initialization can't be skipped.
+  if (!VD->hasLocalStorage()) {
+    if (Info.CallNonConstexprFunctions) {
+      Info.FFDiag(VD->getLocStart());
+      return false;
+    }
     return true;
+  }
 
   LValue Result;
   Result.set(VD, Info.CurrentCall->Index);
@@ -4029,6 +4040,12 @@ static bool CheckConstexprFunction(EvalInfo &Info, SourceLocation CallLoc,
       !Definition->isInvalidDecl() && Body)
     return true;
 
+  // When folding a static initializer, any function can be evaluated as long
+  // as we have the one definition it will have in the program.
+  if (Info.CallNonConstexprFunctions && Definition &&
+      !Definition->isInvalidDecl() && Body && !Definition->isWeak())
+    return true;
+
   if (Info.getLangOpts().CPlusPlus11) {
     const FunctionDecl *DiagDecl = Definition ? Definition : Declaration;
     
@@ -4049,7 +4066,9 @@ static bool CheckConstexprFunction(EvalInfo &Info, SourceLocation CallLoc,
         << CD->getInheritedConstructor().getConstructor()->getParent();
     else
       Info.FFDiag(CallLoc, diag::note_constexpr_invalid_function, 1)
-        << DiagDecl->isConstexpr() << (bool)CD << DiagDecl;
+        << (DiagDecl->isConstexpr() ||
+            (Info.CallNonConstexprFunctions && !Definition))
+        << (bool)CD << DiagDecl;
     Info.Note(DiagDecl->getLocation(), diag::note_declared_at);
   } else {
     Info.FFDiag(CallLoc, diag::note_invalid_subexpr_in_const_expr);
@@ -4094,6 +4113,104 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
+/// Append an encoding of \p V to the memoization key \p Key. Returns false if
+/// \p V refers to an object, in which case a call cannot be memoized.
+static bool appendCallMemoKey(const APValue &V, SmallVectorImpl<char> &Key) {
+  auto AddWord = [&](uint64_t N) {
+    const char *Bytes = reinterpret_cast<const char *>(&N);
+    Key.append(Bytes, Bytes + sizeof(N));
+  };
+  auto AddInt = [&](const llvm::APInt &I) {
+    AddWord(I.getBitWidth());
+    for (unsigned W = 0, E = I.getNumWords(); W != E; ++W)
+      AddWord(I.getRawData()[W]);
+  };
+
+  AddWord(V.getKind());
+  switch (V.getKind()) {
+  case APValue::Uninitialized:
+    return true;
+  case APValue::Int:
+    AddInt(V.getInt());
+    return true;
+  case APValue::Float:
+    AddInt(V.getFloat().bitcastToAPInt());
+    return true;
+  case APValue::ComplexInt:
+    AddInt(V.getComplexIntReal());
+    AddInt(V.getComplexIntImag());
+    return true;
+  case APValue::ComplexFloat:
+    AddInt(V.getComplexFloatReal().bitcastToAPInt());
+    AddInt(V.getComplexFloatImag().bitcastToAPInt());
+    return true;
+  case APValue::Vector:
+    AddWord(V.getVectorLength());
+    for (unsigned I = 0, N = V.getVectorLength(); I != N; ++I)
+      if (!appendCallMemoKey(V.getVectorElt(I), Key))
+        return false;
+    return true;
+  case APValue::Array:
+    AddWord(V.getArraySize());
+    AddWord(V.getArrayInitializedElts());
+    for (unsigned I = 0, N = V.getArrayInitializedElts(); I != N; ++I)
+      if (!appendCallMemoKey(V.getArrayInitializedElt(I), Key))
+        return false;
+    return !V.hasArrayFiller() || appendCallMemoKey(V.getArrayFiller(), Key);
+  case APValue::Struct:
+    AddWord(V.getStructNumBases());
+    AddWord(V.getStructNumFields());
+    for (unsigned I = 0, N = V.getStructNumBases(); I != N; ++I)
+      if (!appendCallMemoKey(V.getStructBase(I), Key))
+        return false;
+    for (unsigned I = 0, N = V.getStructNumFields(); I != N; ++I)
+      if (!appendCallMemoKey(V.getStructField(I), Key))
+        return false;
+    return true;
+  case APValue::Union:
+    AddWord(reinterpret_cast<uintptr_t>(V.getUnionField()));
+    return appendCallMemoKey(V.getUnionValue(), Key);
+  case APValue::LValue:
+  case APValue::MemberPointer:
+  case APValue::AddrLabelDiff:
+    return false;
+  }
+  llvm_unreachable("Unknown APValue kind!");
+}
+
+/// Compute the key under which the result of calling \p Callee with
+/// \p ArgValues can be memoized. Returns false if the call can't be memoized:
+/// only calls to non-member functions whose arguments are plain values are,
+/// and only when evaluating a constant expression, where the result of such
+/// a call can't depend on anything but its arguments. The evaluation mode is
+/// part of the key, since it affects which results are acceptable.
+static bool getCallMemoKey(EvalInfo &Info, const FunctionDecl *Callee,
+                           const LValue *This, ArrayRef<APValue> ArgValues,
+                           SmallVectorImpl<char> &Key) {
+  if (This || Callee->getReturnType()->isVoidType() ||
+      Info.IsSpeculativelyEvaluating ||
+      (Info.EvalMode != EvalInfo::EM_ConstantExpression &&
+       Info.EvalMode != EvalInfo::EM_ConstantExpressionUnevaluated))
+    return false;
+
+  uintptr_t CalleeID = reinterpret_cast<uintptr_t>(Callee);
+  const char *Bytes = reinterpret_cast<const char *>(&CalleeID);
+  Key.append(Bytes, Bytes + sizeof(CalleeID));
+  Key.push_back(static_cast<char>(Info.EvalMode));
+  for (const APValue &Arg : ArgValues)
+    if (!appendCallMemoKey(Arg, Key))
+      return false;
+  return true;
+}
+
+/// Determine whether \p Result, the result of a call, can be memoized: it
+/// must not refer to any object, since that might have been a temporary or
+/// local of the call.
+static bool canMemoizeCallResult(const APValue &Result) {
+  SmallVector<char, 64> Unused;
+  return appendCallMemoKey(Result, Unused);
+}
+
 /// Evaluate a function call.
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
@@ -4107,6 +4224,26 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
+  // A call we've evaluated before with the same arguments has the same
+  // result. Reusing it still counts as a step of the evaluation.
+  SmallString<64> MemoKey;
+  bool CanMemoize = getCallMemoKey(Info, Callee, This, ArgValues, MemoKey);
+  if (CanMemoize) {
+    if (const APValue *Memoized = Info.Ctx.getMemoizedConstexprCall(MemoKey)) {
+      if (!Info.nextStep(Body))
+        return false;
+      Result = *Memoized;
+      return true;
+    }
+  }
+
+  // Only remember a result whose evaluation produced no diagnostic at all: a
+  // note that the call isn't a core constant expression must be issued again
+  // by every call. We can only tell if we are collecting diagnostics and
+  // have none so far.
+  bool HadNoDiags = Info.EvalStatus.Diag && Info.EvalStatus.Diag->empty() &&
+                    !Info.EvalStatus.HasSideEffects;
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -4141,6 +4278,10 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
       return true;
     Info.FFDiag(Callee->getLocEnd(), diag::note_constexpr_no_return);
   }
+  if (ESR == ESR_Returned && CanMemoize && HadNoDiags &&
+      Info.EvalStatus.Diag->empty() && !Info.EvalStatus.HasSideEffects &&
+      canMemoizeCallResult(Result))
+    Info.Ctx.setMemoizedConstexprCall(MemoKey, Result);
   return ESR == ESR_Returned;
 }
 
@@ -9768,22 +9909,26 @@ bool Expr::EvaluateAsLValue(EvalResult &Result, const ASTContext &Ctx) const {
   return true;
 }
 
-bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
-                                 const VarDecl *VD,
-                            SmallVectorImpl<PartialDiagnosticAt> &Notes) const {
+static bool EvaluateInitializer(const Expr *E, APValue &Value,
+                                const ASTContext &Ctx, const VarDecl *VD,
+                                SmallVectorImpl<PartialDiagnosticAt> &Notes,
+                                bool CallNonConstexprFunctions) {
   // FIXME: Evaluating initializers for large array and record types can cause
   // performance problems. Only do so in C++11 for now.
-  if (isRValue() && (getType()->isArrayType() || getType()->isRecordType()) &&
+  if (E->isRValue() &&
+      (E->getType()->isArrayType() || E->getType()->isRecordType()) &&
       !Ctx.getLangOpts().CPlusPlus11)
     return false;
 
   Expr::EvalStatus EStatus;
   EStatus.Diag = &Notes;
 
-  EvalInfo InitInfo(Ctx, EStatus, VD->isConstexpr()
-                                      ? EvalInfo::EM_ConstantExpression
-                                      : EvalInfo::EM_ConstantFold);
+  EvalInfo InitInfo(Ctx, EStatus,
+                    VD->isConstexpr() && !CallNonConstexprFunctions
+                        ? EvalInfo::EM_ConstantExpression
+                        : EvalInfo::EM_ConstantFold);
   InitInfo.setEvaluatingDecl(VD, Value);
+  InitInfo.CallNonConstexprFunctions = CallNonConstexprFunctions;
 
   LValue LVal;
   LVal.set(VD);
@@ -9800,7 +9945,7 @@ bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
       return false;
   }
 
-  if (!EvaluateInPlace(Value, InitInfo, LVal, this,
+  if (!EvaluateInPlace(Value, InitInfo, LVal, E,
                        /*AllowNonLiteralTypes=*/true) ||
       EStatus.HasSideEffects)
     return false;
@@ -9809,6 +9954,21 @@ bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
                                  Value);
 }
 
+bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
+                                 const VarDecl *VD,
+                            SmallVectorImpl<PartialDiagnosticAt> &Notes) const {
+  return EvaluateInitializer(this, Value, Ctx, VD, Notes,
+                             /*CallNonConstexprFunctions=*/false);
+}
+
+bool Expr::EvaluateAsStaticInitializer(
+    APValue &Value, const ASTContext &Ctx, const VarDecl *VD,
+    SmallVectorImpl<PartialDiagnosticAt> &Notes) const {
+  assert(!VD->hasLocalStorage() && "not a variable with static storage");
+  return EvaluateInitializer(this, Value, Ctx, VD, Notes,
+                             /*CallNonConstexprFunctions=*/true);
+}
+
 /// isEvaluatable - Call EvaluateAsRValue to see if this expression can be
 /// constant folded, but discard the result.
 bool Expr::isEvaluatable(const ASTContext &Ctx, SideEffectsKind SEK) const {
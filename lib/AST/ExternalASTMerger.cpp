@@ -0,0 +1,122 @@
+//===- ExternalASTMerger.cpp - Merging External AST Interface ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ExternalASTMerger, which vends a combination of
+//  ASTs from several different ASTContext/FileManager pairs
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ExternalASTMerger.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/FileManager.h"
+#include <algorithm>
+
+using namespace clang;
+
+/// \brief An importer which leaves the contexts it imports empty, marking
+/// them so that their contents are requested from the merger later.
+class ExternalASTMerger::LazyImporter : public ASTImporter {
+  ExternalASTMerger &Merger;
+  unsigned Source;
+
+public:
+  LazyImporter(ExternalASTMerger &Merger, unsigned Source,
+               ASTContext &ToContext, FileManager &ToFileManager,
+               ASTContext &FromContext, FileManager &FromFileManager)
+      : ASTImporter(ToContext, ToFileManager, FromContext, FromFileManager,
+                    /*MinimalImport=*/true),
+        Merger(Merger), Source(Source) {}
+
+  Decl *Imported(Decl *From, Decl *To) override {
+    if (auto *ToTag = dyn_cast<TagDecl>(To)) {
+      ToTag->setHasExternalLexicalStorage();
+      if (ToTag->getPrimaryContext() == ToTag)
+        ToTag->setMustBuildLookupTable();
+      Merger.addOrigin(ToTag, cast<TagDecl>(From), Source);
+    } else if (auto *ToNamespace = dyn_cast<NamespaceDecl>(To)) {
+      ToNamespace->setHasExternalVisibleStorage();
+      Merger.addOrigin(ToNamespace, cast<NamespaceDecl>(From), Source);
+    }
+    return ASTImporter::Imported(From, To);
+  }
+};
+
+ExternalASTMerger::ExternalASTMerger(
+    const ImporterEndpoint &Target, llvm::ArrayRef<ImporterEndpoint> Sources) {
+  for (const ImporterEndpoint &S : Sources) {
+    unsigned Index = Importers.size();
+    ImporterPair Pair;
+    Pair.Forward = llvm::make_unique<LazyImporter>(*this, Index, Target.AST,
+                                                   Target.FM, S.AST, S.FM);
+    Pair.Reverse = llvm::make_unique<ASTImporter>(S.AST, S.FM, Target.AST,
+                                                  Target.FM,
+                                                  /*MinimalImport=*/true);
+    Importers.push_back(std::move(Pair));
+    addOrigin(Target.AST.getTranslationUnitDecl(),
+              S.AST.getTranslationUnitDecl(), Index);
+  }
+}
+
+ExternalASTMerger::~ExternalASTMerger() {}
+
+void ExternalASTMerger::addOrigin(DeclContext *ToDC, DeclContext *FromDC,
+                                  unsigned Source) {
+  SmallVectorImpl<Origin> &DCOrigins = Origins[ToDC->getPrimaryContext()];
+  Origin O(FromDC->getPrimaryContext(), Source);
+  if (std::find(DCOrigins.begin(), DCOrigins.end(), O) == DCOrigins.end())
+    DCOrigins.push_back(O);
+}
+
+bool ExternalASTMerger::FindExternalVisibleDeclsByName(const DeclContext *DC,
+                                                       DeclarationName Name) {
+  auto It = Origins.find(DC->getPrimaryContext());
+  if (It == Origins.end())
+    return false;
+
+  llvm::SmallVector<NamedDecl *, 1> Decls;
+  // Importing a declaration may add origins, so don't hold on to the vector.
+  SmallVector<Origin, 1> DCOrigins = It->second;
+  for (const Origin &O : DCOrigins) {
+    ImporterPair &Pair = Importers[O.second];
+    DeclarationName FromName = Pair.Reverse->Import(Name);
+    if (!FromName && Name)
+      continue;
+    for (NamedDecl *FromD : O.first->lookup(FromName))
+      if (auto *D = cast_or_null<NamedDecl>(Pair.Forward->Import(FromD)))
+        Decls.push_back(D);
+  }
+  if (Decls.empty())
+    return false;
+
+  SetExternalVisibleDeclsForName(DC, Name, Decls);
+  return true;
+}
+
+void ExternalASTMerger::FindExternalLexicalDecls(
+    const DeclContext *DC, llvm::function_ref<bool(Decl::Kind)> IsKindWeWant,
+    SmallVectorImpl<Decl *> &Result) {
+  auto It = Origins.find(DC->getPrimaryContext());
+  if (It == Origins.end())
+    return;
+
+  // The importer adds each declaration to its context in the target AST, so
+  // nothing needs to be returned through Result.
+  SmallVector<Origin, 1> DCOrigins = It->second;
+  for (const Origin &O : DCOrigins)
+    for (Decl *FromD : O.first->decls())
+      if (IsKindWeWant(FromD->getKind()))
+        Importers[O.second].Forward->Import(FromD);
+}
+
+void ExternalASTMerger::CompleteType(TagDecl *Tag) {
+  SmallVector<Decl *, 0> Result;
+  FindExternalLexicalDecls(Tag, [](Decl::Kind) { return true; }, Result);
+  Tag->setHasExternalLexicalStorage(false);
+}
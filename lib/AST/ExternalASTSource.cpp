@@ -71,10 +71,20 @@ bool ExternalASTSource::layoutRecordType(
   return false;
 }
 
+const ASTRecordLayout *
+ExternalASTSource::loadRecordLayout(const RecordDecl *Record) {
+  return nullptr;
+}
+
 Decl *ExternalASTSource::GetExternalDecl(uint32_t ID) {
   return nullptr;
 }
 
+void ExternalASTSource::PrefetchExternalDecls(ArrayRef<uint32_t> IDs) {
+  for (uint32_t ID : IDs)
+    (void)GetExternalDecl(ID);
+}
+
 Selector ExternalASTSource::GetExternalSelector(uint32_t ID) {
   return Selector();
 }
@@ -269,68 +269,127 @@ static bool onlyWhitespaceBetween(SourceManager &SM,
   return true;
 }
 
+/// Returns true if the documentation comment \p C2, which follows \p C1 in the
+/// same file, continues it.
+static bool shouldMergeComments(const SourceManager &SM, const RawComment &C1,
+                                const RawComment &C2) {
+  // Merge comments only if there is only whitespace between them.
+  // Can't merge trailing and non-trailing comments unless the second is
+  // non-trailing ordinary in the same column, as in the case:
+  //   int x; // documents x
+  //          // more text
+  // versus:
+  //   int x; // documents x
+  //   int y; // documents y
+  // or:
+  //   int x; // documents x
+  //   // documents y
+  //   int y;
+  // Merge comments if they are on same or consecutive lines.
+  return (C1.isTrailingComment() == C2.isTrailingComment() ||
+          (C1.isTrailingComment() && !C2.isTrailingComment() &&
+           isOrdinaryKind(C2.getKind()) &&
+           commentsStartOnSameColumn(SM, C1, C2))) &&
+         onlyWhitespaceBetween(SM, C1.getLocEnd(), C2.getLocStart(),
+                               /*MaxNewlinesAllowed=*/1);
+}
+
+/// Locations in the same file are ordered by their raw encoding.
+static bool isBeforeInFile(const RawComment *LHS, const RawComment *RHS) {
+  return LHS->getLocStart().getRawEncoding() <
+         RHS->getLocStart().getRawEncoding();
+}
+
 void RawCommentList::addComment(const RawComment &RC,
                                 llvm::BumpPtrAllocator &Allocator) {
   if (RC.isInvalid())
     return;
 
+  FileComments &FC = CommentsByFile[SourceMgr.getFileID(RC.getLocStart())];
+
   // Check if the comments are not in source order.
-  while (!Comments.empty() &&
-         !SourceMgr.isBeforeInTranslationUnit(Comments.back()->getLocStart(),
-                                              RC.getLocStart())) {
+  while (!FC.Comments.empty() && !isBeforeInFile(FC.Comments.back(), &RC)) {
     // If they are, just pop a few last comments that don't fit.
-    // This happens if an \#include directive contains comments.
-    Comments.pop_back();
+    FC.Comments.pop_back();
+    FC.NumMerged = std::min<unsigned>(FC.NumMerged, FC.Comments.size());
   }
 
   // Ordinary comments are not interesting for us.
   if (RC.isOrdinary())
     return;
 
-  // If this is the first Doxygen comment, save it (because there isn't
-  // anything to merge it with).
-  if (Comments.empty()) {
-    Comments.push_back(new (Allocator) RawComment(RC));
-    return;
+  // Merging is left until the comments of this file are looked up.
+  LastComment = new (Allocator) RawComment(RC);
+  FC.Comments.push_back(LastComment);
+}
+
+void RawCommentList::mergeComments(FileComments &FC) const {
+  std::vector<RawComment *> &Comments = FC.Comments;
+  unsigned NumKept = FC.NumMerged;
+  for (unsigned I = FC.NumMerged, E = Comments.size(); I != E; ++I) {
+    RawComment *C2 = Comments[I];
+    if (NumKept == 0 ||
+        !shouldMergeComments(SourceMgr, *Comments[NumKept - 1], *C2)) {
+      Comments[NumKept++] = C2;
+      continue;
+    }
+
+    RawComment *C1 = Comments[NumKept - 1];
+    SourceRange MergedRange(C1->getLocStart(), C2->getLocEnd());
+    *C1 = RawComment(SourceMgr, MergedRange, true, C2->isParseAllComments());
+    if (LastComment == C2)
+      LastComment = C1;
   }
+  Comments.resize(NumKept);
+  FC.NumMerged = NumKept;
+}
 
-  const RawComment &C1 = *Comments.back();
-  const RawComment &C2 = RC;
+ArrayRef<RawComment *> RawCommentList::getCommentsInFile(FileID File) const {
+  auto Known = CommentsByFile.find(File);
+  if (Known == CommentsByFile.end())
+    return None;
 
-  // Merge comments only if there is only whitespace between them.
-  // Can't merge trailing and non-trailing comments unless the second is
-  // non-trailing ordinary in the same column, as in the case:
-  //   int x; // documents x
-  //          // more text
-  // versus:
-  //   int x; // documents x
-  //   int y; // documents y
-  // or:
-  //   int x; // documents x
-  //   // documents y
-  //   int y;
-  // Merge comments if they are on same or consecutive lines.
-  if ((C1.isTrailingComment() == C2.isTrailingComment() ||
-       (C1.isTrailingComment() && !C2.isTrailingComment() &&
-        isOrdinaryKind(C2.getKind()) &&
-        commentsStartOnSameColumn(SourceMgr, C1, C2))) &&
-      onlyWhitespaceBetween(SourceMgr, C1.getLocEnd(), C2.getLocStart(),
-                            /*MaxNewlinesAllowed=*/1)) {
-    SourceRange MergedRange(C1.getLocStart(), C2.getLocEnd());
-    *Comments.back() = RawComment(SourceMgr, MergedRange, true,
-                                  RC.isParseAllComments());
-  } else {
-    Comments.push_back(new (Allocator) RawComment(RC));
+  FileComments &FC = Known->second;
+  if (FC.NumMerged != FC.Comments.size())
+    mergeComments(FC);
+  return FC.Comments;
+}
+
+std::vector<RawComment *> RawCommentList::getComments() const {
+  std::vector<RawComment *> Result;
+  for (auto &File : CommentsByFile) {
+    FileComments &FC = File.second;
+    if (FC.NumMerged != FC.Comments.size())
+      mergeComments(FC);
+    Result.insert(Result.end(), FC.Comments.begin(), FC.Comments.end());
   }
+  std::sort(Result.begin(), Result.end(),
+            BeforeThanCompare<RawComment>(SourceMgr));
+  return Result;
 }
 
 void RawCommentList::addDeserializedComments(ArrayRef<RawComment *> DeserializedComments) {
-  std::vector<RawComment *> MergedComments;
-  MergedComments.reserve(Comments.size() + DeserializedComments.size());
-
-  std::merge(Comments.begin(), Comments.end(),
-             DeserializedComments.begin(), DeserializedComments.end(),
-             std::back_inserter(MergedComments),
-             BeforeThanCompare<RawComment>(SourceMgr));
-  std::swap(Comments, MergedComments);
+  // Deserialized comments were merged before they were written, but merging
+  // them again is harmless, so just add them to the comments of their file.
+  SmallVector<FileID, 4> UnsortedFiles;
+  FileID LastFile;
+  FileComments *FC = nullptr;
+  for (RawComment *C : DeserializedComments) {
+    FileID File = SourceMgr.getFileID(C->getLocStart());
+    if (!FC || File != LastFile) {
+      FC = &CommentsByFile[File];
+      LastFile = File;
+    }
+    if (!FC->Comments.empty() && !isBeforeInFile(FC->Comments.back(), C)) {
+      UnsortedFiles.push_back(File);
+      FC->NumMerged = 0;
+    }
+    FC->Comments.push_back(C);
+  }
+
+  for (FileID File : UnsortedFiles) {
+    std::vector<RawComment *> &Comments = CommentsByFile[File].Comments;
+    if (!std::is_sorted(Comments.begin(), Comments.end(), isBeforeInFile))
+      std::sort(Comments.begin(), Comments.end(), isBeforeInFile);
+  }
 }
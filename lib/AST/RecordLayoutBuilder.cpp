@@ -2942,7 +2942,14 @@ ASTContext::getASTRecordLayout(const RecordDecl *D) const {
 
   const ASTRecordLayout *NewEntry = nullptr;
 
-  if (isMsLayout(*this)) {
+  // The layout may have been computed when an AST file was built, in which
+  // case there is no need to run a record layout builder.
+  if (ExternalASTSource *Source = getExternalSource())
+    NewEntry = Source->loadRecordLayout(D);
+
+  if (NewEntry) {
+    // Use the loaded layout as is.
+  } else if (isMsLayout(*this)) {
     MicrosoftRecordLayoutBuilder Builder(*this);
     if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
       Builder.cxxLayout(RD);
@@ -84,6 +84,19 @@ void Stmt::PrintStats() {
   llvm::errs() << "Total bytes = " << sum << "\n";
 }
 
+void Stmt::forEachClassStat(
+    llvm::function_ref<void(StringRef, unsigned, size_t)> Callback) {
+  // Ensure the table is primed.
+  getStmtInfoTableEntry(Stmt::NullStmtClass);
+
+  for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
+    if (StmtClassInfo[i].Name == nullptr || StmtClassInfo[i].Counter == 0)
+      continue;
+    Callback(StmtClassInfo[i].Name, StmtClassInfo[i].Counter,
+             StmtClassInfo[i].Size);
+  }
+}
+
 void Stmt::addStmtClass(StmtClass s) {
   ++getStmtInfoTableEntry(s).Counter;
 }
@@ -1473,6 +1473,16 @@ void TemplateSpecializationType::
 void TemplateSpecializationType::PrintTemplateArgumentList(
     raw_ostream &OS, ArrayRef<TemplateArgument> Args,
     const PrintingPolicy &Policy, bool SkipBrackets) {
+  // Abbreviate argument lists nested deeper than the policy allows. A pack
+  // is printed as part of the enclosing list, so it doesn't count.
+  if (!SkipBrackets && !Args.empty() && Policy.TemplateArgDepth == 1) {
+    OS << "<...>";
+    return;
+  }
+  PrintingPolicy ArgPolicy = Policy;
+  if (!SkipBrackets && ArgPolicy.TemplateArgDepth)
+    --ArgPolicy.TemplateArgDepth;
+
   const char *Comma = Policy.MSVCFormatting ? "," : ", ";
   if (!SkipBrackets)
     OS << '<';
@@ -1488,11 +1498,11 @@ void TemplateSpecializationType::PrintTemplateArgumentList(
         OS << Comma;
       PrintTemplateArgumentList(ArgOS,
                                 Arg.getPackAsArray(),
-                                Policy, true);
+                                ArgPolicy, true);
     } else {
       if (!FirstArg)
         OS << Comma;
-      Arg.print(Policy, ArgOS);
+      Arg.print(ArgPolicy, ArgOS);
     }
     StringRef ArgString = ArgOS.str();
 
@@ -1523,6 +1533,14 @@ void TemplateSpecializationType::
 PrintTemplateArgumentList(raw_ostream &OS,
                           ArrayRef<TemplateArgumentLoc> Args,
                           const PrintingPolicy &Policy) {
+  if (!Args.empty() && Policy.TemplateArgDepth == 1) {
+    OS << "<...>";
+    return;
+  }
+  PrintingPolicy ArgPolicy = Policy;
+  if (ArgPolicy.TemplateArgDepth)
+    --ArgPolicy.TemplateArgDepth;
+
   OS << '<';
   const char *Comma = Policy.MSVCFormatting ? "," : ", ";
 
@@ -1538,9 +1556,9 @@ PrintTemplateArgumentList(raw_ostream &OS,
     if (Arg.getArgument().getKind() == TemplateArgument::Pack) {
       PrintTemplateArgumentList(ArgOS,
                                 Arg.getArgument().getPackAsArray(),
-                                Policy, true);
+                                ArgPolicy, true);
     } else {
-      Arg.getArgument().print(Policy, ArgOS);
+      Arg.getArgument().print(ArgPolicy, ArgOS);
     }
     StringRef ArgString = ArgOS.str();
 
@@ -19,11 +19,15 @@
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Timer.h"
+#include <algorithm>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <set>
 
@@ -61,9 +65,27 @@ struct MatchKey {
   ast_type_traits::DynTypedNode Node;
   BoundNodesTreeBuilder BoundNodes;
 
-  bool operator<(const MatchKey &Other) const {
-    return std::tie(MatcherID, Node, BoundNodes) <
-           std::tie(Other.MatcherID, Other.Node, Other.BoundNodes);
+  bool operator==(const MatchKey &Other) const {
+    return MatcherID == Other.MatcherID && Node == Other.Node &&
+           BoundNodes == Other.BoundNodes;
+  }
+
+  // A cheap hash of the key, so that full comparisons are only needed for
+  // keys that are likely equal.
+  unsigned getFingerprint() const {
+    using namespace ast_type_traits;
+    unsigned NodeHash;
+    if (const void *NodeData = Node.getMemoizationData())
+      NodeHash = llvm::hash_value(NodeData);
+    else if (const QualType *T = Node.get<QualType>())
+      NodeHash = llvm::hash_value(T->getAsOpaquePtr());
+    else
+      NodeHash = DynTypedNode::DenseMapInfo::getHashValue(Node);
+    unsigned Hash = llvm::hash_combine(
+        ASTNodeKind::DenseMapInfo::getHashValue(MatcherID.first),
+        MatcherID.second, NodeHash, BoundNodes.getHashValue());
+    // Stay clear of the empty and tombstone keys of DenseMap<unsigned, ...>.
+    return Hash >> 1;
   }
 };
 
@@ -73,6 +95,49 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// Maps (matcher, node, bindings) keys to their match results.
+//
+// Entries are allocated in an arena and found through a hash table keyed by
+// fingerprint; entries whose fingerprints collide are chained and told apart
+// by comparing the full keys.
+class MemoizationCache {
+  struct Entry {
+    MatchKey Key;
+    MemoizedMatchResult Result;
+    Entry *Next;
+  };
+
+  llvm::DenseMap<unsigned, Entry *> Buckets;
+  llvm::SpecificBumpPtrAllocator<Entry> Entries;
+  unsigned NumEntries = 0;
+
+public:
+  unsigned size() const { return NumEntries; }
+
+  const MemoizedMatchResult *find(const MatchKey &Key,
+                                  unsigned Fingerprint) const {
+    for (Entry *E = Buckets.lookup(Fingerprint); E; E = E->Next)
+      if (E->Key == Key)
+        return &E->Result;
+    return nullptr;
+  }
+
+  const MemoizedMatchResult &insert(MatchKey Key, unsigned Fingerprint,
+                                    MemoizedMatchResult Result) {
+    Entry *&Bucket = Buckets[Fingerprint];
+    Bucket = new (Entries.Allocate())
+        Entry{std::move(Key), std::move(Result), Bucket};
+    ++NumEntries;
+    return Bucket->Result;
+  }
+
+  void clear() {
+    Buckets.clear();
+    Entries.DestroyAll();
+    NumEntries = 0;
+  }
+};
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -313,6 +378,11 @@ public:
     if (Options.CheckProfiling) {
       Options.CheckProfiling->Records = std::move(TimeByBucket);
     }
+    if (Options.MemoizationStats) {
+      Options.MemoizationStats->Hits += MemoizationStats.Hits;
+      Options.MemoizationStats->Misses += MemoizationStats.Misses;
+      Options.MemoizationStats->Evictions += MemoizationStats.Evictions;
+    }
   }
 
   void onStartOfTranslationUnit() {
@@ -335,8 +405,21 @@ public:
     }
   }
 
+  // Traverses the traversal scope of the AST context, or the whole
+  // translation unit if it has none.
+  void traverseScope() {
+    const std::vector<Decl *> &Scope = ActiveASTContext->getTraversalScope();
+    if (Scope.empty()) {
+      TraverseDecl(ActiveASTContext->getTranslationUnitDecl());
+      return;
+    }
+    for (Decl *D : Scope)
+      TraverseDecl(D);
+  }
+
   void set_active_ast_context(ASTContext *NewActiveASTContext) {
     ActiveASTContext = NewActiveASTContext;
+    ResolvedNamesCache.clear();
   }
 
   // The following Visit*() and Traverse*() functions "override"
@@ -385,6 +468,20 @@ public:
   bool TraverseNestedNameSpecifierLoc(NestedNameSpecifierLoc NNS);
   bool TraverseConstructorInitializer(CXXCtorInitializer *CtorInit);
 
+  // Empties the memoization cache.
+  void evictResultCache() {
+    if (!ResultCache.size())
+      return;
+    ResultCache.clear();
+    ++MemoizationStats.Evictions;
+  }
+
+  // Empties the memoization cache if it grew too large.
+  void limitResultCache() {
+    if (ResultCache.size() > MaxMemoizationEntries)
+      evictResultCache();
+  }
+
   // Matches children or descendants of 'Node' with 'BaseMatcher'.
   bool memoizedMatchesRecursively(const ast_type_traits::DynTypedNode &Node,
                                   const DynTypedMatcher &Matcher,
@@ -401,19 +498,22 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    unsigned Fingerprint = Key.getFingerprint();
+    if (const MemoizedMatchResult *Cached =
+            ResultCache.find(Key, Fingerprint)) {
+      ++MemoizationStats.Hits;
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
+    ++MemoizationStats.Misses;
 
     MemoizedMatchResult Result;
     Result.Nodes = *Builder;
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(std::move(Key), Fingerprint, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -439,8 +539,7 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    limitResultCache();
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -449,8 +548,7 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    limitResultCache();
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       TK_AsIs, Bind);
   }
@@ -460,9 +558,8 @@ public:
                          BoundNodesTreeBuilder *Builder,
                          AncestorMatchMode MatchMode) override {
     // Reset the cache outside of the recursive call to make sure we
-    // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    // don't invalidate any entries.
+    limitResultCache();
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
@@ -497,6 +594,22 @@ public:
   // Implements ASTMatchFinder::getASTContext.
   ASTContext &getASTContext() const override { return *ActiveASTContext; }
 
+  const HasNameMatcher::ResolvedNames *
+  getResolvedNames(const HasNameMatcher &Matcher) override {
+    ResolvedNamesEntry &Entry = ResolvedNamesCache[&Matcher];
+    if (Entry.MatcherID != Matcher.getID()) {
+      // Matchers that are built while matching, and may only be used once,
+      // are matched as strings until they are seen again.
+      Entry.MatcherID = Matcher.getID();
+      Entry.Resolved.reset();
+      return nullptr;
+    }
+    if (!Entry.Resolved)
+      Entry.Resolved.reset(new HasNameMatcher::ResolvedNames(
+          Matcher.resolveNames(*ActiveASTContext)));
+    return Entry.Resolved.get();
+  }
+
   bool shouldVisitTemplateInstantiations() const { return true; }
   bool shouldVisitImplicitCode() const { return true; }
 
@@ -547,6 +660,26 @@ private:
     }
   }
 
+  /// \brief The matchers to run on nodes of one kind.
+  ///
+  /// Matchers that can only match nodes with one of a set of names, like
+  /// those that start with \c hasName(), are indexed by those names instead,
+  /// so that the matchers ruled out by the name of a node are never run.
+  struct MatcherFilter {
+    MatcherFilter() : HasGuarded(false) {}
+
+    bool empty() const { return Unguarded.empty() && !HasGuarded; }
+
+    /// \brief Matchers without a name guard, which run on every node.
+    std::vector<unsigned short> Unguarded;
+    /// \brief Guarded matchers by the names they accept, for each
+    /// \c NameGuard::GuardSource.
+    llvm::StringMap<std::vector<unsigned short>> ByName[2];
+    /// \brief All guarded matchers, for each \c NameGuard::GuardSource.
+    std::vector<unsigned short> Guarded[2];
+    bool HasGuarded;
+  };
+
   void matchWithFilter(const ast_type_traits::DynTypedNode &DynNode) {
     auto Kind = DynNode.getNodeKind();
     auto it = MatcherFiltersMap.find(Kind);
@@ -556,10 +689,51 @@ private:
     if (Filter.empty())
       return;
 
+    // Look the node up once in the name indexes of the filter, instead of
+    // running the name check of every guarded matcher on it.
+    SmallVector<unsigned short, 16> Candidates;
+    bool HasGuardedCandidates = false;
+    if (Filter.HasGuarded) {
+      llvm::SmallString<128> Scratch;
+      const NamedDecl *Decls[] = {DynNode.get<NamedDecl>(), nullptr};
+      if (const auto *Call = DynNode.get<CallExpr>())
+        Decls[NameGuard::NS_CalleeDecl] =
+            dyn_cast_or_null<NamedDecl>(Call->getCalleeDecl());
+      for (unsigned Source : {NameGuard::NS_Decl, NameGuard::NS_CalleeDecl}) {
+        if (!Decls[Source])
+          continue;
+        StringRef Name = getNodeName(*Decls[Source], Scratch);
+        ArrayRef<unsigned short> Guarded;
+        if (Name.find("::") != StringRef::npos) {
+          // Printed names may contain '::', which the patterns are split at.
+          Guarded = Filter.Guarded[Source];
+        } else {
+          auto NameIt = Filter.ByName[Source].find(Name);
+          if (NameIt != Filter.ByName[Source].end())
+            Guarded = NameIt->second;
+        }
+        if (Guarded.empty())
+          continue;
+        if (!HasGuardedCandidates)
+          Candidates.append(Filter.Unguarded.begin(), Filter.Unguarded.end());
+        Candidates.append(Guarded.begin(), Guarded.end());
+        HasGuardedCandidates = true;
+      }
+      if (HasGuardedCandidates) {
+        // Keep the order in which the matchers were added.
+        std::sort(Candidates.begin(), Candidates.end());
+        Candidates.erase(std::unique(Candidates.begin(), Candidates.end()),
+                         Candidates.end());
+      }
+    }
+    ArrayRef<unsigned short> Indices =
+        HasGuardedCandidates ? ArrayRef<unsigned short>(Candidates)
+                             : ArrayRef<unsigned short>(Filter.Unguarded);
+
     const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
     TimeBucketRegion Timer;
     auto &Matchers = this->Matchers->DeclOrStmt;
-    for (unsigned short I : Filter) {
+    for (unsigned short I : Indices) {
       auto &MP = Matchers[I];
       if (EnableCheckProfiling)
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
@@ -571,14 +745,33 @@ private:
     }
   }
 
-  const std::vector<unsigned short> &
-  getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
-    auto &Filter = MatcherFiltersMap[Kind];
+  const MatcherFilter &getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
+    if (MatcherGuards.empty() && !Matchers.empty()) {
+      MatcherGuards.resize(Matchers.size());
+      for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
+        NameGuard Guard;
+        if (Matchers[I].first.getNameGuard(Guard))
+          MatcherGuards[I] = std::move(Guard);
+      }
+    }
+
+    auto &Filter = MatcherFiltersMap[Kind];
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
-      if (Matchers[I].first.canMatchNodesOfKind(Kind)) {
-        Filter.push_back(I);
+      if (!Matchers[I].first.canMatchNodesOfKind(Kind))
+        continue;
+      const llvm::Optional<NameGuard> &Guard = MatcherGuards[I];
+      if (!Guard) {
+        Filter.Unguarded.push_back(I);
+        continue;
+      }
+      Filter.HasGuarded = true;
+      Filter.Guarded[Guard->Source].push_back(I);
+      for (const std::string &Name : Guard->Names) {
+        auto &Indices = Filter.ByName[Guard->Source][Name];
+        if (Indices.empty() || Indices.back() != I)
+          Indices.push_back(I);
       }
     }
     return Filter;
@@ -643,21 +836,24 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    // Note that we cannot insert before matching and reuse the entry, as
+    // recursive calls to match might empty the result cache.
+    unsigned Fingerprint = Key.getFingerprint();
+    if (const MemoizedMatchResult *Cached =
+            ResultCache.find(Key, Fingerprint)) {
+      ++MemoizationStats.Hits;
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
+    ++MemoizationStats.Misses;
 
     MemoizedMatchResult Result;
     Result.Nodes = *Builder;
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(std::move(Key), Fingerprint, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -759,9 +955,28 @@ private:
   /// We precalculate a list of matchers that pass the toplevel restrict check.
   /// This also allows us to skip the restrict check at matching time. See
   /// use \c matchesNoKindCheck() above.
-  llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
+  ///
+  /// Matchers with a name guard are indexed by name, see \c MatcherFilter.
+  llvm::DenseMap<ast_type_traits::ASTNodeKind, MatcherFilter>
       MatcherFiltersMap;
 
+  /// \brief The patterns of each \c hasName() matcher, resolved to the
+  /// identifiers of the AST being matched.
+  ///
+  /// Keyed by address, and checked against the ID of the matcher in case the
+  /// address was reused.
+  struct ResolvedNamesEntry {
+    ResolvedNamesEntry() : MatcherID(0) {}
+
+    uint64_t MatcherID;
+    std::unique_ptr<HasNameMatcher::ResolvedNames> Resolved;
+  };
+  llvm::DenseMap<const HasNameMatcher *, ResolvedNamesEntry>
+      ResolvedNamesCache;
+
+  /// \brief The name guard of each \c DeclOrStmt matcher, computed once.
+  std::vector<llvm::Optional<NameGuard>> MatcherGuards;
+
   const MatchFinder::MatchFinderOptions &Options;
   ASTContext *ActiveASTContext;
 
@@ -769,8 +984,8 @@ private:
   llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
 
   // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
-  MemoizationMap ResultCache;
+  MemoizationCache ResultCache;
+  MatchFinder::MatchFinderOptions::MemoizationStatistics MemoizationStats;
 };
 
 static CXXRecordDecl *
@@ -835,7 +1050,14 @@ bool MatchASTVisitor::TraverseDecl(Decl *DeclNode) {
     return true;
   }
   match(*DeclNode);
-  return RecursiveASTVisitor<MatchASTVisitor>::TraverseDecl(DeclNode);
+  bool Result = RecursiveASTVisitor<MatchASTVisitor>::TraverseDecl(DeclNode);
+
+  // Matches memoized within a top-level declaration are rarely needed once
+  // it has been traversed; drop them to keep the cache small.
+  const DeclContext *DC = DeclNode->getLexicalDeclContext();
+  if (DC && DC->isTranslationUnit())
+    evictResultCache();
+  return Result;
 }
 
 bool MatchASTVisitor::TraverseStmt(Stmt *StmtNode) {
@@ -893,6 +1115,71 @@ bool MatchASTVisitor::TraverseConstructorInitializer(
       CtorInit);
 }
 
+// Returns the top-level declarations in the files ShouldMatchFile accepts,
+// in translation unit order, without deserializing any others.
+static std::vector<Decl *>
+getTopLevelDeclsInFiles(
+    ASTContext &Context,
+    const std::function<bool(const SourceManager &, FileID)> &ShouldMatchFile) {
+  SourceManager &SM = Context.getSourceManager();
+  llvm::DenseMap<FileID, bool> Accepted;
+  auto IsAccepted = [&](FileID FID) {
+    auto It = Accepted.insert(std::make_pair(FID, false));
+    if (It.second)
+      It.first->second = ShouldMatchFile(SM, FID);
+    return It.first->second;
+  };
+  // Implicit declarations, which are in no file, are never matched.
+  auto IsInAcceptedFile = [&](const Decl *D) {
+    SourceLocation Loc = D->getLocation();
+    return Loc.isValid() && IsAccepted(SM.getFileID(SM.getExpansionLoc(Loc)));
+  };
+
+  std::vector<Decl *> Decls;
+  const std::vector<Decl *> &Scope = Context.getTraversalScope();
+  if (!Scope.empty()) {
+    std::copy_if(Scope.begin(), Scope.end(), std::back_inserter(Decls),
+                 IsInAcceptedFile);
+    return Decls;
+  }
+
+  // The declarations that were parsed or have already been deserialized.
+  TranslationUnitDecl *TU = Context.getTranslationUnitDecl();
+  for (Decl *D : TU->noload_decls())
+    if (IsInAcceptedFile(D))
+      Decls.push_back(D);
+  ExternalASTSource *Source = Context.getExternalSource();
+  if (!Source)
+    return Decls;
+
+  // The external source can find the declarations of a file without
+  // deserializing those of the other ones.
+  llvm::SmallPtrSet<Decl *, 32> Seen(Decls.begin(), Decls.end());
+  size_t NumLoaded = Decls.size();
+  for (unsigned I = 0, E = SM.loaded_sloc_entry_size(); I != E; ++I) {
+    const SrcMgr::SLocEntry &Entry = SM.getLoadedSLocEntry(I);
+    if (!Entry.isFile())
+      continue;
+    FileID FID =
+        SM.getFileID(SourceLocation::getFromRawEncoding(Entry.getOffset()));
+    if (!IsAccepted(FID))
+      continue;
+    SmallVector<Decl *, 32> FileDecls;
+    Source->FindFileRegionDecls(FID, 0, SM.getFileIDSize(FID), FileDecls);
+    for (Decl *D : FileDecls)
+      if (D->getLexicalDeclContext() == TU && Seen.insert(D).second)
+        Decls.push_back(D);
+  }
+  if (Decls.size() == NumLoaded)
+    return Decls;
+  std::stable_sort(Decls.begin(), Decls.end(),
+                   [&](const Decl *LHS, const Decl *RHS) {
+    return SM.isBeforeInTranslationUnit(SM.getExpansionLoc(LHS->getLocStart()),
+                                        SM.getExpansionLoc(RHS->getLocStart()));
+  });
+  return Decls;
+}
+
 class MatchASTConsumer : public ASTConsumer {
 public:
   MatchASTConsumer(MatchFinder *Finder,
@@ -1011,8 +1298,22 @@ void MatchFinder::matchAST(ASTContext &Context) {
   internal::MatchASTVisitor Visitor(&Matchers, Options);
   Visitor.set_active_ast_context(&Context);
   Visitor.onStartOfTranslationUnit();
-  Visitor.TraverseDecl(Context.getTranslationUnitDecl());
+  std::vector<Decl *> OldScope;
+  bool MatchesAnything = true;
+  if (Options.ShouldMatchFile) {
+    OldScope = Context.getTraversalScope();
+    std::vector<Decl *> Scope =
+        internal::getTopLevelDeclsInFiles(Context, Options.ShouldMatchFile);
+    // An empty traversal scope would be the whole translation unit.
+    MatchesAnything = !Scope.empty();
+    if (MatchesAnything)
+      Context.setTraversalScope(Scope);
+  }
+  if (MatchesAnything)
+    Visitor.traverseScope();
   Visitor.onEndOfTranslationUnit();
+  if (Options.ShouldMatchFile && MatchesAnything)
+    Context.setTraversalScope(OldScope);
 }
 
 void MatchFinder::registerTestCallbackAfterParsing(
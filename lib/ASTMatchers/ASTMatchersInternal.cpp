@@ -13,9 +13,13 @@
 
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/ASTMatchers/ASTMatchersInternal.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ManagedStatic.h"
+#include <atomic>
 
 namespace clang {
 namespace ast_matchers {
@@ -41,6 +45,15 @@ bool AnyOfVariadicOperator(const ast_type_traits::DynTypedNode &DynNode,
                            ArrayRef<DynTypedMatcher> InnerMatchers);
 
 
+unsigned BoundNodesTreeBuilder::getHashValue() const {
+  llvm::hash_code Hash = llvm::hash_value(Bindings.size());
+  for (const BoundNodesMap &Binding : Bindings)
+    for (const auto &IDAndNode : Binding.getMap())
+      Hash = llvm::hash_combine(Hash, IDAndNode.first,
+                                IDAndNode.second.getMemoizationData());
+  return Hash;
+}
+
 void BoundNodesTreeBuilder::visitMatches(Visitor *ResultVisitor) {
   if (Bindings.empty())
     Bindings.push_back(BoundNodesMap());
@@ -67,6 +80,32 @@ public:
     return Func(DynNode, Finder, Builder, InnerMatchers);
   }
 
+  bool getNameGuard(NameGuard &Guard) const override {
+    // allOf() has to pass the guard of any of its matchers.
+    if (Func == AllOfVariadicOperator) {
+      for (const DynTypedMatcher &InnerMatcher : InnerMatchers)
+        if (InnerMatcher.getNameGuard(Guard))
+          return true;
+      return false;
+    }
+    // anyOf() and eachOf() have to pass the guard of one of their matchers,
+    // so they are only guarded if all of them are, on the same name.
+    if (Func != AnyOfVariadicOperator && Func != EachOfVariadicOperator)
+      return false;
+    NameGuard Union;
+    for (size_t I = 0, E = InnerMatchers.size(); I != E; ++I) {
+      NameGuard InnerGuard;
+      if (!InnerMatchers[I].getNameGuard(InnerGuard) ||
+          (I != 0 && InnerGuard.Source != Union.Source))
+        return false;
+      Union.Source = InnerGuard.Source;
+      Union.Names.insert(Union.Names.end(), InnerGuard.Names.begin(),
+                         InnerGuard.Names.end());
+    }
+    Guard = std::move(Union);
+    return true;
+  }
+
 private:
   std::vector<DynTypedMatcher> InnerMatchers;
 };
@@ -85,6 +124,10 @@ public:
     return Result;
   }
 
+  bool getNameGuard(NameGuard &Guard) const override {
+    return InnerMatcher->getNameGuard(Guard);
+  }
+
 private:
   const std::string ID;
   const IntrusiveRefCntPtr<DynMatcherInterface> InnerMatcher;
@@ -303,11 +346,13 @@ Matcher<NamedDecl> hasAnyNameFunc(ArrayRef<const StringRef *> NameRefs) {
       new internal::HasNameMatcher(std::move(Names)));
 }
 
+static std::atomic<uint64_t> NextHasNameMatcherID;
+
 HasNameMatcher::HasNameMatcher(std::vector<std::string> N)
     : UseUnqualifiedMatch(std::all_of(
           N.begin(), N.end(),
           [](StringRef Name) { return Name.find("::") == Name.npos; })),
-      Names(std::move(N)) {
+      Names(std::move(N)), ID(++NextHasNameMatcherID) {
 #ifndef NDEBUG
   for (StringRef Name : Names)
     assert(!Name.empty());
@@ -330,6 +375,8 @@ bool consumeNameSuffix(StringRef &FullName, StringRef Suffix) {
   return true;
 }
 
+}  // namespace
+
 StringRef getNodeName(const NamedDecl &Node, llvm::SmallString<128> &Scratch) {
   // Simple name.
   if (Node.getIdentifier())
@@ -346,6 +393,8 @@ StringRef getNodeName(const NamedDecl &Node, llvm::SmallString<128> &Scratch) {
   return "(anonymous)";
 }
 
+namespace {
+
 StringRef getNodeName(const RecordDecl &Node, llvm::SmallString<128> &Scratch) {
   if (Node.getIdentifier()) {
     return Node.getName();
@@ -494,6 +543,124 @@ bool HasNameMatcher::matchesNodeFullSlow(const NamedDecl &Node) const {
   return false;
 }
 
+bool HasNameMatcher::getNameGuard(NameGuard &Guard) const {
+  // The name of a matching node is a pattern, or the part of one after any of
+  // its '::'.
+  Guard.Source = NameGuard::NS_Decl;
+  Guard.Names.clear();
+  for (StringRef Name : Names) {
+    Guard.Names.push_back(Name);
+    for (size_t Pos = Name.find("::"); Pos != StringRef::npos;
+         Pos = Name.find("::", Pos + 2))
+      Guard.Names.push_back(Name.substr(Pos + 2));
+  }
+  return true;
+}
+
+HasNameMatcher::ResolvedNames
+HasNameMatcher::resolveNames(ASTContext &Context) const {
+  ResolvedNames Resolved;
+  Resolved.AllResolved = true;
+  for (StringRef Name : Names) {
+    ResolvedNames::Pattern Pattern;
+    Pattern.IsFullyQualified = Name.startswith("::");
+    if (Pattern.IsFullyQualified)
+      Name = Name.drop_front(2);
+    SmallVector<StringRef, 4> Parts;
+    Name.split(Parts, "::");
+    for (StringRef Part : llvm::reverse(Parts)) {
+      // Names that need to be printed, like operators and template
+      // specializations, have no identifier to compare.
+      if (!isValidIdentifier(Part)) {
+        Resolved.AllResolved = false;
+        Resolved.Patterns.clear();
+        return Resolved;
+      }
+      Pattern.Parts.push_back(&Context.Idents.get(Part));
+    }
+    Resolved.Patterns.push_back(std::move(Pattern));
+  }
+  return Resolved;
+}
+
+bool HasNameMatcher::matchesNodeResolved(const NamedDecl &Node,
+                                         const ResolvedNames &Resolved) const {
+  struct Candidate {
+    ArrayRef<IdentifierInfo *> Parts;
+    bool IsFullyQualified;
+  };
+  SmallVector<Candidate, 8> Candidates;
+
+  // First, match the name.
+  const IdentifierInfo *II = Node.getIdentifier();
+  assert(II && "Only nodes with an identifier are matched by identifier");
+  for (const ResolvedNames::Pattern &Pattern : Resolved.Patterns)
+    if (Pattern.Parts.front() == II)
+      Candidates.push_back(
+          {makeArrayRef(Pattern.Parts).drop_front(), Pattern.IsFullyQualified});
+  if (Candidates.empty())
+    return false;
+  if (UseUnqualifiedMatch)
+    return true;
+
+  auto FoundMatch = [&](bool AllowFullyQualified) {
+    return std::any_of(Candidates.begin(), Candidates.end(),
+                       [&](const Candidate &C) {
+      return C.Parts.empty() && (AllowFullyQualified || !C.IsFullyQualified);
+    });
+  };
+
+  // Then walk the declaration contexts like matchesNodeFullFast().
+  const DeclContext *Ctx = Node.getDeclContext();
+
+  if (Ctx->isFunctionOrMethod())
+    return FoundMatch(/*AllowFullyQualified=*/false);
+
+  for (; Ctx && isa<NamedDecl>(Ctx); Ctx = Ctx->getParent()) {
+    if (FoundMatch(/*AllowFullyQualified=*/false))
+      return true;
+
+    bool CanSkip;
+    if (const auto *ND = dyn_cast<NamespaceDecl>(Ctx))
+      CanSkip = ND->isAnonymousNamespace() || ND->isInline();
+    else if (isa<RecordDecl>(Ctx) && !isa<ClassTemplateSpecializationDecl>(Ctx))
+      CanSkip = false;
+    else
+      return matchesNodeFullSlow(Node);
+
+    // Anonymous namespaces and records have no identifier, and match no
+    // pattern.
+    II = cast<NamedDecl>(Ctx)->getIdentifier();
+    for (size_t I = 0; I < Candidates.size();) {
+      ArrayRef<IdentifierInfo *> &Parts = Candidates[I].Parts;
+      if (II && !Parts.empty() && Parts.front() == II) {
+        Parts = Parts.drop_front();
+        ++I;
+      } else if (CanSkip) {
+        ++I;
+      } else {
+        Candidates.erase(Candidates.begin() + I);
+      }
+    }
+    if (Candidates.empty())
+      return false;
+  }
+
+  return FoundMatch(/*AllowFullyQualified=*/true);
+}
+
+bool HasNameMatcher::matches(const NamedDecl &Node, ASTMatchFinder *Finder,
+                             BoundNodesTreeBuilder *Builder) const {
+  if (Finder && Node.getIdentifier()) {
+    const ResolvedNames *Resolved = Finder->getResolvedNames(*this);
+    if (Resolved && Resolved->AllResolved) {
+      assert(matchesNodeResolved(Node, *Resolved) == matchesNode(Node));
+      return matchesNodeResolved(Node, *Resolved);
+    }
+  }
+  return matchesNode(Node);
+}
+
 bool HasNameMatcher::matchesNode(const NamedDecl &Node) const {
   assert(matchesNodeFullFast(Node) == matchesNodeFullSlow(Node));
   if (UseUnqualifiedMatch) {
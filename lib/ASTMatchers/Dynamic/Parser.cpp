@@ -607,6 +607,72 @@ Parser::parseMatcherExpression(StringRef Code, Sema *S,
   return Result;
 }
 
+/// \brief Returns \p Code without the whitespace that does not separate
+/// tokens, and with single spaces for the rest.
+static std::string canonicalizeMatcherCode(StringRef Code) {
+  std::string Result;
+  Result.reserve(Code.size());
+  char Marker = 0;
+  bool InEscape = false;
+  bool PendingSpace = false;
+  for (char C : Code) {
+    if (Marker) {
+      // Inside a string literal, see CodeTokenizer::consumeStringLiteral().
+      Result += C;
+      if (InEscape)
+        InEscape = false;
+      else if (C == '\\')
+        InEscape = true;
+      else if (C == Marker)
+        Marker = 0;
+      continue;
+    }
+    if (isWhitespace(C)) {
+      PendingSpace = true;
+      continue;
+    }
+    if (PendingSpace && !Result.empty() && isIdentifierBody(Result.back()) &&
+        isIdentifierBody(C))
+      Result += ' ';
+    PendingSpace = false;
+    if (C == '"' || C == '\'')
+      Marker = C;
+    Result += C;
+  }
+  return Result;
+}
+
+llvm::Optional<DynTypedMatcher>
+MatcherExpressionCache::parse(StringRef MatcherCode, Diagnostics *Error) {
+  std::string Key = canonicalizeMatcherCode(MatcherCode);
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Matchers.find(Key);
+    if (It != Matchers.end())
+      return It->second;
+  }
+
+  // Parse without holding the lock; if another thread parsed the same
+  // expression meanwhile, either matcher will do.
+  llvm::Optional<DynTypedMatcher> Result =
+      Parser::parseMatcherExpression(MatcherCode, nullptr, NamedValues, Error);
+  if (Result) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Matchers.insert(std::make_pair(Key, *Result));
+  }
+  return Result;
+}
+
+size_t MatcherExpressionCache::size() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Matchers.size();
+}
+
+void MatcherExpressionCache::clear() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Matchers.clear();
+}
+
 }  // namespace dynamic
 }  // namespace ast_matchers
 }  // namespace clang
@@ -27,12 +27,20 @@
 #include "clang/Analysis/CFGStmtMap.h"
 #include "clang/Analysis/Support/BumpVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 
+#define DEBUG_TYPE "AnalysisDeclContext"
+
+STATISTIC(NumAnalysesRun,
+          "The # of analyses run for an AnalysisDeclContext");
+STATISTIC(NumAnalysisCacheHits,
+          "The # of analysis requests answered by an earlier run");
+
 typedef llvm::DenseMap<const void *, ManagedAnalysis *> ManagedAnalysisMap;
 
 AnalysisDeclContext::AnalysisDeclContext(AnalysisDeclContextManager *Mgr,
@@ -580,11 +588,24 @@ AnalysisDeclContext::getReferencedBlockVars(const BlockDecl *BD) {
   return llvm::make_range(V->begin(), V->end());
 }
 
-ManagedAnalysis *&AnalysisDeclContext::getAnalysisImpl(const void *tag) {
+ManagedAnalysis *AnalysisDeclContext::getAnalysisImpl(const void *Tag,
+                                                      AnalysisCreator Create) {
   if (!ManagedAnalyses)
     ManagedAnalyses = new ManagedAnalysisMap();
   ManagedAnalysisMap *M = (ManagedAnalysisMap*) ManagedAnalyses;
-  return (*M)[tag];
+  ManagedAnalysisMap::iterator I = M->find(Tag);
+  if (I != M->end() && I->second) {
+    ++NumAnalysisCacheHits;
+    return I->second;
+  }
+
+  // Running the analysis may request other analyses, adding them to the map,
+  // so only insert this one once it is done.
+  ManagedAnalysis *A = Create(*this);
+  if (A)
+    ++NumAnalysesRun;
+  (*M)[Tag] = A;
+  return A;
 }
 
 //===----------------------------------------------------------------------===//
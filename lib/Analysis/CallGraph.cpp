@@ -53,10 +53,7 @@ public:
   }
 
   void addCalledDecl(Decl *D) {
-    if (G->includeInGraph(D)) {
-      CallGraphNode *CalleeNode = G->getOrInsertNode(D);
-      CallerNode->addCallee(CalleeNode);
-    }
+    G->addCall(CallerNode, D);
   }
 
   void VisitCallExpr(CallExpr *CE) {
@@ -131,10 +128,34 @@ void CallGraph::addNodeForDecl(Decl* D, bool IsGlobal) {
   // Allocate a new node, mark it as root, and process it's calls.
   CallGraphNode *Node = getOrInsertNode(D);
 
+  // The body of a function may be reached through several of its
+  // declarations, or be added again; only process its calls once.
+  if (!DeclsWithCallees.insert(getNodeKey(D)).second)
+    return;
+
   // Process all the calls by this function as well.
   CGBuilder builder(this, Node);
   if (Stmt *Body = D->getBody())
     builder.Visit(Body);
+
+  // Add the calls made before the function was defined.
+  auto I = DeferredCallers.find(getNodeKey(D));
+  if (I != DeferredCallers.end()) {
+    for (CallGraphNode *Caller : I->second)
+      Caller->addCallee(Node);
+    DeferredCallers.erase(I);
+  }
+}
+
+void CallGraph::addCall(CallGraphNode *Caller, Decl *Callee) {
+  if (includeInGraph(Callee)) {
+    Caller->addCallee(getOrInsertNode(Callee));
+    return;
+  }
+
+  // The callee may still be defined later on.
+  if (!Callee->hasBody())
+    DeferredCallers[getNodeKey(Callee)].push_back(Caller);
 }
 
 CallGraphNode *CallGraph::getNode(const Decl *F) const {
@@ -144,8 +165,7 @@ CallGraphNode *CallGraph::getNode(const Decl *F) const {
 }
 
 CallGraphNode *CallGraph::getOrInsertNode(Decl *F) {
-  if (F && !isa<ObjCMethodDecl>(F))
-    F = F->getCanonicalDecl();
+  F = const_cast<Decl *>(getNodeKey(F));
 
   std::unique_ptr<CallGraphNode> &Node = FunctionMap[F];
   if (Node)
@@ -18,9 +18,13 @@
 #include "clang/AST/Stmt.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
 
 using namespace clang;
 
@@ -155,6 +159,13 @@ public:
       addVariables(S);
   }
 
+  /// \brief Adds the pattern to \p ID. Two patterns of clones have no
+  ///        differences if and only if they add the same data.
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    for (const VariableOccurence &Occurence : Occurences)
+      ID.AddInteger(Occurence.KindID);
+  }
+
   /// \brief Counts the differences between this pattern and the given one.
   /// \param Other The given VariablePattern to compare with.
   /// \param FirstMismatch Output parameter that will be filled with information
@@ -676,21 +687,27 @@ static void CollectStmtSequenceData(const StmtSequence &Sequence,
   }
 }
 
-/// \brief Returns true if both sequences are clones of each other.
-static bool areSequencesClones(const StmtSequence &LHS,
-                               const StmtSequence &RHS) {
-  // We collect the data from all statements in the sequence as we did before
-  // when generating a hash value for each sequence. But this time we don't
-  // hash the collected data and compare the whole data set instead. This
-  // prevents any false-positives due to hash code collisions.
-  llvm::FoldingSetNodeID DataLHS, DataRHS;
-  FoldingSetNodeIDWrapper LHSWrapper(DataLHS);
-  FoldingSetNodeIDWrapper RHSWrapper(DataRHS);
-
-  CollectStmtSequenceData(LHS, LHSWrapper);
-  CollectStmtSequenceData(RHS, RHSWrapper);
-
-  return DataLHS == DataRHS;
+/// \brief Splits \p Indexes into lists of indexes with identical \p Data, in
+///        the order of their first index.
+static std::vector<std::vector<unsigned>>
+splitByData(ArrayRef<unsigned> Indexes,
+            ArrayRef<llvm::FoldingSetNodeID> Data) {
+  std::vector<std::vector<unsigned>> Lists;
+  std::map<unsigned, SmallVector<unsigned, 1>> ListsByHash;
+  for (unsigned I : Indexes) {
+    SmallVectorImpl<unsigned> &Candidates = ListsByHash[Data[I].ComputeHash()];
+    auto List = std::find_if(Candidates.begin(), Candidates.end(),
+                             [&](unsigned L) {
+                               return Data[Lists[L].front()] == Data[I];
+                             });
+    if (List != Candidates.end()) {
+      Lists[*List].push_back(I);
+      continue;
+    }
+    Candidates.push_back(Lists.size());
+    Lists.push_back(std::vector<unsigned>(1, I));
+  }
+  return Lists;
 }
 
 /// \brief Finds all actual clone groups in a single group of presumed clones.
@@ -704,57 +721,58 @@ static bool areSequencesClones(const StmtSequence &LHS,
 static void createCloneGroups(std::vector<CloneDetector::CloneGroup> &Result,
                               const CloneDetector::CloneGroup &Group,
                               bool CheckVariablePattern) {
-  // We remove the Sequences one by one, so a list is more appropriate.
-  std::list<StmtSequence> UnassignedSequences(Group.Sequences.begin(),
-                                              Group.Sequences.end());
-
-  // Search for clones as long as there could be clones in UnassignedSequences.
-  while (UnassignedSequences.size() > 1) {
-
-    // Pick the first Sequence as a protoype for a new clone group.
-    StmtSequence Prototype = UnassignedSequences.front();
-    UnassignedSequences.pop_front();
-
-    CloneDetector::CloneGroup FilteredGroup(Prototype, Group.Signature);
-
-    // Analyze the variable pattern of the prototype. Every other StmtSequence
-    // needs to have the same pattern to get into the new clone group.
-    VariablePattern PrototypeFeatures(Prototype);
-
-    // Search all remaining StmtSequences for an identical variable pattern
-    // and assign them to our new clone group.
-    auto I = UnassignedSequences.begin(), E = UnassignedSequences.end();
-    while (I != E) {
-      // If the sequence doesn't fit to the prototype, we have encountered
-      // an unintended hash code collision and we skip it.
-      if (!areSequencesClones(Prototype, *I)) {
-        ++I;
-        continue;
-      }
-
-      // If we weren't asked to check for a matching variable pattern in clone
-      // groups we can add the sequence now to the new clone group.
-      // If we were asked to check for matching variable pattern, we first have
-      // to check that there are no differences between the two patterns and
-      // only proceed if they match.
-      if (!CheckVariablePattern ||
-          VariablePattern(*I).countPatternDifferences(PrototypeFeatures) == 0) {
-        FilteredGroup.Sequences.push_back(*I);
-        I = UnassignedSequences.erase(I);
-        continue;
-      }
+  // We collect the data from all statements in every sequence as we did before
+  // when generating a hash value for each sequence. But this time we don't
+  // hash the collected data and compare the whole data set instead. This
+  // prevents any false-positives due to hash code collisions.
+  // Every sequence's data is collected once and sequences are bucketed by it,
+  // as comparing every sequence with all the others is quadratic in the size
+  // of the group.
+  unsigned NumSequences = Group.Sequences.size();
+  std::vector<llvm::FoldingSetNodeID> Data(NumSequences);
+  std::vector<unsigned> Indexes;
+  for (unsigned I = 0; I < NumSequences; ++I) {
+    FoldingSetNodeIDWrapper Wrapper(Data[I]);
+    CollectStmtSequenceData(Group.Sequences[I], Wrapper);
+    Indexes.push_back(I);
+  }
 
-      // We didn't found a matching variable pattern, so we continue with the
-      // next sequence.
-      ++I;
+  // The found groups along with the index of their first sequence, as the
+  // groups are returned in the order of the sequences.
+  std::vector<std::pair<unsigned, CloneDetector::CloneGroup>> FoundGroups;
+  std::vector<llvm::FoldingSetNodeID> Patterns(NumSequences);
+
+  for (const std::vector<unsigned> &Clones : splitByData(Indexes, Data)) {
+    // If we were asked to check for matching variable patterns, the clones
+    // are split further into the ones whose patterns have no differences.
+    std::vector<std::vector<unsigned>> Lists;
+    if (CheckVariablePattern) {
+      for (unsigned I : Clones)
+        VariablePattern(Group.Sequences[I]).Profile(Patterns[I]);
+      Lists = splitByData(Clones, Patterns);
+    } else {
+      Lists.push_back(Clones);
     }
 
-    // Add a valid clone group to the list of found clone groups.
-    if (!FilteredGroup.isValid())
-      continue;
+    for (const std::vector<unsigned> &List : Lists) {
+      CloneDetector::CloneGroup FilteredGroup(Group.Sequences[List.front()],
+                                              Group.Signature);
+      for (unsigned I = 1; I < List.size(); ++I)
+        FilteredGroup.Sequences.push_back(Group.Sequences[List[I]]);
 
-    Result.push_back(FilteredGroup);
+      // Add a valid clone group to the list of found clone groups.
+      if (FilteredGroup.isValid())
+        FoundGroups.emplace_back(List.front(), std::move(FilteredGroup));
+    }
   }
+
+  std::sort(FoundGroups.begin(), FoundGroups.end(),
+            [](const std::pair<unsigned, CloneDetector::CloneGroup> &LHS,
+               const std::pair<unsigned, CloneDetector::CloneGroup> &RHS) {
+              return LHS.first < RHS.first;
+            });
+  for (auto &FoundGroup : FoundGroups)
+    Result.push_back(std::move(FoundGroup.second));
 }
 
 void CloneDetector::findClones(std::vector<CloneGroup> &Result,
@@ -892,3 +910,55 @@ void CloneDetector::findSuspiciousClones(
     }
   }
 }
+
+void CloneDetector::exportIndex(llvm::raw_ostream &OS,
+                                unsigned MinComplexity) const {
+  // The hash codes of all single statements, which describe the parts of the
+  // sequences for the detection of near-miss clones.
+  llvm::DenseMap<const Stmt *, size_t> StmtHashes;
+  for (const auto &Entry : Sequences)
+    if (!Entry.second.holdsSequence())
+      StmtHashes[Entry.second.front()] = Entry.first.Hash;
+
+  for (const auto &Entry : Sequences) {
+    const CloneSignature &Signature = Entry.first;
+    const StmtSequence &Sequence = Entry.second;
+    if (Signature.Complexity < MinComplexity)
+      continue;
+
+    const SourceManager &SM = Sequence.getASTContext().getSourceManager();
+    PresumedLoc Start =
+        SM.getPresumedLoc(SM.getExpansionLoc(Sequence.getStartLoc()));
+    PresumedLoc End =
+        SM.getPresumedLoc(SM.getExpansionLoc(Sequence.getEndLoc()));
+    if (Start.isInvalid() || End.isInvalid())
+      continue;
+
+    OS << llvm::format_hex_no_prefix(Signature.Hash, 2 * sizeof(size_t)) << '\t'
+       << Signature.Complexity << '\t' << Start.getFilename() << '\t'
+       << Start.getLine() << ':' << Start.getColumn() << '\t' << End.getLine()
+       << ':' << End.getColumn() << '\t';
+
+    // The parts of a sequence are its statements, the parts of a single
+    // statement are its children.
+    SmallVector<const Stmt *, 8> Parts;
+    if (Sequence.holdsSequence())
+      Parts.append(Sequence.begin(), Sequence.end());
+    else
+      for (const Stmt *Child : Sequence.front()->children())
+        if (Child)
+          Parts.push_back(Child);
+
+    bool First = true;
+    for (const Stmt *Part : Parts) {
+      auto Hash = StmtHashes.find(Part);
+      if (Hash == StmtHashes.end())
+        continue;
+      if (!First)
+        OS << ',';
+      OS << llvm::format_hex_no_prefix(Hash->second, 2 * sizeof(size_t));
+      First = false;
+    }
+    OS << '\n';
+  }
+}
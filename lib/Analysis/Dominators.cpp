@@ -12,3 +12,13 @@
 using namespace clang;
 
 void DominatorTree::anchor() { }
+
+const void *DominatorTree::getTag() { static int x; return &x; }
+
+DominatorTree *DominatorTree::create(AnalysisDeclContext &Ctx) {
+  if (!Ctx.getCFG())
+    return nullptr;
+  DominatorTree *Dom = new DominatorTree();
+  Dom->buildDominatorTree(Ctx);
+  return Dom;
+}
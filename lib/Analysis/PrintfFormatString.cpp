@@ -391,6 +391,96 @@ bool clang::analyze_format_string::ParsePrintfString(FormatStringHandler &H,
   return false;
 }
 
+namespace {
+/// Records the specifiers of a format string which parses without any other
+/// problems.
+class RecordingHandler : public FormatStringHandler {
+public:
+  struct Record {
+    PrintfSpecifier FS;
+    const char *Start;
+    unsigned Length;
+  };
+
+  SmallVector<Record, 8> Records;
+  bool Replayable = true;
+
+  void HandleNullChar(const char *) override { Replayable = false; }
+  void HandlePosition(const char *, unsigned) override { Replayable = false; }
+  void HandleInvalidPosition(const char *, unsigned,
+                             analyze_format_string::PositionContext) override {
+    Replayable = false;
+  }
+  void HandleZeroPosition(const char *, unsigned) override {
+    Replayable = false;
+  }
+  void HandleIncompleteSpecifier(const char *, unsigned) override {
+    Replayable = false;
+  }
+  void HandleEmptyObjCModifierFlag(const char *, unsigned) override {
+    Replayable = false;
+  }
+  void HandleInvalidObjCModifierFlag(const char *, unsigned) override {
+    Replayable = false;
+  }
+  void HandleObjCFlagsWithNonObjCConversion(const char *, const char *,
+                                            const char *) override {
+    Replayable = false;
+  }
+  bool HandleInvalidPrintfConversionSpecifier(const PrintfSpecifier &,
+                                              const char *,
+                                              unsigned) override {
+    Replayable = false;
+    return false;
+  }
+  bool HandlePrintfSpecifier(const PrintfSpecifier &FS,
+                             const char *startSpecifier,
+                             unsigned specifierLen) override {
+    Records.push_back({FS, startSpecifier, specifierLen});
+    return true;
+  }
+};
+} // end anonymous namespace
+
+analyze_format_string::ParsedPrintfString::ParsedPrintfString(
+    StringRef FormatStr, const LangOptions &LO, const TargetInfo &Target,
+    bool isFreeBSDKPrintf)
+    : Str(FormatStr), Replayable(false) {
+  RecordingHandler H;
+  const char *Beg = Str.data();
+  if (ParsePrintfString(H, Beg, Beg + Str.size(), LO, Target,
+                        isFreeBSDKPrintf) ||
+      !H.Replayable)
+    return;
+
+  // The specifiers point into our copy of the string.
+  Specifiers.reserve(H.Records.size());
+  for (const RecordingHandler::Record &R : H.Records)
+    Specifiers.push_back({R.FS, unsigned(R.Start - Beg), R.Length});
+  Replayable = true;
+}
+
+bool analyze_format_string::ParsedPrintfString::replay(
+    FormatStringHandler &H) const {
+  assert(Replayable && "Format string has to be parsed with the handler");
+  for (const Specifier &S : Specifiers)
+    if (!H.HandlePrintfSpecifier(S.FS, Str.data() + S.Start, S.Length))
+      return true;
+  return false;
+}
+
+const analyze_format_string::ParsedPrintfString &
+analyze_format_string::PrintfStringCache::get(StringRef Str,
+                                              const LangOptions &LO,
+                                              const TargetInfo &Target,
+                                              bool isFreeBSDKPrintf) {
+  std::unique_ptr<ParsedPrintfString> &Parsed =
+      Strings[isFreeBSDKPrintf][Str];
+  if (!Parsed)
+    Parsed.reset(new ParsedPrintfString(Str, LO, Target, isFreeBSDKPrintf));
+  return *Parsed;
+}
+
 bool clang::analyze_format_string::ParseFormatStringHasSArg(const char *I,
                                                             const char *E,
                                                             const LangOptions &LO,
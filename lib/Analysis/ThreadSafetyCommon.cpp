@@ -89,6 +89,29 @@ CapabilityExpr SExprBuilder::translateAttrExpr(const Expr *AttrExp,
                                                const NamedDecl *D,
                                                const Expr *DeclExp,
                                                VarDecl *SelfDecl) {
+  // Destructor calls are represented by temporary expressions, whose
+  // addresses are reused, so their translations can't be cached.
+  if (D && isa<CXXDestructorDecl>(D))
+    return translateAttrExprAtDecl(AttrExp, D, DeclExp, SelfDecl);
+
+  // The same attribute is translated in the same context many times, e.g.
+  // once for every access to each member guarded by it, so the translations
+  // are kept for the lifetime of the builder.
+  AttrExprKey Key(std::make_pair(AttrExp, D),
+                  std::make_pair(DeclExp, SelfDecl));
+  auto It = AttrExprCache.find(Key);
+  if (It != AttrExprCache.end())
+    return It->second;
+
+  CapabilityExpr Cp = translateAttrExprAtDecl(AttrExp, D, DeclExp, SelfDecl);
+  AttrExprCache.insert(std::make_pair(Key, Cp));
+  return Cp;
+}
+
+CapabilityExpr SExprBuilder::translateAttrExprAtDecl(const Expr *AttrExp,
+                                                     const NamedDecl *D,
+                                                     const Expr *DeclExp,
+                                                     VarDecl *SelfDecl) {
   // If we are processing a raw attribute expression, with no substitutions.
   if (!DeclExp)
     return translateAttrExpr(AttrExp, nullptr);
@@ -25,6 +25,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PackedVector.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include <utility>
@@ -47,31 +48,58 @@ static bool isTrackedVar(const VarDecl *vd, const DeclContext *dc) {
 // DeclToIndex: a mapping from Decls we track to value indices.
 //====------------------------------------------------------------------------//
 
+static bool hasTrackedVars(const DeclContext &dc) {
+  for (const auto *vd : dc.decls())
+    if (isa<VarDecl>(vd) && isTrackedVar(cast<VarDecl>(vd), &dc))
+      return true;
+  return false;
+}
+
 namespace {
 class DeclToIndex {
   llvm::DenseMap<const VarDecl *, unsigned> map;
+  unsigned numEntries;
+  unsigned numUsed;
 public:
-  DeclToIndex() {}
+  DeclToIndex() : numEntries(0), numUsed(0) {}
   
-  /// Compute the actual mapping from declarations to bits.
-  void computeMap(const DeclContext &dc);
+  /// Compute the actual mapping from declarations to bits. Only the
+  /// variables in \p used can be reported, so only those get values of their
+  /// own; all the other variables share a single entry which is never read.
+  void computeMap(const DeclContext &dc,
+                  const llvm::SmallPtrSetImpl<const VarDecl *> &used);
   
-  /// Return the number of declarations in the map.
-  unsigned size() const { return map.size(); }
+  /// Return the number of entries in the bit vector.
+  unsigned size() const { return numEntries; }
+
+  /// Return the number of declarations which have values of their own.
+  unsigned getNumUsed() const { return numUsed; }
   
   /// Returns the bit vector index for a given declaration.
   Optional<unsigned> getValueIndex(const VarDecl *d) const;
 };
 }
 
-void DeclToIndex::computeMap(const DeclContext &dc) {
-  unsigned count = 0;
+void DeclToIndex::computeMap(const DeclContext &dc,
+                             const llvm::SmallPtrSetImpl<const VarDecl *> &used) {
+  SmallVector<const VarDecl *, 16> unused;
   DeclContext::specific_decl_iterator<VarDecl> I(dc.decls_begin()),
                                                E(dc.decls_end());
   for ( ; I != E; ++I) {
     const VarDecl *vd = *I;
-    if (isTrackedVar(vd, &dc))
-      map[vd] = count++;
+    if (!isTrackedVar(vd, &dc))
+      continue;
+    if (used.count(vd))
+      map[vd] = numUsed++;
+    else
+      unused.push_back(vd);
+  }
+
+  numEntries = numUsed;
+  if (!unused.empty()) {
+    for (const VarDecl *vd : unused)
+      map[vd] = numUsed;
+    ++numEntries;
   }
 }
 
@@ -114,7 +142,9 @@ public:
 
   unsigned getNumEntries() const { return declToIndex.size(); }
   
-  void computeSetOfDeclarations(const DeclContext &dc);  
+  void computeSetOfDeclarations(
+      const DeclContext &dc,
+      const llvm::SmallPtrSetImpl<const VarDecl *> &used);
   ValueVector &getValueVector(const CFGBlock *block) {
     return vals[block->getBlockID()];
   }
@@ -124,9 +154,11 @@ public:
   bool updateValueVectorWithScratch(const CFGBlock *block);
   
   bool hasNoDeclarations() const {
-    return declToIndex.size() == 0;
+    return declToIndex.getNumUsed() == 0;
   }
 
+  unsigned getNumDeclarations() const { return declToIndex.getNumUsed(); }
+
   void resetScratch();
   
   ValueVector::reference operator[](const VarDecl *vd);
@@ -142,8 +174,10 @@ public:
 
 CFGBlockValues::CFGBlockValues(const CFG &c) : cfg(c), vals(0) {}
 
-void CFGBlockValues::computeSetOfDeclarations(const DeclContext &dc) {
-  declToIndex.computeMap(dc);
+void CFGBlockValues::computeSetOfDeclarations(
+    const DeclContext &dc,
+    const llvm::SmallPtrSetImpl<const VarDecl *> &used) {
+  declToIndex.computeMap(dc, used);
   unsigned decls = declToIndex.size();
   scratch.resize(decls);
   unsigned n = cfg.getNumBlockIDs();
@@ -314,6 +348,9 @@ public:
 private:
   const DeclContext *DC;
   llvm::DenseMap<const DeclRefExpr*, Class> Classification;
+  /// The variables which might be read, and so might be reported as used
+  /// uninitialized.
+  llvm::SmallPtrSet<const VarDecl *, 16> UsedVars;
 
   bool isTrackedVar(const VarDecl *VD) const {
     return ::isTrackedVar(VD, DC);
@@ -324,6 +361,7 @@ private:
 public:
   ClassifyRefs(AnalysisDeclContext &AC) : DC(cast<DeclContext>(AC.getDecl())) {}
 
+  void VisitBlockExpr(BlockExpr *BE);
   void VisitDeclStmt(DeclStmt *DS);
   void VisitUnaryOperator(UnaryOperator *UO);
   void VisitBinaryOperator(BinaryOperator *BO);
@@ -332,6 +370,10 @@ public:
 
   void operator()(Stmt *S) { Visit(S); }
 
+  const llvm::SmallPtrSetImpl<const VarDecl *> &getUsedVars() const {
+    return UsedVars;
+  }
+
   Class get(const DeclRefExpr *DRE) const {
     llvm::DenseMap<const DeclRefExpr*, Class>::const_iterator I
         = Classification.find(DRE);
@@ -402,8 +444,20 @@ void ClassifyRefs::classify(const Expr *E, Class C) {
   }
 
   FindVarResult Var = findVar(E, DC);
-  if (const DeclRefExpr *DRE = Var.getDeclRefExpr())
+  if (const DeclRefExpr *DRE = Var.getDeclRefExpr()) {
     Classification[DRE] = std::max(Classification[DRE], C);
+    if (C == Use)
+      UsedVars.insert(Var.getDecl());
+  }
+}
+
+void ClassifyRefs::VisitBlockExpr(BlockExpr *BE) {
+  // Capturing a variable by copy reads it.
+  for (const auto &I : BE->getBlockDecl()->captures()) {
+    const VarDecl *VD = I.getVariable();
+    if (!I.isByRef() && isTrackedVar(VD))
+      UsedVars.insert(VD);
+  }
 }
 
 void ClassifyRefs::VisitDeclStmt(DeclStmt *DS) {
@@ -871,17 +925,22 @@ void clang::runUninitializedVariablesAnalysis(
     AnalysisDeclContext &ac,
     UninitVariablesHandler &handler,
     UninitVariablesAnalysisStats &stats) {
-  CFGBlockValues vals(cfg);
-  vals.computeSetOfDeclarations(dc);
-  if (vals.hasNoDeclarations())
+  if (!hasTrackedVars(dc))
     return;
 
-  stats.NumVariablesAnalyzed = vals.getNumEntries();
-
   // Precompute which expressions are uses and which are initializations.
   ClassifyRefs classification(ac);
   cfg.VisitBlockStmts(classification);
 
+  // Only track the variables which are read somewhere. The others can't be
+  // reported, and in large generated functions they tend to be the majority.
+  CFGBlockValues vals(cfg);
+  vals.computeSetOfDeclarations(dc, classification.getUsedVars());
+  if (vals.hasNoDeclarations())
+    return;
+
+  stats.NumVariablesAnalyzed = vals.getNumDeclarations();
+
   // Mark all variables uninitialized at the entry.
   const CFGBlock &entry = cfg.getEntry();
   ValueVector &vec = vals.getValueVector(&entry);
@@ -78,25 +78,41 @@ bool Builtin::Context::builtinIsSupported(const Builtin::Info &BuiltinInfo,
 }
 
 /// initializeBuiltins - Mark the identifiers for all the builtins with their
-/// appropriate builtin ID # and mark any non-portable builtin identifiers as
-/// such.
+/// appropriate builtin ID #, lazily for those not created yet.
 void Builtin::Context::initializeBuiltins(IdentifierTable &Table,
                                           const LangOptions& LangOpts) {
-  // Step #1: mark all target-independent builtins with their ID's.
+  initializeBuiltinsForAST(Table, LangOpts);
+
+  for (const auto &Entry : Table)
+    if (IdentifierInfo *II = Entry.getValue())
+      if (unsigned ID = getBuiltinID(Entry.getKey()))
+        II->setBuiltinID(ID);
+}
+
+void Builtin::Context::initializeBuiltinsForAST(IdentifierTable &Table,
+                                                const LangOptions &LangOpts) {
+  // Filling a map is much cheaper than creating an identifier for each of the
+  // builtins, most of which a translation unit never refers to.
+  BuiltinIDs.clear();
+  BuiltinIDs.reserve(Builtin::FirstTSBuiltin + TSRecords.size() +
+                     AuxTSRecords.size());
+
+  // Step #1: Register all target-independent builtins with their ID's.
   for (unsigned i = Builtin::NotBuiltin+1; i != Builtin::FirstTSBuiltin; ++i)
-    if (builtinIsSupported(BuiltinInfo[i], LangOpts)) {
-      Table.get(BuiltinInfo[i].Name).setBuiltinID(i);
-    }
+    if (builtinIsSupported(BuiltinInfo[i], LangOpts))
+      BuiltinIDs[BuiltinInfo[i].Name] = i;
 
   // Step #2: Register target-specific builtins.
   for (unsigned i = 0, e = TSRecords.size(); i != e; ++i)
     if (builtinIsSupported(TSRecords[i], LangOpts))
-      Table.get(TSRecords[i].Name).setBuiltinID(i + Builtin::FirstTSBuiltin);
+      BuiltinIDs[TSRecords[i].Name] = i + Builtin::FirstTSBuiltin;
 
   // Step #3: Register target-specific builtins for AuxTarget.
   for (unsigned i = 0, e = AuxTSRecords.size(); i != e; ++i)
-    Table.get(AuxTSRecords[i].Name)
-        .setBuiltinID(i + Builtin::FirstTSBuiltin + TSRecords.size());
+    BuiltinIDs[AuxTSRecords[i].Name] =
+        i + Builtin::FirstTSBuiltin + TSRecords.size();
+
+  Table.setBuiltinInfo(this);
 }
 
 void Builtin::Context::forgetBuiltin(unsigned ID, IdentifierTable &Table) {
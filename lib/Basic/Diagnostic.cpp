@@ -16,6 +16,7 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/PartialDiagnostic.h"
+#include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -81,6 +82,7 @@ DiagnosticsEngine::DiagnosticsEngine(IntrusiveRefCntPtr<DiagnosticIDs> diags,
 
   ErrorLimit = 0;
   TemplateBacktraceLimit = 0;
+  TemplateArgDepth = 0;
   ConstexprBacktraceLimit = 0;
 
   Reset();
@@ -121,6 +123,7 @@ void DiagnosticsEngine::Reset() {
   UnrecoverableErrorOccurred = false;
   
   NumWarnings = 0;
+  NumIgnored = 0;
   NumErrors = 0;
   TrapNumErrorsOccurred = 0;
   TrapNumUnrecoverableErrorsOccurred = 0;
@@ -133,6 +136,7 @@ void DiagnosticsEngine::Reset() {
   DiagStates.clear();
   DiagStatePoints.clear();
   DiagStateOnPushStack.clear();
+  invalidateDiagStatePointIndex();
 
   // Create a DiagState and DiagStatePoint representing diagnostic changes
   // through command-line.
@@ -172,14 +176,132 @@ DiagnosticsEngine::GetDiagStatePointForLoc(SourceLocation L) const {
 
   DiagStatePointsTy::iterator Pos = DiagStatePoints.end();
   FullSourceLoc LastStateChangePos = DiagStatePoints.back().Loc;
-  if (LastStateChangePos.isValid() &&
-      Loc.isBeforeInTranslationUnitThan(LastStateChangePos))
+  if (LastStateChangePos.isInvalid())
+    return Pos - 1;
+
+  // The bucket of the last lookup stays valid until a point is added.
+  std::pair<FileID, unsigned> Decomposed =
+      SourceMgr->getDecomposedExpansionLoc(Loc);
+  uint64_t Key = uint64_t(Decomposed.second) * 2;
+  DiagStatePointBucket &Bucket = LastDiagStatePointBucket;
+  if (Bucket.FID.isValid() && Bucket.FID == Decomposed.first &&
+      Bucket.BeginKey <= Key && Key < Bucket.EndKey &&
+      NumIndexedDiagStatePoints == DiagStatePoints.size())
+    return DiagStatePoints.begin() + Bucket.Point;
+
+  if (Loc.isBeforeInTranslationUnitThan(LastStateChangePos)) {
+    updateDiagStatePointIndex();
+    int Point = FileDiagStatePoints::NoEntryPoint;
+    if (!DiagStatePointIndexUnusable) {
+      DiagStatePointBucket NewBucket;
+      NewBucket.FID = Decomposed.first;
+      Point = findDiagStatePointInFile(Decomposed.first, Key, &NewBucket);
+      // A point at the same expansion location may come from a _Pragma in
+      // the same macro expansion; only comparing the locations orders them.
+      if (Point >= 0 &&
+          SourceMgr->getExpansionLoc(DiagStatePoints[Point].Loc) ==
+              SourceMgr->getExpansionLoc(Loc))
+        Point = FileDiagStatePoints::NoEntryPoint;
+      else if (Point < 0)
+        Point = getDiagStatePointAtFileEntry(Decomposed.first);
+      if (Point >= 0) {
+        NewBucket.Point = Point;
+        Bucket = NewBucket;
+      }
+    }
+    if (Point >= 0)
+      return DiagStatePoints.begin() + Point;
     Pos = std::upper_bound(DiagStatePoints.begin(), DiagStatePoints.end(),
                            DiagStatePoint(nullptr, Loc));
+  }
   --Pos;
   return Pos;
 }
 
+void DiagnosticsEngine::updateDiagStatePointIndex() const {
+  if (DiagStatePointIndexUnusable)
+    return;
+
+  // The first point is the command-line state, which every lookup that finds
+  // no other point falls back to.
+  FileID MainFID = SourceMgr->getMainFileID();
+  for (unsigned I = std::max(NumIndexedDiagStatePoints, 1u),
+                E = DiagStatePoints.size();
+       I != E; ++I) {
+    SourceLocation Loc = DiagStatePoints[I].Loc;
+    if (Loc.isInvalid()) {
+      DiagStatePointIndexUnusable = true;
+      return;
+    }
+    // Record the point in its file and in every file that includes it.
+    std::pair<FileID, unsigned> Decomposed =
+        SourceMgr->getDecomposedExpansionLoc(Loc);
+    uint64_t Key = uint64_t(Decomposed.second) * 2;
+    while (true) {
+      DiagStatePointsByFile[Decomposed.first].Points.push_back(
+          std::make_pair(Key, I));
+      if (Decomposed.first == MainFID)
+        break;
+      Decomposed = SourceMgr->getDecomposedIncludedLoc(Decomposed.first);
+      if (Decomposed.first.isInvalid()) {
+        DiagStatePointIndexUnusable = true;
+        return;
+      }
+      Key = uint64_t(Decomposed.second) * 2 + 1;
+    }
+  }
+  NumIndexedDiagStatePoints = DiagStatePoints.size();
+}
+
+int DiagnosticsEngine::findDiagStatePointInFile(
+    FileID FID, uint64_t Key, DiagStatePointBucket *Bucket) const {
+  if (Bucket) {
+    Bucket->BeginKey = 0;
+    Bucket->EndKey = UINT64_MAX;
+  }
+  auto It = DiagStatePointsByFile.find(FID);
+  if (It == DiagStatePointsByFile.end())
+    return -1;
+  const auto &Points = It->second.Points;
+  auto Pos = std::upper_bound(
+      Points.begin(), Points.end(), Key,
+      [](uint64_t Key, const std::pair<uint64_t, unsigned> &Point) {
+        return Key < Point.first;
+      });
+  if (Bucket && Pos != Points.end())
+    Bucket->EndKey = Pos->first;
+  if (Pos == Points.begin())
+    return -1;
+  // Leave the key of the point itself out of the bucket, since a lookup
+  // there may have to compare macro locations.
+  if (Bucket)
+    Bucket->BeginKey = std::prev(Pos)->first + 1;
+  return std::prev(Pos)->second;
+}
+
+int DiagnosticsEngine::getDiagStatePointAtFileEntry(FileID FID) const {
+  if (FID == SourceMgr->getMainFileID())
+    return 0;
+  auto It = DiagStatePointsByFile.find(FID);
+  if (It != DiagStatePointsByFile.end() &&
+      It->second.EntryPoint != FileDiagStatePoints::UnknownEntryPoint)
+    return It->second.EntryPoint;
+
+  // Points added later come after every file seen so far, so the state at
+  // the start of a file never changes once it is known.
+  int Point = FileDiagStatePoints::NoEntryPoint;
+  std::pair<FileID, unsigned> IncludedLoc =
+      SourceMgr->getDecomposedIncludedLoc(FID);
+  if (IncludedLoc.first.isValid()) {
+    Point = findDiagStatePointInFile(IncludedLoc.first,
+                                     uint64_t(IncludedLoc.second) * 2);
+    if (Point < 0)
+      Point = getDiagStatePointAtFileEntry(IncludedLoc.first);
+  }
+  DiagStatePointsByFile[FID].EntryPoint = Point;
+  return Point;
+}
+
 void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
                                     SourceLocation L) {
   assert(Diag < diag::DIAG_UPPER_LIMIT &&
@@ -246,6 +368,7 @@ void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
   NewState->setMapping(Diag, Mapping);
   DiagStatePoints.insert(Pos+1, DiagStatePoint(NewState,
                                                FullSourceLoc(Loc, *SourceMgr)));
+  invalidateDiagStatePointIndex();
 }
 
 bool DiagnosticsEngine::setSeverityForGroup(diag::Flavor Flavor,
@@ -648,8 +648,10 @@ bool DiagnosticIDs::ProcessDiag(DiagnosticsEngine &Diag) const {
   // a note and the last real diagnostic was ignored, ignore it too.
   if (DiagLevel == DiagnosticIDs::Ignored ||
       (DiagLevel == DiagnosticIDs::Note &&
-       Diag.LastDiagLevel == DiagnosticIDs::Ignored))
+       Diag.LastDiagLevel == DiagnosticIDs::Ignored)) {
+    ++Diag.NumIgnored;
     return false;
+  }
 
   if (DiagLevel >= DiagnosticIDs::Error) {
     if (isUnrecoverable(DiagID))
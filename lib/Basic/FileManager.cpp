@@ -417,6 +417,32 @@ bool FileManager::makeAbsolutePath(SmallVectorImpl<char> &Path) const {
 llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
 FileManager::getBufferForFile(const FileEntry *Entry, bool isVolatile,
                               bool ShouldCloseOpenFile) {
+  SharedFileContents *Shared = FileSystemOpts.SharedContents.get();
+  if (!Shared || !SharedFileContents::canShare(*Entry))
+    return readBufferForFile(Entry, isVolatile, ShouldCloseOpenFile);
+
+  // Memory mapped contents would change along with a volatile file.
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = Shared->lookup(*Entry);
+  if (Buffer && isVolatile &&
+      Buffer->getBufferKind() == llvm::MemoryBuffer::MemoryBuffer_MMap)
+    Buffer.reset();
+  if (Buffer) {
+    if (ShouldCloseOpenFile)
+      Entry->closeFile();
+    return std::move(Buffer);
+  }
+
+  auto Result = readBufferForFile(Entry, isVolatile, ShouldCloseOpenFile);
+  // A volatile file may have changed since it was stat'ed, so only share
+  // contents which match the entry.
+  if (!Result || (*Result)->getBufferSize() != (uint64_t)Entry->getSize())
+    return Result;
+  return Shared->insert(*Entry, std::move(*Result));
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+FileManager::readBufferForFile(const FileEntry *Entry, bool isVolatile,
+                               bool ShouldCloseOpenFile) {
   uint64_t FileSize = Entry->getSize();
   // If there's a high enough chance that the file have changed since we
   // got its size, force a stat before opening it.
@@ -555,6 +581,66 @@ StringRef FileManager::getCanonicalName(const DirectoryEntry *Dir) {
   return CanonicalName;
 }
 
+namespace {
+/// \brief A buffer referring to contents owned by \c SharedFileContents,
+/// which are kept alive as long as the buffer.
+class SharedMemoryBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+
+public:
+  explicit SharedMemoryBuffer(std::shared_ptr<llvm::MemoryBuffer> Contents)
+      : Contents(std::move(Contents)) {
+    init(this->Contents->getBufferStart(), this->Contents->getBufferEnd(),
+         /*RequiresNullTerminator=*/true);
+  }
+
+  BufferKind getBufferKind() const override {
+    return Contents->getBufferKind();
+  }
+};
+} // end anonymous namespace
+
+SharedFileContents::Key SharedFileContents::getKey(const FileEntry &Entry) {
+  return Key(Entry.getUniqueID().getDevice(), Entry.getUniqueID().getFile(),
+             Entry.getModificationTime(), Entry.getSize());
+}
+
+bool SharedFileContents::canShare(const FileEntry &Entry) {
+  // Virtual files have no identity on disk, and pipes are read only once.
+  return Entry.getUniqueID() != llvm::sys::fs::UniqueID(0, 0) &&
+         !Entry.isNamedPipe();
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+SharedFileContents::lookup(const FileEntry &Entry) {
+  std::lock_guard<std::mutex> Guard(Mutex);
+  auto I = Buffers.find(getKey(Entry));
+  if (I == Buffers.end())
+    return nullptr;
+  std::shared_ptr<llvm::MemoryBuffer> Contents = I->second.lock();
+  if (!Contents)
+    return nullptr;
+  return llvm::make_unique<SharedMemoryBuffer>(std::move(Contents));
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+SharedFileContents::insert(const FileEntry &Entry,
+                           std::unique_ptr<llvm::MemoryBuffer> Contents) {
+  std::shared_ptr<llvm::MemoryBuffer> Owned(std::move(Contents));
+  std::lock_guard<std::mutex> Guard(Mutex);
+  Buffers[getKey(Entry)] = Owned;
+  if (Buffers.size() >= NextSweep) {
+    for (auto I = Buffers.begin(); I != Buffers.end();) {
+      if (I->second.expired())
+        I = Buffers.erase(I);
+      else
+        ++I;
+    }
+    NextSweep = std::max<size_t>(64, 2 * Buffers.size());
+  }
+  return llvm::make_unique<SharedMemoryBuffer>(std::move(Owned));
+}
+
 void FileManager::PrintStats() const {
   llvm::errs() << "\n*** File Manager Stats:\n";
   llvm::errs() << UniqueRealFiles.size() << " real files found, "
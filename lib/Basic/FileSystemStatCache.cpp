@@ -12,8 +12,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/FileUtilities.h"
 #include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
 
 using namespace clang;
 
@@ -124,3 +132,252 @@ MemorizeStatCalls::getStat(StringRef Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+bool SharedStatResults::lookup(StringRef Path, bool &Exists, FileData &Data) {
+  llvm::MutexGuard MG(Mux);
+  auto I = Entries.find(Path);
+  if (I == Entries.end())
+    return false;
+  Exists = I->second.first;
+  Data = I->second.second;
+  return true;
+}
+
+void SharedStatResults::insert(StringRef Path, bool Exists,
+                               const FileData &Data) {
+  llvm::MutexGuard MG(Mux);
+  Entries.insert(std::make_pair(Path, std::make_pair(Exists, Data)));
+}
+
+SharedStatCache::LookupResult
+SharedStatCache::getStat(StringRef Path, FileData &Data, bool isFile,
+                         std::unique_ptr<vfs::File> *F, vfs::FileSystem &FS) {
+  if (!llvm::sys::path::is_absolute(Path))
+    return statChained(Path, Data, isFile, F, FS);
+
+  bool Exists;
+  if (Results->lookup(Path, Exists, Data))
+    return Exists ? CacheExists : CacheMissing;
+
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+  // A lookup which opens the file also fails for directories, so only a
+  // plain 'stat' proves that the path is missing.
+  if (Result == CacheExists || !F)
+    Results->insert(Path, Result == CacheExists, Data);
+  return Result;
+}
+
+//===----------------------------------------------------------------------===//
+// Persistent stat cache.
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// \brief The file layout is a header of four little-endian 32-bit words
+/// (magic, version, bucket offset, payload offset) followed by an on-disk
+/// hash table mapping each missing path to its directory stamp.
+enum {
+  StatCacheMagic = 0x43545343, // 'CSTC'
+  StatCacheVersion = 1,
+  StatCacheHeaderSize = 4 * 4
+};
+
+/// \brief The directory stamp recorded for paths whose directory is missing.
+const uint64_t MissingDirectoryStamp = ~0ULL;
+
+class PersistentStatCacheTrait {
+public:
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+  typedef StringRef external_key_type;
+  typedef StringRef internal_key_type;
+  typedef uint64_t data_type;
+  typedef uint64_t data_type_ref;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static hash_value_type ComputeHash(StringRef Key) {
+    return llvm::HashString(Key);
+  }
+
+  static bool EqualKey(StringRef A, StringRef B) { return A == B; }
+
+  static StringRef GetInternalKey(StringRef Key) { return Key; }
+  static StringRef GetExternalKey(StringRef Key) { return Key; }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, uint64_t) {
+    using namespace llvm::support;
+    endian::Writer<little>(Out).write<uint16_t>(Key.size());
+    return std::make_pair(Key.size(), 8);
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out << Key;
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, uint64_t DirStamp,
+                       unsigned) {
+    using namespace llvm::support;
+    endian::Writer<little>(Out).write<uint64_t>(DirStamp);
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, 8);
+  }
+
+  static StringRef ReadKey(const unsigned char *D, unsigned KeyLen) {
+    return StringRef(reinterpret_cast<const char *>(D), KeyLen);
+  }
+
+  static uint64_t ReadData(StringRef, const unsigned char *D, unsigned) {
+    using namespace llvm::support;
+    return endian::readNext<uint64_t, little, unaligned>(D);
+  }
+};
+} // end anonymous namespace
+
+class PersistentStatCache::OnDiskTable {
+public:
+  typedef llvm::OnDiskIterableChainedHashTable<PersistentStatCacheTrait>
+      TableTy;
+  std::unique_ptr<TableTy> Table;
+
+  explicit OnDiskTable(TableTy *Table) : Table(Table) {}
+};
+
+PersistentStatCache::PersistentStatCache(
+    std::unique_ptr<llvm::MemoryBuffer> Buffer,
+    std::unique_ptr<OnDiskTable> Table)
+    : Buffer(std::move(Buffer)), Table(std::move(Table)) {}
+
+PersistentStatCache::~PersistentStatCache() {}
+
+std::unique_ptr<PersistentStatCache>
+PersistentStatCache::create(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!BufferOrErr)
+    return nullptr;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(*BufferOrErr);
+
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  size_t Size = Buffer->getBufferSize();
+  if (Size < StatCacheHeaderSize)
+    return nullptr;
+
+  const unsigned char *D = Base;
+  if (endian::readNext<uint32_t, little, unaligned>(D) != StatCacheMagic ||
+      endian::readNext<uint32_t, little, unaligned>(D) != StatCacheVersion)
+    return nullptr;
+  uint32_t BucketOffset = endian::readNext<uint32_t, little, unaligned>(D);
+  uint32_t PayloadOffset = endian::readNext<uint32_t, little, unaligned>(D);
+  if (BucketOffset >= Size || PayloadOffset > BucketOffset ||
+      PayloadOffset < StatCacheHeaderSize)
+    return nullptr;
+
+  auto Table = llvm::make_unique<OnDiskTable>(OnDiskTable::TableTy::Create(
+      Base + BucketOffset, Base + PayloadOffset, Base));
+  return std::unique_ptr<PersistentStatCache>(
+      new PersistentStatCache(std::move(Buffer), std::move(Table)));
+}
+
+void PersistentStatCache::forEachEntry(
+    llvm::function_ref<void(StringRef Path, uint64_t DirStamp)> Visit) const {
+  // The key and data iterators walk the payload in the same order.
+  auto Key = Table->Table->key_begin(), KeyEnd = Table->Table->key_end();
+  auto Data = Table->Table->data_begin();
+  for (; Key != KeyEnd; ++Key, ++Data)
+    Visit(*Key, *Data);
+}
+
+uint64_t PersistentStatCache::getDirectoryStamp(StringRef Dir,
+                                                vfs::FileSystem &FS) {
+  llvm::ErrorOr<vfs::Status> Status = FS.status(Dir);
+  if (!Status || !Status->isDirectory())
+    return MissingDirectoryStamp;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Status->getLastModificationTime().time_since_epoch())
+      .count();
+}
+
+PersistentStatCache::LookupResult
+PersistentStatCache::getStat(StringRef Path, FileData &Data, bool isFile,
+                             std::unique_ptr<vfs::File> *F,
+                             vfs::FileSystem &FS) {
+  auto Entry = Table->Table->find(Path);
+  if (Entry == Table->Table->end())
+    return statChained(Path, Data, isFile, F, FS);
+
+  // Only trust the entry if the directory it lives in has not changed since
+  // it was recorded.
+  StringRef Dir = llvm::sys::path::parent_path(Path);
+  auto Known = ValidDirectories.insert(std::make_pair(Dir, false));
+  if (Known.second)
+    Known.first->second = getDirectoryStamp(Dir, FS) == *Entry;
+  if (!Known.first->second)
+    return statChained(Path, Data, isFile, F, FS);
+
+  return CacheMissing;
+}
+
+void PersistentStatCacheWriter::addValidEntries(
+    const PersistentStatCache &Cache, vfs::FileSystem &FS) {
+  Cache.forEachEntry([&](StringRef Path, uint64_t DirStamp) {
+    StringRef Dir = llvm::sys::path::parent_path(Path);
+    auto Known = DirectoryStamps.insert(std::make_pair(Dir, 0));
+    if (Known.second)
+      Known.first->second = PersistentStatCache::getDirectoryStamp(Dir, FS);
+    if (Known.first->second == DirStamp)
+      MissingPaths.insert(std::make_pair(Path, DirStamp));
+  });
+}
+
+PersistentStatCacheWriter::LookupResult
+PersistentStatCacheWriter::getStat(StringRef Path, FileData &Data, bool isFile,
+                                   std::unique_ptr<vfs::File> *F,
+                                   vfs::FileSystem &FS) {
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+
+  // Relative paths depend on the working directory, so only absolute misses
+  // are worth sharing with other compilations.
+  if (Result == CacheExists || !llvm::sys::path::is_absolute(Path))
+    return Result;
+
+  StringRef Dir = llvm::sys::path::parent_path(Path);
+  auto Known = DirectoryStamps.insert(std::make_pair(Dir, 0));
+  if (Known.second)
+    Known.first->second = PersistentStatCache::getDirectoryStamp(Dir, FS);
+  MissingPaths[Path] = Known.first->second;
+  return Result;
+}
+
+bool PersistentStatCacheWriter::write(StringRef Path) const {
+  llvm::OnDiskChainedHashTableGenerator<PersistentStatCacheTrait> Generator;
+  for (const auto &Entry : MissingPaths)
+    Generator.insert(Entry.getKey(), Entry.getValue());
+
+  SmallString<4096> Contents;
+  uint32_t BucketOffset;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(Contents);
+    endian::Writer<little> LE(Out);
+    LE.write<uint32_t>(StatCacheMagic);
+    LE.write<uint32_t>(StatCacheVersion);
+    // Placeholders for the offsets, patched below.
+    LE.write<uint32_t>(0);
+    LE.write<uint32_t>(0);
+    BucketOffset = Generator.Emit(Out);
+  }
+  using namespace llvm::support;
+  endian::write32le(Contents.data() + 8, BucketOffset);
+  endian::write32le(Contents.data() + 12, StatCacheHeaderSize);
+
+  return static_cast<bool>(writeFileAtomically(Path, Contents));
+}
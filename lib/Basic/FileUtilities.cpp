@@ -0,0 +1,55 @@
+//===--- FileUtilities.cpp - Writing Files Shared Between Jobs ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FileUtilities.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+std::error_code clang::writeFileAtomically(StringRef Path,
+                                           StringRef Contents) {
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%.tmp";
+  int FD;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return EC;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return std::make_error_code(std::errc::io_error);
+    }
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return EC;
+  }
+  return std::error_code();
+}
+
+std::string clang::getHashedFileName(StringRef Name, StringRef Hash,
+                                     StringRef Extension) {
+  return (Name + "-" + Hash + Extension).str();
+}
+
+std::string clang::getMainFileHashedName(StringRef MainFile,
+                                         StringRef Extension) {
+  return getHashedFileName(llvm::sys::path::filename(MainFile),
+                           llvm::utohexstr(llvm::MD5Hash(MainFile)),
+                           Extension);
+}
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/Builtins.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
@@ -75,7 +76,7 @@ IdentifierIterator *IdentifierInfoLookup::getIdentifiers() {
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), BuiltinInfo(nullptr) {
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -229,6 +230,11 @@ void IdentifierTable::AddKeywords(const LangOptions &LangOpts) {
     AddKeyword("__declspec", tok::kw___declspec, KEYALL, LangOpts, *this);
 }
 
+void IdentifierTable::markBuiltin(IdentifierInfo &II) {
+  if (unsigned ID = BuiltinInfo->getBuiltinID(II.getName()))
+    II.setBuiltinID(ID);
+}
+
 /// \brief Checks if the specified token kind represents a keyword in the
 /// specified language.
 /// \returns Status of the keyword in the language.
@@ -38,9 +38,23 @@ bool SanitizerBlacklist::isBlacklistedFile(StringRef FileName,
   return SCL->inSection("src", FileName, Category);
 }
 
+bool SanitizerBlacklist::isBlacklistedFileID(FileID FID,
+                                             StringRef Category) const {
+  llvm::DenseMap<FileID, bool> &Cache = BlacklistedFileIDs[Category];
+  auto Known = Cache.find(FID);
+  if (Known != Cache.end())
+    return Known->second;
+
+  const FileEntry *File = SM.getFileEntryForID(FID);
+  bool Blacklisted =
+      isBlacklistedFile(File ? File->getName() : StringRef(), Category);
+  Cache.insert(std::make_pair(FID, Blacklisted));
+  return Blacklisted;
+}
+
 bool SanitizerBlacklist::isBlacklistedLocation(SourceLocation Loc,
                                                StringRef Category) const {
   return Loc.isValid() &&
-         isBlacklistedFile(SM.getFilename(SM.getFileLoc(Loc)), Category);
+         isBlacklistedFileID(SM.getFileID(SM.getFileLoc(Loc)), Category);
 }
 
@@ -362,7 +362,7 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile), FilesAreTransient(false),
     ExternalSLocEntries(nullptr), LineTable(nullptr), NumLinearScans(0),
-    NumBinaryProbes(0) {
+    NumBinaryProbes(0), NumLastFileIDHits(0), NumLastFileIDMisses(0) {
   clearIDTables();
   Diag.setSourceManager(this);
 }
@@ -392,10 +392,13 @@ void SourceManager::clearIDTables() {
   MainFileID = FileID();
   LocalSLocEntryTable.clear();
   LoadedSLocEntryTable.clear();
+  LoadedSLocEntryAllocations.clear();
   SLocEntryLoaded.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  IncludeTree.clear();
+  IncludeTreeOrdinals.clear();
 
   if (LineTable)
     LineTable->clear();
@@ -480,6 +483,9 @@ SourceManager::AllocateLoadedSLocEntries(unsigned NumSLocEntries,
   // Make sure we're not about to run out of source locations.
   if (CurrentLoadedOffset - TotalSize < NextLocalOffset)
     return std::make_pair(0, 0);
+  if (NumSLocEntries)
+    LoadedSLocEntryAllocations.push_back(std::make_pair(
+        CurrentLoadedOffset - TotalSize, unsigned(LoadedSLocEntryTable.size())));
   LoadedSLocEntryTable.resize(LoadedSLocEntryTable.size() + NumSLocEntries);
   SLocEntryLoaded.resize(LoadedSLocEntryTable.size());
   CurrentLoadedOffset -= TotalSize;
@@ -848,6 +854,19 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
   // actually a lower index!
   unsigned GreaterIndex = I;
   unsigned LessIndex = LoadedSLocEntryTable.size();
+
+  // Narrow the search down to the batch of entries containing the offset: the
+  // first batch, in allocation order, that starts at or below it.
+  auto Batch = std::partition_point(
+      LoadedSLocEntryAllocations.begin(), LoadedSLocEntryAllocations.end(),
+      [=](const std::pair<unsigned, unsigned> &Allocation) {
+        return Allocation.first > SLocOffset;
+      });
+  if (Batch != LoadedSLocEntryAllocations.end()) {
+    GreaterIndex = std::max(GreaterIndex, Batch->second);
+    if (std::next(Batch) != LoadedSLocEntryAllocations.end())
+      LessIndex = std::next(Batch)->second;
+  }
   NumProbes = 0;
   while (1) {
     ++NumProbes;
@@ -1190,13 +1209,21 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
 #include <emmintrin.h>
 #endif
 
+/// Line offsets are computed at least this many bytes at a time.
+static const unsigned LineNumberChunkSize = 64 * 1024;
+
 static LLVM_ATTRIBUTE_NOINLINE void
 ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                    llvm::BumpPtrAllocator &Alloc,
-                   const SourceManager &SM, bool &Invalid);
+                   const SourceManager &SM, bool &Invalid,
+                   unsigned FilePos, unsigned Line);
+
+/// \brief Extend the line table of \p FI until it holds the start of the first
+/// line after \p FilePos and the start of line \p Line, or is complete.
 static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                                llvm::BumpPtrAllocator &Alloc,
-                               const SourceManager &SM, bool &Invalid) {
+                               const SourceManager &SM, bool &Invalid,
+                               unsigned FilePos, unsigned Line) {
   // Note that calling 'getBuffer()' may lazily page in the file.
   MemoryBuffer *Buffer = FI->getBuffer(Diag, SM, SourceLocation(), &Invalid);
   if (Invalid)
@@ -1206,12 +1233,26 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   // not look at trigraphs, escaped newlines, or anything else tricky.
   SmallVector<unsigned, 256> LineOffsets;
 
-  // Line #1 starts at char 0.
-  LineOffsets.push_back(0);
-
-  const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
+  // Resume from the start of the last line found so far; line #1 starts at
+  // char 0.
   unsigned Offs = 0;
+  if (FI->SourceLineCache)
+    Offs = FI->SourceLineCache[FI->NumLines - 1];
+  else
+    LineOffsets.push_back(0);
+
+  // Scan at least up to the end of the chunk holding FilePos, and at least
+  // double what has been scanned so far, so that a file is rescanned and its
+  // table reallocated only a logarithmic number of times.
+  unsigned StopOffs = std::max(
+      llvm::alignTo(uint64_t(FilePos) + 1, LineNumberChunkSize),
+      uint64_t(Offs) * 2);
+  unsigned StopLine = Line > FI->NumLines ? Line - FI->NumLines : 0;
+
+  const unsigned char *Buf =
+      (const unsigned char *)Buffer->getBufferStart() + Offs;
+  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
+  bool Complete = false;
   while (1) {
     // Skip over the contents of the line.
     const unsigned char *NextBuf = (const unsigned char *)Buf;
@@ -1264,19 +1305,43 @@ FoundSpecialChar:
       ++Offs;
       ++Buf;
       LineOffsets.push_back(Offs);
+      if (Offs >= StopOffs && LineOffsets.size() >= StopLine)
+        break;
     } else {
       // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
+      if (Buf == End) {
+        Complete = true;
+        break;
+      }
       // Otherwise, skip the null.
       ++Offs;
       ++Buf;
     }
   }
 
-  // Copy the offsets into the FileInfo structure.
-  FI->NumLines = LineOffsets.size();
-  FI->SourceLineCache = Alloc.Allocate<unsigned>(LineOffsets.size());
-  std::copy(LineOffsets.begin(), LineOffsets.end(), FI->SourceLineCache);
+  // Append the offsets to the FileInfo structure.  Any previous table stays
+  // in the allocator; the doubling above bounds that waste by the table size.
+  unsigned *NewCache = Alloc.Allocate<unsigned>(FI->NumLines +
+                                                LineOffsets.size());
+  if (FI->SourceLineCache)
+    std::copy(FI->SourceLineCache, FI->SourceLineCache + FI->NumLines,
+              NewCache);
+  std::copy(LineOffsets.begin(), LineOffsets.end(), NewCache + FI->NumLines);
+  FI->NumLines += LineOffsets.size();
+  FI->SourceLineCache = NewCache;
+  FI->SourceLineCacheComplete = Complete;
+}
+
+/// \brief Return true if the line table of \p FI holds the start of the first
+/// line after \p FilePos and the start of line \p Line.
+static bool hasLineNumbers(const ContentCache *FI, unsigned FilePos,
+                           unsigned Line) {
+  if (!FI->SourceLineCache)
+    return false;
+  if (FI->SourceLineCacheComplete)
+    return true;
+  return FI->SourceLineCache[FI->NumLines - 1] > FilePos &&
+         FI->NumLines >= Line;
 }
 
 /// getLineNumber - Given a SourceLocation, return the spelling line number
@@ -1306,11 +1371,12 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
     Content = const_cast<ContentCache*>(Entry.getFile().getContentCache());
   }
   
-  // If this is the first use of line information for this buffer, compute the
-  /// SourceLineCache for it on demand.
-  if (!Content->SourceLineCache) {
+  // If line information for this part of the buffer hasn't been used yet,
+  // compute the SourceLineCache for it on demand.
+  if (!hasLineNumbers(Content, FilePos, 0)) {
     bool MyInvalid = false;
-    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
+    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid,
+                       FilePos, 0);
     if (Invalid)
       *Invalid = MyInvalid;
     if (MyInvalid)
@@ -1744,11 +1810,12 @@ SourceLocation SourceManager::translateLineCol(FileID FID,
   if (!Content)
     return SourceLocation();
 
-  // If this is the first use of line information for this buffer, compute the
-  // SourceLineCache for it on demand.
-  if (!Content->SourceLineCache) {
+  // If line information for this part of the buffer hasn't been used yet,
+  // compute the SourceLineCache for it on demand.
+  if (!hasLineNumbers(Content, 0, Line)) {
     bool MyInvalid = false;
-    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
+    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid,
+                       0, Line);
     if (MyInvalid)
       return SourceLocation();
   }
@@ -2024,6 +2091,108 @@ InBeforeInTUCacheEntry &SourceManager::getInBeforeInTUCache(FileID LFID,
   return IBTUCacheOverflow;
 }
 
+unsigned SourceManager::getIncludeTreeOrdinal(FileID FID) const {
+  if (FID.ID <= 0)
+    return ~0U;
+
+  // Number the local entries up to FID, in the order they were created.
+  unsigned Index = FID.ID;
+  while (IncludeTreeOrdinals.size() <= Index) {
+    unsigned Scanned = IncludeTreeOrdinals.size();
+    IncludeTreeOrdinals.push_back(~0U);
+    const SrcMgr::SLocEntry &Entry = getLocalSLocEntry(Scanned);
+    if (!Entry.isFile())
+      continue;
+
+    unsigned Ordinal = IncludeTree.size();
+    unsigned Parent = ~0U;
+    unsigned IncludeOffset = 0;
+    SourceLocation IncludeLoc = Entry.getFile().getIncludeLoc();
+    if (IncludeLoc.isValid()) {
+      // The includer must be a numbered local file that was not left yet, and
+      // the include must come after the previous one in it.
+      std::pair<FileID, unsigned> Upper = getDecomposedLoc(IncludeLoc);
+      if (Upper.first.ID <= 0 || unsigned(Upper.first.ID) >= Scanned)
+        continue;
+      Parent = IncludeTreeOrdinals[Upper.first.ID];
+      if (Parent == ~0U || IncludeTree[Parent].Exit != ~0U)
+        continue;
+      const SmallVectorImpl<unsigned> &Siblings = IncludeTree[Parent].Children;
+      if (!Siblings.empty() &&
+          IncludeTree[Siblings.back()].IncludeOffset >= Upper.second)
+        continue;
+      IncludeOffset = Upper.second;
+
+      // Entering this file left the files entered after its includer.
+      unsigned Root = IncludeTree[Parent].Root;
+      for (unsigned Open = IncludeTree[Root].Deepest; Open != Parent;
+           Open = IncludeTree[Open].Parent)
+        IncludeTree[Open].Exit = Ordinal;
+      IncludeTree[Parent].Children.push_back(Ordinal);
+      IncludeTree[Root].Deepest = Ordinal;
+    }
+
+    IncludeTreeNode Node;
+    Node.Parent = Parent;
+    Node.Root = Parent == ~0U ? Ordinal : IncludeTree[Parent].Root;
+    Node.IncludeOffset = IncludeOffset;
+    Node.Exit = ~0U;
+    Node.Deepest = Ordinal;
+    IncludeTree.push_back(std::move(Node));
+    IncludeTreeOrdinals[Scanned] = Ordinal;
+  }
+  return IncludeTreeOrdinals[Index];
+}
+
+bool SourceManager::isBeforeInIncludeTree(std::pair<FileID, unsigned> LOffs,
+                                          std::pair<FileID, unsigned> ROffs,
+                                          bool &Result) const {
+  // Leave the macro expansions, to get to the locations in files.
+  auto leaveExpansions = [&](std::pair<FileID, unsigned> &Loc) {
+    while (Loc.first.ID > 0 && getLocalSLocEntry(Loc.first.ID).isExpansion())
+      Loc = getDecomposedIncludedLoc(Loc.first);
+    return Loc.first.ID > 0;
+  };
+  std::pair<FileID, unsigned> LFile = LOffs, RFile = ROffs;
+  if (!leaveExpansions(LFile) || !leaveExpansions(RFile) ||
+      LFile.first == RFile.first)
+    return false;
+
+  unsigned L = getIncludeTreeOrdinal(LFile.first);
+  unsigned R = getIncludeTreeOrdinal(RFile.first);
+  if (L == ~0U || R == ~0U || IncludeTree[L].Root != IncludeTree[R].Root)
+    return false;
+
+  auto isAncestor = [&](unsigned Ancestor, unsigned Descendant) {
+    return Ancestor < Descendant && Descendant < IncludeTree[Ancestor].Exit;
+  };
+  // Returns the offset in Ancestor of the include that leads to Descendant.
+  auto getIncludeOffset = [&](unsigned Ancestor, unsigned Descendant) {
+    const SmallVectorImpl<unsigned> &Children = IncludeTree[Ancestor].Children;
+    unsigned Child =
+        *(std::upper_bound(Children.begin(), Children.end(), Descendant) - 1);
+    return IncludeTree[Child].IncludeOffset;
+  };
+
+  // As in getCachedResult, locations at the same offset in the common file
+  // are ordered by their FileIDs.
+  bool IsLFIDBeforeRFID = LOffs.first.ID < ROffs.first.ID;
+  if (isAncestor(L, R)) {
+    unsigned Offset = getIncludeOffset(L, R);
+    Result = LFile.second < Offset ||
+             (LFile.second == Offset && IsLFIDBeforeRFID);
+  } else if (isAncestor(R, L)) {
+    unsigned Offset = getIncludeOffset(R, L);
+    Result = Offset < RFile.second ||
+             (Offset == RFile.second && IsLFIDBeforeRFID);
+  } else {
+    // The includes leading to the two files are in their nearest common
+    // ancestor, and in preorder because siblings were numbered in order.
+    Result = L < R;
+  }
+  return true;
+}
+
 /// \brief Determines the order of 2 source locations in the translation unit.
 ///
 /// \returns true if LHS source location comes before RHS, false otherwise.
@@ -2046,6 +2215,12 @@ bool SourceManager::isBeforeInTranslationUnit(SourceLocation LHS,
   if (LOffs.first == ROffs.first)
     return LOffs.second < ROffs.second;
 
+  // Locations in different files are ordered by the #include tree, without
+  // walking include stacks or taking up an entry of the cache below.
+  bool Result;
+  if (isBeforeInIncludeTree(LOffs, ROffs, Result))
+    return Result;
+
   // If we are comparing a source location with multiple locations in the same
   // file, we get a big win by caching the result.
   InBeforeInTUCacheEntry &IsBeforeInTUCache =
@@ -2150,6 +2325,67 @@ void SourceManager::PrintStats() const {
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
                << NumBinaryProbes << " binary.\n";
+  unsigned NumLastFileIDLookups = NumLastFileIDHits + NumLastFileIDMisses;
+  llvm::errs() << "FileID lookups: " << NumLastFileIDHits << " hits, "
+               << NumLastFileIDMisses << " misses in the last lookup cache";
+  if (NumLastFileIDLookups)
+    llvm::errs() << " ("
+                 << (NumLastFileIDHits * 100ULL) / NumLastFileIDLookups
+                 << "% hit rate)";
+  llvm::errs() << ", " << LoadedSLocEntryAllocations.size()
+               << " loaded SLocEntry batches.\n";
+
+  // Break the local address space down by the kind of entry using it, and
+  // attribute macro expansions to the spelling location of the replacement
+  // list they come from.
+  uint64_t FileSpace = 0, MacroSpace = 0, MacroArgSpace = 0;
+  unsigned NumMacroEntries = 0, NumMacroArgEntries = 0;
+  llvm::DenseMap<unsigned, std::pair<uint64_t, unsigned>> MacroSpaceBySpelling;
+  for (unsigned I = 0, N = LocalSLocEntryTable.size(); I != N; ++I) {
+    const SrcMgr::SLocEntry &Entry = LocalSLocEntryTable[I];
+    unsigned End = I + 1 == N ? NextLocalOffset
+                              : LocalSLocEntryTable[I + 1].getOffset();
+    unsigned Size = End - Entry.getOffset();
+    if (Entry.isFile()) {
+      FileSpace += Size;
+      continue;
+    }
+    const SrcMgr::ExpansionInfo &Expansion = Entry.getExpansion();
+    if (Expansion.isMacroArgExpansion()) {
+      MacroArgSpace += Size;
+      ++NumMacroArgEntries;
+      continue;
+    }
+    MacroSpace += Size;
+    ++NumMacroEntries;
+    auto &Use =
+        MacroSpaceBySpelling[Expansion.getSpellingLoc().getRawEncoding()];
+    Use.first += Size;
+    ++Use.second;
+  }
+  llvm::errs() << "Local Sloc address space: " << FileSpace << "B in files, "
+               << MacroSpace << "B in " << NumMacroEntries
+               << " macro expansions, " << MacroArgSpace << "B in "
+               << NumMacroArgEntries << " macro argument expansions.\n";
+
+  std::vector<std::pair<unsigned, std::pair<uint64_t, unsigned>>> MacroUsers(
+      MacroSpaceBySpelling.begin(), MacroSpaceBySpelling.end());
+  std::sort(MacroUsers.begin(), MacroUsers.end(),
+            [](const std::pair<unsigned, std::pair<uint64_t, unsigned>> &LHS,
+               const std::pair<unsigned, std::pair<uint64_t, unsigned>> &RHS) {
+              return std::make_pair(LHS.second.first, RHS.first) >
+                     std::make_pair(RHS.second.first, LHS.first);
+            });
+  if (MacroUsers.size() > 10)
+    MacroUsers.resize(10);
+  if (!MacroUsers.empty())
+    llvm::errs() << "Top macro expansions by Sloc address space:\n";
+  for (const auto &User : MacroUsers) {
+    llvm::errs() << "  " << User.second.first << "B in " << User.second.second
+                 << " expansions of ";
+    SourceLocation::getFromRawEncoding(User.first).print(llvm::errs(), *this);
+    llvm::errs() << '\n';
+  }
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
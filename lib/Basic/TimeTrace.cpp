@@ -0,0 +1,182 @@
+//===--- TimeTrace.cpp - Trace of Compiler Phases -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+
+typedef std::chrono::steady_clock ClockType;
+typedef std::chrono::microseconds DurationType;
+
+struct Event {
+  ClockType::time_point Start;
+  DurationType Duration;
+  std::string Name;
+  std::string Detail;
+};
+
+/// The time spent in all the scopes of a kind.
+struct Total {
+  unsigned Count = 0;
+  DurationType Duration = DurationType::zero();
+};
+
+} // end anonymous namespace
+
+class clang::TimeTraceProfiler {
+public:
+  ClockType::time_point StartTime = ClockType::now();
+  DurationType Granularity;
+  /// The scopes which have started and not ended yet, innermost last.
+  std::vector<Event> Stack;
+  /// The scopes which have ended, in the order they ended.
+  std::vector<Event> Events;
+  llvm::StringMap<Total> Totals;
+
+  explicit TimeTraceProfiler(unsigned GranularityUS)
+      : Granularity(GranularityUS) {}
+
+  void end() {
+    assert(!Stack.empty() && "Ending a scope which was never started!");
+    Event &E = Stack.back();
+    E.Duration =
+        std::chrono::duration_cast<DurationType>(ClockType::now() - E.Start);
+
+    // Only count the outermost of recursive scopes of a kind, such as nested
+    // template instantiations, towards the total.
+    if (std::none_of(Stack.begin(), Stack.end() - 1, [&](const Event &Outer) {
+          return Outer.Name == E.Name;
+        })) {
+      Total &T = Totals[E.Name];
+      ++T.Count;
+      T.Duration += E.Duration;
+    }
+
+    if (E.Duration >= Granularity)
+      Events.push_back(std::move(E));
+    Stack.pop_back();
+  }
+
+  void write(raw_ostream &OS);
+};
+
+TimeTraceProfiler *clang::TimeTraceProfilerInstance = nullptr;
+
+/// Writes \p Str as a JSON string.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':
+      OS << "\\\"";
+      break;
+    case '\\':
+      OS << "\\\\";
+      break;
+    case '\n':
+      OS << "\\n";
+      break;
+    case '\t':
+      OS << "\\t";
+      break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) {
+  OS << "{\"traceEvents\":[\n";
+  for (const Event &E : Events) {
+    auto Start =
+        std::chrono::duration_cast<DurationType>(E.Start - StartTime);
+    OS << "{\"pid\":1,\"tid\":0,\"ph\":\"X\",\"ts\":" << Start.count()
+       << ",\"dur\":" << E.Duration.count() << ",\"name\":";
+    writeJSONString(OS, E.Name);
+    OS << ",\"args\":{\"detail\":";
+    writeJSONString(OS, E.Detail);
+    OS << "}},\n";
+  }
+
+  // The totals are shown as one line each, longest first.
+  std::vector<std::pair<StringRef, Total>> SortedTotals;
+  for (const auto &T : Totals)
+    SortedTotals.push_back(std::make_pair(T.first(), T.second));
+  std::sort(SortedTotals.begin(), SortedTotals.end(),
+            [](const std::pair<StringRef, Total> &A,
+               const std::pair<StringRef, Total> &B) {
+              if (A.second.Duration != B.second.Duration)
+                return A.second.Duration > B.second.Duration;
+              return A.first < B.first;
+            });
+  unsigned Tid = 1;
+  for (const auto &T : SortedTotals) {
+    OS << "{\"pid\":1,\"tid\":" << Tid++ << ",\"ph\":\"X\",\"ts\":0,\"dur\":"
+       << T.second.Duration.count() << ",\"name\":";
+    writeJSONString(OS, ("Total " + T.first).str());
+    OS << ",\"args\":{\"count\":" << T.second.Count
+       << ",\"avg us\":" << T.second.Duration.count() / T.second.Count
+       << "}},\n";
+  }
+
+  OS << "{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"ts\":0,\"name\":\"process_name\","
+        "\"args\":{\"name\":\"clang\"}}\n"
+     << "]}\n";
+}
+
+void clang::timeTraceProfilerInitialize(unsigned GranularityUS) {
+  assert(!TimeTraceProfilerInstance && "Profiler is already recording!");
+  TimeTraceProfilerInstance = new TimeTraceProfiler(GranularityUS);
+}
+
+void clang::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+void clang::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(TimeTraceProfilerInstance && "Profiler is not recording!");
+  TimeTraceProfilerInstance->write(OS);
+}
+
+void clang::timeTraceProfilerForEachTotal(
+    llvm::function_ref<void(StringRef Name, unsigned Count,
+                            uint64_t DurationUS)> Fn) {
+  assert(TimeTraceProfilerInstance && "Profiler is not recording!");
+  for (const auto &T : TimeTraceProfilerInstance->Totals)
+    Fn(T.first(), T.second.Count, T.second.Duration.count());
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name,
+                                   llvm::function_ref<std::string()> Detail) {
+  assert(TimeTraceProfilerInstance && "Profiler is not recording!");
+  Event E;
+  E.Start = ClockType::now();
+  E.Duration = DurationType::zero();
+  E.Name = Name;
+  E.Detail = Detail();
+  TimeTraceProfilerInstance->Stack.push_back(std::move(E));
+}
+
+void clang::timeTraceProfilerEnd() {
+  assert(TimeTraceProfilerInstance && "Profiler is not recording!");
+  TimeTraceProfilerInstance->end();
+}
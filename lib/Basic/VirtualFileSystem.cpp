@@ -14,6 +14,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Config/llvm-config.h"
@@ -722,18 +723,49 @@ class RedirectingDirectoryEntry : public Entry {
   std::vector<std::unique_ptr<Entry>> Contents;
   Status S;
 
+  /// \brief The contents by name, so that lookups in the large directories of
+  /// generated overlays do not need to compare every entry.
+  llvm::StringMap<SmallVector<Entry *, 1>> ContentsByName;
+
+  /// \brief Whether any of the contents has an empty name, which is skipped
+  /// rather than matched against a path component.
+  bool HasUnnamedContents = false;
+
+  void indexContent(Entry *E) {
+    if (E->getName().empty())
+      HasUnnamedContents = true;
+    else
+      ContentsByName[E->getName()].push_back(E);
+  }
+
 public:
   RedirectingDirectoryEntry(StringRef Name,
                             std::vector<std::unique_ptr<Entry>> Contents,
                             Status S)
       : Entry(EK_Directory, Name), Contents(std::move(Contents)),
-        S(std::move(S)) {}
+        S(std::move(S)) {
+    for (const std::unique_ptr<Entry> &Content : this->Contents)
+      indexContent(Content.get());
+  }
   RedirectingDirectoryEntry(StringRef Name, Status S)
       : Entry(EK_Directory, Name), S(std::move(S)) {}
   Status getStatus() { return S; }
   void addContent(std::unique_ptr<Entry> Content) {
+    indexContent(Content.get());
     Contents.push_back(std::move(Content));
   }
+  /// \brief Returns the contents named exactly \p Name, in order.
+  ///
+  /// \returns false if contents with other names may also match \p Name,
+  /// in which case all of them need to be considered.
+  bool lookupContents(StringRef Name, ArrayRef<Entry *> &Result) const {
+    if (HasUnnamedContents)
+      return false;
+    auto I = ContentsByName.find(Name);
+    Result = I == ContentsByName.end() ? ArrayRef<Entry *>()
+                                       : makeArrayRef(I->second);
+    return true;
+  }
   Entry *getLastContent() const { return Contents.back().get(); }
   typedef decltype(Contents)::iterator iterator;
   iterator contents_begin() { return Contents.begin(); }
@@ -1063,11 +1095,18 @@ class RedirectingFileSystemParser {
       }
     } else { // Advance to the next component
       auto *DE = dyn_cast<RedirectingDirectoryEntry>(ParentEntry);
-      for (std::unique_ptr<Entry> &Content :
-           llvm::make_range(DE->contents_begin(), DE->contents_end())) {
-        auto *DirContent = dyn_cast<RedirectingDirectoryEntry>(Content.get());
-        if (DirContent && Name.equals(Content->getName()))
-          return DirContent;
+      ArrayRef<Entry *> Named;
+      if (DE->lookupContents(Name, Named)) {
+        for (Entry *Content : Named)
+          if (auto *DirContent = dyn_cast<RedirectingDirectoryEntry>(Content))
+            return DirContent;
+      } else {
+        for (std::unique_ptr<Entry> &Content :
+             llvm::make_range(DE->contents_begin(), DE->contents_end())) {
+          auto *DirContent = dyn_cast<RedirectingDirectoryEntry>(Content.get());
+          if (DirContent && Name.equals(Content->getName()))
+            return DirContent;
+        }
       }
     }
 
@@ -1509,6 +1548,19 @@ RedirectingFileSystem::lookupPath(sys::path::const_iterator Start,
   if (!DE)
     return make_error_code(llvm::errc::not_a_directory);
 
+  // Only the contents named like the next component can match it, unless the
+  // names are compared ignoring case.
+  ArrayRef<Entry *> Named;
+  if (CaseSensitive && !Start->equals(".") &&
+      DE->lookupContents(*Start, Named)) {
+    for (Entry *DirEntry : Named) {
+      ErrorOr<Entry *> Result = lookupPath(Start, End, DirEntry);
+      if (Result || Result.getError() != llvm::errc::no_such_file_or_directory)
+        return Result;
+    }
+    return make_error_code(llvm::errc::no_such_file_or_directory);
+  }
+
   for (const std::unique_ptr<Entry> &DirEntry :
        llvm::make_range(DE->contents_begin(), DE->contents_end())) {
     ErrorOr<Entry *> Result = lookupPath(Start, End, DirEntry.get());
@@ -9,12 +9,17 @@
 
 #include "clang/CodeGen/BackendUtil.h"
 #include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/FileUtilities.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Basic/Version.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
@@ -37,7 +42,9 @@
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -67,6 +74,7 @@ class EmitAssemblyHelper {
   Module *TheModule;
 
   Timer CodeGenerationTime;
+  Timer CodeGenSetupTime;
 
   std::unique_ptr<raw_pwrite_stream> OS;
 
@@ -81,7 +89,10 @@ private:
   /// Set LLVM command line options passed through -backend-option.
   void setCommandLineOpts();
 
-  void CreatePasses(legacy::PassManager &MPM, legacy::FunctionPassManager &FPM);
+  /// \p UsesCodeGen is true when machine code generation, which verifies the
+  /// module it is given, runs after the passes added here.
+  void CreatePasses(legacy::PassManager &MPM, legacy::FunctionPassManager &FPM,
+                    bool UsesCodeGen);
 
   /// Generates the TargetMachine.
   /// Leaves TM unchanged if it is unable to create the target machine.
@@ -104,7 +115,8 @@ public:
                      const clang::TargetOptions &TOpts,
                      const LangOptions &LOpts, Module *M)
       : Diags(_Diags), CodeGenOpts(CGOpts), TargetOpts(TOpts), LangOpts(LOpts),
-        TheModule(M), CodeGenerationTime("codegen", "Code Generation Time") {}
+        TheModule(M), CodeGenerationTime("codegen", "Code Generation Time"),
+        CodeGenSetupTime("codegen-setup", "Code Generation Setup Time") {}
 
   ~EmitAssemblyHelper() {
     if (CodeGenOpts.DisableFree)
@@ -287,7 +299,8 @@ static void addSymbolRewriterPass(const CodeGenOptions &Opts,
 }
 
 void EmitAssemblyHelper::CreatePasses(legacy::PassManager &MPM,
-                                      legacy::FunctionPassManager &FPM) {
+                                      legacy::FunctionPassManager &FPM,
+                                      bool UsesCodeGen) {
   // Handle disabling of all LLVM passes, where we want to preserve the
   // internal module before any optimization.
   if (CodeGenOpts.DisableLLVMPasses)
@@ -409,9 +422,12 @@ void EmitAssemblyHelper::CreatePasses(legacy::PassManager &MPM,
                            addEfficiencySanitizerPass);
   }
 
-  // Set up the per-function pass manager.
+  // Set up the per-function pass manager. At -O0 nothing but the always
+  // inliner and instrumentation runs before code generation, which verifies
+  // the module anyway, so don't verify each function beforehand as well.
   FPM.add(new TargetLibraryInfoWrapperPass(*TLII));
-  if (CodeGenOpts.VerifyModule)
+  if (CodeGenOpts.VerifyModule &&
+      !(UsesCodeGen && CodeGenOpts.OptimizationLevel == 0))
     FPM.add(createVerifierPass());
 
   // Set up the per-module pass manager.
@@ -633,50 +649,59 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       std::unique_ptr<raw_pwrite_stream> OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
 
-  setCommandLineOpts();
-
   bool UsesCodeGen = (Action != Backend_EmitNothing &&
                       Action != Backend_EmitBC &&
                       Action != Backend_EmitLL);
-  CreateTargetMachine(UsesCodeGen);
-
-  if (UsesCodeGen && !TM)
-    return;
-  if (TM)
-    TheModule->setDataLayout(TM->createDataLayout());
 
   legacy::PassManager PerModulePasses;
-  PerModulePasses.add(
-      createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
-
   legacy::FunctionPassManager PerFunctionPasses(TheModule);
-  PerFunctionPasses.add(
-      createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
+  legacy::PassManager CodeGenPasses;
 
-  CreatePasses(PerModulePasses, PerFunctionPasses);
+  {
+    // Time the fixed cost of setting up the backend separately from running
+    // it; for small -O0 compiles it can dominate.
+    TimeRegion SetupRegion(llvm::TimePassesIsEnabled ? &CodeGenSetupTime
+                                                     : nullptr);
 
-  legacy::PassManager CodeGenPasses;
-  CodeGenPasses.add(
-      createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
+    setCommandLineOpts();
 
-  switch (Action) {
-  case Backend_EmitNothing:
-    break;
+    CreateTargetMachine(UsesCodeGen);
 
-  case Backend_EmitBC:
-    PerModulePasses.add(createBitcodeWriterPass(
-        *OS, CodeGenOpts.EmitLLVMUseLists, CodeGenOpts.EmitSummaryIndex,
-        CodeGenOpts.EmitSummaryIndex));
-    break;
+    if (UsesCodeGen && !TM)
+      return;
+    if (TM)
+      TheModule->setDataLayout(TM->createDataLayout());
 
-  case Backend_EmitLL:
     PerModulePasses.add(
-        createPrintModulePass(*OS, "", CodeGenOpts.EmitLLVMUseLists));
-    break;
+        createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
 
-  default:
-    if (!AddEmitPasses(CodeGenPasses, Action, *OS))
-      return;
+    PerFunctionPasses.add(
+        createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
+
+    CreatePasses(PerModulePasses, PerFunctionPasses, UsesCodeGen);
+
+    CodeGenPasses.add(
+        createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
+
+    switch (Action) {
+    case Backend_EmitNothing:
+      break;
+
+    case Backend_EmitBC:
+      PerModulePasses.add(createBitcodeWriterPass(
+          *OS, CodeGenOpts.EmitLLVMUseLists, CodeGenOpts.EmitSummaryIndex,
+          CodeGenOpts.EmitSummaryIndex));
+      break;
+
+    case Backend_EmitLL:
+      PerModulePasses.add(
+          createPrintModulePass(*OS, "", CodeGenOpts.EmitLLVMUseLists));
+      break;
+
+    default:
+      if (!AddEmitPasses(CodeGenPasses, Action, *OS))
+        return;
+    }
   }
 
   // Before executing passes, print the final values of the LLVM options.
@@ -687,21 +712,28 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   {
     PrettyStackTraceString CrashInfo("Per-function optimization");
+    TimeTraceScope TimeScope("PerFunctionPasses");
 
     PerFunctionPasses.doInitialization();
     for (Function &F : *TheModule)
-      if (!F.isDeclaration())
+      if (!F.isDeclaration()) {
+        TimeTraceScope FunctionTimeScope("RunFunctionPasses", [&] {
+          return F.getName().str();
+        });
         PerFunctionPasses.run(F);
+      }
     PerFunctionPasses.doFinalization();
   }
 
   {
     PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope TimeScope("PerModulePasses");
     PerModulePasses.run(*TheModule);
   }
 
   {
     PrettyStackTraceString CrashInfo("Code generation");
+    TimeTraceScope TimeScope("CodeGenPasses");
     CodeGenPasses.run(*TheModule);
   }
 }
@@ -827,17 +859,104 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   // Now that we have all of the passes ready, run them.
   {
     PrettyStackTraceString CrashInfo("Optimizer");
+    TimeTraceScope TimeScope("Optimizer");
     MPM.run(*TheModule, MAM);
   }
 
   // Now if needed, run the legacy PM for codegen.
   if (NeedCodeGen) {
     PrettyStackTraceString CrashInfo("Code generation");
+    TimeTraceScope TimeScope("CodeGenPasses");
     CodeGenPasses.run(*TheModule);
   }
 }
 
-static void runThinLTOBackend(const CodeGenOptions &CGOpts, Module *M,
+/// Add everything in the options of a ThinLTO backend compile that can
+/// affect the object file it produces to \p Hasher.
+static void addThinLTOOptionsToHash(SHA1 &Hasher, const CodeGenOptions &CGOpts,
+                                    const clang::TargetOptions &TOpts,
+                                    const lto::Config &Conf) {
+  auto AddString = [&](StringRef S) {
+    Hasher.update(S);
+    Hasher.update(StringRef("", 1));
+  };
+  auto AddInt = [&](uint64_t I) { AddString(utostr(I)); };
+
+#define CODEGENOPT(Name, Bits, Default) AddInt(CGOpts.Name);
+#define ENUM_CODEGENOPT(Name, Type, Bits, Default) \
+  AddInt(static_cast<unsigned>(CGOpts.get##Name()));
+#include "clang/Frontend/CodeGenOptions.def"
+  AddString(CGOpts.CodeModel);
+  AddString(CGOpts.DebugCompilationDir);
+  AddString(CGOpts.DwarfDebugFlags);
+  AddString(CGOpts.FloatABI);
+  AddString(CGOpts.FPDenormalMode);
+  AddString(CGOpts.LimitFloatPrecision);
+  AddString(CGOpts.MainFileName);
+  AddString(CGOpts.SplitDwarfFile);
+  AddString(CGOpts.RelocationModel);
+  AddString(CGOpts.ThreadModel);
+  AddString(CGOpts.TrapFuncName);
+  // -mllvm options are applied to the whole process before the backend runs.
+  for (const std::string &Option : CGOpts.BackendOptions)
+    AddString(Option);
+  AddString("");
+
+  AddString(TOpts.Triple);
+  AddString(TOpts.CPU);
+  AddString(TOpts.ABI);
+  for (const std::string &Feature : TOpts.Features)
+    AddString(Feature);
+  AddString("");
+
+  AddString(Conf.CPU);
+  for (const std::string &Attr : Conf.MAttrs)
+    AddString(Attr);
+  AddString("");
+  AddInt(Conf.CodeModel);
+  AddInt(Conf.CGOptLevel);
+  AddInt(Conf.OptLevel);
+  AddString(Conf.OptPipeline);
+  AddString(Conf.AAPipeline);
+  AddString(Conf.OverrideTriple);
+  AddString(Conf.DefaultTriple);
+}
+
+/// Compute the name of the file in the ThinLTO cache directory holding the
+/// object file built from the individual index \p CombinedIndex with the
+/// given options. Returns false if the index does not record the hash of
+/// every module involved, in which case the result cannot be cached.
+static bool getThinLTOCachePath(const CodeGenOptions &CGOpts,
+                                const clang::TargetOptions &TOpts,
+                                const lto::Config &Conf,
+                                const ModuleSummaryIndex &CombinedIndex,
+                                SmallVectorImpl<char> &CachePath) {
+  // The individual index names the modules imported from and records which
+  // of their summaries are used and how their linkage is resolved, so along
+  // with the hashes of those modules it determines the backend's output.
+  for (const auto &ModulePath : CombinedIndex.modulePaths()) {
+    const ModuleHash &Hash = ModulePath.second.second;
+    if (llvm::all_of(Hash, [](uint32_t Word) { return Word == 0; }))
+      return false;
+  }
+  ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> IndexBuf =
+      llvm::MemoryBuffer::getFile(CGOpts.ThinLTOIndexFile);
+  if (!IndexBuf)
+    return false;
+
+  SHA1 Hasher;
+  Hasher.update(getClangFullVersion());
+  Hasher.update((*IndexBuf)->getBuffer());
+  addThinLTOOptionsToHash(Hasher, CGOpts, TOpts, Conf);
+  CachePath.assign(CGOpts.ThinLTOCacheDir.begin(),
+                   CGOpts.ThinLTOCacheDir.end());
+  llvm::sys::path::append(
+      CachePath, getHashedFileName("llvmcache", toHex(Hasher.result()), ".o"));
+  return true;
+}
+
+static void runThinLTOBackend(const CodeGenOptions &CGOpts,
+                              const clang::TargetOptions &TOpts, Module *M,
                               std::unique_ptr<raw_pwrite_stream> OS) {
   // If we are performing a ThinLTO importing compile, load the function index
   // into memory and pass it into thinBackend, which will run the function
@@ -852,6 +971,20 @@ static void runThinLTOBackend(const CodeGenOptions &CGOpts, Module *M,
   }
   std::unique_ptr<ModuleSummaryIndex> CombinedIndex = std::move(*IndexOrErr);
 
+  lto::Config Conf;
+
+  // If an earlier backend compile got the same inputs, reuse its output.
+  SmallString<128> CachePath;
+  if (!CGOpts.ThinLTOCacheDir.empty() &&
+      getThinLTOCachePath(CGOpts, TOpts, Conf, *CombinedIndex, CachePath)) {
+    ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> CachedObj =
+        llvm::MemoryBuffer::getFile(CachePath);
+    if (CachedObj) {
+      *OS << (*CachedObj)->getBuffer();
+      return;
+    }
+  }
+
   StringMap<std::map<GlobalValue::GUID, GlobalValueSummary *>>
       ModuleToDefinedGVSummaries;
   CombinedIndex->collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
@@ -915,16 +1048,28 @@ static void runThinLTOBackend(const CodeGenOptions &CGOpts, Module *M,
 
     OwnedImports.push_back(std::move(*MBOrErr));
   }
+  // When the output is to be cached, build it in memory first.
+  SmallString<0> Obj;
   auto AddStream = [&](size_t Task) {
+    if (!CachePath.empty())
+      return llvm::make_unique<lto::NativeObjectStream>(
+          llvm::make_unique<raw_svector_ostream>(Obj));
     return llvm::make_unique<lto::NativeObjectStream>(std::move(OS));
   };
-  lto::Config Conf;
   if (Error E = thinBackend(
           Conf, 0, AddStream, *M, *CombinedIndex, ImportList,
           ModuleToDefinedGVSummaries[M->getModuleIdentifier()], ModuleMap)) {
     handleAllErrors(std::move(E), [&](ErrorInfoBase &EIB) {
       errs() << "Error running ThinLTO backend: " << EIB.message() << '\n';
     });
+    return;
+  }
+
+  if (!CachePath.empty()) {
+    *OS << Obj;
+    // Failing to store the object file is not an error, the backend will
+    // just have to run again next time.
+    writeFileAtomically(CachePath, Obj);
   }
 }
 
@@ -934,8 +1079,9 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
                               const LangOptions &LOpts, const llvm::DataLayout &TDesc,
                               Module *M, BackendAction Action,
                               std::unique_ptr<raw_pwrite_stream> OS) {
+  TimeTraceScope TimeScope("Backend");
   if (!CGOpts.ThinLTOIndexFile.empty()) {
-    runThinLTOBackend(CGOpts, M, std::move(OS));
+    runThinLTOBackend(CGOpts, TOpts, M, std::move(OS));
     return;
   }
 
@@ -17,6 +17,7 @@
 #include "CodeGenModule.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/CodeGen/CGFunctionInfo.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/Operator.h"
@@ -681,15 +682,27 @@ RValue CodeGenFunction::EmitAtomicExpr(AtomicExpr *E) {
   std::tie(sizeChars, alignChars) = getContext().getTypeInfoInChars(AtomicTy);
   uint64_t Size = sizeChars.getQuantity();
   unsigned MaxInlineWidthInBits = getTarget().getMaxAtomicInlineWidth();
-  bool UseLibcall = (sizeChars != alignChars ||
-                     getContext().toBits(sizeChars) > MaxInlineWidthInBits);
 
   llvm::Value *IsWeak = nullptr, *OrderFail = nullptr;
 
   Address Val1 = Address::invalid();
   Address Val2 = Address::invalid();
   Address Dest = Address::invalid();
-  Address Ptr(EmitScalarExpr(E->getPtr()), alignChars);
+  // The object may be known to be more aligned than its type, e.g. a 16-byte
+  // struct declared with alignas(16); that is enough to use a native
+  // instruction (such as cmpxchg16b) instead of a libatomic call.
+  Address Ptr = EmitPointerWithAlignment(E->getPtr());
+  if (Ptr.getAlignment() < alignChars)
+    Ptr = Address(Ptr.getPointer(), alignChars);
+
+  bool Oversized = getContext().toBits(sizeChars) > MaxInlineWidthInBits;
+  bool Misaligned =
+      sizeChars.isZero() || (Ptr.getAlignment() % sizeChars) != 0;
+  bool UseLibcall = Oversized || Misaligned;
+  if (UseLibcall)
+    CGM.getDiags().Report(E->getLocStart(), diag::warn_atomic_op_libcall)
+        << Misaligned << AtomicTy;
+
   if (E->getOp() == AtomicExpr::AO__c11_atomic_init) {
     LValue lvalue = MakeAddrLValue(Ptr, AtomicTy);
     EmitAtomicInit(E->getVal1(), lvalue);
@@ -3525,30 +3525,52 @@ static const NeonIntrinsicInfo AArch64SISDIntrinsicMap[] = {
 #undef NEONMAP1
 #undef NEONMAP2
 
-static bool NEONSIMDIntrinsicsProvenSorted = false;
-
-static bool AArch64SIMDIntrinsicsProvenSorted = false;
-static bool AArch64SISDIntrinsicsProvenSorted = false;
-
-
-static const NeonIntrinsicInfo *
-findNeonIntrinsicInMap(ArrayRef<NeonIntrinsicInfo> IntrinsicMap,
-                       unsigned BuiltinID, bool &MapProvenSorted) {
+namespace {
+/// Maps each NEON builtin to its entry in one of the intrinsic maps above, so
+/// that finding the entry for a call is a single array access rather than a
+/// search.
+class NeonIntrinsicIndex {
+  ArrayRef<NeonIntrinsicInfo> IntrinsicMap;
+  /// One plus the position of the entry for each NEON builtin, or zero if the
+  /// builtin is not in the map.
+  std::vector<uint16_t> Entries;
+
+public:
+  explicit NeonIntrinsicIndex(ArrayRef<NeonIntrinsicInfo> IntrinsicMap)
+      : IntrinsicMap(IntrinsicMap),
+        Entries(NEON::FirstTSBuiltin - Builtin::FirstTSBuiltin, 0) {
+    assert(IntrinsicMap.size() < UINT16_MAX && "intrinsic map too large");
+    for (unsigned I = 0, E = IntrinsicMap.size(); I != E; ++I) {
+      unsigned Index = IntrinsicMap[I].BuiltinID - Builtin::FirstTSBuiltin;
+      assert(Index < Entries.size() && "not a NEON builtin");
+      if (!Entries[Index])
+        Entries[Index] = I + 1;
+    }
+  }
 
-#ifndef NDEBUG
-  if (!MapProvenSorted) {
-    assert(std::is_sorted(std::begin(IntrinsicMap), std::end(IntrinsicMap)));
-    MapProvenSorted = true;
+  const NeonIntrinsicInfo *lookup(unsigned BuiltinID) const {
+    if (BuiltinID < Builtin::FirstTSBuiltin ||
+        BuiltinID >= NEON::FirstTSBuiltin)
+      return nullptr;
+    unsigned Entry = Entries[BuiltinID - Builtin::FirstTSBuiltin];
+    return Entry ? &IntrinsicMap[Entry - 1] : nullptr;
   }
-#endif
+};
+} // end anonymous namespace
 
-  const NeonIntrinsicInfo *Builtin =
-      std::lower_bound(IntrinsicMap.begin(), IntrinsicMap.end(), BuiltinID);
+static const NeonIntrinsicInfo *findARMSIMDIntrinsic(unsigned BuiltinID) {
+  static const NeonIntrinsicIndex Index(ARMSIMDIntrinsicMap);
+  return Index.lookup(BuiltinID);
+}
 
-  if (Builtin != IntrinsicMap.end() && Builtin->BuiltinID == BuiltinID)
-    return Builtin;
+static const NeonIntrinsicInfo *findAArch64SIMDIntrinsic(unsigned BuiltinID) {
+  static const NeonIntrinsicIndex Index(AArch64SIMDIntrinsicMap);
+  return Index.lookup(BuiltinID);
+}
 
-  return nullptr;
+static const NeonIntrinsicInfo *findAArch64SISDIntrinsic(unsigned BuiltinID) {
+  static const NeonIntrinsicIndex Index(AArch64SISDIntrinsicMap);
+  return Index.lookup(BuiltinID);
 }
 
 Function *CodeGenFunction::LookupNeonLLVMIntrinsic(unsigned IntrinsicID,
@@ -4820,9 +4842,7 @@ Value *CodeGenFunction::EmitARMBuiltinExpr(unsigned BuiltinID,
 
   // Many NEON builtins have identical semantics and uses in ARM and
   // AArch64. Emit these in a single function.
-  auto IntrinsicMap = makeArrayRef(ARMSIMDIntrinsicMap);
-  const NeonIntrinsicInfo *Builtin = findNeonIntrinsicInMap(
-      IntrinsicMap, BuiltinID, NEONSIMDIntrinsicsProvenSorted);
+  const NeonIntrinsicInfo *Builtin = findARMSIMDIntrinsic(BuiltinID);
   if (Builtin)
     return EmitCommonNeonBuiltinExpr(
         Builtin->BuiltinID, Builtin->LLVMIntrinsic, Builtin->AltLLVMIntrinsic,
@@ -5429,9 +5449,7 @@ Value *CodeGenFunction::EmitAArch64BuiltinExpr(unsigned BuiltinID,
     }
   }
 
-  auto SISDMap = makeArrayRef(AArch64SISDIntrinsicMap);
-  const NeonIntrinsicInfo *Builtin = findNeonIntrinsicInMap(
-      SISDMap, BuiltinID, AArch64SISDIntrinsicsProvenSorted);
+  const NeonIntrinsicInfo *Builtin = findAArch64SISDIntrinsic(BuiltinID);
 
   if (Builtin) {
     Ops.push_back(EmitScalarExpr(E->getArg(E->getNumArgs() - 1)));
@@ -5917,8 +5935,7 @@ Value *CodeGenFunction::EmitAArch64BuiltinExpr(unsigned BuiltinID,
 
   // Not all intrinsics handled by the common case work for AArch64 yet, so only
   // defer to common code if it's been added to our special map.
-  Builtin = findNeonIntrinsicInMap(AArch64SIMDIntrinsicMap, BuiltinID,
-                                   AArch64SIMDIntrinsicsProvenSorted);
+  Builtin = findAArch64SIMDIntrinsic(BuiltinID);
 
   if (Builtin)
     return EmitCommonNeonBuiltinExpr(
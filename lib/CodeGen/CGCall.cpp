@@ -3996,8 +3996,8 @@ RValue CodeGenFunction::EmitCall(const CGFunctionInfo &CallInfo,
                            llvm::Attribute::AlwaysInline);
   }
 
-  // Disable inlining inside SEH __try blocks.
-  if (isSEHTryScope()) {
+  // Disable inlining inside SEH __try blocks and outlined EH cleanups.
+  if (isSEHTryScope() || IsOutlinedEHCleanup) {
     Attrs =
         Attrs.addAttribute(getLLVMContext(), llvm::AttributeSet::FunctionIndex,
                            llvm::Attribute::NoInline);
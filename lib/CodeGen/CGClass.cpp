@@ -804,6 +804,11 @@ void CodeGenFunction::EmitConstructorBody(FunctionArgList &Args) {
           CtorType == Ctor_Complete) &&
          "can only generate complete ctor for this ABI");
 
+  // A class homed with its out-of-line constructors gets its complete debug
+  // info here.
+  if (CGDebugInfo *DI = CGM.getModuleDebugInfo())
+    DI->completeClassForConstructor(Ctor);
+
   // Before we go any further, try the complete->base constructor
   // delegation optimization.
   if (CtorType == Ctor_Complete && IsConstructorDelegationValid(Ctor) &&
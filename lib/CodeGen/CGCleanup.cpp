@@ -527,8 +527,17 @@ static void EmitCleanup(CodeGenFunction &CGF,
     CGF.EmitBlock(CleanupBB);
   }
 
-  // Ask the cleanup to emit itself.
-  Fn->Emit(CGF, flags);
+  // Ask the cleanup to emit itself.  Under -foutline-eh-cleanups the calls
+  // on the unwind path are kept out of line, so that the cold copy of the
+  // cleanup doesn't grow with the inlined destructors.
+  {
+    llvm::SaveAndRestore<bool> OutlinedEHCleanup(
+        CGF.IsOutlinedEHCleanup,
+        CGF.IsOutlinedEHCleanup ||
+            (flags.isForEHCleanup() &&
+             CGF.CGM.getCodeGenOpts().OutlineEHCleanups));
+    Fn->Emit(CGF, flags);
+  }
   assert(CGF.HaveInsertPoint() && "cleanup ended with no insertion point?");
 
   // Emit the continuation block if there was an active flag.
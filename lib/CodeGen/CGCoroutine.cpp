@@ -30,6 +30,14 @@ struct CGCoroData {
   // diagnostic. If CoroIdExpr is nullptr, the coro.id was created by
   // EmitCoroutineBody.
   CallExpr const *CoroIdExpr = nullptr;
+
+  // Stores the llvm.coro.begin emitted by EmitCoroutineBody, which is the
+  // frame pointer that __builtin_coro_frame refers to.
+  llvm::CallInst *CoroBegin = nullptr;
+
+  // Stores the last llvm.coro.free emitted, so that the deallocation can be
+  // skipped when the frame was not allocated on the heap.
+  llvm::CallInst *LastCoroFree = nullptr;
 };
 }
 }
@@ -59,19 +67,74 @@ static void createCoroData(CodeGenFunction &CGF,
   CurCoro.Data->CoroIdExpr = CoroIdExpr;
 }
 
+/// Emit the deallocation of the coroutine frame, skipping it when coro.free
+/// returns null because the frame was not allocated on the heap.
+static void emitCoroutineDeallocate(CodeGenFunction &CGF,
+                                    const Stmt *Deallocate) {
+  // Emit the deallocation first to get to the coro.free which is the argument
+  // of the delete call, remembering where we are.
+  llvm::BasicBlock *SaveInsertBlock = CGF.Builder.GetInsertBlock();
+  llvm::BasicBlock *FreeBB = CGF.createBasicBlock("coro.free");
+  CGF.EmitBlock(FreeBB);
+  CGF.CurCoro.Data->LastCoroFree = nullptr;
+  CGF.EmitStmt(Deallocate);
+  llvm::BasicBlock *AfterFreeBB = CGF.createBasicBlock("after.coro.free");
+  CGF.EmitBlock(AfterFreeBB);
+
+  llvm::CallInst *CoroFree = CGF.CurCoro.Data->LastCoroFree;
+  if (!CoroFree) {
+    CGF.CGM.Error(Deallocate->getLocStart(),
+                  "deallocation expression does not refer to coro.free");
+    return;
+  }
+
+  // Go back and branch around the deallocation: if (auto *Mem = coro.free)
+  // Deallocate(Mem);
+  llvm::Instruction *InsertPt = SaveInsertBlock->getTerminator();
+  CoroFree->moveBefore(InsertPt);
+  CGF.Builder.SetInsertPoint(InsertPt);
+  auto *NullPtr = llvm::ConstantPointerNull::get(CGF.Int8PtrTy);
+  llvm::Value *Cond = CGF.Builder.CreateICmpNE(CoroFree, NullPtr);
+  CGF.Builder.CreateCondBr(Cond, FreeBB, AfterFreeBB);
+  InsertPt->eraseFromParent();
+  CGF.Builder.SetInsertPoint(AfterFreeBB);
+}
+
 void CodeGenFunction::EmitCoroutineBody(const CoroutineBodyStmt &S) {
   auto *NullPtr = llvm::ConstantPointerNull::get(Builder.getInt8PtrTy());
   auto &TI = CGM.getContext().getTargetInfo();
   unsigned NewAlign = TI.getNewAlign() / TI.getCharWidth();
 
+  auto *EntryBB = Builder.GetInsertBlock();
+  auto *AllocBB = createBasicBlock("coro.alloc");
+  auto *InitBB = createBasicBlock("coro.init");
+
   auto *CoroId = Builder.CreateCall(
       CGM.getIntrinsic(llvm::Intrinsic::coro_id),
       {Builder.getInt32(NewAlign), NullPtr, NullPtr, NullPtr});
   createCoroData(*this, CurCoro, CoroId);
 
-  EmitScalarExpr(S.getAllocate());
+  // Only allocate the frame if coro.alloc says so. The optimizer turns it
+  // into false when it can prove that the frame does not outlive the caller,
+  // and then keeps the frame on the caller's stack.
+  auto *CoroAlloc = Builder.CreateCall(
+      CGM.getIntrinsic(llvm::Intrinsic::coro_alloc), {CoroId});
+  Builder.CreateCondBr(CoroAlloc, AllocBB, InitBB);
+
+  EmitBlock(AllocBB);
+  auto *AllocateCall = EmitScalarExpr(S.getAllocate());
+  auto *AllocOrInvokeContBB = Builder.GetInsertBlock();
+  Builder.CreateBr(InitBB);
+
+  EmitBlock(InitBB);
+  auto *Phi = Builder.CreatePHI(VoidPtrTy, 2);
+  Phi->addIncoming(NullPtr, EntryBB);
+  Phi->addIncoming(AllocateCall, AllocOrInvokeContBB);
+  CurCoro.Data->CoroBegin = Builder.CreateCall(
+      CGM.getIntrinsic(llvm::Intrinsic::coro_begin), {CoroId, Phi});
+
   // FIXME: Emit the rest of the coroutine.
-  EmitStmt(S.getDeallocate());
+  emitCoroutineDeallocate(*this, S.getDeallocate());
 }
 
 // Emit coroutine intrinsic and patch up arguments of the token type.
@@ -81,6 +144,11 @@ RValue CodeGenFunction::EmitCoroutineIntrinsic(const CallExpr *E,
   switch (IID) {
   default:
     break;
+  // In a coroutine, the frame is the one returned by coro.begin.
+  case llvm::Intrinsic::coro_frame:
+    if (CurCoro.Data && CurCoro.Data->CoroBegin)
+      return RValue::get(CurCoro.Data->CoroBegin);
+    break;
   // The following three intrinsics take a token parameter referring to a token
   // returned by earlier call to @llvm.coro.id. Since we cannot represent it in
   // builtins, we patch it up here.
@@ -111,6 +179,10 @@ RValue CodeGenFunction::EmitCoroutineIntrinsic(const CallExpr *E,
   // coro.alloc, coro.begin and coro.free intrinsics to refer to it.
   if (IID == llvm::Intrinsic::coro_id) {
     createCoroData(*this, CurCoro, Call, E);
+  } else if (IID == llvm::Intrinsic::coro_free) {
+    // Remember the last coro.free so that the deallocation can be guarded.
+    if (CurCoro.Data)
+      CurCoro.Data->LastCoroFree = Call;
   }
   return RValue::get(Call);
 }
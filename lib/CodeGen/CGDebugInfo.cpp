@@ -62,6 +62,7 @@ static uint32_t getDeclAlignIfRequired(const Decl *D, const ASTContext &Ctx) {
 CGDebugInfo::CGDebugInfo(CodeGenModule &CGM)
     : CGM(CGM), DebugKind(CGM.getCodeGenOpts().getDebugInfo()),
       DebugTypeExtRefs(CGM.getCodeGenOpts().DebugTypeExtRefs),
+      DebugTypeCtorHoming(CGM.getCodeGenOpts().DebugTypeCtorHoming),
       DBuilder(CGM.getModule()) {
   for (const auto &KV : CGM.getCodeGenOpts().DebugPrefixMap)
     DebugPrefixMap[KV.first] = KV.second;
@@ -1781,8 +1782,42 @@ static bool isClassOrMethodDLLImport(const CXXRecordDecl *RD) {
   return false;
 }
 
+/// Can the definition of \p RD be emitted only along with one of its
+/// constructors?  That is the case if an object of the class can only be
+/// created by calling a constructor which is defined out of line, and which
+/// is therefore emitted in exactly one translation unit. Copy and move
+/// constructors don't count, since they need an object to start from.
+static bool canUseCtorHoming(const CXXRecordDecl *RD) {
+  // Members of templates are only instantiated where they are used, and
+  // constructors with internal linkage are only emitted where they are used.
+  if (RD->getTemplateSpecializationKind() != TSK_Undeclared ||
+      RD->isDependentContext() || !RD->isExternallyVisible())
+    return false;
+  // Microsoft debuggers don't resolve type information across DLL boundaries.
+  if (isClassOrMethodDLLImport(RD))
+    return false;
+  // Objects of these can be created without calling any constructor, or
+  // with one that is emitted wherever it is used.
+  if (RD->isLambda() || RD->isAggregate() ||
+      RD->hasTrivialDefaultConstructor() ||
+      RD->needsImplicitDefaultConstructor() ||
+      RD->hasConstexprNonCopyMoveConstructor())
+    return false;
+  bool HasOutOfLineCtor = false;
+  for (const CXXConstructorDecl *Ctor : RD->ctors()) {
+    if (Ctor->isDeleted() || Ctor->isCopyOrMoveConstructor())
+      continue;
+    if (Ctor->isConstexpr() || Ctor->isInlined() ||
+        Ctor->getMostRecentDecl()->isInlined())
+      return false;
+    HasOutOfLineCtor = true;
+  }
+  return HasOutOfLineCtor;
+}
+
 static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
-                                 bool DebugTypeExtRefs, const RecordDecl *RD,
+                                 bool DebugTypeExtRefs,
+                                 bool DebugTypeCtorHoming, const RecordDecl *RD,
                                  const LangOptions &LangOpts) {
   if (DebugTypeExtRefs && isDefinedInClangModule(RD->getDefinition()))
     return true;
@@ -1811,6 +1846,12 @@ static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
       !isClassOrMethodDLLImport(CXXDecl))
     return true;
 
+  // With constructor homing, only emit complete debug info for a class with
+  // an out-of-line constructor when that constructor is emitted.
+  if (DebugTypeCtorHoming && CXXDecl->hasDefinition() &&
+      canUseCtorHoming(CXXDecl->getDefinition()))
+    return true;
+
   TemplateSpecializationKind Spec = TSK_Undeclared;
   if (const auto *SD = dyn_cast<ClassTemplateSpecializationDecl>(RD))
     Spec = SD->getSpecializationKind();
@@ -1823,8 +1864,19 @@ static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
   return false;
 }
 
+void CGDebugInfo::completeClassForConstructor(const CXXConstructorDecl *Ctor) {
+  const CXXRecordDecl *RD = Ctor->getParent();
+  if (!DebugTypeCtorHoming || DebugKind > codegenoptions::LimitedDebugInfo ||
+      !CGM.getLangOpts().CPlusPlus || Ctor->isInlined() ||
+      (DebugTypeExtRefs && isDefinedInClangModule(RD)) ||
+      !canUseCtorHoming(RD))
+    return;
+  completeClassData(RD);
+}
+
 void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
-  if (shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD, CGM.getLangOpts()))
+  if (shouldOmitDefinition(DebugKind, DebugTypeExtRefs, DebugTypeCtorHoming, RD,
+                           CGM.getLangOpts()))
     return;
 
   QualType Ty = CGM.getContext().getRecordType(RD);
@@ -1836,8 +1888,8 @@ void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
 llvm::DIType *CGDebugInfo::CreateType(const RecordType *Ty) {
   RecordDecl *RD = Ty->getDecl();
   llvm::DIType *T = cast_or_null<llvm::DIType>(getTypeOrNull(QualType(Ty, 0)));
-  if (T || shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD,
-                                CGM.getLangOpts())) {
+  if (T || shouldOmitDefinition(DebugKind, DebugTypeExtRefs,
+                                DebugTypeCtorHoming, RD, CGM.getLangOpts())) {
     if (!T)
       T = getOrCreateRecordFwdDecl(Ty, getDeclContextDescriptor(RD));
     return T;
@@ -2018,8 +2070,9 @@ CGDebugInfo::getOrCreateModuleRef(ExternalASTSource::ASTSourceDescriptor Mod,
 
   bool IsRootModule = M ? !M->Parent : true;
   if (CreateSkeletonCU && IsRootModule) {
-    // PCH files don't have a signature field in the control block,
-    // but LLVM detects skeleton CUs by looking for a non-zero DWO id.
+    // Explicitly built modules and PCHs not in an object file container
+    // don't have a signature field in the control block, but LLVM detects
+    // skeleton CUs by looking for a non-zero DWO id.
     uint64_t Signature = Mod.getSignature() ? Mod.getSignature() : ~1ULL;
     llvm::DIBuilder DIB(CGM.getModule());
     DIB.createCompileUnit(TheCU->getSourceLanguage(),
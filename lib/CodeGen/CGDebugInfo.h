@@ -56,6 +56,7 @@ class CGDebugInfo {
   CodeGenModule &CGM;
   const codegenoptions::DebugInfoKind DebugKind;
   bool DebugTypeExtRefs;
+  bool DebugTypeCtorHoming;
   llvm::DIBuilder DBuilder;
   llvm::DICompileUnit *TheCU = nullptr;
   ModuleMap *ClangModuleMap = nullptr;
@@ -419,6 +420,10 @@ public:
   void completeRequiredType(const RecordDecl *RD);
   void completeClassData(const RecordDecl *RD);
 
+  /// Emit the definition of the class of \p Ctor if it is homed in the
+  /// translation unit that defines this constructor.
+  void completeClassForConstructor(const CXXConstructorDecl *Ctor);
+
   void completeTemplateDefinition(const ClassTemplateSpecializationDecl &SD);
 
 private:
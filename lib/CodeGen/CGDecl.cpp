@@ -1386,7 +1386,7 @@ void CodeGenFunction::EmitAutoVarCleanups(const AutoVarEmission &emission) {
   // Make sure we call @llvm.lifetime.end.  This needs to happen
   // *last*, so the cleanup needs to be pushed *first*.
   if (emission.useLifetimeMarkers())
-    EHStack.pushCleanup<CallLifetimeEnd>(NormalEHLifetimeMarker,
+    EHStack.pushCleanup<CallLifetimeEnd>(getLifetimeMarkerCleanupKind(),
                                          emission.getAllocatedAddress(),
                                          emission.getSizeForLifetimeMarkers());
 
@@ -16,6 +16,7 @@
 #include "CGObjCRuntime.h"
 #include "CGOpenMPRuntime.h"
 #include "clang/Frontend/CodeGenOptions.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/Support/Path.h"
@@ -367,6 +368,10 @@ CodeGenModule::EmitCXXGlobalVarDeclInitFunc(const VarDecl *D,
   CodeGenFunction(*this).GenerateCXXGlobalVarDeclInitFunc(Fn, D, Addr,
                                                           PerformInit);
 
+  if (!getDiags().isIgnored(diag::remark_cxx_dynamic_initializer,
+                            D->getLocation()))
+    reportDynamicInitializer(D, Fn, PerformInit);
+
   llvm::GlobalVariable *COMDATKey =
       supportsCOMDAT() && D->isExternallyVisible() ? Addr : nullptr;
 
@@ -418,6 +423,31 @@ CodeGenModule::EmitCXXGlobalVarDeclInitFunc(const VarDecl *D,
   DelayedCXXInitPosition[D] = ~0U;
 }
 
+void CodeGenModule::reportDynamicInitializer(const VarDecl *D,
+                                             llvm::Function *Fn,
+                                             bool PerformInit) {
+  unsigned Size = 0;
+  for (const llvm::BasicBlock &BB : *Fn)
+    Size += BB.size();
+  getDiags().Report(D->getLocation(), diag::remark_cxx_dynamic_initializer)
+      << !PerformInit << D << Size;
+  if (!PerformInit)
+    return;
+
+  // Explain why the initializer couldn't be evaluated at compile time.
+  APValue Value;
+  SmallVector<PartialDiagnosticAt, 8> Notes;
+  if (CodeGenOpts.FoldGlobalInitializers)
+    D->getInit()->EvaluateAsStaticInitializer(Value, Context, D, Notes);
+  else
+    D->getInit()->EvaluateAsInitializer(Value, Context, D, Notes);
+  for (const PartialDiagnosticAt &Note : Notes) {
+    DiagnosticBuilder Builder =
+        getDiags().Report(Note.first, Note.second.getDiagID());
+    Note.second.Emit(Builder);
+  }
+}
+
 void CodeGenModule::EmitCXXThreadLocalInitFunc() {
   getCXXABI().EmitThreadLocalInitFuncs(
       *this, CXXThreadLocals, CXXThreadLocalInits, CXXThreadLocalInitVars);
@@ -534,11 +534,11 @@ EmitMaterializeTemporaryExpr(const MaterializeTemporaryExpr *M) {
               CGM.getDataLayout().getTypeAllocSize(Object.getElementType()),
               Object.getPointer())) {
         if (M->getStorageDuration() == SD_Automatic)
-          pushCleanupAfterFullExpr<CallLifetimeEnd>(NormalEHLifetimeMarker,
-                                                    Object, Size);
+          pushCleanupAfterFullExpr<CallLifetimeEnd>(
+              getLifetimeMarkerCleanupKind(), Object, Size);
         else
-          pushFullExprCleanup<CallLifetimeEnd>(NormalEHLifetimeMarker, Object,
-                                               Size);
+          pushFullExprCleanup<CallLifetimeEnd>(getLifetimeMarkerCleanupKind(),
+                                               Object, Size);
       }
       break;
     default:
@@ -3120,6 +3120,8 @@ LValue CodeGenFunction::EmitArraySubscriptExpr(const ArraySubscriptExpr *E,
 
   AlignmentSource AlignSource;
   Address Addr = Address::invalid();
+  LValue ArrayLV;
+  bool IsArrayLV = false;
   if (const VariableArrayType *vla =
            getContext().getAsVariableArrayType(E->getType())) {
     // The base must be a pointer, which is not an aggregate.  Emit
@@ -3180,13 +3182,13 @@ LValue CodeGenFunction::EmitArraySubscriptExpr(const ArraySubscriptExpr *E,
     // "gep x, i" here.  Emit one "gep A, 0, i".
     assert(Array->getType()->isArrayType() &&
            "Array to pointer decay must have array source type!");
-    LValue ArrayLV;
     // For simple multidimensional array indexing, set the 'accessed' flag for
     // better bounds-checking of the base expression.
     if (const auto *ASE = dyn_cast<ArraySubscriptExpr>(Array))
       ArrayLV = EmitArraySubscriptExpr(ASE, /*Accessed*/ true);
     else
       ArrayLV = EmitLValue(Array);
+    IsArrayLV = true;
     auto *Idx = EmitIdxAfterBase(/*Promote*/true);
 
     // Propagate the alignment from the array itself to the result.
@@ -3205,7 +3207,13 @@ LValue CodeGenFunction::EmitArraySubscriptExpr(const ArraySubscriptExpr *E,
 
   LValue LV = MakeAddrLValue(Addr, E->getType(), AlignSource);
 
-  // TODO: Preserve/extend path TBAA metadata?
+  // An element of an array is accessed through the path of the array, with
+  // the offset of its first element.
+  if (IsArrayLV && CGM.getCodeGenOpts().PreciseStructPathTBAA) {
+    LV.setTBAAInfo(ArrayLV.getTBAAInfo());
+    LV.setTBAABaseType(ArrayLV.getTBAABaseType());
+    LV.setTBAAOffset(ArrayLV.getTBAAOffset());
+  }
 
   if (getLangOpts().ObjC1 &&
       getLangOpts().getGC() != LangOptions::NonGC) {
@@ -3551,6 +3559,14 @@ LValue CodeGenFunction::EmitLValueForField(LValue base,
   QualType type = field->getType();
 
   bool mayAlias = rec->hasAttr<MayAliasAttr>();
+  // The fields of anonymous structs and unions are fields of the enclosing
+  // record as well.
+  for (const RecordDecl *R = rec; !mayAlias && R->isAnonymousStructOrUnion();) {
+    R = dyn_cast<RecordDecl>(R->getDeclContext());
+    if (!R)
+      break;
+    mayAlias = R->hasAttr<MayAliasAttr>();
+  }
 
   Address addr = base.getAddress();
   unsigned cvr = base.getVRQualifiers();
@@ -3558,8 +3574,12 @@ LValue CodeGenFunction::EmitLValueForField(LValue base,
   if (rec->isUnion()) {
     // For unions, there is no pointer adjustment.
     assert(!type->isReferenceType() && "union has reference member");
-    // TODO: handle path-aware TBAA for union.
-    TBAAPath = false;
+    // Path-aware TBAA can only describe a union whose members all have the
+    // same type.
+    if (!CGM.getCodeGenOpts().PreciseStructPathTBAA ||
+        CGM.getTBAAInfo(getContext().getRecordType(rec)) ==
+            CGM.getTBAAInfo(getContext().CharTy))
+      TBAAPath = false;
   } else {
     // For structs, we GEP to the field that the record layout suggests.
     addr = emitAddrOfFieldStorage(*this, addr, field);
@@ -3624,8 +3644,6 @@ LValue CodeGenFunction::EmitLValueForField(LValue base,
     LV.getQuals().removeObjCGCAttr();
 
   // Fields of may_alias structs act like 'char' for TBAA purposes.
-  // FIXME: this should get propagated down through anonymous structs
-  // and unions.
   if (mayAlias && LV.getTBAAInfo())
     LV.setTBAAInfo(CGM.getTBAAInfo(getContext().CharTy));
 
@@ -18,6 +18,7 @@
 #include "CGObjCRuntime.h"
 #include "clang/CodeGen/CGFunctionInfo.h"
 #include "clang/Frontend/CodeGenOptions.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Intrinsics.h"
 
@@ -214,6 +215,18 @@ RValue CodeGenFunction::EmitCXXMemberOrOperatorMemberCallExpr(
       // we don't have support for that yet, so do a virtual call.
       DevirtualizedMethod = nullptr;
     }
+
+    if (DevirtualizedMethod) {
+      unsigned Reason = 2;
+      if (MD->hasAttr<FinalAttr>() ||
+          DevirtualizedMethod->hasAttr<FinalAttr>())
+        Reason = 0;
+      else if (BestDynamicDecl && BestDynamicDecl->hasAttr<FinalAttr>())
+        Reason = 1;
+      CGM.getDiags().Report(CE->getExprLoc(),
+                            diag::remark_cxx_vcall_devirtualized)
+          << MD << Reason;
+    }
   }
 
   // C++17 demands that we evaluate the RHS of a (possibly-compound) assignment
@@ -22,6 +22,7 @@
 #include "clang/AST/RecordLayout.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Frontend/CodeGenOptions.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
@@ -1221,6 +1222,17 @@ llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
   if (const APValue *Value = D.evaluateValue())
     return EmitConstantValueForMemory(*Value, D.getType(), CGF);
 
+  // The dynamic initialization of a static variable can be performed at
+  // compile time even if it calls functions which are not constexpr, as long
+  // as it doesn't touch any other variable.
+  if (CodeGenOpts.FoldGlobalInitializers && getLangOpts().CPlusPlus &&
+      !D.hasLocalStorage()) {
+    APValue Value;
+    SmallVector<PartialDiagnosticAt, 8> Notes;
+    if (D.getInit()->EvaluateAsStaticInitializer(Value, Context, &D, Notes))
+      return EmitConstantValueForMemory(Value, D.getType(), CGF);
+  }
+
   // FIXME: Implement C++11 [basic.start.init]p2: if the initializer of a
   // reference is a constant expression, and the reference binds to a temporary,
   // then constant initialization is performed. ConstExprEmitter will
@@ -1120,6 +1120,16 @@ public:
                                 ArrayRef<llvm::Value *> CapturedVars,
                                 const Expr *IfCond);
 
+  /// \brief Emits code for the serial call of the \a OutlinedFn by the
+  /// encountering thread alone, as for a parallel region whose 'if' clause is
+  /// false or which is to be run by a team of one thread.
+  /// \param OutlinedFn Outlined function of the parallel region.
+  /// \param CapturedVars Variables used in \a OutlinedFn function.
+  ///
+  void emitSerializedParallelCall(CodeGenFunction &CGF, SourceLocation Loc,
+                                  llvm::Value *OutlinedFn,
+                                  ArrayRef<llvm::Value *> CapturedVars);
+
   /// \brief Emits code for simd call of the \a OutlinedFn with
   /// variables captured in a record which address is stored in \a
   /// CapturedStruct.
@@ -896,13 +896,15 @@ static const Stmt *ignoreCompoundStmts(const Stmt *Body) {
   return Body;
 }
 
+/// check that every CompoundStmt intervening between two constructs holds
+/// just one statement
 static bool onlyOneStmt(const Stmt *Body) {
-  unsigned size = 1;
   while (auto *CS = dyn_cast_or_null<CompoundStmt>(Body)) {
+    if (CS->size() != 1)
+      return false;
     Body = CS->body_front();
-    size = CS->size();
   }
-  return size == 1;
+  return true;
 }
 
 // check for inner (nested) SPMD teams construct, if any
@@ -976,6 +978,36 @@ getNestedTeamsSPMDDirective(const OMPExecutableDirective &D,
   return nullptr;
 }
 
+// check for a 'distribute parallel for' that is the only statement of a
+// 'target teams' region, if any
+static const OMPExecutableDirective *
+getNestedDistributeSPMDDirective(const OMPExecutableDirective &D) {
+  // Privatization and reductions of the teams region are done by the team
+  // master; they must not be executed by every thread of the team.
+  if (D.hasClausesOfKind<OMPPrivateClause>() ||
+      D.hasClausesOfKind<OMPFirstprivateClause>() ||
+      D.hasClausesOfKind<OMPReductionClause>())
+    return nullptr;
+
+  const auto *PCS = cast<CapturedStmt>(D.getAssociatedStmt());
+  if (D.hasClausesOfKind<OMPDependClause>())
+    PCS = cast<CapturedStmt>(PCS->getCapturedStmt());
+
+  // Any code around the nested directive would be a serial region.
+  const Stmt *Body = PCS->getCapturedStmt();
+  if (!onlyOneStmt(Body))
+    return nullptr;
+
+  if (auto *NestedDir = dyn_cast_or_null<OMPExecutableDirective>(
+          ignoreCompoundStmts(Body))) {
+    OpenMPDirectiveKind DirectiveKind = NestedDir->getDirectiveKind();
+    if (isOpenMPDistributeDirective(DirectiveKind) &&
+        isOpenMPParallelDirective(DirectiveKind))
+      return NestedDir;
+  }
+  return nullptr;
+}
+
 static CGOpenMPRuntimeNVPTX::ExecutionMode
 GetExecutionMode(const CodeGenModule &CGM, const OMPExecutableDirective &D) {
   if (CGM.getLangOpts().OpenMPNoSPMD)
@@ -993,6 +1025,11 @@ GetExecutionMode(const CodeGenModule &CGM, const OMPExecutableDirective &D) {
                : CGOpenMPRuntimeNVPTX::ExecutionMode::GENERIC;
   }
   case OMPD_target_teams:
+    // A 'target teams' whose only statement is a 'distribute parallel for'
+    // has no serial region either.
+    return getNestedDistributeSPMDDirective(D)
+               ? CGOpenMPRuntimeNVPTX::ExecutionMode::SPMD
+               : CGOpenMPRuntimeNVPTX::ExecutionMode::GENERIC;
   case OMPD_target_teams_distribute:
   case OMPD_target_teams_distribute_simd:
     return CGOpenMPRuntimeNVPTX::ExecutionMode::GENERIC;
@@ -1019,6 +1056,12 @@ getSPMDDirective(const CodeGenModule &CGM, const OMPExecutableDirective &D) {
     assert(NestedDir && "Failed to find nested teams SPMD directive.");
     return NestedDir;
   }
+  case OMPD_target_teams: {
+    const OMPExecutableDirective *NestedDir =
+        getNestedDistributeSPMDDirective(D);
+    assert(NestedDir && "Failed to find nested distribute SPMD directive.");
+    return NestedDir;
+  }
   case OMPD_target_parallel:
   case OMPD_target_parallel_for:
   case OMPD_target_parallel_for_simd:
@@ -2645,7 +2688,9 @@ void CGOpenMPRuntimeNVPTX::emitForDispatchFinish(CodeGenFunction &CGF,
       (Kind == OMPD_target_teams_distribute_parallel_for ||
        Kind == OMPD_teams_distribute_parallel_for ||
        Kind == OMPD_target_teams_distribute_parallel_for_simd ||
-       Kind == OMPD_teams_distribute_parallel_for_simd))
+       Kind == OMPD_teams_distribute_parallel_for_simd ||
+       Kind == OMPD_distribute_parallel_for ||
+       Kind == OMPD_distribute_parallel_for_simd))
     SyncCTAThreads(CGF);
 }
 
@@ -934,6 +934,70 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S,
   EmitBlock(LoopExit.getBlock(), true);
 }
 
+/// Returns true if \p T is a standard container which keeps its elements in
+/// one array.
+static bool isContiguousStdContainer(QualType T) {
+  const CXXRecordDecl *RD = T->getAsCXXRecordDecl();
+  if (!RD || !RD->getIdentifier() || !RD->getDeclContext()->isStdNamespace())
+    return false;
+  return RD->getName() == "vector" || RD->getName() == "array";
+}
+
+/// Returns true if executing \p S might change the begin or end of the range
+/// of the enclosing range-based for loop.  Without looking into the functions
+/// it calls we can only tell that it does not if it calls none, other than
+/// builtins, const or pure functions and trivial constructors.
+static bool mayModifyRange(const Stmt *S) {
+  if (!S)
+    return false;
+
+  if (const auto *CE = dyn_cast<CallExpr>(S)) {
+    const FunctionDecl *FD = CE->getDirectCallee();
+    if (!FD || (!FD->getBuiltinID() && !FD->hasAttr<ConstAttr>() &&
+                !FD->hasAttr<PureAttr>()))
+      return true;
+  } else if (const auto *CE = dyn_cast<CXXConstructExpr>(S)) {
+    if (!CE->getConstructor()->isTrivial())
+      return true;
+  } else if (const auto *DS = dyn_cast<DeclStmt>(S)) {
+    for (const Decl *D : DS->decls())
+      if (const auto *VD = dyn_cast<VarDecl>(D))
+        if (VD->getType().isDestructedType())
+          return true;
+  } else if (const auto *DAE = dyn_cast<CXXDefaultArgExpr>(S)) {
+    return mayModifyRange(DAE->getExpr());
+  } else if (const auto *DIE = dyn_cast<CXXDefaultInitExpr>(S)) {
+    return mayModifyRange(DIE->getExpr());
+  } else if (isa<CXXNewExpr>(S) || isa<CXXDeleteExpr>(S) ||
+             isa<CXXBindTemporaryExpr>(S) || isa<CXXThrowExpr>(S) ||
+             isa<AsmStmt>(S) || isa<ObjCMessageExpr>(S)) {
+    return true;
+  }
+
+  for (const Stmt *Child : S->children())
+    if (mayModifyRange(Child))
+      return true;
+  return false;
+}
+
+/// Returns true if \p S iterates over an array or a contiguous standard
+/// container which its body cannot modify, so that the loop is worth
+/// vectorizing under -fvectorize-range-for.
+static bool isVectorizableRangeFor(ASTContext &Ctx, const CXXForRangeStmt &S) {
+  // Copying each element must not call a function either.
+  if (!S.getLoopVariable()->getType()->isReferenceType() &&
+      !S.getLoopVariable()->getType().isTriviallyCopyableType(Ctx))
+    return false;
+
+  const auto *RangeVar =
+      cast<VarDecl>(cast<DeclStmt>(S.getRangeStmt())->getSingleDecl());
+  QualType RangeTy = RangeVar->getType().getNonReferenceType();
+  if (!RangeTy->isConstantArrayType() && !isContiguousStdContainer(RangeTy))
+    return false;
+
+  return !mayModifyRange(S.getBody());
+}
+
 void
 CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S,
                                      ArrayRef<const Attr *> ForAttrs) {
@@ -952,6 +1016,13 @@ CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S,
   llvm::BasicBlock *CondBlock = createBasicBlock("for.cond");
   EmitBlock(CondBlock);
 
+  // Explicit loop hints take precedence over -fvectorize-range-for.
+  if (CGM.getCodeGenOpts().VectorizeRangeFor &&
+      llvm::none_of(ForAttrs,
+                    [](const Attr *A) { return isa<LoopHintAttr>(A); }) &&
+      isVectorizableRangeFor(getContext(), S))
+    LoopStack.setVectorizeEnable();
+
   const SourceRange &R = S.getSourceRange();
   LoopStack.push(CondBlock, CGM.getContext(), ForAttrs,
                  SourceLocToDebugLoc(R.getBegin()),
@@ -1391,18 +1391,6 @@ static void emitCommonOMPParallelDirective(CodeGenFunction &CGF,
   auto OutlinedFn = CGF.CGM.getOpenMPRuntime().emitParallelOutlinedFunction(
       S, *CS->getCapturedDecl()->param_begin(), InnermostKind, CodeGen,
       CaptureLevel);
-  if (const auto *NumThreadsClause = S.getSingleClause<OMPNumThreadsClause>()) {
-    CodeGenFunction::RunCleanupsScope NumThreadsScope(CGF);
-    auto NumThreads = CGF.EmitScalarExpr(NumThreadsClause->getNumThreads(),
-                                         /*IgnoreResultAssign*/ true);
-    CGF.CGM.getOpenMPRuntime().emitNumThreadsClause(
-        CGF, NumThreads, NumThreadsClause->getLocStart());
-  }
-  if (const auto *ProcBindClause = S.getSingleClause<OMPProcBindClause>()) {
-    CodeGenFunction::RunCleanupsScope ProcBindScope(CGF);
-    CGF.CGM.getOpenMPRuntime().emitProcBindClause(
-        CGF, ProcBindClause->getProcBindKind(), ProcBindClause->getLocStart());
-  }
   const Expr *IfCond = nullptr;
   for (const auto *C : S.getClausesOfKind<OMPIfClause>()) {
     if (C->getNameModifier() == OMPD_unknown ||
@@ -1411,6 +1399,39 @@ static void emitCommonOMPParallelDirective(CodeGenFunction &CGF,
       break;
     }
   }
+  const auto *NumThreadsClause = S.getSingleClause<OMPNumThreadsClause>();
+  const auto *ProcBindClause = S.getSingleClause<OMPProcBindClause>();
+
+  // A team of one thread is just the encountering thread, so on the host a
+  // region with 'num_threads(1)' is run serialized, without the overhead of
+  // forking, and a number of threads only known at run time is checked before
+  // the fork, which is then the only path pushing it to the runtime. This is
+  // not done if the serialized path would skip an 'if' condition with side
+  // effects or leave a 'proc_bind' clause pushed.
+  llvm::Value *NumThreads = nullptr;
+  llvm::Value *IsSingleThread = nullptr;
+  if (NumThreadsClause) {
+    CodeGenFunction::RunCleanupsScope NumThreadsScope(CGF);
+    NumThreads = CGF.EmitScalarExpr(NumThreadsClause->getNumThreads(),
+                                    /*IgnoreResultAssign*/ true);
+    if (!CGF.getLangOpts().OpenMPIsDevice && !ProcBindClause &&
+        (!IfCond || !IfCond->HasSideEffects(CGF.getContext())))
+      IsSingleThread = CGF.Builder.CreateICmpEQ(
+          CGF.Builder.CreateIntCast(NumThreads, CGF.Int32Ty,
+                                    /*isSigned*/ true),
+          CGF.Builder.getInt32(1));
+    auto *Constant = dyn_cast_or_null<llvm::ConstantInt>(IsSingleThread);
+    if (!IsSingleThread || (Constant && Constant->isZero())) {
+      IsSingleThread = nullptr;
+      CGF.CGM.getOpenMPRuntime().emitNumThreadsClause(
+          CGF, NumThreads, NumThreadsClause->getLocStart());
+    }
+  }
+  if (ProcBindClause) {
+    CodeGenFunction::RunCleanupsScope ProcBindScope(CGF);
+    CGF.CGM.getOpenMPRuntime().emitProcBindClause(
+        CGF, ProcBindClause->getProcBindKind(), ProcBindClause->getLocStart());
+  }
 
   llvm::SmallVector<llvm::Value *, 16> CapturedVars;
 
@@ -1433,8 +1454,38 @@ static void emitCommonOMPParallelDirective(CodeGenFunction &CGF,
     CapturedVars.push_back(UBCast);
   }
   CGF.GenerateOpenMPCapturedVars(*CS, CapturedVars, CaptureLevel);
-  CGF.CGM.getOpenMPRuntime().emitParallelCall(CGF, S.getLocStart(), OutlinedFn,
-                                              CapturedVars, IfCond);
+  if (!IsSingleThread) {
+    CGF.CGM.getOpenMPRuntime().emitParallelCall(CGF, S.getLocStart(),
+                                                OutlinedFn, CapturedVars,
+                                                IfCond);
+    return;
+  }
+
+  auto &&ParallelGen = [&](CodeGenFunction &CGF) {
+    CGF.CGM.getOpenMPRuntime().emitNumThreadsClause(
+        CGF, NumThreads, NumThreadsClause->getLocStart());
+    CGF.CGM.getOpenMPRuntime().emitParallelCall(CGF, S.getLocStart(),
+                                                OutlinedFn, CapturedVars,
+                                                IfCond);
+  };
+  auto &&SerialGen = [&](CodeGenFunction &CGF) {
+    CGF.CGM.getOpenMPRuntime().emitSerializedParallelCall(
+        CGF, S.getLocStart(), OutlinedFn, CapturedVars);
+  };
+  if (isa<llvm::Constant>(IsSingleThread)) {
+    SerialGen(CGF);
+    return;
+  }
+  auto *SerialBlock = CGF.createBasicBlock("omp.serial");
+  auto *ParallelBlock = CGF.createBasicBlock("omp.fork");
+  auto *ContBlock = CGF.createBasicBlock("omp.fork.end");
+  CGF.Builder.CreateCondBr(IsSingleThread, SerialBlock, ParallelBlock);
+  CGF.EmitBlock(SerialBlock);
+  SerialGen(CGF);
+  CGF.EmitBranch(ContBlock);
+  CGF.EmitBlock(ParallelBlock);
+  ParallelGen(CGF);
+  CGF.EmitBlock(ContBlock, /*IsFinished=*/true);
 }
 
 void CodeGenFunction::EmitOMPParallelDirective(const OMPParallelDirective &S) {
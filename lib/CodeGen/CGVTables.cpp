@@ -20,6 +20,8 @@
 #include "clang/AST/RecordLayout.h"
 #include "clang/CodeGen/CGFunctionInfo.h"
 #include "clang/Frontend/CodeGenOptions.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include <algorithm>
@@ -526,17 +528,109 @@ void CodeGenVTables::EmitThunks(GlobalDecl GD)
     emitThunk(GD, Thunk, /*ForVTable=*/false);
 }
 
+bool CodeGenVTables::useRelativeLayout() const {
+  return CGM.getLangOpts().RelativeCXXABIVTables;
+}
+
+llvm::Type *CodeGenVTables::getVTableComponentType() const {
+  return useRelativeLayout() ? CGM.Int32Ty : CGM.Int8PtrTy;
+}
+
+llvm::Constant *
+CodeGenVTables::getRelativeOffset(llvm::Constant *target,
+                                  llvm::Constant *addressPoint) {
+  llvm::Constant *offset = llvm::ConstantExpr::getSub(
+      llvm::ConstantExpr::getPtrToInt(target, CGM.PtrDiffTy),
+      llvm::ConstantExpr::getPtrToInt(addressPoint, CGM.PtrDiffTy));
+  return llvm::ConstantExpr::getTruncOrBitCast(offset, CGM.Int32Ty);
+}
+
+llvm::GlobalValue *
+CodeGenVTables::getRelativeTarget(llvm::GlobalValue *target) {
+  if (target->hasLocalLinkage() || !target->hasDefaultVisibility())
+    return target;
+
+  SmallString<256> name(target->getName());
+  name += ".stub";
+  if (llvm::Function *stub = CGM.getModule().getFunction(name))
+    return stub;
+
+  auto *fnTy = cast<llvm::FunctionType>(target->getValueType());
+  llvm::Function *stub =
+      llvm::Function::Create(fnTy, llvm::GlobalValue::LinkOnceODRLinkage,
+                             name, &CGM.getModule());
+  stub->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  stub->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  if (CGM.supportsCOMDAT())
+    stub->setComdat(CGM.getModule().getOrInsertComdat(name));
+  if (auto *fn = dyn_cast<llvm::Function>(target)) {
+    stub->setAttributes(fn->getAttributes());
+    stub->setCallingConv(fn->getCallingConv());
+  }
+
+  CGBuilderTy builder(CGM, llvm::BasicBlock::Create(CGM.getLLVMContext(),
+                                                    "entry", stub));
+  SmallVector<llvm::Value *, 8> args;
+  for (llvm::Argument &arg : stub->args())
+    args.push_back(&arg);
+  llvm::CallInst *call = builder.CreateCall(fnTy, target, args);
+  call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+  call->setAttributes(stub->getAttributes());
+  call->setCallingConv(stub->getCallingConv());
+  if (fnTy->getReturnType()->isVoidTy())
+    builder.CreateRetVoid();
+  else
+    builder.CreateRet(call);
+  return stub;
+}
+
+llvm::Constant *CodeGenVTables::getOrCreateRTTIProxy(llvm::Constant *rtti) {
+  auto *rttiGV = cast<llvm::GlobalValue>(rtti->stripPointerCasts());
+  SmallString<256> name(rttiGV->getName());
+  name += ".rtti_proxy";
+  if (llvm::GlobalVariable *proxy = CGM.getModule().getNamedGlobal(name))
+    return proxy;
+
+  // The proxy of a local type info must not be merged with the proxies of
+  // other translation units.
+  bool isLocal = rttiGV->hasLocalLinkage();
+  auto *proxy = new llvm::GlobalVariable(
+      CGM.getModule(), rtti->getType(), /*isConstant=*/true,
+      isLocal ? llvm::GlobalValue::InternalLinkage
+              : llvm::GlobalValue::LinkOnceODRLinkage,
+      rtti, name);
+  proxy->setAlignment(CGM.getPointerAlign().getQuantity());
+  proxy->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  if (!isLocal) {
+    proxy->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    if (CGM.supportsCOMDAT())
+      proxy->setComdat(CGM.getModule().getOrInsertComdat(name));
+  }
+  return proxy;
+}
+
 void CodeGenVTables::addVTableComponent(
     ConstantArrayBuilder &builder, const VTableLayout &layout,
-    unsigned idx, llvm::Constant *rtti, unsigned &nextVTableThunkIndex) {
+    unsigned idx, llvm::Constant *rtti, unsigned &nextVTableThunkIndex,
+    llvm::Constant *addressPoint) {
   auto &component = layout.vtable_components()[idx];
+  bool relative = useRelativeLayout();
 
   auto addOffsetConstant = [&](CharUnits offset) {
+    if (relative)
+      return builder.add(llvm::ConstantInt::get(
+          CGM.Int32Ty, offset.getQuantity(), /*isSigned=*/true));
     builder.add(llvm::ConstantExpr::getIntToPtr(
         llvm::ConstantInt::get(CGM.PtrDiffTy, offset.getQuantity()),
         CGM.Int8PtrTy));
   };
 
+  auto addNull = [&] {
+    if (relative)
+      return builder.add(llvm::ConstantInt::get(CGM.Int32Ty, 0));
+    builder.addNullPointer(CGM.Int8PtrTy);
+  };
+
   switch (component.getKind()) {
   case VTableComponent::CK_VCallOffset:
     return addOffsetConstant(component.getVCallOffset());
@@ -548,6 +642,12 @@ void CodeGenVTables::addVTableComponent(
     return addOffsetConstant(component.getOffsetToTop());
 
   case VTableComponent::CK_RTTI:
+    if (relative) {
+      if (rtti->isNullValue())
+        return addNull();
+      return builder.add(
+          getRelativeOffset(getOrCreateRTTIProxy(rtti), addressPoint));
+    }
     return builder.add(llvm::ConstantExpr::getBitCast(rtti, CGM.Int8PtrTy));
 
   case VTableComponent::CK_FunctionPointer:
@@ -582,13 +682,13 @@ void CodeGenVTables::addVTableComponent(
               ? MD->hasAttr<CUDADeviceAttr>()
               : (MD->hasAttr<CUDAHostAttr>() || !MD->hasAttr<CUDADeviceAttr>());
       if (!CanEmitMethod)
-        return builder.addNullPointer(CGM.Int8PtrTy);
+        return addNull();
       // Method is acceptable, continue processing as usual.
     }
 
     // If this is OpenMP target, check if it is legal to emit these methods.
     if (CGM.getLangOpts().OpenMP && CGM.getOpenMPRuntime().emitTargetGlobal(GD))
-      return builder.addNullPointer(CGM.Int8PtrTy);
+      return addNull();
 
     auto getSpecialVirtualFn = [&](StringRef name) {
       llvm::FunctionType *fnTy =
@@ -630,13 +730,19 @@ void CodeGenVTables::addVTableComponent(
       fnPtr = CGM.GetAddrOfFunction(GD, fnTy, /*ForVTable=*/true);
     }
 
+    if (relative) {
+      auto *target = cast<llvm::GlobalValue>(fnPtr->stripPointerCasts());
+      return builder.add(
+          getRelativeOffset(getRelativeTarget(target), addressPoint));
+    }
+
     fnPtr = llvm::ConstantExpr::getBitCast(fnPtr, CGM.Int8PtrTy);
     builder.add(fnPtr);
     return;
   }
 
   case VTableComponent::CK_UnusedFunctionPointer:
-    return builder.addNullPointer(CGM.Int8PtrTy);
+    return addNull();
   }
 
   llvm_unreachable("Unexpected vtable component kind");
@@ -645,7 +751,8 @@ void CodeGenVTables::addVTableComponent(
 llvm::Type *CodeGenVTables::getVTableType(const VTableLayout &layout) {
   SmallVector<llvm::Type *, 4> tys;
   for (unsigned i = 0, e = layout.getNumVTables(); i != e; ++i) {
-    tys.push_back(llvm::ArrayType::get(CGM.Int8PtrTy, layout.getVTableSize(i)));
+    tys.push_back(llvm::ArrayType::get(getVTableComponentType(),
+                                       layout.getVTableSize(i)));
   }
 
   return llvm::StructType::get(CGM.getLLVMContext(), tys);
@@ -654,13 +761,26 @@ llvm::Type *CodeGenVTables::getVTableType(const VTableLayout &layout) {
 void CodeGenVTables::createVTableInitializer(ConstantStructBuilder &builder,
                                              const VTableLayout &layout,
                                              llvm::Constant *rtti) {
+  // The relative components of each vtable are offsets from its address
+  // point.
+  SmallVector<unsigned, 4> addressPointIndices(layout.getNumVTables());
+  for (const auto &addressPoint : layout.getAddressPoints())
+    addressPointIndices[addressPoint.second.VTableIndex] =
+        addressPoint.second.AddressPointIndex;
+
   unsigned nextVTableThunkIndex = 0;
   for (unsigned i = 0, e = layout.getNumVTables(); i != e; ++i) {
-    auto vtableElem = builder.beginArray(CGM.Int8PtrTy);
+    auto vtableElem = builder.beginArray(getVTableComponentType());
+    llvm::Constant *addressPoint = nullptr;
+    if (useRelativeLayout())
+      addressPoint = llvm::ConstantExpr::getInBoundsGetElementPtr(
+          CGM.Int32Ty, vtableElem.getAddrOfCurrentPosition(CGM.Int32Ty),
+          llvm::ConstantInt::get(CGM.Int32Ty, addressPointIndices[i]));
     size_t thisIndex = layout.getVTableOffset(i);
     size_t nextIndex = thisIndex + layout.getVTableSize(i);
     for (unsigned i = thisIndex; i != nextIndex; ++i) {
-      addVTableComponent(vtableElem, layout, i, rtti, nextVTableThunkIndex);
+      addVTableComponent(vtableElem, layout, i, rtti, nextVTableThunkIndex,
+                         addressPoint);
     }
     vtableElem.finishAndAddTo(builder);
   }
@@ -911,6 +1031,135 @@ void CodeGenModule::EmitDeferredVTables() {
   DeferredVTables.clear();
 }
 
+namespace {
+/// Why a virtual call can't be devirtualized, in the order of the
+/// alternatives of remark_cxx_vcall_not_devirtualized.
+enum DevirtualizationFailure {
+  DF_ExternalClass,
+  DF_SeveralImplementations,
+  DF_NoImplementation,
+  DF_ComplexBasePath,
+  DF_CovariantReturn,
+  DF_NotDefined
+};
+
+struct DevirtualizationResult {
+  const CXXMethodDecl *Target;
+  DevirtualizationFailure Failure;
+};
+} // end anonymous namespace
+
+/// Returns the offset of the \p Base subobject of \p Derived, or None if
+/// \p Derived doesn't hold exactly one \p Base subobject or reaches it
+/// through a virtual base.
+static Optional<CharUnits>
+getUniqueNonVirtualBaseOffset(ASTContext &Context,
+                              const CXXRecordDecl *Derived,
+                              const CXXRecordDecl *Base) {
+  if (Derived->getCanonicalDecl() == Base->getCanonicalDecl())
+    return CharUnits::Zero();
+
+  CXXBasePaths Paths(/*FindAmbiguities=*/true, /*RecordPaths=*/true,
+                     /*DetectVirtual=*/true);
+  if (!Derived->isDerivedFrom(Base, Paths) || Paths.getDetectedVirtual() ||
+      Paths.isAmbiguous(Context.getCanonicalType(Context.getRecordType(Base))))
+    return None;
+
+  CharUnits Offset = CharUnits::Zero();
+  for (const CXXBasePathElement &Element : Paths.front())
+    Offset += Context.getASTRecordLayout(Element.Class)
+                  .getBaseClassOffset(
+                      Element.Base->getType()->getAsCXXRecordDecl());
+  return Offset;
+}
+
+/// Find the single implementation of \p MD which a virtual call on an
+/// object of its class can reach. This is only possible when the class is
+/// local to the translation unit, so that every class derived from it is
+/// one of \p Classes.
+static DevirtualizationResult
+findSingleImplementation(ASTContext &Context, const CXXMethodDecl *MD,
+                         ArrayRef<const CXXRecordDecl *> Classes) {
+  const CXXRecordDecl *RD = MD->getParent();
+  if (RD->isExternallyVisible() || RD->isFromASTFile())
+    return {nullptr, DF_ExternalClass};
+
+  const CXXMethodDecl *Target = nullptr;
+  for (const CXXRecordDecl *Class : Classes) {
+    if (Class->getCanonicalDecl() != RD->getCanonicalDecl() &&
+        !Class->isDerivedFrom(RD))
+      continue;
+    // Abstract classes count as well: they are the dynamic type of the
+    // object while their constructor and destructor run.
+    if (!getUniqueNonVirtualBaseOffset(Context, Class, RD))
+      return {nullptr, DF_ComplexBasePath};
+    const CXXMethodDecl *Overrider = MD->getCorrespondingMethodInClass(Class);
+    if (!Overrider)
+      return {nullptr, DF_ComplexBasePath};
+    // Calling a pure virtual function is undefined.
+    if (Overrider->isPure())
+      continue;
+    if (Target && Target->getCanonicalDecl() != Overrider->getCanonicalDecl())
+      return {nullptr, DF_SeveralImplementations};
+    Target = Overrider;
+  }
+
+  if (!Target)
+    return {nullptr, DF_NoImplementation};
+  if (Target->getReturnType().getCanonicalType() !=
+      MD->getReturnType().getCanonicalType())
+    return {nullptr, DF_CovariantReturn};
+  // The call passes a pointer to the RD subobject as 'this'.
+  Optional<CharUnits> Offset =
+      getUniqueNonVirtualBaseOffset(Context, Target->getParent(), RD);
+  if (!Offset || !Offset->isZero())
+    return {nullptr, DF_ComplexBasePath};
+  if (!Target->isDefined())
+    return {nullptr, DF_NotDefined};
+  return {Target, DF_ExternalClass};
+}
+
+void CodeGenModule::devirtualizeInternalVCalls() {
+  std::vector<InternalVCall> VCalls;
+  VCalls.swap(InternalVCalls);
+
+  llvm::DenseMap<const CXXMethodDecl *, DevirtualizationResult> Results;
+  for (const InternalVCall &VCall : VCalls) {
+    // The function holding the call may have been erased.
+    llvm::Value *VFunc = VCall.VFunc;
+    if (!VFunc)
+      continue;
+
+    const auto *MD = cast<CXXMethodDecl>(VCall.GD.getDecl());
+    auto It = Results.find(MD);
+    if (It == Results.end())
+      It = Results
+               .insert(std::make_pair(
+                   MD, findSingleImplementation(Context, MD, DynamicClasses)))
+               .first;
+    const DevirtualizationResult &Result = It->second;
+    if (!Result.Target) {
+      if (VCall.Loc.isValid())
+        getDiags().Report(VCall.Loc, diag::remark_cxx_vcall_not_devirtualized)
+            << MD << Result.Failure;
+      continue;
+    }
+
+    GlobalDecl TargetGD(Result.Target);
+    if (const auto *Dtor = dyn_cast<CXXDestructorDecl>(Result.Target))
+      TargetGD = GlobalDecl(Dtor, VCall.GD.getDtorType());
+    llvm::Constant *Fn = GetAddrOfFunction(
+        TargetGD, VFunc->getType()->getPointerElementType());
+    VFunc->replaceAllUsesWith(
+        llvm::ConstantExpr::getBitCast(Fn, VFunc->getType()));
+    cast<llvm::Instruction>(VFunc)->eraseFromParent();
+
+    if (VCall.Loc.isValid())
+      getDiags().Report(VCall.Loc, diag::remark_cxx_vcall_devirtualized)
+          << MD << 3;
+  }
+}
+
 bool CodeGenModule::HasHiddenLTOVisibility(const CXXRecordDecl *RD) {
   LinkageInfo LV = RD->getLinkageAndVisibility();
   if (!isExternallyVisible(LV.getLinkage()))
@@ -950,8 +1199,11 @@ void CodeGenModule::EmitVTableTypeMetadata(llvm::GlobalVariable *VTable,
   if (!getCodeGenOpts().PrepareForLTO)
     return;
 
-  CharUnits PointerWidth =
-      Context.toCharUnitsFromBits(Context.getTargetInfo().getPointerWidth(0));
+  CharUnits ComponentWidth =
+      getVTables().useRelativeLayout()
+          ? CharUnits::fromQuantity(4)
+          : Context.toCharUnitsFromBits(
+                Context.getTargetInfo().getPointerWidth(0));
 
   typedef std::pair<const CXXRecordDecl *, unsigned> BSEntry;
   std::vector<BSEntry> BitsetEntries;
@@ -989,6 +1241,6 @@ void CodeGenModule::EmitVTableTypeMetadata(llvm::GlobalVariable *VTable,
   });
 
   for (auto BitsetEntry : BitsetEntries)
-    AddVTableTypeMetadata(VTable, PointerWidth * BitsetEntry.second,
+    AddVTableTypeMetadata(VTable, ComponentWidth * BitsetEntry.second,
                           BitsetEntry.first);
 }
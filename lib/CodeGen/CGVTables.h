@@ -67,7 +67,23 @@ class CodeGenVTables {
   void addVTableComponent(ConstantArrayBuilder &builder,
                           const VTableLayout &layout, unsigned idx,
                           llvm::Constant *rtti,
-                          unsigned &nextVTableThunkIndex);
+                          unsigned &nextVTableThunkIndex,
+                          llvm::Constant *addressPoint);
+
+  /// Returns the 32-bit offset of \p target from \p addressPoint, for a
+  /// component of a relative vtable.
+  llvm::Constant *getRelativeOffset(llvm::Constant *target,
+                                    llvm::Constant *addressPoint);
+
+  /// Returns the function a relative vtable refers to for \p target.  An
+  /// offset to a function which may be preempted, or defined in another
+  /// shared object, cannot be resolved at link time, so it refers to a local
+  /// stub tail-calling the function instead.
+  llvm::GlobalValue *getRelativeTarget(llvm::GlobalValue *target);
+
+  /// Returns the local variable holding the address of \p rtti, to which
+  /// the RTTI component of a relative vtable refers.
+  llvm::Constant *getOrCreateRTTIProxy(llvm::Constant *rtti);
 
 public:
   /// Add vtable components for the given vtable layout to the given
@@ -127,6 +143,15 @@ public:
   /// arrays of pointers, with one struct element for each vtable in the vtable
   /// group.
   llvm::Type *getVTableType(const VTableLayout &layout);
+
+  /// Returns true if vtables use the layout of
+  /// -fexperimental-relative-c++-abi-vtables, in which every component is a
+  /// 32-bit integer, and functions and RTTI are referred to by their offset
+  /// from the address point of the vtable.
+  bool useRelativeLayout() const;
+
+  /// Returns the type of the components of a vtable.
+  llvm::Type *getVTableComponentType() const;
 };
 
 } // end namespace CodeGen
@@ -158,6 +158,8 @@ namespace clang {
         HandleTopLevelDecl(D);
     }
 
+    void PrintStats() override { Gen->PrintStats(); }
+
     void HandleTranslationUnit(ASTContext &C) override {
       {
         PrettyStackTraceString CrashInfo("Per-file LLVM IR generation");
@@ -329,6 +329,10 @@ public:
   /// finally block or filter expression.
   bool IsOutlinedSEHHelper;
 
+  /// True while emitting the EH copy of a cleanup under
+  /// -foutline-eh-cleanups.
+  bool IsOutlinedEHCleanup;
+
   const CodeGen::CGBlockInfo *BlockInfo;
   llvm::Value *BlockPointer;
 
@@ -1375,6 +1379,14 @@ public:
     return CGM.getCodeGenOpts().OptimizationLevel == 0;
   }
 
+  /// Retrieves the cleanup kind for the lifetime.end of a local.  Under
+  /// -fshare-landing-pads, lifetimes are only ended on normal exits, so that
+  /// trivially-destructible locals don't give each invoke its own landing pad.
+  CleanupKind getLifetimeMarkerCleanupKind() const {
+    return CGM.getCodeGenOpts().ShareLandingPads ? NormalLifetimeMarker
+                                                 : NormalEHLifetimeMarker;
+  }
+
   const LangOptions &getLangOpts() const { return CGM.getLangOpts(); }
 
   /// Returns a pointer to the function's exception object and selector slot,
@@ -41,6 +41,7 @@
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Sema/SemaDiagnostic.h"
@@ -441,6 +442,22 @@ void CodeGenModule::clear() {
     OpenMPRuntime->clear();
 }
 
+void CodeGenModule::PrintStats() const {
+  unsigned NumFunctions = 0;
+  for (const auto &I : DeferredDecls)
+    if (isa<FunctionDecl>(I.second.getDecl()))
+      ++NumFunctions;
+
+  llvm::errs() << "\n*** CodeGen Stats:\n";
+  llvm::errs() << NumDeferredDeclsEmitted
+               << " deferred declarations emitted once referenced.\n";
+  llvm::errs() << DeferredDecls.size() - NumFunctions
+               << " deferred variables never emitted.\n";
+  llvm::errs() << NumFunctions << " deferred functions never emitted.\n";
+  llvm::errs() << Types.getNumTypeCacheFlushes()
+               << " LLVM type cache flushes.\n";
+}
+
 void InstrProfStats::reportDiagnostics(DiagnosticsEngine &Diags,
                                        StringRef MainFile) {
   if (!hasDiagnostics())
@@ -456,6 +473,12 @@ void InstrProfStats::reportDiagnostics(DiagnosticsEngine &Diags,
 
 void CodeGenModule::Release() {
   EmitDeferred();
+  // Resolving a virtual call can reference a deferred function, whose body
+  // can hold more virtual calls.
+  while (!InternalVCalls.empty()) {
+    devirtualizeInternalVCalls();
+    EmitDeferred();
+  }
   applyGlobalValReplacements();
   applyReplacements();
   checkAliases();
@@ -590,6 +613,11 @@ void CodeGenModule::Release() {
 void CodeGenModule::UpdateCompletedType(const TagDecl *TD) {
   // Make sure that this type is translated.
   Types.UpdateCompletedType(TD);
+
+  if (CodeGenOpts.DevirtualizeInternalClasses)
+    if (const auto *RD = dyn_cast<CXXRecordDecl>(TD))
+      if (RD->isDynamicClass() && !RD->isDependentContext())
+        DynamicClasses.push_back(RD);
 }
 
 void CodeGenModule::RefreshTypeCacheForClass(const CXXRecordDecl *RD) {
@@ -1530,9 +1558,8 @@ bool CodeGenModule::isInSanitizerBlacklist(llvm::Function *Fn,
   // If location is unknown, this may be a compiler-generated function. Assume
   // it's located in the main file.
   auto &SM = Context.getSourceManager();
-  if (const auto *MainFile = SM.getFileEntryForID(SM.getMainFileID())) {
-    return SanitizerBL.isBlacklistedFile(MainFile->getName());
-  }
+  if (SM.getFileEntryForID(SM.getMainFileID()))
+    return SanitizerBL.isBlacklistedFileID(SM.getMainFileID());
   return false;
 }
 
@@ -1665,6 +1692,9 @@ ConstantAddress CodeGenModule::GetWeakRefReference(const ValueDecl *VD) {
 
 void CodeGenModule::EmitGlobal(GlobalDecl GD) {
   const auto *Global = cast<ValueDecl>(GD.getDecl());
+  TimeTraceScope TimeScope("EmitGlobal", [&] {
+    return Global->getQualifiedNameAsString();
+  });
 
   // Weak references don't produce any output by themselves.
   if (Global->hasAttr<WeakRefAttr>())
@@ -1955,6 +1985,9 @@ void CodeGenModule::CompleteDIClassType(const CXXMethodDecl* D) {
 
 void CodeGenModule::EmitGlobalDefinition(GlobalDecl GD, llvm::GlobalValue *GV) {
   const auto *D = cast<ValueDecl>(GD.getDecl());
+  TimeTraceScope TimeScope("EmitGlobalDefinition", [&] {
+    return D->getQualifiedNameAsString();
+  });
 
   PrettyStackTraceDecl CrashInfo(const_cast<ValueDecl *>(D), D->getLocation(), 
                                  Context.getSourceManager(),
@@ -2139,6 +2172,7 @@ CodeGenModule::GetOrCreateLLVMFunction(StringRef MangledName,
       // don't need it anymore).
       addDeferredDeclToEmit(F, DDI->second);
       DeferredDecls.erase(DDI);
+      ++NumDeferredDeclsEmitted;
 
       // Otherwise, there are cases we have to worry about where we're
       // using a declaration for which we must emit a definition but where
@@ -2388,6 +2422,7 @@ CodeGenModule::GetOrCreateLLVMGlobal(StringRef MangledName,
     // list, and remove it from DeferredDecls (since we don't need it anymore).
     addDeferredDeclToEmit(GV, DDI->second);
     DeferredDecls.erase(DDI);
+    ++NumDeferredDeclsEmitted;
   }
 
   // Handle things which are present even on external declarations.
@@ -312,6 +312,10 @@ private:
   /// yet.
   std::map<StringRef, GlobalDecl> DeferredDecls;
 
+  /// The number of deferred decls which were emitted after all, because they
+  /// turned out to be referenced.
+  unsigned NumDeferredDeclsEmitted = 0;
+
   /// This is a list of deferred decls which we have seen that *are* actually
   /// referenced. These get code generated when the module is done.
   struct DeferredGlobal {
@@ -345,6 +349,20 @@ private:
   /// A queue of (optional) vtables to consider emitting.
   std::vector<const CXXRecordDecl*> DeferredVTables;
 
+  /// A virtual call whose callee is resolved once every class of the
+  /// translation unit is known, for -fdevirtualize-internal-classes.
+  struct InternalVCall {
+    GlobalDecl GD;
+    /// The function pointer loaded from the vtable.
+    llvm::WeakVH VFunc;
+    SourceLocation Loc;
+  };
+  std::vector<InternalVCall> InternalVCalls;
+
+  /// The dynamic classes defined in the translation unit, for
+  /// -fdevirtualize-internal-classes.
+  std::vector<const CXXRecordDecl *> DynamicClasses;
+
   /// List of global values which are required to be present in the object file;
   /// bitcast to i8*. This is used for forcing visibility of symbols which may
   /// otherwise be optimized out.
@@ -514,6 +532,10 @@ public:
   /// Finalize LLVM code generation.
   void Release();
 
+  /// Print statistics about the declarations whose emission was deferred, and
+  /// how many of them were never emitted.
+  void PrintStats() const;
+
   /// Return a reference to the configured Objective-C runtime.
   CGObjCRuntime &getObjCRuntime() {
     if (!ObjCRuntime) createObjCRuntime();
@@ -1111,6 +1133,13 @@ public:
     DeferredVTables.push_back(RD);
   }
 
+  /// Note a virtual call to \p GD through the function pointer \p VFunc, to
+  /// be turned into a direct call if the translation unit turns out to hold
+  /// a single implementation of the function.
+  void addInternalVCall(GlobalDecl GD, llvm::Value *VFunc, SourceLocation Loc) {
+    InternalVCalls.push_back({GD, VFunc, Loc});
+  }
+
   /// Emit code for a singal global function or var decl. Forward declarations
   /// are emitted lazily.
   void EmitGlobal(GlobalDecl D);
@@ -1239,6 +1268,12 @@ private:
                                     llvm::GlobalVariable *Addr,
                                     bool PerformInit);
 
+  /// Emit a remark for the function \p Fn which dynamically initializes \p D
+  /// or registers its destructor, with its size and with the reason the
+  /// initializer couldn't be emitted as a constant.
+  void reportDynamicInitializer(const VarDecl *D, llvm::Function *Fn,
+                                bool PerformInit);
+
   void EmitPointerToInitFunc(const VarDecl *VD, llvm::GlobalVariable *Addr,
                              llvm::Function *InitFunc, InitSegAttr *ISA);
 
@@ -1266,6 +1301,10 @@ private:
   /// Emit any vtables which we deferred and still have a use for.
   void EmitDeferredVTables();
 
+  /// Turn the virtual calls noted by addInternalVCall into direct calls
+  /// where the classes of the translation unit allow it.
+  void devirtualizeInternalVCalls();
+
   /// Emit the llvm.used and llvm.compiler.used metadata.
   void emitLLVMUsed();
 
@@ -99,6 +99,16 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
   if (TypeHasMayAlias(QTy))
     return getChar();
 
+  // Accesses to arrays and extended vectors are accesses to objects of their
+  // element types.  Other vector types are left in the char alias class, as
+  // the intrinsic headers use them to access memory of any type.
+  if (CodeGenOpts.PreciseStructPathTBAA) {
+    if (const ArrayType *ATy = Context.getAsArrayType(QTy))
+      return getTBAAInfo(ATy->getElementType());
+    if (const ExtVectorType *VTy = QTy->getAs<ExtVectorType>())
+      return getTBAAInfo(VTy->getElementType());
+  }
+
   const Type *Ty = Context.getCanonicalType(QTy).getTypePtr();
 
   if (llvm::MDNode *N = MetadataCache[Ty])
@@ -162,10 +172,34 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
     return MetadataCache[Ty] = createTBAAScalarType(OutName, getChar());
   }
 
+  // A union whose members all have the same type is accessed as that type.
+  // Computing it may grow MetadataCache, so only index it afterwards.
+  if (CodeGenOpts.PreciseStructPathTBAA)
+    if (const RecordType *RTy = dyn_cast<RecordType>(Ty))
+      if (RTy->getDecl()->isUnion()) {
+        llvm::MDNode *N = getTBAAUnionInfo(RTy->getDecl());
+        return MetadataCache[Ty] = N;
+      }
+
   // For now, handle any other kind of type conservatively.
   return MetadataCache[Ty] = getChar();
 }
 
+llvm::MDNode *CodeGenTBAA::getTBAAUnionInfo(const RecordDecl *RD) {
+  RD = RD->getDefinition();
+  if (!RD)
+    return getChar();
+
+  llvm::MDNode *Common = nullptr;
+  for (const FieldDecl *FD : RD->fields()) {
+    llvm::MDNode *FieldNode = getTBAAInfo(FD->getType());
+    if (Common && FieldNode != Common)
+      return getChar();
+    Common = FieldNode;
+  }
+  return Common ? Common : getChar();
+}
+
 llvm::MDNode *CodeGenTBAA::getTBAAInfoForVTablePtr() {
   return createTBAAScalarType("vtable pointer", getRoot());
 }
@@ -258,6 +292,12 @@ CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
     for (RecordDecl::field_iterator i = RD->field_begin(),
          e = RD->field_end(); i != e; ++i, ++idx) {
       QualType FieldQTy = i->getType();
+      // Elements of an array member are accessed with the offset of its
+      // first element.
+      if (CodeGenOpts.PreciseStructPathTBAA && !TypeHasMayAlias(FieldQTy))
+        while (const ConstantArrayType *ATy =
+                   Context.getAsConstantArrayType(FieldQTy))
+          FieldQTy = ATy->getElementType();
       llvm::MDNode *FieldNode;
       if (isTBAAPathStruct(FieldQTy))
         FieldNode = getTBAAStructTypeInfo(FieldQTy);
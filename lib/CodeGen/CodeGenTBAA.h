@@ -83,6 +83,10 @@ class CodeGenTBAA {
                      SmallVectorImpl<llvm::MDBuilder::TBAAStructField> &Fields,
                      bool MayAlias);
 
+  /// getTBAAUnionInfo - Get the TBAA MDNode shared by all the members of the
+  /// given union, or the char node if they differ.
+  llvm::MDNode *getTBAAUnionInfo(const RecordDecl *RD);
+
   /// A wrapper function to create a scalar type. For struct-path aware TBAA,
   /// the scalar type has the same format as the struct type: name, offset,
   /// pointer to another node in the type DAG.
@@ -26,6 +26,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/SaveAndRestore.h"
 using namespace clang;
 using namespace CodeGen;
 
@@ -247,7 +248,7 @@ void CodeGenTypes::UpdateCompletedType(const TagDecl *TD) {
       // would be lowered to i32, so we only need to flush the cache if this
       // didn't happen.
       if (!ConvertType(ED->getIntegerType())->isIntegerTy(32))
-        TypeCache.clear();
+        flushTypeCache();
     }
     // If necessary, provide the full definition of a type only used with a
     // declaration so far.
@@ -272,13 +273,31 @@ void CodeGenTypes::UpdateCompletedType(const TagDecl *TD) {
     DI->completeType(RD);
 }
 
+void CodeGenTypes::flushTypeCache() {
+  TypeCache.clear();
+  ++NumTypeCacheFlushes;
+}
+
+void CodeGenTypes::flushTypeCacheIfSkippedLayout() {
+  if (!SkippedLayout)
+    return;
+  flushTypeCache();
+
+  // Once nothing that might still cache a type built from a placeholder is
+  // being converted, the flush has removed every such type, so later
+  // conversions need not flush again unless they skip a layout themselves.
+  if (!NumConversionsInProgress && RecordsBeingLaidOut.empty() &&
+      FunctionsBeingProcessed.empty())
+    SkippedLayout = false;
+}
+
 void CodeGenTypes::RefreshTypeCacheForClass(const CXXRecordDecl *RD) {
   QualType T = Context.getRecordType(RD);
   T = Context.getCanonicalType(T);
 
   const Type *Ty = T.getTypePtr();
   if (RecordsWithOpaqueMemberPointers.count(Ty)) {
-    TypeCache.clear();
+    flushTypeCache();
     RecordsWithOpaqueMemberPointers.clear();
   }
 }
@@ -366,8 +385,7 @@ llvm::Type *CodeGenTypes::ConvertFunctionType(QualType QFT,
 
   RecordsBeingLaidOut.erase(Ty);
 
-  if (SkippedLayout)
-    TypeCache.clear();
+  flushTypeCacheIfSkippedLayout();
 
   if (RecordsBeingLaidOut.empty())
     while (!DeferredRecords.empty())
@@ -391,7 +409,10 @@ llvm::Type *CodeGenTypes::ConvertType(QualType T) {
   if (TCI != TypeCache.end())
     return TCI->second;
 
-  // If we don't have it in the cache, convert it now.
+  // If we don't have it in the cache, convert it now.  Until this returns, a
+  // type built from a placeholder may still be added to the cache.
+  llvm::SaveAndRestore<unsigned> InProgress(NumConversionsInProgress,
+                                            NumConversionsInProgress + 1);
   llvm::Type *ResultType = nullptr;
   switch (Ty->getTypeClass()) {
   case Type::Record: // Handled above.
@@ -706,8 +727,7 @@ llvm::StructType *CodeGenTypes::ConvertRecordDeclType(const RecordDecl *RD) {
   // If this struct blocked a FunctionType conversion, then recompute whatever
   // was derived from that.
   // FIXME: This is hugely overconservative.
-  if (SkippedLayout)
-    TypeCache.clear();
+  flushTypeCacheIfSkippedLayout();
     
   // If we're done converting the outer-most record, then convert any deferred
   // structs as well.
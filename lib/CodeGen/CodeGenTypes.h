@@ -156,6 +156,13 @@ class CodeGenTypes {
   /// a recursive struct conversion, set this to true.
   bool SkippedLayout;
 
+  /// The number of ConvertType calls currently converting a type that was
+  /// not in the type cache.
+  unsigned NumConversionsInProgress = 0;
+
+  /// The number of times the type cache has been cleared.
+  unsigned NumTypeCacheFlushes = 0;
+
   SmallVector<const RecordDecl *, 8> DeferredRecords;
   
   /// This map keeps cache of llvm::Types and maps clang::Type to
@@ -166,6 +173,13 @@ class CodeGenTypes {
 
   unsigned ClangCallConvToLLVMCallConv(CallingConv CC);
 
+  /// Clear the type cache, forgetting every type derived from a placeholder.
+  void flushTypeCache();
+
+  /// Flush the type cache if a function type conversion was skipped since
+  /// the last flush.
+  void flushTypeCacheIfSkippedLayout();
+
 public:
   CodeGenTypes(CodeGenModule &cgm);
   ~CodeGenTypes();
@@ -367,6 +381,9 @@ public:  // These are internal details of CGT that shouldn't be used externally.
   bool isRecordBeingLaidOut(const Type *Ty) const {
     return RecordsBeingLaidOut.count(Ty);
   }
+
+  /// Return the number of times the type cache has been cleared.
+  unsigned getNumTypeCacheFlushes() const { return NumTypeCacheFlushes; }
                             
 };
 
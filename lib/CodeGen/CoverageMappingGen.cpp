@@ -15,6 +15,7 @@
 #include "CodeGenFunction.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Optional.h"
@@ -397,6 +398,19 @@ struct CounterCoverageMappingBuilder
   /// expressions cross file or macro boundaries.
   SourceLocation MostRecentLocation;
 
+  /// \brief The raw encodings of the bounds of the regions in
+  /// \c SourceRegions.
+  llvm::DenseSet<std::pair<unsigned, unsigned>> SourceRegionBounds;
+
+  /// \brief Add a region with bounds \c StartLoc and \c EndLoc to the
+  /// function's \c SourceRegions.
+  void addSourceRegion(Counter Count, SourceLocation StartLoc,
+                       SourceLocation EndLoc) {
+    SourceRegionBounds.insert(
+        std::make_pair(StartLoc.getRawEncoding(), EndLoc.getRawEncoding()));
+    SourceRegions.emplace_back(Count, StartLoc, EndLoc);
+  }
+
   /// \brief Return a counter for the subtraction of \c RHS from \c LHS
   Counter subtractCounters(Counter LHS, Counter RHS) {
     return Builder.subtract(LHS, RHS);
@@ -451,7 +465,7 @@ struct CounterCoverageMappingBuilder
           assert(SM.isWrittenInSameFile(NestedLoc, EndLoc));
 
           if (!isRegionAlreadyAdded(NestedLoc, EndLoc))
-            SourceRegions.emplace_back(Region.getCounter(), NestedLoc, EndLoc);
+            addSourceRegion(Region.getCounter(), NestedLoc, EndLoc);
 
           EndLoc = getPreciseTokenLocEnd(getIncludeOrExpansionLoc(EndLoc));
           if (EndLoc.isInvalid())
@@ -467,7 +481,7 @@ struct CounterCoverageMappingBuilder
           MostRecentLocation = getIncludeOrExpansionLoc(EndLoc);
 
         assert(SM.isWrittenInSameFile(Region.getStartLoc(), EndLoc));
-        SourceRegions.push_back(Region);
+        addSourceRegion(Region.getCounter(), Region.getStartLoc(), EndLoc);
       }
       RegionStack.pop_back();
     }
@@ -497,12 +511,8 @@ struct CounterCoverageMappingBuilder
   /// \brief Check whether a region with bounds \c StartLoc and \c EndLoc
   /// is already added to \c SourceRegions.
   bool isRegionAlreadyAdded(SourceLocation StartLoc, SourceLocation EndLoc) {
-    return SourceRegions.rend() !=
-           std::find_if(SourceRegions.rbegin(), SourceRegions.rend(),
-                        [&](const SourceMappingRegion &Region) {
-                          return Region.getStartLoc() == StartLoc &&
-                                 Region.getEndLoc() == EndLoc;
-                        });
+    return SourceRegionBounds.count(
+        std::make_pair(StartLoc.getRawEncoding(), EndLoc.getRawEncoding()));
   }
 
   /// \brief Adjust the most recently visited location to \c EndLoc.
@@ -563,8 +573,7 @@ struct CounterCoverageMappingBuilder
         // correct count. We avoid creating redundant regions by stopping once
         // we've seen this region.
         if (StartLocs.insert(Loc).second)
-          SourceRegions.emplace_back(I.getCounter(), Loc,
-                                     getEndOfFileOrMacro(Loc));
+          addSourceRegion(I.getCounter(), Loc, getEndOfFileOrMacro(Loc));
         Loc = getIncludeOrExpansionLoc(Loc);
       }
       I.setStartLoc(getPreciseTokenLocEnd(Loc));
@@ -578,8 +587,7 @@ struct CounterCoverageMappingBuilder
       while (isNestedIn(Loc, ParentFile)) {
         SourceLocation FileStart = getStartOfFileOrMacro(Loc);
         if (StartLocs.insert(FileStart).second)
-          SourceRegions.emplace_back(*ParentCounter, FileStart,
-                                     getEndOfFileOrMacro(Loc));
+          addSourceRegion(*ParentCounter, FileStart, getEndOfFileOrMacro(Loc));
         Loc = getIncludeOrExpansionLoc(Loc);
       }
     }
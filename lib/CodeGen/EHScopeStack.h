@@ -92,6 +92,7 @@ enum CleanupKind : unsigned {
   InactiveNormalAndEHCleanup = NormalAndEHCleanup | InactiveCleanup,
 
   LifetimeMarker = 0x8,
+  NormalLifetimeMarker = LifetimeMarker | NormalCleanup,
   NormalEHLifetimeMarker = LifetimeMarker | NormalAndEHCleanup,
 };
 
@@ -502,6 +502,34 @@ ItaniumCXXABI::ConvertMemberPointerType(const MemberPointerType *MPT) {
   return llvm::StructType::get(CGM.PtrDiffTy, CGM.PtrDiffTy, nullptr);
 }
 
+/// Load the function or RTTI proxy which the relative vtable component at
+/// \p Offset bytes from the address point \p VTable refers to.
+static llvm::Value *emitLoadRelative(CodeGenFunction &CGF, llvm::Value *VTable,
+                                     llvm::Value *Offset) {
+  llvm::Value *LoadRelative = CGF.CGM.getIntrinsic(
+      llvm::Intrinsic::load_relative, {Offset->getType()});
+  VTable = CGF.Builder.CreateBitCast(VTable, CGF.Int8PtrTy);
+  return CGF.Builder.CreateCall(LoadRelative, {VTable, Offset});
+}
+
+/// Load the offset which a relative vtable stores as a 32-bit component in
+/// place of the ptrdiff_t which the usual layout stores at \p Offset bytes
+/// from the address point \p VTable.
+static llvm::Value *emitLoadOfRelativeVTableOffset(CodeGenFunction &CGF,
+                                                   llvm::Value *VTable,
+                                                   int64_t Offset,
+                                                   const Twine &Name) {
+  int64_t RelativeOffset = Offset / CGF.getPointerSize().getQuantity() * 4;
+  VTable = CGF.Builder.CreateBitCast(VTable, CGF.Int8PtrTy);
+  llvm::Value *Ptr =
+      CGF.Builder.CreateConstInBoundsGEP1_64(VTable, RelativeOffset);
+  Ptr = CGF.Builder.CreateBitCast(Ptr, CGF.Int32Ty->getPointerTo());
+  llvm::Value *Value =
+      CGF.Builder.CreateAlignedLoad(Ptr, CharUnits::fromQuantity(4), Name);
+  return CGF.Builder.CreateSExt(
+      Value, CGF.ConvertType(CGF.getContext().getPointerDiffType()));
+}
+
 /// In the Itanium and ARM ABIs, method pointers have the form:
 ///   struct { ptrdiff_t ptr; ptrdiff_t adj; } memptr;
 ///
@@ -590,17 +618,24 @@ CGCallee ItaniumCXXABI::EmitLoadOfMemberFunctionPointer(
   llvm::Value *VTableOffset = FnAsInt;
   if (!UseARMMethodPtrABI)
     VTableOffset = Builder.CreateSub(VTableOffset, ptrdiff_1);
-  if (Use32BitVTableOffsetABI) {
+  llvm::Value *VirtualFn;
+  if (CGM.getVTables().useRelativeLayout()) {
     VTableOffset = Builder.CreateTrunc(VTableOffset, CGF.Int32Ty);
-    VTableOffset = Builder.CreateZExt(VTableOffset, CGM.PtrDiffTy);
-  }
-  VTable = Builder.CreateGEP(VTable, VTableOffset);
+    VirtualFn = Builder.CreateBitCast(
+        emitLoadRelative(CGF, VTable, VTableOffset), FTy->getPointerTo(),
+        "memptr.virtualfn");
+  } else {
+    if (Use32BitVTableOffsetABI) {
+      VTableOffset = Builder.CreateTrunc(VTableOffset, CGF.Int32Ty);
+      VTableOffset = Builder.CreateZExt(VTableOffset, CGM.PtrDiffTy);
+    }
+    VTable = Builder.CreateGEP(VTable, VTableOffset);
 
-  // Load the virtual function to call.
-  VTable = Builder.CreateBitCast(VTable, FTy->getPointerTo()->getPointerTo());
-  llvm::Value *VirtualFn =
-    Builder.CreateAlignedLoad(VTable, CGF.getPointerAlign(),
-                              "memptr.virtualfn");
+    // Load the virtual function to call.
+    VTable = Builder.CreateBitCast(VTable, FTy->getPointerTo()->getPointerTo());
+    VirtualFn = Builder.CreateAlignedLoad(VTable, CGF.getPointerAlign(),
+                                          "memptr.virtualfn");
+  }
   CGF.EmitBranch(FnEnd);
 
   // In the non-virtual path, the function pointer is actually a
@@ -811,6 +846,8 @@ llvm::Constant *ItaniumCXXABI::BuildMemberPointer(const CXXMethodDecl *MD,
     CharUnits PointerWidth =
       Context.toCharUnitsFromBits(Context.getTargetInfo().getPointerWidth(0));
     uint64_t VTableOffset = (Index * PointerWidth.getQuantity());
+    if (CGM.getVTables().useRelativeLayout())
+      VTableOffset = Index * 4;
 
     if (UseARMMethodPtrABI) {
       // ARM C++ ABI 3.2.1:
@@ -1024,10 +1061,16 @@ void ItaniumCXXABI::emitVirtualObjectDelete(CodeGenFunction &CGF,
         CGF.GetVTablePtr(Ptr, CGF.IntPtrTy->getPointerTo(), ClassDecl);
 
     // Track back to entry -2 and pull out the offset there.
-    llvm::Value *OffsetPtr = CGF.Builder.CreateConstInBoundsGEP1_64(
-        VTable, -2, "complete-offset.ptr");
-    llvm::Value *Offset =
-      CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+    llvm::Value *Offset;
+    if (CGM.getVTables().useRelativeLayout()) {
+      Offset = emitLoadOfRelativeVTableOffset(
+          CGF, VTable, -2 * CGF.getPointerSize().getQuantity(),
+          "complete-offset");
+    } else {
+      llvm::Value *OffsetPtr = CGF.Builder.CreateConstInBoundsGEP1_64(
+          VTable, -2, "complete-offset.ptr");
+      Offset = CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+    }
 
     // Apply the offset.
     llvm::Value *CompletePtr =
@@ -1225,6 +1268,14 @@ llvm::Value *ItaniumCXXABI::EmitTypeid(CodeGenFunction &CGF,
   llvm::Value *Value =
       CGF.GetVTablePtr(ThisPtr, StdTypeInfoPtrTy->getPointerTo(), ClassDecl);
 
+  // The RTTI component of a relative vtable refers to a proxy holding the
+  // address of the type info.
+  if (CGM.getVTables().useRelativeLayout()) {
+    Value = emitLoadRelative(CGF, Value, CGF.Builder.getInt32(-4));
+    Value = CGF.Builder.CreateBitCast(Value, StdTypeInfoPtrTy->getPointerTo());
+    return CGF.Builder.CreateAlignedLoad(Value, CGF.getPointerAlign());
+  }
+
   // Load the type info.
   Value = CGF.Builder.CreateConstInBoundsGEP1_64(Value, -1ULL);
   return CGF.Builder.CreateAlignedLoad(Value, CGF.getPointerAlign());
@@ -1293,11 +1344,16 @@ llvm::Value *ItaniumCXXABI::EmitDynamicCastToVoid(CodeGenFunction &CGF,
       ClassDecl);
 
   // Get the offset-to-top from the vtable.
-  llvm::Value *OffsetToTop =
-      CGF.Builder.CreateConstInBoundsGEP1_64(VTable, -2ULL);
-  OffsetToTop =
-    CGF.Builder.CreateAlignedLoad(OffsetToTop, CGF.getPointerAlign(),
-                                  "offset.to.top");
+  llvm::Value *OffsetToTop;
+  if (CGM.getVTables().useRelativeLayout()) {
+    OffsetToTop = emitLoadOfRelativeVTableOffset(
+        CGF, VTable, -2 * CGF.getPointerSize().getQuantity(), "offset.to.top");
+  } else {
+    OffsetToTop = CGF.Builder.CreateConstInBoundsGEP1_64(VTable, -2ULL);
+    OffsetToTop =
+      CGF.Builder.CreateAlignedLoad(OffsetToTop, CGF.getPointerAlign(),
+                                    "offset.to.top");
+  }
 
   // Finally, add the offset to the pointer.
   llvm::Value *Value = ThisAddr.getPointer();
@@ -1324,6 +1380,10 @@ ItaniumCXXABI::GetVirtualBaseClassOffset(CodeGenFunction &CGF,
       CGM.getItaniumVTableContext().getVirtualBaseOffsetOffset(ClassDecl,
                                                                BaseClassDecl);
 
+  if (CGM.getVTables().useRelativeLayout())
+    return emitLoadOfRelativeVTableOffset(
+        CGF, VTablePtr, VBaseOffsetOffset.getQuantity(), "vbase.offset");
+
   llvm::Value *VBaseOffsetPtr =
     CGF.Builder.CreateConstGEP1_64(VTablePtr, VBaseOffsetOffset.getQuantity(),
                                    "vbase.offset.ptr");
@@ -1622,7 +1682,13 @@ CGCallee ItaniumCXXABI::getVirtualFunctionPointer(CodeGenFunction &CGF,
 
   uint64_t VTableIndex = CGM.getItaniumVTableContext().getMethodVTableIndex(GD);
   llvm::Value *VFunc;
-  if (CGF.ShouldEmitVTableTypeCheckedLoad(MethodDecl->getParent())) {
+  if (CGM.getVTables().useRelativeLayout()) {
+    CGF.EmitTypeMetadataCodeForVCall(MethodDecl->getParent(), VTable, Loc);
+
+    VFunc = CGF.Builder.CreateBitCast(
+        emitLoadRelative(CGF, VTable, CGF.Builder.getInt32(4 * VTableIndex)),
+        Ty->getPointerElementType());
+  } else if (CGF.ShouldEmitVTableTypeCheckedLoad(MethodDecl->getParent())) {
     VFunc = CGF.EmitVTableTypeCheckedLoad(
         MethodDecl->getParent(), VTable,
         VTableIndex * CGM.getContext().getTargetInfo().getPointerWidth(0) / 8);
@@ -1649,6 +1715,10 @@ CGCallee ItaniumCXXABI::getVirtualFunctionPointer(CodeGenFunction &CGF,
     VFunc = VFuncLoad;
   }
 
+  if (CGM.getCodeGenOpts().DevirtualizeInternalClasses &&
+      !CGM.getLangOpts().AppleKext)
+    CGM.addInternalVCall(GD, VFunc, Loc);
+
   CGCallee Callee(MethodDecl, VFunc);
   return Callee;
 }
@@ -1715,14 +1785,20 @@ static llvm::Value *performTypeAdjustment(CodeGenFunction &CGF,
     Address VTablePtrPtr = CGF.Builder.CreateElementBitCast(V, CGF.Int8PtrTy);
     llvm::Value *VTablePtr = CGF.Builder.CreateLoad(VTablePtrPtr);
 
-    llvm::Value *OffsetPtr =
-        CGF.Builder.CreateConstInBoundsGEP1_64(VTablePtr, VirtualAdjustment);
+    // Load the adjustment offset from the vtable.
+    llvm::Value *Offset;
+    if (CGF.CGM.getVTables().useRelativeLayout()) {
+      Offset = emitLoadOfRelativeVTableOffset(CGF, VTablePtr,
+                                              VirtualAdjustment, "");
+    } else {
+      llvm::Value *OffsetPtr =
+          CGF.Builder.CreateConstInBoundsGEP1_64(VTablePtr, VirtualAdjustment);
 
-    OffsetPtr = CGF.Builder.CreateBitCast(OffsetPtr, PtrDiffTy->getPointerTo());
+      OffsetPtr =
+          CGF.Builder.CreateBitCast(OffsetPtr, PtrDiffTy->getPointerTo());
 
-    // Load the adjustment offset from the vtable.
-    llvm::Value *Offset =
-      CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+      Offset = CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+    }
 
     // Adjust our pointer.
     ResultPtr = CGF.Builder.CreateInBoundsGEP(V.getPointer(), Offset);
@@ -2885,10 +2961,18 @@ void ItaniumRTTIBuilder::BuildVTablePointer(const Type *Ty) {
     CGM.getTypes().ConvertType(CGM.getContext().getPointerDiffType());
 
   // The vtable address point is 2.
-  llvm::Constant *Two = llvm::ConstantInt::get(PtrDiffTy, 2);
-  VTable =
-      llvm::ConstantExpr::getInBoundsGetElementPtr(CGM.Int8PtrTy, VTable, Two);
-  VTable = llvm::ConstantExpr::getBitCast(VTable, CGM.Int8PtrTy);
+  if (CGM.getVTables().useRelativeLayout()) {
+    // The components of a relative vtable are 4 bytes long.
+    llvm::Constant *Eight = llvm::ConstantInt::get(PtrDiffTy, 8);
+    VTable = llvm::ConstantExpr::getBitCast(VTable, CGM.Int8PtrTy);
+    VTable =
+        llvm::ConstantExpr::getInBoundsGetElementPtr(CGM.Int8Ty, VTable, Eight);
+  } else {
+    llvm::Constant *Two = llvm::ConstantInt::get(PtrDiffTy, 2);
+    VTable = llvm::ConstantExpr::getInBoundsGetElementPtr(CGM.Int8PtrTy, VTable,
+                                                          Two);
+    VTable = llvm::ConstantExpr::getBitCast(VTable, CGM.Int8PtrTy);
+  }
 
   Fields.push_back(VTable);
 }
@@ -247,6 +247,11 @@ namespace {
           DI->completeRequiredType(RD);
     }
 
+    void PrintStats() override {
+      if (Builder)
+        Builder->PrintStats();
+    }
+
     void HandleTranslationUnit(ASTContext &Ctx) override {
       // Release the Builder when there is no error.
       if (!Diags.hasErrorOccurred() && Builder)
@@ -239,8 +239,8 @@ public:
     M->setTargetTriple(Ctx.getTargetInfo().getTriple().getTriple());
     M->setDataLayout(Ctx.getTargetInfo().getDataLayout());
 
-    // PCH files don't have a signature field in the control block,
-    // but LLVM detects DWO CUs by looking for a non-zero DWO id.
+    // Explicitly built modules don't have a signature field in the control
+    // block, but LLVM detects DWO CUs by looking for a non-zero DWO id.
     uint64_t Signature = Buffer->Signature ? Buffer->Signature : ~1ULL;
     Builder->getModuleDebugInfo()->setDwoId(Signature);
 
@@ -263,6 +263,13 @@ public:
     auto *Data = llvm::ConstantDataArray::getString(
         *VMContext, StringRef(SerializedAST.data(), Size),
         /*AddNull=*/false);
+
+    // The constant holds its own copy of the serialized AST; free the
+    // temporary buffer now rather than keeping both alive while the backend
+    // runs.
+    llvm::SmallVector<char, 0> Empty;
+    SerializedAST = std::move(Empty);
+
     auto *ASTSym = new llvm::GlobalVariable(
         *M, Ty, /*constant*/ true, llvm::GlobalVariable::InternalLinkage, Data,
         "__clang_ast");
@@ -293,10 +300,6 @@ public:
     clang::EmitBackendOutput(Diags, CodeGenOpts, TargetOpts, LangOpts,
                              Ctx.getTargetInfo().getDataLayout(), M.get(),
                              BackendAction::Backend_EmitObj, std::move(OS));
-
-    // Free the memory for the temporary buffer.
-    llvm::SmallVector<char, 0> Empty;
-    SerializedAST = std::move(Empty);
   }
 };
 
@@ -315,6 +318,11 @@ ObjectFilePCHContainerWriter::CreatePCHContainerGenerator(
 StringRef
 ObjectFilePCHContainerReader::ExtractPCH(llvm::MemoryBufferRef Buffer) const {
   StringRef PCH;
+  // A raw AST file is not wrapped in an object file; don't try to parse it
+  // as one.
+  if (Buffer.getBuffer().startswith("CPCH"))
+    return Buffer.getBuffer();
+
   auto OFOrErr = llvm::object::ObjectFile::createObjectFile(Buffer);
   if (OFOrErr) {
     auto &OF = OFOrErr.get();
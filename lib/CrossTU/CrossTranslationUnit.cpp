@@ -0,0 +1,293 @@
+//===--- CrossTranslationUnit.cpp - Cross translation unit support --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the CrossTranslationUnitContext class, which loads
+//  function definitions from the ASTs of other translation units.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "clang/AST/ASTImporter.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace cross_tu;
+
+namespace {
+class IndexErrorCategory : public std::error_category {
+public:
+  const char *name() const noexcept override { return "clang.index"; }
+
+  std::string message(int Condition) const override {
+    switch (static_cast<index_error_code>(Condition)) {
+    case index_error_code::unspecified:
+      return "An unknown error has occurred.";
+    case index_error_code::missing_index_file:
+      return "The index file is missing.";
+    case index_error_code::invalid_index_format:
+      return "Invalid index file format.";
+    case index_error_code::multiple_definitions:
+      return "Multiple definitions in the index file.";
+    case index_error_code::missing_definition:
+      return "Missing definition from the index file.";
+    case index_error_code::failed_import:
+      return "Failed to import the definition.";
+    case index_error_code::failed_to_get_external_ast:
+      return "Failed to load external AST source.";
+    case index_error_code::failed_to_generate_usr:
+      return "Failed to generate USR.";
+    }
+    llvm_unreachable("Unrecognized index_error_code.");
+  }
+};
+} // end anonymous namespace
+
+static llvm::ManagedStatic<IndexErrorCategory> Category;
+
+char IndexError::ID;
+
+void IndexError::log(raw_ostream &OS) const {
+  OS << Category->message(static_cast<int>(Code));
+  if (!FileName.empty()) {
+    OS << " (" << FileName;
+    if (LineNo)
+      OS << ":" << LineNo;
+    OS << ")";
+  }
+  OS << '\n';
+}
+
+std::error_code IndexError::convertToErrorCode() const {
+  return std::error_code(static_cast<int>(Code), *Category);
+}
+
+llvm::Expected<llvm::StringMap<std::string>>
+cross_tu::parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexPath);
+  if (!Buffer)
+    return llvm::make_error<IndexError>(index_error_code::missing_index_file,
+                                        IndexPath.str());
+
+  llvm::StringMap<std::string> Result;
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/true);
+  for (unsigned I = 0, E = Lines.size(); I != E; ++I) {
+    StringRef Line = Lines[I].rtrim("\r");
+    if (Line.trim().empty())
+      continue;
+    // USRs don't contain spaces, but paths may.
+    StringRef USR, FileName;
+    std::tie(USR, FileName) = Line.split(' ');
+    if (USR.empty() || FileName.empty())
+      return llvm::make_error<IndexError>(
+          index_error_code::invalid_index_format, IndexPath.str(), I + 1);
+
+    SmallString<256> FilePath;
+    if (llvm::sys::path::is_relative(FileName)) {
+      FilePath = CrossTUDir;
+      llvm::sys::path::append(FilePath, FileName);
+    } else {
+      FilePath = FileName;
+    }
+    if (!Result.insert(std::make_pair(USR, FilePath.str().str())).second)
+      return llvm::make_error<IndexError>(
+          index_error_code::multiple_definitions, IndexPath.str(), I + 1);
+  }
+  return std::move(Result);
+}
+
+std::string
+cross_tu::createCrossTUIndexString(const llvm::StringMap<std::string> &Index) {
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  for (const auto &Entry : Index)
+    OS << Entry.getKey() << " " << Entry.getValue() << "\n";
+  return OS.str();
+}
+
+CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI,
+                                                         unsigned MaxLoadedTUs)
+    : CI(CI), Context(CI.getASTContext()),
+      MaxLoadedTUs(std::max(MaxLoadedTUs, 1u)) {}
+
+CrossTranslationUnitContext::~CrossTranslationUnitContext() {}
+
+std::string CrossTranslationUnitContext::getLookupName(const NamedDecl *ND) {
+  SmallString<128> DeclUSR;
+  if (index::generateUSRForDecl(ND, DeclUSR))
+    return std::string();
+  return DeclUSR.str();
+}
+
+/// Can functions be defined in \p D, or in contexts nested in it?
+static bool mayContainFunctions(const Decl *D) {
+  return isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+         isa<CXXRecordDecl>(D);
+}
+
+const FunctionDecl *
+CrossTranslationUnitContext::findFunctionInDeclContext(const DeclContext *DC,
+                                                       StringRef LookupFnName) {
+  for (const Decl *D : DC->decls()) {
+    if (mayContainFunctions(D)) {
+      if (const FunctionDecl *FD =
+              findFunctionInDeclContext(cast<DeclContext>(D), LookupFnName))
+        return FD;
+      continue;
+    }
+    const auto *FD = dyn_cast<FunctionDecl>(D);
+    const FunctionDecl *Definition;
+    if (!FD || !FD->hasBody(Definition))
+      continue;
+    if (getLookupName(Definition) == LookupFnName)
+      return Definition;
+  }
+  return nullptr;
+}
+
+llvm::Expected<const FunctionDecl *>
+CrossTranslationUnitContext::getCrossTUDefinition(const FunctionDecl *FD,
+                                                  StringRef CrossTUDir,
+                                                  StringRef IndexName) {
+  const FunctionDecl *Definition;
+  if (FD->hasBody(Definition))
+    return Definition;
+
+  std::string LookupFnName = getLookupName(FD);
+  if (LookupFnName.empty())
+    return llvm::make_error<IndexError>(
+        index_error_code::failed_to_generate_usr);
+
+  auto Imported = ImportedFunctions.find(LookupFnName);
+  if (Imported != ImportedFunctions.end())
+    return Imported->second;
+
+  llvm::Expected<ASTUnit *> UnitOrError =
+      loadExternalAST(LookupFnName, CrossTUDir, IndexName);
+  if (!UnitOrError)
+    return UnitOrError.takeError();
+  ASTUnit *Unit = *UnitOrError;
+
+  const FunctionDecl *FromDefinition = findFunctionInDeclContext(
+      Unit->getASTContext().getTranslationUnitDecl(), LookupFnName);
+  if (!FromDefinition)
+    return llvm::make_error<IndexError>(index_error_code::missing_definition,
+                                        LookupFnName);
+
+  llvm::Expected<const FunctionDecl *> ToDefinition =
+      importDefinition(FromDefinition, Unit);
+  if (ToDefinition)
+    ImportedFunctions[LookupFnName] = *ToDefinition;
+  return ToDefinition;
+}
+
+llvm::Expected<ASTUnit *>
+CrossTranslationUnitContext::loadExternalAST(StringRef LookupName,
+                                             StringRef CrossTUDir,
+                                             StringRef IndexName) {
+  if (FunctionFileMap.empty()) {
+    SmallString<256> IndexFile;
+    if (llvm::sys::path::is_absolute(IndexName)) {
+      IndexFile = IndexName;
+    } else {
+      IndexFile = CrossTUDir;
+      llvm::sys::path::append(IndexFile, IndexName);
+    }
+    // Report a missing or invalid index again without reading it every time.
+    auto Failed = IndexFileErrors.find(IndexFile);
+    if (Failed != IndexFileErrors.end())
+      return llvm::make_error<IndexError>(Failed->second);
+    llvm::Expected<llvm::StringMap<std::string>> IndexOrErr =
+        parseCrossTUIndex(IndexFile, CrossTUDir);
+    if (!IndexOrErr)
+      return llvm::handleErrors(
+          IndexOrErr.takeError(), [&](const IndexError &IE) -> llvm::Error {
+            IndexFileErrors.insert(std::make_pair(IndexFile.str(), IE));
+            return llvm::make_error<IndexError>(IE);
+          });
+    FunctionFileMap = std::move(*IndexOrErr);
+  }
+
+  auto It = FunctionFileMap.find(LookupName);
+  if (It == FunctionFileMap.end())
+    return llvm::make_error<IndexError>(index_error_code::missing_definition,
+                                        LookupName.str());
+  StringRef ASTFileName = It->second;
+
+  auto UnitIt = FileASTUnitMap.find(ASTFileName);
+  if (UnitIt != FileASTUnitMap.end()) {
+    LoadedUnits.splice(LoadedUnits.begin(), LoadedUnits, UnitIt->second);
+    return UnitIt->second->second.get();
+  }
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticPrinter *DiagClient =
+      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
+      new DiagnosticsEngine(DiagID, &*DiagOpts, DiagClient));
+
+  std::unique_ptr<ASTUnit> Unit = ASTUnit::LoadFromASTFile(
+      ASTFileName, CI.getPCHContainerOperations()->getRawReader(), Diags,
+      CI.getFileSystemOpts());
+  if (!Unit)
+    return llvm::make_error<IndexError>(
+        index_error_code::failed_to_get_external_ast, ASTFileName.str());
+
+  // Release the least recently used AST to make room for this one. Its
+  // importer refers to it, so it has to go as well.
+  if (LoadedUnits.size() >= MaxLoadedTUs) {
+    LoadedUnit &Oldest = LoadedUnits.back();
+    ASTUnitImporterMap.erase(Oldest.second.get());
+    FileASTUnitMap.erase(Oldest.first);
+    LoadedUnits.pop_back();
+  }
+
+  LoadedUnits.emplace_front(ASTFileName.str(), std::move(Unit));
+  FileASTUnitMap[ASTFileName] = LoadedUnits.begin();
+  return LoadedUnits.front().second.get();
+}
+
+llvm::Expected<const FunctionDecl *>
+CrossTranslationUnitContext::importDefinition(const FunctionDecl *FD,
+                                              ASTUnit *Unit) {
+  ASTImporter &Importer = getOrCreateASTImporter(Unit);
+  auto *ToDecl = cast_or_null<FunctionDecl>(
+      Importer.Import(const_cast<FunctionDecl *>(FD)));
+  const FunctionDecl *Definition;
+  if (!ToDecl || !ToDecl->hasBody(Definition))
+    return llvm::make_error<IndexError>(index_error_code::failed_import,
+                                        getLookupName(FD));
+  return Definition;
+}
+
+ASTImporter &
+CrossTranslationUnitContext::getOrCreateASTImporter(ASTUnit *Unit) {
+  std::unique_ptr<ASTImporter> &Importer = ASTUnitImporterMap[Unit];
+  if (!Importer)
+    Importer = llvm::make_unique<ASTImporter>(
+        Context, Context.getSourceManager().getFileManager(),
+        Unit->getASTContext(), Unit->getFileManager(),
+        /*MinimalImport=*/false);
+  return *Importer;
+}
@@ -8,15 +8,24 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Driver/Compilation.h"
+#include "CompileCache.h"
 #include "clang/Driver/Action.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
 
 using namespace clang::driver;
 using namespace clang;
@@ -144,40 +153,101 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
-      std::error_code EC;
-      OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
-                                    llvm::sys::fs::F_Append |
-                                        llvm::sys::fs::F_Text);
-      if (EC) {
-        getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        delete OS;
-        return 1;
-      }
+bool Compilation::PrintCommandIfRequested(const Command &C) const {
+  if ((!getDriver().CCPrintOptions && !getArgs().hasArg(options::OPT_v)) ||
+      getDriver().CCGenDiagnostics)
+    return true;
+
+  raw_ostream *OS = &llvm::errs();
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
+    std::error_code EC;
+    OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
+                                  llvm::sys::fs::F_Append |
+                                      llvm::sys::fs::F_Text);
+    if (EC) {
+      getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
+          << EC.message();
+      delete OS;
+      return false;
     }
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]";
+  if (getDriver().CCPrintOptions)
+    *OS << "[Logging clang options]";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
 
-    if (OS != &llvm::errs())
-      delete OS;
+  if (OS != &llvm::errs())
+    delete OS;
+  return true;
+}
+
+bool Compilation::canRunWithCC1Runner(const Command &C) const {
+  const Driver &D = getDriver();
+  // Only plain clang -cc1 jobs can be handed off: redirected output and
+  // /fallback both need the job to be run as a real process, and so do the
+  // jobs rerun to diagnose a crash.
+  return D.CC1Runner && !Redirects && !ForDiagnostics &&
+         !C.getArguments().empty() &&
+         StringRef(C.getArguments().front()) == "-cc1" &&
+         StringRef(C.getExecutable()) == D.getClangProgramPath() &&
+         !getArgs().hasArg(options::OPT__SLASH_fallback);
+}
+
+bool Compilation::RunWithCC1Runner(const Command &C, int &Res,
+                                 std::string *ErrMsg) const {
+  if (!canRunWithCC1Runner(C))
+    return false;
+  return getDriver().CC1Runner(C.getArguments(), Res, ErrMsg);
+}
+
+bool Compilation::canRunWithCompileCache(const Command &C) const {
+  const Driver &D = getDriver();
+  // Jobs with redirected output and jobs rerun to diagnose a crash must
+  // always run.
+  return !D.getCompileCacheDir().empty() && !Redirects && !ForDiagnostics &&
+         !C.getArguments().empty() &&
+         StringRef(C.getArguments().front()) == "-cc1" &&
+         StringRef(C.getExecutable()) == D.getClangProgramPath();
+}
+
+bool Compilation::RunWithCompileCache(const Command &C, int &Res,
+                                      std::string *ErrMsg,
+                                      bool *ExecutionFailed) const {
+  if (!canRunWithCompileCache(C))
+    return false;
+  return executeWithCompileCache(getDriver().getCompileCacheDir(), C, Res,
+                                 ErrMsg, ExecutionFailed);
+}
+
+bool Compilation::isRunWithCC1Runner(const Command &C) const {
+  // The compile cache runs its jobs as processes, and so are jobs run in
+  // parallel unless the runner is thread-safe.
+  return canRunWithCC1Runner(C) && !canRunWithCompileCache(C) &&
+         (getDriver().CC1RunnerIsThreadSafe ||
+          getNumParallelJobs(getJobs()) == 1);
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommandIfRequested(C)) {
+    FailingCommand = &C;
+    return 1;
   }
 
   std::string Error;
-  bool ExecutionFailed;
-  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  bool ExecutionFailed = false;
+  int Res;
+  if (RunWithCompileCache(C, Res, &Error, &ExecutionFailed)) {
+    // Nothing more to do; the job was run or its result was reused.
+  } else if (!RunWithCC1Runner(C, Res, &Error)) {
+    Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  } else if (!Error.empty()) {
+    ExecutionFailed = true;
+  }
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
     getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
@@ -189,9 +259,23 @@ int Compilation::ExecuteCommand(const Command &C,
   return ExecutionFailed ? 1 : Res;
 }
 
+unsigned Compilation::getNumParallelJobs(const JobList &Jobs) const {
+  unsigned NumThreads = getDriver().getNumParallelJobs();
+  if (LLVM_ENABLE_THREADS && NumThreads > 1 && Jobs.size() > 1 &&
+      !ForDiagnostics)
+    return NumThreads;
+  return 1;
+}
+
 void Compilation::ExecuteJobs(
     const JobList &Jobs,
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  unsigned NumThreads = getNumParallelJobs(Jobs);
+  if (NumThreads > 1) {
+    ExecuteJobsInParallel(Jobs, NumThreads, FailingCommands);
+    return;
+  }
+
   for (const auto &Job : Jobs) {
     const Command *FailingCommand = nullptr;
     if (int Res = ExecuteCommand(Job, FailingCommand)) {
@@ -203,6 +287,133 @@ void Compilation::ExecuteJobs(
   }
 }
 
+/// Add every action which \p A (transitively) consumes to \p Inputs.
+static void collectInputActions(const Action *A,
+                                llvm::SmallPtrSetImpl<const Action *> &Inputs) {
+  for (const Action *Input : A->getInputs())
+    if (Inputs.insert(Input).second)
+      collectInputActions(Input, Inputs);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, unsigned NumThreads,
+    SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  SmallVector<const Command *, 16> Commands;
+  llvm::DenseMap<const Action *, unsigned> CommandForAction;
+  for (const auto &Job : Jobs) {
+    CommandForAction[&Job.getSource()] = Commands.size();
+    Commands.push_back(&Job);
+  }
+
+  // A command depends on every other command whose source action feeds into
+  // its own, possibly through actions which were collapsed into it.
+  unsigned NumCommands = Commands.size();
+  std::vector<SmallVector<unsigned, 4>> Dependents(NumCommands);
+  std::vector<unsigned> NumPendingDeps(NumCommands, 0);
+  for (unsigned I = 0; I != NumCommands; ++I) {
+    llvm::SmallPtrSet<const Action *, 16> Inputs;
+    collectInputActions(&Commands[I]->getSource(), Inputs);
+    for (const Action *Input : Inputs) {
+      auto It = CommandForAction.find(Input);
+      if (It == CommandForAction.end() || It->second == I)
+        continue;
+      Dependents[It->second].push_back(I);
+      ++NumPendingDeps[I];
+    }
+  }
+
+  struct CommandResult {
+    int Res = 0;
+    bool ExecutionFailed = false;
+    bool Started = false;
+    std::string Error;
+  };
+  std::vector<CommandResult> Results(NumCommands);
+
+  // The commands which finished but have not been processed yet, guarded by
+  // FinishedLock.
+  std::mutex FinishedLock;
+  std::condition_variable FinishedCV;
+  SmallVector<unsigned, 16> Finished;
+
+  // Start ready commands in their original order so that the -v output and the
+  // scheduling match the serial order as closely as possible.
+  std::set<unsigned> Ready;
+  for (unsigned I = 0; I != NumCommands; ++I)
+    if (!NumPendingDeps[I])
+      Ready.insert(I);
+
+  llvm::ThreadPool Pool(std::min(NumThreads, NumCommands));
+  unsigned NumRunning = 0;
+  bool HadFailure = false;
+  while (NumRunning || (!Ready.empty() && !HadFailure)) {
+    while (!Ready.empty() && !HadFailure && NumRunning < NumThreads) {
+      unsigned I = *Ready.begin();
+      Ready.erase(Ready.begin());
+
+      CommandResult &R = Results[I];
+      R.Started = true;
+      if (!PrintCommandIfRequested(*Commands[I])) {
+        R.Res = 1;
+        HadFailure = true;
+        break;
+      }
+
+      ++NumRunning;
+      Pool.async([&, I] {
+        CommandResult &Result = Results[I];
+        if (RunWithCompileCache(*Commands[I], Result.Res, &Result.Error,
+                                &Result.ExecutionFailed)) {
+          // Nothing more to do; the job was run or its result was reused.
+        } else if (!getDriver().CC1RunnerIsThreadSafe ||
+                   !RunWithCC1Runner(*Commands[I], Result.Res,
+                                     &Result.Error)) {
+          Result.Res = Commands[I]->Execute(Redirects, &Result.Error,
+                                            &Result.ExecutionFailed);
+        } else if (!Result.Error.empty()) {
+          Result.ExecutionFailed = true;
+        }
+        std::lock_guard<std::mutex> Guard(FinishedLock);
+        Finished.push_back(I);
+        FinishedCV.notify_one();
+      });
+    }
+
+    if (!NumRunning)
+      break;
+
+    SmallVector<unsigned, 16> Done;
+    {
+      std::unique_lock<std::mutex> Guard(FinishedLock);
+      FinishedCV.wait(Guard, [&] { return !Finished.empty(); });
+      Done.swap(Finished);
+    }
+
+    for (unsigned I : Done) {
+      --NumRunning;
+      if (Results[I].Res) {
+        HadFailure = true;
+        continue;
+      }
+      for (unsigned Dependent : Dependents[I])
+        if (!--NumPendingDeps[Dependent])
+          Ready.insert(Dependent);
+    }
+  }
+  Pool.wait();
+
+  // Report the results in job order, independently of completion order.
+  for (unsigned I = 0; I != NumCommands; ++I) {
+    const CommandResult &R = Results[I];
+    if (!R.Started || !R.Res)
+      continue;
+    if (!R.Error.empty())
+      getDriver().Diag(clang::diag::err_drv_command_failure) << R.Error;
+    FailingCommands.push_back(
+        std::make_pair(R.ExecutionFailed ? 1 : R.Res, Commands[I]));
+  }
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
@@ -0,0 +1,389 @@
+//===--- CompileCache.cpp - Cache of Compile Job Results ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The cache directory holds, for each job key, a '<key>.manifest' file:
+//
+//   result <result hash>
+//   dep <content hash> <path>
+//   ...
+//   end
+//
+// with one entry per stored result, and with the fields separated by tabs.
+// The result hash covers the job key and the hashes of all its dependencies,
+// and names the '<result hash>.o' and '<result hash>.stderr' files holding
+// the object file and the diagnostics of the job.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CompileCache.h"
+#include "clang/Basic/FileUtilities.h"
+#include "clang/Basic/Version.h"
+#include "clang/Driver/Job.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+using namespace clang::driver;
+
+/// The number of results kept in the manifest of a job key.
+static const unsigned MaxManifestResults = 16;
+
+/// The target of the dependency files written for the cache.
+static const char DependencyTarget[] = "compile-cache";
+
+namespace {
+
+/// A result stored in the manifest of a job key.
+struct ManifestResult {
+  std::string ResultHash;
+  /// The content hash and path of each dependency.
+  std::vector<std::pair<std::string, std::string>> Dependencies;
+};
+
+} // end anonymous namespace
+
+/// Returns the hex SHA1 hash of \p Data.
+static std::string hashContents(StringRef Data) {
+  llvm::SHA1 Hasher;
+  Hasher.update(Data);
+  return llvm::toHex(Hasher.result());
+}
+
+/// Returns whether the -cc1 job with the arguments \p Args only writes an
+/// object file, and only reads the files a dependency file lists. If so,
+/// \p Output is set to the name of its object file. Jobs with any other
+/// output, like coverage notes or optimization records, are not cacheable,
+/// since only the object file is restored from the cache.
+static bool isCacheable(ArrayRef<const char *> Args, StringRef &Output) {
+  bool EmitsObject = false;
+  for (size_t I = 0, E = Args.size(); I != E; ++I) {
+    StringRef Arg = Args[I];
+    if (Arg == "-emit-obj") {
+      EmitsObject = true;
+      continue;
+    }
+    if (Arg == "-o" && I + 1 != E) {
+      Output = Args[++I];
+      continue;
+    }
+    // Other outputs, inputs missing from dependency files, and results which
+    // are not only written to the object file and stderr.
+    if (llvm::StringSwitch<bool>(Arg)
+            .Cases("-dependency-file", "-dependency-dot", "-header-include-file",
+                   "-serialize-diagnostic-file", "-split-dwarf-file", true)
+            .Cases("-index-store-path", "-include-pch", "-emit-pch", true)
+            .Cases("-femit-coverage-notes", "-coverage-notes-file",
+                   "-opt-record-file", "-diagnostic-log-file", true)
+            .Cases("-fdump-record-layouts", "-fdump-record-layouts-simple",
+                   "-fdump-vtable-layouts", "-dump-coverage-mapping", true)
+            .Cases("-fixit", "-fixit-recompile", "-fixit-to-temporary", true)
+            .Cases("-fmodules", "-fmodules-ts", "-fmodule-maps",
+                   "-module-file-deps", true)
+            .Cases("-load", "-plugin", "-add-plugin", true)
+            .Cases("-mlink-bitcode-file", "-mlink-cuda-bitcode",
+                   "-fcuda-include-gpubinary", true)
+            .Cases("-ftime-report", "-ftemplate-profile", "-print-stats", true)
+            .Default(false) ||
+        Arg.startswith("-fmodule-file=") ||
+        Arg.startswith("-fmodule-map-file=") ||
+        Arg.startswith("-coverage-notes-file=") || Arg.startswith("-fixit=") ||
+        Arg.startswith("-fprofile-instrument-use-path=") ||
+        Arg.startswith("-fprofile-sample-use=") ||
+        Arg.startswith("-fthinlto-index=") || Arg.startswith("-stats-file=") ||
+        Arg.startswith("-ftime-trace=") ||
+        Arg.startswith("-fheader-cost-file="))
+      return false;
+  }
+  return EmitsObject && !Output.empty() && Output != "-";
+}
+
+/// Returns the key of the -cc1 job running \p Executable with \p Args.
+static std::string getJobKey(StringRef Executable,
+                             ArrayRef<const char *> Args) {
+  const StringRef Separator("\0", 1);
+  llvm::SHA1 Hasher;
+  Hasher.update(getClangFullVersion());
+  Hasher.update(Separator);
+  Hasher.update(Executable);
+  Hasher.update(Separator);
+  // Relative paths in the arguments and the debug info depend on it.
+  SmallString<128> WorkingDir;
+  if (!llvm::sys::fs::current_path(WorkingDir))
+    Hasher.update(WorkingDir);
+  Hasher.update(Separator);
+  for (size_t I = 0, E = Args.size(); I != E; ++I) {
+    // Results do not depend on the name of the object file.
+    if (I == 0 || StringRef(Args[I - 1]) != "-o")
+      Hasher.update(Args[I]);
+    Hasher.update(Separator);
+  }
+  return llvm::toHex(Hasher.result());
+}
+
+/// Parses the dependency file \p Contents into the files it lists.
+static bool parseDependencyFile(StringRef Contents,
+                                std::vector<std::string> &Files) {
+  if (!Contents.consume_front(DependencyTarget) ||
+      !Contents.consume_front(":"))
+    return false;
+
+  std::string File;
+  auto AddFile = [&] {
+    if (!File.empty())
+      Files.push_back(std::move(File));
+    File.clear();
+  };
+  for (size_t I = 0, E = Contents.size(); I != E; ++I) {
+    char C = Contents[I];
+    if (C == '\\' && I + 1 != E &&
+        (Contents[I + 1] == ' ' || Contents[I + 1] == '#')) {
+      File += Contents[++I];
+    } else if (C == '\\' && Contents.substr(I + 1).startswith("\n")) {
+      // A line continuation.
+      AddFile();
+      ++I;
+    } else if (C == '\\' && Contents.substr(I + 1).startswith("\r\n")) {
+      AddFile();
+      I += 2;
+    } else if (C == '$' && I + 1 != E && Contents[I + 1] == '$') {
+      File += '$';
+      ++I;
+    } else if (C == ' ' || C == '\t' || C == '\r' || C == '\n') {
+      AddFile();
+    } else {
+      File += C;
+    }
+  }
+  AddFile();
+  return true;
+}
+
+/// Returns the content hash of \p Path, or an empty string if it cannot be
+/// read or the results of compiling it would not be repeatable.
+static std::string hashDependency(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!File)
+    return std::string();
+  StringRef Contents = (*File)->getBuffer();
+  // The expansions of these macros change from one compile to the next.
+  if (Contents.find("__DATE__") != StringRef::npos ||
+      Contents.find("__TIME__") != StringRef::npos ||
+      Contents.find("__TIMESTAMP__") != StringRef::npos)
+    return std::string();
+  return hashContents(Contents);
+}
+
+/// Parses the manifest \p Contents into its results, oldest first.
+static std::vector<ManifestResult> parseManifest(StringRef Contents) {
+  std::vector<ManifestResult> Results;
+  SmallVector<StringRef, 64> Lines;
+  Contents.split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  ManifestResult Current;
+  bool InResult = false;
+  for (StringRef Line : Lines) {
+    SmallVector<StringRef, 3> Fields;
+    Line.split(Fields, '\t', 2);
+    if (Fields[0] == "result" && Fields.size() == 2) {
+      Current = ManifestResult();
+      Current.ResultHash = Fields[1];
+      InResult = true;
+    } else if (Fields[0] == "dep" && Fields.size() == 3 && InResult) {
+      Current.Dependencies.push_back(std::make_pair(Fields[1], Fields[2]));
+    } else if (Fields[0] == "end" && InResult) {
+      Results.push_back(std::move(Current));
+      InResult = false;
+    } else {
+      // A truncated or corrupt entry.
+      InResult = false;
+    }
+  }
+  return Results;
+}
+
+/// Returns the path of the file \p Name in the cache directory \p CacheDir.
+static std::string getCachePath(StringRef CacheDir, const Twine &Name) {
+  SmallString<128> Path(CacheDir);
+  llvm::sys::path::append(Path, Name);
+  return Path.str();
+}
+
+/// Copies the stored result for the job key \p Key to \p Output, if there is
+/// one whose dependencies are unchanged.
+static bool replayResult(StringRef CacheDir, StringRef Key, StringRef Output) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Manifest =
+      llvm::MemoryBuffer::getFile(getCachePath(CacheDir, Key + ".manifest"));
+  if (!Manifest)
+    return false;
+
+  std::vector<ManifestResult> Results =
+      parseManifest((*Manifest)->getBuffer());
+  llvm::StringMap<std::string> DependencyHashes;
+  for (auto R = Results.rbegin(), E = Results.rend(); R != E; ++R) {
+    bool Unchanged = true;
+    for (const auto &Dependency : R->Dependencies) {
+      auto Known = DependencyHashes.insert(
+          std::make_pair(Dependency.second, std::string()));
+      if (Known.second)
+        Known.first->second = hashDependency(Dependency.second);
+      if (Known.first->second != Dependency.first) {
+        Unchanged = false;
+        break;
+      }
+    }
+    if (!Unchanged)
+      continue;
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Object =
+        llvm::MemoryBuffer::getFile(
+            getCachePath(CacheDir, R->ResultHash + ".o"), /*FileSize=*/-1,
+            /*RequiresNullTerminator=*/false);
+    if (!Object || writeFileAtomically(Output, (*Object)->getBuffer()))
+      continue;
+    if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Diagnostics =
+            llvm::MemoryBuffer::getFile(
+                getCachePath(CacheDir, R->ResultHash + ".stderr")))
+      llvm::errs() << (*Diagnostics)->getBuffer();
+    return true;
+  }
+  return false;
+}
+
+/// Stores the result of the job with the key \p Key, which wrote \p Output
+/// and \p Diagnostics and read the files in the dependency file \p DepFile.
+/// Failing to do so is not an error.
+static void storeResult(StringRef CacheDir, StringRef Key, StringRef Output,
+                        StringRef Diagnostics, StringRef DepFile) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Dependencies =
+      llvm::MemoryBuffer::getFile(DepFile);
+  std::vector<std::string> Files;
+  if (!Dependencies ||
+      !parseDependencyFile((*Dependencies)->getBuffer(), Files) ||
+      Files.empty())
+    return;
+
+  ManifestResult Result;
+  llvm::SHA1 Hasher;
+  Hasher.update(Key);
+  for (std::string &File : Files) {
+    std::string Hash = hashDependency(File);
+    if (Hash.empty() || File.find_first_of("\t\n") != std::string::npos)
+      return;
+    Hasher.update(StringRef("\0", 1));
+    Hasher.update(Hash);
+    Hasher.update(File);
+    Result.Dependencies.push_back(std::make_pair(Hash, std::move(File)));
+  }
+  Result.ResultHash = llvm::toHex(Hasher.result());
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Object =
+      llvm::MemoryBuffer::getFile(Output, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Object || llvm::sys::fs::create_directories(CacheDir))
+    return;
+  if (!Diagnostics.empty() &&
+      writeFileAtomically(
+          getCachePath(CacheDir, Result.ResultHash + ".stderr"), Diagnostics))
+    return;
+  if (writeFileAtomically(getCachePath(CacheDir, Result.ResultHash + ".o"),
+                          (*Object)->getBuffer()))
+    return;
+
+  // Add the result to the manifest, dropping the oldest results.
+  std::string ManifestPath = getCachePath(CacheDir, Key + ".manifest");
+  std::vector<ManifestResult> Results;
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Manifest =
+          llvm::MemoryBuffer::getFile(ManifestPath))
+    Results = parseManifest((*Manifest)->getBuffer());
+  Results.erase(std::remove_if(Results.begin(), Results.end(),
+                               [&](const ManifestResult &R) {
+                                 return R.ResultHash == Result.ResultHash;
+                               }),
+                Results.end());
+  Results.push_back(std::move(Result));
+  if (Results.size() > MaxManifestResults)
+    Results.erase(Results.begin(),
+                  Results.begin() + (Results.size() - MaxManifestResults));
+
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  for (const ManifestResult &R : Results) {
+    OS << "result\t" << R.ResultHash << "\n";
+    for (const auto &Dependency : R.Dependencies)
+      OS << "dep\t" << Dependency.first << "\t" << Dependency.second << "\n";
+    OS << "end\n";
+  }
+  OS.flush();
+  writeFileAtomically(ManifestPath, Contents);
+}
+
+bool clang::driver::executeWithCompileCache(StringRef CacheDir,
+                                            const Command &C, int &Res,
+                                            std::string *ErrMsg,
+                                            bool *ExecutionFailed) {
+  const llvm::opt::ArgStringList &Args = C.getArguments();
+  StringRef Output;
+  if (!isCacheable(Args, Output))
+    return false;
+
+  std::string Key = getJobKey(C.getExecutable(), Args);
+  if (replayResult(CacheDir, Key, Output)) {
+    Res = 0;
+    return true;
+  }
+
+  // Run the job, collecting its dependencies and its diagnostics.
+  SmallString<128> DepFile, DiagFile;
+  if (llvm::sys::fs::createTemporaryFile("compile-cache", "d", DepFile))
+    return false;
+  if (llvm::sys::fs::createTemporaryFile("compile-cache", "stderr",
+                                         DiagFile)) {
+    llvm::sys::fs::remove(DepFile);
+    return false;
+  }
+
+  llvm::opt::ArgStringList CachingArgs(Args);
+  CachingArgs.push_back("-dependency-file");
+  CachingArgs.push_back(DepFile.c_str());
+  CachingArgs.push_back("-MT");
+  CachingArgs.push_back(DependencyTarget);
+  CachingArgs.push_back("-sys-header-deps");
+  Command CachingCommand(C);
+  CachingCommand.replaceArguments(CachingArgs);
+
+  StringRef DiagFileRef = DiagFile;
+  const StringRef *Redirects[] = {nullptr, nullptr, &DiagFileRef};
+  bool Failed = false;
+  Res = CachingCommand.Execute(Redirects, ErrMsg, &Failed);
+  if (ExecutionFailed)
+    *ExecutionFailed = Failed;
+
+  std::string Diagnostics;
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> DiagBuffer =
+          llvm::MemoryBuffer::getFile(DiagFile))
+    Diagnostics = (*DiagBuffer)->getBuffer();
+  llvm::errs() << Diagnostics;
+
+  if (!Res && !Failed)
+    storeResult(CacheDir, Key, Output, Diagnostics, DepFile);
+
+  llvm::sys::fs::remove(DepFile);
+  llvm::sys::fs::remove(DiagFile);
+  return true;
+}
@@ -0,0 +1,41 @@
+//===--- CompileCache.h - Cache of Compile Job Results ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_DRIVER_COMPILECACHE_H
+#define LLVM_CLANG_LIB_DRIVER_COMPILECACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+namespace driver {
+class Command;
+
+/// Run the clang -cc1 job \p C through the cache of compile results in
+/// \p CacheDir, selected with -fcompile-cache-dir=.
+///
+/// A job is keyed on the compiler version, its working directory and its
+/// arguments other than the name of its output. Each key has a manifest
+/// which lists, for every result stored for it, the files the job read and
+/// the hashes of their contents, as found from a dependency file written by
+/// the job which produced the result. When all the files of a result still
+/// have those contents, the job is not run: its object file is copied from
+/// the cache, and the diagnostics it printed are printed again.
+///
+/// \returns false if \p C cannot be cached and needs to be executed as
+/// usual. Otherwise \p Res, \p ErrMsg and \p ExecutionFailed are set like
+/// Command::Execute sets them.
+bool executeWithCompileCache(StringRef CacheDir, const Command &C, int &Res,
+                             std::string *ErrMsg, bool *ExecutionFailed);
+
+} // end namespace driver
+} // end namespace clang
+
+#endif
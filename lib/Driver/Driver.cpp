@@ -55,12 +55,14 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
                IntrusiveRefCntPtr<vfs::FileSystem> VFS)
     : Opts(createDriverOptTable()), Diags(Diags), VFS(std::move(VFS)),
       Mode(GCCMode), SaveTemps(SaveTempsNone), BitcodeEmbed(EmbedNone),
-      LTOMode(LTOK_None), ClangExecutable(ClangExecutable),
+      LTOMode(LTOK_None), NumParallelJobs(1), ClangExecutable(ClangExecutable),
       SysRoot(DEFAULT_SYSROOT), UseStdLib(true),
       DriverTitle("clang LLVM compiler"), CCPrintOptionsFilename(nullptr),
       CCPrintHeadersFilename(nullptr), CCLogDiagnosticsFilename(nullptr),
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-      CCGenDiagnostics(false), DefaultTargetTriple(DefaultTargetTriple),
+      CCGenDiagnostics(false), CC1Runner(nullptr),
+      CC1RunnerIsThreadSafe(false), CC1RunnerName(nullptr),
+      DefaultTargetTriple(DefaultTargetTriple),
       CCCGenericGCCName(""), CheckInputsExist(true), CCCUsePCH(true),
       SuppressMissingInputWarning(false) {
 
@@ -599,6 +601,14 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // Ignore -pipe.
   Args.ClaimAllArgs(options::OPT_pipe);
 
+  // -fintegrated-cc1 is handled by the driver's main.
+  Args.ClaimAllArgs(options::OPT_fintegrated_cc1);
+  Args.ClaimAllArgs(options::OPT_fno_integrated_cc1);
+
+  // --toolchain-cache is only used by the toolchains that detect a GCC
+  // installation.
+  Args.ClaimAllArgs(options::OPT_toolchain_cache_EQ);
+
   // Extract -ccc args.
   //
   // FIXME: We need to figure out where this behavior should live. Most of it
@@ -648,6 +658,22 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
 
   setLTOMode(Args);
 
+  // Process -fparallel-jobs= flags.
+  if (const Arg *A = Args.getLastArg(options::OPT_fparallel_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    unsigned Jobs;
+    if (Value.getAsInteger(10, Jobs) || Jobs == 0)
+      Diags.Report(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                                    << Value;
+    else
+      NumParallelJobs = Jobs;
+  }
+
+  // Process -fcompile-cache-dir= flags. Jobs with a fallback are always run.
+  if (const Arg *A = Args.getLastArg(options::OPT_fcompile_cache_dir_EQ))
+    if (!Args.hasArg(options::OPT__SLASH_fallback))
+      CompileCacheDir = A->getValue();
+
   // Process -fembed-bitcode= flags.
   if (Arg *A = Args.getLastArg(options::OPT_fembed_bitcode_EQ)) {
     StringRef Name = A->getValue();
@@ -1010,7 +1036,11 @@ int Driver::ExecuteCompilation(
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) {
   // Just print if -### was present.
   if (C.getArgs().hasArg(options::OPT__HASH_HASH_HASH)) {
-    C.getJobs().Print(llvm::errs(), "\n", true);
+    for (const Command &Job : C.getJobs()) {
+      if (CC1RunnerName && C.isRunWithCC1Runner(Job))
+        llvm::errs() << " (" << CC1RunnerName << ")\n";
+      Job.Print(llvm::errs(), "\n", true);
+    }
     return 0;
   }
 
@@ -23,6 +23,7 @@
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include <cstdio>
@@ -49,7 +50,8 @@ using namespace llvm::opt;
 
 MSVCToolChain::MSVCToolChain(const Driver &D, const llvm::Triple& Triple,
                              const ArgList &Args)
-  : ToolChain(D, Triple, Args) {
+  : ToolChain(D, Triple, Args),
+    ToolchainCacheFile(Args.getLastArgValue(options::OPT_toolchain_cache_EQ)) {
   getProgramPaths().push_back(getDriver().getInstalledDir());
   if (getDriver().getInstalledDir() != getDriver().Dir)
     getProgramPaths().push_back(getDriver().Dir);
@@ -223,6 +225,80 @@ static bool getSystemRegistryString(const char *keyPath, const char *valueName,
 #endif // USE_WIN32
 }
 
+/// \brief Returns the last write time of the HKLM registry key \p keyPath,
+/// which changes whenever a value or a subkey of it is added, removed or
+/// changed.
+static uint64_t getRegistryKeyStamp(const std::string &keyPath) {
+#ifndef USE_WIN32
+  return MissingPathStamp;
+#else
+  HKEY hKey = NULL;
+  if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, keyPath.c_str(), 0,
+                    KEY_READ | KEY_WOW64_32KEY, &hKey) != ERROR_SUCCESS)
+    return MissingPathStamp;
+  FILETIME lastWriteTime;
+  long lResult = RegQueryInfoKeyA(hKey, NULL, NULL, NULL, NULL, NULL, NULL,
+                                  NULL, NULL, NULL, NULL, &lastWriteTime);
+  RegCloseKey(hKey);
+  if (lResult != ERROR_SUCCESS)
+    return MissingPathStamp;
+  return (uint64_t(lastWriteTime.dwHighDateTime) << 32) |
+         lastWriteTime.dwLowDateTime;
+#endif // USE_WIN32
+}
+
+namespace {
+
+/// \brief The registry keys and the directories which the detection of the
+/// Visual Studio and Windows SDK installations read, with their stamps as
+/// lines of a --toolchain-cache entry.
+class InstallationProbes {
+  vfs::FileSystem &FS;
+  std::string Lines;
+
+public:
+  InstallationProbes(vfs::FileSystem &FS) : FS(FS) {}
+
+  void addRegistryKey(const std::string &keyPath) {
+    Lines += "registry\t" + std::to_string(getRegistryKeyStamp(keyPath)) +
+             "\t" + keyPath + "\n";
+  }
+
+  void addPath(StringRef Path) {
+    Lines += "stamp\t" + std::to_string(getPathStamp(Path, FS)) + "\t" +
+             Path.str() + "\n";
+  }
+
+  StringRef getLines() const { return Lines; }
+};
+
+} // end anonymous namespace
+
+/// \brief Like getSystemRegistryString, and records the registry keys the
+/// result depends on in \p Probes.
+static bool getProbedRegistryString(const char *keyPath, const char *valueName,
+                                    std::string &value, std::string *phValue,
+                                    InstallationProbes &Probes) {
+  std::string bestName;
+  bool returnValue =
+      getSystemRegistryString(keyPath, valueName, value, &bestName);
+  StringRef Key = keyPath;
+  size_t Placeholder = Key.find("\\$VERSION");
+  if (Placeholder == StringRef::npos) {
+    Probes.addRegistryKey(Key.str());
+  } else {
+    // Versions are found among the subkeys of the parent key, and the value
+    // is read from the key of the best one.
+    StringRef ParentKey = Key.substr(0, Placeholder);
+    Probes.addRegistryKey(ParentKey.str());
+    if (returnValue)
+      Probes.addRegistryKey((ParentKey + "\\" + bestName).str());
+  }
+  if (phValue)
+    *phValue = std::move(bestName);
+  return returnValue;
+}
+
 // Convert LLVM's ArchType
 // to the corresponding name of Windows SDK libraries subfolder
 static StringRef getWindowsSDKArch(llvm::Triple::ArchType Arch) {
@@ -243,12 +319,14 @@ static StringRef getWindowsSDKArch(llvm::Triple::ArchType Arch) {
 // directory by name and uses the last one of the list.
 // So we compare entry names lexicographically to find the greatest one.
 static bool getWindows10SDKVersion(const std::string &SDKPath,
-                                   std::string &SDKVersion) {
+                                   std::string &SDKVersion,
+                                   InstallationProbes &Probes) {
   SDKVersion.clear();
 
   std::error_code EC;
   llvm::SmallString<128> IncludePath(SDKPath);
   llvm::sys::path::append(IncludePath, "Include");
+  Probes.addPath(IncludePath);
   for (llvm::sys::fs::directory_iterator DirIt(IncludePath, EC), DirEnd;
        DirIt != DirEnd && !EC; DirIt.increment(EC)) {
     if (!llvm::sys::fs::is_directory(DirIt->path()))
@@ -266,15 +344,16 @@ static bool getWindows10SDKVersion(const std::string &SDKPath,
   return !SDKVersion.empty();
 }
 
-/// \brief Get Windows SDK installation directory.
-bool MSVCToolChain::getWindowsSDKDir(std::string &Path, int &Major,
-                                     std::string &WindowsSDKIncludeVersion,
-                                     std::string &WindowsSDKLibVersion) const {
+/// \brief Find the Windows SDK installation directory.
+static bool detectWindowsSDKDir(std::string &Path, int &Major,
+                                std::string &WindowsSDKIncludeVersion,
+                                std::string &WindowsSDKLibVersion,
+                                InstallationProbes &Probes) {
   std::string RegistrySDKVersion;
   // Try the Windows registry.
-  if (!getSystemRegistryString(
+  if (!getProbedRegistryString(
           "SOFTWARE\\Microsoft\\Microsoft SDKs\\Windows\\$VERSION",
-          "InstallationFolder", Path, &RegistrySDKVersion))
+          "InstallationFolder", Path, &RegistrySDKVersion, Probes))
     return false;
   if (Path.empty() || RegistrySDKVersion.empty())
     return false;
@@ -290,6 +369,9 @@ bool MSVCToolChain::getWindowsSDKDir(std::string &Path, int &Major,
     // version of the OS you're targeting.  By default choose the newest, which
     // usually corresponds to the version of the OS you've installed the SDK on.
     const char *Tests[] = {"winv6.3", "win8", "win7"};
+    llvm::SmallString<128> LibPath(Path);
+    llvm::sys::path::append(LibPath, "Lib");
+    Probes.addPath(LibPath);
     for (const char *Test : Tests) {
       llvm::SmallString<128> TestPath(Path);
       llvm::sys::path::append(TestPath, "Lib", Test);
@@ -301,7 +383,7 @@ bool MSVCToolChain::getWindowsSDKDir(std::string &Path, int &Major,
     return !WindowsSDKLibVersion.empty();
   }
   if (Major == 10) {
-    if (!getWindows10SDKVersion(Path, WindowsSDKIncludeVersion))
+    if (!getWindows10SDKVersion(Path, WindowsSDKIncludeVersion, Probes))
       return false;
     WindowsSDKLibVersion = WindowsSDKIncludeVersion;
     return true;
@@ -310,6 +392,18 @@ bool MSVCToolChain::getWindowsSDKDir(std::string &Path, int &Major,
   return false;
 }
 
+/// \brief Get Windows SDK installation directory.
+bool MSVCToolChain::getWindowsSDKDir(std::string &Path, int &Major,
+                                     std::string &WindowsSDKIncludeVersion,
+                                     std::string &WindowsSDKLibVersion) const {
+  const Installation &I = getInstallation();
+  Path = I.WindowsSDKDir;
+  Major = I.WindowsSDKMajor;
+  WindowsSDKIncludeVersion = I.WindowsSDKIncludeVersion;
+  WindowsSDKLibVersion = I.WindowsSDKLibVersion;
+  return I.HasWindowsSDK;
+}
+
 // Gets the library path required to link against the Windows SDK.
 bool MSVCToolChain::getWindowsSDKLibraryPath(std::string &path) const {
   std::string sdkPath;
@@ -359,16 +453,25 @@ bool clang::driver::toolchains::MSVCToolChain::useUniversalCRT(
   return !llvm::sys::fs::exists(TestPath);
 }
 
-bool MSVCToolChain::getUniversalCRTSdkDir(std::string &Path,
-                                          std::string &UCRTVersion) const {
+static bool detectUniversalCRTSdkDir(std::string &Path,
+                                     std::string &UCRTVersion,
+                                     InstallationProbes &Probes) {
   // vcvarsqueryregistry.bat for Visual Studio 2015 queries the registry
   // for the specific key "KitsRoot10". So do we.
-  if (!getSystemRegistryString(
+  if (!getProbedRegistryString(
           "SOFTWARE\\Microsoft\\Windows Kits\\Installed Roots", "KitsRoot10",
-          Path, nullptr))
+          Path, nullptr, Probes))
     return false;
 
-  return getWindows10SDKVersion(Path, UCRTVersion);
+  return getWindows10SDKVersion(Path, UCRTVersion, Probes);
+}
+
+bool MSVCToolChain::getUniversalCRTSdkDir(std::string &Path,
+                                          std::string &UCRTVersion) const {
+  const Installation &I = getInstallation();
+  Path = I.UniversalCRTSdkDir;
+  UCRTVersion = I.UCRTVersion;
+  return I.HasUniversalCRT;
 }
 
 bool MSVCToolChain::getUniversalCRTLibraryPath(std::string &Path) const {
@@ -520,8 +623,9 @@ VersionTuple MSVCToolChain::getMSVCVersionFromExe() const {
   return Version;
 }
 
-// Get Visual Studio installation directory.
-bool MSVCToolChain::getVisualStudioInstallDir(std::string &path) const {
+// Find Visual Studio installation directory.
+static bool detectVisualStudioInstallDir(std::string &path,
+                                         InstallationProbes &Probes) {
   // First check the environment variables that vsvars32.bat sets.
   if (llvm::Optional<std::string> VcInstallDir =
           llvm::sys::Process::GetEnv("VCINSTALLDIR")) {
@@ -534,16 +638,17 @@ bool MSVCToolChain::getVisualStudioInstallDir(std::string &path) const {
   std::string vsExpressIDEInstallDir;
   // Then try the windows registry.
   bool hasVCDir =
-      getSystemRegistryString("SOFTWARE\\Microsoft\\VisualStudio\\$VERSION",
-                              "InstallDir", vsIDEInstallDir, nullptr);
+      getProbedRegistryString("SOFTWARE\\Microsoft\\VisualStudio\\$VERSION",
+                              "InstallDir", vsIDEInstallDir, nullptr, Probes);
   if (hasVCDir && !vsIDEInstallDir.empty()) {
     path = vsIDEInstallDir.substr(0, vsIDEInstallDir.find("\\Common7\\IDE"));
     return true;
   }
 
   bool hasVCExpressDir =
-      getSystemRegistryString("SOFTWARE\\Microsoft\\VCExpress\\$VERSION",
-                              "InstallDir", vsExpressIDEInstallDir, nullptr);
+      getProbedRegistryString("SOFTWARE\\Microsoft\\VCExpress\\$VERSION",
+                              "InstallDir", vsExpressIDEInstallDir, nullptr,
+                              Probes);
   if (hasVCExpressDir && !vsExpressIDEInstallDir.empty()) {
     path = vsExpressIDEInstallDir.substr(
         0, vsIDEInstallDir.find("\\Common7\\IDE"));
@@ -576,6 +681,126 @@ bool MSVCToolChain::getVisualStudioInstallDir(std::string &path) const {
   return false;
 }
 
+// Get Visual Studio installation directory.
+bool MSVCToolChain::getVisualStudioInstallDir(std::string &path) const {
+  const Installation &I = getInstallation();
+  path = I.VSInstallDir;
+  return I.HasVSInstallDir;
+}
+
+/// The environment variables which the detection of the Visual Studio
+/// installation reads.
+static const char *const InstallationEnvVars[] = {
+    "VCINSTALLDIR", "VS120COMNTOOLS", "VS100COMNTOOLS", "VS90COMNTOOLS",
+    "VS80COMNTOOLS"};
+
+const MSVCToolChain::Installation &MSVCToolChain::getInstallation() const {
+  if (DetectedInstallation)
+    return *DetectedInstallation;
+  DetectedInstallation = Installation();
+  Installation &I = *DetectedInstallation;
+
+  // The detection does not depend on the target, so that an entry is shared
+  // by all the MSVC targets.
+  std::string Key = "msvc";
+  for (const char *Var : InstallationEnvVars)
+    if (llvm::Optional<std::string> Value = llvm::sys::Process::GetEnv(Var))
+      Key += (Twine("\t") + Var + "=" + *Value).str();
+
+  auto ParseEntry = [&](ArrayRef<StringRef> Lines) {
+    bool HaveVS = false, HaveSDK = false, HaveUCRT = false;
+    for (StringRef Line : Lines) {
+      SmallVector<StringRef, 8> Fields;
+      Line.split(Fields, '\t');
+      if (Fields[0] == "vs" && Fields.size() == 3) {
+        I.HasVSInstallDir = Fields[1] == "1";
+        I.VSInstallDir = Fields[2];
+        HaveVS = true;
+      } else if (Fields[0] == "sdk" && Fields.size() == 6) {
+        I.HasWindowsSDK = Fields[1] == "1";
+        if (Fields[2].getAsInteger(10, I.WindowsSDKMajor))
+          return false;
+        I.WindowsSDKDir = Fields[3];
+        I.WindowsSDKIncludeVersion = Fields[4];
+        I.WindowsSDKLibVersion = Fields[5];
+        HaveSDK = true;
+      } else if (Fields[0] == "ucrt" && Fields.size() == 4) {
+        I.HasUniversalCRT = Fields[1] == "1";
+        I.UniversalCRTSdkDir = Fields[2];
+        I.UCRTVersion = Fields[3];
+        HaveUCRT = true;
+      } else if (Fields[0] == "stamp" && Fields.size() == 3) {
+        uint64_t Stamp;
+        if (Fields[1].getAsInteger(10, Stamp) ||
+            getPathStamp(Fields[2], getVFS()) != Stamp)
+          return false;
+      } else if (Fields[0] == "registry" && Fields.size() == 3) {
+        uint64_t Stamp;
+        if (Fields[1].getAsInteger(10, Stamp) ||
+            getRegistryKeyStamp(Fields[2]) != Stamp)
+          return false;
+      } else {
+        return false;
+      }
+    }
+    return HaveVS && HaveSDK && HaveUCRT;
+  };
+
+  if (!ToolchainCacheFile.empty()) {
+    bool Loaded = false;
+    if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+            llvm::MemoryBuffer::getFile(ToolchainCacheFile))
+      forEachToolchainCacheEntry(
+          (*File)->getBuffer(),
+          [&](StringRef EntryKey, ArrayRef<StringRef> Lines) {
+            if (EntryKey == Key)
+              Loaded = ParseEntry(Lines);
+          });
+    if (Loaded)
+      return I;
+    I = Installation();
+  }
+
+  InstallationProbes Probes(getVFS());
+  I.HasVSInstallDir = detectVisualStudioInstallDir(I.VSInstallDir, Probes);
+  I.HasWindowsSDK =
+      detectWindowsSDKDir(I.WindowsSDKDir, I.WindowsSDKMajor,
+                          I.WindowsSDKIncludeVersion, I.WindowsSDKLibVersion,
+                          Probes);
+  I.HasUniversalCRT =
+      detectUniversalCRTSdkDir(I.UniversalCRTSdkDir, I.UCRTVersion, Probes);
+  if (ToolchainCacheFile.empty())
+    return I;
+
+  // The fields of the file are separated by tabs and newlines.
+  auto IsStorable = [](StringRef Field) {
+    return Field.find_first_of("\t\n") == StringRef::npos;
+  };
+  if (!IsStorable(I.VSInstallDir) || !IsStorable(I.WindowsSDKDir) ||
+      !IsStorable(I.WindowsSDKIncludeVersion) ||
+      !IsStorable(I.WindowsSDKLibVersion) ||
+      !IsStorable(I.UniversalCRTSdkDir) || !IsStorable(I.UCRTVersion))
+    return I;
+  SmallVector<StringRef, 16> ProbeLines;
+  Probes.getLines().split(ProbeLines, '\n', -1, /*KeepEmpty=*/false);
+  for (StringRef Line : ProbeLines)
+    if (Line.count('\t') != 2)
+      return I;
+
+  std::string Lines;
+  llvm::raw_string_ostream OS(Lines);
+  OS << "vs\t" << I.HasVSInstallDir << "\t" << I.VSInstallDir << "\n"
+     << "sdk\t" << I.HasWindowsSDK << "\t" << I.WindowsSDKMajor << "\t"
+     << I.WindowsSDKDir << "\t" << I.WindowsSDKIncludeVersion << "\t"
+     << I.WindowsSDKLibVersion << "\n"
+     << "ucrt\t" << I.HasUniversalCRT << "\t" << I.UniversalCRTSdkDir << "\t"
+     << I.UCRTVersion << "\n"
+     << Probes.getLines();
+  OS.flush();
+  saveToolchainCacheEntry(ToolchainCacheFile, Key, Lines);
+  return I;
+}
+
 void MSVCToolChain::AddSystemIncludeWithSubfolder(
     const ArgList &DriverArgs, ArgStringList &CC1Args,
     const std::string &folder, const Twine &subfolder1, const Twine &subfolder2,
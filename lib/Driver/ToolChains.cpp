@@ -9,6 +9,7 @@
 
 #include "ToolChains.h"
 #include "clang/Basic/Cuda.h"
+#include "clang/Basic/FileUtilities.h"
 #include "clang/Basic/ObjCRuntime.h"
 #include "clang/Basic/Version.h"
 #include "clang/Basic/VirtualFileSystem.h"
@@ -35,6 +36,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/TargetParser.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
 #include <cstdlib> // ::getenv
 #include <system_error>
 
@@ -1404,9 +1406,29 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args) {
 /// should instead pull the target out of the driver. This is currently
 /// necessary because the driver doesn't store the final version of the target
 /// triple.
+///
+/// With --toolchain-cache=<file>, the result is read from the cache file when
+/// none of the paths probed by the detection that wrote it have changed since.
 void Generic_GCC::GCCInstallationDetector::init(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     ArrayRef<std::string> ExtraTripleAliases) {
+  StringRef CacheFile = Args.getLastArgValue(options::OPT_toolchain_cache_EQ);
+  if (CacheFile.empty())
+    return detect(TargetTriple, Args, ExtraTripleAliases);
+
+  std::string Key = getCacheKey(TargetTriple, Args, ExtraTripleAliases);
+  if (loadFromCache(CacheFile, Key, TargetTriple, Args))
+    return;
+
+  RecordProbes = true;
+  detect(TargetTriple, Args, ExtraTripleAliases);
+  RecordProbes = false;
+  saveToCache(CacheFile, Key);
+}
+
+void Generic_GCC::GCCInstallationDetector::detect(
+    const llvm::Triple &TargetTriple, const ArgList &Args,
+    ArrayRef<std::string> ExtraTripleAliases) {
   llvm::Triple BiarchVariantTriple = TargetTriple.isArch32Bit()
                                          ? TargetTriple.get64BitArchVariant()
                                          : TargetTriple.get32BitArchVariant();
@@ -1475,10 +1497,12 @@ void Generic_GCC::GCCInstallationDetector::init(
   // installation available. GCC installs are ranked by version number.
   Version = GCCVersion::Parse("0.0.0");
   for (const std::string &Prefix : Prefixes) {
+    recordProbe(Prefix);
     if (!D.getVFS().exists(Prefix))
       continue;
     for (StringRef Suffix : CandidateLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      recordProbe(LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : ExtraTripleAliases) // Try these first.
@@ -1488,6 +1512,7 @@ void Generic_GCC::GCCInstallationDetector::init(
     }
     for (StringRef Suffix : CandidateBiarchLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      recordProbe(LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : CandidateBiarchTripleAliases)
@@ -1497,6 +1522,199 @@ void Generic_GCC::GCCInstallationDetector::init(
   }
 }
 
+uint64_t toolchains::getPathStamp(StringRef Path, vfs::FileSystem &FS) {
+  llvm::ErrorOr<vfs::Status> Status = FS.status(Path);
+  if (!Status)
+    return MissingPathStamp;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Status->getLastModificationTime().time_since_epoch())
+      .count();
+}
+
+void toolchains::forEachToolchainCacheEntry(
+    StringRef Contents,
+    llvm::function_ref<void(StringRef Key, ArrayRef<StringRef> Lines)> Visit) {
+  SmallVector<StringRef, 64> Lines;
+  Contents.split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  size_t I = 0;
+  while (I != Lines.size()) {
+    if (!Lines[I].startswith("key\t")) {
+      ++I;
+      continue;
+    }
+    size_t End = I + 1;
+    while (End != Lines.size() && Lines[End] != "end" &&
+           !Lines[End].startswith("key\t"))
+      ++End;
+    if (End == Lines.size() || Lines[End] != "end") {
+      // A truncated entry.
+      I = End;
+      continue;
+    }
+    Visit(Lines[I].substr(4), makeArrayRef(Lines).slice(I + 1, End - I - 1));
+    I = End + 1;
+  }
+}
+
+void toolchains::saveToolchainCacheEntry(StringRef CacheFile, StringRef Key,
+                                         StringRef Lines) {
+  if (Key.find('\n') != StringRef::npos)
+    return;
+
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  // Keep the entries for other keys.
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+          llvm::MemoryBuffer::getFile(CacheFile))
+    forEachToolchainCacheEntry((*File)->getBuffer(),
+                               [&](StringRef EntryKey,
+                                   ArrayRef<StringRef> EntryLines) {
+                                 if (EntryKey == Key)
+                                   return;
+                                 OS << "key\t" << EntryKey << "\n";
+                                 for (StringRef Line : EntryLines)
+                                   OS << Line << "\n";
+                                 OS << "end\n";
+                               });
+  OS << "key\t" << Key << "\n" << Lines << "end\n";
+  OS.flush();
+
+  // Concurrent compilations must never see a partially written cache.
+  writeFileAtomically(CacheFile, Contents);
+}
+
+void Generic_GCC::GCCInstallationDetector::recordProbe(StringRef Path) {
+  if (!RecordProbes)
+    return;
+  // A missing path is represented by its closest existing ancestor, whose
+  // modification time changes when the path is created.
+  while (true) {
+    uint64_t Stamp = getPathStamp(Path, D.getVFS());
+    StringRef Parent = llvm::sys::path::parent_path(Path);
+    if (Stamp != MissingPathStamp || Parent.empty()) {
+      ProbedPaths[Path] = Stamp;
+      return;
+    }
+    Path = Parent;
+  }
+}
+
+std::string Generic_GCC::GCCInstallationDetector::getCacheKey(
+    const llvm::Triple &TargetTriple, const ArgList &Args,
+    ArrayRef<std::string> ExtraTripleAliases) const {
+  // Everything other than the file system that the detection depends on.
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << TargetTriple.str() << "\tsysroot=" << D.SysRoot
+     << "\tinstalled=" << D.InstalledDir
+     << "\tgcc-toolchain=" << getGCCToolchainDir(Args);
+  for (const std::string &Dir : D.PrefixDirs)
+    OS << "\tprefix=" << Dir;
+  for (const std::string &Alias : ExtraTripleAliases)
+    OS << "\talias=" << Alias;
+  // The multilib selection depends on the -m flags.
+  for (const Arg *A : Args.filtered(options::OPT_m_Group))
+    OS << "\t" << A->getAsString(Args);
+  return OS.str();
+}
+
+bool Generic_GCC::GCCInstallationDetector::loadFromCache(
+    StringRef CacheFile, StringRef Key, const llvm::Triple &TargetTriple,
+    const ArgList &Args) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+      llvm::MemoryBuffer::getFile(CacheFile);
+  if (!File)
+    return false;
+
+  ArrayRef<StringRef> Entry;
+  bool Found = false;
+  forEachToolchainCacheEntry((*File)->getBuffer(),
+                             [&](StringRef EntryKey, ArrayRef<StringRef> Lines) {
+                               if (EntryKey == Key) {
+                                 Entry = Lines;
+                                 Found = true;
+                               }
+                             });
+  if (!Found)
+    return false;
+
+  auto ParseEntry = [&]() {
+    bool HaveResult = false;
+    for (StringRef Line : Entry) {
+      SmallVector<StringRef, 8> Fields;
+      Line.split(Fields, '\t');
+      if (Fields[0] == "result" && Fields.size() == 7) {
+        unsigned Valid, ScanKind;
+        if (Fields[1].getAsInteger(10, Valid) ||
+            Fields[2].getAsInteger(10, ScanKind) ||
+            ScanKind > BiarchMultilibScan)
+          return false;
+        IsValid = Valid;
+        InstallMultilibScan = static_cast<MultilibScanKind>(ScanKind);
+        GCCTriple.setTriple(Fields[3]);
+        Version = GCCVersion::Parse(Fields[4]);
+        GCCInstallPath = Fields[5];
+        GCCParentLibPath = Fields[6];
+        HaveResult = true;
+      } else if (Fields[0] == "candidate" && Fields.size() == 2) {
+        CandidateGCCInstallPaths.insert(Fields[1]);
+      } else if (Fields[0] == "stamp" && Fields.size() == 3) {
+        uint64_t Stamp;
+        if (Fields[1].getAsInteger(10, Stamp) ||
+            getPathStamp(Fields[2], D.getVFS()) != Stamp)
+          return false;
+      } else {
+        return false;
+      }
+    }
+    return HaveResult;
+  };
+
+  // The multilibs are not cached; they are found again in the install path,
+  // which is quick.
+  if (ParseEntry() &&
+      (!IsValid || InstallMultilibScan == NoMultilibScan ||
+       ScanGCCForMultilibs(TargetTriple, Args, GCCInstallPath,
+                           InstallMultilibScan == BiarchMultilibScan)))
+    return true;
+
+  // Start the detection from scratch.
+  IsValid = false;
+  InstallMultilibScan = NoMultilibScan;
+  GCCTriple = llvm::Triple();
+  GCCInstallPath.clear();
+  GCCParentLibPath.clear();
+  CandidateGCCInstallPaths.clear();
+  return false;
+}
+
+void Generic_GCC::GCCInstallationDetector::saveToCache(StringRef CacheFile,
+                                                       StringRef Key) const {
+  // The fields of the file are separated by tabs and newlines.
+  auto IsStorable = [](StringRef Field) {
+    return Field.find_first_of("\t\n") == StringRef::npos;
+  };
+  if (!IsStorable(GCCTriple.str()) || !IsStorable(Version.Text) ||
+      !IsStorable(GCCInstallPath) || !IsStorable(GCCParentLibPath) ||
+      !llvm::all_of(CandidateGCCInstallPaths, IsStorable))
+    return;
+
+  std::string Lines;
+  llvm::raw_string_ostream OS(Lines);
+  OS << "result\t" << IsValid << "\t" << InstallMultilibScan << "\t"
+     << GCCTriple.str() << "\t" << Version.Text << "\t" << GCCInstallPath
+     << "\t" << GCCParentLibPath << "\n";
+  for (const std::string &Path : CandidateGCCInstallPaths)
+    OS << "candidate\t" << Path << "\n";
+  for (const auto &Probe : ProbedPaths) {
+    if (!IsStorable(Probe.first()))
+      return;
+    OS << "stamp\t" << Probe.second << "\t" << Probe.first() << "\n";
+  }
+  OS.flush();
+  saveToolchainCacheEntry(CacheFile, Key, Lines);
+}
+
 void Generic_GCC::GCCInstallationDetector::print(raw_ostream &OS) const {
   for (const auto &InstallPath : CandidateGCCInstallPaths)
     OS << "Found candidate GCC installation: " << InstallPath << "\n";
@@ -2706,6 +2924,7 @@ void Generic_GCC::GCCInstallationDetector::scanLibDirForGCCTripleSolaris(
   // Solaris is a special case. The GCC installation is under
   // /usr/gcc/<major>.<minor>/lib/gcc/<triple>/<major>.<minor>.<patch>/, so we
   // need to iterate twice.
+  recordProbe(LibDir);
   std::error_code EC;
   for (vfs::directory_iterator LI = D.getVFS().dir_begin(LibDir, EC), LE;
        !EC && LI != LE; LI = LI.increment(EC)) {
@@ -2722,6 +2941,7 @@ void Generic_GCC::GCCInstallationDetector::scanLibDirForGCCTripleSolaris(
 
     GCCInstallPath =
         LibDir + "/" + VersionText.str() + "/lib/gcc/" + CandidateTriple.str();
+    recordProbe(GCCInstallPath);
     if (!D.getVFS().exists(GCCInstallPath))
       continue;
 
@@ -2746,6 +2966,7 @@ void Generic_GCC::GCCInstallationDetector::scanLibDirForGCCTripleSolaris(
     GCCParentLibPath = GCCInstallPath + "/../../../../";
 
     IsValid = true;
+    InstallMultilibScan = NoMultilibScan;
   }
 }
 
@@ -2816,6 +3037,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
                                    (TargetArch != llvm::Triple::x86));
   for (unsigned i = 0; i < NumLibSuffixes; ++i) {
     StringRef LibSuffix = LibAndInstallSuffixes[i][0];
+    recordProbe(LibDir + LibSuffix.str());
     std::error_code EC;
     for (vfs::directory_iterator
              LI = D.getVFS().dir_begin(LibDir + LibSuffix, EC),
@@ -2831,6 +3053,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       if (CandidateVersion <= Version)
         continue;
 
+      recordProbe(LI->getName());
       if (!ScanGCCForMultilibs(TargetTriple, Args, LI->getName(),
                                NeedsBiarchSuffix))
         continue;
@@ -2844,6 +3067,8 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
           LibDir + LibAndInstallSuffixes[i][0] + "/" + VersionText.str();
       GCCParentLibPath = GCCInstallPath + LibAndInstallSuffixes[i][1];
       IsValid = true;
+      InstallMultilibScan =
+          NeedsBiarchSuffix ? BiarchMultilibScan : MultilibScan;
     }
   }
 }
@@ -2851,9 +3076,11 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
 bool Generic_GCC::GCCInstallationDetector::ScanGentooGccConfig(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     StringRef CandidateTriple, bool NeedsBiarchSuffix) {
+  const std::string ConfigPath =
+      D.SysRoot + "/etc/env.d/gcc/config-" + CandidateTriple.str();
+  recordProbe(ConfigPath);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
-      D.getVFS().getBufferForFile(D.SysRoot + "/etc/env.d/gcc/config-" +
-                                  CandidateTriple.str());
+      D.getVFS().getBufferForFile(ConfigPath);
   if (File) {
     SmallVector<StringRef, 2> Lines;
     File.get()->getBuffer().split(Lines, "\n");
@@ -2868,6 +3095,8 @@ bool Generic_GCC::GCCInstallationDetector::ScanGentooGccConfig(
         const std::string GentooPath = D.SysRoot + "/usr/lib/gcc/" +
                                        ActiveVersion.first.str() + "/" +
                                        ActiveVersion.second.str();
+        recordProbe(GentooPath);
+        recordProbe(GentooPath + "/crtbegin.o");
         if (D.getVFS().exists(GentooPath + "/crtbegin.o")) {
           if (!ScanGCCForMultilibs(TargetTriple, Args, GentooPath,
                                    NeedsBiarchSuffix))
@@ -2878,6 +3107,8 @@ bool Generic_GCC::GCCInstallationDetector::ScanGentooGccConfig(
           GCCParentLibPath = GentooPath + "/../../..";
           GCCTriple.setTriple(ActiveVersion.first);
           IsValid = true;
+          InstallMultilibScan =
+              NeedsBiarchSuffix ? BiarchMultilibScan : MultilibScan;
           return true;
         }
       }
@@ -17,7 +17,9 @@
 #include "clang/Driver/Multilib.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 #include <set>
 #include <vector>
@@ -80,6 +82,32 @@ public:
 
 namespace toolchains {
 
+/// \name The --toolchain-cache file
+/// The results of the toolchains' installation detections, each as an entry
+/// of a 'key <key>' line, tab separated lines describing the result and the
+/// state of the file system it was found in, and an 'end' line.
+/// @{
+
+/// \brief The stamp of a path which does not exist.
+const uint64_t MissingPathStamp = ~0ULL;
+
+/// \brief Returns the modification time of \p Path, which for a directory
+/// changes whenever an entry is added to or removed from it.
+uint64_t getPathStamp(StringRef Path, vfs::FileSystem &FS);
+
+/// \brief Calls \p Visit with the key and the lines of each complete entry in
+/// the contents of a --toolchain-cache file.
+void forEachToolchainCacheEntry(
+    StringRef Contents,
+    llvm::function_ref<void(StringRef Key, ArrayRef<StringRef> Lines)> Visit);
+
+/// \brief Replaces the entry for \p Key in \p CacheFile with \p Lines, each
+/// of which ends in a newline. Failing to write the file is not an error.
+void saveToolchainCacheEntry(StringRef CacheFile, StringRef Key,
+                             StringRef Lines);
+
+/// @}
+
 /// Generic_GCC - A tool chain using the 'gcc' command to perform
 /// all subcommands; this relies on gcc translating the majority of
 /// command line options.
@@ -154,8 +182,22 @@ public:
     /// The set of multilibs that the detected installation supports.
     MultilibSet Multilibs;
 
+    /// How the multilibs of the detected installation were found, so that
+    /// this can be repeated for an installation loaded from a cache.
+    enum MultilibScanKind { NoMultilibScan, MultilibScan, BiarchMultilibScan };
+    MultilibScanKind InstallMultilibScan;
+
+    /// Whether to record the paths the detection depends on.
+    bool RecordProbes;
+
+    /// The stamp of each path the detection depended on, for a
+    /// --toolchain-cache file.
+    llvm::StringMap<uint64_t> ProbedPaths;
+
   public:
-    explicit GCCInstallationDetector(const Driver &D) : IsValid(false), D(D) {}
+    explicit GCCInstallationDetector(const Driver &D)
+        : IsValid(false), D(D), InstallMultilibScan(NoMultilibScan),
+          RecordProbes(false) {}
     void init(const llvm::Triple &TargetTriple, const llvm::opt::ArgList &Args,
               ArrayRef<std::string> ExtraTripleAliases = None);
 
@@ -188,6 +230,21 @@ public:
     void print(raw_ostream &OS) const;
 
   private:
+    void detect(const llvm::Triple &TargetTriple,
+                const llvm::opt::ArgList &Args,
+                ArrayRef<std::string> ExtraTripleAliases);
+
+    /// \brief Record that the detection depends on \p Path.
+    void recordProbe(StringRef Path);
+
+    std::string getCacheKey(const llvm::Triple &TargetTriple,
+                            const llvm::opt::ArgList &Args,
+                            ArrayRef<std::string> ExtraTripleAliases) const;
+    bool loadFromCache(StringRef CacheFile, StringRef Key,
+                       const llvm::Triple &TargetTriple,
+                       const llvm::opt::ArgList &Args);
+    void saveToCache(StringRef CacheFile, StringRef Key) const;
+
     static void
     CollectLibDirsAndTriples(const llvm::Triple &TargetTriple,
                              const llvm::Triple &BiarchTriple,
@@ -1189,6 +1246,29 @@ protected:
 private:
   VersionTuple getMSVCVersionFromTriple() const;
   VersionTuple getMSVCVersionFromExe() const;
+
+  /// The Visual Studio and Windows SDK installations found in the registry
+  /// and the file system.
+  struct Installation {
+    bool HasVSInstallDir = false;
+    std::string VSInstallDir;
+    bool HasWindowsSDK = false;
+    std::string WindowsSDKDir;
+    int WindowsSDKMajor = 0;
+    std::string WindowsSDKIncludeVersion;
+    std::string WindowsSDKLibVersion;
+    bool HasUniversalCRT = false;
+    std::string UniversalCRTSdkDir;
+    std::string UCRTVersion;
+  };
+
+  /// Returns the installations, detecting them the first time, unless they
+  /// can be read from the --toolchain-cache file because none of the
+  /// registry keys and directories the detection read have changed since.
+  const Installation &getInstallation() const;
+
+  std::string ToolchainCacheFile;
+  mutable llvm::Optional<Installation> DetectedInstallation;
 };
 
 class LLVM_LIBRARY_VISIBILITY CrossWindowsToolChain : public Generic_GCC {
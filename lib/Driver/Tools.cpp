@@ -27,6 +27,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Object/Archive.h"
@@ -692,9 +693,39 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
     A->render(Args, CmdArgs);
   }
 
-  Args.AddAllArgs(CmdArgs,
-                  {options::OPT_D, options::OPT_U, options::OPT_I_Group,
-                   options::OPT_F, options::OPT_index_header_map});
+  // Command lines generated by build systems can repeat the same -I and -D
+  // flags many times over; only render the first of them. A repeated search
+  // directory is dropped by the header search anyway, and defining a macro
+  // again to the same value does not change it. -index-header-map applies to
+  // the flag after it, so no flags are dropped when it is used.
+  bool DropRepeatedFlags = !Args.hasArg(options::OPT_index_header_map);
+  llvm::StringSet<> RenderedDirs;
+  llvm::StringMap<const Arg *> LastMacroFlags;
+  for (const Arg *A :
+       Args.filtered(options::OPT_D, options::OPT_U, options::OPT_I_Group,
+                     options::OPT_F, options::OPT_index_header_map)) {
+    A->claim();
+    if (DropRepeatedFlags) {
+      const Option &O = A->getOption();
+      if (O.matches(options::OPT_D) || O.matches(options::OPT_U)) {
+        StringRef Macro = A->getValue();
+        const Arg *&Last = LastMacroFlags[Macro.substr(
+            0, Macro.find_first_of("=("))];
+        bool IsRepeated = Last && O.matches(options::OPT_D) &&
+                          Last->getOption().matches(options::OPT_D) &&
+                          Macro == Last->getValue();
+        Last = A;
+        if (IsRepeated)
+          continue;
+      } else if (O.matches(options::OPT_I) || O.matches(options::OPT_F)) {
+        if (!RenderedDirs
+                 .insert((Twine(O.getID()) + ":" + A->getValue()).str())
+                 .second)
+          continue;
+      }
+    }
+    A->render(Args, CmdArgs);
+  }
 
   // Add -Wp, and -Xpreprocessor if using the preprocessor.
 
@@ -4258,6 +4289,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       D.Diag(diag::err_drv_argument_only_allowed_with) << A->getAsString(Args)
                                                        << "-x ir";
     Args.AddLastArg(CmdArgs, options::OPT_fthinlto_index_EQ);
+    Args.AddLastArg(CmdArgs, options::OPT_fthinlto_cache_dir_EQ);
   }
 
   // Embed-bitcode option.
@@ -4484,6 +4516,9 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   if (!Args.hasFlag(options::OPT_fstruct_path_tbaa,
                     options::OPT_fno_struct_path_tbaa))
     CmdArgs.push_back("-no-struct-path-tbaa");
+  if (Args.hasFlag(options::OPT_fprecise_struct_path_tbaa,
+                   options::OPT_fno_precise_struct_path_tbaa, false))
+    CmdArgs.push_back("-fprecise-struct-path-tbaa");
   if (Args.hasFlag(options::OPT_fstrict_enums, options::OPT_fno_strict_enums,
                    false))
     CmdArgs.push_back("-fstrict-enums");
@@ -4494,6 +4529,22 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_strict_vtable_pointers,
                    false))
     CmdArgs.push_back("-fstrict-vtable-pointers");
+  if (Args.hasFlag(options::OPT_fdevirtualize_internal_classes,
+                   options::OPT_fno_devirtualize_internal_classes, false))
+    CmdArgs.push_back("-fdevirtualize-internal-classes");
+  if (Args.hasFlag(options::OPT_ffold_global_initializers,
+                   options::OPT_fno_fold_global_initializers, false))
+    CmdArgs.push_back("-ffold-global-initializers");
+  if (Args.hasFlag(options::OPT_fshare_landing_pads,
+                   options::OPT_fno_share_landing_pads, false))
+    CmdArgs.push_back("-fshare-landing-pads");
+  if (Args.hasFlag(options::OPT_foutline_eh_cleanups,
+                   options::OPT_fno_outline_eh_cleanups, false))
+    CmdArgs.push_back("-foutline-eh-cleanups");
+  if (Args.hasFlag(options::OPT_fexperimental_relative_cxx_abi_vtables,
+                   options::OPT_fno_experimental_relative_cxx_abi_vtables,
+                   false))
+    CmdArgs.push_back("-fexperimental-relative-c++-abi-vtables");
   if (!Args.hasFlag(options::OPT_foptimize_sibling_calls,
                     options::OPT_fno_optimize_sibling_calls))
     CmdArgs.push_back("-mdisable-tail-calls");
@@ -4858,6 +4909,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(D.CCPrintHeadersFilename ? D.CCPrintHeadersFilename
                                                : "-");
   }
+  if (!D.CCGenDiagnostics)
+    Args.AddLastArg(CmdArgs, options::OPT_fheader_cost_file_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_P);
   Args.AddLastArg(CmdArgs, options::OPT_print_ivar_layout);
 
@@ -5079,6 +5132,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   CmdArgs.push_back(D.ResourceDir.c_str());
 
   Args.AddLastArg(CmdArgs, options::OPT_working_directory);
+  Args.AddLastArg(CmdArgs, options::OPT_index_store_path);
 
   bool ARCMTEnabled = false;
   if (!Args.hasArg(options::OPT_fno_objc_arc, options::OPT_fobjc_arc)) {
@@ -5349,6 +5403,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fdiagnostics_template_depth_EQ)) {
+    CmdArgs.push_back("-fdiagnostics-template-depth");
+    CmdArgs.push_back(A->getValue());
+  }
+
   if (Arg *A = Args.getLastArg(options::OPT_fconstexpr_backtrace_limit_EQ)) {
     CmdArgs.push_back("-fconstexpr-backtrace-limit");
     CmdArgs.push_back(A->getValue());
@@ -5500,7 +5559,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fobjc_sender_dependent_dispatch);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
+  Args.AddLastArg(CmdArgs, options::OPT_ftemplate_profile);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -5791,6 +5853,25 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(Args.MakeArgString(Path));
   }
 
+  // -fbuiltin-headers-pch precompiles the builtin headers included at the
+  // start of a file into a cache, which only makes sense without modules.
+  if (!HaveAnyModules && !C.isForDiagnostics() &&
+      Args.hasFlag(options::OPT_fbuiltin_headers_pch,
+                   options::OPT_fno_builtin_headers_pch, false)) {
+    SmallString<128> Path;
+    if (Arg *A = Args.getLastArg(options::OPT_fbuiltin_headers_pch_path))
+      Path = A->getValue();
+    if (Path.empty()) {
+      llvm::sys::path::system_temp_directory(/*erasedOnReboot=*/false, Path);
+      llvm::sys::path::append(Path, "org.llvm.clang.");
+      appendUserToPath(Path);
+      llvm::sys::path::append(Path, "BuiltinHeadersPCH");
+    }
+    const char Arg[] = "-fbuiltin-headers-pch-path=";
+    Path.insert(Path.begin(), Arg, Arg + strlen(Arg));
+    CmdArgs.push_back(Args.MakeArgString(Path));
+  }
+
   if (HaveAnyModules) {
     // -fprebuilt-module-path specifies where to load the prebuilt module files.
     for (const Arg *A : Args.filtered(options::OPT_fprebuilt_module_path))
@@ -5844,6 +5925,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_interval);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_after);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_build_threads_EQ);
 
   Args.AddLastArg(CmdArgs, options::OPT_fbuild_session_timestamp);
 
@@ -5871,6 +5953,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fmodules_validate_once_per_build_session);
   }
 
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_trusted_manifest);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_disable_diagnostic_validation);
 
@@ -6323,6 +6406,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_vectorize, EnableVec))
     CmdArgs.push_back("-vectorize-loops");
 
+  // -fno-vectorize-range-for is default.
+  if (Args.hasFlag(options::OPT_fvectorize_range_for,
+                   options::OPT_fno_vectorize_range_for, false))
+    CmdArgs.push_back("-fvectorize-range-for");
+
   // -fslp-vectorize is enabled based on the optimization level selected.
   bool EnableSLPVec = shouldEnableVectorizerAtOLevel(Args, true);
   OptSpecifier SLPVectAliasOption =
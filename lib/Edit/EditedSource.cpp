@@ -15,6 +15,7 @@
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Twine.h"
+#include <algorithm>
 
 using namespace clang;
 using namespace edit;
@@ -108,7 +109,7 @@ bool EditedSource::commitInsert(SourceLocation OrigLoc,
       CurrCommitMacroArgExps.emplace_back(ExpLoc, II);
   }
   
-  FileEdit &FA = FileEdits[Offs];
+  FileEdit &FA = getOrCreateEdit(Offs);
   if (FA.Text.empty()) {
     FA.Text = copyString(text);
     return true;
@@ -132,7 +133,7 @@ bool EditedSource::commitInsertFromRange(SourceLocation OrigLoc,
   SmallString<128> StrVec;
   FileOffset BeginOffs = InsertFromRangeOffs;
   FileOffset EndOffs = BeginOffs.getWithOffset(Len);
-  FileEditsTy::iterator I = FileEdits.upper_bound(BeginOffs);
+  FileEditsTy::iterator I = getFirstEditAfter(BeginOffs);
   if (I != FileEdits.begin())
     --I;
 
@@ -186,7 +187,7 @@ void EditedSource::commitRemove(SourceLocation OrigLoc,
     return;
 
   FileOffset EndOffs = BeginOffs.getWithOffset(Len);
-  FileEditsTy::iterator I = FileEdits.upper_bound(BeginOffs);
+  FileEditsTy::iterator I = getFirstEditAfter(BeginOffs);
   if (I != FileEdits.begin())
     --I;
 
@@ -215,6 +216,7 @@ void EditedSource::commitRemove(SourceLocation OrigLoc,
   if (BeginOffs < B) {
     FileEditsTy::iterator
       NewI = FileEdits.insert(I, std::make_pair(BeginOffs, FileEdit()));
+    I = NewI + 1;
     TopBegin = BeginOffs;
     TopEnd = EndOffs;
     TopFA = &NewI->second;
@@ -233,6 +235,9 @@ void EditedSource::commitRemove(SourceLocation OrigLoc,
     ++I;
   }
 
+  // Find the following edits which overlap the removal and erase them all at
+  // once.  TopFA precedes them, so it stays valid.
+  FileEditsTy::iterator EraseBegin = I;
   while (I != FileEdits.end()) {
     FileEdit &FA = I->second;
     FileOffset B = I->first;
@@ -242,7 +247,7 @@ void EditedSource::commitRemove(SourceLocation OrigLoc,
       break;
 
     if (E <= TopEnd) {
-      FileEdits.erase(I++);
+      ++I;
       continue;
     }
 
@@ -250,11 +255,12 @@ void EditedSource::commitRemove(SourceLocation OrigLoc,
       unsigned diff = E.getOffset() - TopEnd.getOffset();
       TopEnd = E;
       TopFA->RemoveLen += diff;
-      FileEdits.erase(I);
+      ++I;
     }
 
     break;
   }
+  FileEdits.erase(EraseBegin, I);
 }
 
 bool EditedSource::commit(const Commit &commit) {
@@ -442,9 +448,35 @@ StringRef EditedSource::getSourceText(FileOffset BeginOffs, FileOffset EndOffs,
                               SourceMgr, LangOpts, &Invalid);
 }
 
+EditedSource::FileEditsTy::iterator
+EditedSource::getFirstEditAfter(FileOffset Offs) {
+  return std::upper_bound(
+      FileEdits.begin(), FileEdits.end(), Offs,
+      [](FileOffset LHS, const FileEditsTy::value_type &RHS) {
+        return LHS < RHS.first;
+      });
+}
+
+EditedSource::FileEdit &EditedSource::getOrCreateEdit(FileOffset Offs) {
+  // Most edits are made after all of the previous ones.
+  if (FileEdits.empty() || FileEdits.back().first < Offs) {
+    FileEdits.push_back(std::make_pair(Offs, FileEdit()));
+    return FileEdits.back().second;
+  }
+
+  FileEditsTy::iterator I = std::lower_bound(
+      FileEdits.begin(), FileEdits.end(), Offs,
+      [](const FileEditsTy::value_type &LHS, FileOffset RHS) {
+        return LHS.first < RHS;
+      });
+  if (I == FileEdits.end() || I->first != Offs)
+    I = FileEdits.insert(I, std::make_pair(Offs, FileEdit()));
+  return I->second;
+}
+
 EditedSource::FileEditsTy::iterator
 EditedSource::getActionForOffset(FileOffset Offs) {
-  FileEditsTy::iterator I = FileEdits.upper_bound(Offs);
+  FileEditsTy::iterator I = getFirstEditAfter(Offs);
   if (I == FileEdits.begin())
     return FileEdits.end();
   --I;
@@ -26,6 +26,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/STLExtras.h"
@@ -1805,6 +1806,7 @@ cleanupAroundReplacements(StringRef Code, const tooling::Replacements &Replaces,
 tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                ArrayRef<tooling::Range> Ranges,
                                StringRef FileName, bool *IncompleteFormat) {
+  TimeTraceScope TimeScope("Reformat", [&] { return FileName.str(); });
   FormatStyle Expanded = expandPresets(Style);
   if (Expanded.DisableFormat)
     return tooling::Replacements();
@@ -1882,21 +1884,31 @@ static FormatStyle::LanguageKind getLanguageByFileName(StringRef FileName) {
   return FormatStyle::LK_Cpp;
 }
 
-FormatStyle getStyle(StringRef StyleName, StringRef FileName,
-                     StringRef FallbackStyle, StringRef Code,
-                     vfs::FileSystem *FS) {
-  if (!FS) {
-    FS = vfs::getRealFileSystem().get();
-  }
-  FormatStyle Style = getLLVMStyle();
-  Style.Language = getLanguageByFileName(FileName);
-
+FormatStyle::LanguageKind guessLanguage(StringRef FileName, StringRef Code) {
+  FormatStyle::LanguageKind Language = getLanguageByFileName(FileName);
   // This is a very crude detection of whether a header contains ObjC code that
   // should be improved over time and probably be done on tokens, not one the
   // bare content of the file.
-  if (Style.Language == FormatStyle::LK_Cpp && FileName.endswith(".h") &&
+  if (Language == FormatStyle::LK_Cpp && FileName.endswith(".h") &&
       (Code.contains("\n- (") || Code.contains("\n+ (")))
-    Style.Language = FormatStyle::LK_ObjC;
+    Language = FormatStyle::LK_ObjC;
+  return Language;
+}
+
+// Implements getStyle(), setting \p UsedConfigFile to the configuration file
+// the style was read from, if any, and \p ConfigError if a configuration file
+// was found but could not be read or parsed.
+static FormatStyle getStyleAndConfigFile(StringRef StyleName,
+                                         StringRef FileName,
+                                         StringRef FallbackStyle,
+                                         StringRef Code, vfs::FileSystem *FS,
+                                         std::string &UsedConfigFile,
+                                         bool &ConfigError) {
+  if (!FS) {
+    FS = vfs::getRealFileSystem().get();
+  }
+  FormatStyle Style = getLLVMStyle();
+  Style.Language = guessLanguage(FileName, Code);
 
   if (!getPredefinedStyle(FallbackStyle, Style.Language, &Style)) {
     llvm::errs() << "Invalid fallback style \"" << FallbackStyle
@@ -1960,6 +1972,7 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
           FS->getBufferForFile(ConfigFile.str());
       if (std::error_code EC = Text.getError()) {
         llvm::errs() << EC.message() << "\n";
+        ConfigError = true;
         break;
       }
       if (std::error_code ec =
@@ -1972,9 +1985,11 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
         }
         llvm::errs() << "Error reading " << ConfigFile << ": " << ec.message()
                      << "\n";
+        ConfigError = true;
         break;
       }
       DEBUG(llvm::dbgs() << "Using configuration file " << ConfigFile << "\n");
+      UsedConfigFile = ConfigFile.str();
       return Style;
     }
   }
@@ -1986,5 +2001,68 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
   return Style;
 }
 
+FormatStyle getStyle(StringRef StyleName, StringRef FileName,
+                     StringRef FallbackStyle, StringRef Code,
+                     vfs::FileSystem *FS) {
+  std::string ConfigFile;
+  bool ConfigError = false;
+  return getStyleAndConfigFile(StyleName, FileName, FallbackStyle, Code, FS,
+                               ConfigFile, ConfigError);
+}
+
+FormatStyle FormatStyleCache::getStyle(StringRef StyleName, StringRef FileName,
+                                       StringRef FallbackStyle, StringRef Code,
+                                       vfs::FileSystem *FS) {
+  // Only looking for a configuration file is worth caching.
+  if (!StyleName.equals_lower("file"))
+    return format::getStyle(StyleName, FileName, FallbackStyle, Code, FS);
+  if (!FS)
+    FS = vfs::getRealFileSystem().get();
+
+  SmallString<128> Path(FileName);
+  if (FS->makeAbsolute(Path))
+    return format::getStyle(StyleName, FileName, FallbackStyle, Code, FS);
+  SmallString<128> Key(llvm::sys::path::parent_path(Path));
+  Key.push_back('\0');
+  Key.push_back(static_cast<char>(guessLanguage(FileName, Code)));
+  Key.push_back('\0');
+  Key.append(FallbackStyle);
+
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Entries.find(Key);
+    if (It != Entries.end()) {
+      const Entry &E = It->second;
+      if (E.ConfigFile.empty())
+        return E.Style;
+      auto Status = FS->status(E.ConfigFile);
+      if (Status &&
+          Status->getLastModificationTime() == E.ModificationTime &&
+          Status->getSize() == E.Size)
+        return E.Style;
+    }
+  }
+
+  Entry E;
+  bool ConfigError = false;
+  E.Style = getStyleAndConfigFile(StyleName, FileName, FallbackStyle, Code, FS,
+                                  E.ConfigFile, ConfigError);
+  // The fallback style used for a broken configuration file must not outlive
+  // the file being fixed.
+  if (ConfigError)
+    return E.Style;
+  if (!E.ConfigFile.empty()) {
+    auto Status = FS->status(E.ConfigFile);
+    if (!Status)
+      return E.Style;
+    E.ModificationTime = Status->getLastModificationTime();
+    E.Size = Status->getSize();
+  }
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries[Key] = E;
+  return E.Style;
+}
+
 } // namespace format
 } // namespace clang
@@ -9,6 +9,7 @@
 
 #include "UnwrappedLineFormatter.h"
 #include "WhitespaceManager.h"
+#include "clang/Basic/TimeTrace.h"
 #include "llvm/Support/Debug.h"
 #include <queue>
 
@@ -674,6 +675,9 @@ private:
   typedef std::priority_queue<QueueItem, std::vector<QueueItem>,
                               std::greater<QueueItem>> QueueType;
 
+  /// \brief The states that have already been examined.
+  typedef std::set<LineState *, CompareLineStatePointers> SeenSet;
+
   /// \brief Analyze the entire solution space starting from \p InitialState.
   ///
   /// This implements a variant of Dijkstra's algorithm on the graph that spans
@@ -683,7 +687,8 @@ private:
   ///
   /// If \p DryRun is \c false, directly applies the changes.
   unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun) {
-    std::set<LineState *, CompareLineStatePointers> Seen;
+    TimeTraceScope TimeScope("ReformatLineSearch");
+    SeenSet Seen;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -719,9 +724,11 @@ private:
 
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, Seen, &Count,
+                            &Queue);
       if (LastFormat == FD_Unformatted || LastFormat == FD_Break)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, Seen, &Count,
+                            &Queue);
     }
 
     if (Queue.empty()) {
@@ -745,8 +752,13 @@ private:
   ///
   /// Assume the current state is \p PreviousNode and has been reached with a
   /// penalty of \p Penalty. Insert a line break if \p NewLine is \c true.
+  ///
+  /// States in \p Seen have been reached with a penalty no higher than
+  /// \p Penalty, so a following state that is already in there is dropped
+  /// right away instead of being queued only to be skipped later.
   void addNextStateToQueue(unsigned Penalty, StateNode *PreviousNode,
-                           bool NewLine, unsigned *Count, QueueType *Queue) {
+                           bool NewLine, const SeenSet &Seen, unsigned *Count,
+                           QueueType *Queue) {
     if (NewLine && !Indenter->canBreak(PreviousNode->State))
       return;
     if (!NewLine && Indenter->mustBreak(PreviousNode->State))
@@ -759,8 +771,13 @@ private:
 
     Penalty += Indenter->addTokenToState(Node->State, NewLine, true);
 
-    Queue->push(QueueItem(OrderedPenalty(Penalty, *Count), Node));
-    ++(*Count);
+    // Count dropped states as well: the count decides when the analysis is
+    // cut off (see IgnoreStackForComparison), and that must not change.
+    unsigned NodeCount = (*Count)++;
+    if (Seen.count(&Node->State))
+      return;
+
+    Queue->push(QueueItem(OrderedPenalty(Penalty, NodeCount), Node));
   }
 
   /// \brief Applies the best formatting by reconstructing the path in the
@@ -37,10 +37,12 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/Errc.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <atomic>
@@ -83,6 +85,10 @@ namespace {
     /// \brief The file in which the precompiled preamble is stored.
     std::string PreambleFile;
 
+    /// \brief Whether PreambleFile only names a precompiled preamble kept in
+    /// memory, so that there is nothing on disk to erase.
+    bool PreambleFileIsInMemory = false;
+
     /// \brief Temporary files that should be removed when the ASTUnit is
     /// destroyed.
     SmallVector<std::string, 4> TemporaryFiles;
@@ -154,8 +160,11 @@ static void removeOnDiskEntry(const ASTUnit *AU) {
   }
 }
 
-static void setPreambleFile(const ASTUnit *AU, StringRef preambleFile) {
-  getOnDiskData(AU).PreambleFile = preambleFile;
+static void setPreambleFile(const ASTUnit *AU, StringRef preambleFile,
+                            bool isInMemory = false) {
+  OnDiskData &D = getOnDiskData(AU);
+  D.PreambleFile = preambleFile;
+  D.PreambleFileIsInMemory = isInMemory;
 }
 
 static const std::string &getPreambleFile(const ASTUnit *AU) {
@@ -170,8 +179,10 @@ void OnDiskData::CleanTemporaryFiles() {
 
 void OnDiskData::CleanPreambleFile() {
   if (!PreambleFile.empty()) {
-    llvm::sys::fs::remove(PreambleFile);
+    if (!PreambleFileIsInMemory)
+      llvm::sys::fs::remove(PreambleFile);
     PreambleFile.clear();
+    PreambleFileIsInMemory = false;
   }
 }
 
@@ -188,6 +199,104 @@ struct ASTUnit::ASTWriterData {
   ASTWriterData() : Stream(Buffer), Writer(Stream, { }) { }
 };
 
+namespace {
+/// \brief An open in-memory precompiled preamble.
+class InMemoryPreambleFile : public vfs::File {
+  vfs::Status Stat;
+  const llvm::MemoryBuffer &PCH;
+
+public:
+  InMemoryPreambleFile(vfs::Status Stat, const llvm::MemoryBuffer &PCH)
+      : Stat(std::move(Stat)), PCH(PCH) {}
+
+  llvm::ErrorOr<vfs::Status> status() override { return Stat; }
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::MemoryBuffer::getMemBuffer(
+        PCH.getBuffer(), PCH.getBufferIdentifier(), RequiresNullTerminator);
+  }
+  std::error_code close() override { return std::error_code(); }
+};
+} // end anonymous namespace
+
+/// \brief A file system which knows of a single file: the precompiled
+/// preamble of an ASTUnit that keeps it in memory. It is laid over the file
+/// systems of the file managers the ASTUnit creates.
+class ASTUnit::PreambleFileSystem : public vfs::FileSystem {
+  /// \brief The name of the current preamble, if there is one.
+  std::string Path;
+  vfs::Status Stat;
+  std::unique_ptr<llvm::MemoryBuffer> PCH;
+
+  /// \brief The preamble replaced by the current one, which the AST parsed
+  /// with it may still refer to until that AST is discarded.
+  std::unique_ptr<llvm::MemoryBuffer> SupersededPCH;
+
+  /// \brief The number of preambles served so far. Each one gets a name of
+  /// its own, since file managers remember what they found under a name.
+  unsigned NumPreambles = 0;
+
+  bool isPreamble(const Twine &P) const {
+    return PCH && P.str() == Path;
+  }
+
+public:
+  /// \brief Serve \p Contents as the current preamble, returning its name.
+  StringRef setPreamble(StringRef Contents) {
+    SmallString<128> NewPath;
+    llvm::sys::path::system_temp_directory(/*erasedOnReboot=*/true, NewPath);
+    llvm::sys::path::append(NewPath, "preamble-in-memory-" +
+                                         Twine(++NumPreambles) + ".pch");
+    Path = NewPath.str();
+    SupersededPCH = std::move(PCH);
+    PCH = llvm::MemoryBuffer::getMemBufferCopy(Contents, Path);
+    Stat = vfs::Status(Path, vfs::getNextVirtualUniqueID(),
+                       llvm::sys::toTimePoint(0), 0, 0, Contents.size(),
+                       llvm::sys::fs::file_type::regular_file,
+                       llvm::sys::fs::all_read);
+    return Path;
+  }
+
+  /// \brief Free the preamble replaced by the current one, once nothing can
+  /// refer to it any more.
+  void releaseSupersededPreamble() { SupersededPCH.reset(); }
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &P) override {
+    if (!isPreamble(P))
+      return make_error_code(llvm::errc::no_such_file_or_directory);
+    return Stat;
+  }
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &P) override {
+    if (!isPreamble(P))
+      return make_error_code(llvm::errc::no_such_file_or_directory);
+    return std::unique_ptr<vfs::File>(new InMemoryPreambleFile(Stat, *PCH));
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    EC = make_error_code(llvm::errc::no_such_file_or_directory);
+    return vfs::directory_iterator();
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &P) override {
+    // The preamble is always named by an absolute path.
+    return std::error_code();
+  }
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return std::string();
+  }
+};
+
+IntrusiveRefCntPtr<vfs::FileSystem>
+ASTUnit::overlayPreambleFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> VFS) {
+  if (!PreambleFS)
+    return VFS;
+  IntrusiveRefCntPtr<vfs::OverlayFileSystem> Overlay(
+      new vfs::OverlayFileSystem(std::move(VFS)));
+  Overlay->pushOverlay(PreambleFS);
+  return Overlay;
+}
+
 void ASTUnit::clearFileLevelDecls() {
   llvm::DeleteContainerSeconds(FileDecls);
 }
@@ -482,6 +591,36 @@ void ASTUnit::ClearCachedCompletionResults() {
   CachedCompletionAllocator = nullptr;
 }
 
+size_t ASTUnit::getStoredDiagnosticsMemory() const {
+  size_t Size = StoredDiagnostics.capacity() * sizeof(StoredDiagnostic);
+  for (const StoredDiagnostic &SD : StoredDiagnostics) {
+    Size += SD.getMessage().size();
+    Size += SD.range_size() * sizeof(CharSourceRange);
+    for (const FixItHint &FixIt : SD.getFixIts())
+      Size += sizeof(FixItHint) + FixIt.CodeToInsert.size();
+  }
+  return Size;
+}
+
+size_t ASTUnit::trimMemory(bool ClearDiagnostics) {
+  size_t Released = 0;
+  if (CachedCompletionAllocator)
+    Released += CachedCompletionAllocator->getTotalMemory();
+  Released += CachedCompletionResults.capacity() *
+              sizeof(CachedCodeCompletionResult);
+  ClearCachedCompletionResults();
+  std::vector<CachedCodeCompletionResult>().swap(CachedCompletionResults);
+  // Make the next reparse rebuild the cache.
+  CompletionCacheTopLevelHashValue = 0;
+
+  if (ClearDiagnostics) {
+    Released += getStoredDiagnosticsMemory();
+    SmallVector<StoredDiagnostic, 4>().swap(StoredDiagnostics);
+    NumStoredDiagnosticsFromDriver = 0;
+  }
+  return Released;
+}
+
 namespace {
 
 /// \brief Gathers information from ASTReader that will be used to initialize
@@ -743,6 +882,10 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromASTFile(
 
   PP.setCounterValue(Counter);
 
+  // The AST file only knows about the builtins it referred to.
+  PP.getBuiltinInfo().initializeBuiltinsForAST(PP.getIdentifierTable(),
+                                               Context.getLangOpts());
+
   // Create an AST consumer, even though it isn't used.
   AST->Consumer.reset(new ASTConsumer);
   
@@ -898,10 +1041,14 @@ public:
 class PrecompilePreambleAction : public ASTFrontendAction {
   ASTUnit &Unit;
   bool HasEmittedPreamblePCH;
+  /// \brief If non-null, where to keep the preamble PCH instead of writing it
+  /// to the output file.
+  SmallVectorImpl<char> *InMemoryPCH;
 
 public:
-  explicit PrecompilePreambleAction(ASTUnit &Unit)
-      : Unit(Unit), HasEmittedPreamblePCH(false) {}
+  explicit PrecompilePreambleAction(ASTUnit &Unit,
+                                    SmallVectorImpl<char> *InMemoryPCH = nullptr)
+      : Unit(Unit), HasEmittedPreamblePCH(false), InMemoryPCH(InMemoryPCH) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override;
@@ -920,16 +1067,18 @@ class PrecompilePreambleConsumer : public PCHGenerator {
   std::vector<Decl *> TopLevelDecls;
   PrecompilePreambleAction *Action;
   std::unique_ptr<raw_ostream> Out;
+  SmallVectorImpl<char> *InMemoryPCH;
 
 public:
   PrecompilePreambleConsumer(ASTUnit &Unit, PrecompilePreambleAction *Action,
                              const Preprocessor &PP, StringRef isysroot,
-                             std::unique_ptr<raw_ostream> Out)
+                             std::unique_ptr<raw_ostream> Out,
+                             SmallVectorImpl<char> *InMemoryPCH)
       : PCHGenerator(PP, "", isysroot, std::make_shared<PCHBuffer>(),
                      ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>>(),
                      /*AllowASTWithErrors=*/true),
         Unit(Unit), Hash(Unit.getCurrentTopLevelHashValue()), Action(Action),
-        Out(std::move(Out)) {
+        Out(std::move(Out)), InMemoryPCH(InMemoryPCH) {
     Hash = 0;
   }
 
@@ -950,10 +1099,15 @@ public:
   void HandleTranslationUnit(ASTContext &Ctx) override {
     PCHGenerator::HandleTranslationUnit(Ctx);
     if (hasEmittedPCH()) {
-      // Write the generated bitstream to "Out".
-      *Out << getPCH();
-      // Make sure it hits disk now.
-      Out->flush();
+      if (InMemoryPCH) {
+        // Hand the generated bitstream over to be kept in memory.
+        InMemoryPCH->swap(getPCH());
+      } else {
+        // Write the generated bitstream to "Out".
+        *Out << getPCH();
+        // Make sure it hits disk now.
+        Out->flush();
+      }
       // Free the buffer.
       llvm::SmallVector<char, 0> Empty;
       getPCH() = std::move(Empty);
@@ -981,11 +1135,19 @@ PrecompilePreambleAction::CreateASTConsumer(CompilerInstance &CI,
                                             StringRef InFile) {
   std::string Sysroot;
   std::string OutputFile;
-  std::unique_ptr<raw_ostream> OS =
-      GeneratePCHAction::ComputeASTConsumerArguments(CI, InFile, Sysroot,
-                                                     OutputFile);
-  if (!OS)
-    return nullptr;
+  std::unique_ptr<raw_ostream> OS;
+  if (InMemoryPCH) {
+    Sysroot = CI.getHeaderSearchOpts().Sysroot;
+    if (CI.getFrontendOpts().RelocatablePCH && Sysroot.empty()) {
+      CI.getDiagnostics().Report(diag::err_relocatable_without_isysroot);
+      return nullptr;
+    }
+  } else {
+    OS = GeneratePCHAction::ComputeASTConsumerArguments(CI, InFile, Sysroot,
+                                                        OutputFile);
+    if (!OS)
+      return nullptr;
+  }
 
   if (!CI.getFrontendOpts().RelocatablePCH)
     Sysroot.clear();
@@ -994,7 +1156,7 @@ PrecompilePreambleAction::CreateASTConsumer(CompilerInstance &CI,
       llvm::make_unique<MacroDefinitionTrackerPPCallbacks>(
                                            Unit.getCurrentTopLevelHashValue()));
   return llvm::make_unique<PrecompilePreambleConsumer>(
-      Unit, this, CI.getPreprocessor(), Sysroot, std::move(OS));
+      Unit, this, CI.getPreprocessor(), Sysroot, std::move(OS), InMemoryPCH);
 }
 
 static bool isNonDriverDiag(const StoredDiagnostic &StoredDiag) {
@@ -1079,6 +1241,10 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   LangOpts = Clang->getInvocation().LangOpts;
   FileSystemOpts = Clang->getFileSystemOpts();
   if (!FileMgr) {
+    if (PreambleFS)
+      Clang->setVirtualFileSystem(overlayPreambleFileSystem(
+          Clang->hasVirtualFileSystem() ? &Clang->getVirtualFileSystem()
+                                        : vfs::getRealFileSystem()));
     Clang->createFileManager();
     FileMgr = &Clang->getFileManager();
   }
@@ -1088,6 +1254,8 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   Ctx = nullptr;
   PP = nullptr;
   Reader = nullptr;
+  if (PreambleFS)
+    PreambleFS->releaseSupersededPreamble();
 
   // Clear out old caches and data.
   TopLevelDecls.clear();
@@ -1478,10 +1646,12 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
 
-  // Create a temporary file for the precompiled preamble. In rare 
-  // circumstances, this can fail.
-  std::string PreamblePCHPath = GetPreamblePCHPath();
-  if (PreamblePCHPath.empty()) {
+  // Create a temporary file for the precompiled preamble, unless it is kept
+  // in memory. In rare circumstances, this can fail.
+  std::string PreamblePCHPath;
+  if (!PreambleFS)
+    PreamblePCHPath = GetPreamblePCHPath();
+  if (!PreambleFS && PreamblePCHPath.empty()) {
     // Try again next time.
     PreambleRebuildCounter = 1;
     return nullptr;
@@ -1508,7 +1678,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   // Tell the compiler invocation to generate a temporary precompiled header.
   FrontendOpts.ProgramAction = frontend::GeneratePCH;
-  // FIXME: Generate the precompiled header into memory?
+  // When the preamble is kept in memory, there is no output file.
   FrontendOpts.OutputFile = PreamblePCHPath;
   PreprocessorOpts.PrecompiledPreambleBytes.first = 0;
   PreprocessorOpts.PrecompiledPreambleBytes.second = false;
@@ -1574,8 +1744,10 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   auto PreambleDepCollector = std::make_shared<DependencyCollector>();
   Clang->addDependencyCollector(PreambleDepCollector);
 
+  llvm::SmallVector<char, 0> InMemoryPCH;
   std::unique_ptr<PrecompilePreambleAction> Act;
-  Act.reset(new PrecompilePreambleAction(*this));
+  Act.reset(new PrecompilePreambleAction(*this,
+                                         PreambleFS ? &InMemoryPCH : nullptr));
   if (!Act->BeginSourceFile(*Clang.get(), Clang->getFrontendOpts().Inputs[0])) {
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
     Preamble.clear();
@@ -1611,7 +1783,13 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   }
   
   // Keep track of the preamble we precompiled.
-  setPreambleFile(this, FrontendOpts.OutputFile);
+  if (PreambleFS)
+    setPreambleFile(this,
+                    PreambleFS->setPreamble(StringRef(InMemoryPCH.data(),
+                                                      InMemoryPCH.size())),
+                    /*isInMemory=*/true);
+  else
+    setPreambleFile(this, FrontendOpts.OutputFile);
   NumWarningsInPreamble = getDiagnostics().getNumWarnings();
   
   // Keep track of all of the files that the source manager knows about,
@@ -1946,7 +2124,9 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
     bool AllowPCHWithCompilerErrors, bool SkipFunctionBodies,
     bool UserFilesAreVolatile, bool ForSerialization,
-    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST) {
+    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
+    bool StorePreamblesInMemory,
+    std::shared_ptr<SharedFileContents> SharedContents) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -1982,17 +2162,25 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   if (ModuleFormat)
     CI->getHeaderSearchOpts().ModuleFormat = ModuleFormat.getValue();
 
+  // Reparses and the preamble build share the contents as well, as they use
+  // the file system options of the invocation.
+  CI->getFileSystemOpts().SharedContents = std::move(SharedContents);
+
   // Create the AST unit.
   std::unique_ptr<ASTUnit> AST;
   AST.reset(new ASTUnit(false));
   ConfigureDiags(Diags, *AST, CaptureDiagnostics);
   AST->Diagnostics = Diags;
   AST->FileSystemOpts = CI->getFileSystemOpts();
+  if (StorePreamblesInMemory)
+    AST->PreambleFS = new PreambleFileSystem();
   IntrusiveRefCntPtr<vfs::FileSystem> VFS =
       createVFSFromCompilerInvocation(*CI, *Diags);
   if (!VFS)
     return nullptr;
-  AST->FileMgr = new FileManager(AST->FileSystemOpts, VFS);
+  AST->FileMgr =
+      new FileManager(AST->FileSystemOpts,
+                      AST->overlayPreambleFileSystem(std::move(VFS)));
   AST->OnlyLocalDecls = OnlyLocalDecls;
   AST->CaptureDiagnostics = CaptureDiagnostics;
   AST->TUKind = TUKind;
@@ -2246,6 +2434,12 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     // interested in, we'll add this result.
     if ((C->ShowInContexts & InContexts) == 0)
       continue;
+
+    // Cached results are computed once for every name, so they are filtered
+    // by the name typed so far here rather than in Sema.
+    if (!isCodeCompletionFilterMatch(getFilter(),
+                                     C->Completion->getTypedText()))
+      continue;
     
     // If we haven't added any results previously, do so now.
     if (!AddedResult) {
@@ -2343,6 +2537,7 @@ void ASTUnit::CodeComplete(
   CodeCompleteOpts.IncludeCodePatterns = IncludeCodePatterns;
   CodeCompleteOpts.IncludeGlobals = CachedCompletionResults.empty();
   CodeCompleteOpts.IncludeBriefComments = IncludeBriefComments;
+  CodeCompleteOpts.Filter = Consumer.getFilter();
 
   assert(IncludeBriefComments == this->IncludeBriefCommentsInCodeCompletion);
 
@@ -192,6 +192,10 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
         return nullptr;
       Clang->setModuleManager(Reader);
       Clang->getASTContext().setExternalSource(Reader);
+
+      Preprocessor &PP = Clang->getPreprocessor();
+      PP.getBuiltinInfo().initializeBuiltinsForAST(PP.getIdentifierTable(),
+                                                   PP.getLangOpts());
     }
     
     if (!Clang->InitializeSourceManager(InputFile))
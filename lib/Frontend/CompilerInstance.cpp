@@ -11,10 +11,14 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/FileUtilities.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Config/config.h"
 #include "clang/Frontend/ChainedDiagnosticConsumer.h"
@@ -34,20 +38,29 @@
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LockFileManager.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
 #include <sys/stat.h>
 #include <system_error>
+#include <thread>
 #include <time.h>
 #include <utility>
 
@@ -57,10 +70,11 @@ CompilerInstance::CompilerInstance(
     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     bool BuildingModule)
     : ModuleLoader(BuildingModule), Invocation(new CompilerInvocation()),
-      ModuleManager(nullptr),
+      StatCacheWriter(nullptr), ModuleManager(nullptr),
       ThePCHContainerOperations(std::move(PCHContainerOps)),
       BuildGlobalModuleIndex(false), HaveFullGlobalModuleIndex(false),
-      ModuleBuildFailed(false) {}
+      ModuleBuildFailed(false), NumModuleLockWaits(0),
+      ModuleLockWaitSeconds(0) {}
 
 CompilerInstance::~CompilerInstance() {
   assert(OutputFiles.empty() && "Still output files in flight?");
@@ -86,6 +100,7 @@ void CompilerInstance::setAuxTarget(TargetInfo *Value) { AuxTarget = Value; }
 
 void CompilerInstance::setFileManager(FileManager *Value) {
   FileMgr = Value;
+  StatCacheWriter = nullptr;
   if (Value)
     VirtualFileSystem = Value->getVirtualFileSystem();
   else
@@ -141,6 +156,14 @@ void CompilerInstance::setModuleDepCollector(
   ModuleDepCollector = std::move(Collector);
 }
 
+void CompilerInstance::PrintStats() const {
+  llvm::errs() << "\n*** Module Build Stats:\n";
+  llvm::errs() << NumModuleLockWaits
+               << " waits for modules built by other processes, ";
+  llvm::errs() << llvm::format("%.3f", ModuleLockWaitSeconds)
+               << " seconds spent waiting.\n";
+}
+
 static void collectHeaderMaps(const HeaderSearch &HS,
                               std::shared_ptr<ModuleDependencyCollector> MDC) {
   SmallVector<std::string, 4> HeaderMapFileNames;
@@ -296,6 +319,32 @@ void CompilerInstance::createFileManager() {
     setVirtualFileSystem(vfs::getRealFileSystem());
   }
   FileMgr = new FileManager(getFileSystemOpts(), VirtualFileSystem);
+  StatCacheWriter = nullptr;
+
+  const FileSystemOptions &FSOpts = getFileSystemOpts();
+  if (FSOpts.StatCacheFile.empty())
+    return;
+
+  // A cache which is missing or out of date only costs the lookups it would
+  // have saved, so silently ignore any that cannot be loaded.
+  std::unique_ptr<PersistentStatCache> Cache =
+      PersistentStatCache::create(FSOpts.StatCacheFile);
+
+  // The writer sits behind the cache, which answers the paths it knows about
+  // without asking it; carry those over so they are not dropped.
+  std::unique_ptr<PersistentStatCacheWriter> Writer;
+  if (FSOpts.UpdateStatCache) {
+    Writer = llvm::make_unique<PersistentStatCacheWriter>();
+    if (Cache)
+      Writer->addValidEntries(*Cache, *VirtualFileSystem);
+  }
+
+  if (Cache)
+    FileMgr->addStatCache(std::move(Cache));
+  if (Writer) {
+    StatCacheWriter = Writer.get();
+    FileMgr->addStatCache(std::move(Writer));
+  }
 }
 
 // Source Manager
@@ -613,6 +662,9 @@ void CompilerInstance::createSema(TranslationUnitKind TUKind,
                                   CodeCompleteConsumer *CompletionConsumer) {
   TheSema.reset(new Sema(getPreprocessor(), getASTContext(), getASTConsumer(),
                          TUKind, CompletionConsumer));
+  if (getFrontendOpts().ShowTemplateProfile)
+    TheSema->TemplateProfile =
+        llvm::make_unique<TemplateProfiler>(getASTContext());
   // Attach the external sema source if there is any.
   if (ExternalSemaSrc) {
     TheSema->addExternalSource(ExternalSemaSrc.get());
@@ -955,10 +1007,30 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
     if (hasSourceManager() && !Act.isModelParsingAction())
       getSourceManager().clearIDTables();
 
+    bool UsesBuiltinHeadersPCH = setUpBuiltinHeadersPCH(FIF);
+
     if (Act.BeginSourceFile(*this, FIF)) {
       Act.Execute();
       Act.EndSourceFile();
     }
+
+    // The precompiled builtin headers only belong to this input.
+    if (UsesBuiltinHeadersPCH)
+      getPreprocessorOpts().ImplicitPCHInclude.clear();
+  }
+
+  // Don't leave modules half-built in the background; with -disable-free
+  // this instance is never destroyed, so nothing else would wait for them.
+  // The instances building modules for this one leave that to it.
+  if (!buildingModule())
+    waitForModuleBuilds();
+
+  // Share the files found missing with later compilations.
+  if (StatCacheWriter) {
+    StringRef StatCacheFile = getFileSystemOpts().StatCacheFile;
+    if (StatCacheWriter->write(StatCacheFile))
+      getDiagnostics().Report(diag::warn_fe_unable_to_write_stat_cache)
+          << StatCacheFile;
   }
 
   // Notify the diagnostic client that all files were processed.
@@ -1015,16 +1087,12 @@ static InputKind getSourceInputKindFromOptions(const LangOptions &LangOpts) {
   return LangOpts.CPlusPlus? IK_CXX : IK_C;
 }
 
-/// \brief Compile a module file for the given module, using the options 
-/// provided by the importing compiler instance. Returns true if the module
-/// was built without errors.
-static bool compileModuleImpl(CompilerInstance &ImportingInstance,
-                              SourceLocation ImportLoc,
-                              Module *Module,
-                              StringRef ModuleFileName) {
-  ModuleMap &ModMap 
-    = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
-    
+/// \brief Create the invocation which builds \p Module into \p ModuleFileName,
+/// using the options provided by the importing compiler instance. Its inputs
+/// are left empty.
+static IntrusiveRefCntPtr<CompilerInvocation>
+createModuleBuildInvocation(CompilerInstance &ImportingInstance,
+                            Module *Module, StringRef ModuleFileName) {
   // Construct a compiler invocation for creating this module.
   IntrusiveRefCntPtr<CompilerInvocation> Invocation
     (new CompilerInvocation(ImportingInstance.getInvocation()));
@@ -1051,25 +1119,14 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   // Note the name of the module we're building.
   Invocation->getLangOpts()->CurrentModule = Module->getTopLevelModuleName();
 
-  // Make sure that the failed-module structure has been allocated in
-  // the importing instance, and propagate the pointer to the newly-created
-  // instance.
-  PreprocessorOptions &ImportingPPOpts
-    = ImportingInstance.getInvocation().getPreprocessorOpts();
-  if (!ImportingPPOpts.FailedModules)
-    ImportingPPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
-  PPOpts.FailedModules = ImportingPPOpts.FailedModules;
-
-  // If there is a module map file, build the module using the module map.
-  // Set up the inputs/outputs so that we build the module from its umbrella
-  // header.
+  // Set up the outputs; the caller sets up the inputs so that we build the
+  // module from its module map.
   FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
   FrontendOpts.OutputFile = ModuleFileName.str();
   FrontendOpts.DisableFree = false;
   FrontendOpts.GenerateGlobalModuleIndex = false;
   FrontendOpts.BuildingImplicitModule = true;
   FrontendOpts.Inputs.clear();
-  InputKind IK = getSourceInputKindFromOptions(*Invocation->getLangOpts());
 
   // Don't free the remapped file buffers; they are owned by our caller.
   PPOpts.RetainRemappedFileBuffers = true;
@@ -1077,7 +1134,34 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   Invocation->getDiagnosticOpts().VerifyDiagnostics = 0;
   assert(ImportingInstance.getInvocation().getModuleHash() ==
          Invocation->getModuleHash() && "Module hash mismatch!");
-  
+  return Invocation;
+}
+
+/// \brief Compile a module file for the given module, using the options 
+/// provided by the importing compiler instance. Returns true if the module
+/// was built without errors.
+static bool compileModuleImpl(CompilerInstance &ImportingInstance,
+                              SourceLocation ImportLoc,
+                              Module *Module,
+                              StringRef ModuleFileName) {
+  ModuleMap &ModMap 
+    = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
+
+  IntrusiveRefCntPtr<CompilerInvocation> Invocation =
+      createModuleBuildInvocation(ImportingInstance, Module, ModuleFileName);
+  FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
+  InputKind IK = getSourceInputKindFromOptions(*Invocation->getLangOpts());
+
+  // Make sure that the failed-module structure has been allocated in
+  // the importing instance, and propagate the pointer to the newly-created
+  // instance.
+  PreprocessorOptions &ImportingPPOpts
+    = ImportingInstance.getInvocation().getPreprocessorOpts();
+  if (!ImportingPPOpts.FailedModules)
+    ImportingPPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
+  Invocation->getPreprocessorOpts().FailedModules =
+      ImportingPPOpts.FailedModules;
+
   // Construct a compiler instance that will be used to actually create the
   // module.
   CompilerInstance Instance(ImportingInstance.getPCHContainerOperations(),
@@ -1106,6 +1190,10 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   Instance.setModuleDepCollector(ImportingInstance.getModuleDepCollector());
   Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
 
+  // The imports of this module may start more builds in the background.
+  Instance.setModuleBuildScheduler(
+      ImportingInstance.getModuleBuildScheduler());
+
   // Get or create the module map that we'll use to build this module.
   std::string InferredModuleMapContent;
   if (const FileEntry *ModuleMapFile =
@@ -1163,6 +1251,295 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   return !Instance.getDiagnostics().hasErrorOccurred();
 }
 
+/// \brief Builds modules on a pool of threads before they are imported.
+///
+/// These builds are speculative: each has a file manager of its own and
+/// drops its diagnostics, since a module which failed to build in the
+/// background is built again, and its errors reported, when it is imported.
+/// They take the lock on the module file like any other build, so that an
+/// importer which needs one of these modules meanwhile waits for it.
+class clang::ModuleBuildScheduler {
+public:
+  explicit ModuleBuildScheduler(unsigned Threads) : Pool(Threads) {}
+
+  llvm::ThreadPool Pool;
+
+  /// \brief The files whose imports were already scheduled.
+  llvm::DenseSet<const FileEntry *> ScannedFiles;
+
+  /// \brief The module files which were scheduled to be built.
+  llvm::StringSet<> ScheduledModuleFiles;
+};
+
+void CompilerInstance::waitForModuleBuilds() {
+  if (ModuleScheduler)
+    ModuleScheduler->Pool.wait();
+}
+
+/// \brief Build a module with \p Invocation in the background, unless someone
+/// else is building it already. \p ModuleBuildStack names the modules which
+/// were being built when this build was scheduled, innermost last.
+static void buildModuleInBackground(
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    IntrusiveRefCntPtr<CompilerInvocation> Invocation,
+    IntrusiveRefCntPtr<vfs::FileSystem> VFS,
+    std::vector<std::string> ModuleBuildStack, bool IsSystem) {
+  StringRef ModuleFileName = Invocation->getFrontendOpts().OutputFile;
+  llvm::LockFileManager Locked(ModuleFileName);
+  if (Locked != llvm::LockFileManager::LFS_Owned ||
+      llvm::sys::fs::exists(ModuleFileName))
+    return;
+
+  CompilerInstance Instance(std::move(PCHContainerOps),
+                            /*BuildingModule=*/true);
+  Instance.setInvocation(&*Invocation);
+  Instance.createDiagnostics(new IgnoringDiagConsumer,
+                             /*ShouldOwnClient=*/true);
+  Instance.setVirtualFileSystem(VFS);
+
+  // The file and source managers of the importer can't be used from another
+  // thread. Importing one of the modules being built in the importer is a
+  // cycle, which fails the build right away rather than waiting for them.
+  Instance.createFileManager();
+  Instance.createSourceManager(Instance.getFileManager());
+  SourceManager &SourceMgr = Instance.getSourceManager();
+  for (const std::string &Name : ModuleBuildStack)
+    SourceMgr.pushModuleBuildStack(Name, FullSourceLoc());
+  SourceMgr.pushModuleBuildStack(Invocation->getLangOpts()->CurrentModule,
+                                 FullSourceLoc());
+
+  GenerateModuleFromModuleMapAction CreateModuleAction(
+      /*ModuleMap=*/nullptr, IsSystem);
+  const unsigned ThreadStackSize = 8 << 20;
+  llvm::CrashRecoveryContext CRC;
+  CRC.RunSafelyOnThread([&]() { Instance.ExecuteAction(CreateModuleAction); },
+                        ThreadStackSize);
+  Instance.clearOutputFiles(/*EraseFiles=*/true);
+}
+
+/// \brief Collect the headers named by the \#include and \#import directives
+/// of \p Buffer, along with whether they are angled, and the top-level
+/// modules named by its @import declarations.
+///
+/// This only looks at each line by itself, ignoring comments and
+/// conditionals, which is good enough to guess what will be imported.
+static void collectImports(StringRef Buffer,
+                           SmallVectorImpl<std::pair<StringRef, bool>> &Headers,
+                           SmallVectorImpl<StringRef> &Modules) {
+  SmallVector<StringRef, 128> Lines;
+  Buffer.split(Lines, '\n');
+  for (StringRef Line : Lines) {
+    Line = Line.trim();
+    if (Line.startswith("@import")) {
+      StringRef Name = Line.drop_front(strlen("@import")).ltrim();
+      size_t End = 0;
+      while (End != Name.size() && isIdentifierBody(Name[End]))
+        ++End;
+      if (End)
+        Modules.push_back(Name.substr(0, End));
+      continue;
+    }
+    if (!Line.startswith("#"))
+      continue;
+
+    StringRef Rest = Line.drop_front().ltrim(" \t");
+    if (Rest.startswith("include"))
+      Rest = Rest.drop_front(strlen("include"));
+    else if (Rest.startswith("import"))
+      Rest = Rest.drop_front(strlen("import"));
+    else
+      continue;
+    Rest = Rest.ltrim(" \t");
+    if (Rest.empty() || (Rest[0] != '<' && Rest[0] != '"'))
+      continue;
+    bool IsAngled = Rest[0] == '<';
+    size_t Close = Rest.find(IsAngled ? '>' : '"', 1);
+    if (Close != StringRef::npos)
+      Headers.push_back(std::make_pair(Rest.slice(1, Close), IsAngled));
+  }
+}
+
+/// \brief Start building in the background the modules which \p Module and
+/// the file containing \p ImportLoc are likely to import, when
+/// -fmodules-build-threads= is set. The caller is about to build \p Module.
+static void scheduleModuleBuilds(CompilerInstance &ImportingInstance,
+                                 SourceLocation ImportLoc, Module *Module) {
+  unsigned Threads = ImportingInstance.getHeaderSearchOpts().ModulesBuildThreads;
+  if (!Threads || !llvm::llvm_is_multithreaded())
+    return;
+  // The time trace and the statistics can only be recorded by one thread,
+  // and the remapped file buffers belong to our caller.
+  if (timeTraceProfilerEnabled() ||
+      ImportingInstance.getFrontendOpts().ShowStats ||
+      !ImportingInstance.getPreprocessorOpts().RemappedFileBuffers.empty())
+    return;
+
+  std::shared_ptr<ModuleBuildScheduler> Scheduler =
+      ImportingInstance.getModuleBuildScheduler();
+  if (!Scheduler) {
+    Scheduler = std::make_shared<ModuleBuildScheduler>(Threads);
+    ImportingInstance.setModuleBuildScheduler(Scheduler);
+  }
+
+  SourceManager &SourceMgr = ImportingInstance.getSourceManager();
+  HeaderSearch &HS = ImportingInstance.getPreprocessor().getHeaderSearchInfo();
+  ModuleMap &ModMap = HS.getModuleMap();
+
+  // Look at the file with the import, whose other imports are siblings of
+  // this one, and at the headers of the module, whose imports it needs.
+  SmallVector<const FileEntry *, 16> Files;
+  if (ImportLoc.isValid())
+    Files.push_back(SourceMgr.getFileEntryForID(
+        SourceMgr.getFileID(SourceMgr.getExpansionLoc(ImportLoc))));
+  SmallVector<clang::Module *, 8> Worklist(1, Module);
+  while (!Worklist.empty()) {
+    clang::Module *M = Worklist.pop_back_val();
+    if (Module::Header Umbrella = M->getUmbrellaHeader())
+      Files.push_back(Umbrella.Entry);
+    for (Module::HeaderKind Kind : {Module::HK_Normal, Module::HK_Private})
+      for (const Module::Header &H : M->Headers[Kind])
+        Files.push_back(H.Entry);
+    Worklist.append(M->submodule_begin(), M->submodule_end());
+  }
+
+  SmallVector<clang::Module *, 16> Imported;
+  for (const FileEntry *File : Files) {
+    if (!File || !Scheduler->ScannedFiles.insert(File).second)
+      continue;
+    bool Invalid = false;
+    llvm::MemoryBuffer *Buffer =
+        SourceMgr.getMemoryBufferForFile(File, &Invalid);
+    if (Invalid)
+      continue;
+
+    SmallVector<std::pair<StringRef, bool>, 16> Headers;
+    SmallVector<StringRef, 4> Modules;
+    collectImports(Buffer->getBuffer(), Headers, Modules);
+    for (const auto &Header : Headers) {
+      const DirectoryLookup *CurDir = nullptr;
+      ModuleMap::KnownHeader Suggested;
+      std::pair<const FileEntry *, const DirectoryEntry *> Includer(
+          File, File->getDir());
+      if (HS.LookupFile(Header.first, SourceLocation(), Header.second,
+                        /*FromDir=*/nullptr, CurDir, Includer,
+                        /*SearchPath=*/nullptr, /*RelativePath=*/nullptr,
+                        /*RequestingModule=*/nullptr, &Suggested) &&
+          Suggested)
+        Imported.push_back(Suggested.getModule()->getTopLevelModule());
+    }
+    for (StringRef Name : Modules)
+      if (clang::Module *M = HS.lookupModule(Name))
+        Imported.push_back(M);
+  }
+
+  ModuleBuildStack BuildStack = SourceMgr.getModuleBuildStack();
+  std::vector<std::string> StackNames;
+  for (const auto &Entry : BuildStack)
+    StackNames.push_back(Entry.first);
+  StackNames.push_back(Module->getTopLevelModuleName());
+  const PreprocessorOptions &PPOpts = ImportingInstance.getPreprocessorOpts();
+
+  for (clang::Module *M : Imported) {
+    if (M == Module->getTopLevelModule() || M->getASTFile() ||
+        std::find(StackNames.begin(), StackNames.end(), M->Name) !=
+            StackNames.end() ||
+        (PPOpts.FailedModules &&
+         PPOpts.FailedModules->hasAlreadyFailed(M->Name)))
+      continue;
+    // Inferred modules are built from a module map written on the fly, which
+    // is left for when they are imported.
+    const FileEntry *ModuleMapFile = ModMap.getContainingModuleMapFile(M);
+    if (!ModuleMapFile ||
+        ModuleMapFile != ModMap.getModuleMapFileForUniquing(M))
+      continue;
+    std::string ModuleFileName = HS.getModuleFileName(M);
+    if (ModuleFileName.empty() ||
+        !Scheduler->ScheduledModuleFiles.insert(ModuleFileName).second ||
+        llvm::sys::fs::exists(ModuleFileName))
+      continue;
+
+    IntrusiveRefCntPtr<CompilerInvocation> Invocation =
+        createModuleBuildInvocation(ImportingInstance, M, ModuleFileName);
+    Invocation->getPreprocessorOpts().FailedModules = nullptr;
+    Invocation->getHeaderSearchOpts().ModulesBuildThreads = 0;
+    Invocation->getFrontendOpts().ShowTimers = false;
+    Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
+    Invocation->getFrontendOpts().Inputs.emplace_back(
+        ModuleMapFile->getName(),
+        getSourceInputKindFromOptions(*Invocation->getLangOpts()));
+
+    ImportingInstance.getDiagnostics().Report(
+        ImportLoc, diag::remark_module_build_scheduled)
+        << M->Name << ModuleFileName;
+    llvm::sys::fs::create_directories(
+        llvm::sys::path::parent_path(ModuleFileName));
+    Scheduler->Pool.async(buildModuleInBackground,
+                          ImportingInstance.getPCHContainerOperations(),
+                          std::move(Invocation),
+                          IntrusiveRefCntPtr<vfs::FileSystem>(
+                              &ImportingInstance.getVirtualFileSystem()),
+                          StackNames, M->IsSystem);
+  }
+}
+
+/// \brief Wait for the process holding the lock on \p ModuleFileName to finish
+/// building the module.
+///
+/// LockFileManager::waitForUnlock doubles its polling interval without bound,
+/// so a waiter can go on sleeping long after a slow build has finished, and it
+/// times out after 40 seconds even while the owner is still busy, at which
+/// point the module gets built all over again. Instead, poll for the lock file
+/// at a short interval and check on the owner now and then, only giving up
+/// on an owner which is still alive after a much longer time.
+///
+/// The owner is checked by constructing another LockFileManager, which reads
+/// the lock file and checks whether the process named in it is still
+/// running. While it is, no lock file of its own is created.
+static llvm::LockFileManager::WaitForUnlockResult
+waitForModuleLock(StringRef ModuleFileName) {
+  using namespace std::chrono;
+  const milliseconds MaxPollInterval(50);
+  const seconds OwnerCheckInterval(1);
+  const minutes Timeout(10);
+
+  SmallString<128> LockFileName(ModuleFileName);
+  LockFileName += ".lock";
+
+  // The owner removes its lock only after renaming the finished module file
+  // into place, so once the lock has gone the module is there to read unless
+  // the owner failed to build it.
+  auto lockReleased = [&] {
+    return llvm::sys::fs::exists(ModuleFileName)
+               ? llvm::LockFileManager::Res_Success
+               : llvm::LockFileManager::Res_OwnerDied;
+  };
+
+  auto Start = steady_clock::now();
+  auto LastOwnerCheck = Start;
+  milliseconds Interval(1);
+  while (true) {
+    std::this_thread::sleep_for(Interval);
+    Interval = std::min(Interval * 2, MaxPollInterval);
+
+    if (!llvm::sys::fs::exists(LockFileName))
+      return lockReleased();
+
+    auto Now = steady_clock::now();
+    if (Now - LastOwnerCheck < OwnerCheckInterval)
+      continue;
+    LastOwnerCheck = Now;
+
+    // Trying to take the lock checks whether its owner is still running, and
+    // clears it if not. If we do get it, just let it go again.
+    if (llvm::LockFileManager(ModuleFileName) !=
+        llvm::LockFileManager::LFS_Shared)
+      return lockReleased();
+
+    if (Now - Start > Timeout)
+      return llvm::LockFileManager::Res_Timeout;
+  }
+}
+
 static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
                                  SourceLocation ImportLoc,
                                  SourceLocation ModuleNameLoc, Module *Module,
@@ -1189,7 +1566,9 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
       return false;
 
     case llvm::LockFileManager::LFS_Owned:
-      // We're responsible for building the module ourselves.
+      // We're responsible for building the module ourselves. Its siblings
+      // and imports can be built at the same time.
+      scheduleModuleBuilds(ImportingInstance, ImportLoc, Module);
       if (!compileModuleImpl(ImportingInstance, ModuleNameLoc, Module,
                              ModuleFileName)) {
         diagnoseBuildFailure();
@@ -1197,10 +1576,16 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
       }
       break;
 
-    case llvm::LockFileManager::LFS_Shared:
+    case llvm::LockFileManager::LFS_Shared: {
       // Someone else is responsible for building the module. Wait for them to
       // finish.
-      switch (Locked.waitForUnlock()) {
+      auto WaitStart = std::chrono::steady_clock::now();
+      auto WaitResult = waitForModuleLock(ModuleFileName);
+      ImportingInstance.noteModuleLockWait(
+          std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        WaitStart)
+              .count());
+      switch (WaitResult) {
       case llvm::LockFileManager::Res_Success:
         ModuleLoadCapabilities |= ASTReader::ARR_OutOfDate;
         break;
@@ -1215,6 +1600,7 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
       }
       break;
     }
+    }
 
     // Try to read the module file, now that we've compiled it.
     ASTReader::ASTReadResult ReadResult =
@@ -1239,6 +1625,325 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
   }
 }
 
+/// \brief Collect the names of the headers which are included with angle
+/// brackets at the start of \p Buffer, before any line other than comments.
+static void collectLeadingIncludes(StringRef Buffer,
+                                   SmallVectorImpl<StringRef> &Names) {
+  while (true) {
+    Buffer = Buffer.ltrim();
+    if (Buffer.startswith("//")) {
+      Buffer = Buffer.substr(Buffer.find('\n'));
+      continue;
+    }
+    if (Buffer.startswith("/*")) {
+      size_t End = Buffer.find("*/", 2);
+      if (End == StringRef::npos)
+        return;
+      Buffer = Buffer.substr(End + 2);
+      continue;
+    }
+    if (!Buffer.startswith("#"))
+      return;
+
+    // Anything unusual, like a line continuation or a trailing block comment,
+    // ends the list.
+    StringRef Line = Buffer.substr(0, Buffer.find('\n'));
+    StringRef Rest = Line.drop_front().ltrim(" \t");
+    if (Line.find('\\') != StringRef::npos || !Rest.startswith("include"))
+      return;
+    Rest = Rest.drop_front(strlen("include")).ltrim(" \t");
+    size_t Close = Rest.find('>');
+    if (!Rest.startswith("<") || Close == StringRef::npos)
+      return;
+    StringRef Tail = Rest.substr(Close + 1).trim(" \t\r");
+    if (!Tail.empty() && !Tail.startswith("//"))
+      return;
+    Names.push_back(Rest.slice(1, Close));
+    Buffer = Buffer.substr(Line.size());
+  }
+}
+
+namespace {
+/// \brief Checks that none of the input files of a precompiled header were
+/// modified after it was written, and collects them.
+class PCHInputFileChecker : public ASTReaderListener {
+  vfs::FileSystem &FS;
+  llvm::sys::TimePoint<> PCHTime;
+
+public:
+  bool IsStale = false;
+  std::vector<std::pair<std::string, bool /*IsSystem*/>> Files;
+
+  PCHInputFileChecker(vfs::FileSystem &FS, llvm::sys::TimePoint<> PCHTime)
+      : FS(FS), PCHTime(PCHTime) {}
+
+  bool needsInputFileVisitation() override { return true; }
+  bool needsSystemInputFileVisitation() override { return true; }
+  bool visitInputFile(StringRef Filename, bool isSystem, bool isOverridden,
+                      bool isExplicitModule) override {
+    llvm::ErrorOr<vfs::Status> Status = FS.status(Filename);
+    if (!Status || Status->getLastModificationTime() > PCHTime) {
+      IsStale = true;
+      return false;
+    }
+    Files.emplace_back(Filename, isSystem);
+    return true;
+  }
+};
+} // end anonymous namespace
+
+/// \brief Check whether the precompiled builtin headers \p PCHFile exist, can
+/// be used by \p CI and are newer than all of their input files, which are
+/// then returned in \p Inputs.
+static bool
+checkBuiltinHeadersPCH(CompilerInstance &CI, StringRef PCHFile,
+                       std::vector<std::pair<std::string, bool>> &Inputs) {
+  vfs::FileSystem &FS = CI.getVirtualFileSystem();
+  llvm::ErrorOr<vfs::Status> Status = FS.status(PCHFile);
+  if (!Status)
+    return false;
+
+  // Use a file manager of our own, so that the one of the compilation never
+  // caches the PCH file from before it was rebuilt.
+  FileManager FileMgr(CI.getFileSystemOpts(), &FS);
+  if (!ASTReader::isAcceptableASTFile(
+          PCHFile, FileMgr, CI.getPCHContainerReader(), CI.getLangOpts(),
+          CI.getTargetOpts(), CI.getPreprocessorOpts(),
+          CI.getSpecificModuleCachePath()))
+    return false;
+
+  PCHInputFileChecker Checker(FS, Status->getLastModificationTime());
+  if (ASTReader::readASTFileControlBlock(
+          PCHFile, FileMgr, CI.getPCHContainerReader(),
+          /*FindModuleFileExtensions=*/false, Checker,
+          /*ValidateDiagnosticOptions=*/false) ||
+      Checker.IsStale)
+    return false;
+
+  Inputs = std::move(Checker.Files);
+  return true;
+}
+
+/// \brief Build the precompiled builtin headers \p PCHFile from \p HeaderFile,
+/// which includes \p Headers, using the options of \p CI.
+static bool buildBuiltinHeadersPCH(CompilerInstance &CI, InputKind IK,
+                                   StringRef HeaderFile, StringRef PCHFile,
+                                   ArrayRef<StringRef> Headers) {
+  // The header is named after the headers it includes, so once written it
+  // never needs to change.
+  if (!llvm::sys::fs::exists(HeaderFile)) {
+    std::string Contents = "#pragma once\n";
+    for (StringRef Header : Headers)
+      Contents += ("#include <" + Header + ">\n").str();
+    if (writeFileAtomically(HeaderFile, Contents))
+      return false;
+  }
+
+  // Construct a compiler invocation which only writes the precompiled header.
+  IntrusiveRefCntPtr<CompilerInvocation> Invocation(
+      new CompilerInvocation(CI.getInvocation()));
+  FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
+  FrontendOpts.ProgramAction = frontend::GeneratePCH;
+  FrontendOpts.OutputFile = PCHFile;
+  FrontendOpts.Inputs.clear();
+  FrontendOpts.Inputs.emplace_back(HeaderFile, IK);
+  FrontendOpts.BuiltinHeadersPCHPath.clear();
+  FrontendOpts.AddPluginActions.clear();
+  FrontendOpts.IndexStorePath.clear();
+  FrontendOpts.StatsFile.clear();
+  FrontendOpts.TimeTracePath.clear();
+  FrontendOpts.ShowStats = false;
+  FrontendOpts.ShowTimers = false;
+  FrontendOpts.ShowTemplateProfile = false;
+  FrontendOpts.RelocatablePCH = false;
+  FrontendOpts.DisableFree = false;
+  Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
+  DiagnosticOptions &DiagOpts = Invocation->getDiagnosticOpts();
+  DiagOpts.VerifyDiagnostics = 0;
+  DiagOpts.DiagnosticLogFile.clear();
+  DiagOpts.DiagnosticSerializationFile.clear();
+
+  // Problems in the builtin headers are reported when they are parsed without
+  // the precompiled header instead.
+  CompilerInstance Instance(CI.getPCHContainerOperations());
+  Instance.setInvocation(&*Invocation);
+  Instance.createDiagnostics(new IgnoringDiagConsumer(),
+                             /*ShouldOwnClient=*/true);
+  Instance.setVirtualFileSystem(&CI.getVirtualFileSystem());
+
+  CI.getDiagnosticClient().BeginSourceFile(CI.getLangOpts(), nullptr);
+  CI.getDiagnostics().Report(diag::remark_builtin_headers_pch_build) << PCHFile;
+  CI.getDiagnosticClient().EndSourceFile();
+
+  // Execute the action on a separate thread so that we get a stack large
+  // enough, as for modules.
+  GeneratePCHAction CreatePCHAction;
+  const unsigned ThreadStackSize = 8 << 20;
+  llvm::CrashRecoveryContext CRC;
+  CRC.RunSafelyOnThread([&]() { Instance.ExecuteAction(CreatePCHAction); },
+                        ThreadStackSize);
+  Instance.clearOutputFiles(/*EraseFiles=*/true);
+
+  return !Instance.getDiagnostics().hasErrorOccurred();
+}
+
+bool CompilerInstance::setUpBuiltinHeadersPCH(const FrontendInputFile &Input) {
+  StringRef CacheDir = getFrontendOpts().BuiltinHeadersPCHPath;
+  if (CacheDir.empty() || !Input.isFile() || Input.getFile() == "-")
+    return false;
+
+  switch (Input.getKind()) {
+  case IK_C:
+  case IK_CXX:
+  case IK_ObjC:
+  case IK_ObjCXX:
+  case IK_OpenCL:
+    break;
+  default:
+    return false;
+  }
+
+  switch (getFrontendOpts().ProgramAction) {
+  case frontend::EmitAssembly:
+  case frontend::EmitBC:
+  case frontend::EmitLLVM:
+  case frontend::EmitLLVMOnly:
+  case frontend::EmitCodeGenOnly:
+  case frontend::EmitObj:
+  case frontend::ParseSyntaxOnly:
+    break;
+  default:
+    return false;
+  }
+
+  // A precompiled header can only stand for the start of a translation unit,
+  // so don't use one when anything else gets in before the included headers.
+  const LangOptions &LangOpts = getLangOpts();
+  PreprocessorOptions &PPOpts = getPreprocessorOpts();
+  if (LangOpts.Modules || LangOpts.ModulesTS || LangOpts.CUDA ||
+      !getHeaderSearchOpts().UseBuiltinIncludes ||
+      !PPOpts.ImplicitPCHInclude.empty() ||
+      !PPOpts.ImplicitPTHInclude.empty() || !PPOpts.MacroIncludes.empty() ||
+      !PPOpts.ChainedIncludes.empty() || !PPOpts.RemappedFiles.empty() ||
+      !PPOpts.RemappedFileBuffers.empty() ||
+      PPOpts.PrecompiledPreambleBytes.first ||
+      getDiagnosticOpts().VerifyDiagnostics ||
+      !getFrontendOpts().CodeCompletionAt.FileName.empty())
+    return false;
+
+  if (!hasVirtualFileSystem()) {
+    IntrusiveRefCntPtr<vfs::FileSystem> VFS =
+        createVFSFromCompilerInvocation(getInvocation(), getDiagnostics());
+    if (!VFS)
+      return false;
+    setVirtualFileSystem(VFS);
+  }
+  if (!hasFileManager())
+    createFileManager();
+  FileManager &FileMgr = getFileManager();
+
+  SmallString<128> BuiltinIncludeDir(getHeaderSearchOpts().ResourceDir);
+  llvm::sys::path::append(BuiltinIncludeDir, "include");
+  auto isBuiltinHeader = [&](StringRef Name) {
+    if (Name.empty() || llvm::sys::path::is_absolute(Name) ||
+        Name.find("..") != StringRef::npos)
+      return false;
+    SmallString<128> Path(BuiltinIncludeDir);
+    llvm::sys::path::append(Path, Name);
+    return FileMgr.getFile(Path) != nullptr;
+  };
+
+  // The -include files are parsed before the main file, which is fine as
+  // long as they are builtin headers too, like the default OpenCL header.
+  if (!std::all_of(PPOpts.Includes.begin(), PPOpts.Includes.end(),
+                   isBuiltinHeader))
+    return false;
+
+  const FileEntry *MainFile = FileMgr.getFile(Input.getFile());
+  if (!MainFile)
+    return false;
+  auto Buffer = FileMgr.getBufferForFile(MainFile);
+  if (!Buffer)
+    return false;
+  SmallVector<StringRef, 8> Headers;
+  collectLeadingIncludes((*Buffer)->getBuffer(), Headers);
+  Headers.erase(std::find_if_not(Headers.begin(), Headers.end(),
+                                 isBuiltinHeader),
+                Headers.end());
+  if (Headers.empty() && PPOpts.Includes.empty())
+    return false;
+
+  // Everything that can change what the headers mean is part of the name of
+  // the precompiled header, starting with the options hashed for modules.
+  using llvm::hash_combine;
+  llvm::hash_code Code = llvm::hash_value(getInvocation().getModuleHash());
+  for (const auto &Entry : getHeaderSearchOpts().UserEntries)
+    Code = hash_combine(Code, Entry.Path, static_cast<unsigned>(Entry.Group),
+                        static_cast<bool>(Entry.IsFramework),
+                        static_cast<bool>(Entry.IgnoreSysRoot));
+  for (const auto &Prefix : getHeaderSearchOpts().SystemHeaderPrefixes)
+    Code = hash_combine(Code, Prefix.Prefix, Prefix.IsSystemHeader);
+  for (StringRef Warning : getDiagnosticOpts().Warnings)
+    Code = hash_combine(Code, Warning);
+  for (StringRef Remark : getDiagnosticOpts().Remarks)
+    Code = hash_combine(Code, Remark);
+  for (StringRef Include : PPOpts.Includes)
+    Code = hash_combine(Code, Include);
+  for (StringRef Header : Headers)
+    Code = hash_combine(Code, Header);
+  std::string Key = llvm::utohexstr(static_cast<size_t>(Code));
+
+  SmallString<128> HeaderFile(CacheDir);
+  llvm::sys::path::append(HeaderFile, Key + ".h");
+  SmallString<128> PCHFile(CacheDir);
+  llvm::sys::path::append(PCHFile, Key + ".pch");
+
+  std::vector<std::pair<std::string, bool>> Inputs;
+  if (!checkBuiltinHeadersPCH(*this, PCHFile, Inputs)) {
+    llvm::sys::fs::create_directories(CacheDir);
+    while (true) {
+      llvm::LockFileManager Locked(PCHFile);
+      if (Locked == llvm::LockFileManager::LFS_Error)
+        return false;
+
+      if (Locked == llvm::LockFileManager::LFS_Owned) {
+        // Another compilation may have finished building it in the meantime.
+        if (checkBuiltinHeadersPCH(*this, PCHFile, Inputs))
+          break;
+        if (!buildBuiltinHeadersPCH(*this, Input.getKind(), HeaderFile,
+                                    PCHFile, Headers) ||
+            !checkBuiltinHeadersPCH(*this, PCHFile, Inputs))
+          return false;
+        break;
+      }
+
+      // Someone else is building it; wait for them to finish.
+      llvm::LockFileManager::WaitForUnlockResult WaitResult =
+          waitForModuleLock(PCHFile);
+      if (WaitResult == llvm::LockFileManager::Res_OwnerDied)
+        continue;
+      if (WaitResult == llvm::LockFileManager::Res_Timeout) {
+        Locked.unsafeRemoveLockFile();
+        return false;
+      }
+      if (!checkBuiltinHeadersPCH(*this, PCHFile, Inputs))
+        return false;
+      break;
+    }
+  }
+
+  // The headers in the precompiled header are no longer entered, so list
+  // them as dependencies explicitly.
+  DependencyOutputOptions &DepOpts = getDependencyOutputOpts();
+  for (const auto &File : Inputs)
+    if (File.first != HeaderFile &&
+        (!File.second || DepOpts.IncludeSystemHeaders))
+      DepOpts.ExtraDeps.push_back(File.first);
+
+  PPOpts.ImplicitPCHInclude = PCHFile.str();
+  return true;
+}
+
 /// \brief Diagnose differences between the current definition of the given
 /// configuration macro and the definition provided on the command line.
 static void checkConfigMacro(Preprocessor &PP, StringRef ConfigMacro,
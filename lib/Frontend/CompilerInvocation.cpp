@@ -27,6 +27,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Linker/Linker.h"
@@ -508,10 +509,16 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.DebugColumnInfo = Args.hasArg(OPT_dwarf_column_info);
   Opts.EmitCodeView = Args.hasArg(OPT_gcodeview);
   Opts.WholeProgramVTables = Args.hasArg(OPT_fwhole_program_vtables);
+  Opts.DevirtualizeInternalClasses =
+      Args.hasArg(OPT_fdevirtualize_internal_classes);
+  Opts.FoldGlobalInitializers = Args.hasArg(OPT_ffold_global_initializers);
+  Opts.ShareLandingPads = Args.hasArg(OPT_fshare_landing_pads);
+  Opts.OutlineEHCleanups = Args.hasArg(OPT_foutline_eh_cleanups);
   Opts.LTOVisibilityPublicStd = Args.hasArg(OPT_flto_visibility_public_std);
   Opts.SplitDwarfFile = Args.getLastArgValue(OPT_split_dwarf_file);
   Opts.SplitDwarfInlining = !Args.hasArg(OPT_fno_split_dwarf_inlining);
   Opts.DebugTypeExtRefs = Args.hasArg(OPT_dwarf_ext_refs);
+  Opts.DebugTypeCtorHoming = Args.hasArg(OPT_fuse_ctor_homing);
   Opts.DebugExplicitImport = Triple.isPS4CPU();
 
   for (const auto &Arg : Args.getAllArgValues(OPT_fdebug_prefix_map_EQ))
@@ -528,6 +535,7 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
     OPT_fuse_register_sized_bitfield_access);
   Opts.RelaxedAliasing = Args.hasArg(OPT_relaxed_aliasing);
   Opts.StructPathTBAA = !Args.hasArg(OPT_no_struct_path_tbaa);
+  Opts.PreciseStructPathTBAA = Args.hasArg(OPT_fprecise_struct_path_tbaa);
   Opts.OpenmpCombineDirs = Args.hasArg(OPT_fopenmp_combine_dirs);
   Opts.OpenmpNonaliasedMaps = Args.hasArg(OPT_fopenmp_nonaliased_maps);
   Opts.OpenMPRequireGPURuntime = Args.hasArg(OPT_fopenmp_nvptx_requireruntime);
@@ -640,12 +648,14 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
       Diags.Report(diag::err_drv_argument_only_allowed_with)
           << A->getAsString(Args) << "-x ir";
     Opts.ThinLTOIndexFile = Args.getLastArgValue(OPT_fthinlto_index_EQ);
+    Opts.ThinLTOCacheDir = Args.getLastArgValue(OPT_fthinlto_cache_dir_EQ);
   }
 
   Opts.MSVolatile = Args.hasArg(OPT_fms_volatile);
 
   Opts.VectorizeBB = Args.hasArg(OPT_vectorize_slp_aggressive);
   Opts.VectorizeLoop = Args.hasArg(OPT_vectorize_loops);
+  Opts.VectorizeRangeFor = Args.hasArg(OPT_fvectorize_range_for);
   Opts.VectorizeSLP = Args.hasArg(OPT_vectorize_slp);
 
   Opts.MainFileName = Args.getLastArgValue(OPT_main_file_name);
@@ -913,6 +923,7 @@ static void ParseDependencyOutputArgs(DependencyOutputOptions &Opts,
   Opts.UsePhonyTargets = Args.hasArg(OPT_MP);
   Opts.ShowHeaderIncludes = Args.hasArg(OPT_H);
   Opts.HeaderIncludeOutputFile = Args.getLastArgValue(OPT_header_include_file);
+  Opts.HeaderCostFile = Args.getLastArgValue(OPT_fheader_cost_file_EQ);
   Opts.AddMissingHeaderDeps = Args.hasArg(OPT_MG);
   Opts.PrintShowIncludes = Args.hasArg(OPT_show_includes);
   Opts.DOTOutputFile = Args.getLastArgValue(OPT_dependency_dot);
@@ -1049,6 +1060,9 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.ShowSourceRanges = Args.hasArg(OPT_fdiagnostics_print_source_range_info);
   Opts.ShowParseableFixits = Args.hasArg(OPT_fdiagnostics_parseable_fixits);
   Opts.ShowPresumedLoc = !Args.hasArg(OPT_fno_diagnostics_use_presumed_location);
+  Opts.AsyncOutput = Args.hasArg(OPT_fdiagnostics_async_output);
+  Opts.BufferedOutput =
+      Opts.AsyncOutput || Args.hasArg(OPT_fdiagnostics_buffered_output);
   Opts.VerifyDiagnostics = Args.hasArg(OPT_verify);
   DiagnosticLevelMask DiagMask = DiagnosticLevelMask::None;
   Success &= parseDiagnosticLevelMask("-verify-ignore-unexpected=",
@@ -1066,6 +1080,8 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.TemplateBacktraceLimit = getLastArgIntValue(
       Args, OPT_ftemplate_backtrace_limit,
       DiagnosticOptions::DefaultTemplateBacktraceLimit, Diags);
+  Opts.TemplateArgDepth =
+      getLastArgIntValue(Args, OPT_fdiagnostics_template_depth, 0, Diags);
   Opts.ConstexprBacktraceLimit = getLastArgIntValue(
       Args, OPT_fconstexpr_backtrace_limit,
       DiagnosticOptions::DefaultConstexprBacktraceLimit, Diags);
@@ -1089,6 +1105,8 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
 
 static void ParseFileSystemArgs(FileSystemOptions &Opts, ArgList &Args) {
   Opts.WorkingDir = Args.getLastArgValue(OPT_working_directory);
+  Opts.StatCacheFile = Args.getLastArgValue(OPT_stat_cache);
+  Opts.UpdateStatCache = Args.hasArg(OPT_stat_cache_update);
 }
 
 /// Parse the argument to the -ftest-module-file-extension
@@ -1237,8 +1255,13 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ShowHelp = Args.hasArg(OPT_help);
   Opts.ShowStats = Args.hasArg(OPT_print_stats);
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
+  Opts.ShowTemplateProfile = Args.hasArg(OPT_ftemplate_profile);
+  Opts.TimeTracePath = Args.getLastArgValue(OPT_ftime_trace_EQ);
+  Opts.TimeTraceGranularity = getLastArgIntValue(
+      Args, OPT_ftime_trace_granularity_EQ, Opts.TimeTraceGranularity, Diags);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
+  Opts.IndexStorePath = Args.getLastArgValue(OPT_index_store_path);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
   Opts.FixWhatYouCan = Args.hasArg(OPT_fix_what_you_can);
   Opts.FixOnlyWarnings = Args.hasArg(OPT_fix_only_warnings);
@@ -1254,6 +1277,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ModulesEmbedFiles = Args.getAllArgValues(OPT_fmodules_embed_file_EQ);
   Opts.ModulesEmbedAllFiles = Args.hasArg(OPT_fmodules_embed_all_files);
   Opts.IncludeTimestamps = !Args.hasArg(OPT_fno_pch_timestamp);
+  Opts.SerializeRecordLayouts = Args.hasArg(OPT_fserialize_record_layouts);
 
   Opts.CodeCompleteOpts.IncludeMacros
     = Args.hasArg(OPT_code_completion_macros);
@@ -1263,6 +1287,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     = !Args.hasArg(OPT_no_code_completion_globals);
   Opts.CodeCompleteOpts.IncludeBriefComments
     = Args.hasArg(OPT_code_completion_brief_comments);
+  Opts.CodeCompleteOpts.Filter
+    = Args.getLastArgValue(OPT_code_completion_filter_EQ);
 
   Opts.OverrideRecordLayoutsFile
     = Args.getLastArgValue(OPT_foverride_record_layout_EQ);
@@ -1270,6 +1296,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       llvm::Triple::normalize(Args.getLastArgValue(OPT_aux_triple));
   Opts.FindPchSource = Args.getLastArgValue(OPT_find_pch_source_EQ);
   Opts.StatsFile = Args.getLastArgValue(OPT_stats_file);
+  Opts.BuiltinHeadersPCHPath =
+      Args.getLastArgValue(OPT_fbuiltin_headers_pch_path);
 
   if (const Arg *A = Args.getLastArg(OPT_arcmt_check,
                                      OPT_arcmt_modify,
@@ -1434,12 +1462,17 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
       getLastArgIntValue(Args, OPT_fmodules_prune_interval, 7 * 24 * 60 * 60);
   Opts.ModuleCachePruneAfter =
       getLastArgIntValue(Args, OPT_fmodules_prune_after, 31 * 24 * 60 * 60);
+  Opts.ModulesBuildThreads =
+      getLastArgIntValue(Args, OPT_fmodules_build_threads_EQ, 0);
   Opts.ModulesValidateOncePerBuildSession =
       Args.hasArg(OPT_fmodules_validate_once_per_build_session);
   Opts.BuildSessionTimestamp =
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
+  Opts.ModulesTrustedManifest =
+      Args.getLastArgValue(OPT_fmodules_trusted_manifest);
   Opts.ModulesValidateSystemHeaders =
       Args.hasArg(OPT_fmodules_validate_system_headers);
+  Opts.IndexSearchDirectories = Args.hasArg(OPT_index_header_search_dirs);
   if (const Arg *A = Args.getLastArg(OPT_fmodule_format_EQ))
     Opts.ModuleFormat = A->getValue();
 
@@ -1857,6 +1890,17 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       Opts.AppleKext = 1;
   }
 
+  if (Args.hasArg(OPT_fexperimental_relative_cxx_abi_vtables)) {
+    if (Opts.AppleKext)
+      Diags.Report(diag::err_drv_argument_not_allowed_with)
+          << "-fexperimental-relative-c++-abi-vtables" << "-fapple-kext";
+    else if (T.isWindowsMSVCEnvironment())
+      Diags.Report(diag::err_drv_unsupported_opt_for_target)
+          << "-fexperimental-relative-c++-abi-vtables" << T.str();
+    else
+      Opts.RelativeCXXABIVTables = 1;
+  }
+
   if (Args.hasArg(OPT_print_ivar_layout))
     Opts.ObjCGCBitmapPrint = 1;
   if (Args.hasArg(OPT_fno_constant_cfstrings))
@@ -2338,7 +2382,14 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
     Opts.TokenCache = Opts.ImplicitPTHInclude;
   Opts.UsePredefines = !Args.hasArg(OPT_undef);
   Opts.DetailedRecord = Args.hasArg(OPT_detailed_preprocessing_record);
+  Opts.DetailedRecordMainFileOnly =
+      Args.hasArg(OPT_detailed_preprocessing_record_main_file_only);
   Opts.DisablePCHValidation = Args.hasArg(OPT_fno_validate_pch);
+  Opts.StrictLazyPCHLoading = Args.hasArg(OPT_fpch_strict_lazy_loading);
+  Opts.ElideSystemMacroExpansionLocs =
+      Args.hasArg(OPT_felide_system_macro_expansion_locs);
+  Opts.MinimizeSourcesToDirectives =
+      Args.hasArg(OPT_minimize_sources_to_directives);
 
   Opts.DumpDeserializedPCHDecls = Args.hasArg(OPT_dump_deserialized_pch_decls);
   for (const Arg *A : Args.filtered(OPT_error_on_deserialized_pch_decl))
@@ -2581,6 +2632,10 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
   ParsePreprocessorOutputArgs(Res.getPreprocessorOutputOpts(), Args,
                               Res.getFrontendOpts().ProgramAction);
 
+  // Preprocessed output is laid out by the expansion locations of its tokens.
+  if (Res.getPreprocessorOutputOpts().ShowCPP)
+    Res.getPreprocessorOpts().ElideSystemMacroExpansionLocs = false;
+
   // Turn on -Wspir-compat for SPIR target.
   llvm::Triple T(Res.getTargetOpts().Triple);
   auto Arch = T.getArch();
@@ -2623,25 +2678,47 @@ std::string CompilerInvocation::getModuleHash() const {
   // Extend the signature with preprocessor options.
   const PreprocessorOptions &ppOpts = getPreprocessorOpts();
   const HeaderSearchOptions &hsOpts = getHeaderSearchOpts();
-  code = hash_combine(code, ppOpts.UsePredefines, ppOpts.DetailedRecord);
+  code = hash_combine(code, ppOpts.UsePredefines, ppOpts.DetailedRecord,
+                      ppOpts.DetailedRecordMainFileOnly);
+
+  // Only the net effect of the -D and -U options is checked when a module is
+  // loaded, so hash that: the last definition of each macro, in name order.
+  // Reordering or repeating the options, or writing -DX as -DX=1, then
+  // doesn't give a separate copy of every module in the cache.
+  llvm::StringMap<std::pair<std::string, bool/*isUndef*/>> Macros;
+  for (const auto &Macro : ppOpts.Macros) {
+    StringRef MacroDef, MacroBody;
+    std::tie(MacroDef, MacroBody) = StringRef(Macro.first).split('=');
 
-  for (std::vector<std::pair<std::string, bool/*isUndef*/>>::const_iterator
-            I = getPreprocessorOpts().Macros.begin(),
-         IEnd = getPreprocessorOpts().Macros.end();
-       I != IEnd; ++I) {
     // If we're supposed to ignore this macro for the purposes of modules,
     // don't put it into the hash.
-    if (!hsOpts.ModulesIgnoreMacros.empty()) {
-      // Check whether we're ignoring this macro.
-      StringRef MacroDef = I->first;
-      if (hsOpts.ModulesIgnoreMacros.count(
-              llvm::CachedHashString(MacroDef.split('=').first)))
-        continue;
-    }
+    if (hsOpts.ModulesIgnoreMacros.count(llvm::CachedHashString(MacroDef)))
+      continue;
 
-    code = hash_combine(code, I->first, I->second);
+    // Key each macro by its identifier, so that a -D of a function-like
+    // macro is replaced by a later -D or -U of the same macro. Its parameter
+    // list is part of its definition.
+    StringRef MacroName = MacroDef.substr(0, MacroDef.find('('));
+    std::string Definition;
+    if (!Macro.second) {
+      Definition = MacroDef.substr(MacroName.size());
+      Definition += '=';
+      if (MacroDef.size() == Macro.first.size())
+        Definition += '1';
+      else
+        Definition += MacroBody.substr(0, MacroBody.find_first_of("\n\r"));
+    }
+    Macros[MacroName] = std::make_pair(std::move(Definition), Macro.second);
   }
 
+  std::vector<StringRef> MacroNames;
+  for (const auto &Macro : Macros)
+    MacroNames.push_back(Macro.getKey());
+  std::sort(MacroNames.begin(), MacroNames.end());
+  for (StringRef MacroName : MacroNames)
+    code = hash_combine(code, MacroName, Macros[MacroName].first,
+                        Macros[MacroName].second);
+
   // Extend the signature with the sysroot and other header search options.
   code = hash_combine(code, hsOpts.Sysroot,
                       hsOpts.ModuleFormat,
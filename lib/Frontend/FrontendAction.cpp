@@ -22,6 +22,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Parse/ParseAST.h"
+#include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
@@ -142,8 +143,17 @@ FrontendAction::CreateWrappedASTConsumer(CompilerInstance &CI,
   if (!Consumer)
     return nullptr;
 
-  // If there are no registered plugins we don't need to wrap the consumer
-  if (FrontendPluginRegistry::begin() == FrontendPluginRegistry::end())
+  std::unique_ptr<ASTConsumer> HeaderCostConsumer;
+  StringRef HeaderCostFile = CI.getDependencyOutputOpts().HeaderCostFile;
+  if (!HeaderCostFile.empty() && CI.hasPreprocessor() &&
+      !isModelParsingAction())
+    HeaderCostConsumer =
+        CreateHeaderCostConsumer(CI.getPreprocessor(), HeaderCostFile);
+
+  // If there are no registered plugins or header costs to record we don't
+  // need to wrap the consumer
+  if (FrontendPluginRegistry::begin() == FrontendPluginRegistry::end() &&
+      !HeaderCostConsumer)
     return Consumer;
 
   // Collect the list of plugins that go before the main action (in Consumers)
@@ -183,6 +193,8 @@ FrontendAction::CreateWrappedASTConsumer(CompilerInstance &CI,
   for (auto &C : AfterConsumers) {
     Consumers.push_back(std::move(C));
   }
+  if (HeaderCostConsumer)
+    Consumers.push_back(std::move(HeaderCostConsumer));
 
   return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
 }
@@ -403,6 +415,11 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
     assert((!CI.getLangOpts().Modules || CI.getModuleManager()) &&
            "modules enabled but created an external source that "
            "doesn't support modules");
+
+    // The external source only knows about the builtins it referred to.
+    Preprocessor &PP = CI.getPreprocessor();
+    PP.getBuiltinInfo().initializeBuiltinsForAST(PP.getIdentifierTable(),
+                                                 PP.getLangOpts());
   }
 
   // If we were asked to load any module map files, do so now.
@@ -505,6 +522,7 @@ void FrontendAction::EndSourceFile() {
     CI.getPreprocessor().getIdentifierTable().PrintStats();
     CI.getPreprocessor().getHeaderSearchInfo().PrintStats();
     CI.getSourceManager().PrintStats();
+    CI.PrintStats();
     llvm::errs() << "\n";
   }
 
@@ -557,6 +575,9 @@ void ASTFrontendAction::ExecuteAction() {
 
   ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
            CI.getFrontendOpts().SkipFunctionBodies);
+
+  if (const TemplateProfiler *Profile = CI.getSema().TemplateProfile.get())
+    Profile->print(llvm::errs(), CI.getSourceManager());
 }
 
 void PluginASTAction::anchor() { }
@@ -0,0 +1,388 @@
+//===--- HeaderCostGen.cpp - Generate Header Costs ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements -fheader-cost-file=, which adds up what each header
+//  costs across the translation units of a build, to tell which headers are
+//  worth splitting or turning into modules first.
+//
+//  The summary file has a line per header, costliest first:
+//
+//    <TUs> <includes> <time (us)> <tokens> <decls> <instantiations>
+//    <AST bytes> <path>
+//
+//  separated by tabs. The time, tokens and AST memory are those spent while
+//  the header was the current file, without the headers it includes. The
+//  instantiations are those whose point of instantiation is in the header.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileUtilities.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+#include <vector>
+using namespace clang;
+
+namespace {
+typedef std::chrono::steady_clock ClockType;
+
+/// The cost of a header in one translation unit.
+struct FileCost {
+  unsigned Includes = 0;
+  ClockType::duration Time = ClockType::duration::zero();
+  unsigned Tokens = 0;
+  unsigned Decls = 0;
+  unsigned Instantiations = 0;
+  size_t ASTBytes = 0;
+};
+
+/// The cost of a header summed over translation units, as in the summary
+/// file.
+struct HeaderCost {
+  uint64_t TranslationUnits = 0;
+  uint64_t Includes = 0;
+  uint64_t Microseconds = 0;
+  uint64_t Tokens = 0;
+  uint64_t Decls = 0;
+  uint64_t Instantiations = 0;
+  uint64_t ASTBytes = 0;
+
+  void add(const HeaderCost &Other) {
+    TranslationUnits += Other.TranslationUnits;
+    Includes += Other.Includes;
+    Microseconds += Other.Microseconds;
+    Tokens += Other.Tokens;
+    Decls += Other.Decls;
+    Instantiations += Other.Instantiations;
+    ASTBytes += Other.ASTBytes;
+  }
+};
+
+/// Charges the time, the tokens and the AST memory to the file the
+/// preprocessor is in, and the declarations and instantiations to the file
+/// they are at.
+///
+/// The preprocessor owns the collector, as it outlives the consumer.
+class HeaderCostCollector : public PPCallbacks {
+  const Preprocessor &PP;
+  SourceManager &SM;
+  const ASTContext *Context;
+  llvm::DenseMap<const FileEntry *, FileCost> Costs;
+
+  /// The file the preprocessor is in, if it is a file at all.
+  const FileEntry *CurrentFile;
+  ClockType::time_point LastTime;
+  unsigned LastTokens;
+  size_t LastASTBytes;
+
+  size_t getASTBytes() const {
+    return Context ? Context->getAllocator().getBytesAllocated() : 0;
+  }
+
+  FileCost *getCost(SourceLocation Loc);
+
+public:
+  explicit HeaderCostCollector(const Preprocessor &PP)
+      : PP(PP), SM(PP.getSourceManager()), Context(nullptr),
+        CurrentFile(nullptr), LastTime(ClockType::now()), LastTokens(0),
+        LastASTBytes(0) {}
+
+  void setASTContext(const ASTContext &C) {
+    Context = &C;
+    LastASTBytes = getASTBytes();
+  }
+
+  /// \brief Charges the costs since the last change of file to the current
+  /// file.
+  void charge();
+
+  void countDecl(SourceLocation Loc) {
+    if (FileCost *Cost = getCost(Loc))
+      ++Cost->Decls;
+  }
+
+  void countInstantiation(SourceLocation PointOfInstantiation) {
+    if (FileCost *Cost = getCost(PointOfInstantiation))
+      ++Cost->Instantiations;
+  }
+
+  /// \brief Adds the costs of the headers to the totals in \p OutputPath.
+  void write(StringRef OutputPath);
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override;
+};
+
+class HeaderCostConsumer : public ASTConsumer,
+                           public RecursiveASTVisitor<HeaderCostConsumer> {
+  HeaderCostCollector &Collector;
+  std::string OutputPath;
+  std::vector<Decl *> TopLevelDecls;
+
+public:
+  HeaderCostConsumer(HeaderCostCollector &Collector, StringRef OutputPath)
+      : Collector(Collector), OutputPath(OutputPath) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+
+  void Initialize(ASTContext &Context) override {
+    Collector.setASTContext(Context);
+  }
+
+  bool HandleTopLevelDecl(DeclGroupRef D) override {
+    TopLevelDecls.insert(TopLevelDecls.end(), D.begin(), D.end());
+    return true;
+  }
+
+  void HandleTranslationUnit(ASTContext &Context) override;
+
+  bool VisitDecl(Decl *D);
+};
+} // end anonymous namespace
+
+FileCost *HeaderCostCollector::getCost(SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return nullptr;
+  const FileEntry *File =
+      SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
+  return File ? &Costs[File] : nullptr;
+}
+
+void HeaderCostCollector::charge() {
+  ClockType::time_point Now = ClockType::now();
+  unsigned Tokens = PP.getNumLexedFileTokens();
+  size_t ASTBytes = getASTBytes();
+  if (CurrentFile) {
+    FileCost &Cost = Costs[CurrentFile];
+    Cost.Time += Now - LastTime;
+    Cost.Tokens += Tokens - LastTokens;
+    Cost.ASTBytes += ASTBytes - LastASTBytes;
+  }
+  LastTime = Now;
+  LastTokens = Tokens;
+  LastASTBytes = ASTBytes;
+}
+
+void HeaderCostCollector::FileChanged(SourceLocation Loc,
+                                      FileChangeReason Reason,
+                                      SrcMgr::CharacteristicKind FileType,
+                                      FileID PrevFID) {
+  if (Reason != PPCallbacks::EnterFile && Reason != PPCallbacks::ExitFile)
+    return;
+
+  // On leaving a file, Loc is in the file which included it.
+  charge();
+  CurrentFile = SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
+  if (Reason == PPCallbacks::EnterFile && CurrentFile)
+    ++Costs[CurrentFile].Includes;
+}
+
+/// Reads the totals in the summary file \p Buffer into \p Totals.
+static void readHeaderCosts(StringRef Buffer,
+                            llvm::StringMap<HeaderCost> &Totals) {
+  SmallVector<StringRef, 16> Lines;
+  Buffer.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    if (Line.startswith("#"))
+      continue;
+    SmallVector<StringRef, 8> Fields;
+    Line.split(Fields, '\t', /*MaxSplit=*/7);
+    HeaderCost Cost;
+    if (Fields.size() != 8 ||
+        Fields[0].getAsInteger(10, Cost.TranslationUnits) ||
+        Fields[1].getAsInteger(10, Cost.Includes) ||
+        Fields[2].getAsInteger(10, Cost.Microseconds) ||
+        Fields[3].getAsInteger(10, Cost.Tokens) ||
+        Fields[4].getAsInteger(10, Cost.Decls) ||
+        Fields[5].getAsInteger(10, Cost.Instantiations) ||
+        Fields[6].getAsInteger(10, Cost.ASTBytes))
+      continue;
+    Totals[Fields[7]].add(Cost);
+  }
+}
+
+/// Adds \p Costs to the totals in the summary file \p OutputPath, which the
+/// caller has locked.
+static std::error_code
+addHeaderCosts(StringRef OutputPath,
+               const llvm::StringMap<HeaderCost> &Costs) {
+  llvm::StringMap<HeaderCost> Totals;
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+          llvm::MemoryBuffer::getFile(OutputPath))
+    readHeaderCosts((*File)->getBuffer(), Totals);
+  for (const auto &Cost : Costs)
+    Totals[Cost.first()].add(Cost.second);
+
+  std::vector<std::pair<StringRef, const HeaderCost *>> Sorted;
+  for (const auto &Total : Totals)
+    Sorted.push_back(std::make_pair(Total.first(), &Total.second));
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const std::pair<StringRef, const HeaderCost *> &A,
+               const std::pair<StringRef, const HeaderCost *> &B) {
+              if (A.second->Microseconds != B.second->Microseconds)
+                return A.second->Microseconds > B.second->Microseconds;
+              return A.first < B.first;
+            });
+
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  OS << "# TUs\tincludes\ttime (us)\ttokens\tdecls\tinstantiations\t"
+        "AST bytes\theader\n";
+  for (const auto &Entry : Sorted) {
+    const HeaderCost &Cost = *Entry.second;
+    OS << Cost.TranslationUnits << '\t' << Cost.Includes << '\t'
+       << Cost.Microseconds << '\t' << Cost.Tokens << '\t' << Cost.Decls
+       << '\t' << Cost.Instantiations << '\t' << Cost.ASTBytes << '\t'
+       << Entry.first << '\n';
+  }
+  OS.flush();
+
+  // A failed compilation must never leave a partially written summary behind.
+  return writeFileAtomically(OutputPath, Contents);
+}
+
+void HeaderCostCollector::write(StringRef OutputPath) {
+  charge();
+
+  // Name the headers by their absolute paths, so that the translation units
+  // of a build agree on them whatever their working directory.
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  llvm::StringMap<HeaderCost> HeaderCosts;
+  for (const auto &Entry : Costs) {
+    if (Entry.first == MainFile)
+      continue;
+    SmallString<256> Path(Entry.first->getName());
+    PP.getFileManager().makeAbsolutePath(Path);
+    llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+
+    const FileCost &Cost = Entry.second;
+    HeaderCost &Total = HeaderCosts[Path];
+    Total.TranslationUnits = 1;
+    Total.Includes += Cost.Includes;
+    Total.Microseconds +=
+        std::chrono::duration_cast<std::chrono::microseconds>(Cost.Time)
+            .count();
+    Total.Tokens += Cost.Tokens;
+    Total.Decls += Cost.Decls;
+    Total.Instantiations += Cost.Instantiations;
+    Total.ASTBytes += Cost.ASTBytes;
+  }
+
+  // The compilations of a build update the summary one at a time.
+  std::error_code EC;
+  while (true) {
+    llvm::LockFileManager Lock(OutputPath);
+    switch (Lock) {
+    case llvm::LockFileManager::LFS_Error:
+      // Better an update which might race with another one than none.
+    case llvm::LockFileManager::LFS_Owned:
+      EC = addHeaderCosts(OutputPath, HeaderCosts);
+      break;
+    case llvm::LockFileManager::LFS_Shared:
+      if (Lock.waitForUnlock() == llvm::LockFileManager::Res_Timeout)
+        Lock.unsafeRemoveLockFile();
+      continue;
+    }
+    break;
+  }
+  if (EC)
+    PP.getDiagnostics().Report(diag::warn_fe_header_cost_file_failure)
+        << OutputPath << EC.message();
+}
+
+/// Returns whether \p D was implicitly instantiated, and if so sets
+/// \p PointOfInstantiation to where its definition was instantiated from, or
+/// to an invalid location if only its declaration was.
+static bool isImplicitInstantiation(const Decl *D,
+                                    SourceLocation &PointOfInstantiation) {
+  PointOfInstantiation = SourceLocation();
+  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    if (FD->getTemplateSpecializationKind() != TSK_ImplicitInstantiation)
+      return false;
+    if (FD->isThisDeclarationADefinition())
+      PointOfInstantiation = FD->getPointOfInstantiation();
+    return true;
+  }
+  if (const auto *Spec = dyn_cast<ClassTemplateSpecializationDecl>(D)) {
+    if (Spec->getSpecializationKind() != TSK_ImplicitInstantiation)
+      return false;
+    if (Spec->isCompleteDefinition())
+      PointOfInstantiation = Spec->getPointOfInstantiation();
+    return true;
+  }
+  if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
+    const MemberSpecializationInfo *MSI = RD->getMemberSpecializationInfo();
+    if (!MSI ||
+        MSI->getTemplateSpecializationKind() != TSK_ImplicitInstantiation)
+      return false;
+    if (RD->isCompleteDefinition())
+      PointOfInstantiation = MSI->getPointOfInstantiation();
+    return true;
+  }
+  if (const auto *VD = dyn_cast<VarDecl>(D)) {
+    if (VD->getTemplateSpecializationKind() != TSK_ImplicitInstantiation)
+      return false;
+    if (VD->isThisDeclarationADefinition())
+      PointOfInstantiation = VD->getPointOfInstantiation();
+    return true;
+  }
+  return false;
+}
+
+bool HeaderCostConsumer::VisitDecl(Decl *D) {
+  if (D->isImplicit())
+    return true;
+
+  SourceLocation PointOfInstantiation;
+  if (isImplicitInstantiation(D, PointOfInstantiation)) {
+    Collector.countInstantiation(PointOfInstantiation);
+    return true;
+  }
+
+  // The members of an instantiation are part of the instantiation, not
+  // declarations of the header the template is in.
+  for (const DeclContext *DC = D->getDeclContext(); DC && !DC->isFileContext();
+       DC = DC->getParent())
+    if (isImplicitInstantiation(cast<Decl>(DC), PointOfInstantiation))
+      return true;
+
+  Collector.countDecl(D->getLocation());
+  return true;
+}
+
+void HeaderCostConsumer::HandleTranslationUnit(ASTContext &Context) {
+  for (Decl *D : TopLevelDecls)
+    TraverseDecl(D);
+  Collector.write(OutputPath);
+}
+
+std::unique_ptr<ASTConsumer>
+clang::CreateHeaderCostConsumer(Preprocessor &PP, StringRef OutputPath) {
+  auto Collector = llvm::make_unique<HeaderCostCollector>(PP);
+  auto Consumer =
+      llvm::make_unique<HeaderCostConsumer>(*Collector, OutputPath);
+  PP.addPPCallbacks(std::move(Collector));
+  return std::move(Consumer);
+}
@@ -25,6 +25,9 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Serialization/ASTReader.h"
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ManagedStatic.h"
+#include <mutex>
 using namespace clang;
 
 static bool MacroBodyEndsInBackslash(StringRef MacroBody) {
@@ -1017,24 +1020,13 @@ static void InitializePredefinedMacros(const TargetInfo &TI,
   TI.getTargetDefines(LangOpts, Builder);
 }
 
-/// InitializePreprocessor - Initialize the preprocessor getting it and the
-/// environment ready to process a single file. This returns true on error.
-///
-void clang::InitializePreprocessor(
-    Preprocessor &PP, const PreprocessorOptions &InitOpts,
-    const PCHContainerReader &PCHContainerRdr,
-    const FrontendOptions &FEOpts) {
+/// Add the macros predefined by the compiler, as opposed to those from the
+/// command line, for the target and the language.
+static void InitializeBuiltinMacros(Preprocessor &PP,
+                                    const PreprocessorOptions &InitOpts,
+                                    const FrontendOptions &FEOpts,
+                                    MacroBuilder &Builder) {
   const LangOptions &LangOpts = PP.getLangOpts();
-  std::string PredefineBuffer;
-  PredefineBuffer.reserve(4080);
-  llvm::raw_string_ostream Predefines(PredefineBuffer);
-  MacroBuilder Builder(Predefines);
-
-  // Emit line markers for various builtin sections of the file.  We don't do
-  // this in asm preprocessor mode, because "# 4" is not a line marker directive
-  // in this mode.
-  if (!PP.getLangOpts().AsmPreprocessor)
-    Builder.append("# 1 \"<built-in>\" 3");
 
   // Install things like __POWERPC__, __GNUC__, etc into the macro table.
   if (InitOpts.UsePredefines) {
@@ -1065,6 +1057,117 @@ void clang::InitializePreprocessor(
   // current language configuration.
   InitializeStandardPredefinedMacros(PP.getTargetInfo(), PP.getLangOpts(),
                                      FEOpts, Builder);
+}
+
+static void addTargetOptionsToKey(const TargetOptions &Opts,
+                                  raw_ostream &OS) {
+  OS << Opts.Triple << '\0' << Opts.CPU << '\0' << Opts.FPMath << '\0'
+     << Opts.ABI << '\0' << Opts.EABIVersion << '\0';
+  for (const std::string &Feature : Opts.FeaturesAsWritten)
+    OS << Feature << ',';
+  OS << '\0';
+  for (const std::string &Feature : Opts.Features)
+    OS << Feature << ',';
+  OS << '\0';
+}
+
+/// Returns a key identifying everything the built-in macros depend on, or an
+/// empty string if they can't be cached.
+static std::string getBuiltinMacrosKey(const Preprocessor &PP,
+                                       const PreprocessorOptions &InitOpts,
+                                       const FrontendOptions &FEOpts) {
+  const LangOptions &LangOpts = PP.getLangOpts();
+  // The OpenCL extension macros depend on the target's supported extensions,
+  // which can be changed after the target is created.
+  if (LangOpts.OpenCL)
+    return std::string();
+
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  addTargetOptionsToKey(PP.getTargetInfo().getTargetOpts(), OS);
+  if (const TargetInfo *AuxTarget = PP.getAuxTargetInfo())
+    addTargetOptionsToKey(AuxTarget->getTargetOpts(), OS);
+  OS << '\0';
+#define LANGOPT(Name, Bits, Default, Description) OS << LangOpts.Name << ',';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+  OS << static_cast<unsigned>(LangOpts.get##Name()) << ',';
+#include "clang/Basic/LangOptions.def"
+  OS << LangOpts.ObjCRuntime.getAsString() << '\0' << LangOpts.Sanitize.Mask
+     << '\0' << InitOpts.UsePredefines << ','
+     << static_cast<unsigned>(InitOpts.ObjCXXARCStandardLibrary) << ','
+     << static_cast<unsigned>(FEOpts.ProgramAction);
+  return OS.str();
+}
+
+namespace {
+/// The built-in part of the predefines buffer for each configuration, so
+/// that a process which sets up many preprocessors, like an indexer or a
+/// tool running over a compilation database, only builds it once.
+struct BuiltinMacrosCache {
+  std::mutex Mutex;
+  llvm::StringMap<std::string> Buffers;
+};
+} // end anonymous namespace
+
+static llvm::ManagedStatic<BuiltinMacrosCache> CachedBuiltinMacros;
+
+/// The number of configurations whose built-in macros are kept.
+static const unsigned MaxCachedBuiltinMacros = 16;
+
+static void AddBuiltinMacros(Preprocessor &PP,
+                             const PreprocessorOptions &InitOpts,
+                             const FrontendOptions &FEOpts,
+                             MacroBuilder &Builder, raw_ostream &Predefines) {
+  std::string Key = getBuiltinMacrosKey(PP, InitOpts, FEOpts);
+  if (Key.empty()) {
+    InitializeBuiltinMacros(PP, InitOpts, FEOpts, Builder);
+    return;
+  }
+
+  BuiltinMacrosCache &Cache = *CachedBuiltinMacros;
+  {
+    std::lock_guard<std::mutex> Lock(Cache.Mutex);
+    auto Known = Cache.Buffers.find(Key);
+    if (Known != Cache.Buffers.end()) {
+      Predefines << Known->second;
+      return;
+    }
+  }
+
+  std::string Buffer;
+  {
+    llvm::raw_string_ostream OS(Buffer);
+    MacroBuilder BufferBuilder(OS);
+    InitializeBuiltinMacros(PP, InitOpts, FEOpts, BufferBuilder);
+  }
+  Predefines << Buffer;
+
+  std::lock_guard<std::mutex> Lock(Cache.Mutex);
+  if (Cache.Buffers.size() >= MaxCachedBuiltinMacros)
+    Cache.Buffers.clear();
+  Cache.Buffers[Key] = std::move(Buffer);
+}
+
+/// InitializePreprocessor - Initialize the preprocessor getting it and the
+/// environment ready to process a single file. This returns true on error.
+///
+void clang::InitializePreprocessor(
+    Preprocessor &PP, const PreprocessorOptions &InitOpts,
+    const PCHContainerReader &PCHContainerRdr,
+    const FrontendOptions &FEOpts) {
+  const LangOptions &LangOpts = PP.getLangOpts();
+  std::string PredefineBuffer;
+  PredefineBuffer.reserve(4080);
+  llvm::raw_string_ostream Predefines(PredefineBuffer);
+  MacroBuilder Builder(Predefines);
+
+  // Emit line markers for various builtin sections of the file.  We don't do
+  // this in asm preprocessor mode, because "# 4" is not a line marker directive
+  // in this mode.
+  if (!PP.getLangOpts().AsmPreprocessor)
+    Builder.append("# 1 \"<built-in>\" 3");
+
+  AddBuiltinMacros(PP, InitOpts, FEOpts, Builder, Predefines);
 
   // Add on the predefines from the driver.  Wrap in a #line directive to report
   // that they come from the command line.
@@ -28,6 +28,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <cstring>
 using namespace clang;
 
 /// PrintMacroDefinition - Print a macro definition in a form that will be
@@ -642,6 +643,28 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+/// Returns true if \p Tok may be a C++ operator keyword, like 'or', that is
+/// as long as the punctuator it stands for.
+static bool mayBeSameLengthOperatorKeyword(const Token &Tok) {
+  switch (Tok.getKind()) {
+#define CXX_KEYWORD_OPERATOR(X, Y) \
+  case tok::Y: return Tok.getLength() == sizeof(#X) - 1;
+#include "clang/Basic/TokenKinds.def"
+  default:
+    return false;
+  }
+}
+
+/// Returns true if \p Tok is a punctuator spelled as its kind.  Digraphs
+/// and escaped newlines both make the token longer than that spelling, so a
+/// punctuator of the same length can be written without reading the source,
+/// unless it may be an operator keyword of that length.
+static bool isPlainPunctuator(const Token &Tok) {
+  const char *Spelling = tok::getPunctuatorSpelling(Tok.getKind());
+  return Spelling && std::strlen(Spelling) == Tok.getLength() &&
+         !mayBeSameLengthOperatorKeyword(Tok);
+}
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
@@ -688,6 +711,8 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
                Tok.getLiteralData()) {
       OS.write(Tok.getLiteralData(), Tok.getLength());
+    } else if (isPlainPunctuator(Tok)) {
+      OS << tok::getPunctuatorSpelling(Tok.getKind());
     } else if (Tok.getLength() < 256) {
       const char *TokPtr = Buffer;
       unsigned Len = PP.getSpelling(Tok, TokPtr);
@@ -20,7 +20,9 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <utility>
 
@@ -107,6 +109,10 @@ public:
     return readDiagnostics(File);
   }
 
+  std::error_code mergeRecordsFromBuffer(llvm::MemoryBufferRef Buffer) {
+    return readDiagnostics(Buffer);
+  }
+
 protected:
   std::error_code visitStartOfDiagnostic() override;
   std::error_code visitEndOfDiagnostic() override;
@@ -159,6 +165,10 @@ public:
 
   ~SDiagsWriter() override {}
 
+  /// \brief Writes the diagnostics of \p InputFiles to \p OutputFile.
+  static std::error_code mergeFiles(ArrayRef<std::string> InputFiles,
+                                    StringRef OutputFile);
+
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
                         const Diagnostic &Info) override;
 
@@ -177,6 +187,9 @@ private:
   /// merge into our own.
   void RemoveOldDiagnostics();
 
+  /// \brief Write the bitstream built so far to the output file.
+  std::error_code writeOutputFile();
+
   /// \brief Emit the preamble for the serialized diagnostics.
   void EmitPreamble();
   
@@ -218,8 +231,15 @@ private:
   unsigned getEmitDiagnosticFlag(StringRef DiagName);
 
   /// \brief Emit (lazily) the file string and retrieved the file identifier.
+  ///
+  /// \p Filename must stay valid as long as this writer, like the names of
+  /// PresumedLocs do.
   unsigned getEmitFile(const char *Filename);
 
+  /// \brief Emit (lazily) the file string of a transient file name, such as
+  /// one read from another diagnostics file.
+  unsigned getEmitFile(StringRef Filename);
+
   /// \brief Add SourceLocation information the specified record.  
   void AddLocToRecord(SourceLocation Loc, const SourceManager *SM,
                       PresumedLoc PLoc, RecordDataImpl &Record,
@@ -280,14 +300,18 @@ private:
     /// \brief The collection of diagnostic categories used.
     llvm::DenseSet<unsigned> Categories;
 
-    /// \brief The collection of files used.
+    /// \brief The IDs of the files used, by the address of their name.
     llvm::DenseMap<const char *, unsigned> Files;
 
-    typedef llvm::DenseMap<const void *, std::pair<unsigned, StringRef> >
-    DiagFlagsTy;
+    /// \brief The IDs of the files used, by name.
+    llvm::StringMap<unsigned> FileNames;
 
-    /// \brief Map for uniquing strings.
-    DiagFlagsTy DiagFlags;
+    /// \brief The IDs of the diagnostic flags used, by the address of their
+    /// static name.
+    llvm::DenseMap<const void *, unsigned> DiagFlags;
+
+    /// \brief The IDs of the diagnostic flags used, by name.
+    llvm::StringMap<unsigned> DiagFlagNames;
 
     /// \brief Whether we have already started emission of any DIAG blocks. Once
     /// this becomes \c true, we never close a DIAG block until we know that we're
@@ -310,6 +334,11 @@ create(StringRef OutputFile, DiagnosticOptions *Diags, bool MergeChildRecords) {
   return llvm::make_unique<SDiagsWriter>(OutputFile, Diags, MergeChildRecords);
 }
 
+std::error_code mergeFiles(ArrayRef<std::string> InputFiles,
+                           StringRef OutputFile) {
+  return SDiagsWriter::mergeFiles(InputFiles, OutputFile);
+}
+
 } // end namespace serialized_diags
 } // end namespace clang
 
@@ -385,14 +414,22 @@ void SDiagsWriter::AddCharSourceRangeToRecord(CharSourceRange Range,
 unsigned SDiagsWriter::getEmitFile(const char *FileName){
   if (!FileName)
     return 0;
-  
+
+  // The names of PresumedLocs are uniqued by the SourceManager, so most
+  // lookups don't need to hash the name.
   unsigned &entry = State->Files[FileName];
+  if (!entry)
+    entry = getEmitFile(StringRef(FileName));
+  return entry;
+}
+
+unsigned SDiagsWriter::getEmitFile(StringRef Name) {
+  unsigned &entry = State->FileNames[Name];
   if (entry)
     return entry;
-  
+
   // Lazily generate the record for the file.
-  entry = State->Files.size();
-  StringRef Name(FileName);
+  entry = State->FileNames.size();
   RecordData::value_type Record[] = {RECORD_FILENAME, entry, 0 /* For legacy */,
                                      0 /* For legacy */, Name.size()};
   State->Stream.EmitRecordWithBlob(State->Abbrevs.get(RECORD_FILENAME), Record,
@@ -422,12 +459,15 @@ void SDiagsWriter::EmitPreamble() {
   EmitMetaBlock();
 }
 
+// Readers decode records with the abbreviations in the file, so fields can
+// use variable-width encodings without changing the format version. IDs are
+// VBR as well, so that merging many files can't overflow them.
 static void AddSourceLocationAbbrev(llvm::BitCodeAbbrev *Abbrev) {
   using namespace llvm;
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 10)); // File ID.
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Line.
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Column.
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Offset;
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));  // File ID.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));  // Line.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));  // Column.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 12)); // Offset;
 }
 
 static void AddRangeLocationAbbrev(llvm::BitCodeAbbrev *Abbrev) {
@@ -471,8 +511,8 @@ void SDiagsWriter::EmitBlockInfoBlock() {
   Abbrev->Add(BitCodeAbbrevOp(RECORD_DIAG));
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 3));  // Diag level.
   AddSourceLocationAbbrev(Abbrev);
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 10)); // Category.  
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 10)); // Mapped Diag ID.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));  // Category.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));  // Mapped Diag ID.
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // Text size.
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Diagnostc text.
   Abbrevs.set(RECORD_DIAG, Stream.EmitBlockInfoAbbrev(BLOCK_DIAG, Abbrev));
@@ -495,7 +535,7 @@ void SDiagsWriter::EmitBlockInfoBlock() {
   // Emit the abbreviation for RECORD_DIAG_FLAG.
   Abbrev = new BitCodeAbbrev();
   Abbrev->Add(BitCodeAbbrevOp(RECORD_DIAG_FLAG));
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 10)); // Mapped Diag ID.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));    // Mapped Diag ID.
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 16)); // Text size.
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Flag name text.
   Abbrevs.set(RECORD_DIAG_FLAG, Stream.EmitBlockInfoAbbrev(BLOCK_DIAG,
@@ -504,9 +544,9 @@ void SDiagsWriter::EmitBlockInfoBlock() {
   // Emit the abbreviation for RECORD_FILENAME.
   Abbrev = new BitCodeAbbrev();
   Abbrev->Add(BitCodeAbbrevOp(RECORD_FILENAME));
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 10)); // Mapped file ID.
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Size.
-  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Modifcation time.  
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));    // Mapped file ID.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));    // Size.
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));    // Modifcation time.
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 16)); // Text size.
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // File name text.
   Abbrevs.set(RECORD_FILENAME, Stream.EmitBlockInfoAbbrev(BLOCK_DIAG,
@@ -554,29 +594,33 @@ unsigned SDiagsWriter::getEmitDiagnosticFlag(DiagnosticsEngine::Level DiagLevel,
     return 0; // No flag for notes.
   
   StringRef FlagName = DiagnosticIDs::getWarningOptionForDiag(DiagID);
-  return getEmitDiagnosticFlag(FlagName);
+  if (FlagName.empty())
+    return 0;
+
+  // The names of diagnostic groups are static data whose pointer value is
+  // fixed, so most lookups don't need to hash the name.
+  unsigned &entry = State->DiagFlags[FlagName.data()];
+  if (!entry)
+    entry = getEmitDiagnosticFlag(FlagName);
+  return entry;
 }
 
 unsigned SDiagsWriter::getEmitDiagnosticFlag(StringRef FlagName) {
   if (FlagName.empty())
     return 0;
 
-  // Here we assume that FlagName points to static data whose pointer
-  // value is fixed.  This allows us to unique by diagnostic groups.
-  const void *data = FlagName.data();
-  std::pair<unsigned, StringRef> &entry = State->DiagFlags[data];
-  if (entry.first == 0) {
-    entry.first = State->DiagFlags.size();
-    entry.second = FlagName;
-    
+  unsigned &entry = State->DiagFlagNames[FlagName];
+  if (entry == 0) {
+    entry = State->DiagFlagNames.size();
+
     // Lazily emit the string in a separate record.
-    RecordData::value_type Record[] = {RECORD_DIAG_FLAG, entry.first,
+    RecordData::value_type Record[] = {RECORD_DIAG_FLAG, entry,
                                        FlagName.size()};
     State->Stream.EmitRecordWithBlob(State->Abbrevs.get(RECORD_DIAG_FLAG),
                                      Record, FlagName);
   }
 
-  return entry.first;
+  return entry;
 }
 
 void SDiagsWriter::HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
@@ -804,18 +848,39 @@ void SDiagsWriter::finish() {
         getMetaDiags()->Report(diag::warn_fe_serialized_diag_merge_failure);
   }
 
+  if (std::error_code EC = writeOutputFile())
+    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
+        << State->OutputFile << EC.message();
+}
+
+std::error_code SDiagsWriter::writeOutputFile() {
   std::error_code EC;
   auto OS = llvm::make_unique<llvm::raw_fd_ostream>(State->OutputFile.c_str(),
                                                     EC, llvm::sys::fs::F_None);
-  if (EC) {
-    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
-        << State->OutputFile << EC.message();
-    return;
-  }
+  if (EC)
+    return EC;
 
   // Write the generated bitstream to "Out".
   OS->write((char *)&State->Buffer.front(), State->Buffer.size());
   OS->flush();
+  return std::error_code();
+}
+
+std::error_code SDiagsWriter::mergeFiles(ArrayRef<std::string> InputFiles,
+                                         StringRef OutputFile) {
+  SDiagsWriter Writer(OutputFile, new DiagnosticOptions(),
+                      /*MergeChildRecords=*/false);
+  for (const std::string &File : InputFiles) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(File);
+    if (!Buffer)
+      return SDError::CouldNotLoad;
+    // The IDs of files, categories and flags are local to each input.
+    if (std::error_code EC =
+            SDiagsMerger(Writer).mergeRecordsFromBuffer(**Buffer))
+      return EC;
+  }
+  return Writer.writeOutputFile();
 }
 
 std::error_code SDiagsMerger::visitStartOfDiagnostic() {
@@ -869,7 +934,7 @@ SDiagsMerger::visitFixitRecord(const serialized_diags::Location &Start,
 std::error_code SDiagsMerger::visitFilenameRecord(unsigned ID, unsigned Size,
                                                   unsigned Timestamp,
                                                   StringRef Name) {
-  FileLookup[ID] = Writer.getEmitFile(Name.str().c_str());
+  FileLookup[ID] = Writer.getEmitFile(Name);
   return std::error_code();
 }
 
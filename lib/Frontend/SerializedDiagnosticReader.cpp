@@ -8,23 +8,25 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Frontend/SerializedDiagnosticReader.h"
-#include "clang/Basic/FileManager.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace clang;
 using namespace clang::serialized_diags;
 
 std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
-  // Open the diagnostics file.
-  FileSystemOptions FO;
-  FileManager FileMgr(FO);
-
-  auto Buffer = FileMgr.getBufferForFile(File);
+  // Open the diagnostics file. It is read once, so there is no need for a
+  // FileManager and its caches.
+  auto Buffer = llvm::MemoryBuffer::getFile(File);
   if (!Buffer)
     return SDError::CouldNotLoad;
+  return readDiagnostics(**Buffer);
+}
 
-  llvm::BitstreamCursor Stream(**Buffer);
+std::error_code
+SerializedDiagnosticReader::readDiagnostics(llvm::MemoryBufferRef Buffer) {
+  llvm::BitstreamCursor Stream(Buffer);
   Optional<llvm::BitstreamBlockInfo> BlockInfo;
 
   // Sniff for the signature.
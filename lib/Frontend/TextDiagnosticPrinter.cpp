@@ -17,21 +17,171 @@
 #include "clang/Frontend/TextDiagnostic.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
 using namespace clang;
 
+namespace clang {
+
+/// \brief A buffer in front of the stream diagnostics are printed to.
+///
+/// Diagnostics are written to the underlying stream in large blocks, either
+/// directly or, in asynchronous mode, from a background thread. Nothing else
+/// may write to the underlying stream until \c sync() returns.
+class BufferedDiagnosticStream : public raw_ostream {
+  raw_ostream &Out;
+  uint64_t Pos;
+
+  bool Async;
+  std::thread Writer;
+  std::mutex Lock;
+  std::condition_variable WorkAvailable;
+  std::condition_variable WorkDone;
+  std::string Pending;
+  bool Writing;
+  bool Done;
+
+  void write_impl(const char *Ptr, size_t Size) override {
+    Pos += Size;
+    if (!Async) {
+      Out.write(Ptr, Size);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      Pending.append(Ptr, Size);
+    }
+    WorkAvailable.notify_one();
+  }
+
+  uint64_t current_pos() const override { return Pos; }
+
+  void runWriter() {
+    std::string Block;
+    std::unique_lock<std::mutex> Guard(Lock);
+    while (true) {
+      WorkAvailable.wait(Guard, [this] { return Done || !Pending.empty(); });
+      if (Pending.empty())
+        return;
+      Block.swap(Pending);
+      Writing = true;
+      Guard.unlock();
+      Out.write(Block.data(), Block.size());
+      Out.flush();
+      Block.clear();
+      Guard.lock();
+      Writing = false;
+      WorkDone.notify_all();
+    }
+  }
+
+  /// \brief Writes the escape sequence of a color change into the buffer,
+  /// like raw_fd_ostream does, without counting it as output.
+  raw_ostream &writeColorCode(const char *Code) {
+    if (Code) {
+      size_t Len = strlen(Code);
+      write(Code, Len);
+      Pos -= Len;
+    }
+    return *this;
+  }
+
+public:
+  BufferedDiagnosticStream(raw_ostream &Out, bool Async)
+      : Out(Out), Pos(0), Async(Async && LLVM_ENABLE_THREADS), Writing(false),
+        Done(false) {
+    SetBufferSize(64 * 1024);
+    if (this->Async)
+      Writer = std::thread([this] { runWriter(); });
+  }
+
+  ~BufferedDiagnosticStream() override {
+    flush();
+    if (Async) {
+      {
+        std::lock_guard<std::mutex> Guard(Lock);
+        Done = true;
+      }
+      WorkAvailable.notify_one();
+      Writer.join();
+    }
+    Out.flush();
+  }
+
+  raw_ostream &getUnderlyingStream() { return Out; }
+
+  /// \brief Writes everything printed so far to the underlying stream.
+  void sync() {
+    flush();
+    if (Async) {
+      std::unique_lock<std::mutex> Guard(Lock);
+      WorkDone.wait(Guard, [this] { return Pending.empty() && !Writing; });
+    }
+    Out.flush();
+  }
+
+  raw_ostream &changeColor(enum Colors Color, bool Bold, bool BG) override {
+    if (llvm::sys::Process::ColorNeedsFlush()) {
+      sync();
+      Out.changeColor(Color, Bold, BG);
+      return *this;
+    }
+    return writeColorCode(Color == SAVEDCOLOR
+                              ? llvm::sys::Process::OutputBold(BG)
+                              : llvm::sys::Process::OutputColor(Color, Bold,
+                                                                BG));
+  }
+
+  raw_ostream &resetColor() override {
+    if (llvm::sys::Process::ColorNeedsFlush()) {
+      sync();
+      Out.resetColor();
+      return *this;
+    }
+    return writeColorCode(llvm::sys::Process::ResetColor());
+  }
+
+  raw_ostream &reverseColor() override {
+    if (llvm::sys::Process::ColorNeedsFlush()) {
+      sync();
+      Out.reverseColor();
+      return *this;
+    }
+    return writeColorCode(llvm::sys::Process::OutputReverse());
+  }
+
+  bool is_displayed() const override { return Out.is_displayed(); }
+  bool has_colors() const override { return Out.has_colors(); }
+};
+
+} // end namespace clang
+
+static BufferedDiagnosticStream *createBuffer(raw_ostream &OS,
+                                              DiagnosticOptions *DiagOpts) {
+  if (!DiagOpts->BufferedOutput)
+    return nullptr;
+  return new BufferedDiagnosticStream(OS, DiagOpts->AsyncOutput);
+}
+
 TextDiagnosticPrinter::TextDiagnosticPrinter(raw_ostream &os,
                                              DiagnosticOptions *diags,
                                              bool _OwnsOutputStream)
-  : OS(os), DiagOpts(diags),
-    OwnsOutputStream(_OwnsOutputStream) {
+  : Buffer(createBuffer(os, diags)), OS(Buffer ? *Buffer : os),
+    DiagOpts(diags), OwnsOutputStream(_OwnsOutputStream) {
 }
 
 TextDiagnosticPrinter::~TextDiagnosticPrinter() {
+  raw_ostream &Out = Buffer ? Buffer->getUnderlyingStream() : OS;
+  Buffer.reset();
   if (OwnsOutputStream)
-    delete &OS;
+    delete &Out;
 }
 
 void TextDiagnosticPrinter::BeginSourceFile(const LangOptions &LO,
@@ -42,6 +192,24 @@ void TextDiagnosticPrinter::BeginSourceFile(const LangOptions &LO,
 
 void TextDiagnosticPrinter::EndSourceFile() {
   TextDiag.reset();
+  if (Buffer)
+    Buffer->sync();
+}
+
+void TextDiagnosticPrinter::finish() {
+  if (Buffer)
+    Buffer->sync();
+}
+
+void TextDiagnosticPrinter::flushDiagnostic(DiagnosticsEngine::Level Level) {
+  if (!Buffer) {
+    OS.flush();
+    return;
+  }
+  // Outside a source file there may be no EndSourceFile() to come, and a
+  // fatal error is best seen right away.
+  if (!TextDiag || Level == DiagnosticsEngine::Fatal)
+    Buffer->sync();
 }
 
 /// \brief Print any diagnostic option information to a raw_ostream.
@@ -140,7 +308,7 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                                            OS.tell() - StartOfLocationInfo,
                                            DiagOpts->MessageLength,
                                            DiagOpts->ShowColors);
-    OS.flush();
+    flushDiagnostic(Level);
     return;
   }
 
@@ -155,5 +323,5 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                            Info.getFixItHints(),
                            &Info.getSourceManager());
 
-  OS.flush();
+  flushDiagnostic(Level);
 }
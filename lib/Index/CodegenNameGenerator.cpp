@@ -18,6 +18,7 @@
 #include "clang/AST/Mangle.h"
 #include "clang/AST/VTableBuilder.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/Support/raw_ostream.h"
@@ -28,6 +29,7 @@ using namespace clang::index;
 struct CodegenNameGenerator::Implementation {
   std::unique_ptr<MangleContext> MC;
   llvm::DataLayout DL;
+  llvm::DenseMap<const Decl *, std::string> Names;
 
   Implementation(ASTContext &Ctx)
     : MC(Ctx.createMangleContext()),
@@ -60,11 +62,16 @@ struct CodegenNameGenerator::Implementation {
   }
 
   std::string getName(const Decl *D) {
+    auto Known = Names.find(D);
+    if (Known != Names.end())
+      return Known->second;
+
     std::string Name;
     {
       llvm::raw_string_ostream OS(Name);
       writeName(D, OS);
     }
+    Names[D] = Name;
     return Name;
   }
 
@@ -75,7 +82,6 @@ struct CodegenNameGenerator::Implementation {
     const NamedDecl *ND = cast<NamedDecl>(D);
 
     ASTContext &Ctx = ND->getASTContext();
-    std::unique_ptr<MangleContext> M(Ctx.createMangleContext());
 
     std::vector<std::string> Manglings;
 
@@ -9,7 +9,9 @@
 
 #include "IndexingContext.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclVisitor.h"
+#include "clang/Basic/SourceManager.h"
 
 using namespace clang;
 using namespace index;
@@ -471,6 +473,11 @@ bool IndexingContext::indexTopLevelDecl(const Decl *D) {
   if (isa<ObjCMethodDecl>(D))
     return true; // Wait for the objc container.
 
+  SourceManager &SM = Ctx->getSourceManager();
+  if (!DataConsumer.shouldIndexFile(
+          SM.getFileID(SM.getFileLoc(D->getLocation()))))
+    return true;
+
   return indexDecl(D);
 }
 
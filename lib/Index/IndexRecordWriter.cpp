@@ -0,0 +1,190 @@
+//===- IndexRecordWriter.cpp - Index data recording for the index store ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Writes the symbol occurrences of a translation unit to an index store, as
+// a side effect of compiling it.
+//
+// A record file has one line per occurrence, sorted by location:
+//
+//   <line>:<column> <kind> <roles> <USR> <name> [<relation roles> <USR>]...
+//
+// with the fields separated by tabs, and the roles as SymbolRoleSet values.
+// A unit file has a 'main' and an 'output' line naming the main file and the
+// output of the translation unit, followed by a 'file <path> <record>' line
+// for every file with occurrences.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/IndexingAction.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/FileUtilities.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace clang;
+using namespace clang::index;
+
+/// \brief Returns \p Name followed by the hex MD5 hash of \p Contents.
+static std::string getHashedName(StringRef Name, StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Hex;
+  llvm::MD5::stringifyResult(Result, Hex);
+  return getHashedFileName(Name, Hex);
+}
+
+namespace {
+
+class IndexRecordingConsumer : public IndexDataConsumer {
+  struct Occurrence {
+    unsigned Line;
+    unsigned Column;
+    std::string Symbol;
+
+    bool operator<(const Occurrence &RHS) const {
+      return std::tie(Line, Column, Symbol) <
+             std::tie(RHS.Line, RHS.Column, RHS.Symbol);
+    }
+  };
+
+  std::string StorePath;
+  std::string OutputFile;
+  ASTContext *Ctx = nullptr;
+  llvm::DenseMap<const FileEntry *, std::vector<Occurrence>> Records;
+  USRCache USRs;
+
+  void reportError(StringRef Path, std::error_code EC) {
+    DiagnosticsEngine &Diags = Ctx->getDiagnostics();
+    unsigned DiagID = Diags.getCustomDiagID(
+        DiagnosticsEngine::Warning, "cannot write index store file '%0': %1");
+    Diags.Report(DiagID) << Path << EC.message();
+  }
+
+public:
+  IndexRecordingConsumer(StringRef StorePath, StringRef OutputFile)
+      : StorePath(StorePath), OutputFile(OutputFile) {}
+
+  void initialize(ASTContext &Ctx) override { this->Ctx = &Ctx; }
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations, FileID FID,
+                           unsigned Offset, ASTNodeInfo ASTNode) override {
+    const SourceManager &SM = Ctx->getSourceManager();
+    const FileEntry *File = FID.isValid() ? SM.getFileEntryForID(FID) : nullptr;
+    if (!File)
+      return true;
+    StringRef USR = USRs.getUSR(D);
+    if (USR.empty())
+      return true;
+
+    Occurrence O;
+    O.Line = SM.getLineNumber(FID, Offset);
+    O.Column = SM.getColumnNumber(FID, Offset);
+    llvm::raw_string_ostream OS(O.Symbol);
+    OS << getSymbolKindString(getSymbolInfo(D).Kind) << '\t' << Roles << '\t'
+       << USR << '\t';
+    printSymbolName(D, Ctx->getLangOpts(), OS);
+    for (const SymbolRelation &Relation : Relations) {
+      StringRef RelatedUSR = USRs.getUSR(Relation.RelatedSymbol);
+      if (!RelatedUSR.empty())
+        OS << '\t' << Relation.Roles << '\t' << RelatedUSR;
+    }
+    OS.flush();
+    Records[File].push_back(std::move(O));
+    return true;
+  }
+
+  void finish() override;
+};
+
+} // anonymous namespace
+
+void IndexRecordingConsumer::finish() {
+  // Nothing was parsed, e.g. when only preprocessing.
+  if (!Ctx)
+    return;
+
+  SmallString<128> RecordsDir(StorePath);
+  llvm::sys::path::append(RecordsDir, "v1", "records");
+  SmallString<128> UnitsDir(StorePath);
+  llvm::sys::path::append(UnitsDir, "v1", "units");
+  for (StringRef Dir : {RecordsDir.str(), UnitsDir.str()}) {
+    if (std::error_code EC = llvm::sys::fs::create_directories(Dir)) {
+      reportError(Dir, EC);
+      return;
+    }
+  }
+
+  const SourceManager &SM = Ctx->getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  StringRef MainFileName = MainFile ? MainFile->getName() : "";
+
+  std::vector<std::pair<StringRef, std::vector<Occurrence> *>> Files;
+  for (auto &Record : Records)
+    Files.push_back(std::make_pair(Record.first->getName(), &Record.second));
+  std::sort(Files.begin(), Files.end());
+
+  std::string Unit;
+  llvm::raw_string_ostream UnitOS(Unit);
+  UnitOS << "main\t" << MainFileName << "\n"
+         << "output\t" << OutputFile << "\n";
+  for (const auto &File : Files) {
+    std::vector<Occurrence> &Occurrences = *File.second;
+    std::sort(Occurrences.begin(), Occurrences.end());
+
+    std::string Record;
+    llvm::raw_string_ostream RecordOS(Record);
+    for (const Occurrence &O : Occurrences)
+      RecordOS << O.Line << ':' << O.Column << '\t' << O.Symbol << "\n";
+    RecordOS.flush();
+
+    // Records are named after their contents; one that exists already was
+    // written by another translation unit and is shared.
+    std::string RecordName =
+        getHashedName(llvm::sys::path::filename(File.first), Record);
+    SmallString<128> RecordPath(RecordsDir);
+    llvm::sys::path::append(RecordPath, RecordName);
+    if (!llvm::sys::fs::exists(RecordPath))
+      if (std::error_code EC = writeFileAtomically(RecordPath, Record)) {
+        reportError(RecordPath, EC);
+        return;
+      }
+    UnitOS << "file\t" << File.first << "\t" << RecordName << "\n";
+  }
+  UnitOS.flush();
+
+  StringRef UnitSource = OutputFile.empty() ? MainFileName : OutputFile;
+  SmallString<128> UnitPath(UnitsDir);
+  llvm::sys::path::append(
+      UnitPath,
+      getHashedName(llvm::sys::path::filename(UnitSource), UnitSource));
+  if (std::error_code EC = writeFileAtomically(UnitPath, Unit))
+    reportError(UnitPath, EC);
+}
+
+std::unique_ptr<FrontendAction> index::createIndexDataRecordingAction(
+    StringRef StorePath, StringRef OutputFile,
+    std::unique_ptr<FrontendAction> WrappedAction) {
+  return createIndexingAction(
+      std::make_shared<IndexRecordingConsumer>(StorePath, OutputFile),
+      IndexingOptions(), std::move(WrappedAction));
+}
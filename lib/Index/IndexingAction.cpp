@@ -10,6 +10,7 @@
 #include "clang/Index/IndexingAction.h"
 #include "clang/Index/IndexDataConsumer.h"
 #include "IndexingContext.h"
+#include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Lex/Preprocessor.h"
@@ -38,6 +39,10 @@ bool IndexDataConsumer::handleModuleOccurence(const ImportDecl *ImportD,
   return true;
 }
 
+bool IndexDataConsumer::shouldIndexFile(FileID FID) {
+  return true;
+}
+
 namespace {
 
 class IndexASTConsumer : public ASTConsumer {
@@ -67,6 +72,15 @@ protected:
 
   void HandleTranslationUnit(ASTContext &Ctx) override {
   }
+
+  bool shouldSkipFunctionBody(Decl *D) override {
+    if (!IndexCtx.getIndexOpts().SkipFunctionBodiesOutsideMainFile)
+      return true;
+
+    const SourceManager &SM = D->getASTContext().getSourceManager();
+    SourceLocation Loc = SM.getFileLoc(D->getLocation());
+    return SM.getFileID(Loc) != SM.getMainFileID();
+  }
 };
 
 class IndexActionBase {
@@ -83,6 +97,12 @@ protected:
     return llvm::make_unique<IndexASTConsumer>(IndexCtx);
   }
 
+  /// Have the parser ask the consumer which function bodies to skip.
+  void setUpFunctionBodySkipping(CompilerInstance &CI) {
+    if (IndexCtx.getIndexOpts().SkipFunctionBodiesOutsideMainFile)
+      CI.getFrontendOpts().SkipFunctionBodies = true;
+  }
+
   void finish() {
     DataConsumer->finish();
   }
@@ -95,6 +115,11 @@ public:
     : IndexActionBase(std::move(DataConsumer), Opts) {}
 
 protected:
+  bool BeginInvocation(CompilerInstance &CI) override {
+    setUpFunctionBodySkipping(CI);
+    return true;
+  }
+
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override {
     return createIndexASTConsumer();
@@ -117,6 +142,7 @@ public:
       IndexActionBase(std::move(DataConsumer), Opts) {}
 
 protected:
+  bool BeginInvocation(CompilerInstance &CI) override;
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override;
   void EndSourceFileAction() override;
@@ -124,6 +150,13 @@ protected:
 
 } // anonymous namespace
 
+bool WrappingIndexAction::BeginInvocation(CompilerInstance &CI) {
+  if (!WrapperFrontendAction::BeginInvocation(CI))
+    return false;
+  setUpFunctionBodySkipping(CI);
+  return true;
+}
+
 void WrappingIndexAction::EndSourceFileAction() {
   // Invoke wrapped action's method.
   WrapperFrontendAction::EndSourceFileAction();
@@ -12,6 +12,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Lex/PreprocessingRecord.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -929,3 +930,20 @@ bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
   Out << MD->getName()->getName();
   return false;
 }
+
+StringRef USRCache::getUSR(const Decl *D) {
+  auto Known = USRs.find(D);
+  if (Known != USRs.end())
+    return Known->second;
+
+  SmallString<128> Buf;
+  StringRef USR;
+  if (!generateUSRForDecl(D, Buf)) {
+    char *Data = Alloc.Allocate<char>(Buf.size() + 1);
+    std::copy(Buf.begin(), Buf.end(), Data);
+    Data[Buf.size()] = '\0';
+    USR = StringRef(Data, Buf.size());
+  }
+  USRs[D] = USR;
+  return USR;
+}
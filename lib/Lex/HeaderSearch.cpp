@@ -26,6 +26,7 @@
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include <cstdio>
 #include <utility>
 #if defined(LLVM_ON_UNIX)
@@ -54,6 +55,44 @@ HeaderFileInfo::getControllingMacro(ExternalPreprocessorSource *External) {
 
 ExternalHeaderFileInfoSource::~ExternalHeaderFileInfoSource() {}
 
+SharedLookupFileCache::SharedLookupFileCache() {}
+
+SharedLookupFileCache::~SharedLookupFileCache() {}
+
+/// \brief Return the key of the lookup of \p Filename from \p StartIdx within
+/// the results for one search path.
+static std::string getSharedLookupKey(unsigned StartIdx, StringRef Filename) {
+  return (Twine(StartIdx) + ":" + Filename).str();
+}
+
+bool SharedLookupFileCache::lookup(FileManager &FileMgr,
+                                   StringRef SearchPathKey, unsigned StartIdx,
+                                   StringRef Filename, Entry &Result) {
+  std::lock_guard<std::mutex> Guard(Mutex);
+  if (this->FileMgr.get() != &FileMgr)
+    return false;
+  auto Path = Lookups.find(SearchPathKey);
+  if (Path == Lookups.end())
+    return false;
+  auto Lookup = Path->second.find(getSharedLookupKey(StartIdx, Filename));
+  if (Lookup == Path->second.end())
+    return false;
+  Result = Lookup->second;
+  return true;
+}
+
+void SharedLookupFileCache::insert(FileManager &FileMgr,
+                                   StringRef SearchPathKey, unsigned StartIdx,
+                                   StringRef Filename, Entry Result) {
+  std::lock_guard<std::mutex> Guard(Mutex);
+  if (!this->FileMgr)
+    this->FileMgr = &FileMgr;
+  else if (this->FileMgr.get() != &FileMgr)
+    return;
+  Lookups[SearchPathKey][getSharedLookupKey(StartIdx, Filename)] =
+      std::move(Result);
+}
+
 HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
                            SourceManager &SourceMgr, DiagnosticsEngine &Diags,
                            const LangOptions &LangOpts,
@@ -70,6 +109,8 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+  NumIndexedDirectories = NumLookupsSkippedByIndex = 0;
+  NumSharedLookupHits = 0;
 }
 
 HeaderSearch::~HeaderSearch() {
@@ -98,6 +139,32 @@ void HeaderSearch::PrintStats() {
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+  if (HSOpts->IndexSearchDirectories)
+    fprintf(stderr, "%d directories indexed, %d lookups skipped.\n",
+            NumIndexedDirectories, NumLookupsSkippedByIndex);
+  if (HSOpts->SharedLookupCache)
+    fprintf(stderr, "%d lookups found in the shared lookup cache.\n",
+            NumSharedLookupHits);
+}
+
+StringRef HeaderSearch::getSearchPathKey() {
+  if (!SearchPathKey.empty())
+    return SearchPathKey;
+
+  // Lookups only depend on the entries the FileManager gives out for the
+  // search directories, so these identify the search path.
+  llvm::raw_string_ostream OS(SearchPathKey);
+  OS << SearchDirs.size();
+  for (const DirectoryLookup &DL : SearchDirs) {
+    OS << ';' << DL.getLookupType() << ',' << DL.getDirCharacteristic() << ','
+       << DL.isIndexHeaderMap() << ',';
+    if (DL.isHeaderMap())
+      OS << DL.getHeaderMap()->getFileName();
+    else
+      OS << (DL.isFramework() ? DL.getFrameworkDir() : DL.getDir());
+  }
+  OS.flush();
+  return SearchPathKey;
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -315,6 +382,47 @@ const FileEntry *HeaderSearch::getFileAndSuggestModule(
   return File;
 }
 
+bool HeaderSearch::directoryMayContain(const DirectoryEntry *Dir,
+                                       StringRef Filename) {
+  if (!HSOpts->IndexSearchDirectories)
+    return true;
+
+  // Files which only exist in the file manager do not show up in directory
+  // listings.
+  if (FileMgr.hasVirtualFiles())
+    return true;
+
+  StringRef FirstComponent = *llvm::sys::path::begin(Filename);
+  if (FirstComponent == "." || FirstComponent == ".." ||
+      llvm::sys::path::is_absolute(Filename))
+    return true;
+
+  auto Known = DirectoryEntryNames.insert(std::make_pair(Dir, nullptr));
+  if (Known.second) {
+    // Names are lowercased so that the index is also correct on
+    // case-insensitive file systems; that only adds false positives.
+    auto Names = llvm::make_unique<llvm::StringSet<>>();
+    SmallString<256> DirName(Dir->getName());
+    FileMgr.FixupRelativePath(DirName);
+    std::error_code EC;
+    vfs::FileSystem &FS = *FileMgr.getVirtualFileSystem();
+    for (vfs::directory_iterator I = FS.dir_begin(DirName, EC), E;
+         !EC && I != E; I.increment(EC))
+      Names->insert(llvm::sys::path::filename(I->getName()).lower());
+    if (!EC) {
+      Known.first->second = std::move(Names);
+      ++NumIndexedDirectories;
+    }
+  }
+
+  const llvm::StringSet<> *Names = Known.first->second.get();
+  if (!Names || Names->count(FirstComponent.lower()))
+    return true;
+
+  ++NumLookupsSkippedByIndex;
+  return false;
+}
+
 /// LookupFile - Lookup the specified file in this search path, returning it
 /// if it exists or returning null if not.
 const FileEntry *DirectoryLookup::LookupFile(
@@ -333,6 +441,9 @@ const FileEntry *DirectoryLookup::LookupFile(
 
   SmallString<1024> TmpDir;
   if (isNormalDir()) {
+    if (!HS.directoryMayContain(getDir(), Filename))
+      return nullptr;
+
     // Concatenate the requested file onto the directory.
     TmpDir = getDir()->getName();
     llvm::sys::path::append(TmpDir, Filename);
@@ -746,6 +857,11 @@ const FileEntry *HeaderSearch::LookupFile(
   // (potentially huge) series of SearchDirs to find it.
   LookupFileCacheInfo &CacheLookup = LookupFileCache[Filename];
 
+  // The shared lookup cache to record the result of this lookup in, if any.
+  SharedLookupFileCache *SharedLookup = nullptr;
+  unsigned SharedStartIdx = 0;
+  StringRef SpelledFilename;
+
   // If the entry has been previously looked up, the first value will be
   // non-zero.  If the value is equal to i (the start point of our search), then
   // this is a matching hit.
@@ -759,6 +875,28 @@ const FileEntry *HeaderSearch::LookupFile(
     // our search start.  We will fill in our found location below, so prime the
     // start point value.
     CacheLookup.reset(/*StartIdx=*/i+1);
+
+    // Another translation unit with the same search path may have done this
+    // lookup already. Implicit module maps are loaded as a side effect of
+    // searching, so the search cannot be skipped when they are in use.
+    if (!SkipCache && HSOpts->SharedLookupCache &&
+        !HSOpts->ImplicitModuleMaps) {
+      SharedLookup = HSOpts->SharedLookupCache.get();
+      SharedStartIdx = i;
+      SpelledFilename = Filename;
+      SharedLookupFileCache::Entry Shared;
+      if (SharedLookup->lookup(FileMgr, getSearchPathKey(), i, Filename,
+                               Shared)) {
+        ++NumSharedLookupHits;
+        SharedLookup = nullptr;
+        CacheLookup.HitIdx = i = Shared.HitIdx;
+        if (!Shared.MappedName.empty()) {
+          CacheLookup.MappedName =
+              copyString(Shared.MappedName, LookupFileCache.getAllocator());
+          Filename = CacheLookup.MappedName;
+        }
+      }
+    }
   }
 
   SmallString<64> MappedName;
@@ -818,6 +956,11 @@ const FileEntry *HeaderSearch::LookupFile(
 
     // Remember this location for the next lookup we do.
     CacheLookup.HitIdx = i;
+    if (SharedLookup)
+      SharedLookup->insert(FileMgr, getSearchPathKey(), SharedStartIdx,
+                           SpelledFilename,
+                           {i, CacheLookup.MappedName ? CacheLookup.MappedName
+                                                      : ""});
     return FE;
   }
 
@@ -860,6 +1003,12 @@ const FileEntry *HeaderSearch::LookupFile(
 
   // Otherwise, didn't find it. Remember we didn't find this.
   CacheLookup.HitIdx = SearchDirs.size();
+  if (SharedLookup)
+    SharedLookup->insert(FileMgr, getSearchPathKey(), SharedStartIdx,
+                         SpelledFilename,
+                         {CacheLookup.HitIdx, CacheLookup.MappedName
+                                                  ? CacheLookup.MappedName
+                                                  : ""});
   return nullptr;
 }
 
@@ -35,8 +35,118 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
+//===----------------------------------------------------------------------===//
+// Vectorized scanning helpers
+//===----------------------------------------------------------------------===//
+//
+// Each of these advances over a run of characters which the corresponding
+// scalar loop would consume without doing anything else, 16 at a time. They
+// stop at or before the first character that needs a closer look, and never
+// read at or past BufferEnd, so the caller's scalar loop finishes the job.
+
+#ifdef __SSE2__
+/// Return a mask of the bytes of \p V which are in the range [Lo, Hi].
+static inline __m128i inRange(__m128i V, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(V, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(V, _mm_set1_epi8(Hi + 1)));
+}
+
+/// Return a mask of the bytes of \p V which are equal to \p C.
+static inline __m128i isChar(__m128i V, char C) {
+  return _mm_cmpeq_epi8(V, _mm_set1_epi8(C));
+}
+
+/// Advance \p CurPtr until \p IsStop, which maps 16 bytes to a mask of the
+/// bytes to stop at, matches any byte.
+template <typename StopFn>
+static inline const char *skipUntil(const char *CurPtr, const char *BufferEnd,
+                                    StopFn IsStop) {
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i *>(CurPtr));
+    if (unsigned Mask = _mm_movemask_epi8(IsStop(V)))
+      return CurPtr + llvm::countTrailingZeros(Mask);
+    CurPtr += 16;
+  }
+  return CurPtr;
+}
+#endif
+
+/// Skip over [_A-Za-z0-9]*.
+static const char *skipIdentifierBody(const char *CurPtr,
+                                      const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipUntil(CurPtr, BufferEnd, [](__m128i V) {
+    // Setting bit 5 maps 'A'-'Z' onto 'a'-'z' and nothing else onto them.
+    // Non-ASCII bytes are negative and fall outside both ranges.
+    __m128i Lower = _mm_or_si128(V, _mm_set1_epi8(0x20));
+    __m128i Body = _mm_or_si128(
+        _mm_or_si128(inRange(Lower, 'a', 'z'), inRange(V, '0', '9')),
+        isChar(V, '_'));
+    return _mm_xor_si128(Body, _mm_set1_epi8(-1));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip over horizontal whitespace.
+static const char *skipHorizontalWhitespace(const char *CurPtr,
+                                            const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipUntil(CurPtr, BufferEnd, [](__m128i V) {
+    // '\t', '\v' and '\f' are 0x09, 0x0B and 0x0C; '\n' is 0x0A.
+    __m128i Space = _mm_or_si128(
+        _mm_or_si128(isChar(V, ' '), isChar(V, '\t')),
+        inRange(V, '\v', '\f'));
+    return _mm_xor_si128(Space, _mm_set1_epi8(-1));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip over characters which cannot end a line comment, stopping at
+/// newlines and at nul characters (the end of the buffer or a code completion
+/// point).
+static const char *skipLineCommentBody(const char *CurPtr,
+                                       const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipUntil(CurPtr, BufferEnd, [](__m128i V) {
+    return _mm_or_si128(_mm_or_si128(isChar(V, '\n'), isChar(V, '\r')),
+                        isChar(V, 0));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip over characters in a string literal which getAndAdvanceChar would
+/// return unchanged and which cannot end the literal: anything but '"', '\\',
+/// '?' (a potential trigraph), newlines and nul characters.
+static const char *skipStringLiteralBody(const char *CurPtr,
+                                         const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipUntil(CurPtr, BufferEnd, [](__m128i V) {
+    __m128i Stop = _mm_or_si128(_mm_or_si128(isChar(V, '"'), isChar(V, '\\')),
+                                isChar(V, '?'));
+    return _mm_or_si128(
+        Stop, _mm_or_si128(_mm_or_si128(isChar(V, '\n'), isChar(V, '\r')),
+                           isChar(V, 0)));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
 //===----------------------------------------------------------------------===//
 // Token Class Implementation
 //===----------------------------------------------------------------------===//
@@ -204,6 +314,13 @@ Lexer *Lexer::Create_PragmaLexer(SourceLocation SpellingLoc,
   return L;
 }
 
+void Lexer::seek(unsigned Offset, bool IsAtStartOfLine) {
+  assert(BufferStart + Offset <= BufferEnd && "Seeking past the buffer end");
+  BufferPtr = BufferStart + Offset;
+  this->IsAtStartOfLine = IsAtStartOfLine;
+  this->IsAtPhysicalStartOfLine = IsAtStartOfLine;
+}
+
 /// Stringify - Convert the specified string into a C string, with surrounding
 /// ""'s, and with escaped \ and " characters.
 std::string Lexer::Stringify(StringRef Str, bool Charify) {
@@ -702,6 +819,55 @@ std::pair<unsigned, bool> Lexer::ComputePreamble(StringRef Buffer,
                                : TheTok.isAtStartOfLine());
 }
 
+void Lexer::MinimizeToDirectives(StringRef Buffer, const LangOptions &LangOpts,
+                                 SmallVectorImpl<char> &Minimized) {
+  // As in ComputePreamble, use a "fake" file location at offset 1 to track
+  // our position within the buffer.
+  const unsigned StartOffset = 1;
+  SourceLocation FileLoc = SourceLocation::getFromRawEncoding(StartOffset);
+  Lexer TheLexer(FileLoc, LangOpts, Buffer.begin(), Buffer.begin(),
+                 Buffer.end());
+  auto getOffset = [&](const Token &Tok) {
+    return Tok.getLocation().getRawEncoding() - StartOffset;
+  };
+
+  Minimized.clear();
+  Minimized.reserve(Buffer.size());
+  // The end of the part of the buffer that Minimized already stands for.
+  unsigned Done = 0;
+  Token TheTok;
+  TheLexer.LexFromRawLexer(TheTok);
+  while (TheTok.isNot(tok::eof)) {
+    if (!TheTok.isAtStartOfLine() || TheTok.isNot(tok::hash)) {
+      TheLexer.LexFromRawLexer(TheTok);
+      continue;
+    }
+
+    // The directive runs up to the next token at the start of a line.
+    unsigned Begin = getOffset(TheTok);
+    unsigned End;
+    do {
+      End = getOffset(TheTok) + TheTok.getLength();
+      TheLexer.LexFromRawLexer(TheTok);
+    } while (TheTok.isNot(tok::eof) && !TheTok.isAtStartOfLine());
+
+    // Drop what came before it, but keep the line breaks, and the column
+    // the directive starts at.
+    StringRef Dropped = Buffer.slice(Done, Begin);
+    Minimized.append(Dropped.count('\n'), '\n');
+    size_t LastLineStart = Dropped.rfind('\n');
+    Minimized.append(LastLineStart == StringRef::npos
+                         ? Dropped.size()
+                         : Dropped.size() - LastLineStart - 1,
+                     ' ');
+    Minimized.append(Buffer.begin() + Begin, Buffer.begin() + End);
+    Done = End;
+  }
+  // Directives need not end in a newline; keep the last one terminated.
+  if (Done != Buffer.size())
+    Minimized.push_back('\n');
+}
+
 /// AdvanceToTokenCharacter - Given a location that specifies the start of a
 /// token, return a new location that specifies a character within the token.
 SourceLocation Lexer::AdvanceToTokenCharacter(SourceLocation TokStart,
@@ -1507,6 +1673,7 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -1792,6 +1959,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipStringLiteralBody(CurPtr, BufferEnd);
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2006,6 +2174,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2072,6 +2244,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // them.  As such, optimize for this case with the inner loop.
   char C;
   do {
+    CurPtr = skipLineCommentBody(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2277,13 +2450,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
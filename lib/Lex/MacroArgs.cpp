@@ -132,12 +132,25 @@ bool MacroArgs::ArgNeedsPreexpansion(const Token *ArgTok,
                                      Preprocessor &PP) const {
   // If there are no identifiers in the argument list, or if the identifiers are
   // known to not be macros, pre-expansion won't modify it.
-  for (; ArgTok->isNot(tok::eof); ++ArgTok)
-    if (IdentifierInfo *II = ArgTok->getIdentifierInfo())
-      if (II->hasMacroDefinition())
-        // Return true even though the macro could be a function-like macro
-        // without a following '(' token, or could be disabled, or not visible.
-        return true;
+  for (; ArgTok->isNot(tok::eof); ++ArgTok) {
+    IdentifierInfo *II = ArgTok->getIdentifierInfo();
+    if (!II || !II->hasMacroDefinition())
+      continue;
+    // A macro that is not visible is never expanded.
+    const MacroInfo *MI = PP.getMacroInfo(II);
+    if (!MI)
+      continue;
+    // Neither is an enabled function-like macro that is not followed by a '('
+    // within the argument, and lexing it leaves the token unchanged.  This is
+    // common for arguments that name functions hidden behind macros, like
+    // 'f(toupper)'.
+    if (MI->isFunctionLike() && MI->isEnabled() &&
+        !ArgTok->isExpandDisabled() && ArgTok[1].isNot(tok::l_paren))
+      continue;
+    // Return true even though the macro could be disabled, in which case
+    // pre-expansion only marks the token as unexpandable.
+    return true;
+  }
   return false;
 }
 
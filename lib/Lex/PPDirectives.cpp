@@ -33,6 +33,7 @@
 #include "clang/Lex/PTHLexer.h"
 #include "clang/Lex/Token.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/STLExtras.h"
@@ -371,6 +372,26 @@ void Preprocessor::CheckEndOfDirective(const char *DirType, bool EnableMacros) {
   }
 }
 
+Preprocessor::SkippedDirectiveTable *Preprocessor::getSkippedDirectiveTable() {
+  // Jumping ahead would step over the code completion point, and whitespace
+  // tokens must not be lost.
+  if (!CurLexer || isCodeCompletionEnabled() ||
+      CurLexer->isKeepWhitespaceMode())
+    return nullptr;
+
+  StringRef Buffer = CurLexer->getBuffer();
+  SkippedDirectiveTable *&Table =
+      SkippedDirectiveTableForBuffer[Buffer.data()];
+  if (!Table) {
+    auto &Shared = SkippedDirectiveTables[std::make_pair(
+        static_cast<size_t>(llvm::hash_value(Buffer)), Buffer.size())];
+    if (!Shared)
+      Shared = llvm::make_unique<SkippedDirectiveTable>();
+    Table = Shared.get();
+  }
+  return Table;
+}
+
 /// SkipExcludedConditionalBlock - We just read a \#if or related directive and
 /// decided that the subsequent tokens are in the \#if'd out portion of the
 /// file.  Lex the rest of the file, until we see an \#endif.  If
@@ -397,8 +418,26 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation IfTokenLoc,
   // Enter raw mode to disable identifier lookup (and thus macro expansion),
   // disabling warnings, etc.
   CurPPLexer->LexingRawMode = true;
+  SkippedDirectiveTable *DirectiveTable = getSkippedDirectiveTable();
+  bool AtResumePoint = true;
+  unsigned ResumeKey = 0;
   Token Tok;
   while (true) {
+    // Raw lexing is a function of the buffer contents and the position it
+    // starts from, so if we previously skipped from here in a buffer with the
+    // same contents, jump straight to the '#' that ended that run of tokens.
+    if (DirectiveTable && AtResumePoint) {
+      ResumeKey = (CurLexer->getBufferLocation() -
+                   CurLexer->getBuffer().data()) * 2 +
+                  CurLexer->isAtStartOfLine();
+      auto Known = DirectiveTable->find(ResumeKey);
+      if (Known != DirectiveTable->end()) {
+        CurLexer->seek(Known->second, /*IsAtStartOfLine=*/true);
+        ++NumSkippedByTable;
+      }
+      AtResumePoint = false;
+    }
+
     CurLexer->Lex(Tok);
 
     if (Tok.is(tok::code_completion)) {
@@ -427,6 +466,13 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation IfTokenLoc,
     if (Tok.isNot(tok::hash) || !Tok.isAtStartOfLine())
       continue;
 
+    if (DirectiveTable) {
+      (*DirectiveTable)[ResumeKey] = CurLexer->getBufferLocation() -
+                                     Tok.getLength() -
+                                     CurLexer->getBuffer().data();
+      AtResumePoint = true;
+    }
+
     // We just parsed a # character at the start of a line, so we're in
     // directive mode.  Tell the lexer this so any newlines we see will be
     // converted into an EOD token (this terminates the macro).
@@ -928,6 +974,7 @@ void Preprocessor::HandleDirective(Token &Result) {
   // work, we have to remember if we had read any tokens *before* this
   // pp-directive.
   bool ReadAnyTokensBeforeDirective =CurPPLexer->MIOpt.getHasReadAnyTokensVal();
+  CurPPLexer->MIOpt.EnterDirective();
 
   // Save the '#' token in case we need to return it later.
   Token SavedHash = Result;
@@ -2023,6 +2070,7 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
   // position on the file where it will be included and after the expansions.
   if (IncludePos.isMacroID())
     IncludePos = SourceMgr.getExpansionRange(IncludePos).second;
+  minimizeFileToDirectives(File);
   FileID FID = SourceMgr.createFileID(File, IncludePos, FileCharacter);
   assert(FID.isValid() && "Expected valid file ID");
 
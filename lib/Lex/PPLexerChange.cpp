@@ -15,6 +15,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/MacroInfo.h"
@@ -79,6 +80,7 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
   if (PTH) {
     if (PTHLexer *PL = PTH->CreateLexer(FID)) {
       EnterSourceFileWithPTH(PL, CurDir);
+      beginTimeTracedFile(Loc);
       return false;
     }
   }
@@ -102,9 +104,25 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
   }
 
   EnterSourceFileWithLexer(new Lexer(FID, InputFile, *this), CurDir);
+  beginTimeTracedFile(Loc);
   return false;
 }
 
+/// beginTimeTracedFile - Start the -ftime-trace scope of the file which was
+/// just entered from \p Loc; it ends when the file is popped off the include
+/// stack.
+void Preprocessor::beginTimeTracedFile(SourceLocation Loc) {
+  // The main file is not traced; it lasts as long as the whole compile.
+  if (!timeTraceProfilerEnabled() || Loc.isInvalid())
+    return;
+  timeTraceProfilerBegin("Source", [&] {
+    return SourceMgr
+        .getBufferName(SourceMgr.getLocForStartOfFile(CurPPLexer->getFileID()))
+        .str();
+  });
+  TimeTracedLexers.push_back(CurPPLexer);
+}
+
 /// EnterSourceFileWithLexer - Add a source file to the top of the include stack
 ///  and start lexing tokens from it instead of the current buffer.
 void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
@@ -415,6 +433,12 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
       LeaveSubmodule();
     }
 
+    if (!TimeTracedLexers.empty() && TimeTracedLexers.back() == CurPPLexer) {
+      TimeTracedLexers.pop_back();
+      if (timeTraceProfilerEnabled())
+        timeTraceProfilerEnd();
+    }
+
     // We're done with the #included file.
     RemoveTopOfLexerStack();
 
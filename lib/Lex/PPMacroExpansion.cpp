@@ -28,6 +28,7 @@
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorLexer.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Lex/PTHLexer.h"
 #include "clang/Lex/Token.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -457,6 +458,19 @@ bool Preprocessor::isNextPPTokenLParen() {
   return Val == 1;
 }
 
+bool Preprocessor::shouldElideMacroExpansionLocs(SourceLocation ExpandLoc,
+                                                 SourceLocation DefLoc) {
+  // Only expansions written directly in a system header qualify; a macro name
+  // that came from another expansion has a macro location. The tokens end up
+  // where the macro is defined, so that has to be in a system header too.
+  if (!PPOpts->ElideSystemMacroExpansionLocs || !ExpandLoc.isFileID() ||
+      !SourceMgr.isInSystemHeader(ExpandLoc) ||
+      !SourceMgr.isInSystemHeader(DefLoc))
+    return false;
+  ++NumElidedMacroExpansions;
+  return true;
+}
+
 /// HandleMacroExpandedIdentifier - If an identifier token is read that is to be
 /// expanded as a macro, handle it and return the next token as 'Identifier'.
 bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
@@ -584,10 +598,12 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
 
     // Update the tokens location to include both its expansion and physical
     // locations.
-    SourceLocation Loc =
-      SourceMgr.createExpansionLoc(Identifier.getLocation(), ExpandLoc,
-                                   ExpansionEnd,Identifier.getLength());
-    Identifier.setLocation(Loc);
+    if (!shouldElideMacroExpansionLocs(ExpandLoc, Identifier.getLocation())) {
+      SourceLocation Loc =
+        SourceMgr.createExpansionLoc(Identifier.getLocation(), ExpandLoc,
+                                     ExpansionEnd,Identifier.getLength());
+      Identifier.setLocation(Loc);
+    }
 
     // If this is a disabled macro or #define X X, we must mark the result as
     // unexpandable.
@@ -431,9 +431,13 @@ static void InvalidPTH(DiagnosticsEngine &Diags, const char *Msg) {
 }
 
 PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
-  // Memory map the PTH file.
+  // Memory map the PTH file.  Nothing reads past the end of the tables, so
+  // don't require a null terminator; that would force a heap copy whenever the
+  // file size is a multiple of the page size, and the mapping could then not
+  // be shared with other compiler processes reading the same cache.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileOrErr =
-      llvm::MemoryBuffer::getFile(file);
+      llvm::MemoryBuffer::getFile(file, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
 
   if (!FileOrErr) {
     // FIXME: Add ec.message() to this diag.
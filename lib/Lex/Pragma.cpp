@@ -383,6 +383,10 @@ void Preprocessor::HandlePragmaOnce(Token &OnceTok) {
   // Get the current file lexer we're looking at.  Ignore _Pragma 'files' etc.
   // Mark the file as a once-only file now.
   HeaderInfo.MarkFileIncludeOnce(getCurrentFileLexer()->getFileEntry());
+
+  // A '#pragma once' next to the include guard does not hide it.
+  if (CurPPLexer)
+    CurPPLexer->MIOpt.ReadFileLocalDirective();
 }
 
 void Preprocessor::HandlePragmaMark() {
@@ -449,6 +453,10 @@ void Preprocessor::HandlePragmaSystemHeader(Token &SysHeaderTok) {
   // Mark the file as a system header.
   HeaderInfo.MarkFileSystemHeader(TheLexer->getFileEntry());
 
+  // Neither does a '#pragma system_header' before it.
+  if (CurPPLexer)
+    CurPPLexer->MIOpt.ReadFileLocalDirective();
+
 
   PresumedLoc PLoc = SourceMgr.getPresumedLoc(SysHeaderTok.getLocation());
   if (PLoc.isInvalid())
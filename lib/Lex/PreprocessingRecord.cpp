@@ -16,6 +16,7 @@
 #include "clang/Lex/Token.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <algorithm>
 
 using namespace clang;
 
@@ -35,7 +36,7 @@ InclusionDirective::InclusionDirective(PreprocessingRecord &PPRec,
 
 PreprocessingRecord::PreprocessingRecord(SourceManager &SM)
   : SourceMgr(SM),
-    ExternalSource(nullptr) {
+    ExternalSource(nullptr), MainFileOnly(false), NumEntitiesByFile(0) {
 }
 
 /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -116,6 +117,66 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
                                         FID, SourceMgr);
 }
 
+void PreprocessingRecord::updateLocalEntitiesByFile() {
+  if (NumEntitiesByFile == PreprocessedEntities.size())
+    return;
+
+  LocalEntitiesByFile.clear();
+  for (PreprocessedEntity *PPE : PreprocessedEntities) {
+    SourceRange Range = PPE->getSourceRange();
+    if (Range.isInvalid())
+      continue;
+    std::pair<FileID, unsigned> Begin =
+        SourceMgr.getDecomposedLoc(SourceMgr.getFileLoc(Range.getBegin()));
+    std::pair<FileID, unsigned> End =
+        SourceMgr.getDecomposedLoc(SourceMgr.getFileLoc(Range.getEnd()));
+    if (End.first != Begin.first || End.second < Begin.second)
+      End.second = Begin.second;
+    FileEntityInfo Info = { Begin.second, End.second, PPE };
+    LocalEntitiesByFile[Begin.first].push_back(Info);
+  }
+
+  // Entities are in translation unit order, which is offset order within a
+  // file; only the ones that were inserted out of order need to move.
+  for (auto &File : LocalEntitiesByFile)
+    std::stable_sort(File.second.begin(), File.second.end());
+  NumEntitiesByFile = PreprocessedEntities.size();
+}
+
+ArrayRef<PreprocessingRecord::FileEntityInfo>
+PreprocessingRecord::getLocalPreprocessedEntitiesInFile(FileID FID,
+                                                        unsigned BeginOffset,
+                                                        unsigned EndOffset) {
+  if (FID.isInvalid() || BeginOffset > EndOffset)
+    return None;
+
+  updateLocalEntitiesByFile();
+  auto Pos = LocalEntitiesByFile.find(FID);
+  if (Pos == LocalEntitiesByFile.end())
+    return None;
+  ArrayRef<FileEntityInfo> Entities = Pos->second;
+
+  // As in findBeginLocalPreprocessedEntity, the end offsets may be unordered
+  // when a macro expansion is inside another macro argument, but then it does
+  // not matter whether we start at the macro expansion or its containing one.
+  size_t First = 0, Count = Entities.size();
+  while (Count > 0) {
+    size_t Half = Count / 2;
+    if (Entities[First + Half].EndOffset < BeginOffset) {
+      First += Half + 1;
+      Count -= Half + 1;
+    } else
+      Count = Half;
+  }
+
+  const FileEntityInfo *Last = std::upper_bound(
+      Entities.begin() + First, Entities.end(), EndOffset,
+      [](unsigned Offset, const FileEntityInfo &Info) {
+        return Offset < Info.BeginOffset;
+      });
+  return Entities.slice(First, Last - (Entities.begin() + First));
+}
+
 /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
 /// that source range \arg R encompasses.
 std::pair<int, int>
@@ -368,6 +429,9 @@ void PreprocessingRecord::addMacroExpansion(const Token &Id,
   if (Id.getLocation().isMacroID())
     return;
 
+  if (!shouldRecordEntityAt(Range.getBegin()))
+    return;
+
   if (MI->isBuiltinMacro())
     addPreprocessedEntity(new (*this)
                               MacroExpansion(Id.getIdentifierInfo(), Range));
@@ -436,6 +500,9 @@ void PreprocessingRecord::InclusionDirective(
     StringRef SearchPath,
     StringRef RelativePath,
     const Module *Imported) {
+  if (!shouldRecordEntityAt(HashLoc))
+    return;
+
   InclusionDirective::InclusionKind Kind = InclusionDirective::Include;
   
   switch (IncludeTok.getIdentifierInfo()->getPPKeywordID()) {
@@ -476,8 +543,12 @@ void PreprocessingRecord::InclusionDirective(
 }
 
 size_t PreprocessingRecord::getTotalMemory() const {
-  return BumpAlloc.getTotalMemory()
+  size_t Total = BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
     + llvm::capacity_in_bytes(PreprocessedEntities)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities);
+  Total += llvm::capacity_in_bytes(LocalEntitiesByFile);
+  for (const auto &File : LocalEntitiesByFile)
+    Total += llvm::capacity_in_bytes(File.second);
+  return Total;
 }
@@ -99,8 +99,11 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
   NumEnteredSourceFiles = 0;
   NumMacroExpanded = NumFnMacroExpanded = NumBuiltinMacroExpanded = 0;
   NumFastMacroExpanded = NumTokenPaste = NumFastTokenPaste = 0;
+  NumElidedMacroExpansions = 0;
   MaxIncludeStackDepth = 0;
   NumSkipped = 0;
+  NumSkippedByTable = 0;
+  NumLexedFileTokens = 0;
   
   // Default to discarding comments.
   KeepComments = false;
@@ -271,10 +274,16 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "  " << NumEndif << " #endif.\n";
   llvm::errs() << "  " << NumPragma << " #pragma.\n";
   llvm::errs() << NumSkipped << " #if/#ifndef#ifdef regions skipped\n";
+  llvm::errs() << "  " << NumSkippedByTable
+               << " skipped using known directive offsets.\n";
 
   llvm::errs() << NumMacroExpanded << "/" << NumFnMacroExpanded << "/"
              << NumBuiltinMacroExpanded << " obj/fn/builtin macros expanded, "
              << NumFastMacroExpanded << " on the fast path.\n";
+  llvm::errs() << NumElidedMacroExpansions
+             << " macro expansions in system headers without expansion "
+                "locations.\n";
+  llvm::errs() << NumLexedFileTokens << " tokens lexed from source files.\n";
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
@@ -299,7 +308,7 @@ void Preprocessor::PrintStats() {
 Preprocessor::macro_iterator
 Preprocessor::macro_begin(bool IncludeExternalMacros) const {
   if (IncludeExternalMacros && ExternalSource &&
-      !ReadMacrosFromExternalSource) {
+      !ReadMacrosFromExternalSource && !PPOpts->StrictLazyPCHLoading) {
     ReadMacrosFromExternalSource = true;
     ExternalSource->ReadDefinedMacros();
   }
@@ -326,7 +335,7 @@ size_t Preprocessor::getTotalMemory() const {
 Preprocessor::macro_iterator
 Preprocessor::macro_end(bool IncludeExternalMacros) const {
   if (IncludeExternalMacros && ExternalSource &&
-      !ReadMacrosFromExternalSource) {
+      !ReadMacrosFromExternalSource && !PPOpts->StrictLazyPCHLoading) {
     ReadMacrosFromExternalSource = true;
     ExternalSource->ReadDefinedMacros();
   }
@@ -500,6 +509,29 @@ Module *Preprocessor::getCurrentModule() {
 // Preprocessor Initialization Methods
 //===----------------------------------------------------------------------===//
 
+/// minimizeFileToDirectives - Replace the contents of the specified file by
+/// just its preprocessor directives, for a dependency scan.
+void Preprocessor::minimizeFileToDirectives(const FileEntry *File) {
+  // Module builds would keep the minimized headers.  Files overridden already
+  // have been minimized, or were remapped on purpose.
+  if (!PPOpts->MinimizeSourcesToDirectives || getLangOpts().Modules ||
+      !File || SourceMgr.isFileOverridden(File))
+    return;
+
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer =
+      SourceMgr.getMemoryBufferForFile(File, &Invalid);
+  if (Invalid)
+    return;
+
+  SmallVector<char, 0> Minimized;
+  Lexer::MinimizeToDirectives(Buffer->getBuffer(), getLangOpts(), Minimized);
+  SourceMgr.overrideFileContents(
+      File, llvm::MemoryBuffer::getMemBufferCopy(
+                StringRef(Minimized.data(), Minimized.size()),
+                Buffer->getBufferIdentifier()));
+}
+
 /// EnterMainSourceFile - Enter the specified FileID as the main source file,
 /// which implicitly adds the builtin defines etc.
 void Preprocessor::EnterMainSourceFile() {
@@ -512,6 +544,8 @@ void Preprocessor::EnterMainSourceFile() {
   // If MainFileID is loaded it means we loaded an AST file, no need to enter
   // a main file.
   if (!SourceMgr.isLoadedFileID(MainFileID)) {
+    minimizeFileToDirectives(SourceMgr.getFileEntryForID(MainFileID));
+
     // Enter the main file source buffer.
     EnterSourceFile(MainFileID, nullptr, SourceLocation());
 
@@ -743,9 +777,11 @@ void Preprocessor::Lex(Token &Result) {
     switch (CurLexerKind) {
     case CLK_Lexer:
       ReturnedToken = CurLexer->Lex(Result);
+      NumLexedFileTokens += ReturnedToken;
       break;
     case CLK_PTHLexer:
       ReturnedToken = CurPTHLexer->Lex(Result);
+      NumLexedFileTokens += ReturnedToken;
       break;
     case CLK_TokenLexer:
       ReturnedToken = CurTokenLexer->Lex(Result);
@@ -949,5 +985,6 @@ void Preprocessor::createPreprocessingRecord() {
     return;
   
   Record = new PreprocessingRecord(getSourceManager());
+  Record->setMainFileOnly(PPOpts->DetailedRecordMainFileOnly);
   addPPCallbacks(std::unique_ptr<PPCallbacks>(Record));
 }
@@ -43,6 +43,7 @@ void TokenLexer::Init(Token &Tok, SourceLocation ELEnd, MacroInfo *MI,
   DisableMacroExpansion = false;
   NumTokens = Macro->tokens_end()-Macro->tokens_begin();
   MacroExpansionStart = SourceLocation();
+  ElideExpansionLocs = false;
 
   SourceManager &SM = PP.getSourceManager();
   MacroStartSLocOffset = SM.getNextLocalOffset();
@@ -59,10 +60,17 @@ void TokenLexer::Init(Token &Tok, SourceLocation ELEnd, MacroInfo *MI,
     // creating separate source location entries for each token.
     MacroDefStart = SM.getExpansionLoc(Tokens[0].getLocation());
     MacroDefLength = Macro->getDefinitionLength(SM);
-    MacroExpansionStart = SM.createExpansionLoc(MacroDefStart,
-                                                ExpandLocStart,
-                                                ExpandLocEnd,
-                                                MacroDefLength);
+
+    // Pasted tokens need the chunk to describe where they came from.
+    ElideExpansionLocs = !Macro->hasPasteOrComment() &&
+                         !PP.getLangOpts().MSVCCompat &&
+                         PP.shouldElideMacroExpansionLocs(ExpandLocStart,
+                                                          MacroDefStart);
+    if (!ElideExpansionLocs)
+      MacroExpansionStart = SM.createExpansionLoc(MacroDefStart,
+                                                  ExpandLocStart,
+                                                  ExpandLocEnd,
+                                                  MacroDefLength);
   }
 
   // If this is a function-like macro, expand the arguments and change
@@ -70,6 +78,9 @@ void TokenLexer::Init(Token &Tok, SourceLocation ELEnd, MacroInfo *MI,
   if (Macro->isFunctionLike() && Macro->getNumArgs())
     ExpandFunctionArguments();
 
+  IsDefinitionExpansion = NumTokens > 0 && !Macro->hasPasteOrComment() &&
+                          Tokens == &*Macro->tokens_begin();
+
   // Mark the macro as currently disabled, so that it is not recursively
   // expanded.  The macro must be disabled only after argument pre-expansion of
   // function-like macro arguments occurs.
@@ -89,6 +100,8 @@ void TokenLexer::Init(const Token *TokArray, unsigned NumToks,
   Tokens = TokArray;
   OwnsTokens = ownsTokens;
   DisableMacroExpansion = disableMacroExpansion;
+  IsDefinitionExpansion = false;
+  ElideExpansionLocs = false;
   NumTokens = NumToks;
   CurToken = 0;
   ExpandLocStart = ExpandLocEnd = SourceLocation();
@@ -190,10 +203,12 @@ void TokenLexer::ExpandFunctionArguments() {
       int ArgNo = Macro->getArgumentNum(Tokens[i+1].getIdentifierInfo());
       assert(ArgNo != -1 && "Token following # is not an argument?");
 
-      SourceLocation ExpansionLocStart =
-          getExpansionLocForMacroDefLoc(CurTok.getLocation());
-      SourceLocation ExpansionLocEnd =
-          getExpansionLocForMacroDefLoc(Tokens[i+1].getLocation());
+      SourceLocation ExpansionLocStart = CurTok.getLocation();
+      SourceLocation ExpansionLocEnd = Tokens[i+1].getLocation();
+      if (!ElideExpansionLocs) {
+        ExpansionLocStart = getExpansionLocForMacroDefLoc(ExpansionLocStart);
+        ExpansionLocEnd = getExpansionLocForMacroDefLoc(ExpansionLocEnd);
+      }
 
       Token Res;
       if (CurTok.is(tok::hash))  // Stringify
@@ -295,7 +310,7 @@ void TokenLexer::ExpandFunctionArguments() {
             Tok.setKind(tok::unknown);
         }
 
-        if(ExpandLocStart.isValid()) {
+        if (ExpandLocStart.isValid() && !ElideExpansionLocs) {
           updateLocForMacroArgTokens(CurTok.getLocation(),
                                      ResultToks.begin()+FirstResult,
                                      ResultToks.end());
@@ -339,7 +354,7 @@ void TokenLexer::ExpandFunctionArguments() {
           Tok.setKind(tok::unknown);
       }
 
-      if (ExpandLocStart.isValid()) {
+      if (ExpandLocStart.isValid() && !ElideExpansionLocs) {
         updateLocForMacroArgTokens(CurTok.getLocation(),
                                    ResultToks.end()-NumToks, ResultToks.end());
       }
@@ -441,42 +456,57 @@ bool TokenLexer::Lex(Token &Tok) {
 
   bool TokenIsFromPaste = false;
 
-  // If this token is followed by a token paste (##) operator, paste the tokens!
-  // Note that ## is a normal token when not expanding a macro.
-  if (!isAtEnd() && Macro &&
-      (Tokens[CurToken].is(tok::hashhash) ||
-       // Special processing of L#x macros in -fms-compatibility mode.
-       // Microsoft compiler is able to form a wide string literal from
-       // 'L#macro_arg' construct in a function-like macro.
-       (PP.getLangOpts().MSVCCompat &&
-        isWideStringLiteralFromMacro(Tok, Tokens[CurToken])))) {
-    // When handling the microsoft /##/ extension, the final token is
-    // returned by PasteTokens, not the pasted token.
-    if (PasteTokens(Tok))
-      return true;
+  if (ElideExpansionLocs) {
+    // Everything but the names of macros keeps its spelling location.  Those
+    // are given expansion locations, so that the expansions they start (such
+    // as __LINE__ or _Pragma) know where they happened.  Arguments are
+    // spelled outside the definition and never need one.
+    const IdentifierInfo *II = Tok.getIdentifierInfo();
+    if (II && II->hasMacroDefinition() && Tok.getLocation().isFileID() &&
+        SM.isInSLocAddrSpace(Tok.getLocation(), MacroDefStart, MacroDefLength))
+      Tok.setLocation(getExpansionLocForMacroDefLoc(Tok.getLocation()));
+  } else if (IsDefinitionExpansion) {
+    // Tokens straight from the replacement list all come from the macro
+    // definition, and there is nothing to paste.
+    Tok.setLocation(getExpansionLocForMacroDefLoc(Tok.getLocation()));
+  } else {
+    // If this token is followed by a token paste (##) operator, paste the
+    // tokens!  Note that ## is a normal token when not expanding a macro.
+    if (!isAtEnd() && Macro &&
+        (Tokens[CurToken].is(tok::hashhash) ||
+         // Special processing of L#x macros in -fms-compatibility mode.
+         // Microsoft compiler is able to form a wide string literal from
+         // 'L#macro_arg' construct in a function-like macro.
+         (PP.getLangOpts().MSVCCompat &&
+          isWideStringLiteralFromMacro(Tok, Tokens[CurToken])))) {
+      // When handling the microsoft /##/ extension, the final token is
+      // returned by PasteTokens, not the pasted token.
+      if (PasteTokens(Tok))
+        return true;
+
+      TokenIsFromPaste = true;
+    }
 
-    TokenIsFromPaste = true;
-  }
+    // The token's current location indicate where the token was lexed from.
+    // We need this information to compute the spelling of the token, but any
+    // diagnostics for the expanded token should appear as if they came from
+    // ExpansionLoc.  Pull this information together into a new SourceLocation
+    // that captures all of this.
+    if (ExpandLocStart.isValid() &&   // Don't do this for token streams.
+        // Check that the token's location was not already set properly.
+        SM.isBeforeInSLocAddrSpace(Tok.getLocation(), MacroStartSLocOffset)) {
+      SourceLocation instLoc;
+      if (Tok.is(tok::comment)) {
+        instLoc = SM.createExpansionLoc(Tok.getLocation(),
+                                        ExpandLocStart,
+                                        ExpandLocEnd,
+                                        Tok.getLength());
+      } else {
+        instLoc = getExpansionLocForMacroDefLoc(Tok.getLocation());
+      }
 
-  // The token's current location indicate where the token was lexed from.  We
-  // need this information to compute the spelling of the token, but any
-  // diagnostics for the expanded token should appear as if they came from
-  // ExpansionLoc.  Pull this information together into a new SourceLocation
-  // that captures all of this.
-  if (ExpandLocStart.isValid() &&   // Don't do this for token streams.
-      // Check that the token's location was not already set properly.
-      SM.isBeforeInSLocAddrSpace(Tok.getLocation(), MacroStartSLocOffset)) {
-    SourceLocation instLoc;
-    if (Tok.is(tok::comment)) {
-      instLoc = SM.createExpansionLoc(Tok.getLocation(),
-                                      ExpandLocStart,
-                                      ExpandLocEnd,
-                                      Tok.getLength());
-    } else {
-      instLoc = getExpansionLocForMacroDefLoc(Tok.getLocation());
+      Tok.setLocation(instLoc);
     }
-
-    Tok.setLocation(instLoc);
   }
 
   // If this is the first token, set the lexical properties of the token to
@@ -738,15 +768,20 @@ void TokenLexer::HandleMicrosoftCommentPaste(Token &Tok, SourceLocation OpLoc) {
 /// macro expansion source location entry, otherwise it returns an invalid
 /// SourceLocation.
 SourceLocation
-TokenLexer::getExpansionLocForMacroDefLoc(SourceLocation loc) const {
-  assert(ExpandLocStart.isValid() && MacroExpansionStart.isValid() &&
-         "Not appropriate for token streams");
+TokenLexer::getExpansionLocForMacroDefLoc(SourceLocation loc) {
+  assert(ExpandLocStart.isValid() && "Not appropriate for token streams");
   assert(loc.isValid() && loc.isFileID());
   
   SourceManager &SM = PP.getSourceManager();
   assert(SM.isInSLocAddrSpace(loc, MacroDefStart, MacroDefLength) &&
          "Expected loc to come from the macro definition");
 
+  if (MacroExpansionStart.isInvalid()) {
+    assert(ElideExpansionLocs && "Macro expansion chunk was not reserved");
+    MacroExpansionStart = SM.createExpansionLoc(MacroDefStart, ExpandLocStart,
+                                                ExpandLocEnd, MacroDefLength);
+  }
+
   unsigned relativeOffset = 0;
   SM.isInSLocAddrSpace(loc, MacroDefStart, MacroDefLength, &relativeOffset);
   return MacroExpansionStart.getLocWithOffset(relativeOffset);
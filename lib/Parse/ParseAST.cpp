@@ -16,14 +16,19 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/Stmt.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/Parser.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
+#include <algorithm>
 #include <cstdio>
 #include <memory>
+#include <vector>
 
 using namespace clang;
 
@@ -87,6 +92,99 @@ void PrettyStackTraceParserEntry::print(raw_ostream &OS) const {
 
 }  // namespace
 
+/// The number of node kinds listed by PrintMemoryStats.
+static const unsigned NumLargestNodeKinds = 10;
+
+static void PrintAllocatorStats(StringRef Name,
+                                const llvm::BumpPtrAllocator &Alloc) {
+  size_t Allocated = Alloc.getBytesAllocated();
+  size_t Slabs = Alloc.getTotalMemory();
+  llvm::errs() << llvm::format("  %-28s%14zu%14zu%14zu\n", Name.str().c_str(),
+                               Allocated, Slabs,
+                               Slabs > Allocated ? Slabs - Allocated : 0);
+}
+
+static void PrintMemoryStat(StringRef Name, size_t Bytes) {
+  llvm::errs() << llvm::format("  %-28s%14zu\n", Name.str().c_str(), Bytes);
+}
+
+/// Print the memory used by the subsystems of the frontend, the heap in use
+/// after each phase, and the kinds of AST nodes which take the most memory.
+static void PrintMemoryStats(Sema &S, size_t HeapAtStart,
+                             size_t HeapAfterParsing,
+                             size_t HeapAfterConsumer) {
+  Preprocessor &PP = S.getPreprocessor();
+  const SourceManager &SM = PP.getSourceManager();
+  ASTContext &Ctx = S.getASTContext();
+
+  llvm::errs() << "\n*** Memory Stats:\n";
+  llvm::errs() << llvm::format("  %-28s%14s%14s%14s\n", "Allocator",
+                               "Allocated", "Slabs", "Wasted");
+  PrintAllocatorStats("ASTContext", Ctx.getAllocator());
+  PrintAllocatorStats("Sema", S.BumpAlloc);
+  PrintAllocatorStats("Preprocessor", PP.getPreprocessorAllocator());
+  PrintAllocatorStats("IdentifierTable",
+                      PP.getIdentifierTable().getAllocator());
+  PrintAllocatorStats("SourceManager", SM.getContentCacheAllocator());
+
+  llvm::errs() << llvm::format("  %-28s%14s\n", "Other", "Bytes");
+  PrintMemoryStat("ASTContext side tables", Ctx.getSideTableAllocatedMemory());
+  PrintMemoryStat("Preprocessor tables",
+                  PP.getTotalMemory() -
+                      PP.getPreprocessorAllocator().getTotalMemory());
+  PrintMemoryStat("SourceManager tables", SM.getDataStructureSizes());
+  SourceManager::MemoryBufferSizes Buffers = SM.getMemoryBufferSizes();
+  PrintMemoryStat("Source buffers (malloc)", Buffers.malloc_bytes);
+  PrintMemoryStat("Source buffers (mmap)", Buffers.mmap_bytes);
+  if (ExternalASTSource *External = Ctx.getExternalSource()) {
+    ExternalASTSource::MemoryBufferSizes ASTBuffers =
+        External->getMemoryBufferSizes();
+    PrintMemoryStat("AST file buffers (malloc)", ASTBuffers.malloc_bytes);
+    PrintMemoryStat("AST file buffers (mmap)", ASTBuffers.mmap_bytes);
+  }
+
+  // The heap in use is only known on hosts which can tell.
+  if (HeapAtStart || HeapAfterParsing || HeapAfterConsumer) {
+    llvm::errs() << llvm::format("  %-28s%14s%14s\n", "Heap in use", "Bytes",
+                                 "Growth");
+    llvm::errs() << llvm::format("  %-28s%14zu\n", "at start", HeapAtStart);
+    llvm::errs() << llvm::format("  %-28s%14zu%14lld\n", "after parsing",
+                                 HeapAfterParsing,
+                                 (long long)HeapAfterParsing -
+                                     (long long)HeapAtStart);
+    llvm::errs() << llvm::format("  %-28s%14zu%14lld\n",
+                                 "after the AST consumer", HeapAfterConsumer,
+                                 (long long)HeapAfterConsumer -
+                                     (long long)HeapAfterParsing);
+  }
+
+  struct NodeKindStat {
+    StringRef Name;
+    unsigned Count;
+    size_t Bytes;
+  };
+  std::vector<NodeKindStat> NodeKinds;
+  auto AddNodeKind = [&](StringRef Name, unsigned Count, size_t Size) {
+    NodeKinds.push_back({Name, Count, Count * Size});
+  };
+  Decl::forEachKindStat(AddNodeKind);
+  Stmt::forEachClassStat(AddNodeKind);
+  std::sort(NodeKinds.begin(), NodeKinds.end(),
+            [](const NodeKindStat &A, const NodeKindStat &B) {
+              if (A.Bytes != B.Bytes)
+                return A.Bytes > B.Bytes;
+              return A.Name < B.Name;
+            });
+  if (NodeKinds.size() > NumLargestNodeKinds)
+    NodeKinds.resize(NumLargestNodeKinds);
+  llvm::errs() << llvm::format("  %-28s%14s%14s\n", "Largest node kinds",
+                               "Count", "Bytes");
+  for (const NodeKindStat &Kind : NodeKinds)
+    llvm::errs() << llvm::format("  %-28s%14u%14zu\n",
+                                 Kind.Name.str().c_str(), Kind.Count,
+                                 Kind.Bytes);
+}
+
 //===----------------------------------------------------------------------===//
 // Public interface to the file
 //===----------------------------------------------------------------------===//
@@ -123,6 +221,8 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
 
   ASTConsumer *Consumer = &S.getASTConsumer();
 
+  size_t HeapAtStart = PrintStats ? llvm::sys::Process::GetMallocUsage() : 0;
+
   std::unique_ptr<Parser> ParseOP(
       new Parser(S.getPreprocessor(), S, SkipFunctionBodies));
   Parser &P = *ParseOP.get();
@@ -135,28 +235,38 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   llvm::CrashRecoveryContextCleanupRegistrar<Parser>
     CleanupParser(ParseOP.get());
 
-  S.getPreprocessor().EnterMainSourceFile();
-  P.Initialize();
+  {
+    // The time spent on the translation unit before it is handed off as a
+    // whole, e.g. to the backend.
+    TimeTraceScope TimeScope("Frontend");
 
-  Parser::DeclGroupPtrTy ADecl;
-  ExternalASTSource *External = S.getASTContext().getExternalSource();
-  if (External)
-    External->StartTranslationUnit(Consumer);
+    S.getPreprocessor().EnterMainSourceFile();
+    P.Initialize();
 
-  for (bool AtEOF = P.ParseFirstTopLevelDecl(ADecl); !AtEOF;
-       AtEOF = P.ParseTopLevelDecl(ADecl)) {
-    // If we got a null return and something *was* parsed, ignore it.  This
-    // is due to a top-level semicolon, an action override, or a parse error
-    // skipping something.
-    if (ADecl && !Consumer->HandleTopLevelDecl(ADecl.get()))
-      return;
+    Parser::DeclGroupPtrTy ADecl;
+    ExternalASTSource *External = S.getASTContext().getExternalSource();
+    if (External)
+      External->StartTranslationUnit(Consumer);
+
+    for (bool AtEOF = P.ParseFirstTopLevelDecl(ADecl); !AtEOF;
+         AtEOF = P.ParseTopLevelDecl(ADecl)) {
+      // If we got a null return and something *was* parsed, ignore it.  This
+      // is due to a top-level semicolon, an action override, or a parse error
+      // skipping something.
+      if (ADecl && !Consumer->HandleTopLevelDecl(ADecl.get()))
+        return;
+    }
+
+    // Process any TopLevelDecls generated by #pragma weak.
+    for (Decl *D : S.WeakTopLevelDecls())
+      Consumer->HandleTopLevelDecl(DeclGroupRef(D));
   }
 
-  // Process any TopLevelDecls generated by #pragma weak.
-  for (Decl *D : S.WeakTopLevelDecls())
-    Consumer->HandleTopLevelDecl(DeclGroupRef(D));
-  
+  size_t HeapAfterParsing =
+      PrintStats ? llvm::sys::Process::GetMallocUsage() : 0;
   Consumer->HandleTranslationUnit(S.getASTContext());
+  size_t HeapAfterConsumer =
+      PrintStats ? llvm::sys::Process::GetMallocUsage() : 0;
 
   std::swap(OldCollectStats, S.CollectStats);
   if (PrintStats) {
@@ -166,5 +276,6 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
     Decl::PrintStats();
     Stmt::PrintStats();
     Consumer->PrintStats();
+    PrintMemoryStats(S, HeapAtStart, HeapAfterParsing, HeapAfterConsumer);
   }
 }
@@ -17,6 +17,42 @@
 #include "clang/Sema/ParsedTemplate.h"
 using namespace clang;
 
+/// The outcome of a disambiguation depends on the tokens it starts at, on
+/// whether '>' ends a template argument list, and on the identifiers being
+/// declared tentatively.
+Parser::TentativeParseKey Parser::getTentativeParseKey(unsigned Kind) const {
+  return TentativeParseKey(Tok.getLocation().getRawEncoding(),
+                           Kind | GreaterThanIsOperator << 8 |
+                               TentativelyDeclaredIdentifiers.size() << 9);
+}
+
+namespace {
+enum TentativeParseOutcome : unsigned char {
+  TPO_True = 1 << 0,
+  TPO_Ambiguous = 1 << 1
+};
+}
+
+bool Parser::lookupTentativeParse(TentativeParseKey Key, bool &Result,
+                                  bool &IsAmbiguous) const {
+  auto Known = TentativeParseCache.find(Key);
+  if (Known == TentativeParseCache.end())
+    return false;
+  Result = Known->second & TPO_True;
+  IsAmbiguous = Known->second & TPO_Ambiguous;
+  return true;
+}
+
+void Parser::rememberTentativeParse(TentativeParseKey Key, bool Result,
+                                    bool IsAmbiguous) {
+  // Tokens without a location, such as those of some annotations, can't be
+  // told apart.
+  if (!Key.first)
+    return;
+  TentativeParseCache[Key] =
+      (Result ? TPO_True : 0) | (IsAmbiguous ? TPO_Ambiguous : 0);
+}
+
 /// isCXXDeclarationStatement - C++-specialized function that disambiguates
 /// between a declaration or an expression statement, when parsing function
 /// bodies. Returns true for declaration, false for expression.
@@ -132,6 +168,11 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '(',
   // or an identifier which doesn't resolve as anything. We need tentative
   // parsing...
+  TentativeParseKey Key = getTentativeParseKey(
+      AllowForRangeDecl ? TPK_ForRangeDeclaration : TPK_SimpleDeclaration);
+  bool Result, IsAmbiguous;
+  if (lookupTentativeParse(Key, Result, IsAmbiguous))
+    return Result;
  
   {
     RevertingTentativeParsingAction PA(*this);
@@ -139,14 +180,18 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   }
 
   // In case of an error, let the declaration parsing code handle it.
-  if (TPR == TPResult::Error)
+  if (TPR == TPResult::Error) {
+    rememberTentativeParse(Key, true, false);
     return true;
+  }
 
   // Declarations take precedence over expressions.
-  if (TPR == TPResult::Ambiguous)
+  IsAmbiguous = TPR == TPResult::Ambiguous;
+  if (IsAmbiguous)
     TPR = TPResult::True;
 
   assert(TPR == TPResult::True || TPR == TPResult::False);
+  rememberTentativeParse(Key, TPR == TPResult::True, IsAmbiguous);
   return TPR == TPResult::True;
 }
 
@@ -507,6 +552,10 @@ bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
 
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '('.
   // We need tentative parsing...
+  TentativeParseKey Key = getTentativeParseKey(TPK_TypeId + Context);
+  bool Result;
+  if (lookupTentativeParse(Key, Result, isAmbiguous))
+    return Result;
 
   RevertingTentativeParsingAction PA(*this);
 
@@ -542,6 +591,7 @@ bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
   }
 
   assert(TPR == TPResult::True || TPR == TPResult::False);
+  rememberTentativeParse(Key, TPR == TPResult::True, isAmbiguous);
   return TPR == TPResult::True;
 }
 
@@ -1673,6 +1723,13 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // declaration with a function-style cast as the initializer. Just as for the
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
+  TentativeParseKey Key = getTentativeParseKey(TPK_FunctionDeclarator);
+  bool Result, Ambiguous;
+  if (lookupTentativeParse(Key, Result, Ambiguous)) {
+    if (IsAmbiguous && Ambiguous)
+      *IsAmbiguous = true;
+    return Result;
+  }
 
   RevertingTentativeParsingAction PA(*this);
 
@@ -1702,6 +1759,8 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
     *IsAmbiguous = true;
 
   // In case of an error, let the declaration parsing code handle it.
+  rememberTentativeParse(Key, TPR != TPResult::False,
+                         TPR == TPResult::Ambiguous);
   return TPR != TPResult::False;
 }
 
@@ -21,7 +21,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
 #include <memory>
+#include <vector>
 using namespace clang;
 
 
@@ -359,11 +361,45 @@ void html::AddHeaderFooterInternalBuiltinCSS(Rewriter &R, FileID FID,
   R.InsertTextAfter(EndLoc, "</body></html>\n");
 }
 
+namespace {
+/// \brief A range highlighted with HighlightRange, recorded to be applied to
+/// other rewrite buffers of the same file.
+struct Highlight {
+  unsigned B, E;
+  std::string StartTag, EndTag;
+};
+typedef std::vector<Highlight> HighlightList;
+} // end anonymous namespace
+
+struct html::RelexRewriteCache {
+  std::map<FileID, HighlightList> SyntaxHighlights;
+  std::map<FileID, HighlightList> MacroHighlights;
+};
+
+html::RelexRewriteCacheRef html::instantiateRelexRewriteCache() {
+  return std::make_shared<RelexRewriteCache>();
+}
+
+/// \brief Applies the highlighting recorded for \p FID in \p Cache to \p RB,
+/// if there is any.
+static bool applyCachedHighlights(const std::map<FileID, HighlightList> &Cache,
+                                  FileID FID, RewriteBuffer &RB,
+                                  const char *BufferStart) {
+  auto Highlights = Cache.find(FID);
+  if (Highlights == Cache.end())
+    return false;
+  for (const Highlight &H : Highlights->second)
+    html::HighlightRange(RB, H.B, H.E, BufferStart, H.StartTag.c_str(),
+                         H.EndTag.c_str());
+  return true;
+}
+
 /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
 /// information about keywords, macro expansions etc.  This uses the macro
 /// table state from the end of the file, so it won't be perfectly perfect,
 /// but it will be reasonably close.
-void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
+void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP,
+                           RelexRewriteCacheRef Cache) {
   RewriteBuffer &RB = R.getEditBuffer(FID);
 
   const SourceManager &SM = PP.getSourceManager();
@@ -371,6 +407,18 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
   const char *BufferStart = L.getBuffer().data();
 
+  if (Cache &&
+      applyCachedHighlights(Cache->SyntaxHighlights, FID, RB, BufferStart))
+    return;
+
+  HighlightList Highlights;
+  auto AddHighlight = [&](unsigned B, unsigned E, const char *StartTag,
+                          const char *EndTag) {
+    HighlightRange(RB, B, E, BufferStart, StartTag, EndTag);
+    if (Cache)
+      Highlights.push_back({B, E, StartTag, EndTag});
+  };
+
   // Inform the preprocessor that we want to retain comments as tokens, so we
   // can highlight them.
   L.SetCommentRetentionState(true);
@@ -396,13 +444,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
       // If this is a pp-identifier, for a keyword, highlight it as such.
       if (Tok.isNot(tok::identifier))
-        HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                       "<span class='keyword'>", "</span>");
+        AddHighlight(TokOffs, TokOffs + TokLen, "<span class='keyword'>",
+                     "</span>");
       break;
     }
     case tok::comment:
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='comment'>", "</span>");
+      AddHighlight(TokOffs, TokOffs + TokLen, "<span class='comment'>",
+                   "</span>");
       break;
     case tok::utf8_string_literal:
       // Chop off the u part of u8 prefix
@@ -418,8 +466,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       // FALL THROUGH.
     case tok::string_literal:
       // FIXME: Exclude the optional ud-suffix from the highlighted range.
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='string_literal'>", "</span>");
+      AddHighlight(TokOffs, TokOffs + TokLen, "<span class='string_literal'>",
+                   "</span>");
       break;
     case tok::hash: {
       // If this is a preprocessor directive, all tokens to end of line are too.
@@ -436,8 +484,7 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       }
 
       // Find end of line.  This is a hack.
-      HighlightRange(RB, TokOffs, TokEnd, BufferStart,
-                     "<span class='directive'>", "</span>");
+      AddHighlight(TokOffs, TokEnd, "<span class='directive'>", "</span>");
 
       // Don't skip the next token.
       continue;
@@ -446,18 +493,28 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
     L.LexFromRawLexer(Tok);
   }
+
+  if (Cache)
+    Cache->SyntaxHighlights[FID] = std::move(Highlights);
 }
 
 /// HighlightMacros - This uses the macro table state from the end of the
 /// file, to re-expand macros and insert (into the HTML) information about the
 /// macro expansions.  This won't be perfectly perfect, but it will be
 /// reasonably close.
-void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
-  // Re-lex the raw token stream into a token buffer.
+void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP,
+                           RelexRewriteCacheRef Cache) {
   const SourceManager &SM = PP.getSourceManager();
-  std::vector<Token> TokenStream;
-
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  const char *BufferStart = FromFile->getBufferStart();
+  if (Cache &&
+      applyCachedHighlights(Cache->MacroHighlights, FID, RB, BufferStart))
+    return;
+  HighlightList Highlights;
+
+  // Re-lex the raw token stream into a token buffer.
+  std::vector<Token> TokenStream;
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
 
   // Lex all the tokens in raw mode, to avoid entering #includes or expanding
@@ -581,11 +638,19 @@ void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
     // highlighted.
     Expansion = "<span class='expansion'>" + Expansion + "</span></span>";
 
-    HighlightRange(R, LLoc.first, LLoc.second,
-                   "<span class='macro'>", Expansion.c_str());
+    unsigned B = SM.getFileOffset(LLoc.first);
+    unsigned E = SM.getFileOffset(LLoc.second) +
+                 Lexer::MeasureTokenLength(LLoc.second, SM, PP.getLangOpts());
+    HighlightRange(RB, B, E, BufferStart, "<span class='macro'>",
+                   Expansion.c_str());
+    if (Cache)
+      Highlights.push_back({B, E, "<span class='macro'>", Expansion});
   }
 
   // Restore the preprocessor's old state.
   TmpPP.setDiagnostics(*OldDiags);
   TmpPP.setPragmasEnabled(PragmasPreviouslyEnabled);
+
+  if (Cache)
+    Cache->MacroHighlights[FID] = std::move(Highlights);
 }
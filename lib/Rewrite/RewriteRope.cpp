@@ -687,6 +687,28 @@ RopePieceBTreeIterator::RopePieceBTreeIterator(const void *n) {
   CurChar = 0;
 }
 
+RopePieceBTreeIterator::RopePieceBTreeIterator(const void *n,
+                                               unsigned Offset) {
+  const RopePieceBTreeNode *N = static_cast<const RopePieceBTreeNode*>(n);
+  assert(Offset < N->size() && "Invalid offset to find!");
+
+  // Walk down the tree to the leaf containing Offset.
+  while (const RopePieceBTreeInterior *IN =
+             dyn_cast<RopePieceBTreeInterior>(N)) {
+    unsigned i = 0;
+    for (; Offset >= IN->getChild(i)->size(); ++i)
+      Offset -= IN->getChild(i)->size();
+    N = IN->getChild(i);
+  }
+
+  CurNode = cast<RopePieceBTreeLeaf>(N);
+  unsigned i = 0;
+  for (; Offset >= getCN(CurNode)->getPiece(i).size(); ++i)
+    Offset -= getCN(CurNode)->getPiece(i).size();
+  CurPiece = &getCN(CurNode)->getPiece(i);
+  CurChar = Offset;
+}
+
 void RopePieceBTreeIterator::MoveToNextPiece() {
   if (CurPiece != &getCN(CurNode)->getPiece(getCN(CurNode)->getNumPieces()-1)) {
     CurChar = 0;
@@ -62,27 +62,42 @@ void RewriteBuffer::RemoveText(unsigned OrigOffset, unsigned Size,
 
   if (removeLineIfEmpty) {
     // Find the line that the remove occurred and if it is completely empty
-    // remove the line as well.
-
-    iterator curLineStart = begin();
-    unsigned curLineStartOffs = 0;
-    iterator posI = begin();
-    for (unsigned i = 0; i != RealOffset; ++i) {
-      if (*posI == '\n') {
-        curLineStart = posI;
-        ++curLineStart;
-        curLineStartOffs = i + 1;
-      }
-      ++posI;
+    // remove the line as well. Seek to the pieces around the removal rather
+    // than walking the buffer from its start, which made every removal linear
+    // in the size of the buffer.
+    unsigned curLineStartOffs = RealOffset;
+    bool blankUpToRemoval = true;
+    while (blankUpToRemoval && curLineStartOffs != 0) {
+      iterator I = Buffer.find(curLineStartOffs - 1);
+      StringRef beforeRemoval = I.piece().substr(0, I.getPieceOffset() + 1);
+      size_t lastNL = beforeRemoval.rfind('\n');
+      if (lastNL != StringRef::npos)
+        beforeRemoval = beforeRemoval.substr(lastNL + 1);
+      for (char c : beforeRemoval)
+        blankUpToRemoval &= isWhitespaceExceptNL(c);
+      curLineStartOffs -= beforeRemoval.size();
+      if (lastNL != StringRef::npos)
+        break;
     }
-  
-    unsigned lineSize = 0;
-    posI = curLineStart;
-    while (posI != end() && isWhitespaceExceptNL(*posI)) {
-      ++posI;
-      ++lineSize;
+
+    unsigned lineSize = RealOffset - curLineStartOffs;
+    bool lineIsEmpty = false;
+    if (blankUpToRemoval) {
+      iterator I = Buffer.find(RealOffset), E = end();
+      for (unsigned skip = I != E ? I.getPieceOffset() : 0; I != E;
+           I.MoveToNextPiece(), skip = 0) {
+        StringRef rest = I.piece().substr(skip);
+        size_t blanks = 0;
+        while (blanks != rest.size() && isWhitespaceExceptNL(rest[blanks]))
+          ++blanks;
+        lineSize += blanks;
+        if (blanks != rest.size()) {
+          lineIsEmpty = rest[blanks] == '\n';
+          break;
+        }
+      }
     }
-    if (posI != end() && *posI == '\n') {
+    if (lineIsEmpty) {
       Buffer.erase(curLineStartOffs, lineSize + 1/* + '\n'*/);
       AddReplaceDelta(curLineStartOffs, -(lineSize + 1/* + '\n'*/));
     }
@@ -1854,8 +1854,28 @@ clang::sema::AnalysisBasedWarnings::Policy::Policy() {
   enableConsumedAnalysis = 0;
 }
 
-static unsigned isEnabled(DiagnosticsEngine &D, unsigned diag) {
-  return (unsigned)!D.isIgnored(diag, SourceLocation());
+static unsigned isEnabled(DiagnosticsEngine &D, unsigned diag,
+                          SourceLocation Loc = SourceLocation()) {
+  return (unsigned)!D.isIgnored(diag, Loc);
+}
+
+/// Turn off the analyses in \p P whose warnings are all ignored at \p Loc.
+static void disableIgnoredAnalyses(sema::AnalysisBasedWarnings::Policy &P,
+                                   DiagnosticsEngine &D, SourceLocation Loc) {
+  using namespace diag;
+
+  if (P.enableCheckUnreachable)
+    P.enableCheckUnreachable =
+      isEnabled(D, warn_unreachable, Loc) ||
+      isEnabled(D, warn_unreachable_break, Loc) ||
+      isEnabled(D, warn_unreachable_return, Loc) ||
+      isEnabled(D, warn_unreachable_loop_increment, Loc);
+
+  if (P.enableThreadSafetyAnalysis)
+    P.enableThreadSafetyAnalysis = isEnabled(D, warn_double_lock, Loc);
+
+  if (P.enableConsumedAnalysis)
+    P.enableConsumedAnalysis = isEnabled(D, warn_use_in_invalid_state, Loc);
 }
 
 clang::sema::AnalysisBasedWarnings::AnalysisBasedWarnings(Sema &s)
@@ -1869,21 +1889,10 @@ clang::sema::AnalysisBasedWarnings::AnalysisBasedWarnings(Sema &s)
     MaxUninitAnalysisVariablesPerFunction(0),
     NumUninitAnalysisBlockVisits(0),
     MaxUninitAnalysisBlockVisitsPerFunction(0) {
-
-  using namespace diag;
-  DiagnosticsEngine &D = S.getDiagnostics();
-
-  DefaultPolicy.enableCheckUnreachable =
-    isEnabled(D, warn_unreachable) ||
-    isEnabled(D, warn_unreachable_break) ||
-    isEnabled(D, warn_unreachable_return) ||
-    isEnabled(D, warn_unreachable_loop_increment);
-
-  DefaultPolicy.enableThreadSafetyAnalysis =
-    isEnabled(D, warn_double_lock);
-
-  DefaultPolicy.enableConsumedAnalysis =
-    isEnabled(D, warn_use_in_invalid_state);
+  DefaultPolicy.enableCheckUnreachable = 1;
+  DefaultPolicy.enableThreadSafetyAnalysis = 1;
+  DefaultPolicy.enableConsumedAnalysis = 1;
+  disableIgnoredAnalyses(DefaultPolicy, S.getDiagnostics(), SourceLocation());
 }
 
 static void flushDiagnostics(Sema &S, const sema::FunctionScopeInfo *fscope) {
@@ -1923,6 +1932,11 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   const Stmt *Body = D->getBody();
   assert(Body);
 
+  // The policy reflects the command line; warnings can also be turned off
+  // for this function with pragmas. Don't run the analyses which can't warn
+  // here, so they don't force a fully linearized CFG, or any CFG at all.
+  disableIgnoredAnalyses(P, Diags, D->getLocStart());
+
   // Construct the analysis context with the specified CFG build options.
   AnalysisDeclContext AC(/* AnalysisDeclContextManager */ nullptr, D);
 
@@ -141,6 +141,19 @@ AttributeList::Kind AttributeList::getKind(const IdentifierInfo *Name,
   return ::getAttrKind(FullName, SyntaxUsed);
 }
 
+AttributeList::Kind
+AttributeFactory::getKind(const IdentifierInfo *Name,
+                          const IdentifierInfo *Scope,
+                          AttributeList::Syntax SyntaxUsed) {
+  auto Key = std::make_pair(std::make_pair(Name, Scope), unsigned(SyntaxUsed));
+  auto Known = Kinds.find(Key);
+  if (Known != Kinds.end())
+    return Known->second;
+  AttributeList::Kind K = AttributeList::getKind(Name, Scope, SyntaxUsed);
+  Kinds.insert(std::make_pair(Key, K));
+  return K;
+}
+
 unsigned AttributeList::getAttributeSpellingListIndex() const {
   // Both variables will be used in tablegen generated
   // attribute spell list index matching code.
@@ -15,6 +15,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Lex/Preprocessor.h"
@@ -661,3 +662,29 @@ bool clang::operator<(const CodeCompletionResult &X,
   
   return false;
 }
+
+bool CodeCompletionResult::matchesFilter(StringRef Filter) const {
+  if (Filter.empty())
+    return true;
+  std::string Saved;
+  return isCodeCompletionFilterMatch(Filter, getOrderedName(*this, Saved));
+}
+
+bool clang::isCodeCompletionFilterMatch(StringRef Filter, StringRef Name) {
+  if (Filter.empty())
+    return true;
+  if (Name.empty() || toLowercase(Filter[0]) != toLowercase(Name[0]))
+    return false;
+
+  // The remaining characters of the filter must appear in order.
+  size_t Pos = 1;
+  for (char C : Filter.drop_front()) {
+    C = toLowercase(C);
+    while (Pos != Name.size() && toLowercase(Name[Pos]) != C)
+      ++Pos;
+    if (Pos == Name.size())
+      return false;
+    ++Pos;
+  }
+  return true;
+}
@@ -49,6 +49,12 @@ Decl *MultiplexExternalSemaSource::GetExternalDecl(uint32_t ID) {
   return nullptr;
 }
 
+void MultiplexExternalSemaSource::PrefetchExternalDecls(
+    ArrayRef<uint32_t> IDs) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    Sources[i]->PrefetchExternalDecls(IDs);
+}
+
 void MultiplexExternalSemaSource::CompleteRedeclChain(const Decl *D) {
   for (size_t i = 0; i < Sources.size(); ++i)
     Sources[i]->CompleteRedeclChain(D);
@@ -170,6 +176,14 @@ bool MultiplexExternalSemaSource::layoutRecordType(const RecordDecl *Record,
   return false;
 }
 
+const ASTRecordLayout *
+MultiplexExternalSemaSource::loadRecordLayout(const RecordDecl *Record) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    if (const ASTRecordLayout *Layout = Sources[i]->loadRecordLayout(Record))
+      return Layout;
+  return nullptr;
+}
+
 void MultiplexExternalSemaSource::
 getMemoryBufferSizes(MemoryBufferSizes &sizes) const {
   for(size_t i = 0; i < Sources.size(); ++i)
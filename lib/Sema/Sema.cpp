@@ -20,6 +20,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtCXX.h"
+#include "clang/Analysis/Analyses/FormatString.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
@@ -39,6 +40,7 @@
 #include "clang/Sema/TemplateDeduction.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/Support/Format.h"
 using namespace clang;
 using namespace sema;
 
@@ -103,7 +105,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
     CurrentInstantiationScope(nullptr), DisableTypoCorrection(false),
-    TyposCorrected(0), AnalysisWarnings(*this), ThreadSafetyDeclCache(nullptr),
+    TyposCorrected(0), NumTypoCorrectionCandidates(0), TypoCorrectionTime(0),
+    AnalysisWarnings(*this), ThreadSafetyDeclCache(nullptr),
     VarDataSharingAttributesStack(nullptr), CurScope(nullptr),
     Ident_super(nullptr), Ident___float128(nullptr)
 {
@@ -371,6 +374,24 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumPendingFunctionInstantiations
+               << " pending function instantiations performed.\n";
+  llvm::errs() << NumPendingVariableInstantiations
+               << " pending variable instantiations performed.\n";
+  llvm::errs() << MaxPendingInstantiations
+               << " instantiations pending at most.\n";
+  llvm::errs() << NumOverloadCandidates << " overload candidates considered, "
+               << NumOverloadCandidatesBadArity
+               << " rejected for their arity and "
+               << NumOverloadCandidatesBadDeduction
+               << " for failed deduction.\n";
+  llvm::errs() << NumDeclAttributesProcessed
+               << " declaration attributes processed.\n";
+  llvm::errs() << TyposCorrected << " typo corrections attempted, "
+               << NumTypoCorrectionCandidates << " candidate names considered, "
+               << llvm::format("%.4f", TypoCorrectionTime) << " seconds.\n";
+  llvm::errs() << Diags.getNumIgnored()
+               << " diagnostics built and then ignored.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -6342,17 +6342,32 @@ static void CheckFormatString(Sema &S, const FormatStringLiteral *FExpr,
   if (Type == Sema::FST_Printf || Type == Sema::FST_NSString ||
       Type == Sema::FST_FreeBSDKPrintf || Type == Sema::FST_OSLog ||
       Type == Sema::FST_OSTrace) {
+    // The same format strings tend to be used over and over again, so only
+    // parse each of them once, as long as that doesn't report any problems
+    // with the string itself.
+    if (!S.PrintfStrings)
+      S.PrintfStrings.reset(new analyze_format_string::PrintfStringCache());
+    const analyze_format_string::ParsedPrintfString &Parsed =
+        S.PrintfStrings->get(StringRef(Str, StrLen), S.getLangOpts(),
+                             S.Context.getTargetInfo(),
+                             Type == Sema::FST_FreeBSDKPrintf);
+
     CheckPrintfHandler H(
         S, FExpr, OrigFormatExpr, Type, firstDataArg, numDataArgs,
-        (Type == Sema::FST_NSString || Type == Sema::FST_OSTrace), Str,
+        (Type == Sema::FST_NSString || Type == Sema::FST_OSTrace),
+        Parsed.isReplayable() ? Parsed.getBegin() : Str,
         HasVAListArg, Args, format_idx, inFunctionCall, CallType,
         CheckedVarArgs, UncoveredArg);
 
-    if (!analyze_format_string::ParsePrintfString(H, Str, Str + StrLen,
-                                                  S.getLangOpts(),
-                                                  S.Context.getTargetInfo(),
-                                            Type == Sema::FST_FreeBSDKPrintf))
+    if (Parsed.isReplayable()) {
+      if (!Parsed.replay(H))
+        H.DoneProcessing();
+    } else if (!analyze_format_string::ParsePrintfString(
+                   H, Str, Str + StrLen, S.getLangOpts(),
+                   S.Context.getTargetInfo(),
+                   Type == Sema::FST_FreeBSDKPrintf)) {
       H.DoneProcessing();
+    }
   } else if (Type == Sema::FST_Scanf) {
     CheckScanfHandler H(S, FExpr, OrigFormatExpr, Type, firstDataArg,
                         numDataArgs, Str, HasVAListArg, Args, format_idx,
@@ -8669,6 +8684,10 @@ void AnalyzeAssignment(Sema &S, BinaryOperator *E) {
 void DiagnoseImpCast(Sema &S, Expr *E, QualType SourceType, QualType T, 
                      SourceLocation CContext, unsigned diag,
                      bool pruneControlFlow = false) {
+  // Most conversion warnings are off by default; don't build them for nothing.
+  if (S.Diags.isIgnored(diag, E->getExprLoc()))
+    return;
+
   if (pruneControlFlow) {
     S.DiagRuntimeBehavior(E->getExprLoc(), E,
                           S.PDiag(diag)
@@ -8751,6 +8770,9 @@ void DiagnoseFloatingImpCast(Sema &S, Expr *E, QualType T,
     DiagID = diag::warn_impcast_float_to_integer;
   }
 
+  if (S.Diags.isIgnored(DiagID, E->getExprLoc()))
+    return;
+
   // FIXME: Force the precision of the source value down so we don't print
   // digits which are usually useless (we don't really care here if we
   // truncate a digit by accident in edge cases).  Ideally, APFloat::toString
@@ -206,6 +206,13 @@ namespace {
       return SemaRef.CodeCompleter && 
              SemaRef.CodeCompleter->includeCodePatterns();
     }
+
+    /// \brief Whether the result doesn't match the name typed so far, and
+    /// should be dropped before anything is allocated for it.
+    bool isFilteredOut(const Result &R) const {
+      return SemaRef.CodeCompleter &&
+             !R.matchesFilter(SemaRef.CodeCompleter->getFilter());
+    }
     
     /// \brief Set the filter used for code-completion results.
     void setFilter(LookupFilter Filter) {
@@ -831,7 +838,8 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
   
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
-    Results.push_back(R);
+    if (!isFilteredOut(R))
+      Results.push_back(R);
     return;
   }
 
@@ -849,7 +857,8 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
   unsigned IDNS = CanonDecl->getIdentifierNamespace();
 
   bool AsNestedNameSpecifier = false;
-  if (!isInterestingDecl(R.Declaration, AsNestedNameSpecifier))
+  if (!isInterestingDecl(R.Declaration, AsNestedNameSpecifier) ||
+      isFilteredOut(R))
     return;
       
   // C++ constructors are never found by name lookup.
@@ -948,7 +957,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
                               NamedDecl *Hiding, bool InBaseClass = false) {
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
-    Results.push_back(R);
+    if (!isFilteredOut(R))
+      Results.push_back(R);
     return;
   }
 
@@ -962,7 +972,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
   }
   
   bool AsNestedNameSpecifier = false;
-  if (!isInterestingDecl(R.Declaration, AsNestedNameSpecifier))
+  if (!isInterestingDecl(R.Declaration, AsNestedNameSpecifier) ||
+      isFilteredOut(R))
     return;
   
   // C++ constructors are never found by name lookup.
@@ -1031,7 +1042,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
 void ResultBuilder::AddResult(Result R) {
   assert(R.Kind != Result::RK_Declaration && 
           "Declaration results need more context");
-  Results.push_back(R);
+  if (!isFilteredOut(R))
+    Results.push_back(R);
 }
 
 /// \brief Enter into a new scope.
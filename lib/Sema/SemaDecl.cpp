@@ -11170,9 +11170,9 @@ void Sema::ActOnDocumentableDecls(ArrayRef<Decl *> Group) {
   }
 
   // See if there are any new comments that are not attached to a decl.
-  ArrayRef<RawComment *> Comments = Context.getRawCommentList().getComments();
-  if (!Comments.empty() &&
-      !Comments.back()->isAttached()) {
+  const RawComment *LastComment =
+      Context.getRawCommentList().getLastComment();
+  if (LastComment && !LastComment->isAttached()) {
     // There is at least one comment that not attached to a decl.
     // Maybe it should be attached to one of these decls?
     //
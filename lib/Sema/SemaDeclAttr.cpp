@@ -5556,6 +5556,7 @@ static void handleOpenCLAccessAttr(Sema &S, Decl *D,
 static void ProcessDeclAttribute(Sema &S, Scope *scope, Decl *D,
                                  const AttributeList &Attr,
                                  bool IncludeCXX11Attributes) {
+  ++S.NumDeclAttributesProcessed;
   if (Attr.isInvalid() || Attr.getKind() == AttributeList::IgnoredAttribute)
     return;
 
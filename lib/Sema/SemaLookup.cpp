@@ -40,6 +40,7 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Timer.h"
 #include <algorithm>
 #include <iterator>
 #include <list>
@@ -3901,6 +3902,22 @@ void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
   // Compute an upper bound on the allowable edit distance, so that the
   // edit-distance algorithm can short-circuit.
   unsigned UpperBound = (TypoStr.size() + 2) / 3 + 1;
+  ++SemaRef.NumTypoCorrectionCandidates;
+
+  // Each edit changes the count of at most one character in each direction,
+  // so the number of characters of the name that the typo lacks, and vice
+  // versa, bound the edit distance from below. This rejects most of the
+  // names in a large identifier table far more cheaply than edit_distance.
+  unsigned Missing = 0;
+  for (unsigned char C : Name)
+    if (TypoCharCounts[C]-- <= 0)
+      ++Missing;
+  for (unsigned char C : Name)
+    ++TypoCharCounts[C];
+  unsigned Extra = Missing + TypoStr.size() - Name.size();
+  if (std::max(Missing, Extra) >= UpperBound)
+    return;
+
   unsigned ED = TypoStr.edit_distance(Name, true, UpperBound);
   if (ED >= UpperBound) return;
 
@@ -4572,6 +4589,10 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
     for (const auto &I : Context.Idents)
       Consumer->FoundName(I.getKey());
 
+    // Builtins only get an identifier once they are referred to.
+    for (const auto &Entry : Context.BuiltinInfo.getSupportedBuiltins())
+      Consumer->FoundName(Entry.first);
+
     // Walk through identifiers in external identifier sources.
     // FIXME: Re-add the ability to skip very unlikely potential corrections.
     if (IdentifierInfoLookup *External
@@ -4607,6 +4628,23 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
   return Consumer;
 }
 
+namespace {
+/// Adds the wall time spent in its scope to Sema::TypoCorrectionTime.
+class TypoCorrectionTimeRAII {
+  Sema &SemaRef;
+  double Start;
+
+public:
+  TypoCorrectionTimeRAII(Sema &SemaRef)
+      : SemaRef(SemaRef),
+        Start(llvm::TimeRecord::getCurrentTime().getWallTime()) {}
+  ~TypoCorrectionTimeRAII() {
+    SemaRef.TypoCorrectionTime +=
+        llvm::TimeRecord::getCurrentTime().getWallTime() - Start;
+  }
+};
+} // end anonymous namespace
+
 /// \brief Try to "correct" a typo in the source code by finding
 /// visible declarations whose names are similar to the name that was
 /// present in the source code.
@@ -4648,6 +4686,7 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
                                  const ObjCObjectPointerType *OPT,
                                  bool RecordFailure) {
   assert(CCC && "CorrectTypo requires a CorrectionCandidateCallback");
+  TypoCorrectionTimeRAII Timer(*this);
 
   // Always let the ExternalSource have the first chance at correction, even
   // if we would otherwise have given up.
@@ -4782,6 +4821,7 @@ TypoExpr *Sema::CorrectTypoDelayed(
     DeclContext *MemberContext, bool EnteringContext,
     const ObjCObjectPointerType *OPT) {
   assert(CCC && "CorrectTypoDelayed requires a CorrectionCandidateCallback");
+  TypoCorrectionTimeRAII Timer(*this);
 
   auto Consumer = makeTypoCorrectionConsumer(
       TypoName, LookupKind, S, SS, std::move(CCC), MemberContext,
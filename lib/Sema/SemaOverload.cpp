@@ -605,8 +605,7 @@ clang::MakeDeductionFailureInfo(ASTContext &Context,
     break;
 
   case Sema::TDK_DeducedMismatch: {
-    // FIXME: Should allocate from normal heap so that we can free this later.
-    auto *Saved = new (Context) DFIDeducedMismatchArgs;
+    auto *Saved = new DFIDeducedMismatchArgs;
     Saved->FirstArg = Info.FirstArg;
     Saved->SecondArg = Info.SecondArg;
     Saved->TemplateArgs = Info.take();
@@ -616,8 +615,7 @@ clang::MakeDeductionFailureInfo(ASTContext &Context,
   }
 
   case Sema::TDK_NonDeducedMismatch: {
-    // FIXME: Should allocate from normal heap so that we can free this later.
-    DFIArguments *Saved = new (Context) DFIArguments;
+    DFIArguments *Saved = new DFIArguments;
     Saved->FirstArg = Info.FirstArg;
     Saved->SecondArg = Info.SecondArg;
     Result.Data = Saved;
@@ -626,8 +624,7 @@ clang::MakeDeductionFailureInfo(ASTContext &Context,
 
   case Sema::TDK_Inconsistent:
   case Sema::TDK_Underqualified: {
-    // FIXME: Should allocate from normal heap so that we can free this later.
-    DFIParamWithArguments *Saved = new (Context) DFIParamWithArguments;
+    DFIParamWithArguments *Saved = new DFIParamWithArguments;
     Saved->Param = Info.Param;
     Saved->FirstArg = Info.FirstArg;
     Saved->SecondArg = Info.SecondArg;
@@ -668,9 +665,17 @@ void DeductionFailureInfo::Destroy() {
 
   case Sema::TDK_Inconsistent:
   case Sema::TDK_Underqualified:
+    delete static_cast<DFIParamWithArguments*>(Data);
+    Data = nullptr;
+    break;
+
   case Sema::TDK_DeducedMismatch:
+    delete static_cast<DFIDeducedMismatchArgs*>(Data);
+    Data = nullptr;
+    break;
+
   case Sema::TDK_NonDeducedMismatch:
-    // FIXME: Destroy the data?
+    delete static_cast<DFIArguments*>(Data);
     Data = nullptr;
     break;
 
@@ -5890,6 +5895,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
 
   // Add this candidate
   OverloadCandidate &Candidate = CandidateSet.addCandidate(Args.size());
+  ++NumOverloadCandidates;
   Candidate.FoundDecl = FoundDecl;
   Candidate.Function = Function;
   Candidate.Viable = true;
@@ -5921,6 +5927,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       !Proto->isVariadic()) {
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_many_arguments;
+    ++NumOverloadCandidatesBadArity;
     return;
   }
 
@@ -5934,6 +5941,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
     // Not enough arguments.
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_few_arguments;
+    ++NumOverloadCandidatesBadArity;
     return;
   }
 
@@ -6284,6 +6292,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
 
   // Add this candidate
   OverloadCandidate &Candidate = CandidateSet.addCandidate(Args.size() + 1);
+  ++NumOverloadCandidates;
   Candidate.FoundDecl = FoundDecl;
   Candidate.Function = Method;
   Candidate.IsSurrogate = false;
@@ -6299,6 +6308,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       !Proto->isVariadic()) {
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_many_arguments;
+    ++NumOverloadCandidatesBadArity;
     return;
   }
 
@@ -6312,6 +6322,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
     // Not enough arguments.
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_few_arguments;
+    ++NumOverloadCandidatesBadArity;
     return;
   }
 
@@ -6410,6 +6421,8 @@ Sema::AddMethodTemplateCandidate(FunctionTemplateDecl *MethodTmpl,
       = DeduceTemplateArguments(MethodTmpl, ExplicitTemplateArgs, Args,
                                 Specialization, Info, PartialOverloading)) {
     OverloadCandidate &Candidate = CandidateSet.addCandidate();
+    ++NumOverloadCandidates;
+    ++NumOverloadCandidatesBadDeduction;
     Candidate.FoundDecl = FoundDecl;
     Candidate.Function = MethodTmpl->getTemplatedDecl();
     Candidate.Viable = false;
@@ -6461,6 +6474,8 @@ Sema::AddTemplateOverloadCandidate(FunctionTemplateDecl *FunctionTemplate,
         = DeduceTemplateArguments(FunctionTemplate, ExplicitTemplateArgs, Args,
                                   Specialization, Info, PartialOverloading)) {
     OverloadCandidate &Candidate = CandidateSet.addCandidate();
+    ++NumOverloadCandidates;
+    ++NumOverloadCandidatesBadDeduction;
     Candidate.FoundDecl = FoundDecl;
     Candidate.Function = FunctionTemplate->getTemplatedDecl();
     Candidate.Viable = false;
@@ -10272,6 +10287,12 @@ void OverloadCandidateSet::NoteCandidates(
     Sema &S, OverloadCandidateDisplayKind OCD, ArrayRef<Expr *> Args,
     StringRef Opc, SourceLocation OpLoc,
     llvm::function_ref<bool(OverloadCandidate &)> Filter) {
+  // The notes would be dropped along with an ignored diagnostic; don't
+  // complete and sort the candidates for them. Notes in a SFINAE context are
+  // kept with the deduction failure instead.
+  if (S.Diags.isLastDiagnosticIgnored() && !S.isSFINAEContext())
+    return;
+
   // Sort the candidates by viability and position.  Sorting directly would
   // be prohibitive, so we make a set of pointers and sort those.
   SmallVector<OverloadCandidate*, 32> Cands;
@@ -10402,6 +10423,9 @@ void TemplateSpecCandidateSet::clear() {
 /// This is analoguous to OverloadCandidateSet::NoteCandidates() with
 /// OCD == OCD_AllCandidates and Cand->Viable == false.
 void TemplateSpecCandidateSet::NoteCandidates(Sema &S, SourceLocation Loc) {
+  if (S.Diags.isLastDiagnosticIgnored() && !S.isSFINAEContext())
+    return;
+
   // Sort the candidates by position (assuming no candidate is a match).
   // Sorting directly would be prohibitive, so we make a set of pointers
   // and sort those.
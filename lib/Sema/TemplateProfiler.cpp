@@ -0,0 +1,126 @@
+//===--- TemplateProfiler.cpp - Cost of Template Instantiations -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the TemplateProfiler class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/TemplateProfiler.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+
+/// The number of points of instantiation printed for each template.
+static const unsigned MaxPrintedSites = 3;
+
+void TemplateProfiler::begin(const NamedDecl *Pattern,
+                             SourceLocation PointOfInstantiation) {
+  TemplateCost &Cost = Costs[Pattern];
+  ++Cost.Count;
+  if (PointOfInstantiation.isValid())
+    ++Cost.Sites[Context.getSourceManager()
+                     .getExpansionLoc(PointOfInstantiation)
+                     .getRawEncoding()];
+
+  ActiveInstantiation A;
+  A.Pattern = Pattern;
+  A.Start = ClockType::now();
+  A.StartBytes = Context.getAllocator().getBytesAllocated();
+  A.NestedTime = DurationType::zero();
+  A.NestedBytes = 0;
+  Active.push_back(A);
+}
+
+void TemplateProfiler::end() {
+  assert(!Active.empty() && "Ending an instantiation which never started!");
+  ActiveInstantiation A = Active.pop_back_val();
+  DurationType Time =
+      std::chrono::duration_cast<DurationType>(ClockType::now() - A.Start);
+  size_t Bytes = Context.getAllocator().getBytesAllocated() - A.StartBytes;
+
+  TemplateCost &Cost = Costs[A.Pattern];
+  Cost.SelfTime += Time - A.NestedTime;
+  Cost.SelfBytes += Bytes - A.NestedBytes;
+  // Recursive instantiations of a template are already part of the time of
+  // the outermost one.
+  if (std::none_of(Active.begin(), Active.end(),
+                   [&](const ActiveInstantiation &Outer) {
+                     return Outer.Pattern == A.Pattern;
+                   }))
+    Cost.Time += Time;
+
+  if (!Active.empty()) {
+    Active.back().NestedTime += Time;
+    Active.back().NestedBytes += Bytes;
+  }
+}
+
+void TemplateProfiler::print(raw_ostream &OS, const SourceManager &SM) const {
+  std::vector<std::pair<const NamedDecl *, const TemplateCost *>> Sorted;
+  for (const auto &Entry : Costs)
+    Sorted.push_back(std::make_pair(Entry.first, &Entry.second));
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const std::pair<const NamedDecl *, const TemplateCost *> &A,
+               const std::pair<const NamedDecl *, const TemplateCost *> &B) {
+              if (A.second->Time != B.second->Time)
+                return A.second->Time > B.second->Time;
+              return A.second->Count > B.second->Count;
+            });
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << std::string(24, ' ') << "Template instantiation profile\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "   Time (ms)   Self (ms)    Count  Self AST (KB)  Template\n";
+  for (const auto &Entry : Sorted) {
+    const TemplateCost &Cost = *Entry.second;
+    OS << llvm::format("%12.3f%12.3f%9u%15.1f  ", Cost.Time.count() / 1000.0,
+                       Cost.SelfTime.count() / 1000.0, Cost.Count,
+                       Cost.SelfBytes / 1024.0);
+    Entry.first->getNameForDiagnostic(OS, Context.getPrintingPolicy(),
+                                      /*Qualified=*/true);
+    OS << "\n";
+
+    // Points of instantiation on the same line are counted together.
+    llvm::StringMap<unsigned> Sites;
+    for (const auto &Site : Cost.Sites) {
+      PresumedLoc PLoc = SM.getPresumedLoc(
+          SourceLocation::getFromRawEncoding(Site.first));
+      if (PLoc.isInvalid())
+        continue;
+      Sites[(Twine(PLoc.getFilename()) + ":" + Twine(PLoc.getLine())).str()] +=
+          Site.second;
+    }
+    std::vector<std::pair<StringRef, unsigned>> SortedSites;
+    for (const auto &Site : Sites)
+      SortedSites.push_back(std::make_pair(Site.first(), Site.second));
+    std::sort(SortedSites.begin(), SortedSites.end(),
+              [](const std::pair<StringRef, unsigned> &A,
+                 const std::pair<StringRef, unsigned> &B) {
+                if (A.second != B.second)
+                  return A.second > B.second;
+                return A.first < B.first;
+              });
+    if (SortedSites.size() > MaxPrintedSites)
+      SortedSites.resize(MaxPrintedSites);
+    if (SortedSites.empty())
+      continue;
+    OS << std::string(50, ' ') << "from ";
+    for (unsigned I = 0, E = SortedSites.size(); I != E; ++I)
+      OS << (I ? ", " : "") << SortedSites[I].first << " ("
+         << SortedSites[I].second << ")";
+    OS << "\n";
+  }
+}
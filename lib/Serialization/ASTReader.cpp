@@ -27,6 +27,7 @@
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
 #include "clang/AST/UnresolvedSet.h"
@@ -44,6 +45,7 @@
 #include "clang/Basic/Specifiers.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Basic/Version.h"
 #include "clang/Basic/VersionTuple.h"
@@ -67,6 +69,7 @@
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/BitstreamReader.h"
@@ -845,6 +848,7 @@ IdentifierInfo *ASTIdentifierLookupTrait::ReadData(const internal_key_type& k,
                                                    const unsigned char* d,
                                                    unsigned DataLen) {
   using namespace llvm::support;
+  Reader.noteRecordRead(F, (d - F.Data.bytes_begin()) * 8);
   unsigned RawID = endian::readNext<uint32_t, little, unaligned>(d);
   bool IsInteresting = RawID & 0x01;
 
@@ -1284,6 +1288,9 @@ bool ASTReader::ReadSLocEntry(int ID) {
         Error("could not decompress embedded file contents");
         return nullptr;
       }
+      ++NumBuffersDecompressed;
+      NumCompressedBufferBytes += Blob.size();
+      NumDecompressedBufferBytes += Uncompressed.size();
       return llvm::MemoryBuffer::getMemBufferCopy(Uncompressed, Name);
     } else if (RecCode == SM_SLOC_BUFFER_BLOB) {
       return llvm::MemoryBuffer::getMemBuffer(Blob.drop_back(1), Name, true);
@@ -1294,6 +1301,7 @@ bool ASTReader::ReadSLocEntry(int ID) {
   };
 
   ModuleFile *F = GlobalSLocEntryMap.find(-ID)->second;
+  noteRecordRead(*F, F->SLocEntryOffsets[ID - F->SLocEntryBaseID]);
   F->SLocEntryCursor.JumpToBit(F->SLocEntryOffsets[ID - F->SLocEntryBaseID]);
   BitstreamCursor &SLocEntryCursor = F->SLocEntryCursor;
   unsigned BaseOffset = F->SLocEntryBaseOffset;
@@ -1471,6 +1479,7 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
   // after reading this macro.
   SavedStreamPosition SavedPosition(Stream);
 
+  noteRecordRead(F, Offset);
   Stream.JumpToBit(Offset);
   RecordData Record;
   SmallVector<IdentifierInfo*, 16> MacroArgs;
@@ -1852,6 +1861,7 @@ void ASTReader::resolvePendingMacro(IdentifierInfo *II,
 
   BitstreamCursor &Cursor = M.MacroCursor;
   SavedStreamPosition SavedPosition(Cursor);
+  noteRecordRead(M, PMInfo.MacroDirectivesOffset);
   Cursor.JumpToBit(PMInfo.MacroDirectivesOffset);
 
   struct ModuleMacroRecord {
@@ -2070,7 +2080,7 @@ InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
   if (!Overridden && //
       (StoredSize != File->getSize() ||
        (StoredTime && StoredTime != File->getModificationTime() &&
-        !DisableValidation)
+        !DisableValidation && !F.InputFilesTrusted)
        )) {
     if (Complain) {
       // Build a list of the PCH imports that got us here (in reverse).
@@ -2258,9 +2268,10 @@ ASTReader::ReadControlBlock(ModuleFile &F,
 
       // All user input files reside at the index range [0, NumUserInputs), and
       // system input files reside at [NumUserInputs, NumInputs). For explicitly
-      // loaded module files, ignore missing inputs.
-      if (!DisableValidation && F.Kind != MK_ExplicitModule &&
-          F.Kind != MK_PrebuiltModule) {
+      // loaded module files, ignore missing inputs. The inputs of module files
+      // in the trusted manifest are known to be up to date.
+      if (!DisableValidation && !F.InputFilesTrusted &&
+          F.Kind != MK_ExplicitModule && F.Kind != MK_PrebuiltModule) {
         bool Complain = (ClientLoadCapabilities & ARR_OutOfDate) == 0;
 
         // If we are reading a module, we will create a verification timestamp,
@@ -2409,6 +2420,13 @@ ASTReader::ReadControlBlock(ModuleFile &F,
       break;
 
     case IMPORTS: {
+      // Start reading all of the imported files before loading any of them,
+      // so that their I/O overlaps with loading the first.
+      for (unsigned Idx = 0, N = Record.size(); Idx < N;) {
+        Idx += 5; // Kind, ImportLoc, Size, ModTime, Signature
+        ModuleMgr.prefetchModuleFile(ReadPath(F, Record, Idx));
+      }
+
       // Load each of the imported PCH files.
       unsigned Idx = 0, N = Record.size();
       while (Idx < N) {
@@ -2883,7 +2901,7 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
     case SOURCE_LOCATION_OFFSETS: {
       F.SLocEntryOffsets = (const uint32_t *)Blob.data();
       F.LocalNumSLocEntries = Record[0];
-      unsigned SLocSpaceSize = Record[1];
+      unsigned SLocSpaceSize = F.SLocSpaceSize = Record[1];
       std::tie(F.SLocEntryBaseID, F.SLocEntryBaseOffset) =
           SourceMgr.AllocateLoadedSLocEntries(F.LocalNumSLocEntries,
                                               SLocSpaceSize);
@@ -2907,6 +2925,7 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
 
       // Initialize the remapping table.
       // Invalid stays invalid.
+      F.clearLastSLocRemap();
       F.SLocRemap.insertOrReplace(std::make_pair(0U, 0));
       // This module. Base was 2 when being compiled.
       F.SLocRemap.insertOrReplace(std::make_pair(2U,
@@ -2921,6 +2940,8 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       const unsigned char *Data = (const unsigned char*)Blob.data();
       const unsigned char *DataEnd = Data + Blob.size();
 
+      F.clearLastSLocRemap();
+
       // If we see this entry before SOURCE_LOCATION_OFFSETS, add placeholders.
       if (F.SLocRemap.find(0) == F.SLocRemap.end()) {
         F.SLocRemap.insert(std::make_pair(0U, 0));
@@ -3186,6 +3207,23 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       }
       break;
 
+    case RECORD_LAYOUTS:
+      for (unsigned I = 0, E = Record.size(); I != E;) {
+        if (E - I < 2 || Record[I + 1] > E - I - 2) {
+          Error("invalid RECORD_LAYOUTS block in AST file");
+          return Failure;
+        }
+        GlobalDeclID ID = getGlobalDeclID(F, Record[I]);
+        unsigned Length = Record[I + 1];
+        I += 2;
+        auto &Layout = RecordLayouts[ID];
+        Layout.first = &F;
+        Layout.second.assign(Record.begin() + I, Record.begin() + I + Length);
+        I += Length;
+        ++TotalNumRecordLayouts;
+      }
+      break;
+
     case OPENCL_EXTENSION_DECLS:
       for (unsigned I = 0, E = Record.size(); I != E;) {
         auto DeclID = static_cast<::DeclID>(Record[I++]);
@@ -3455,6 +3493,9 @@ static void moveMethodToBackOfGlobalList(Sema &S, ObjCMethodDecl *Method) {
 
 void ASTReader::makeNamesVisible(const HiddenNames &Names, Module *Owner) {
   assert(Owner->NameVisibility != Module::Hidden && "nothing to make visible?");
+  // Newly visible methods and categories change Objective-C method lookups.
+  if (!Names.empty())
+    getContext().invalidateObjCMethodLookups();
   for (Decl *D : Names) {
     bool wasHidden = D->Hidden;
     D->Hidden = false;
@@ -3610,6 +3651,7 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
                                             SourceLocation ImportLoc,
                                             unsigned ClientLoadCapabilities,
                                             SmallVectorImpl<ImportedSubmodule> *Imported) {
+  TimeTraceScope TimeScope("ReadAST", [&] { return FileName.str(); });
   llvm::SaveAndRestore<SourceLocation>
     SetCurImportLocRAII(CurrentImportLoc, ImportLoc);
 
@@ -3920,7 +3962,8 @@ ASTReader::ReadASTCore(StringRef FileName,
 
   ModuleFile &F = *M;
   BitstreamCursor &Stream = F.Stream;
-  Stream = BitstreamCursor(PCHContainerRdr.ExtractPCH(*F.Buffer));
+  // The module manager has already located the AST within its container.
+  Stream = BitstreamCursor(F.Data);
   F.SizeInBits = F.Buffer->getBufferSize() * 8;
 
   // Sniff for the signature.
@@ -5361,6 +5404,7 @@ QualType ASTReader::readTypeRecord(unsigned Index) {
   Deserializing AType(this);
 
   unsigned Idx = 0;
+  noteRecordRead(*Loc.F, Loc.Offset);
   DeclsCursor.JumpToBit(Loc.Offset);
   RecordData Record;
   unsigned Code = DeclsCursor.ReadCode();
@@ -6686,6 +6730,30 @@ Decl *ASTReader::GetDecl(DeclID ID) {
   return DeclsLoaded[Index];
 }
 
+void ASTReader::PrefetchExternalDecls(ArrayRef<uint32_t> IDs) {
+  // Reading the records in the order they were written keeps the reads
+  // moving forward through each AST file instead of seeking back and forth.
+  SmallVector<std::pair<uint64_t, DeclID>, 16> Unloaded;
+  for (DeclID ID : IDs) {
+    if (ID < NUM_PREDEF_DECL_IDS || GetExistingDecl(ID))
+      continue;
+    GlobalDeclMapType::iterator I = GlobalDeclMap.find(ID);
+    assert(I != GlobalDeclMap.end() && "Corrupted global declaration map");
+    ModuleFile *M = I->second;
+    const DeclOffset &DOffs =
+        M->DeclOffsets[ID - M->BaseDeclID - NUM_PREDEF_DECL_IDS];
+    Unloaded.push_back(
+        std::make_pair(getGlobalBitOffset(*M, DOffs.BitOffset), ID));
+  }
+  if (Unloaded.empty())
+    return;
+
+  std::sort(Unloaded.begin(), Unloaded.end());
+  Deserializing Prefetch(this);
+  for (const auto &Entry : Unloaded)
+    (void)GetDecl(Entry.second);
+}
+
 DeclID ASTReader::mapGlobalIDToModuleFileGlobalID(ModuleFile &M,
                                                   DeclID GlobalID) {
   if (GlobalID < NUM_PREDEF_DECL_IDS)
@@ -6848,6 +6916,117 @@ void ASTReader::FindFileRegionDecls(FileID File,
     Decls.push_back(GetDecl(getGlobalDeclID(*DInfo.Mod, *DIt)));
 }
 
+const ASTRecordLayout *ASTReader::loadRecordLayout(const RecordDecl *Record) {
+  if (!Record->isFromASTFile())
+    return nullptr;
+  auto It = RecordLayouts.find(Record->getGlobalID());
+  if (It == RecordLayouts.end())
+    return nullptr;
+
+  // The values are in the order in which ASTWriter::WriteRecordLayouts
+  // writes them. Reading past their end yields zeros and makes the layout
+  // invalid.
+  ModuleFile &F = *It->second.first;
+  ArrayRef<uint64_t> Values = It->second.second;
+  unsigned Idx = 0;
+  bool Invalid = false;
+  auto ReadValue = [&]() -> uint64_t {
+    if (Idx == Values.size()) {
+      Invalid = true;
+      return 0;
+    }
+    return Values[Idx++];
+  };
+  auto ReadCharUnits = [&]() {
+    return CharUnits::fromQuantity(static_cast<int64_t>(ReadValue()));
+  };
+  auto ReadBase = [&]() -> const CXXRecordDecl * {
+    uint64_t ID = ReadValue();
+    if (!ID)
+      return nullptr;
+    const auto *Base =
+        dyn_cast_or_null<CXXRecordDecl>(GetDecl(getGlobalDeclID(F, ID)));
+    if (!Base || !Base->getDefinition()) {
+      Invalid = true;
+      return nullptr;
+    }
+    return Base->getDefinition();
+  };
+
+  CharUnits Size = ReadCharUnits();
+  CharUnits Alignment = ReadCharUnits();
+  CharUnits RequiredAlignment = ReadCharUnits();
+  CharUnits DataSize = ReadCharUnits();
+
+  // The layout only applies if the record still has the fields and bases it
+  // was computed for; otherwise, let the record be laid out from scratch.
+  uint64_t NumFields = ReadValue();
+  if (NumFields != (uint64_t)std::distance(Record->field_begin(),
+                                           Record->field_end()))
+    return nullptr;
+  SmallVector<uint64_t, 16> FieldOffsets;
+  for (uint64_t I = 0; I != NumFields && !Invalid; ++I)
+    FieldOffsets.push_back(ReadValue());
+
+  const auto *CXXRD = dyn_cast<CXXRecordDecl>(Record);
+  if (ReadValue() != (CXXRD != nullptr) || Invalid)
+    return nullptr;
+  if (!CXXRD) {
+    if (Idx != Values.size())
+      return nullptr;
+    ++NumRecordLayoutsRead;
+    return new (getContext()) ASTRecordLayout(
+        getContext(), Size, Alignment, RequiredAlignment, DataSize,
+        FieldOffsets);
+  }
+
+  bool HasOwnVFPtr = ReadValue();
+  bool HasExtendableVFPtr = ReadValue();
+  CharUnits VBPtrOffset = ReadCharUnits();
+  CharUnits NonVirtualSize = ReadCharUnits();
+  CharUnits NonVirtualAlignment = ReadCharUnits();
+  CharUnits SizeOfLargestEmptySubobject = ReadCharUnits();
+  const CXXRecordDecl *PrimaryBase = ReadBase();
+  bool IsPrimaryBaseVirtual = ReadValue();
+  const CXXRecordDecl *BaseSharingVBPtr = ReadBase();
+  bool EndsWithZeroSizedObject = ReadValue();
+  bool LeadsWithZeroSizedBase = ReadValue();
+
+  unsigned NumBases = 0;
+  for (const CXXBaseSpecifier &Base : CXXRD->bases())
+    if (!Base.isVirtual())
+      ++NumBases;
+  if (ReadValue() != NumBases)
+    return nullptr;
+  ASTRecordLayout::BaseOffsetsMapTy BaseOffsets;
+  for (unsigned I = 0; I != NumBases; ++I) {
+    const CXXRecordDecl *Base = ReadBase();
+    if (!Base)
+      return nullptr;
+    BaseOffsets[Base] = ReadCharUnits();
+  }
+  if (ReadValue() != CXXRD->getNumVBases())
+    return nullptr;
+  ASTRecordLayout::VBaseOffsetsMapTy VBaseOffsets;
+  for (unsigned I = 0, N = CXXRD->getNumVBases(); I != N; ++I) {
+    const CXXRecordDecl *Base = ReadBase();
+    if (!Base)
+      return nullptr;
+    CharUnits Offset = ReadCharUnits();
+    VBaseOffsets[Base] = ASTRecordLayout::VBaseInfo(Offset, ReadValue());
+  }
+  if (Invalid || Idx != Values.size())
+    return nullptr;
+
+  ++NumRecordLayoutsRead;
+  return new (getContext()) ASTRecordLayout(
+      getContext(), Size, Alignment, RequiredAlignment, HasOwnVFPtr,
+      HasExtendableVFPtr, VBPtrOffset, DataSize, FieldOffsets, NonVirtualSize,
+      NonVirtualAlignment, SizeOfLargestEmptySubobject, PrimaryBase,
+      IsPrimaryBaseVirtual, BaseSharingVBPtr, EndsWithZeroSizedObject,
+      LeadsWithZeroSizedBase, BaseOffsets, VBaseOffsets);
+}
+
 bool
 ASTReader::FindExternalVisibleDeclsByName(const DeclContext *DC,
                                           DeclarationName Name) {
@@ -6864,7 +7043,9 @@ ASTReader::FindExternalVisibleDeclsByName(const DeclContext *DC,
 
   // Load the list of declarations.
   SmallVector<NamedDecl *, 64> Decls;
-  for (DeclID ID : It->second.Table.find(Name)) {
+  auto IDs = It->second.Table.find(Name);
+  PrefetchExternalDecls(IDs);
+  for (DeclID ID : IDs) {
     NamedDecl *ND = cast<NamedDecl>(GetDecl(ID));
     if (ND->getDeclName() == Name)
       Decls.push_back(ND);
@@ -6885,7 +7066,9 @@ void ASTReader::completeVisibleDeclsMap(const DeclContext *DC) {
 
   DeclsMap Decls;
 
-  for (DeclID ID : It->second.Table.findAll()) {
+  auto IDs = It->second.Table.findAll();
+  PrefetchExternalDecls(IDs);
+  for (DeclID ID : IDs) {
     NamedDecl *ND = cast<NamedDecl>(GetDecl(ID));
     Decls[ND->getDeclName()].push_back(ND);
   }
@@ -6960,6 +7143,14 @@ void ASTReader::StartTranslationUnit(ASTConsumer *Consumer) {
     DeserializationListener->ReaderInitialized(this);
 }
 
+void ASTReader::notePageRead(ModuleFile &F, uint64_t BitOffset) {
+  // Pages are assumed to be 4K; this is only used for statistics.
+  unsigned Page = BitOffset / (4096 * 8);
+  if (Page >= F.PagesRead.size())
+    F.PagesRead.resize(Page + 1);
+  F.PagesRead.set(Page);
+}
+
 void ASTReader::PrintStats() {
   std::fprintf(stderr, "*** AST File Statistics:\n");
 
@@ -6986,6 +7177,12 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u source location entries read (%f%%)\n",
                  NumSLocEntriesRead, TotalNumSLocEntries,
                  ((float)NumSLocEntriesRead/TotalNumSLocEntries * 100));
+  if (NumBuffersDecompressed)
+    std::fprintf(stderr, "  %u embedded file buffers decompressed "
+                 "(%llu bytes to %llu bytes)\n",
+                 NumBuffersDecompressed,
+                 (unsigned long long)NumCompressedBufferBytes,
+                 (unsigned long long)NumDecompressedBufferBytes);
   if (!TypesLoaded.empty())
     std::fprintf(stderr, "  %u/%u types read (%f%%)\n",
                  NumTypesLoaded, (unsigned)TypesLoaded.size(),
@@ -7014,6 +7211,10 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u macros read (%f%%)\n",
                  NumMacrosRead, TotalNumMacros,
                  ((float)NumMacrosRead/TotalNumMacros * 100));
+  if (TotalNumRecordLayouts)
+    std::fprintf(stderr, "  %u/%u record layouts read (%f%%)\n",
+                 NumRecordLayoutsRead, TotalNumRecordLayouts,
+                 ((float)NumRecordLayoutsRead/TotalNumRecordLayouts * 100));
   if (TotalLexicalDeclContexts)
     std::fprintf(stderr, "  %u/%u lexical declcontexts read (%f%%)\n",
                  NumLexicalDeclContextsRead, TotalLexicalDeclContexts,
@@ -7042,6 +7243,33 @@ void ASTReader::PrintStats() {
                   * 100.0));
   }
 
+  unsigned NumPagesRead = 0, TotalNumPages = 0;
+  for (ModuleFile *F : ModuleMgr) {
+    NumPagesRead += F->PagesRead.count();
+    TotalNumPages += (F->Data.size() + 4095) / 4096;
+  }
+  if (CountPagesRead && TotalNumPages)
+    std::fprintf(stderr, "  %u/%u AST file pages read (%f%%)\n",
+                 NumPagesRead, TotalNumPages,
+                 ((float)NumPagesRead/TotalNumPages * 100));
+
+  // Report the share of the source location address space that each AST file
+  // takes up, largest first; imported modules are the usual reason for
+  // running out of it.
+  SmallVector<ModuleFile *, 16> SLocUsers;
+  for (ModuleFile *F : ModuleMgr)
+    if (F->SLocSpaceSize)
+      SLocUsers.push_back(F);
+  std::stable_sort(SLocUsers.begin(), SLocUsers.end(),
+                   [](const ModuleFile *LHS, const ModuleFile *RHS) {
+                     return LHS->SLocSpaceSize > RHS->SLocSpaceSize;
+                   });
+  if (!SLocUsers.empty())
+    std::fprintf(stderr, "  source location address space by AST file:\n");
+  for (ModuleFile *F : SLocUsers)
+    std::fprintf(stderr, "    %10uB in %6u entries: %s\n", F->SLocSpaceSize,
+                 F->LocalNumSLocEntries, F->FileName.c_str());
+
   if (NumIdentifierLookupHits) {
     std::fprintf(stderr,
                  "  %u / %u identifier table lookups succeeded (%f%%)\n",
@@ -7579,6 +7807,11 @@ void ASTReader::ReadUsedVTables(SmallVectorImpl<ExternalVTableUse> &VTables) {
 
 void ASTReader::ReadPendingInstantiations(
        SmallVectorImpl<std::pair<ValueDecl *, SourceLocation> > &Pending) {
+  SmallVector<DeclID, 64> IDs;
+  for (unsigned Idx = 0, N = PendingInstantiations.size(); Idx < N; Idx += 2)
+    IDs.push_back(PendingInstantiations[Idx]);
+  PrefetchExternalDecls(IDs);
+
   for (unsigned Idx = 0, N = PendingInstantiations.size(); Idx < N;) {
     ValueDecl *D = cast<ValueDecl>(GetDecl(PendingInstantiations[Idx++]));
     SourceLocation Loc
@@ -8917,9 +9150,13 @@ ASTReader::ASTReader(
       ValidateSystemInputs(ValidateSystemInputs),
       UseGlobalIndex(UseGlobalIndex), TriedLoadingGlobalIndex(false),
       ProcessingUpdateRecords(false),
+      CountPagesRead(llvm::AreStatisticsEnabled()),
       CurrSwitchCaseStmts(&SwitchCaseStmts), NumSLocEntriesRead(0),
-      TotalNumSLocEntries(0), NumStatementsRead(0), TotalNumStatements(0),
-      NumMacrosRead(0), TotalNumMacros(0), NumIdentifierLookups(0),
+      TotalNumSLocEntries(0), NumBuffersDecompressed(0),
+      NumCompressedBufferBytes(0), NumDecompressedBufferBytes(0),
+      NumStatementsRead(0), TotalNumStatements(0),
+      NumMacrosRead(0), TotalNumMacros(0), NumRecordLayoutsRead(0),
+      TotalNumRecordLayouts(0), NumIdentifierLookups(0),
       NumIdentifierLookupHits(0), NumSelectorsRead(0),
       NumMethodPoolEntriesRead(0), NumMethodPoolLookups(0),
       NumMethodPoolHits(0), NumMethodPoolTableLookups(0),
@@ -8930,6 +9167,15 @@ ASTReader::ASTReader(
       PassingDeclsToConsumer(false), ReadingKind(Read_None) {
   SourceMgr.setExternalSLocEntrySource(this);
 
+  StringRef TrustedManifest =
+      PP.getHeaderSearchInfo().getHeaderSearchOpts().ModulesTrustedManifest;
+  if (!TrustedManifest.empty()) {
+    std::string ErrorStr;
+    if (!ModuleMgr.readTrustedManifest(TrustedManifest, ErrorStr))
+      Diags.Report(diag::err_module_trusted_manifest_unreadable)
+        << TrustedManifest << ErrorStr;
+  }
+
   for (const auto &Ext : Extensions) {
     auto BlockName = Ext->getExtensionMetadata().BlockName;
     auto Known = ModuleFileExtensions.find(BlockName);
@@ -1516,6 +1516,8 @@ void ASTDeclReader::ReadCXXDefinitionData(
   Data.ImplicitCopyAssignmentHasConstParam = Record.readInt();
   Data.HasDeclaredCopyConstructorWithConstParam = Record.readInt();
   Data.HasDeclaredCopyAssignmentWithConstParam = Record.readInt();
+  Data.ODRHash = Record.readInt();
+  Data.HasODRHash = true;
 
   Data.NumBases = Record.readInt();
   if (Data.NumBases)
@@ -1651,6 +1653,15 @@ void ASTDeclReader::MergeDefinitionData(
 
   if (DD.NumBases != MergeDD.NumBases || DD.NumVBases != MergeDD.NumVBases)
     DetectedOdrViolation = true;
+
+  // Definitions from AST files carry a hash of their members and bases, so
+  // a definition that differs in ways the flags above don't capture (such
+  // as the access or signature of a member) is caught. Only the existing
+  // definition may have to be walked, if it was parsed rather than read and
+  // its hash has not been computed yet.
+  if (!DD.IsLambda && !DD.Definition->isBeingDefined() &&
+      D->getODRHash() != MergeDD.ODRHash)
+    DetectedOdrViolation = true;
   // FIXME: Issue a diagnostic if the base classes don't match when we come
   // to lazily load them.
 
@@ -3259,6 +3270,7 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   // Note that we are loading a declaration record.
   Deserializing ADecl(this);
 
+  noteRecordRead(*Loc.F, Loc.Offset);
   DeclsCursor.JumpToBit(Loc.Offset);
   ASTRecordReader Record(*this, *Loc.F);
   ASTDeclReader Reader(*this, Record, Loc, ID, DeclLoc);
@@ -3749,6 +3761,8 @@ void ASTReader::loadObjCCategories(serialization::GlobalDeclID ID,
   ObjCCategoriesVisitor Visitor(*this, D, CategoriesDeserialized, ID,
                                 PreviousGeneration);
   ModuleMgr.visit(Visitor);
+  // Categories appended to the list change the methods of the class.
+  Context.invalidateObjCMethodLookups();
 }
 
 template<typename DeclT, typename Fn>
@@ -44,6 +44,10 @@ public:
   // Maximum number of lookup tables we allow before condensing the tables.
   static const int MaxTables = 4;
 
+  // Maximum number of lookups we allow into more than one lookup table
+  // before condensing the tables.
+  static const int MaxUncondensedLookups = 8;
+
   /// The lookup result is a list of global declaration IDs.
   typedef llvm::SmallVector<DeclID, 4> data_type;
   struct data_type_builder {
@@ -27,6 +27,7 @@
 #include "clang/AST/LambdaCapture.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
@@ -74,6 +75,7 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
@@ -1055,6 +1057,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(OPENCL_EXTENSIONS);
   RECORD(OPENCL_EXTENSION_TYPES);
   RECORD(OPENCL_EXTENSION_DECLS);
+  RECORD(RECORD_LAYOUTS);
   RECORD(DELEGATING_CTORS);
   RECORD(KNOWN_NAMESPACES);
   RECORD(MODULE_OFFSET_MAP);
@@ -1311,6 +1314,47 @@ static ASTFileSignature getSignature() {
   }
 }
 
+/// Compute the signature of a precompiled header from the compiler, target
+/// and language options it was built with and from every source buffer that
+/// went into it, so that rebuilding an unchanged PCH keeps its signature.
+static ASTFileSignature getPCHSignature(Preprocessor &PP,
+                                        ASTContext &Context) {
+  llvm::MD5 Hash;
+  Hash.update(getClangFullRepositoryVersion());
+  Hash.update(Context.getTargetInfo().getTriple().str());
+
+  const LangOptions &LangOpts = Context.getLangOpts();
+  SmallVector<uint64_t, 256> Options;
+#define LANGOPT(Name, Bits, Default, Description) \
+  Options.push_back(LangOpts.Name);
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+  Options.push_back(static_cast<unsigned>(LangOpts.get##Name()));
+#include "clang/Basic/LangOptions.def"
+  Hash.update(llvm::makeArrayRef(
+      reinterpret_cast<const uint8_t *>(Options.data()),
+      Options.size() * sizeof(uint64_t)));
+
+  SourceManager &SM = PP.getSourceManager();
+  for (unsigned I = 1, N = SM.local_sloc_entry_size(); I != N; ++I) {
+    const SrcMgr::SLocEntry &SLoc = SM.getLocalSLocEntry(I);
+    if (!SLoc.isFile())
+      continue;
+    const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+    bool Invalid = false;
+    llvm::MemoryBuffer *Buffer =
+        Content->getBuffer(PP.getDiagnostics(), SM, SourceLocation(), &Invalid);
+    if (!Invalid)
+      Hash.update(Buffer->getBuffer());
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  using namespace llvm::support;
+  ASTFileSignature Signature = endian::read<uint64_t, little, unaligned>(Result);
+  // Zero means the AST file has no signature.
+  return Signature ? Signature : 1;
+}
+
 /// \brief Write the control block.
 uint64_t ASTWriter::WriteControlBlock(Preprocessor &PP,
                                       ASTContext &Context,
@@ -1344,6 +1388,16 @@ uint64_t ASTWriter::WriteControlBlock(Preprocessor &PP,
     Stream.EmitRecordWithBlob(MetadataAbbrevCode, Record,
                               getClangFullRepositoryVersion());
   }
+  if (!WritingModule &&
+      PP.getHeaderSearchInfo().getHeaderSearchOpts().ModuleFormat == "obj") {
+    // Debug info for the types a PCH defines is emitted into its object file
+    // container, and is referred to by this signature from the object files
+    // built with the PCH. Other formats have no use for it, so don't spend a
+    // hash of every input buffer on them.
+    Signature = getPCHSignature(PP, Context);
+    RecordData::value_type Record[] = {Signature};
+    Stream.EmitRecord(SIGNATURE, Record);
+  }
   if (WritingModule) {
     // For implicit modules we output a signature that we can use to ensure
     // duplicate module builds don't collide in the cache as their output order
@@ -2946,7 +3000,7 @@ void ASTWriter::WriteFileDeclIDsMap() {
 
 void ASTWriter::WriteComments() {
   Stream.EnterSubblock(COMMENTS_BLOCK_ID, 3);
-  ArrayRef<RawComment *> RawComments = Context->Comments.getComments();
+  std::vector<RawComment *> RawComments = Context->Comments.getComments();
   RecordData Record;
   for (const auto *I : RawComments) {
     Record.clear();
@@ -3988,6 +4042,73 @@ void ASTWriter::WriteCUDAPragmas(Sema &SemaRef) {
   }
 }
 
+void ASTWriter::WriteRecordLayouts(ASTContext &Context) {
+  if (RecordsToLayOut.empty() || ASTHasCompilerErrors)
+    return;
+
+  // For each record, write the number of values in its layout, followed by
+  // all the fields of its ASTRecordLayout; see ASTReader::loadRecordLayout.
+  // Base classes are referred to by their declaration IDs.
+  RecordData Record;
+  for (const RecordDecl *RD : RecordsToLayOut) {
+    const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
+    Record.push_back(getDeclID(RD));
+    unsigned LengthIdx = Record.size();
+    Record.push_back(0);
+
+    Record.push_back(Layout.getSize().getQuantity());
+    Record.push_back(Layout.getAlignment().getQuantity());
+    Record.push_back(Layout.getRequiredAlignment().getQuantity());
+    Record.push_back(Layout.getDataSize().getQuantity());
+    Record.push_back(Layout.getFieldCount());
+    for (unsigned I = 0, N = Layout.getFieldCount(); I != N; ++I)
+      Record.push_back(Layout.getFieldOffset(I));
+
+    const auto *CXXRD = dyn_cast<CXXRecordDecl>(RD);
+    Record.push_back(CXXRD != nullptr);
+    if (CXXRD) {
+      Record.push_back(Layout.hasOwnVFPtr());
+      Record.push_back(Layout.hasExtendableVFPtr());
+      Record.push_back(Layout.getVBPtrOffset().getQuantity());
+      Record.push_back(Layout.getNonVirtualSize().getQuantity());
+      Record.push_back(Layout.getNonVirtualAlignment().getQuantity());
+      Record.push_back(Layout.getSizeOfLargestEmptySubobject().getQuantity());
+      const CXXRecordDecl *PrimaryBase = Layout.getPrimaryBase();
+      Record.push_back(PrimaryBase ? getDeclID(PrimaryBase) : 0);
+      Record.push_back(Layout.isPrimaryBaseVirtual());
+      const CXXRecordDecl *BaseSharingVBPtr = Layout.getBaseSharingVBPtr();
+      Record.push_back(BaseSharingVBPtr ? getDeclID(BaseSharingVBPtr) : 0);
+      Record.push_back(Layout.endsWithZeroSizedObject());
+      Record.push_back(Layout.leadsWithZeroSizedBase());
+
+      unsigned NumBasesIdx = Record.size();
+      Record.push_back(0);
+      for (const CXXBaseSpecifier &Base : CXXRD->bases()) {
+        if (Base.isVirtual())
+          continue;
+        const CXXRecordDecl *BaseDecl = Base.getType()->getAsCXXRecordDecl();
+        ++Record[NumBasesIdx];
+        Record.push_back(getDeclID(BaseDecl));
+        Record.push_back(Layout.getBaseClassOffset(BaseDecl).getQuantity());
+      }
+      // Walk the virtual bases in declaration order rather than that of the
+      // map, so that the output is deterministic.
+      const ASTRecordLayout::VBaseOffsetsMapTy &VBases =
+          Layout.getVBaseOffsetsMap();
+      Record.push_back(CXXRD->getNumVBases());
+      for (const CXXBaseSpecifier &Base : CXXRD->vbases()) {
+        const CXXRecordDecl *BaseDecl = Base.getType()->getAsCXXRecordDecl();
+        const ASTRecordLayout::VBaseInfo &Info = VBases.find(BaseDecl)->second;
+        Record.push_back(getDeclID(BaseDecl));
+        Record.push_back(Info.VBaseOffset.getQuantity());
+        Record.push_back(Info.hasVtorDisp());
+      }
+    }
+    Record[LengthIdx] = Record.size() - LengthIdx - 1;
+  }
+  Stream.EmitRecord(RECORD_LAYOUTS, Record);
+}
+
 void ASTWriter::WriteObjCCategories() {
   SmallVector<ObjCCategoriesInfo, 2> CategoriesMap;
   RecordData Categories;
@@ -4224,9 +4345,10 @@ void ASTWriter::SetSelectorOffset(Selector Sel, uint32_t Offset) {
 ASTWriter::ASTWriter(
   llvm::BitstreamWriter &Stream,
   ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-  bool IncludeTimestamps)
+  bool IncludeTimestamps, bool SerializeRecordLayouts)
     : Stream(Stream), Context(nullptr), PP(nullptr), Chain(nullptr),
       WritingModule(nullptr), IncludeTimestamps(IncludeTimestamps),
+      SerializeRecordLayouts(SerializeRecordLayouts),
       WritingAST(false), DoneWritingDeclsAndTypes(false),
       ASTHasCompilerErrors(false), FirstDeclID(NUM_PREDEF_DECL_IDS),
       NextDeclID(FirstDeclID), FirstTypeID(NUM_PREDEF_TYPE_IDS),
@@ -4655,6 +4777,7 @@ uint64_t ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   if (!DeclUpdatesOffsetsRecord.empty())
     Stream.EmitRecord(DECL_UPDATE_OFFSETS, DeclUpdatesOffsetsRecord);
   WriteFileDeclIDsMap();
+  WriteRecordLayouts(Context);
   WriteSourceManagerBlock(Context.getSourceManager(), PP);
   WriteComments();
   WritePreprocessor(PP, isModule);
@@ -5684,6 +5807,7 @@ void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   Record->push_back(Data.ImplicitCopyAssignmentHasConstParam);
   Record->push_back(Data.HasDeclaredCopyConstructorWithConstParam);
   Record->push_back(Data.HasDeclaredCopyAssignmentWithConstParam);
+  Record->push_back(D->getODRHash());
   // IsLambda bit is already saved.
 
   Record->push_back(Data.NumBases);
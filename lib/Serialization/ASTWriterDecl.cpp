@@ -2219,6 +2219,13 @@ void ASTWriter::WriteDecl(ASTContext &Context, Decl *D) {
   // them to a record in the AST file later.
   if (isRequiredDecl(D, Context, WritingModule))
     EagerlyDeserializedDecls.push_back(ID);
+
+  // Note record type definitions whose layouts we can write out later.
+  if (SerializeRecordLayouts)
+    if (auto *RD = dyn_cast<RecordDecl>(D))
+      if (RD->isCompleteDefinition() && !RD->isDependentType() &&
+          !RD->isInvalidDecl())
+        RecordsToLayOut.push_back(RD);
 }
 
 void ASTRecordWriter::AddFunctionDefinition(const FunctionDecl *FD) {
@@ -20,6 +20,7 @@
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamReader.h"
@@ -423,6 +424,22 @@ namespace {
     /// \returns true if an error occurred, false otherwise.
     bool loadModuleFile(const FileEntry *File);
 
+    /// \brief Add a module file as described by an up-to-date existing index,
+    /// without loading it. Its ID must be the next one to be assigned.
+    void addIndexedModuleFile(const FileEntry *File,
+                              ArrayRef<unsigned> Dependencies) {
+      ModuleFileInfo &Info = getModuleFileInfo(File);
+      assert(Info.ID == ModuleFiles.size() - 1 && "module file ID mismatch");
+      Info.Dependencies.append(Dependencies.begin(), Dependencies.end());
+    }
+
+    /// \brief Add the module files in which an identifier is interesting, as
+    /// described by an existing index.
+    void addIndexedIdentifier(StringRef Name, ArrayRef<unsigned> ModuleIDs) {
+      auto &IDs = InterestingIdentifiers[Name];
+      IDs.append(ModuleIDs.begin(), ModuleIDs.end());
+    }
+
     /// \brief Write the index to the given bitstream.
     void writeIndex(llvm::BitstreamWriter &Stream);
   };
@@ -786,7 +803,46 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr, PCHContainerRdr);
 
-  // Load each of the module files.
+  // Usually the index is rewritten because a module file has been added. If
+  // the module files in the existing index are all still there and unchanged,
+  // take what it says about them rather than reading them all again.
+  llvm::SmallPtrSet<const FileEntry *, 16> IndexedModuleFiles;
+  std::unique_ptr<GlobalModuleIndex> OldIndex(readIndex(Path).first);
+  if (OldIndex && !OldIndex->Modules.empty()) {
+    SmallVector<const FileEntry *, 16> OldFiles;
+    for (const ModuleInfo &Info : OldIndex->Modules) {
+      const FileEntry *File = Info.FileName.empty()
+                                  ? nullptr
+                                  : FileMgr.getFile(Info.FileName);
+      if (!File || File->getSize() != Info.Size ||
+          File->getModificationTime() != Info.ModTime) {
+        OldFiles.clear();
+        break;
+      }
+      OldFiles.push_back(File);
+    }
+
+    if (!OldFiles.empty()) {
+      for (unsigned I = 0, N = OldFiles.size(); I != N; ++I) {
+        Builder.addIndexedModuleFile(OldFiles[I],
+                                     OldIndex->Modules[I].Dependencies);
+        IndexedModuleFiles.insert(OldFiles[I]);
+      }
+
+      if (OldIndex->IdentifierIndex) {
+        IdentifierIndexTable &Table =
+            *static_cast<IdentifierIndexTable *>(OldIndex->IdentifierIndex);
+        auto Key = Table.key_begin();
+        for (auto D = Table.data_begin(), DEnd = Table.data_end(); D != DEnd;
+             ++D, ++Key)
+          Builder.addIndexedIdentifier(*Key, *D);
+      }
+    }
+  }
+  // The old index file is about to be replaced; don't keep it open.
+  OldIndex.reset();
+
+  // Load each of the module files not already in the index.
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
        D != DEnd && !EC;
@@ -802,9 +858,9 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
       continue;
     }
 
-    // If we can't find the module file, skip it.
+    // If we can't find the module file, or already know about it, skip it.
     const FileEntry *ModuleFile = FileMgr.getFile(D->path());
-    if (!ModuleFile)
+    if (!ModuleFile || IndexedModuleFiles.count(ModuleFile))
       continue;
 
     // Load this module file.
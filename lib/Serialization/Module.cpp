@@ -23,7 +23,7 @@ ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
   : Kind(Kind), File(nullptr), Signature(0), DirectlyImported(false),
     Generation(Generation), SizeInBits(0),
     LocalNumSLocEntries(0), SLocEntryBaseID(0),
-    SLocEntryBaseOffset(0), SLocEntryOffsets(nullptr),
+    SLocEntryBaseOffset(0), SLocSpaceSize(0), SLocEntryOffsets(nullptr),
     LocalNumIdentifiers(0),
     IdentifierOffsets(nullptr), BaseIdentifierID(0),
     IdentifierTableData(nullptr), IdentifierLookupTable(nullptr),
@@ -39,7 +39,9 @@ ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
     FileSortedDecls(nullptr), NumFileSortedDecls(0),
     ObjCCategoriesMap(nullptr), LocalNumObjCCategoriesInMap(0),
     LocalNumTypes(0), TypeOffsets(nullptr), BaseTypeIndex(0)
-{}
+{
+  clearLastSLocRemap();
+}
 
 ModuleFile::~ModuleFile() {
   delete static_cast<ASTIdentifierLookupTable *>(IdentifierLookupTable);
@@ -76,6 +78,8 @@ LLVM_DUMP_METHOD void ModuleFile::dump() {
   
   // Remapping tables.
   llvm::errs() << "  Base source location offset: " << SLocEntryBaseOffset 
+               << '\n'
+               << "  Source location address space: " << SLocSpaceSize
                << '\n';
   dumpLocalRemap("Source location offset local -> global map", SLocRemap);
   
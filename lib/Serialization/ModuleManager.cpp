@@ -16,8 +16,13 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/ModuleMap.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
+#include <future>
 #include <system_error>
 
 #ifndef NDEBUG
@@ -52,6 +57,78 @@ ModuleManager::lookupBuffer(StringRef Name) {
   return std::move(InMemoryBuffers[Entry]);
 }
 
+struct ModuleManager::PrefetchedFile {
+  /// The size and modification time of the file that was read, taken from
+  /// the descriptor its contents were read through.
+  off_t Size;
+  time_t ModTime;
+
+  /// Ready once the contents have been read.
+  std::shared_future<void> Done;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer;
+
+  PrefetchedFile() : Size(0), ModTime(0), Buffer(std::error_code()) {}
+};
+
+void ModuleManager::prefetchModuleFile(StringRef FileName) {
+  if (!LLVM_ENABLE_THREADS || FileName == "-")
+    return;
+
+  const FileEntry *Entry = FileMgr.getFile(FileName, /*openFile=*/false,
+                                           /*cacheFailure=*/false);
+  if (!Entry || Modules.count(Entry) || InMemoryBuffers.count(Entry) ||
+      PrefetchedFiles.count(Entry))
+    return;
+
+  if (!PrefetchThreads)
+    PrefetchThreads = llvm::make_unique<llvm::ThreadPool>();
+
+  auto File = std::make_shared<PrefetchedFile>();
+  std::string Path = Entry->getName();
+  File->Done = PrefetchThreads->async([File, Path] {
+    int FD;
+    if (llvm::sys::fs::openFileForRead(Path, FD))
+      return;
+    llvm::sys::fs::file_status Status;
+    if (!llvm::sys::fs::status(FD, Status)) {
+      File->Size = Status.getSize();
+      File->ModTime = llvm::sys::toTimeT(Status.getLastModificationTime());
+      File->Buffer = llvm::MemoryBuffer::getOpenFile(FD, Path,
+                                                     Status.getSize());
+    }
+    llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+    if (!File->Buffer)
+      return;
+
+    // The file is most likely mapped rather than read; touch every page so
+    // that it is paged in here rather than while it is being deserialized.
+    const volatile char *Data = (*File->Buffer)->getBufferStart();
+    size_t Size = (*File->Buffer)->getBufferSize();
+    size_t PageSize = llvm::sys::Process::getPageSize();
+    for (size_t I = 0; I < Size; I += PageSize)
+      (void)Data[I];
+  });
+  PrefetchedFiles[Entry] = std::move(File);
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+ModuleManager::takePrefetchedBuffer(const FileEntry *Entry) {
+  auto Known = PrefetchedFiles.find(Entry);
+  if (Known == PrefetchedFiles.end())
+    return nullptr;
+
+  std::shared_ptr<PrefetchedFile> File = std::move(Known->second);
+  PrefetchedFiles.erase(Known);
+  File->Done.wait();
+
+  // The file may have been replaced between the stat behind Entry, which is
+  // what the importer validated, and the prefetch.
+  if (!File->Buffer || File->Size != Entry->getSize() ||
+      File->ModTime != Entry->getModificationTime())
+    return nullptr;
+  return std::move(*File->Buffer);
+}
+
 ModuleManager::AddModuleResult
 ModuleManager::addModule(StringRef FileName, ModuleKind Type,
                          SourceLocation ImportLoc, ModuleFile *ImportedBy,
@@ -95,6 +172,7 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
     ModuleEntry->File = Entry;
     ModuleEntry->ImportLoc = ImportLoc;
     ModuleEntry->InputFilesValidationTimestamp = 0;
+    ModuleEntry->InputFilesTrusted = false;
 
     if (ModuleEntry->Kind == MK_ImplicitModule) {
       std::string TimestampFilename = ModuleEntry->getTimestampFilename();
@@ -115,6 +193,9 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
           (std::error_code()));
       if (FileName == "-") {
         Buf = llvm::MemoryBuffer::getSTDIN();
+      } else if (std::unique_ptr<llvm::MemoryBuffer> Prefetched =
+                     takePrefetchedBuffer(ModuleEntry->File)) {
+        Buf = std::move(Prefetched);
       } else {
         // Leave the FileEntry open so if it gets read again by another
         // ModuleManager it must be the same underlying file.
@@ -154,6 +235,25 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
     }
   }
 
+  // A module file in the trusted manifest must be the one the build system
+  // produced; if it is, its inputs are known to be up to date. Module files
+  // without a signature, such as explicitly built modules, can't be matched
+  // against the manifest, so their inputs are validated as usual.
+  auto Trusted = TrustedSignatures.find(FileName);
+  if (NewModule && Trusted != TrustedSignatures.end()) {
+    if (!ModuleEntry->Signature)
+      ModuleEntry->Signature = ReadSignature(ModuleEntry->Data);
+
+    if (ModuleEntry->Signature) {
+      if (ModuleEntry->Signature != Trusted->second) {
+        ErrorStr = "signature does not match the trusted module manifest";
+        delete ModuleEntry;
+        return OutOfDate;
+      }
+      ModuleEntry->InputFilesTrusted = true;
+    }
+  }
+
   if (ImportedBy) {
     ModuleEntry->ImportedBy.insert(ImportedBy);
     ImportedBy->Imports.insert(ModuleEntry);
@@ -191,6 +291,10 @@ void ModuleManager::removeModules(
   // Explicitly clear VisitOrder since we might not notice it is stale.
   VisitOrder.clear();
 
+  // Files may be rebuilt after a failed load, so don't trust anything read
+  // ahead of time for it.
+  PrefetchedFiles.clear();
+
   // Collect the set of module file pointers that we'll be removing.
   llvm::SmallPtrSet<ModuleFile *, 4> victimSet(first, last);
 
@@ -265,6 +369,33 @@ void ModuleManager::returnVisitState(VisitState *State) {
   FirstVisitState = State;
 }
 
+bool ModuleManager::readTrustedManifest(StringRef FileName,
+                                        std::string &ErrorStr) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf =
+      llvm::MemoryBuffer::getFile(FileName);
+  if (!Buf) {
+    ErrorStr = Buf.getError().message();
+    return false;
+  }
+
+  SmallVector<StringRef, 64> Lines;
+  (*Buf)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (unsigned I = 0, N = Lines.size(); I != N; ++I) {
+    StringRef Signature, Name;
+    std::tie(Signature, Name) = Lines[I].trim().split(' ');
+    Name = Name.trim();
+    if (Signature.empty())
+      continue;
+    ASTFileSignature Value;
+    if (Signature.getAsInteger(0, Value) || !Value || Name.empty()) {
+      ErrorStr = "malformed entry '" + Lines[I].trim().str() + "'";
+      return false;
+    }
+    TrustedSignatures[Name] = Value;
+  }
+  return true;
+}
+
 void ModuleManager::setGlobalIndex(GlobalModuleIndex *Index) {
   GlobalIndex = Index;
   if (!GlobalIndex) {
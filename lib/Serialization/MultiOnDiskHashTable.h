@@ -79,6 +79,10 @@ private:
   /// discarded.
   llvm::TinyPtrVector<file_type> PendingOverrides;
 
+  /// \brief The number of lookups performed since the tables were last
+  /// condensed, while there was more than one table to look into.
+  unsigned NumUncondensedLookups = 0;
+
   struct AsOnDiskTable {
     typedef OnDiskTable *result_type;
     result_type operator()(void *P) const {
@@ -88,6 +92,9 @@ private:
   typedef llvm::mapped_iterator<TableVector::iterator, AsOnDiskTable>
       table_iterator;
   typedef llvm::iterator_range<table_iterator> table_range;
+  typedef llvm::mapped_iterator<TableVector::const_iterator, AsOnDiskTable>
+      const_table_iterator;
+  typedef llvm::iterator_range<const_table_iterator> const_table_range;
 
   /// \brief The current set of on-disk tables.
   table_range tables() {
@@ -97,6 +104,13 @@ private:
     return llvm::make_range(llvm::map_iterator(Begin, AsOnDiskTable()),
                             llvm::map_iterator(End, AsOnDiskTable()));
   }
+  const_table_range tables() const {
+    auto Begin = Tables.begin(), End = Tables.end();
+    if (getMergedTable())
+      ++Begin;
+    return llvm::make_range(llvm::map_iterator(Begin, AsOnDiskTable()),
+                            llvm::map_iterator(End, AsOnDiskTable()));
+  }
 
   MergedTable *getMergedTable() const {
     // If we already have a merged table, it's the first one.
@@ -130,6 +144,23 @@ private:
     PendingOverrides.clear();
   }
 
+  /// \brief Read every entry of the on-disk table \p ODT into \p Data.
+  static void readAllInto(OnDiskTable *ODT,
+                          llvm::DenseMap<internal_key_type, data_type> &Data) {
+    auto &HT = ODT->Table;
+    Info &InfoObj = HT.getInfoObj();
+
+    for (auto I = HT.data_begin(), E = HT.data_end(); I != E; ++I) {
+      auto *LocalPtr = I.getItem();
+
+      // FIXME: Don't rely on the OnDiskHashTable format here.
+      auto L = InfoObj.ReadKeyDataLength(LocalPtr);
+      const internal_key_type &Key = InfoObj.ReadKey(LocalPtr, L.first);
+      data_type_builder ValueBuilder(Data[Key]);
+      InfoObj.ReadDataInto(Key, LocalPtr + L.first, L.second, ValueBuilder);
+    }
+  }
+
   void condense() {
     MergedTable *Merged = getMergedTable();
     if (!Merged)
@@ -138,26 +169,27 @@ private:
     // Read in all the tables and merge them together.
     // FIXME: Be smarter about which tables we merge.
     for (auto *ODT : tables()) {
-      auto &HT = ODT->Table;
-      Info &InfoObj = HT.getInfoObj();
-
-      for (auto I = HT.data_begin(), E = HT.data_end(); I != E; ++I) {
-        auto *LocalPtr = I.getItem();
-
-        // FIXME: Don't rely on the OnDiskHashTable format here.
-        auto L = InfoObj.ReadKeyDataLength(LocalPtr);
-        const internal_key_type &Key = InfoObj.ReadKey(LocalPtr, L.first);
-        data_type_builder ValueBuilder(Merged->Data[Key]);
-        InfoObj.ReadDataInto(Key, LocalPtr + L.first, L.second,
-                             ValueBuilder);
-      }
-
+      readAllInto(ODT, Merged->Data);
       Merged->Files.push_back(ODT->File);
       delete ODT;
     }
 
     Tables.clear();
     Tables.push_back(Table(Merged).getOpaqueValue());
+    NumUncondensedLookups = 0;
+  }
+
+  /// \brief Determine whether the tables should be condensed before a lookup.
+  ///
+  /// Besides keeping the number of tables bounded, a table that keeps being
+  /// looked into is condensed as soon as it's clear the lookups would
+  /// otherwise keep probing more than one table.
+  bool shouldCondense() {
+    if (Tables.size() > static_cast<unsigned>(Info::MaxTables))
+      return true;
+    return Tables.size() > 1 &&
+           ++NumUncondensedLookups >
+               static_cast<unsigned>(Info::MaxUncondensedLookups);
   }
 
   /// The generator is permitted to read our merged table.
@@ -168,7 +200,8 @@ public:
   MultiOnDiskHashTable() {}
   MultiOnDiskHashTable(MultiOnDiskHashTable &&O)
       : Tables(std::move(O.Tables)),
-        PendingOverrides(std::move(O.PendingOverrides)) {
+        PendingOverrides(std::move(O.PendingOverrides)),
+        NumUncondensedLookups(O.NumUncondensedLookups) {
     O.Tables.clear();
   }
   MultiOnDiskHashTable &operator=(MultiOnDiskHashTable &&O) {
@@ -178,6 +211,7 @@ public:
     Tables = std::move(O.Tables);
     O.Tables.clear();
     PendingOverrides = std::move(O.PendingOverrides);
+    NumUncondensedLookups = O.NumUncondensedLookups;
     return *this;
   }
   ~MultiOnDiskHashTable() { clear(); }
@@ -219,7 +253,7 @@ public:
     if (!PendingOverrides.empty())
       removeOverriddenTables();
 
-    if (Tables.size() > static_cast<unsigned>(Info::MaxTables))
+    if (shouldCondense())
       condense();
 
     internal_key_type Key = Info::GetInternalKey(EKey);
@@ -303,19 +337,52 @@ public:
       // Reserve four bytes for the bucket offset.
       Writer.write<uint32_t>(0);
 
-      if (auto *Merged = Base ? Base->getMergedTable() : nullptr) {
-        // Write list of overridden files.
-        Writer.write<uint32_t>(Merged->Files.size());
+      auto *Merged = Base ? Base->getMergedTable() : nullptr;
+
+      // If a reader of this table would otherwise still have to look into
+      // several of the tables it was built on, merge those into it as well,
+      // so that lookups find everything in one table.
+      llvm::SmallVector<typename BaseTable::OnDiskTable *, 4> OnDiskTables;
+      if (Base) {
+        for (auto *ODT : Base->tables())
+          if (!llvm::is_contained(Base->PendingOverrides, ODT->File))
+            OnDiskTables.push_back(ODT);
+        if (OnDiskTables.size() < 2)
+          OnDiskTables.clear();
+      }
+
+      // Write list of overridden files.
+      Writer.write<uint32_t>((Merged ? Merged->Files.size() : 0) +
+                             OnDiskTables.size());
+      if (Merged)
         for (const auto &F : Merged->Files)
           Info.EmitFileRef(OutStream, F);
-
-        // Add all merged entries from Base to the generator.
+      for (auto *ODT : OnDiskTables)
+        Info.EmitFileRef(OutStream, ODT->File);
+
+      // Add all merged entries from Base to the generator. The entries of
+      // the on-disk tables being merged are read into a map of their own,
+      // and the merged table's entries for the same keys are added to them.
+      llvm::DenseMap<typename ReaderInfo::internal_key_type,
+                     typename ReaderInfo::data_type> Data;
+      for (auto *ODT : OnDiskTables)
+        BaseTable::readAllInto(ODT, Data);
+      if (Merged) {
         for (auto &KV : Merged->Data) {
-          if (!Gen.contains(KV.first, Info))
+          if (Gen.contains(KV.first, Info))
+            continue;
+          auto It = Data.find(KV.first);
+          if (It == Data.end()) {
             Gen.insert(KV.first, Info.ImportData(KV.second), Info);
+            continue;
+          }
+          typename ReaderInfo::data_type_builder Builder(It->second);
+          ReaderInfo::MergeDataInto(KV.second, Builder);
         }
-      } else {
-        Writer.write<uint32_t>(0);
+      }
+      for (auto &KV : Data) {
+        if (!Gen.contains(KV.first, Info))
+          Gen.insert(KV.first, Info.ImportData(KV.second), Info);
       }
     }
 
@@ -16,11 +16,15 @@
 #include "ClangSACheckers.h"
 #include "clang/Analysis/CloneDetection.h"
 #include "clang/Basic/Diagnostic.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
@@ -46,6 +50,11 @@ public:
   ///        that explain why they are suspicious.
   void reportSuspiciousClones(BugReporter &BR, AnalysisManager &Mgr,
                               int MinComplexity) const;
+
+  /// \brief Writes the index of the statements in this translation unit to a
+  ///        new file in the given directory.
+  void exportIndex(AnalysisManager &Mgr, StringRef Dir,
+                   int MinComplexity) const;
 };
 } // end anonymous namespace
 
@@ -72,6 +81,16 @@ void CloneChecker::checkEndOfTranslationUnit(const TranslationUnitDecl *TU,
   bool ReportNormalClones = Mgr.getAnalyzerOptions().getBooleanOption(
       "ReportNormalClones", true, this);
 
+  // Instead of reporting the clones in this translation unit, the index of
+  // its statements can be written out to be merged with the indexes of other
+  // translation units, such as with utils/analyzer/MergeCloneIndex.py.
+  StringRef IndexDir = Mgr.getAnalyzerOptions().getOptionAsString(
+      "IndexDir", "", this);
+  if (!IndexDir.empty()) {
+    exportIndex(Mgr, IndexDir, MinComplexity);
+    return;
+  }
+
   if (ReportSuspiciousClones)
     reportSuspiciousClones(BR, Mgr, MinComplexity);
 
@@ -152,6 +171,34 @@ void CloneChecker::reportSuspiciousClones(BugReporter &BR,
   }
 }
 
+void CloneChecker::exportIndex(AnalysisManager &Mgr, StringRef Dir,
+                               int MinComplexity) const {
+  // Every translation unit gets its own file, so that concurrent analyses can
+  // write to the same directory.
+  llvm::SmallString<128> Model(Dir);
+  llvm::sys::path::append(Model, "clones-%%%%%%%%.idx");
+  int FD;
+  llvm::SmallString<128> Path;
+  std::error_code EC = llvm::sys::fs::create_directories(Dir);
+  if (!EC)
+    EC = llvm::sys::fs::createUniqueFile(Model, FD, Path);
+  if (EC) {
+    Mgr.getDiagnostic().Report(diag::warn_clone_index_failure)
+        << Dir << EC.message();
+    return;
+  }
+
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  Detector.exportIndex(OS, MinComplexity);
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    llvm::sys::fs::remove(Path);
+    Mgr.getDiagnostic().Report(diag::warn_clone_index_failure)
+        << Dir << "write failed";
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Register CloneChecker
 //===----------------------------------------------------------------------===//
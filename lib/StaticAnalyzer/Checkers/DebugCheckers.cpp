@@ -36,11 +36,8 @@ class DominatorsTreeDumper : public Checker<check::ASTCodeBody> {
 public:
   void checkASTCodeBody(const Decl *D, AnalysisManager& mgr,
                         BugReporter &BR) const {
-    if (AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D)) {
-      DominatorTree dom;
-      dom.buildDominatorTree(*AC);
-      dom.dump();
-    }
+    if (DominatorTree *Dom = mgr.getAnalysis<DominatorTree>(D))
+      Dom->dump();
   }
 };
 }
@@ -38,6 +38,9 @@ AnalysisManager::AnalysisManager(ASTContext &ctx, DiagnosticsEngine &diags,
     CheckerMgr(checkerMgr),
     options(Options) {
   AnaCtxMgr.getCFGBuildOptions().setAllAlwaysAdd();
+  if (Options.PrintStats)
+    PathGenerationTimer = llvm::make_unique<llvm::Timer>(
+        "pathgen", "Analyzer Path Diagnostic Generation Time");
 }
 
 AnalysisManager::~AnalysisManager() {
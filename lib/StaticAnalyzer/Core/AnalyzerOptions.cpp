@@ -88,6 +88,24 @@ IPAKind AnalyzerOptions::getIPAMode() {
   return IPAMode;
 }
 
+ExplorationStrategyKind AnalyzerOptions::getExplorationStrategy() {
+  if (ExplorationStrategy == ESK_NotSet) {
+    StringRef StratStr =
+        Config.insert(std::make_pair("exploration-strategy", "dfs"))
+            .first->second;
+    ExplorationStrategy =
+        llvm::StringSwitch<ExplorationStrategyKind>(StratStr)
+            .Case("dfs", ESK_DFS)
+            .Case("bfs", ESK_BFS)
+            .Case("bfs-block-dfs-contents", ESK_BFSBlockDFSContents)
+            .Case("coverage-guided", ESK_CoverageGuided)
+            .Default(ESK_NotSet);
+    assert(ExplorationStrategy != ESK_NotSet &&
+           "Exploration strategy is invalid.");
+  }
+  return ExplorationStrategy;
+}
+
 bool
 AnalyzerOptions::mayInlineCXXMemberFunction(CXXInlineableMemberKind K) {
   if (getIPAMode() < IPAK_Inlining)
@@ -308,6 +326,11 @@ unsigned AnalyzerOptions::getGraphTrimInterval() {
   return GraphTrimInterval.getValue();
 }
 
+bool AnalyzerOptions::shouldTrimGraphAggressively() {
+  return getBooleanOption(TrimGraphAggressively, "graph-trim-aggressive",
+                          /* Default = */ false);
+}
+
 unsigned AnalyzerOptions::getMaxTimesInlineLarge() {
   if (!MaxTimesInlineLarge.hasValue())
     MaxTimesInlineLarge = getOptionAsInteger("max-times-inline-large", 32);
@@ -370,3 +393,29 @@ bool AnalyzerOptions::shouldDisplayNotesAsEvents() {
         getBooleanOption("notes-as-events", /*Default=*/false);
   return DisplayNotesAsEvents.getValue();
 }
+
+StringRef AnalyzerOptions::getSummariesDir() {
+  return getOptionAsString("summaries-dir", "");
+}
+
+StringRef AnalyzerOptions::getIncrementalDir() {
+  return getOptionAsString("incremental-dir", "");
+}
+
+StringRef AnalyzerOptions::getCallGraphDir() {
+  return getOptionAsString("callgraph-dir", "");
+}
+
+StringRef AnalyzerOptions::getCTUDir() {
+  return getOptionAsString("ctu-dir", "");
+}
+
+StringRef AnalyzerOptions::getCTUIndexName() {
+  return getOptionAsString("ctu-index-name", "externalFnMap.txt");
+}
+
+unsigned AnalyzerOptions::getMaxLoadedCTUs() {
+  if (!MaxLoadedCTUs.hasValue())
+    MaxLoadedCTUs = getOptionAsInteger("ctu-max-loaded-tus", 8);
+  return MaxLoadedCTUs.getValue();
+}
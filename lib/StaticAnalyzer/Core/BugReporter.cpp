@@ -32,6 +32,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
 #include <queue>
@@ -46,6 +47,11 @@ STATISTIC(MaxBugClassSize,
 STATISTIC(MaxValidBugClassSize,
           "The maximum number of bug reports in the same equivalence class "
           "where at least one report is valid (not suppressed)");
+STATISTIC(NumTrimmedGraphs,
+          "The # of exploded graphs trimmed for path generation");
+STATISTIC(NumSharedTrimmedGraphUses,
+          "The # of equivalence classes whose paths were generated from a "
+          "trimmed graph shared with other classes");
 
 BugReporterVisitor::~BugReporterVisitor() {}
 
@@ -2739,7 +2745,6 @@ PathDiagnosticLocation BugReport::getLocation(const SourceManager &SM) const {
 //===----------------------------------------------------------------------===//
 
 BugReportEquivClass::~BugReportEquivClass() { }
-GRBugReporter::~GRBugReporter() { }
 BugReporterData::~BugReporterData() {}
 
 ExplodedGraph &GRBugReporter::getGraph() { return Eng.getGraph(); }
@@ -2771,6 +2776,8 @@ void BugReporter::FlushReports() {
          I = bugTypes.begin(), E = bugTypes.end(); I != E; ++I)
     const_cast<BugType*>(*I)->FlushReports(*this);
 
+  llvm::TimeRegion Timer(D.getPathGenerationTimer());
+
   // We need to flush reports in deterministic order to ensure the order
   // of the reports is consistent between runs.
   typedef std::vector<BugReportEquivClass *> ContVecTy;
@@ -2804,19 +2811,46 @@ public:
   const ExplodedNode *ErrorNode;
   size_t Index;
 };
+} // end anonymous namespace
+
+namespace clang {
+namespace ento {
+/// A graph trimmed down to the paths leading to a set of error nodes, its node
+/// maps and the order in which a forward BFS from the root reaches its nodes.
+///
+/// The trimmed graph of the error nodes of several equivalence classes gives
+/// the same shortest paths to each of them as the graph trimmed for just one
+/// of the classes would: the paths only go through the ancestors of the error
+/// nodes, and the extra nodes don't change the relative order of those.
+class TrimmedGraphData {
+public:
+  typedef llvm::DenseMap<const ExplodedNode *, unsigned> PriorityMapTy;
 
+  InterExplodedGraphMap ForwardMap;
+  InterExplodedGraphMap InverseMap;
+  PriorityMapTy PriorityMap;
+  std::unique_ptr<ExplodedGraph> G;
+
+  /// Trim \p OriginalGraph to the paths leading to \p Nodes. If \p StopEarly
+  /// is set, the BFS stops as soon as it reached all the error nodes.
+  TrimmedGraphData(const ExplodedGraph *OriginalGraph,
+                   ArrayRef<const ExplodedNode *> Nodes, bool StopEarly);
+};
+} // end namespace ento
+} // end namespace clang
+
+namespace {
 /// A wrapper around a trimmed graph and its node maps.
 class TrimmedGraph {
-  InterExplodedGraphMap InverseMap;
+  typedef TrimmedGraphData::PriorityMapTy PriorityMapTy;
 
-  typedef llvm::DenseMap<const ExplodedNode *, unsigned> PriorityMapTy;
-  PriorityMapTy PriorityMap;
+  /// The trimmed graph, if it isn't shared with other equivalence classes.
+  std::unique_ptr<TrimmedGraphData> OwnData;
+  const TrimmedGraphData *Data;
 
   typedef std::pair<const ExplodedNode *, size_t> NodeIndexPair;
   SmallVector<NodeIndexPair, 32> ReportNodes;
 
-  std::unique_ptr<ExplodedGraph> G;
-
   /// A helper class for sorting ExplodedNodes by priority.
   template <bool Descending>
   class PriorityCompare {
@@ -2844,32 +2878,32 @@ class TrimmedGraph {
     }
   };
 
+  void findReportNodes(ArrayRef<const ExplodedNode *> Nodes);
+
 public:
   TrimmedGraph(const ExplodedGraph *OriginalGraph,
                ArrayRef<const ExplodedNode *> Nodes);
 
+  /// Use the trimmed graph \p Shared, whose error nodes include \p Nodes.
+  TrimmedGraph(const TrimmedGraphData &Shared,
+               ArrayRef<const ExplodedNode *> Nodes);
+
   bool popNextReportGraph(ReportGraph &GraphWrapper);
 };
 }
 
-TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
-                           ArrayRef<const ExplodedNode *> Nodes) {
-  // The trimmed graph is created in the body of the constructor to ensure
-  // that the DenseMaps have been initialized already.
-  InterExplodedGraphMap ForwardMap;
+TrimmedGraphData::TrimmedGraphData(const ExplodedGraph *OriginalGraph,
+                                   ArrayRef<const ExplodedNode *> Nodes,
+                                   bool StopEarly) {
   G = OriginalGraph->trim(Nodes, &ForwardMap, &InverseMap);
 
-  // Find the (first) error node in the trimmed graph.  We just need to consult
+  // Find the error nodes in the trimmed graph.  We just need to consult
   // the node map which maps from nodes in the original graph to nodes
   // in the new graph.
   llvm::SmallPtrSet<const ExplodedNode *, 32> RemainingNodes;
-
-  for (unsigned i = 0, count = Nodes.size(); i < count; ++i) {
-    if (const ExplodedNode *NewNode = ForwardMap.lookup(Nodes[i])) {
-      ReportNodes.push_back(std::make_pair(NewNode, i));
+  for (const ExplodedNode *N : Nodes)
+    if (const ExplodedNode *NewNode = ForwardMap.lookup(N))
       RemainingNodes.insert(NewNode);
-    }
-  }
 
   assert(!RemainingNodes.empty() && "No error node found in the trimmed graph");
 
@@ -2896,7 +2930,7 @@ TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
     }
 
     if (RemainingNodes.erase(Node))
-      if (RemainingNodes.empty())
+      if (StopEarly && RemainingNodes.empty())
         break;
 
     for (ExplodedNode::const_pred_iterator I = Node->succ_begin(),
@@ -2904,10 +2938,30 @@ TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
          I != E; ++I)
       WS.push(*I);
   }
+}
+
+TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
+                           ArrayRef<const ExplodedNode *> Nodes)
+    : OwnData(llvm::make_unique<TrimmedGraphData>(OriginalGraph, Nodes,
+                                                  /*StopEarly=*/true)),
+      Data(OwnData.get()) {
+  findReportNodes(Nodes);
+}
+
+TrimmedGraph::TrimmedGraph(const TrimmedGraphData &Shared,
+                           ArrayRef<const ExplodedNode *> Nodes)
+    : Data(&Shared) {
+  findReportNodes(Nodes);
+}
+
+void TrimmedGraph::findReportNodes(ArrayRef<const ExplodedNode *> Nodes) {
+  for (unsigned i = 0, count = Nodes.size(); i < count; ++i)
+    if (const ExplodedNode *NewNode = Data->ForwardMap.lookup(Nodes[i]))
+      ReportNodes.push_back(std::make_pair(NewNode, i));
 
   // Sort the error paths from longest to shortest.
   std::sort(ReportNodes.begin(), ReportNodes.end(),
-            PriorityCompare<true>(PriorityMap));
+            PriorityCompare<true>(Data->PriorityMap));
 }
 
 bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
@@ -2916,7 +2970,7 @@ bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
 
   const ExplodedNode *OrigN;
   std::tie(OrigN, GraphWrapper.Index) = ReportNodes.pop_back_val();
-  assert(PriorityMap.find(OrigN) != PriorityMap.end() &&
+  assert(Data->PriorityMap.find(OrigN) != Data->PriorityMap.end() &&
          "error node not accessible from root");
 
   // Create a new graph with a single path.  This is the graph
@@ -2934,8 +2988,8 @@ bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
                                        OrigN->isSink());
 
     // Store the mapping to the original node.
-    InterExplodedGraphMap::const_iterator IMitr = InverseMap.find(OrigN);
-    assert(IMitr != InverseMap.end() && "No mapping to original node.");
+    InterExplodedGraphMap::const_iterator IMitr = Data->InverseMap.find(OrigN);
+    assert(IMitr != Data->InverseMap.end() && "No mapping to original node.");
     GraphWrapper.BackMap[NewN] = IMitr->second;
 
     // Link up the new node with the previous node.
@@ -2955,7 +3009,7 @@ bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
     // Find the next predeccessor node.  We choose the node that is marked
     // with the lowest BFS number.
     OrigN = *std::min_element(OrigN->pred_begin(), OrigN->pred_end(),
-                          PriorityCompare<false>(PriorityMap));
+                          PriorityCompare<false>(Data->PriorityMap));
   }
 
   GraphWrapper.Graph = std::move(GNew);
@@ -3059,6 +3113,42 @@ static void CompactPathDiagnostic(PathPieces &path, const SourceManager& SM) {
   path.insert(path.end(), Pieces.begin(), Pieces.end());
 }
 
+GRBugReporter::GRBugReporter(BugReporterData& d, ExprEngine& eng)
+  : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+
+GRBugReporter::~GRBugReporter() { }
+
+const TrimmedGraphData *GRBugReporter::getSharedTrimmedGraph() {
+  if (TriedSharedTrimmedGraph)
+    return SharedTrimmedGraph.get();
+  TriedSharedTrimmedGraph = true;
+
+  SmallVector<const ExplodedNode *, 32> ErrorNodes;
+  unsigned NumClasses = 0;
+  for (EQClasses_iterator I = EQClasses_begin(), E = EQClasses_end(); I != E;
+       ++I) {
+    bool HasErrorNode = false;
+    for (BugReport &R : *I) {
+      if (!R.isValid() || !R.getErrorNode())
+        continue;
+      ErrorNodes.push_back(R.getErrorNode());
+      HasErrorNode = true;
+    }
+    if (HasErrorNode)
+      ++NumClasses;
+  }
+
+  // A single class is better served by a graph trimmed just for it, whose
+  // BFS can stop as soon as it reached all the error nodes.
+  if (NumClasses < 2)
+    return nullptr;
+
+  SharedTrimmedGraph = llvm::make_unique<TrimmedGraphData>(
+      &getGraph(), ErrorNodes, /*StopEarly=*/false);
+  ++NumTrimmedGraphs;
+  return SharedTrimmedGraph.get();
+}
+
 bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
                                            PathDiagnosticConsumer &PC,
                                            ArrayRef<BugReport *> &bugReports) {
@@ -3094,10 +3184,22 @@ bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
     }
   }
 
-  TrimmedGraph TrimG(&getGraph(), errorNodes);
+  // Trim the graph once for all the equivalence classes being flushed, unless
+  // some of this class' error nodes were reported after it was trimmed.
+  std::unique_ptr<TrimmedGraph> TrimG;
+  const TrimmedGraphData *Shared = getSharedTrimmedGraph();
+  if (Shared && llvm::all_of(errorNodes, [Shared](const ExplodedNode *N) {
+        return !N || Shared->ForwardMap.count(N);
+      })) {
+    TrimG = llvm::make_unique<TrimmedGraph>(*Shared, errorNodes);
+    ++NumSharedTrimmedGraphUses;
+  } else {
+    TrimG = llvm::make_unique<TrimmedGraph>(&getGraph(), errorNodes);
+    ++NumTrimmedGraphs;
+  }
   ReportGraph ErrorGraph;
 
-  while (TrimG.popNextReportGraph(ErrorGraph)) {
+  while (TrimG->popNextReportGraph(ErrorGraph)) {
     // Find the BugReport with the original location.
     assert(ErrorGraph.Index < bugReports.size());
     BugReport *R = bugReports[ErrorGraph.Index];
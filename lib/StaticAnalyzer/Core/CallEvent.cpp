@@ -16,8 +16,11 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/AST/ParentMap.h"
 #include "clang/Analysis/ProgramPoint.h"
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/DynamicTypeMap.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/raw_ostream.h"
@@ -343,6 +346,40 @@ ArrayRef<ParmVarDecl*> AnyFunctionCall::parameters() const {
   return D->parameters();
 }
 
+RuntimeDefinition AnyFunctionCall::getRuntimeDefinition() const {
+  const FunctionDecl *FD = getDecl();
+  if (!FD)
+    return RuntimeDefinition();
+
+  // Note that the AnalysisDeclContext will have the FunctionDecl with
+  // the definition (if one exists).
+  AnalysisDeclContext *AD =
+    getLocationContext()->getAnalysisDeclContext()->
+    getManager()->getContext(FD);
+  if (AD->getBody())
+    return RuntimeDefinition(AD->getDecl());
+
+  // Look for the definition in the translation unit which defines it.
+  AnalysisManager &AMgr =
+      getState()->getStateManager().getOwningEngine()->getAnalysisManager();
+  cross_tu::CrossTranslationUnitContext *CTUCtx =
+      AMgr.getCrossTranslationUnitContext();
+  if (!CTUCtx)
+    return RuntimeDefinition();
+
+  AnalyzerOptions &Opts = AMgr.getAnalyzerOptions();
+  llvm::Expected<const FunctionDecl *> CTUDeclOrError =
+      CTUCtx->getCrossTUDefinition(FD, Opts.getCTUDir(),
+                                   Opts.getCTUIndexName());
+  if (!CTUDeclOrError) {
+    // Most functions without a body here, like those of the C library, are
+    // not in the index either, so there is nothing to report.
+    llvm::consumeError(CTUDeclOrError.takeError());
+    return RuntimeDefinition();
+  }
+  return RuntimeDefinition(*CTUDeclOrError);
+}
+
 void AnyFunctionCall::getInitialStackFrameContents(
                                         const StackFrameContext *CalleeCtx,
                                         BindingsTy &Bindings) const {
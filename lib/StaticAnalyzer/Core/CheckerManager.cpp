@@ -751,13 +751,21 @@ const CheckerManager::CachedStmtCheckers &
 CheckerManager::getCachedStmtCheckersFor(const Stmt *S, bool isPreVisit) {
   assert(S);
 
+  // This is called for every statement of every path, so look the checkers
+  // up in a table rather than a map.
+  if (CachedStmtCheckersTable.empty()) {
+    unsigned NumKeys = (Stmt::lastStmtConstant + 1) << 1;
+    CachedStmtCheckersTable.resize(NumKeys);
+    CachedStmtCheckersComputed.resize(NumKeys);
+  }
+
   unsigned Key = (S->getStmtClass() << 1) | unsigned(isPreVisit);
-  CachedStmtCheckersMapTy::iterator CCI = CachedStmtCheckersMap.find(Key);
-  if (CCI != CachedStmtCheckersMap.end())
-    return CCI->second;
+  CachedStmtCheckers &Checkers = CachedStmtCheckersTable[Key];
+  if (CachedStmtCheckersComputed[Key])
+    return Checkers;
+  CachedStmtCheckersComputed[Key] = true;
 
   // Find the checkers that should run for this Stmt and cache them.
-  CachedStmtCheckers &Checkers = CachedStmtCheckersMap[Key];
   for (unsigned i = 0, e = StmtCheckers.size(); i != e; ++i) {
     StmtCheckerInfo &Info = StmtCheckers[i];
     if (Info.IsPreVisit == isPreVisit && Info.IsForStmtFn(S))
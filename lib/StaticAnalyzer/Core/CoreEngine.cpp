@@ -20,6 +20,8 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/ErrorHandling.h"
+#include <queue>
 
 using namespace clang;
 using namespace ento;
@@ -156,10 +158,131 @@ WorkList* WorkList::makeBFSBlockDFSContents() {
   return new BFSBlockDFSContents();
 }
 
+namespace {
+  /// Explores each basic block to completion like BFSBlockDFSContents, but
+  /// picks the next block to enter by how much it adds to the coverage: the
+  /// blocks which no path has reached yet come first, then those which their
+  /// path has visited the fewest times. This keeps the node budget from being
+  /// spent on unrolling a loop over and over while the code after it is still
+  /// unexplored.
+  class CoverageGuided : public WorkList {
+    /// The priority of an edge into a basic block; smaller is more urgent.
+    /// Among equally urgent edges the one queued last is taken first.
+    struct Priority {
+      bool Visited;
+      unsigned NumVisitedOnPath;
+      unsigned Order;
+
+      bool operator<(const Priority &RHS) const {
+        if (Visited != RHS.Visited)
+          return !Visited;
+        if (NumVisitedOnPath != RHS.NumVisitedOnPath)
+          return NumVisitedOnPath < RHS.NumVisitedOnPath;
+        return Order > RHS.Order;
+      }
+    };
+
+    typedef std::pair<Priority, WorkListUnit> QueueEntry;
+
+    struct ComparePriority {
+      bool operator()(const QueueEntry &LHS, const QueueEntry &RHS) const {
+        return RHS.first < LHS.first;
+      }
+    };
+
+    const FunctionSummariesTy &FunctionSummaries;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, ComparePriority>
+        Queue;
+    SmallVector<WorkListUnit,20> Stack;
+    unsigned NumEnqueued;
+
+  public:
+    explicit CoverageGuided(const FunctionSummariesTy &FS)
+        : FunctionSummaries(FS), NumEnqueued(0) {}
+
+    bool hasWork() const override {
+      return !Queue.empty() || !Stack.empty();
+    }
+
+    void enqueue(const WorkListUnit& U) override {
+      const ExplodedNode *N = U.getNode();
+      Optional<BlockEdge> BE = N->getLocation().getAs<BlockEdge>();
+      if (!BE) {
+        Stack.push_back(U);
+        return;
+      }
+
+      const LocationContext *LC = N->getLocationContext();
+      unsigned BlockID = BE->getDst()->getBlockID();
+      Priority P;
+      P.Visited = FunctionSummaries.isVisitedBasicBlock(BlockID, LC->getDecl());
+      P.NumVisitedOnPath = U.getBlockCounter().getNumVisited(
+          LC->getCurrentStackFrame(), BlockID);
+      P.Order = NumEnqueued++;
+      Queue.push(std::make_pair(P, U));
+    }
+
+    WorkListUnit dequeue() override {
+      // Process all basic blocks to completion.
+      if (!Stack.empty()) {
+        const WorkListUnit& U = Stack.back();
+        Stack.pop_back(); // This technically "invalidates" U, but we are fine.
+        return U;
+      }
+
+      assert(!Queue.empty());
+      WorkListUnit U = Queue.top().second;
+      Queue.pop();
+      return U;
+    }
+
+    bool visitItemsInWorkList(Visitor &V) override {
+      for (SmallVectorImpl<WorkListUnit>::iterator
+           I = Stack.begin(), E = Stack.end(); I != E; ++I) {
+        if (V.visit(*I))
+          return true;
+      }
+      // std::priority_queue doesn't allow iterating over its elements, so
+      // visit a copy of it.
+      auto Copy = Queue;
+      for (; !Copy.empty(); Copy.pop())
+        if (V.visit(Copy.top().second))
+          return true;
+      return false;
+    }
+  };
+} // end anonymous namespace
+
+WorkList *WorkList::makeCoverageGuided(const FunctionSummariesTy &FS) {
+  return new CoverageGuided(FS);
+}
+
 //===----------------------------------------------------------------------===//
 // Core analysis engine.
 //===----------------------------------------------------------------------===//
 
+static WorkList *createWorkList(AnalyzerOptions &Opts,
+                                const FunctionSummariesTy &FS) {
+  switch (Opts.getExplorationStrategy()) {
+  case ESK_DFS:
+    return WorkList::makeDFS();
+  case ESK_BFS:
+    return WorkList::makeBFS();
+  case ESK_BFSBlockDFSContents:
+    return WorkList::makeBFSBlockDFSContents();
+  case ESK_CoverageGuided:
+    return WorkList::makeCoverageGuided(FS);
+  case ESK_NotSet:
+    break;
+  }
+  llvm_unreachable("Unknown exploration strategy");
+}
+
+CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
+                       AnalyzerOptions &Opts)
+    : SubEng(subengine), WList(createWorkList(Opts, *FS)),
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
                                    ProgramStateRef InitState) {
@@ -24,6 +24,13 @@
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ExplodedGraph"
+
+STATISTIC(NumReclaimedNodes,
+          "The # of nodes reclaimed from exploded graphs.");
+STATISTIC(NumGraphKilobytes,
+          "The # of kilobytes allocated for exploded graphs.");
+
 //===----------------------------------------------------------------------===//
 // Node auditing.
 //===----------------------------------------------------------------------===//
@@ -46,9 +53,11 @@ void ExplodedNode::SetAuditor(ExplodedNode::Auditor* A) {
 //===----------------------------------------------------------------------===//
 
 ExplodedGraph::ExplodedGraph()
-  : NumNodes(0), ReclaimNodeInterval(0) {}
+  : NumNodes(0), ReclaimNodeInterval(0), AggressiveReclamation(false) {}
 
-ExplodedGraph::~ExplodedGraph() {}
+ExplodedGraph::~ExplodedGraph() {
+  NumGraphKilobytes += BVC.getAllocator().getTotalMemory() / 1024;
+}
 
 //===----------------------------------------------------------------------===//
 // Node reclamation.
@@ -62,6 +71,16 @@ bool ExplodedGraph::isInterestingLValueExpr(const Expr *Ex) {
          isa<ObjCIvarRefExpr>(Ex);
 }
 
+/// Returns true if \p succ is where a call is retried without inlining, which
+/// needs to find its predecessor.
+static bool isCallRelatedSuccessor(const ExplodedNode *succ) {
+  const ProgramPoint SuccLoc = succ->getLocation();
+  if (Optional<StmtPoint> SP = SuccLoc.getAs<StmtPoint>())
+    if (CallEvent::isCallStmt(SP->getStmt()))
+      return true;
+  return SuccLoc.getAs<CallEnter>() || SuccLoc.getAs<PreImplicitCall>();
+}
+
 bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   // First, we only consider nodes for reclamation of the following
   // conditions apply:
@@ -92,6 +111,11 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   //      PreImplicitCall (so that we would be able to find it when retrying a
   //      call with no inlining).
   // FIXME: It may be safe to reclaim PreCall and PostCall nodes as well.
+  //
+  // When reclaiming aggressively, we also discard the plain PreStmt and
+  // PostStmt nodes for which (4), (7) and (10) apply and whose state is the
+  // same as the predecessor's, even though they fail (8) or (9). The
+  // diagnostics may then point at fewer intermediate expressions.
 
   // Conditions 1 and 2.
   if (node->pred_size() != 1 || node->succ_size() != 1)
@@ -111,14 +135,22 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   if (progPoint.getAs<PreStmtPurgeDeadSymbols>())
     return !progPoint.getTag();
 
-  // Condition 3.
-  if (!progPoint.getAs<PostStmt>() || progPoint.getAs<PostStore>())
-    return false;
-
   // Condition 4.
   if (progPoint.getTag())
     return false;
 
+  if (AggressiveReclamation &&
+      (progPoint.getKind() == ProgramPoint::PreStmtKind ||
+       progPoint.getKind() == ProgramPoint::PostStmtKind) &&
+      node->getState() == pred->getState() &&
+      progPoint.getLocationContext() == pred->getLocationContext() &&
+      !isCallRelatedSuccessor(succ))
+    return true;
+
+  // Condition 3.
+  if (!progPoint.getAs<PostStmt>() || progPoint.getAs<PostStore>())
+    return false;
+
   // Conditions 5, 6, and 7.
   ProgramStateRef state = node->getState();
   ProgramStateRef pred_state = pred->getState();
@@ -147,16 +179,7 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
     return false;
 
   // Condition 10.
-  const ProgramPoint SuccLoc = succ->getLocation();
-  if (Optional<StmtPoint> SP = SuccLoc.getAs<StmtPoint>())
-    if (CallEvent::isCallStmt(SP->getStmt()))
-      return false;
-
-  // Condition 10, continuation.
-  if (SuccLoc.getAs<CallEnter>() || SuccLoc.getAs<PreImplicitCall>())
-    return false;
-
-  return true;
+  return !isCallRelatedSuccessor(succ);
 }
 
 void ExplodedGraph::collectNode(ExplodedNode *node) {
@@ -172,6 +195,7 @@ void ExplodedGraph::collectNode(ExplodedNode *node) {
   FreeNodes.push_back(node);
   Nodes.RemoveNode(node);
   --NumNodes;
+  ++NumReclaimedNodes;
   node->~ExplodedNode();
 }
 
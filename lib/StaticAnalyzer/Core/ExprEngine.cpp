@@ -73,7 +73,7 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
                        InliningModes HowToInlineIn)
   : AMgr(mgr),
     AnalysisDeclContexts(mgr.getAnalysisDeclContextManager()),
-    Engine(*this, FS),
+    Engine(*this, FS, mgr.getAnalyzerOptions()),
     G(Engine.getGraph()),
     StateMgr(getContext(), mgr.getStoreManagerCreator(),
              mgr.getConstraintManagerCreator(), G.getAllocator(),
@@ -89,7 +89,8 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
   unsigned TrimInterval = mgr.options.getGraphTrimInterval();
   if (TrimInterval != 0) {
     // Enable eager node reclaimation when constructing the ExplodedGraph.
-    G.enableNodeReclamation(TrimInterval);
+    G.enableNodeReclamation(TrimInterval,
+                            mgr.options.shouldTrimGraphAggressively());
   }
 }
 
@@ -2198,6 +2199,26 @@ ProgramStateRef ExprEngine::processPointerEscapedOnBind(ProgramStateRef State,
   return State;
 }
 
+ProgramStateRef ExprEngine::processPointerEscapedOnCall(ProgramStateRef State,
+                                                        const CallEvent &Call) {
+  InvalidatedSymbols EscapedSymbols;
+  for (unsigned Idx = 0, Count = Call.getNumArgs(); Idx != Count; ++Idx) {
+    CollectReachableSymbolsCallback Scanner =
+        State->scanReachableSymbols<CollectReachableSymbolsCallback>(
+            Call.getArgSVal(Idx));
+    EscapedSymbols.insert(Scanner.getSymbols().begin(),
+                          Scanner.getSymbols().end());
+  }
+  if (EscapedSymbols.empty())
+    return State;
+
+  return getCheckerManager().runCheckersForPointerEscape(State,
+                                                         EscapedSymbols,
+                                                         &Call,
+                                                         PSK_DirectEscapeOnCall,
+                                                         nullptr);
+}
+
 ProgramStateRef
 ExprEngine::notifyCheckersOfPointerEscape(ProgramStateRef State,
     const InvalidatedSymbols *Invalidated,
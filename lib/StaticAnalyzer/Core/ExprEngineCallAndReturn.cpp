@@ -562,7 +562,14 @@ ProgramStateRef ExprEngine::bindReturnValue(const CallEvent &Call,
 void ExprEngine::conservativeEvalCall(const CallEvent &Call, NodeBuilder &Bldr,
                                       ExplodedNode *Pred,
                                       ProgramStateRef State) {
-  State = Call.invalidateRegions(currBldrCtx->blockCount(), State);
+  // Functions summarized as side-effect free by the analysis of another
+  // translation unit leave everything they can reach untouched. Their
+  // arguments still escape, though: the callee may return them, and its
+  // conjured return value is then their only remaining reference.
+  if (!AMgr.isSideEffectFreeFunction(Call.getDecl()))
+    State = Call.invalidateRegions(currBldrCtx->blockCount(), State);
+  else
+    State = processPointerEscapedOnCall(State, Call);
   State = bindReturnValue(Call, Pred->getLocationContext(), State);
 
   // And make the result node.
@@ -44,6 +44,8 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   bool createdDir, noDir;
   const Preprocessor &PP;
   AnalyzerOptions &AnalyzerOpts;
+  /// The syntax and macro highlighting of the files reported on so far.
+  html::RelexRewriteCacheRef RewriterCache;
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts, const std::string& prefix, const Preprocessor &pp);
 
@@ -76,8 +78,9 @@ public:
 HTMLDiagnostics::HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts,
                                  const std::string& prefix,
                                  const Preprocessor &pp)
-    : Directory(prefix), createdDir(false), noDir(false), PP(pp), AnalyzerOpts(AnalyzerOpts) {
-}
+    : Directory(prefix), createdDir(false), noDir(false), PP(pp),
+      AnalyzerOpts(AnalyzerOpts),
+      RewriterCache(html::instantiateRelexRewriteCache()) {}
 
 void ento::createHTMLDiagnosticConsumer(AnalyzerOptions &AnalyzerOpts,
                                         PathDiagnosticConsumers &C,
@@ -187,8 +190,8 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
   // We might not have a preprocessor if we come from a deserialized AST file,
   // for example.
 
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  html::SyntaxHighlight(R, FID, PP, RewriterCache);
+  html::HighlightMacros(R, FID, PP, RewriterCache);
 
   // Get the full directory name of the analyzed file.
 
@@ -12,6 +12,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "FunctionFingerprintStore.h"
+#include "FunctionSummaryStore.h"
 #include "ModelInjector.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
@@ -21,8 +23,11 @@
 #include "clang/Analysis/CFG.h"
 #include "clang/Analysis/CallGraph.h"
 #include "clang/Analysis/CodeInjector.h"
+#include "clang/Basic/FileUtilities.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
@@ -34,12 +39,16 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -163,6 +172,7 @@ class AnalysisConsumer : public AnalysisASTConsumer,
 
 public:
   ASTContext *Ctx;
+  CompilerInstance &CI;
   const Preprocessor &PP;
   const std::string OutDir;
   AnalyzerOptionsRef Opts;
@@ -192,12 +202,20 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
-  AnalysisConsumer(const Preprocessor &pp, const std::string &outdir,
+  /// The fingerprints of the analyzed code, if only the code changed since
+  /// the previous analysis is to be analyzed.
+  std::unique_ptr<FunctionFingerprintStore> Fingerprints;
+
+  /// Loads the definitions of functions defined in other translation units,
+  /// if they are to be inlined.
+  std::unique_ptr<cross_tu::CrossTranslationUnitContext> CTU;
+
+  AnalysisConsumer(CompilerInstance &CI, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
                    CodeInjector *injector)
-      : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr), PP(pp),
-        OutDir(outdir), Opts(std::move(opts)), Plugins(plugins),
-        Injector(injector) {
+      : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr), CI(CI),
+        PP(CI.getPreprocessor()), OutDir(outdir), Opts(std::move(opts)),
+        Plugins(plugins), Injector(injector) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats) {
       llvm::EnableStatistics(false);
@@ -292,6 +310,12 @@ public:
     Mgr = llvm::make_unique<AnalysisManager>(
         *Ctx, PP.getDiagnostics(), PP.getLangOpts(), PathConsumers,
         CreateStoreMgr, CreateConstraintMgr, checkerMgr.get(), *Opts, Injector);
+
+    if (!Opts->getCTUDir().empty()) {
+      CTU = llvm::make_unique<cross_tu::CrossTranslationUnitContext>(
+          CI, Opts->getMaxLoadedCTUs());
+      Mgr->setCrossTranslationUnitContext(CTU.get());
+    }
   }
 
   /// \brief Store the top level decls in the set to be processed later on.
@@ -307,9 +331,9 @@ public:
   ExprEngine::InliningModes
     getInliningModeForFunction(const Decl *D, const SetOfConstDecls &Visited);
 
-  /// \brief Build the call graph for all the top level decls of this TU and
-  /// use it to define the order in which the functions should be visited.
-  void HandleDeclsCallGraph(const unsigned LocalTUDeclsSize);
+  /// \brief Use the call graph of all the top level decls of this TU to
+  /// define the order in which the functions should be visited.
+  void HandleDeclsCallGraph(CallGraph &CG);
 
   /// \brief Run analyzes(syntax or path sensitive) on the given function.
   /// \param Mode - determines if we are requesting syntax only or path
@@ -457,16 +481,7 @@ AnalysisConsumer::getInliningModeForFunction(const Decl *D,
   return ExprEngine::Inline_Regular;
 }
 
-void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
-  // Build the Call Graph by adding all the top level declarations to the graph.
-  // Note: CallGraph can trigger deserialization of more items from a pch
-  // (though HandleInterestingDecl); triggering additions to LocalTUDecls.
-  // We rely on random access to add the initially processed Decls to CG.
-  CallGraph CG;
-  for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-    CG.addToCallGraph(LocalTUDecls[i]);
-  }
-
+void AnalysisConsumer::HandleDeclsCallGraph(CallGraph &CG) {
   // Walk over all of the call graph nodes in topological order, so that we
   // analyze parents before the children. Skip the functions inlined into
   // the previously processed functions. Use external Visited set to identify
@@ -508,6 +523,88 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   }
 }
 
+/// Add the callees of \p N to \p Callees, looking through the blocks called
+/// by \p N, which have no USRs of their own.
+static void collectCallees(const CallGraphNode *N,
+                           llvm::SetVector<const Decl *> &Callees,
+                           llvm::SmallPtrSetImpl<const CallGraphNode *> &Seen) {
+  for (const CallGraphNode *Callee : *N) {
+    if (!Seen.insert(Callee).second)
+      continue;
+    if (isa<BlockDecl>(Callee->getDecl()))
+      collectCallees(Callee, Callees, Seen);
+    else
+      Callees.insert(Callee->getDecl());
+  }
+}
+
+/// Write the call graph \p CG of the translation unit of \p Ctx to a file of
+/// its own in \p Dir. Every line describes a function defined in the
+/// translation unit, with the tab separated USR, name, location and
+/// linkage of the function and the comma separated USRs of its callees.
+static void writeCallGraph(const CallGraph &CG, StringRef Dir,
+                           ASTContext &Ctx) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  if (!MainFile)
+    return;
+
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(
+      Path, getMainFileHashedName(MainFile->getName(), ".callgraph"));
+
+  // Sort the lines, so that the output doesn't depend on the order of the
+  // nodes in the graph.
+  std::vector<std::string> Lines;
+  for (const auto &Entry : CG) {
+    const CallGraphNode *N = Entry.second.get();
+    const auto *ND = dyn_cast_or_null<NamedDecl>(N->getDecl());
+    SmallString<128> USR;
+    if (!ND || index::generateUSRForDecl(ND, USR))
+      continue;
+
+    // The node is keyed by the canonical declaration; locate the definition.
+    const NamedDecl *Def = ND;
+    if (const auto *FD = dyn_cast<FunctionDecl>(ND)) {
+      const FunctionDecl *FDDef;
+      if (FD->hasBody(FDDef))
+        Def = FDDef;
+    }
+
+    std::string Line;
+    llvm::raw_string_ostream OS(Line);
+    PresumedLoc PLoc =
+        SM.getPresumedLoc(SM.getExpansionLoc(Def->getLocation()));
+    OS << USR << '\t' << ND->getQualifiedNameAsString() << '\t';
+    if (PLoc.isValid())
+      OS << PLoc.getFilename() << ':' << PLoc.getLine();
+    OS << '\t' << (ND->isExternallyVisible() ? "external" : "internal") << '\t';
+
+    llvm::SetVector<const Decl *> Callees;
+    llvm::SmallPtrSet<const CallGraphNode *, 8> Seen;
+    collectCallees(N, Callees, Seen);
+    bool First = true;
+    for (const Decl *Callee : Callees) {
+      SmallString<128> CalleeUSR;
+      if (index::generateUSRForDecl(Callee, CalleeUSR))
+        continue;
+      if (!First)
+        OS << ',';
+      OS << CalleeUSR;
+      First = false;
+    }
+    Lines.push_back(OS.str());
+  }
+  std::sort(Lines.begin(), Lines.end());
+
+  std::string Contents;
+  for (const std::string &Line : Lines)
+    Contents += Line + '\n';
+
+  // The tools reading the call graphs must never see a partially written file.
+  writeFileAtomically(Path, Contents);
+}
+
 void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
   // Don't run the actions if an error has occurred with parsing the file.
   DiagnosticsEngine &Diags = PP.getDiagnostics();
@@ -527,6 +624,37 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
     checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
+    std::unique_ptr<FunctionSummaryStore> Summaries;
+    StringRef SummariesDir = Opts->getSummariesDir();
+    if (!SummariesDir.empty()) {
+      Summaries = llvm::make_unique<FunctionSummaryStore>(SummariesDir);
+      Summaries->load(TU, *Mgr);
+    }
+
+    // Build the Call Graph by adding all the top level declarations to the
+    // graph, once for all of its users.
+    // Note: CallGraph can trigger deserialization of more items from a pch
+    // (though HandleInterestingDecl); triggering additions to LocalTUDecls.
+    // We rely on random access to add the initially processed Decls to CG.
+    const unsigned LocalTUDeclsSize = LocalTUDecls.size();
+    StringRef IncrementalDir = Opts->getIncrementalDir();
+    StringRef CallGraphDir = Opts->getCallGraphDir();
+    CallGraph CG;
+    if (Mgr->shouldInlineCall() || !IncrementalDir.empty() ||
+        !CallGraphDir.empty())
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i)
+        CG.addToCallGraph(LocalTUDecls[i]);
+
+    if (!CallGraphDir.empty())
+      writeCallGraph(CG, CallGraphDir, C);
+
+    if (!IncrementalDir.empty()) {
+      Fingerprints = llvm::make_unique<FunctionFingerprintStore>(
+          IncrementalDir, C, *Opts, CG);
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i)
+        Fingerprints->addTopLevelDecl(LocalTUDecls[i]);
+    }
+
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
     // sensitive analyzes as well.
@@ -541,17 +669,28 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // entries.  Thus we don't use an iterator, but rely on LocalTUDecls
     // random access.  By doing so, we automatically compensate for iterators
     // possibly being invalidated, although this is a bit slower.
-    const unsigned LocalTUDeclsSize = LocalTUDecls.size();
     for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
       TraverseDecl(LocalTUDecls[i]);
     }
 
     if (Mgr->shouldInlineCall())
-      HandleDeclsCallGraph(LocalTUDeclsSize);
+      HandleDeclsCallGraph(CG);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
     checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
+    if (Summaries) {
+      const SourceManager &SM = C.getSourceManager();
+      Summaries->summarize(TU, SM);
+      if (const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID()))
+        Summaries->save(MainFile->getName());
+    }
+
+    if (Fingerprints) {
+      Fingerprints->save();
+      Fingerprints.reset();
+    }
+
     RecVisitorBR = nullptr;
   }
 
@@ -560,6 +699,7 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
   // side-effects in PathDiagnosticConsumer's destructor. This is required when
   // used with option -disable-free.
   Mgr.reset();
+  CTU.reset();
 
   if (TUTotalTimer) TUTotalTimer->stopTimer();
 
@@ -666,6 +806,10 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
   if (Mode == AM_None)
     return;
 
+  // The previous analysis already checked this code as it is now.
+  if (Fingerprints && Fingerprints->isUnchanged(D))
+    return;
+
   // Clear the AnalysisManager of old AnalysisDeclContexts.
   Mgr->ClearContexts();
   // Ignore autosynthesized code.
@@ -764,7 +908,7 @@ ento::CreateAnalysisConsumer(CompilerInstance &CI) {
   bool hasModelPath = analyzerOpts->Config.count("model-path") > 0;
 
   return llvm::make_unique<AnalysisConsumer>(
-      CI.getPreprocessor(), CI.getFrontendOpts().OutputFile, analyzerOpts,
+      CI, CI.getFrontendOpts().OutputFile, analyzerOpts,
       CI.getFrontendOpts().Plugins,
       hasModelPath ? new ModelInjector(CI) : nullptr);
 }
@@ -0,0 +1,251 @@
+//===-- FunctionFingerprintStore.cpp ----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Implements the fingerprints of the analyzed code which allow an
+/// analysis to skip the functions unchanged since the previous one.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FunctionFingerprintStore.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/Basic/FileUtilities.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/Version.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace ento;
+
+static std::string getHashString(llvm::MD5 &Hash) {
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Str;
+  llvm::MD5::stringifyResult(Result, Str);
+  return Str.str();
+}
+
+/// Returns true if \p D is code analyzed on its own, whose text is covered
+/// by its own fingerprint rather than by the context.
+static bool isCodeDecl(const Decl *D) {
+  if (const auto *FD = dyn_cast<FunctionDecl>(D))
+    return FD->isThisDeclarationADefinition();
+  if (const auto *MD = dyn_cast<ObjCMethodDecl>(D))
+    return MD->isThisDeclarationADefinition();
+  return false;
+}
+
+/// Hash the preprocessor directives of the main file, which can change what
+/// its function definitions mean without changing their text.
+static void hashMainFileDirectives(const SourceManager &SM,
+                                   const LangOptions &LangOpts, llvm::MD5 &H) {
+  FileID MainFileID = SM.getMainFileID();
+  bool Invalid = false;
+  StringRef Buffer = SM.getBufferData(MainFileID, &Invalid);
+  if (Invalid)
+    return;
+
+  Lexer L(SM.getLocForStartOfFile(MainFileID), LangOpts, Buffer.begin(),
+          Buffer.begin(), Buffer.end());
+  Token Tok;
+  L.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof)) {
+    if (Tok.isNot(tok::hash) || !Tok.isAtStartOfLine()) {
+      L.LexFromRawLexer(Tok);
+      continue;
+    }
+    // A directive runs up to the next token at the start of a line.
+    unsigned Begin = SM.getFileOffset(Tok.getLocation());
+    unsigned End;
+    do {
+      End = SM.getFileOffset(Tok.getLocation()) + Tok.getLength();
+      L.LexFromRawLexer(Tok);
+    } while (Tok.isNot(tok::eof) && !Tok.isAtStartOfLine());
+    H.update(Buffer.slice(Begin, End));
+    H.update("\n");
+  }
+}
+
+FunctionFingerprintStore::FunctionFingerprintStore(StringRef Dir,
+                                                   ASTContext &Ctx,
+                                                   AnalyzerOptions &Opts,
+                                                   const CallGraph &CG)
+    : Ctx(Ctx), Opts(Opts), CG(CG) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  if (!MainFile)
+    return;
+
+  SmallString<128> P(Dir);
+  llvm::sys::path::append(
+      P, getMainFileHashedName(MainFile->getName(), ".fingerprints"));
+  Path = P.str();
+
+  ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> Entry = Line.split(' ');
+    OldFingerprints[Entry.second] = Entry.first;
+  }
+}
+
+void FunctionFingerprintStore::addTopLevelDecl(Decl *D) {
+  // Look into the contexts which just group declarations, so that changing
+  // one function in a namespace doesn't change the context of all the others.
+  if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D)) {
+    for (Decl *Member : cast<DeclContext>(D)->decls())
+      if (!isCodeDecl(Member))
+        addTopLevelDecl(Member);
+    return;
+  }
+
+  const SourceManager &SM = Ctx.getSourceManager();
+  if (!isCodeDecl(D) && SM.isInMainFile(SM.getExpansionLoc(D->getLocStart())))
+    ContextDecls.push_back(D);
+}
+
+bool FunctionFingerprintStore::getTextHash(const Decl *D, std::string &Hash) {
+  auto I = TextHashes.find(D);
+  if (I != TextHashes.end()) {
+    Hash = I->second;
+    return !Hash.empty();
+  }
+
+  // Hash the text of the definition, looking through macro expansions.
+  const SourceManager &SM = Ctx.getSourceManager();
+  const Decl *Def = D;
+  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    const FunctionDecl *FDDef;
+    if (FD->hasBody(FDDef))
+      Def = FDDef;
+  }
+  CharSourceRange Range = CharSourceRange::getTokenRange(
+      SM.getExpansionRange(Def->getSourceRange()));
+  StringRef Text = Lexer::getSourceText(Range, SM, Ctx.getLangOpts());
+  if (!Text.empty()) {
+    llvm::MD5 H;
+    H.update(Text);
+    Hash = getHashString(H);
+  } else {
+    Hash.clear();
+  }
+  TextHashes[D] = Hash;
+  return !Hash.empty();
+}
+
+bool FunctionFingerprintStore::isUnchanged(const Decl *D) {
+  if (Path.empty())
+    return false;
+
+  if (ContextHash.empty()) {
+    llvm::MD5 H;
+    H.update(getClangFullRepositoryVersion());
+    H.update(Ctx.getTargetInfo().getTriple().str());
+    for (const auto &Checker : Opts.CheckersControlList) {
+      H.update(Checker.first);
+      H.update(Checker.second ? "+" : "-");
+    }
+    std::vector<std::pair<StringRef, StringRef>> Config;
+    for (const auto &Option : Opts.Config)
+      Config.push_back(std::make_pair(Option.getKey(), Option.getValue()));
+    std::sort(Config.begin(), Config.end());
+    for (const auto &Option : Config) {
+      H.update(Option.first);
+      H.update("=");
+      H.update(Option.second);
+    }
+
+    // Everything but the main file, which only contributes its directives and
+    // the text of its declarations other than functions.
+    const SourceManager &SM = Ctx.getSourceManager();
+    for (unsigned I = 1, N = SM.local_sloc_entry_size(); I != N; ++I) {
+      const SrcMgr::SLocEntry &SLoc = SM.getLocalSLocEntry(I);
+      if (!SLoc.isFile())
+        continue;
+      const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+      if (Content->OrigEntry &&
+          Content->OrigEntry == SM.getFileEntryForID(SM.getMainFileID()))
+        continue;
+      bool Invalid = false;
+      llvm::MemoryBuffer *Buffer = Content->getBuffer(
+          Ctx.getDiagnostics(), SM, SourceLocation(), &Invalid);
+      if (!Invalid)
+        H.update(Buffer->getBuffer());
+    }
+    hashMainFileDirectives(SM, Ctx.getLangOpts(), H);
+    for (const Decl *CD : ContextDecls) {
+      CharSourceRange Range = CharSourceRange::getTokenRange(
+          SM.getExpansionRange(CD->getSourceRange()));
+      H.update(Lexer::getSourceText(Range, SM, Ctx.getLangOpts()));
+    }
+    ContextHash = getHashString(H);
+  }
+
+  SmallString<128> USR;
+  if (index::generateUSRForDecl(D, USR))
+    return false;
+
+  // Cover the definitions of everything the analysis of D may inline.
+  llvm::MD5 H;
+  H.update(ContextHash);
+  CallGraphNode *Root =
+      CG.getNode(isa<ObjCMethodDecl>(D) ? D : D->getCanonicalDecl());
+  if (!Root)
+    return false;
+  SmallVector<CallGraphNode *, 16> Worklist(1, Root);
+  llvm::DenseSet<CallGraphNode *> Seen;
+  Seen.insert(Root);
+  while (!Worklist.empty()) {
+    CallGraphNode *N = Worklist.pop_back_val();
+    if (!N->getDecl()->hasBody())
+      continue;
+    std::string TextHash;
+    if (!getTextHash(N->getDecl(), TextHash))
+      return false;
+    H.update(TextHash);
+    for (CallGraphNode *Callee : *N)
+      if (Seen.insert(Callee).second)
+        Worklist.push_back(Callee);
+  }
+
+  std::string Fingerprint = getHashString(H);
+  bool Unchanged = OldFingerprints.lookup(USR) == Fingerprint;
+  NewFingerprints[USR] = std::move(Fingerprint);
+  return Unchanged;
+}
+
+void FunctionFingerprintStore::save() const {
+  if (Path.empty())
+    return;
+
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  for (const auto &Entry : NewFingerprints)
+    OS << Entry.getValue() << ' ' << Entry.getKey() << '\n';
+  OS.flush();
+
+  // An interrupted analysis must never leave a partially written file behind.
+  writeFileAtomically(Path, Contents);
+}
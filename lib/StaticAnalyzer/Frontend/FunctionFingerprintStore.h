@@ -0,0 +1,85 @@
+//===-- FunctionFingerprintStore.h ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::FunctionFingerprintStore class,
+/// which lets an analysis skip the functions which haven't changed since the
+/// previous analysis of the same translation unit, through a directory given
+/// with the 'incremental-dir' analyzer option.
+///
+/// The fingerprint of a function covers the source text of its definition
+/// and of the definitions of everything it may inline, as well as the
+/// contents of all the headers, the analyzer configuration, the preprocessor
+/// directives of the main file and the parts of it outside of function
+/// definitions.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_FUNCTIONFINGERPRINTSTORE_H
+#define LLVM_CLANG_SA_FRONTEND_FUNCTIONFINGERPRINTSTORE_H
+
+#include "clang/Analysis/CallGraph.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+
+namespace clang {
+
+class AnalyzerOptions;
+class ASTContext;
+class Decl;
+
+namespace ento {
+
+class FunctionFingerprintStore {
+public:
+  /// Read the fingerprints written by the previous analysis of the main file
+  /// of \p Ctx in \p Dir. \p CG is the call graph of the translation unit.
+  FunctionFingerprintStore(StringRef Dir, ASTContext &Ctx,
+                           AnalyzerOptions &Opts, const CallGraph &CG);
+
+  /// Make the top-level declaration \p D part of the fingerprints.
+  void addTopLevelDecl(Decl *D);
+
+  /// Returns true if the code \p D has the same fingerprint as in the
+  /// previous analysis.
+  bool isUnchanged(const Decl *D);
+
+  /// Write the fingerprints of the code checked by this analysis.
+  void save() const;
+
+private:
+  /// Hash the source text of the definition of \p D, returning false if it
+  /// can't be found.
+  bool getTextHash(const Decl *D, std::string &Hash);
+
+  ASTContext &Ctx;
+  AnalyzerOptions &Opts;
+  std::string Path;
+  const CallGraph &CG;
+
+  /// The hash of everything outside of the function definitions which the
+  /// analysis depends on. This is computed once all top-level declarations
+  /// have been added.
+  std::string ContextHash;
+
+  /// The top-level declarations in the main file which aren't functions.
+  SmallVector<const Decl *, 32> ContextDecls;
+
+  llvm::DenseMap<const Decl *, std::string> TextHashes;
+  llvm::StringMap<std::string> OldFingerprints;
+  llvm::StringMap<std::string> NewFingerprints;
+};
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
@@ -0,0 +1,214 @@
+//===-- FunctionSummaryStore.cpp --------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Implements the sharing of function summaries between the analyses
+/// of different translation units.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FunctionSummaryStore.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/StmtVisitor.h"
+#include "clang/Basic/FileUtilities.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace ento;
+
+static const char SummaryFileExtension[] = ".summaries";
+
+/// Can calls to \p FD share a summary with the definition of \p FD in another
+/// translation unit?
+static bool isSummarizable(const FunctionDecl *FD) {
+  if (!FD->isExternallyVisible() || FD->isDependentContext())
+    return false;
+  // A call to a virtual function may end up in any of its overriders.
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (MD->isVirtual())
+      return false;
+  return true;
+}
+
+static bool getUSR(const Decl *D, SmallVectorImpl<char> &USR) {
+  return !index::generateUSRForDecl(D, USR);
+}
+
+namespace {
+/// Finds anything in a function body which might have an effect visible to
+/// the function's callers, other than its return value.
+class SideEffectFinder : public ConstStmtVisitor<SideEffectFinder, bool> {
+  const llvm::StringSet<> &SideEffectFree;
+
+  /// Is \p E a variable which only lives as long as the call?
+  static bool isLocalVariable(const Expr *E) {
+    if (const auto *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParenImpCasts()))
+      if (const auto *VD = dyn_cast<VarDecl>(DRE->getDecl()))
+        return VD->hasLocalStorage() && !VD->getType()->isReferenceType();
+    return false;
+  }
+
+public:
+  explicit SideEffectFinder(const llvm::StringSet<> &SideEffectFree)
+      : SideEffectFree(SideEffectFree) {}
+
+  bool VisitStmt(const Stmt *S) {
+    for (const Stmt *Child : S->children())
+      if (Child && Visit(Child))
+        return true;
+    return false;
+  }
+
+  bool VisitBinaryOperator(const BinaryOperator *BO) {
+    if (BO->isAssignmentOp() && !isLocalVariable(BO->getLHS()))
+      return true;
+    return VisitStmt(BO);
+  }
+
+  bool VisitUnaryOperator(const UnaryOperator *UO) {
+    if (UO->isIncrementDecrementOp() && !isLocalVariable(UO->getSubExpr()))
+      return true;
+    return VisitStmt(UO);
+  }
+
+  bool VisitDeclRefExpr(const DeclRefExpr *DRE) {
+    return DRE->getType().isVolatileQualified();
+  }
+
+  bool VisitDeclStmt(const DeclStmt *DS) {
+    for (const Decl *D : DS->decls()) {
+      const auto *VD = dyn_cast<VarDecl>(D);
+      if (!VD)
+        continue;
+      if (VD->isStaticLocal())
+        return true;
+      if (const CXXRecordDecl *RD = VD->getType()->getAsCXXRecordDecl())
+        if (RD->hasDefinition() && !RD->hasTrivialDestructor())
+          return true;
+    }
+    return VisitStmt(DS);
+  }
+
+  bool VisitCallExpr(const CallExpr *CE) {
+    const FunctionDecl *Callee = CE->getDirectCallee();
+    if (!Callee)
+      return true;
+    if (!Callee->hasAttr<PureAttr>() && !Callee->hasAttr<ConstAttr>()) {
+      SmallString<128> USR;
+      if (!isSummarizable(Callee) || !getUSR(Callee, USR) ||
+          !SideEffectFree.count(USR))
+        return true;
+    }
+    return VisitStmt(CE);
+  }
+
+  bool VisitCXXConstructExpr(const CXXConstructExpr *CE) {
+    if (!CE->getConstructor()->isTrivial())
+      return true;
+    return VisitStmt(CE);
+  }
+
+  bool VisitCXXNewExpr(const CXXNewExpr *) { return true; }
+  bool VisitCXXDeleteExpr(const CXXDeleteExpr *) { return true; }
+  bool VisitCXXThrowExpr(const CXXThrowExpr *) { return true; }
+  bool VisitAsmStmt(const AsmStmt *) { return true; }
+  bool VisitAtomicExpr(const AtomicExpr *) { return true; }
+  bool VisitObjCMessageExpr(const ObjCMessageExpr *) { return true; }
+};
+} // end anonymous namespace
+
+/// Collect the functions declared in \p DC and the contexts nested in it.
+static void collectFunctions(const DeclContext *DC,
+                             SmallVectorImpl<const FunctionDecl *> &Fns) {
+  for (const Decl *D : DC->decls()) {
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      Fns.push_back(FD);
+    else if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+             isa<CXXRecordDecl>(D))
+      collectFunctions(cast<DeclContext>(D), Fns);
+  }
+}
+
+void FunctionSummaryStore::load(const TranslationUnitDecl *TU,
+                                AnalysisManager &Mgr) {
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator It(Dir, EC), End; It != End && !EC;
+       It.increment(EC)) {
+    StringRef Path = It->path();
+    if (llvm::sys::path::extension(Path) != SummaryFileExtension)
+      continue;
+    ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      continue;
+    SmallVector<StringRef, 64> USRs;
+    (*Buffer)->getBuffer().split(USRs, '\n', /*MaxSplit=*/-1,
+                                 /*KeepEmpty=*/false);
+    for (StringRef USR : USRs)
+      SideEffectFree.insert(USR);
+  }
+  if (SideEffectFree.empty())
+    return;
+
+  // Only calls to functions whose bodies aren't available here use the
+  // summaries, the others are inlined or evaluated conservatively as usual.
+  SmallVector<const FunctionDecl *, 256> Fns;
+  collectFunctions(TU, Fns);
+  for (const FunctionDecl *FD : Fns) {
+    if (FD->hasBody() || !isSummarizable(FD))
+      continue;
+    SmallString<128> USR;
+    if (getUSR(FD, USR) && SideEffectFree.count(USR))
+      Mgr.addSideEffectFreeFunction(FD);
+  }
+}
+
+void FunctionSummaryStore::summarize(const TranslationUnitDecl *TU,
+                                     const SourceManager &SM) {
+  // Functions are summarized in the order they are defined, so that calls to
+  // the side-effect free functions defined earlier don't spoil the summaries
+  // of their callers.
+  SmallVector<const FunctionDecl *, 256> Fns;
+  collectFunctions(TU, Fns);
+  for (const FunctionDecl *FD : Fns) {
+    const Stmt *Body = FD->getBody();
+    if (!Body || !FD->isThisDeclarationADefinition() ||
+        !SM.isInMainFile(FD->getLocation()) || !isSummarizable(FD))
+      continue;
+    if (SideEffectFinder(SideEffectFree).Visit(Body))
+      continue;
+    SmallString<128> USR;
+    if (!getUSR(FD, USR))
+      continue;
+    SideEffectFree.insert(USR);
+    LocalSideEffectFree.push_back(USR.str());
+  }
+}
+
+void FunctionSummaryStore::save(StringRef MainFile) const {
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(
+      Path, getMainFileHashedName(MainFile, SummaryFileExtension));
+
+  std::string Contents;
+  for (const std::string &USR : LocalSideEffectFree)
+    Contents += USR + '\n';
+
+  // Concurrent analyses must never read a partially written summary file.
+  writeFileAtomically(Path, Contents);
+}
@@ -0,0 +1,69 @@
+//===-- FunctionSummaryStore.h ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::FunctionSummaryStore class, which
+/// shares summaries of functions between the analyses of different
+/// translation units through a directory given with the 'summaries-dir'
+/// analyzer option.
+///
+/// The analysis of each translation unit writes one file to the directory,
+/// listing the USRs of the functions it defines whose bodies have no side
+/// effects. Later analyses of translation units which call these functions
+/// without seeing their bodies then don't need to invalidate anything for
+/// such calls.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_FUNCTIONSUMMARYSTORE_H
+#define LLVM_CLANG_SA_FRONTEND_FUNCTIONSUMMARYSTORE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringSet.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class SourceManager;
+class TranslationUnitDecl;
+
+namespace ento {
+class AnalysisManager;
+
+class FunctionSummaryStore {
+public:
+  explicit FunctionSummaryStore(StringRef Dir) : Dir(Dir) {}
+
+  /// Read the summaries written by earlier analyses, and tell \p Mgr about
+  /// the functions declared in \p TU which they found to be free of side
+  /// effects.
+  void load(const TranslationUnitDecl *TU, AnalysisManager &Mgr);
+
+  /// Summarize the functions defined in the main file of \p TU.
+  void summarize(const TranslationUnitDecl *TU, const SourceManager &SM);
+
+  /// Write the summaries of this translation unit's functions, replacing
+  /// those written by an earlier analysis of \p MainFile.
+  void save(StringRef MainFile) const;
+
+private:
+  std::string Dir;
+
+  /// The USRs of the side-effect free functions of earlier analyses.
+  llvm::StringSet<> SideEffectFree;
+
+  /// The USRs of this translation unit's side-effect free functions.
+  std::vector<std::string> LocalSideEffectFree;
+};
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
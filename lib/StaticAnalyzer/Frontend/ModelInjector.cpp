@@ -19,6 +19,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include <utility>
 
 using namespace clang;
@@ -49,6 +50,13 @@ void ModelInjector::onBodySynthesis(const NamedDecl *D) {
   AnalyzerOptionsRef analyzerOpts = CI.getAnalyzerOpts();
   llvm::StringRef modelPath = analyzerOpts->Config["model-path"];
 
+  if (!ModelNamesRead)
+    readModelNames(modelPath);
+  if (!ModelNames.count(D->getName())) {
+    Bodies[D->getName()] = nullptr;
+    return;
+  }
+
   llvm::SmallString<128> fileName;
 
   if (!modelPath.empty())
@@ -57,11 +65,6 @@ void ModelInjector::onBodySynthesis(const NamedDecl *D) {
   else
     fileName = llvm::StringRef(D->getName().str() + ".model");
 
-  if (!llvm::sys::fs::exists(fileName.str())) {
-    Bodies[D->getName()] = nullptr;
-    return;
-  }
-
   IntrusiveRefCntPtr<CompilerInvocation> Invocation(
       new CompilerInvocation(CI.getInvocation()));
 
@@ -114,3 +117,16 @@ void ModelInjector::onBodySynthesis(const NamedDecl *D) {
   // is done.
   SM.setMainFileID(mainFileID);
 }
+
+void ModelInjector::readModelNames(StringRef ModelPath) {
+  ModelNamesRead = true;
+
+  StringRef Dir = ModelPath.empty() ? "." : ModelPath;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Dir, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    StringRef Name = llvm::sys::path::filename(I->path());
+    if (llvm::sys::path::extension(Name) == ".model")
+      ModelNames.insert(llvm::sys::path::stem(Name));
+  }
+}
@@ -26,6 +26,7 @@
 
 #include "clang/Analysis/CodeInjector.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 
 namespace clang {
 
@@ -58,8 +59,17 @@ private:
   /// working directory of the compiler.
   void onBodySynthesis(const NamedDecl *D);
 
+  /// \brief Read the names of the functions which have model files, so that
+  /// the model path doesn't have to be searched for every function without a
+  /// body.
+  void readModelNames(StringRef ModelPath);
+
   CompilerInstance &CI;
 
+  /// The names of the functions which have model files.
+  llvm::StringSet<> ModelNames;
+  bool ModelNamesRead = false;
+
   // FIXME: double memoization is redundant, with memoization both here and in
   // BodyFarm.
   llvm::StringMap<Stmt *> Bodies;
@@ -0,0 +1,377 @@
+//===--- BinaryCompilationDatabase.cpp - ------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file contains the implementation of the BinaryCompilationDatabase.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/BinaryCompilationDatabase.h"
+#include "clang/Basic/FileUtilities.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tooling {
+
+// The file starts with a header of 32-bit little endian fields:
+//   magic, version,
+//   number of strings, offset of the string index,
+//   number of commands, offset of the first command,
+//   number of files, offset of the file list,
+//   offset of the hash table buckets.
+// The string index has an (offset, length) pair for each string, the file
+// list the index of each file's path. A command is the index of its
+// directory, file and output, followed by the number of arguments and their
+// indices. The hash table maps the path of each file to the offsets of its
+// commands. All offsets are from the start of the file.
+static const uint32_t BinaryDatabaseMagic = 0x42444343; // 'CCDB'
+static const uint32_t BinaryDatabaseVersion = 1;
+static const unsigned BinaryDatabaseHeaderSize = 9 * 4;
+
+namespace {
+class BinaryDatabaseTrait {
+public:
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+  typedef StringRef external_key_type;
+  typedef StringRef internal_key_type;
+  typedef std::vector<uint32_t> data_type;
+  typedef const std::vector<uint32_t> &data_type_ref;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static hash_value_type ComputeHash(StringRef Key) {
+    return llvm::HashString(Key);
+  }
+
+  static bool EqualKey(StringRef A, StringRef B) { return A == B; }
+
+  static StringRef GetInternalKey(StringRef Key) { return Key; }
+
+  static std::pair<unsigned, unsigned>
+  EmitKeyDataLength(raw_ostream &Out, StringRef Key, data_type_ref Data) {
+    using namespace llvm::support;
+    endian::Writer<little> LE(Out);
+    unsigned DataLen = Data.size() * 4;
+    LE.write<uint32_t>(Key.size());
+    LE.write<uint32_t>(DataLen);
+    return std::make_pair(Key.size(), DataLen);
+  }
+
+  static void EmitKey(raw_ostream &Out, StringRef Key, unsigned) {
+    Out << Key;
+  }
+
+  static void EmitData(raw_ostream &Out, StringRef, data_type_ref Data,
+                       unsigned) {
+    using namespace llvm::support;
+    for (uint32_t Offset : Data)
+      endian::Writer<little>(Out).write<uint32_t>(Offset);
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char *&D) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint32_t, little, unaligned>(D);
+    unsigned DataLen = endian::readNext<uint32_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static StringRef ReadKey(const unsigned char *D, unsigned KeyLen) {
+    return StringRef(reinterpret_cast<const char *>(D), KeyLen);
+  }
+
+  static data_type ReadData(StringRef, const unsigned char *D,
+                            unsigned DataLen) {
+    using namespace llvm::support;
+    data_type Result;
+    for (; DataLen >= 4; DataLen -= 4)
+      Result.push_back(endian::readNext<uint32_t, little, unaligned>(D));
+    return Result;
+  }
+};
+} // end anonymous namespace
+
+class BinaryCompilationDatabase::OnDiskTable {
+public:
+  typedef llvm::OnDiskChainedHashTable<BinaryDatabaseTrait> TableTy;
+  std::unique_ptr<TableTy> Table;
+
+  explicit OnDiskTable(TableTy *Table) : Table(Table) {}
+};
+
+// Returns the path the commands for \p Command's file are looked up by, the
+// same one JSONCompilationDatabase indexes them by.
+static void getNativeFilePath(const CompileCommand &Command,
+                              SmallVectorImpl<char> &NativeFilePath) {
+  if (llvm::sys::path::is_relative(Command.Filename)) {
+    SmallString<128> AbsolutePath(Command.Directory);
+    llvm::sys::path::append(AbsolutePath, Command.Filename);
+    llvm::sys::path::native(AbsolutePath, NativeFilePath);
+  } else {
+    llvm::sys::path::native(Command.Filename, NativeFilePath);
+  }
+}
+
+BinaryCompilationDatabase::BinaryCompilationDatabase(
+    std::unique_ptr<llvm::MemoryBuffer> Buffer,
+    std::unique_ptr<OnDiskTable> Table)
+    : Buffer(std::move(Buffer)), Table(std::move(Table)) {}
+
+BinaryCompilationDatabase::~BinaryCompilationDatabase() {}
+
+std::unique_ptr<BinaryCompilationDatabase>
+BinaryCompilationDatabase::loadFromFile(StringRef FilePath,
+                                        std::string &ErrorMessage) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(FilePath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (std::error_code Result = BufferOrErr.getError()) {
+    ErrorMessage = "Error while opening binary database: " + Result.message();
+    return nullptr;
+  }
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(*BufferOrErr);
+
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  size_t Size = Buffer->getBufferSize();
+  if (Size < BinaryDatabaseHeaderSize ||
+      endian::read32le(Base) != BinaryDatabaseMagic ||
+      endian::read32le(Base + 4) != BinaryDatabaseVersion) {
+    ErrorMessage = "Not a binary compilation database.";
+    return nullptr;
+  }
+  uint64_t NumStrings = endian::read32le(Base + 8);
+  uint64_t StringIndexOffset = endian::read32le(Base + 12);
+  uint64_t NumFiles = endian::read32le(Base + 24);
+  uint64_t FilesOffset = endian::read32le(Base + 28);
+  uint64_t BucketOffset = endian::read32le(Base + 32);
+  if (StringIndexOffset + NumStrings * 8 > Size ||
+      FilesOffset + NumFiles * 4 > Size || BucketOffset >= Size) {
+    ErrorMessage = "Truncated binary compilation database.";
+    return nullptr;
+  }
+
+  auto Table = llvm::make_unique<OnDiskTable>(
+      OnDiskTable::TableTy::Create(Base + BucketOffset, Base));
+  return std::unique_ptr<BinaryCompilationDatabase>(
+      new BinaryCompilationDatabase(std::move(Buffer), std::move(Table)));
+}
+
+StringRef BinaryCompilationDatabase::getString(uint32_t Index) const {
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  if (Index >= endian::read32le(Base + 8))
+    return StringRef();
+  const unsigned char *Entry = Base + endian::read32le(Base + 12) + Index * 8;
+  uint64_t Offset = endian::read32le(Entry);
+  uint64_t Length = endian::read32le(Entry + 4);
+  if (Offset + Length > Buffer->getBufferSize())
+    return StringRef();
+  return StringRef(Buffer->getBufferStart() + Offset, Length);
+}
+
+CompileCommand BinaryCompilationDatabase::readCommand(uint32_t Offset) const {
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  size_t Size = Buffer->getBufferSize();
+  if (uint64_t(Offset) + 16 > Size)
+    return CompileCommand();
+  const unsigned char *D = Base + Offset;
+  auto Next = [&D] { return endian::readNext<uint32_t, little, unaligned>(D); };
+  StringRef Directory = getString(Next());
+  StringRef Filename = getString(Next());
+  StringRef Output = getString(Next());
+  uint64_t NumArgs = Next();
+  std::vector<std::string> CommandLine;
+  if (uint64_t(Offset) + 16 + NumArgs * 4 <= Size)
+    for (uint64_t I = 0; I != NumArgs; ++I)
+      CommandLine.push_back(getString(Next()));
+  return CompileCommand(Directory, Filename, std::move(CommandLine), Output);
+}
+
+std::vector<CompileCommand>
+BinaryCompilationDatabase::getCompileCommands(StringRef FilePath) const {
+  SmallString<128> NativeFilePath;
+  llvm::sys::path::native(FilePath, NativeFilePath);
+
+  std::vector<CompileCommand> Commands;
+  auto Entry = Table->Table->find(NativeFilePath.str());
+  if (Entry == Table->Table->end())
+    return Commands;
+  for (uint32_t Offset : *Entry)
+    Commands.push_back(readCommand(Offset));
+  return Commands;
+}
+
+std::vector<std::string> BinaryCompilationDatabase::getAllFiles() const {
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  uint32_t NumFiles = endian::read32le(Base + 24);
+  const unsigned char *D = Base + endian::read32le(Base + 28);
+
+  std::vector<std::string> Files;
+  for (uint32_t I = 0; I != NumFiles; ++I)
+    Files.push_back(
+        getString(endian::readNext<uint32_t, little, unaligned>(D)));
+  return Files;
+}
+
+std::vector<CompileCommand>
+BinaryCompilationDatabase::getAllCompileCommands() const {
+  using namespace llvm::support;
+  const unsigned char *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  uint32_t NumCommands = endian::read32le(Base + 16);
+  uint64_t Offset = endian::read32le(Base + 20);
+
+  std::vector<CompileCommand> Commands;
+  for (uint32_t I = 0; I != NumCommands; ++I) {
+    if (Offset + 16 > Buffer->getBufferSize())
+      break;
+    uint32_t NumArgs = endian::read32le(Base + Offset + 12);
+    Commands.push_back(readCommand(Offset));
+    Offset += 16 + uint64_t(NumArgs) * 4;
+  }
+  return Commands;
+}
+
+bool BinaryCompilationDatabase::writeToFile(const CompilationDatabase &Database,
+                                            StringRef FilePath,
+                                            std::string &ErrorMessage) {
+  std::vector<CompileCommand> Commands = Database.getAllCompileCommands();
+
+  // Give every distinct string an index.
+  llvm::StringMap<uint32_t> StringIndices;
+  std::vector<StringRef> Strings;
+  auto Intern = [&](StringRef S) {
+    auto Inserted = StringIndices.insert(std::make_pair(S, Strings.size()));
+    if (Inserted.second)
+      Strings.push_back(Inserted.first->getKey());
+    return Inserted.first->getValue();
+  };
+  std::vector<uint32_t> FileIndices;
+  std::vector<std::string> FilePaths;
+  llvm::StringSet<> SeenFiles;
+  for (const CompileCommand &Command : Commands) {
+    Intern(Command.Directory);
+    Intern(Command.Filename);
+    Intern(Command.Output);
+    for (const std::string &Argument : Command.CommandLine)
+      Intern(Argument);
+    SmallString<128> NativeFilePath;
+    getNativeFilePath(Command, NativeFilePath);
+    FilePaths.push_back(NativeFilePath.str());
+    uint32_t FileIndex = Intern(NativeFilePath);
+    if (SeenFiles.insert(NativeFilePath).second)
+      FileIndices.push_back(FileIndex);
+  }
+
+  std::string Contents;
+  uint32_t StringIndexOffset, CommandsOffset, FilesOffset, BucketOffset;
+  {
+    using namespace llvm::support;
+    llvm::raw_string_ostream Out(Contents);
+    endian::Writer<little> LE(Out);
+    LE.write<uint32_t>(BinaryDatabaseMagic);
+    LE.write<uint32_t>(BinaryDatabaseVersion);
+    // Placeholders for the counts and offsets, patched below.
+    for (unsigned I = 2; I != BinaryDatabaseHeaderSize / 4; ++I)
+      LE.write<uint32_t>(0);
+
+    std::vector<uint32_t> StringOffsets;
+    for (StringRef S : Strings) {
+      StringOffsets.push_back(Out.tell());
+      Out << S;
+    }
+    StringIndexOffset = Out.tell();
+    for (unsigned I = 0, E = Strings.size(); I != E; ++I) {
+      LE.write<uint32_t>(StringOffsets[I]);
+      LE.write<uint32_t>(Strings[I].size());
+    }
+
+    CommandsOffset = Out.tell();
+    llvm::StringMap<std::vector<uint32_t>> CommandsByFile;
+    for (unsigned I = 0, E = Commands.size(); I != E; ++I) {
+      const CompileCommand &Command = Commands[I];
+      CommandsByFile[FilePaths[I]].push_back(Out.tell());
+      LE.write<uint32_t>(StringIndices[Command.Directory]);
+      LE.write<uint32_t>(StringIndices[Command.Filename]);
+      LE.write<uint32_t>(StringIndices[Command.Output]);
+      LE.write<uint32_t>(Command.CommandLine.size());
+      for (const std::string &Argument : Command.CommandLine)
+        LE.write<uint32_t>(StringIndices[Argument]);
+    }
+
+    FilesOffset = Out.tell();
+    for (uint32_t FileIndex : FileIndices)
+      LE.write<uint32_t>(FileIndex);
+
+    llvm::OnDiskChainedHashTableGenerator<BinaryDatabaseTrait> Generator;
+    for (const auto &Entry : CommandsByFile)
+      Generator.insert(Entry.getKey(), Entry.getValue());
+    BucketOffset = Generator.Emit(Out);
+  }
+  using namespace llvm::support;
+  char *Header = &Contents[0];
+  endian::write32le(Header + 8, Strings.size());
+  endian::write32le(Header + 12, StringIndexOffset);
+  endian::write32le(Header + 16, Commands.size());
+  endian::write32le(Header + 20, CommandsOffset);
+  endian::write32le(Header + 24, FileIndices.size());
+  endian::write32le(Header + 28, FilesOffset);
+  endian::write32le(Header + 32, BucketOffset);
+
+  // Concurrent readers see either the old or the new database.
+  if (std::error_code EC = writeFileAtomically(FilePath, Contents)) {
+    ErrorMessage = "Error while writing binary database: " + EC.message();
+    return true;
+  }
+  return false;
+}
+
+std::unique_ptr<BinaryCompilationDatabase>
+BinaryCompilationDatabase::loadFromDirectory(StringRef Directory,
+                                             std::string &ErrorMessage) {
+  SmallString<1024> BinaryDatabasePath(Directory);
+  llvm::sys::path::append(BinaryDatabasePath, "compile_commands.bin");
+  llvm::sys::fs::file_status BinaryStatus;
+  if (llvm::sys::fs::status(BinaryDatabasePath, BinaryStatus) ||
+      !llvm::sys::fs::exists(BinaryStatus)) {
+    ErrorMessage = "No binary compilation database found.";
+    return nullptr;
+  }
+
+  // Leave an outdated binary database to the JSON one it was written from.
+  SmallString<1024> JSONDatabasePath(Directory);
+  llvm::sys::path::append(JSONDatabasePath, "compile_commands.json");
+  llvm::sys::fs::file_status JSONStatus;
+  if (!llvm::sys::fs::status(JSONDatabasePath, JSONStatus) &&
+      JSONStatus.getLastModificationTime() >
+          BinaryStatus.getLastModificationTime()) {
+    ErrorMessage = "Binary compilation database is older than "
+                   "compile_commands.json.";
+    return nullptr;
+  }
+
+  return loadFromFile(BinaryDatabasePath, ErrorMessage);
+}
+
+} // end namespace tooling
+} // end namespace clang
@@ -114,6 +114,10 @@ CommonOptionsParser::CommonOptionsParser(
       cl::desc("Additional argument to prepend to the compiler command line"),
       cl::cat(Category));
 
+  static cl::opt<unsigned> Threads(
+      "j", cl::desc("Number of translation units to process concurrently"),
+      cl::init(1), cl::cat(Category));
+
   cl::HideUnrelatedOptions(Category);
 
   Compilations.reset(FixedCompilationDatabase::loadFromCommandLine(argc, argv));
@@ -121,6 +125,7 @@ CommonOptionsParser::CommonOptionsParser(
   cl::PrintOptionValues();
 
   SourcePathList = SourcePaths;
+  NumThreads = Threads;
   if ((OccurrencesFlag == cl::ZeroOrMore || OccurrencesFlag == cl::Optional) &&
       SourcePathList.empty())
     return;
@@ -323,6 +323,44 @@ llvm::Error Replacements::add(const Replacement &R) {
   return llvm::Error::success();
 }
 
+llvm::Error Replacements::addAll(std::vector<Replacement> NewReplaces) {
+  std::sort(NewReplaces.begin(), NewReplaces.end());
+  if (!Replaces.empty()) {
+    for (const auto &R : NewReplaces)
+      if (llvm::Error Err = add(R))
+        return Err;
+    return llvm::Error::success();
+  }
+
+  // Append the replacements that neither overlap with one before them nor
+  // are insertions at the offset of the insertion before them; those are
+  // left to add() to check for conflicts and merge.
+  unsigned End = 0;
+  for (const auto &R : NewReplaces) {
+    if (!Replaces.empty()) {
+      const Replacement &Last = *Replaces.rbegin();
+      if (R.getFilePath() != Last.getFilePath())
+        return llvm::make_error<ReplacementError>(
+            replacement_error::wrong_file_path, R, *Replaces.begin());
+      bool Appendable =
+          R.getOffset() != UINT_MAX && R.getOffset() >= End &&
+          !(R.getLength() == 0 && Last.getLength() == 0 &&
+            R.getOffset() == Last.getOffset());
+      if (!Appendable) {
+        if (llvm::Error Err = add(R))
+          return Err;
+        if (R.getOffset() != UINT_MAX)
+          End = std::max(End, R.getOffset() + R.getLength());
+        continue;
+      }
+    }
+    Replaces.insert(Replaces.end(), R);
+    if (R.getOffset() != UINT_MAX)
+      End = R.getOffset() + R.getLength();
+  }
+  return llvm::Error::success();
+}
+
 namespace {
 
 // Represents a merged replacement, i.e. a replacement consisting of multiple
@@ -454,7 +492,8 @@ Replacements Replacements::merge(const Replacements &ReplacesToMerge) const {
       ++I;
     }
     Delta -= Merged.deltaFirst();
-    Result.insert(Merged.asReplacement());
+    // Merged replacements are produced in order.
+    Result.insert(Result.end(), Merged.asReplacement());
   }
   return Replacements(Result.begin(), Result.end());
 }
@@ -555,29 +594,32 @@ llvm::Expected<std::string> applyAllReplacements(StringRef Code,
   if (Replaces.empty())
     return Code.str();
 
-  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
-      new vfs::InMemoryFileSystem);
-  FileManager Files(FileSystemOptions(), InMemoryFileSystem);
-  DiagnosticsEngine Diagnostics(
-      IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
-      new DiagnosticOptions);
-  SourceManager SourceMgr(Diagnostics, Files);
-  Rewriter Rewrite(SourceMgr, LangOptions());
-  InMemoryFileSystem->addFile(
-      "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
-  FileID ID = SourceMgr.createFileID(Files.getFile("<stdin>"), SourceLocation(),
-                                     clang::SrcMgr::C_User);
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
+  // The replacements are sorted and don't overlap, so the new code can be
+  // built in a single pass over the old one. An insertion is ordered before a
+  // replacement at the same offset, and so ends up in front of its text.
+  // Check every replacement before sizing the result, so that the size can't
+  // wrap around.
+  size_t NewSize = Code.size();
+  unsigned Pos = 0;
+  for (const auto &R : Replaces) {
+    if (R.getOffset() < Pos || R.getOffset() > Code.size() ||
+        R.getLength() > Code.size() - R.getOffset())
       return llvm::make_error<ReplacementError>(
-          replacement_error::fail_to_apply, Replace);
+          replacement_error::fail_to_apply,
+          Replacement("<stdin>", R.getOffset(), R.getLength(),
+                      R.getReplacementText()));
+    NewSize = NewSize - R.getLength() + R.getReplacementText().size();
+    Pos = R.getOffset() + R.getLength();
   }
   std::string Result;
-  llvm::raw_string_ostream OS(Result);
-  Rewrite.getEditBuffer(ID).write(OS);
-  OS.flush();
+  Result.reserve(NewSize);
+  Pos = 0;
+  for (const auto &R : Replaces) {
+    Result.append(Code.data() + Pos, R.getOffset() - Pos);
+    Result += R.getReplacementText();
+    Pos = R.getOffset() + R.getLength();
+  }
+  Result.append(Code.data() + Pos, Code.size() - Pos);
   return Result;
 }
 
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "clang/Tooling/BinaryCompilationDatabase.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/CompilationDatabasePluginRegistry.h"
 #include "clang/Tooling/Tooling.h"
@@ -144,6 +145,15 @@ std::vector<std::string> unescapeCommandLine(JSONCommandLineSyntax Syntax,
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
   std::unique_ptr<CompilationDatabase>
   loadFromDirectory(StringRef Directory, std::string &ErrorMessage) override {
+    // A binary database written from the JSON one is read in its place. It is
+    // tried here rather than by a plugin of its own, whose precedence would
+    // depend on the order the plugins were registered in.
+    std::string BinaryErrorMessage;
+    if (std::unique_ptr<CompilationDatabase> BinaryDatabase =
+            BinaryCompilationDatabase::loadFromDirectory(Directory,
+                                                         BinaryErrorMessage))
+      return BinaryDatabase;
+
     SmallString<1024> JSONDatabasePath(Directory);
     llvm::sys::path::append(JSONDatabasePath, "compile_commands.json");
     std::unique_ptr<CompilationDatabase> Database(
@@ -237,37 +247,60 @@ JSONCompilationDatabase::getAllCompileCommands() const {
   return Commands;
 }
 
-static std::vector<std::string>
-nodeToCommandLine(JSONCommandLineSyntax Syntax,
-                  const std::vector<llvm::yaml::ScalarNode *> &Nodes) {
-  SmallString<1024> Storage;
-  if (Nodes.size() == 1) {
-    return unescapeCommandLine(Syntax, Nodes[0]->getValue(Storage));
-  }
-  std::vector<std::string> Arguments;
-  for (auto *Node : Nodes) {
-    Arguments.push_back(Node->getValue(Storage));
+// Decodes the scalars \p RawValues, as written in the database file, into
+// \p Values. They are parsed together as a flow sequence, which decodes them
+// just like the database file itself did.
+static void decodeScalars(ArrayRef<StringRef> RawValues,
+                          std::vector<std::string> &Values) {
+  std::string Sequence = "[";
+  for (StringRef RawValue : RawValues) {
+    if (Sequence.size() > 1)
+      Sequence += ", ";
+    Sequence += RawValue;
   }
-  return Arguments;
+  Sequence += "]";
+
+  llvm::SourceMgr SM;
+  llvm::yaml::Stream YAMLStream(Sequence, SM);
+  auto *Array =
+      dyn_cast_or_null<llvm::yaml::SequenceNode>(YAMLStream.begin()->getRoot());
+  assert(Array && "scalars checked when parsing the database");
+  SmallString<32> Storage;
+  for (auto &Node : *Array)
+    Values.push_back(cast<llvm::yaml::ScalarNode>(Node).getValue(Storage));
 }
 
 void JSONCompilationDatabase::getCommands(
     ArrayRef<CompileCommandRef> CommandsRef,
     std::vector<CompileCommand> &Commands) const {
-  for (int I = 0, E = CommandsRef.size(); I != E; ++I) {
-    SmallString<8> DirectoryStorage;
-    SmallString<32> FilenameStorage;
-    SmallString<32> OutputStorage;
-    auto Output = std::get<3>(CommandsRef[I]);
-    Commands.emplace_back(
-        std::get<0>(CommandsRef[I])->getValue(DirectoryStorage),
-        std::get<1>(CommandsRef[I])->getValue(FilenameStorage),
-        nodeToCommandLine(Syntax, std::get<2>(CommandsRef[I])),
-        Output ? Output->getValue(OutputStorage) : "");
+  for (const CompileCommandRef &CommandRef : CommandsRef) {
+    StringRef Output = std::get<3>(CommandRef);
+    const std::vector<StringRef> &CommandLine = std::get<2>(CommandRef);
+    SmallVector<StringRef, 64> RawValues;
+    RawValues.push_back(std::get<0>(CommandRef));
+    RawValues.push_back(std::get<1>(CommandRef));
+    if (!Output.empty())
+      RawValues.push_back(Output);
+    RawValues.append(CommandLine.begin(), CommandLine.end());
+
+    std::vector<std::string> Values;
+    decodeScalars(RawValues, Values);
+    auto Arguments = Values.begin() + (Output.empty() ? 2 : 3);
+    std::vector<std::string> CommandLineValues;
+    if (CommandLine.size() == 1)
+      CommandLineValues = unescapeCommandLine(Syntax, *Arguments);
+    else
+      CommandLineValues.assign(Arguments, Values.end());
+    Commands.emplace_back(Values[0], Values[1], std::move(CommandLineValues),
+                          Output.empty() ? "" : Values[2]);
   }
 }
 
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
+  // The stream, with all of its nodes, only lives while the database is
+  // indexed; the index refers to the database buffer itself.
+  llvm::SourceMgr SM;
+  llvm::yaml::Stream YAMLStream(Database->getBuffer(), SM);
   llvm::yaml::document_iterator I = YAMLStream.begin();
   if (I == YAMLStream.end()) {
     ErrorMessage = "Error while parsing YAML.";
@@ -290,7 +323,7 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
       return false;
     }
     llvm::yaml::ScalarNode *Directory = nullptr;
-    llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
+    llvm::Optional<std::vector<StringRef>> Command;
     llvm::yaml::ScalarNode *File = nullptr;
     llvm::yaml::ScalarNode *Output = nullptr;
     for (auto& NextKeyValue : *Object) {
@@ -321,18 +354,18 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
       if (KeyValue == "directory") {
         Directory = ValueString;
       } else if (KeyValue == "arguments") {
-        Command = std::vector<llvm::yaml::ScalarNode *>();
+        Command = std::vector<StringRef>();
         for (auto &Argument : *SequenceString) {
           auto Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
           if (!Scalar) {
             ErrorMessage = "Only strings are allowed in 'arguments'.";
             return false;
           }
-          Command->push_back(Scalar);
+          Command->push_back(Scalar->getRawValue());
         }
       } else if (KeyValue == "command") {
         if (!Command)
-          Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
+          Command = std::vector<StringRef>(1, ValueString->getRawValue());
       } else if (KeyValue == "file") {
         File = ValueString;
       } else if (KeyValue == "output") {
@@ -367,7 +400,9 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
     } else {
       llvm::sys::path::native(FileName, NativeFilePath);
     }
-    auto Cmd = CompileCommandRef(Directory, File, *Command, Output);
+    auto Cmd = CompileCommandRef(Directory->getRawValue(), File->getRawValue(),
+                                 *Command,
+                                 Output ? Output->getRawValue() : StringRef());
     IndexByFile[NativeFilePath].push_back(Cmd);
     AllCommands.push_back(Cmd);
     MatchTrie.insert(NativeFilePath);
@@ -19,21 +19,51 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_os_ostream.h"
 
 namespace clang {
 namespace tooling {
 
+/// The replacements of the translation unit which the current thread is
+/// processing as part of a parallel run.
+static LLVM_THREAD_LOCAL std::map<std::string, Replacements>
+    *JobReplacesOnThread;
+
 RefactoringTool::RefactoringTool(
     const CompilationDatabase &Compilations, ArrayRef<std::string> SourcePaths,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps)
     : ClangTool(Compilations, SourcePaths, PCHContainerOps) {}
 
 std::map<std::string, Replacements> &RefactoringTool::getReplacements() {
+  if (JobReplacesOnThread)
+    return *JobReplacesOnThread;
   return FileToReplaces;
 }
 
+void RefactoringTool::beginParallelRun(unsigned NumJobs) {
+  JobReplaces.clear();
+  JobReplaces.resize(NumJobs);
+}
+
+void RefactoringTool::beginParallelJob(unsigned Job) {
+  JobReplacesOnThread = &JobReplaces[Job];
+}
+
+void RefactoringTool::endParallelRun() {
+  for (const auto &Replaces : JobReplaces) {
+    for (const auto &FileAndReplaces : Replaces) {
+      Replacements &Merged = FileToReplaces[FileAndReplaces.first];
+      for (const Replacement &R : FileAndReplaces.second)
+        if (llvm::Error Err = Merged.add(R))
+          llvm::errs() << "Skipping replacement: "
+                       << llvm::toString(std::move(Err)) << "\n";
+    }
+  }
+  JobReplaces.clear();
+}
+
 int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   if (int Result = run(ActionFactory)) {
     return Result;
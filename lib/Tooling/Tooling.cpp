@@ -13,6 +13,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/Tooling.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/FileUtilities.h"
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/Options.h"
@@ -20,12 +22,17 @@
 #include "clang/Driver/ToolChain.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/Option.h"
@@ -33,7 +40,11 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <utility>
 
 #define DEBUG_TYPE "clang-tooling"
@@ -275,6 +286,12 @@ bool ToolInvocation::run() {
     Invocation->getPreprocessorOpts().addRemappedFile(It.getKey(),
                                                       Input.release());
   }
+  // Remapped files are only visible to this invocation, so header search
+  // results that could depend on them are not shared with others.
+  const PreprocessorOptions &PPOpts = Invocation->getPreprocessorOpts();
+  if (SharedLookupCache && PPOpts.RemappedFiles.empty() &&
+      PPOpts.RemappedFileBuffers.empty())
+    Invocation->getHeaderSearchOpts().SharedLookupCache = SharedLookupCache;
   return runInvocation(BinaryName, Compilation.get(), Invocation.release(),
                        std::move(PCHContainerOps));
 }
@@ -329,7 +346,8 @@ ClangTool::ClangTool(const CompilationDatabase &Compilations,
       OverlayFileSystem(new vfs::OverlayFileSystem(vfs::getRealFileSystem())),
       InMemoryFileSystem(new vfs::InMemoryFileSystem),
       Files(new FileManager(FileSystemOptions(), OverlayFileSystem)),
-      DiagConsumer(nullptr) {
+      LookupCache(std::make_shared<SharedLookupFileCache>()),
+      DiagConsumer(nullptr), NumThreads(1) {
   OverlayFileSystem->pushOverlay(InMemoryFileSystem);
   appendArgumentsAdjuster(getClangStripOutputAdjuster());
   appendArgumentsAdjuster(getClangSyntaxOnlyAdjuster());
@@ -353,6 +371,10 @@ void ClangTool::clearArgumentsAdjusters() {
   ArgsAdjuster = nullptr;
 }
 
+void ClangTool::setSharedPCHDirectory(StringRef Directory) {
+  SharedPCHDirectory = getAbsolutePath(Directory);
+}
+
 static void injectResourceDir(CommandLineArguments &Args, const char *Argv0,
                               void *MainAddr) {
   // Allow users to override the resource dir.
@@ -365,7 +387,237 @@ static void injectResourceDir(CommandLineArguments &Args, const char *Argv0,
                  CompilerInvocation::GetResourcesPath(Argv0, MainAddr));
 }
 
+namespace {
+
+/// \brief A precompiled header of the system headers that the main files of
+/// a group of compile commands all start with.
+class SharedPCH {
+  std::string Fingerprint;
+  std::vector<std::string> Includes;
+  unsigned NumCommands = 0;
+  std::once_flag Built;
+  std::string PCHPath;
+
+  /// \brief Returns the name of the header and precompiled header in the
+  /// directory. It covers the include list as well as the options, so that
+  /// tools sharing the directory never build different headers under the
+  /// same name.
+  std::string getName() const {
+    return getHashedFileName(
+        "shared",
+        llvm::utohexstr(llvm::hash_combine(
+            Fingerprint,
+            llvm::hash_combine_range(Includes.begin(), Includes.end()))));
+  }
+
+  /// \brief Writes the header at \p HeaderPath, unless it is already there.
+  ///
+  /// The header is written atomically, so that another tool never sees it
+  /// partially written. Its name determines its contents, so an existing one
+  /// is left alone rather than replaced under a precompiled header that may
+  /// have been built from it.
+  bool writeHeader(StringRef HeaderPath) const {
+    if (llvm::sys::fs::exists(HeaderPath))
+      return true;
+    std::string Contents;
+    for (const std::string &Include : Includes)
+      Contents += Include + "\n";
+    return !writeFileAtomically(HeaderPath, Contents);
+  }
+
+public:
+  explicit SharedPCH(std::string Fingerprint)
+      : Fingerprint(std::move(Fingerprint)) {}
+
+  /// \brief Adds a command whose main file starts with \p CommandIncludes to
+  /// the group, keeping only the includes all commands have in common.
+  void addCommand(const std::vector<std::string> &CommandIncludes) {
+    if (NumCommands++ == 0) {
+      Includes = CommandIncludes;
+      return;
+    }
+    size_t Common = 0;
+    while (Common < Includes.size() && Common < CommandIncludes.size() &&
+           Includes[Common] == CommandIncludes[Common])
+      ++Common;
+    Includes.resize(Common);
+  }
+
+  bool isWorthBuilding() const { return NumCommands > 1 && !Includes.empty(); }
+
+  /// \brief Returns the path of the precompiled header, building it with the
+  /// options of \p Invocation the first time, or an empty string if it could
+  /// not be built.
+  StringRef get(StringRef Directory, const CompilerInvocation &Invocation,
+                FileManager *Files,
+                std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
+    std::call_once(Built, [&] {
+      std::string Name = getName();
+      SmallString<128> HeaderPath(Directory);
+      llvm::sys::path::append(HeaderPath, Name + ".h");
+      if (!writeHeader(HeaderPath))
+        return;
+      // GeneratePCHAction writes through a temporary file too.
+      SmallString<128> OutputPath(Directory);
+      llvm::sys::path::append(OutputPath, Name + ".pch");
+
+      CompilerInvocation *PCHInvocation = new CompilerInvocation(Invocation);
+      FrontendOptions &FrontendOpts = PCHInvocation->getFrontendOpts();
+      InputKind Kind = FrontendOpts.Inputs[0].getKind();
+      FrontendOpts.Inputs.clear();
+      FrontendOpts.Inputs.push_back(FrontendInputFile(HeaderPath, Kind));
+      FrontendOpts.OutputFile = OutputPath.str();
+      FrontendOpts.ProgramAction = frontend::GeneratePCH;
+      PCHInvocation->getDependencyOutputOpts() = DependencyOutputOptions();
+
+      CompilerInstance Compiler(std::move(PCHContainerOps));
+      Compiler.setInvocation(PCHInvocation);
+      Compiler.setFileManager(Files);
+      // Errors in the shared headers are reported by the translation units.
+      IgnoringDiagConsumer IgnoreDiagnostics;
+      Compiler.createDiagnostics(&IgnoreDiagnostics, /*ShouldOwnClient=*/false);
+      Compiler.createSourceManager(*Files);
+      GeneratePCHAction Action;
+      bool Success = Compiler.ExecuteAction(Action) &&
+                     !Compiler.getDiagnostics().hasErrorOccurred();
+      Files->clearStatCaches();
+      if (Success)
+        PCHPath = OutputPath.str();
+    });
+    return PCHPath;
+  }
+};
+
+/// \brief The shared precompiled headers of all groups of compile commands.
+class SharedPCHs {
+  std::map<std::string, SharedPCH> Groups;
+
+public:
+  void addCommand(const std::string &Fingerprint,
+                  const std::vector<std::string> &Includes) {
+    auto Group = Groups.find(Fingerprint);
+    if (Group == Groups.end())
+      Group = Groups.emplace(std::piecewise_construct,
+                             std::forward_as_tuple(Fingerprint),
+                             std::forward_as_tuple(Fingerprint)).first;
+    Group->second.addCommand(Includes);
+  }
+
+  SharedPCH *lookup(const std::string &Fingerprint) {
+    auto Group = Groups.find(Fingerprint);
+    if (Group == Groups.end() || !Group->second.isWorthBuilding())
+      return nullptr;
+    return &Group->second;
+  }
+};
+
+/// \brief Makes the invocations of a \c ToolAction load a shared precompiled
+/// header, building it first if needed.
+class SharedPCHAction : public ToolAction {
+  ToolAction &Action;
+  StringRef Directory;
+  SharedPCH &PCH;
+
+public:
+  SharedPCHAction(ToolAction &Action, StringRef Directory, SharedPCH &PCH)
+      : Action(Action), Directory(Directory), PCH(PCH) {}
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    PreprocessorOptions &PPOpts = Invocation->getPreprocessorOpts();
+    if (PPOpts.ImplicitPCHInclude.empty() && PPOpts.Includes.empty()) {
+      StringRef PCHPath =
+          PCH.get(Directory, *Invocation, Files, PCHContainerOps);
+      if (!PCHPath.empty())
+        PPOpts.ImplicitPCHInclude = PCHPath;
+    }
+    return Action.runInvocation(Invocation, Files, std::move(PCHContainerOps),
+                                DiagConsumer);
+  }
+};
+
+} // end anonymous namespace
+
+/// \brief Returns the key under which compile commands that only differ in
+/// the file they compile and the files they write are grouped.
+static std::string getCommandFingerprint(const CompileCommand &Command) {
+  std::string Fingerprint = Command.Directory;
+  ArrayRef<std::string> CommandLine = Command.CommandLine;
+  for (size_t I = 0, E = CommandLine.size(); I != E; ++I) {
+    StringRef Arg = CommandLine[I];
+    if (Arg == Command.Filename)
+      continue;
+    if (Arg == "-o" || Arg == "-MF" || Arg == "-MT" || Arg == "-MQ") {
+      ++I;
+      continue;
+    }
+    Fingerprint += '\0';
+    Fingerprint += Arg;
+  }
+  return Fingerprint;
+}
+
+/// \brief Returns the '#include <...>' directives that \p Code starts with,
+/// up to the first other directive or declaration.
+static std::vector<std::string> getLeadingSystemIncludes(StringRef Code) {
+  std::vector<std::string> Includes;
+  Code = Code.substr(0, Lexer::ComputePreamble(Code, LangOptions()).first);
+  SmallVector<StringRef, 32> Lines;
+  Code.split(Lines, '\n');
+  for (StringRef Line : Lines) {
+    Line = Line.trim();
+    // The preamble only holds directives, comments and blank lines.
+    if (!Line.startswith("#"))
+      continue;
+    Line = Line.drop_front().ltrim();
+    StringRef Directive = Line.substr(0, Line.find_first_of(" \t<\""));
+    if (Directive != "include" && Directive != "import")
+      break;
+    StringRef Target = Line.substr(Directive.size()).ltrim();
+    size_t End = Target.find('>');
+    if (!Target.startswith("<") || End == StringRef::npos)
+      break;
+    Includes.push_back(
+        ("#" + Directive + " " + Target.substr(0, End + 1)).str());
+  }
+  return Includes;
+}
+
+/// \brief Groups the compile commands of \p SourcePaths for sharing
+/// precompiled headers.
+static void
+collectSharedPCHs(const CompilationDatabase &Compilations,
+                  ArrayRef<std::string> SourcePaths, FileManager &Files,
+                  ArrayRef<std::pair<StringRef, StringRef>> MappedFileContents,
+                  SharedPCHs &PCHs) {
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty())
+      continue;
+
+    std::vector<std::string> Includes;
+    auto Mapped = std::find_if(
+        MappedFileContents.begin(), MappedFileContents.end(),
+        [&](const std::pair<StringRef, StringRef> &MappedFile) {
+          return MappedFile.first == File;
+        });
+    if (Mapped != MappedFileContents.end()) {
+      Includes = getLeadingSystemIncludes(Mapped->second);
+    } else if (auto Buffer = Files.getBufferForFile(File)) {
+      Includes = getLeadingSystemIncludes((*Buffer)->getBuffer());
+    }
+    for (const CompileCommand &CompileCommand : CompileCommandsForFile)
+      PCHs.addCommand(getCommandFingerprint(CompileCommand), Includes);
+  }
+}
+
 int ClangTool::run(ToolAction *Action) {
+  if (NumThreads > 1)
+    return runInParallel(Action);
+
   // Exists solely for the purpose of lookup of the resource path.
   // This just needs to be some symbol in the binary.
   static int StaticSymbol;
@@ -384,6 +636,11 @@ int ClangTool::run(ToolAction *Action) {
             MappedFile.first, 0,
             llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
 
+  SharedPCHs PCHs;
+  if (!SharedPCHDirectory.empty())
+    collectSharedPCHs(Compilations, SourcePaths, *Files, MappedFileContents,
+                      PCHs);
+
   bool ProcessingFailed = false;
   for (const auto &SourcePath : SourcePaths) {
     std::string File(getAbsolutePath(SourcePath));
@@ -419,6 +676,10 @@ int ClangTool::run(ToolAction *Action) {
         llvm::report_fatal_error("Cannot chdir into \"" +
                                  Twine(CompileCommand.Directory) + "\n!");
 
+      SharedPCH *PCH = SharedPCHDirectory.empty()
+                           ? nullptr
+                           : PCHs.lookup(getCommandFingerprint(CompileCommand));
+
       // Now fill the in-memory VFS with the relative file mappings so it will
       // have the correct relative paths. We never remove mappings but that
       // should be fine.
@@ -447,9 +708,14 @@ int ClangTool::run(ToolAction *Action) {
       // FIXME: We need a callback mechanism for the tool writer to output a
       // customized message for each file.
       DEBUG({ llvm::dbgs() << "Processing: " << File << ".\n"; });
-      ToolInvocation Invocation(std::move(CommandLine), Action, Files.get(),
-                                PCHContainerOps);
+      std::unique_ptr<SharedPCHAction> PCHAction;
+      if (PCH)
+        PCHAction.reset(new SharedPCHAction(*Action, SharedPCHDirectory, *PCH));
+      ToolInvocation Invocation(std::move(CommandLine),
+                                PCHAction ? PCHAction.get() : Action,
+                                Files.get(), PCHContainerOps);
       Invocation.setDiagnosticConsumer(DiagConsumer);
+      Invocation.setSharedLookupCache(LookupCache);
 
       if (!Invocation.run()) {
         // FIXME: Diagnostics should be used instead.
@@ -468,7 +734,262 @@ int ClangTool::run(ToolAction *Action) {
 
 namespace {
 
+/// \brief Lists the entries of a directory under the name it was asked for,
+/// rather than the one it was found at.
+class WorkingDirectoryDirIterImpl : public vfs::detail::DirIterImpl {
+  vfs::directory_iterator Entries;
+  std::string Dir;
+
+  void setCurrentEntry() {
+    if (Entries == vfs::directory_iterator()) {
+      CurrentEntry = vfs::Status();
+      return;
+    }
+    SmallString<256> Name(Dir);
+    llvm::sys::path::append(Name,
+                            llvm::sys::path::filename(Entries->getName()));
+    CurrentEntry = vfs::Status::copyWithNewName(*Entries, Name);
+  }
+
+public:
+  WorkingDirectoryDirIterImpl(vfs::directory_iterator Entries, StringRef Dir)
+      : Entries(Entries), Dir(Dir) {
+    setCurrentEntry();
+  }
+
+  std::error_code increment() override {
+    std::error_code EC;
+    Entries.increment(EC);
+    setCurrentEntry();
+    return EC;
+  }
+};
+
+/// \brief A file system which resolves relative paths against its own working
+/// directory instead of the process-wide one.
+///
+/// Unlike the real file system, changing the working directory does not call
+/// chdir, so several instances can be used concurrently from different
+/// threads.
+class WorkingDirectoryFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> Base;
+  std::string WorkingDirectory;
+
+  std::string resolve(const Twine &Path) const {
+    SmallString<256> Absolute;
+    Path.toVector(Absolute);
+    if (!llvm::sys::path::is_absolute(Absolute)) {
+      SmallString<256> Relative(Absolute);
+      Absolute = WorkingDirectory;
+      llvm::sys::path::append(Absolute, Relative);
+    }
+    return Absolute.str();
+  }
+
+public:
+  WorkingDirectoryFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> Base,
+                             StringRef WorkingDirectory)
+      : Base(std::move(Base)), WorkingDirectory(WorkingDirectory) {}
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+    llvm::ErrorOr<vfs::Status> S = Base->status(resolve(Path));
+    if (!S)
+      return S;
+    return vfs::Status::copyWithNewName(*S, Path.str());
+  }
+
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    return Base->openFileForRead(resolve(Path));
+  }
+
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    vfs::directory_iterator Entries = Base->dir_begin(resolve(Dir), EC);
+    return vfs::directory_iterator(
+        std::make_shared<WorkingDirectoryDirIterImpl>(Entries, Dir.str()));
+  }
+
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    std::string Dir = resolve(Path);
+    llvm::ErrorOr<vfs::Status> S = Base->status(Dir);
+    if (!S)
+      return S.getError();
+    if (!S->isDirectory())
+      return std::make_error_code(std::errc::not_a_directory);
+    WorkingDirectory = Dir;
+    return std::error_code();
+  }
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return WorkingDirectory;
+  }
+};
+
+/// \brief Forwards diagnostics to another consumer under a lock, so that a
+/// single consumer can be shared by concurrently running tool invocations.
+class LockingDiagnosticConsumer : public DiagnosticConsumer {
+  DiagnosticConsumer &Target;
+  std::mutex &Lock;
+
+public:
+  LockingDiagnosticConsumer(DiagnosticConsumer &Target, std::mutex &Lock)
+      : Target(Target), Lock(Lock) {}
+
+  void BeginSourceFile(const LangOptions &LangOpts,
+                       const Preprocessor *PP) override {
+    std::lock_guard<std::mutex> Guard(Lock);
+    Target.BeginSourceFile(LangOpts, PP);
+  }
+
+  void EndSourceFile() override {
+    std::lock_guard<std::mutex> Guard(Lock);
+    Target.EndSourceFile();
+  }
+
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(DiagLevel, Info);
+    std::lock_guard<std::mutex> Guard(Lock);
+    Target.HandleDiagnostic(DiagLevel, Info);
+  }
+};
+
+} // end anonymous namespace
+
+int ClangTool::runInParallel(ToolAction *Action) {
+  // Exists solely for the purpose of lookup of the resource path.
+  // This just needs to be some symbol in the binary.
+  static int StaticSymbol;
+
+  llvm::SmallString<128> InitialDirectory;
+  if (std::error_code EC = llvm::sys::fs::current_path(InitialDirectory))
+    llvm::report_fatal_error("Cannot detect current path: " +
+                             Twine(EC.message()));
+
+  // Query the compilation database and adjust the command lines up front, on
+  // this thread; neither is required to be thread-safe.
+  struct Job {
+    std::string File;
+    std::string Directory;
+    std::vector<std::string> CommandLine;
+    SharedPCH *PCH = nullptr;
+    std::string Output;
+    bool Succeeded = false;
+  };
+  SharedPCHs PCHs;
+  if (!SharedPCHDirectory.empty())
+    collectSharedPCHs(Compilations, SourcePaths, *Files, MappedFileContents,
+                      PCHs);
+  std::vector<Job> Jobs;
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty()) {
+      llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
+      continue;
+    }
+    for (CompileCommand &CompileCommand : CompileCommandsForFile) {
+      Job J;
+      J.File = File;
+      J.Directory = CompileCommand.Directory;
+      J.CommandLine = CompileCommand.CommandLine;
+      if (!SharedPCHDirectory.empty())
+        J.PCH = PCHs.lookup(getCommandFingerprint(CompileCommand));
+      if (ArgsAdjuster)
+        J.CommandLine = ArgsAdjuster(J.CommandLine, CompileCommand.Filename);
+      assert(!J.CommandLine.empty());
+      injectResourceDir(J.CommandLine, "clang_tool", &StaticSymbol);
+      Jobs.push_back(std::move(J));
+    }
+  }
+
+  // The translation units share the results of 'stat' calls on absolute
+  // paths, unless a relative mapped file makes their views differ.
+  std::shared_ptr<SharedStatResults> StatResults;
+  if (llvm::all_of(MappedFileContents,
+                   [](const std::pair<StringRef, StringRef> &MappedFile) {
+                     return llvm::sys::path::is_absolute(MappedFile.first);
+                   }))
+    StatResults = std::make_shared<SharedStatResults>();
+
+  beginParallelRun(Jobs.size());
+  std::mutex DiagLock;
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned Index = 0, NumJobs = Jobs.size(); Index != NumJobs; ++Index) {
+      Pool.async([&, Index] {
+        Job &J = Jobs[Index];
+        beginParallelJob(Index);
+
+        // Each translation unit gets its own view of the file system, with
+        // the working directory of its compile command and the mapped files.
+        IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFS(
+            new vfs::OverlayFileSystem(new WorkingDirectoryFileSystem(
+                vfs::getRealFileSystem(), InitialDirectory)));
+        IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFS(
+            new vfs::InMemoryFileSystem);
+        OverlayFS->pushOverlay(InMemoryFS);
+        if (OverlayFS->setCurrentWorkingDirectory(J.Directory)) {
+          J.Output = "Cannot chdir into \"" + J.Directory + "\"\n";
+          return;
+        }
+        for (const auto &MappedFile : MappedFileContents)
+          InMemoryFS->addFile(
+              MappedFile.first, 0,
+              llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+        IntrusiveRefCntPtr<FileManager> TUFiles(
+            new FileManager(FileSystemOptions(), OverlayFS));
+        if (StatResults)
+          TUFiles->addStatCache(
+              llvm::make_unique<SharedStatCache>(StatResults));
+
+        // Buffer the diagnostics so that they are printed in a deterministic
+        // order, unless the client asked for them to be delivered elsewhere.
+        llvm::raw_string_ostream OS(J.Output);
+        IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+        TextDiagnosticPrinter Printer(OS, &*DiagOpts);
+        LockingDiagnosticConsumer Locking(DiagConsumer ? *DiagConsumer
+                                                       : Printer,
+                                          DiagLock);
+
+        DEBUG({
+          std::lock_guard<std::mutex> Guard(DiagLock);
+          llvm::dbgs() << "Processing: " << J.File << ".\n";
+        });
+        std::unique_ptr<SharedPCHAction> PCHAction;
+        if (J.PCH)
+          PCHAction.reset(
+              new SharedPCHAction(*Action, SharedPCHDirectory, *J.PCH));
+        ToolInvocation Invocation(std::move(J.CommandLine),
+                                  PCHAction ? PCHAction.get() : Action,
+                                  TUFiles.get(), PCHContainerOps);
+        Invocation.setDiagnosticConsumer(&Locking);
+        J.Succeeded = Invocation.run();
+        OS.flush();
+      });
+    }
+    Pool.wait();
+  }
+  endParallelRun();
+
+  bool ProcessingFailed = false;
+  for (const Job &J : Jobs) {
+    llvm::errs() << J.Output;
+    if (!J.Succeeded) {
+      // FIXME: Diagnostics should be used instead.
+      llvm::errs() << "Error while processing " << J.File << ".\n";
+      ProcessingFailed = true;
+    }
+  }
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
 class ASTBuilderAction : public ToolAction {
+  std::mutex Lock;
   std::vector<std::unique_ptr<ASTUnit>> &ASTs;
 
 public:
@@ -486,6 +1007,7 @@ public:
     if (!AST)
       return false;
 
+    std::lock_guard<std::mutex> Guard(Lock);
     ASTs.push_back(std::move(AST));
     return true;
   }
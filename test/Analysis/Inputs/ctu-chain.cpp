@@ -0,0 +1,7 @@
+namespace chns {
+int chf3(int x);
+
+int chf2(int x) {
+  return chf3(x) + 1;
+}
+}
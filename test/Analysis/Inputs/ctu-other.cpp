@@ -0,0 +1,48 @@
+int g(int x) {
+  return x + 1;
+}
+
+namespace myns {
+int fns(int x) {
+  return x + 7;
+}
+
+namespace embed_ns {
+int fens(int x) {
+  return x - 3;
+}
+}
+
+class embed_cls {
+public:
+  int fecl(int x) {
+    return x - 7;
+  }
+};
+}
+
+class mycls {
+public:
+  int fcl(int x);
+  static int fscl(int x);
+};
+
+int mycls::fcl(int x) {
+  return x + 5;
+}
+
+int mycls::fscl(int x) {
+  return x + 6;
+}
+
+namespace chns {
+int chf2(int x);
+
+int chf1(int x) {
+  return chf2(x);
+}
+
+int chf3(int x) {
+  return x * 3;
+}
+}
@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config callgraph-dir=%t -fblocks -verify %s
+// RUN: cat %t/callgraph-dir.c-*.callgraph | FileCheck %s
+
+// expected-no-diagnostics
+
+void external();
+
+static void helper() {
+  external();
+}
+
+void later();
+
+void caller() {
+  helper();
+  later();
+}
+
+void later() {}
+
+void throughBlock() {
+  ^{
+    caller();
+  }();
+}
+
+// The callees of a block are attributed to the function which calls it, and
+// the calls to functions without definitions are left out.
+// CHECK: c:@F@caller{{.*}}caller{{.*}}callgraph-dir.c:15{{.*}}external{{.*}}c:callgraph-dir.c{{(@[0-9]+)?}}@F@helper,c:@F@later{{$}}
+// CHECK-NEXT: c:@F@later{{.*}}later{{.*}}callgraph-dir.c:20{{.*}}external{{[[:space:]]*$}}
+// CHECK-NEXT: c:@F@throughBlock{{.*}}throughBlock{{.*}}callgraph-dir.c:22{{.*}}external{{.*}}c:@F@caller{{$}}
+// CHECK-NEXT: c:callgraph-dir.c{{(@[0-9]+)?}}@F@helper{{.*}}helper{{.*}}callgraph-dir.c:9{{.*}}internal{{[[:space:]]*$}}
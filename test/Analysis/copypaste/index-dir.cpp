@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -analyze -std=c++11 -analyzer-checker=alpha.clone.CloneChecker -analyzer-config alpha.clone.CloneChecker:IndexDir=%t -verify %s
+// RUN: cat %t/clones-*.idx | FileCheck %s
+// RUN: touch %t/file
+// RUN: %clang_cc1 -analyze -std=c++11 -analyzer-checker=alpha.clone.CloneChecker -analyzer-config alpha.clone.CloneChecker:IndexDir=%t/file/sub %s 2>&1 | FileCheck --check-prefix=CHECK-FAIL %s
+
+// This tests the index of the statements written instead of the reports, for
+// finding clones across translation units.
+
+// expected-no-diagnostics
+
+void log();
+
+int max(int a, int b) {
+  log();
+  if (a > b)
+    return a;
+  return b;
+}
+
+int maxClone(int x, int y) {
+  log();
+  if (x > y)
+    return x;
+  return y;
+}
+
+// CHECK: [[HASH:[0-9a-f]+]]{{.}}{{[0-9]+}}{{.}}{{.*}}index-dir.cpp{{.}}12:23{{.}}17:1{{.}}[[PARTS:[0-9a-f,]+]]
+// CHECK: [[HASH]]{{.}}{{[0-9]+}}{{.}}{{.*}}index-dir.cpp{{.}}19:28{{.}}24:1{{.}}[[PARTS]]
+
+// CHECK-FAIL: warning: unable to write clone index in '{{.*}}sub'
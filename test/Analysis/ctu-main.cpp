@@ -0,0 +1,59 @@
+// RUN: rm -rf %t && mkdir -p %t/ctudir
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -emit-pch -o %t/ctudir/ctu-other.cpp.ast %S/Inputs/ctu-other.cpp
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -emit-pch -o %t/ctudir/ctu-chain.cpp.ast %S/Inputs/ctu-chain.cpp
+// RUN: cp %S/Inputs/externalFnMap.txt %t/ctudir/
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ctu-dir=%t/ctudir -verify %s
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ctu-dir=%t/ctudir -analyzer-config ctu-max-loaded-tus=1 -verify %s
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -analyze -analyzer-checker=core,debug.ExprInspection -DNO_CTU -verify %s
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ctu-dir=%t/missing -DNO_CTU -verify %s
+
+void clang_analyzer_eval(int);
+
+int g(int);
+
+namespace myns {
+int fns(int x);
+
+namespace embed_ns {
+int fens(int x);
+}
+
+class embed_cls {
+public:
+  int fecl(int x);
+};
+}
+
+class mycls {
+public:
+  int fcl(int x);
+  static int fscl(int x);
+};
+
+namespace chns {
+int chf1(int x);
+}
+
+int h(int);
+
+#ifndef NO_CTU
+void test_ctu() {
+  clang_analyzer_eval(g(1) == 2); // expected-warning{{TRUE}}
+  clang_analyzer_eval(myns::fns(1) == 8); // expected-warning{{TRUE}}
+  clang_analyzer_eval(myns::embed_ns::fens(4) == 1); // expected-warning{{TRUE}}
+  clang_analyzer_eval(myns::embed_cls().fecl(8) == 1); // expected-warning{{TRUE}}
+  clang_analyzer_eval(mycls().fcl(1) == 6); // expected-warning{{TRUE}}
+  clang_analyzer_eval(mycls::fscl(1) == 7); // expected-warning{{TRUE}}
+  // chf1 calls chf2 in another translation unit, which calls chf3 back in
+  // the first one.
+  clang_analyzer_eval(chns::chf1(2) == 7); // expected-warning{{TRUE}}
+  // Functions missing from the index are evaluated conservatively.
+  clang_analyzer_eval(h(1) == 1); // expected-warning{{UNKNOWN}}
+}
+#else
+void test_no_ctu() {
+  clang_analyzer_eval(g(1) == 2); // expected-warning{{UNKNOWN}}
+  // A missing index makes every lookup fail, not just the first one.
+  clang_analyzer_eval(h(1) == 1); // expected-warning{{UNKNOWN}}
+}
+#endif
@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config max-nodes=2000 -analyzer-config exploration-strategy=dfs -DDFS -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config max-nodes=2000 -analyzer-config exploration-strategy=bfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config max-nodes=2000 -analyzer-config exploration-strategy=coverage-guided -verify %s
+
+// The loop exit is explored first, and the code after the loop has far more
+// paths than the node budget allows. Depth-first search spends the whole
+// budget there and never enters the loop body, while the coverage-guided
+// strategy gets to the unvisited body right after one path through the rest.
+
+#ifdef DFS
+// expected-no-diagnostics
+#endif
+
+int coin(void);
+int g;
+
+void loopBodyAfterManyPaths(int n) {
+  for (int i = 0; i < n; ++i) {
+    int *p = 0;
+#ifndef DFS
+    // expected-warning@+2 {{Dereference of null pointer}}
+#endif
+    *p = i;
+  }
+  int x = 0;
+  if (coin()) x += 1;
+  if (coin()) x += 2;
+  if (coin()) x += 4;
+  if (coin()) x += 8;
+  if (coin()) x += 16;
+  if (coin()) x += 32;
+  if (coin()) x += 64;
+  if (coin()) x += 128;
+  if (coin()) x += 256;
+  if (coin()) x += 512;
+  if (coin()) x += 1024;
+  if (coin()) x += 2048;
+  g = x;
+}
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration-strategy=dfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration-strategy=bfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration-strategy=bfs-block-dfs-contents -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration-strategy=coverage-guided -verify %s
+
+int g;
+
+void afterLoop(int n) {
+  for (int i = 0; i < n; ++i)
+    ++g;
+  int *p = 0;
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+void inBranches(int a, int b) {
+  int d = 1;
+  if (a)
+    d = 0;
+  for (int i = 0; i < b; ++i)
+    g += i;
+  g = 10 / d; // expected-warning{{Division by zero}}
+}
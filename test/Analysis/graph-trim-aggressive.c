@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config graph-trim-interval=1 -analyzer-config graph-trim-aggressive=true -verify %s
+
+void clang_analyzer_eval(int);
+
+int compute(int a) {
+  // Produce plenty of nodes which don't change the state.
+  (void)a;
+  (void)(a + 1);
+  return 2 + 3 + 4 + 5 + 6;
+}
+
+void testValuesSurvive(int a) {
+  int x = compute(a);
+  clang_analyzer_eval(x == 20); // expected-warning{{TRUE}}
+}
+
+void testBugsSurvive(int a) {
+  int *p = 0;
+  if (compute(a) == 20)
+    *p = a; // expected-warning{{Dereference of null pointer (loaded from variable 'p')}}
+}
@@ -0,0 +1,24 @@
+// RUN: rm -fR %T/many-reports
+// RUN: mkdir %T/many-reports
+// RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -o %T/many-reports %s
+// RUN: cat %T/many-reports/report-*.html | FileCheck %s
+
+// The highlighting of a file is computed once and reused for every report on
+// it; check that every report still gets all macro expansions.
+
+#define DEREF(p) *p = 0xDEADBEEF
+
+void first(int *p) {
+  if (p) {}
+  DEREF(p);
+}
+
+void second(int *q) {
+  if (q) {}
+  DEREF(q);
+}
+
+// CHECK: <span class='expansion'>*p = 0xDEADBEEF</span>
+// CHECK: <span class='expansion'>*q = 0xDEADBEEF</span>
+// CHECK: <span class='expansion'>*p = 0xDEADBEEF</span>
+// CHECK: <span class='expansion'>*q = 0xDEADBEEF</span>
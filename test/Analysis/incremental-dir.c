@@ -0,0 +1,38 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: cp %s %t/input.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-dir=%t %t/input.c 2>&1 | FileCheck -check-prefix=FIRST %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-dir=%t %t/input.c 2>&1 | FileCheck -check-prefix=UNCHANGED -allow-empty %s
+// RUN: sed -e 's/\*q = 1;/*q = 2;/' %s > %t/input.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-dir=%t %t/input.c 2>&1 | FileCheck -check-prefix=CHANGED %s
+// RUN: sed -e 's/\*q = 1;/*q = 2;/' -e 's/define ZERO 0/define ZERO (0)/' %s > %t/input.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-dir=%t %t/input.c 2>&1 | FileCheck -check-prefix=MACRO %s
+
+#define ZERO 0
+
+void unchanged() {
+  int *p = ZERO;
+  *p = 1;
+}
+
+static void callee(int *q) {
+  *q = 1;
+}
+
+void caller() {
+  callee(0);
+}
+
+// FIRST-DAG: warning: Dereference of null pointer (loaded from variable 'p')
+// FIRST-DAG: warning: Dereference of null pointer (loaded from variable 'q')
+
+// UNCHANGED-NOT: warning
+
+// Changing the callee makes its caller be analyzed again.
+// CHANGED-NOT: variable 'p'
+// CHANGED: warning: Dereference of null pointer (loaded from variable 'q')
+// CHANGED-NOT: variable 'p'
+
+// Changing a macro of the main file makes the functions be analyzed again,
+// even if their text is the same.
+// MACRO-DAG: warning: Dereference of null pointer (loaded from variable 'p')
+// MACRO-DAG: warning: Dereference of null pointer (loaded from variable 'q')
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=text -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats %s 2>&1 | FileCheck %s
+// REQUIRES: asserts
+
+// The paths of all the reports in a function are generated from one trimmed
+// graph, and must still be the shortest path to each of them.
+
+void test(int *p, int a, int b) {
+  int *q = 0; // expected-note{{'q' initialized to a null pointer value}}
+  if (a) { // expected-note{{Assuming 'a' is not equal to 0}}
+           // expected-note@-1{{Taking true branch}}
+           // expected-note@-2{{Assuming 'a' is 0}}
+           // expected-note@-3{{Taking false branch}}
+    if (p) // expected-note{{Assuming 'p' is null}}
+           // expected-note@-1{{Taking false branch}}
+      return;
+    *p = 1; // expected-warning{{Dereference of null pointer (loaded from variable 'p')}}
+            // expected-note@-1{{Dereference of null pointer (loaded from variable 'p')}}
+  }
+  if (b) // expected-note{{Assuming 'b' is not equal to 0}}
+         // expected-note@-1{{Taking true branch}}
+    *q = a; // expected-warning{{Dereference of null pointer (loaded from variable 'q')}}
+            // expected-note@-1{{Dereference of null pointer (loaded from variable 'q')}}
+}
+
+// CHECK: BugReporter - The # of equivalence classes whose paths were generated from a trimmed graph shared with other classes
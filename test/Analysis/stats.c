@@ -6,4 +6,5 @@ void foo() {
 }
 // CHECK: ... Statistics Collected ...
 // CHECK:100 AnalysisConsumer - The % of reachable basic blocks.
+// CHECK:ExplodedGraph - The # of kilobytes allocated for exploded graphs.
 // CHECK:The # of times RemoveDeadBindings is called
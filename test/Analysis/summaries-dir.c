@@ -0,0 +1,51 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,debug.ExprInspection -analyzer-config summaries-dir=%t -DDEFINE -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,debug.ExprInspection -analyzer-config summaries-dir=%t -verify %s
+
+void clang_analyzer_eval(int);
+
+typedef __typeof(sizeof(int)) size_t;
+void *malloc(size_t);
+void free(void *);
+
+int g;
+
+#ifdef DEFINE
+// expected-no-diagnostics
+
+int sum(int a, int b) {
+  int s = a;
+  s += b;
+  return s;
+}
+
+int twice(int a) { return sum(a, a); }
+
+void bump() { ++g; }
+
+void *id(void *p) { return p; }
+
+#else
+
+int sum(int a, int b);
+int twice(int a);
+void bump();
+void *id(void *p);
+
+void test() {
+  g = 1;
+  sum(1, 2);
+  twice(3);
+  clang_analyzer_eval(g == 1); // expected-warning{{TRUE}}
+  bump();
+  clang_analyzer_eval(g == 1); // expected-warning{{UNKNOWN}}
+}
+
+// The memory passed to a side-effect free function escapes, since it may be
+// what the function returns.
+void testReturnedArgument() {
+  void *q = id(malloc(1));
+  free(q); // no-warning
+}
+
+#endif
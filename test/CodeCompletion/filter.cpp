@@ -0,0 +1,27 @@
+struct Widget {
+  int size;
+  int capacity;
+  void resize(int);
+  void reserve(int);
+};
+
+void test(Widget &w) {
+  w.
+  // RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:9:5 %s -o - | FileCheck -check-prefix=CHECK-ALL %s
+  // CHECK-ALL: capacity
+  // CHECK-ALL: reserve
+  // CHECK-ALL: resize
+  // CHECK-ALL: size
+
+  // RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:9:5 -code-completion-filter=re %s -o - | FileCheck -check-prefix=CHECK-RE %s
+  // CHECK-RE-NOT: capacity
+  // CHECK-RE-NOT: size
+  // CHECK-RE: reserve
+  // CHECK-RE: resize
+  // CHECK-RE-NOT: size
+
+  // Matching is case-insensitive and allows skipped characters.
+  // RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:9:5 -code-completion-filter=CPT %s -o - | FileCheck -check-prefix=CHECK-CPT %s
+  // CHECK-CPT: COMPLETION: capacity
+  // CHECK-CPT-NOT: COMPLETION:
+}
@@ -0,0 +1,45 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -target-cpu core2 -emit-llvm -Watomic-alignment -verify %s -o - | FileCheck %s
+
+struct pair { long a, b; };
+struct quad { long a, b, c, d; };
+
+struct pair P;
+_Alignas(16) struct pair AlignedP;
+struct quad Q;
+
+// CHECK-LABEL: define void @load_unaligned(
+// CHECK: call void @__atomic_load(i64 16,
+void load_unaligned(struct pair *R) {
+  __atomic_load(&P, R, __ATOMIC_SEQ_CST); // expected-warning {{misaligned atomic operation on 'struct pair' is lowered to a library call, which may take a lock}}
+}
+
+// The declared alignment of the object is enough to use cmpxchg16b.
+// CHECK-LABEL: define void @load_aligned(
+// CHECK: load atomic i128, i128* bitcast (%struct.pair* @AlignedP to i128*) seq_cst, align 16
+void load_aligned(struct pair *R) {
+  __atomic_load(&AlignedP, R, __ATOMIC_SEQ_CST);
+}
+
+// CHECK-LABEL: define void @exchange_aligned(
+// CHECK: atomicrmw xchg i128* bitcast (%struct.pair* @AlignedP to i128*)
+void exchange_aligned(struct pair *V, struct pair *R) {
+  __atomic_exchange(&AlignedP, V, R, __ATOMIC_SEQ_CST);
+}
+
+// CHECK-LABEL: define void @store_pointer(
+// CHECK: call void @__atomic_store(i64 16,
+void store_pointer(struct pair *D, struct pair *V) {
+  __atomic_store(D, V, __ATOMIC_RELEASE); // expected-warning {{misaligned atomic operation on 'struct pair'}}
+}
+
+// CHECK-LABEL: define void @load_large(
+// CHECK: call void @__atomic_load(i64 32,
+void load_large(struct quad *R) {
+  __atomic_load(&Q, R, __ATOMIC_SEQ_CST); // expected-warning {{large atomic operation on 'struct quad'}}
+}
+
+// CHECK-LABEL: define i32 @fetch_add(
+// CHECK: atomicrmw add i32*
+int fetch_add(int *I) {
+  return __atomic_fetch_add(I, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,95 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -disable-llvm-passes -fprecise-struct-path-tbaa %s -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -disable-llvm-passes %s -emit-llvm -o - | FileCheck %s -check-prefix=DEFAULT
+// Test the TBAA metadata of accesses to arrays, vectors and unions under
+// -fprecise-struct-path-tbaa.
+
+struct Particle {
+  int id;
+  float pos[3];
+  float w;
+};
+
+float array_member(Particle *P, int *N, int I) {
+// CHECK-LABEL: define float @_Z12array_memberP8ParticlePii(
+// CHECK: store i32 0, i32* %{{.*}}, !tbaa [[TAG_int:!.*]]
+// CHECK: load float, float* %{{.*}}, !tbaa [[TAG_Particle_pos:!.*]]
+// DEFAULT-LABEL: define float @_Z12array_memberP8ParticlePii(
+// DEFAULT: load float, float* %{{.*}}, !tbaa [[TAG_float:!.*]]
+  *N = 0;
+  return P->pos[I];
+}
+
+struct Grid {
+  int n;
+  Particle cells[4][4];
+};
+
+float nested_array(Grid *G, int I, int J) {
+// CHECK-LABEL: define float @_Z12nested_arrayP4Gridii(
+// CHECK: load float, float* %{{.*}}, !tbaa [[TAG_Grid_cells_w:!.*]]
+// DEFAULT-LABEL: define float @_Z12nested_arrayP4Gridii(
+// DEFAULT: load float, float* %{{.*}}, !tbaa [[TAG_float]]
+  return G->cells[I][J].w;
+}
+
+typedef float float4 __attribute__((ext_vector_type(4)));
+
+float4 vector_load(float4 *V, int *N) {
+// CHECK-LABEL: define {{.*}}@_Z11vector_loadPDv4_fPi(
+// CHECK: load <4 x float>, <4 x float>* %{{.*}}, !tbaa [[TAG_float:!.*]]
+// DEFAULT-LABEL: define {{.*}}@_Z11vector_loadPDv4_fPi(
+// DEFAULT: load <4 x float>, <4 x float>* %{{.*}}, !tbaa [[TAG_char:!.*]]
+  *N = 0;
+  return *V;
+}
+
+// All the members of the union are floats, so it can be part of the path.
+struct Sample {
+  int id;
+  union {
+    float f[2];
+    float g;
+  } u;
+};
+
+float union_member(Sample *S, int *N) {
+// CHECK-LABEL: define float @_Z12union_memberP6SamplePi(
+// CHECK: load float, float* %{{.*}}, !tbaa [[TAG_Sample_u_g:!.*]]
+// DEFAULT-LABEL: define float @_Z12union_memberP6SamplePi(
+// DEFAULT: load float, float* %{{.*}}, !tbaa [[TAG_float]]
+  *N = 0;
+  return S->u.g;
+}
+
+// may_alias applies to the members of anonymous unions as well.
+struct __attribute__((may_alias)) Punned {
+  union {
+    int i;
+    float f;
+  };
+};
+
+int may_alias_member(Punned *P, int *N) {
+// CHECK-LABEL: define i32 @_Z16may_alias_memberP6PunnedPi(
+// CHECK: load i32, i32* %{{.*}}, !tbaa [[TAG_char:!.*]]
+// DEFAULT-LABEL: define i32 @_Z16may_alias_memberP6PunnedPi(
+// DEFAULT: load i32, i32* %{{.*}}, !tbaa [[TAG_char]]
+  *N = 0;
+  return P->i;
+}
+
+// CHECK: [[TYPE_char:!.*]] = !{!"omnipotent char", !
+// CHECK: [[TAG_int]] = !{[[TYPE_int:!.*]], [[TYPE_int]], i64 0}
+// CHECK: [[TYPE_int]] = !{!"int", [[TYPE_char]]
+// CHECK: [[TAG_Particle_pos]] = !{[[TYPE_Particle:!.*]], [[TYPE_float:!.*]], i64 4}
+// CHECK: [[TYPE_Particle]] = !{!"_ZTS8Particle", [[TYPE_int]], i64 0, [[TYPE_float]], i64 4, [[TYPE_float]], i64 16}
+// CHECK: [[TYPE_float]] = !{!"float", [[TYPE_char]]
+// CHECK: [[TAG_Grid_cells_w]] = !{[[TYPE_Grid:!.*]], [[TYPE_float]], i64 20}
+// CHECK: [[TYPE_Grid]] = !{!"_ZTS4Grid", [[TYPE_int]], i64 0, [[TYPE_Particle]], i64 4}
+// CHECK: [[TAG_float]] = !{[[TYPE_float]], [[TYPE_float]], i64 0}
+// CHECK: [[TAG_Sample_u_g]] = !{[[TYPE_Sample:!.*]], [[TYPE_float]], i64 4}
+// CHECK: [[TYPE_Sample]] = !{!"_ZTS6Sample", [[TYPE_int]], i64 0, [[TYPE_float]], i64 4}
+// CHECK: [[TAG_char]] = !{[[TYPE_char]], [[TYPE_char]], i64 0}
+
+// DEFAULT: [[TAG_float]] = !{[[TYPE_float:!.*]], [[TYPE_float]], i64 0}
+// DEFAULT: [[TAG_char]] = !{[[TYPE_char:!.*]], [[TYPE_char]], i64 0}
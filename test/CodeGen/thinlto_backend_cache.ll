@@ -0,0 +1,44 @@
+; REQUIRES: x86-registered-target
+
+; RUN: opt -module-summary -module-hash -o %t1.o %s
+; RUN: opt -module-summary -module-hash -o %t2.o %S/Inputs/thinlto_backend.ll
+; RUN: llvm-lto -thinlto -o %t %t1.o %t2.o
+
+; The first backend compile fills the cache, the second one reuses its output.
+; RUN: rm -rf %t.cache && mkdir %t.cache
+; RUN: %clang -target x86_64-unknown-linux-gnu -O2 -o %t3.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 1
+; RUN: %clang -target x86_64-unknown-linux-gnu -O2 -o %t4.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 1
+; RUN: cmp %t3.o %t4.o
+; RUN: llvm-nm %t4.o | FileCheck --check-prefix=CHECK-OBJ %s
+; CHECK-OBJ: T f1
+; CHECK-OBJ-NOT: U f2
+
+; Compiles with different options don't share an entry.
+; RUN: %clang -target x86_64-unknown-linux-gnu -O1 -o %t5.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 2
+; RUN: %clang -target x86_64-unknown-linux-gnu -O2 -g -o %t5.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 3
+; RUN: %clang -target x86_64-unknown-linux-gnu -O2 -march=haswell -o %t5.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 4
+; RUN: %clang -target x86_64-unknown-linux-gnu -O2 -mllvm -enable-misched=false -o %t5.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 5
+
+; Nothing is cached if the index doesn't record the modules' hashes.
+; RUN: opt -module-summary -o %t1.o %s
+; RUN: opt -module-summary -o %t2.o %S/Inputs/thinlto_backend.ll
+; RUN: llvm-lto -thinlto -o %t %t1.o %t2.o
+; RUN: rm -rf %t.cache && mkdir %t.cache
+; RUN: %clang -target x86_64-unknown-linux-gnu -O2 -o %t3.o -x ir %t1.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache
+; RUN: ls %t.cache | count 0
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @f2()
+
+define void @f1() {
+  call void @f2()
+  ret void
+}
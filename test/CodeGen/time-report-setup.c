@@ -0,0 +1,8 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -ftime-report -emit-obj -o /dev/null %s 2>&1 | FileCheck %s
+
+// The fixed cost of setting up the backend is reported on its own.
+// CHECK-DAG: Code Generation Setup Time
+// CHECK-DAG: Code Generation Time
+
+int f(int x) { return x + 1; }
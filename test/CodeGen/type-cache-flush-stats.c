@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -print-stats -o /dev/null %s 2>&1 | FileCheck %s
+
+// Converting A skips the layout of the function type that refers to it, which
+// flushes the type cache when that function type and then A are done. The
+// records converted afterwards don't depend on any placeholder, so they must
+// not flush it again.
+struct A { void (*f)(struct A); };
+struct B { int x; };
+struct C { struct B b; };
+struct D { struct C c; struct B *p; };
+
+struct A a;
+struct C c;
+struct D d;
+
+// CHECK: *** CodeGen Stats:
+// CHECK: 2 LLVM type cache flushes.
@@ -0,0 +1,48 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-llvm -O1 -disable-llvm-passes -fcxx-exceptions -fexceptions %s -o - | FileCheck --check-prefix=CHECK-DEFAULT %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-llvm -O1 -disable-llvm-passes -fcxx-exceptions -fexceptions -fshare-landing-pads %s -o - | FileCheck --check-prefix=CHECK-SHARE %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-llvm -fcxx-exceptions -fexceptions -foutline-eh-cleanups %s -o - | FileCheck --check-prefix=CHECK-OUTLINE %s
+
+void may_throw(int *);
+
+struct Guard {
+  ~Guard();
+};
+
+// Each local with a lifetime marker normally starts a new EH region.
+// CHECK-DEFAULT-LABEL: define void @_Z6lockedv()
+// CHECK-DEFAULT: invoke void @_Z9may_throwPi({{.*}})
+// CHECK-DEFAULT-NEXT: to label %{{.*}} unwind label %[[LPAD1:.*]]
+// CHECK-DEFAULT: invoke void @_Z9may_throwPi({{.*}})
+// CHECK-DEFAULT-NOT: unwind label %[[LPAD1]]
+// CHECK-DEFAULT: ret void
+
+// CHECK-SHARE-LABEL: define void @_Z6lockedv()
+// CHECK-SHARE: invoke void @_Z9may_throwPi({{.*}})
+// CHECK-SHARE-NEXT: to label %{{.*}} unwind label %[[LPAD:.*]]
+// CHECK-SHARE: invoke void @_Z9may_throwPi({{.*}})
+// CHECK-SHARE-NEXT: to label %{{.*}} unwind label %[[LPAD]]
+// CHECK-SHARE: invoke void @_Z9may_throwPi({{.*}})
+// CHECK-SHARE-NEXT: to label %{{.*}} unwind label %[[LPAD]]
+// CHECK-SHARE: {{^}}ehcleanup:
+// CHECK-SHARE-NOT: call void @llvm.lifetime.end
+// CHECK-SHARE: call void @_ZN5GuardD1Ev(
+// CHECK-SHARE: resume
+void locked() {
+  Guard G;
+  int A;
+  may_throw(&A);
+  int B;
+  may_throw(&B);
+  int C;
+  may_throw(&C);
+}
+
+// The normal path keeps the destructor call inlinable, the unwind path
+// doesn't.
+// CHECK-OUTLINE-LABEL: define void @_Z6lockedv()
+// CHECK-OUTLINE: call void @_ZN5GuardD1Ev(%struct.Guard* %{{.*}}) [[NORMAL:#[0-9]+]]
+// CHECK-OUTLINE: {{^}}ehcleanup:
+// CHECK-OUTLINE: call void @_ZN5GuardD1Ev(%struct.Guard* %{{.*}}) [[OUTLINED:#[0-9]+]]
+// CHECK-OUTLINE: resume
+// CHECK-OUTLINE: attributes [[NORMAL]] = { nounwind }
+// CHECK-OUTLINE: attributes [[OUTLINED]] = { noinline nounwind }
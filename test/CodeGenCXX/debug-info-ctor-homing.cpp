@@ -0,0 +1,73 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -debug-info-kind=limited -fuse-ctor-homing %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -debug-info-kind=limited %s -o - | FileCheck -check-prefix=NOHOME %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -debug-info-kind=standalone -fuse-ctor-homing %s -o - | FileCheck -check-prefix=NOHOME %s
+
+// A class whose out-of-line constructor is defined elsewhere only gets a
+// declaration.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Elsewhere"{{.*}}flags: DIFlagFwdDecl
+// NOHOME: !DICompositeType(tag: DW_TAG_structure_type, name: "Elsewhere"
+// NOHOME-NOT:             DIFlagFwdDecl
+// NOHOME-SAME:            elements:
+struct Elsewhere {
+  Elsewhere();
+  int I;
+};
+int useElsewhere(Elsewhere &E) { return E.I; }
+
+// It is defined along with that constructor.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Here",{{.*}}elements:
+struct Here {
+  Here(int);
+  int I;
+};
+Here::Here(int I) : I(I) {}
+int useHere(Here &H) { return H.I; }
+
+// Classes that can be constructed without calling an out-of-line constructor
+// are emitted wherever they are needed.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Inline",{{.*}}elements:
+struct Inline {
+  Inline() {}
+  int I;
+};
+int useInline(Inline &I) { return I.I; }
+
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Aggregate",{{.*}}elements:
+struct Aggregate {
+  int I;
+};
+int useAggregate(Aggregate &A) { return A.I; }
+
+// Copy constructors need an object to start from, so they don't count.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "NonCopyable",{{.*}}elements:
+struct NonCopyable {
+  NonCopyable() {}
+  int I;
+private:
+  NonCopyable(const NonCopyable &);
+};
+int useNonCopyable(NonCopyable &N) { return N.I; }
+
+// Neither does an out-of-line constructor if there is also an inline one.
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Mixed",{{.*}}elements:
+struct Mixed {
+  Mixed(int);
+  Mixed() : I(0) {}
+  int I;
+};
+int useMixed(Mixed &M) { return M.I; }
+
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Constexpr",{{.*}}elements:
+struct Constexpr {
+  Constexpr(int);
+  constexpr Constexpr(char C) : I(C) {}
+  int I;
+};
+int useConstexpr(Constexpr &C) { return C.I; }
+
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Template<int>",{{.*}}elements:
+template <typename T> struct Template {
+  Template();
+  T I;
+};
+int useTemplate(Template<int> &T) { return T.I; }
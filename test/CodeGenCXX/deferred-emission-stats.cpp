@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -print-stats -o /dev/null %s 2>&1 | FileCheck -check-prefix=STATS %s
+
+inline int used() { return 1; }
+inline int unused() { return 2; }
+template <typename T> T unusedTemplate(T t) { return t; }
+inline int alsoUnused() { return unusedTemplate(3); }
+
+int f() { return used(); }
+
+// CHECK: define i32 @_Z1fv()
+// CHECK: define linkonce_odr i32 @_Z4usedv()
+// CHECK-NOT: unused
+
+// STATS: *** CodeGen Stats:
+// STATS-NEXT: 1 deferred declarations emitted once referenced.
+// STATS-NEXT: 0 deferred variables never emitted.
+// STATS-NEXT: 3 deferred functions never emitted.
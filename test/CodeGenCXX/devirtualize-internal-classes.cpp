@@ -0,0 +1,109 @@
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-unknown-linux -emit-llvm -fdevirtualize-internal-classes -Rdevirtualize -verify %s -o - | FileCheck %s
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-unknown-linux -emit-llvm %s -o - | FileCheck %s --check-prefix=CHECK-OFF
+
+namespace {
+struct Shape {
+  virtual int area() = 0;
+  virtual int id();
+};
+struct Square : Shape {
+  int area() override;
+};
+struct Circle : Shape {
+  int area() override;
+};
+int Shape::id() { return 0; }
+int Square::area() { return 4; }
+int Circle::area() { return 3; }
+
+struct Base {
+  virtual int v() = 0;
+};
+struct Impl : Base {
+  int v() override;
+};
+int Impl::v() { return 1; }
+
+struct Other {
+  virtual int o();
+};
+int Other::o() { return 0; }
+
+struct X {
+  virtual int x();
+};
+struct Y {
+  virtual int y() = 0;
+};
+struct Z : X, Y {
+  int y() override;
+};
+int X::x() { return 0; }
+int Z::y() { return 2; }
+}
+
+// CHECK-LABEL: define i32 @_Z2idPN12_GLOBAL__N_15ShapeE(
+// CHECK: call i32 @_ZN12_GLOBAL__N_15Shape2idEv(
+// CHECK-OFF-LABEL: define i32 @_Z2idPN12_GLOBAL__N_15ShapeE(
+// CHECK-OFF: %[[VFN:.*]] = load
+// CHECK-OFF: call i32 %[[VFN]](
+int id(Shape *S) {
+  return S->id(); // expected-remark {{call to virtual function '(anonymous namespace)::Shape::id' devirtualized because it has a single implementation in the translation unit}}
+}
+
+// CHECK-LABEL: define i32 @_Z4areaPN12_GLOBAL__N_15ShapeE(
+// CHECK: %[[VFN:.*]] = load
+// CHECK: call i32 %[[VFN]](
+int area(Shape *S) {
+  return S->area(); // expected-remark {{call to virtual function '(anonymous namespace)::Shape::area' not devirtualized because it has several implementations in the translation unit}}
+}
+
+// CHECK-LABEL: define i32 @_Z1vPN12_GLOBAL__N_14BaseE(
+// CHECK: call i32 {{.*}}@_ZN12_GLOBAL__N_14Impl1vEv
+int v(Base *B) {
+  return B->v(); // expected-remark {{call to virtual function '(anonymous namespace)::Base::v' devirtualized because it has a single implementation in the translation unit}}
+}
+
+// A class derived after the call still counts.
+// CHECK-LABEL: define i32 @_Z1oPN12_GLOBAL__N_15OtherE(
+// CHECK: %[[VFN:.*]] = load
+// CHECK: call i32 %[[VFN]](
+int o(Other *O) {
+  return O->o(); // expected-remark {{call to virtual function '(anonymous namespace)::Other::o' not devirtualized because it has several implementations in the translation unit}}
+}
+
+namespace {
+struct LateOther : Other {
+  int o() override;
+};
+int LateOther::o() { return 1; }
+}
+int late(LateOther *L) { return L->Other::o(); }
+
+// The implementation expects a pointer to Z rather than to its Y subobject.
+// CHECK-LABEL: define i32 @_Z1yPN12_GLOBAL__N_11YE(
+// CHECK: %[[VFN:.*]] = load
+// CHECK: call i32 %[[VFN]](
+int y(Y *P) {
+  return P->y(); // expected-remark {{call to virtual function '(anonymous namespace)::Y::y' not devirtualized because the implementation is reached through a complex base path}}
+}
+
+struct External {
+  virtual int e();
+};
+struct Final final : External {
+  int e() override;
+};
+
+// CHECK-LABEL: define i32 @_Z1eP8External(
+// CHECK: %[[VFN:.*]] = load
+// CHECK: call i32 %[[VFN]](
+int e(External *P) {
+  return P->e(); // expected-remark {{call to virtual function 'External::e' not devirtualized because its class is visible outside the translation unit}}
+}
+
+// CHECK-LABEL: define i32 @_Z1fP5Final(
+// CHECK: call i32 @_ZN5Final1eEv(
+int f(Final *P) {
+  return P->e(); // expected-remark {{call to virtual function 'Final::e' devirtualized because the class is final}}
+}
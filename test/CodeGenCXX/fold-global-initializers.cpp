@@ -0,0 +1,69 @@
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux -emit-llvm %s -o - | FileCheck --check-prefix=CHECK-DEFAULT %s
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux -emit-llvm -ffold-global-initializers %s -o - | FileCheck %s
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux -emit-llvm-only -ffold-global-initializers -Rglobal-constructors %s 2>&1 | FileCheck --check-prefix=REMARK %s
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux -emit-llvm-only -Rglobal-constructors %s 2>&1 | FileCheck --check-prefix=REMARK-DEFAULT %s
+
+int square(int x) { return x * x; }
+
+// CHECK-DEFAULT: @a = global i32 0
+// CHECK: @a = global i32 9
+// REMARK-NOT: for 'a'
+// REMARK-DEFAULT: remark: emitted a dynamic initializer for 'a' of {{[0-9]+}} IR instructions
+// REMARK-DEFAULT: note: non-constexpr function 'square' cannot be used in a constant expression
+int a = square(3);
+
+struct Point {
+  Point(int x, int y) : x(x), y(y) {}
+  int x, y;
+};
+
+// CHECK-DEFAULT: @p = global %struct.Point zeroinitializer
+// CHECK: @p = global %struct.Point { i32 1, i32 2 }
+Point p(1, 2);
+
+int count();
+
+// CHECK: @b = global i32 0
+// REMARK: remark: emitted a dynamic initializer for 'b' of {{[0-9]+}} IR instructions
+// REMARK: note: undefined function 'count' cannot be used in a constant expression
+int b = count();
+
+int counter;
+int bump() { return ++counter; }
+
+// A dynamic initializer which modifies another global can't be folded.
+// CHECK: @c = global i32 0
+// REMARK: remark: emitted a dynamic initializer for 'c'
+int c = bump();
+
+int withStatic() {
+  static int Calls = count();
+  return 1;
+}
+
+// Folding would skip the initialization of the static local.
+// CHECK: @d = global i32 0
+// REMARK: remark: emitted a dynamic initializer for 'd'
+int d = withStatic();
+
+__attribute__((weak)) int weakValue() { return 1; }
+
+// The definition of a weak function can be replaced at link time.
+// CHECK: @e = global i32 0
+// REMARK: remark: emitted a dynamic initializer for 'e'
+int e = weakValue();
+
+struct Counted {
+  Counted() : n(square(2)) {}
+  ~Counted();
+  int n;
+};
+
+// The destructor still needs to be registered.
+// CHECK: @f = global %struct.Counted { i32 4 }
+// REMARK: remark: emitted a dynamic destructor registration for 'f'
+Counted f;
+
+// CHECK-LABEL: define internal void @__cxx_global_var_init
+// CHECK: call i32 @_Z5countv()
+// CHECK: store i32 {{.*}}, i32* @b
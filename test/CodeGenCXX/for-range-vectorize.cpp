@@ -0,0 +1,78 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -fvectorize-range-for -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -emit-llvm -o - %s | FileCheck -check-prefix=NOHINT %s
+
+// NOHINT-NOT: llvm.loop.vectorize.enable
+
+namespace std {
+inline namespace __1 {
+template <typename T> struct vector {
+  T *b, *e;
+  T *begin();
+  T *end();
+  void push_back(const T &);
+};
+}
+}
+
+struct Point {
+  float x, y;
+};
+
+extern "C" float sqrtf(float);
+float scale(float) __attribute__((const));
+void record(float);
+
+// CHECK-LABEL: define void @_Z5arrayv(
+void array() {
+  float a[64];
+  // CHECK: br label {{.*}}, !llvm.loop ![[ENABLE_1:.*]]
+  for (float &x : a)
+    x = sqrtf(x) * scale(x);
+}
+
+// CHECK-LABEL: define void @_Z6vector{{.*}}(
+void vector(std::vector<float> &v) {
+  // CHECK: br label {{.*}}, !llvm.loop ![[ENABLE_2:.*]]
+  for (float &x : v)
+    x *= 2;
+}
+
+// CHECK-LABEL: define float @_Z6points{{.*}}(
+float points(std::vector<Point> &v) {
+  float Sum = 0;
+  // CHECK: br label {{.*}}, !llvm.loop ![[ENABLE_3:.*]]
+  for (Point p : v)
+    Sum += p.x * p.y;
+  return Sum;
+}
+
+// A call might grow the vector.
+// CHECK-LABEL: define void @_Z4grow{{.*}}(
+void grow(std::vector<float> &v) {
+  // CHECK-NOT: !llvm.loop
+  for (float &x : v)
+    v.push_back(x);
+}
+
+// CHECK-LABEL: define void @_Z4call{{.*}}(
+void call(std::vector<float> &v) {
+  // CHECK-NOT: !llvm.loop
+  for (float &x : v)
+    record(x);
+}
+
+// Explicit loop hints win.
+// CHECK-LABEL: define void @_Z6hinted{{.*}}(
+void hinted(std::vector<float> &v) {
+  // CHECK: br label {{.*}}, !llvm.loop ![[DISABLE:.*]]
+#pragma clang loop vectorize(disable)
+  for (float &x : v)
+    x *= 2;
+}
+
+// CHECK: ![[ENABLE_1]] = distinct !{![[ENABLE_1]], ![[VECTORIZE_ENABLE:.*]]}
+// CHECK: ![[VECTORIZE_ENABLE]] = !{!"llvm.loop.vectorize.enable", i1 true}
+// CHECK: ![[ENABLE_2]] = distinct !{![[ENABLE_2]], ![[VECTORIZE_ENABLE]]}
+// CHECK: ![[ENABLE_3]] = distinct !{![[ENABLE_3]], ![[VECTORIZE_ENABLE]]}
+// CHECK: ![[DISABLE]] = distinct !{![[DISABLE]], ![[WIDTH_1:.*]]}
+// CHECK: ![[WIDTH_1]] = !{!"llvm.loop.vectorize.width", i32 1}
@@ -0,0 +1,111 @@
+// RUN: %clang_cc1 %s -triple x86_64-unknown-linux-gnu -std=c++11 -fexperimental-relative-c++-abi-vtables -emit-llvm -o - | FileCheck %s
+// RUN: not %clang_cc1 %s -triple x86_64-pc-windows-msvc -fexperimental-relative-c++-abi-vtables -emit-llvm -o /dev/null 2>&1 | FileCheck -check-prefix=CHECK-MSVC %s
+
+// CHECK-MSVC: error: unsupported option '-fexperimental-relative-c++-abi-vtables' for target 'x86_64-pc-windows-msvc'
+
+namespace std {
+class type_info;
+}
+
+// Each component is an i32; functions and RTTI are referred to by their
+// offset from the address point, which is the third component.
+// CHECK: @_ZTV1A = unnamed_addr constant { [5 x i32] } { [5 x i32] [i32 0,
+// CHECK-SAME: i32 trunc (i64 sub (i64 ptrtoint (i8** @_ZTI1A.rtti_proxy to i64), i64 ptrtoint (i32* getelementptr inbounds ({ [5 x i32] }, { [5 x i32] }* @_ZTV1A, i32 0, i32 0, {{i32|i64}} 2) to i64)) to i32),
+// CHECK-SAME: i32 trunc (i64 sub (i64 ptrtoint (void (%struct.A*)* @_ZN1A1fEv.stub to i64), i64 ptrtoint (i32* getelementptr inbounds ({ [5 x i32] }, { [5 x i32] }* @_ZTV1A, i32 0, i32 0, {{i32|i64}} 2) to i64)) to i32),
+// CHECK-SAME: i32 trunc (i64 sub (i64 ptrtoint (void (%struct.A*)* @_ZN1A1gEv to i64), i64 ptrtoint (i32* getelementptr inbounds ({ [5 x i32] }, { [5 x i32] }* @_ZTV1A, i32 0, i32 0, {{i32|i64}} 2) to i64)) to i32),
+// CHECK-SAME: i32 trunc (i64 sub (i64 ptrtoint (void ()* @__cxa_pure_virtual.stub to i64), i64 ptrtoint (i32* getelementptr inbounds ({ [5 x i32] }, { [5 x i32] }* @_ZTV1A, i32 0, i32 0, {{i32|i64}} 2) to i64)) to i32)] }, align 4
+
+// The proxy holds the address of the type info.
+// CHECK: @_ZTI1A.rtti_proxy = linkonce_odr hidden unnamed_addr constant i8* bitcast ({{.*}} @_ZTI1A to i8*), comdat
+
+// Virtual bases are found with 32-bit offsets too.
+// CHECK: @_ZTV1C = unnamed_addr constant { [4 x i32] } { [4 x i32] [i32 8, i32 0,
+
+struct A {
+  virtual void f();
+  // A function which cannot be preempted is referred to directly.
+  __attribute__((visibility("hidden"))) virtual void g();
+  virtual void h() = 0;
+};
+
+void A::f() {}
+void A::g() {}
+
+struct B {
+  int b;
+};
+
+struct C : virtual B {
+  virtual void c();
+};
+
+void C::c() {}
+
+// The stub of a preemptible function tail-calls it.
+// CHECK: define linkonce_odr hidden void @_ZN1A1fEv.stub(%struct.A*{{.*}}) unnamed_addr {{.*}}comdat
+// CHECK: musttail call void @_ZN1A1fEv(%struct.A*
+// CHECK-NEXT: ret void
+
+// CHECK-LABEL: define void @_Z4callP1A(
+void call(A *a) {
+  // CHECK: [[VTABLE:%.*]] = load void (%struct.A*)**, void (%struct.A*)*** %{{.*}}
+  // CHECK: [[VTABLE_I8:%.*]] = bitcast void (%struct.A*)** [[VTABLE]] to i8*
+  // CHECK: [[FN:%.*]] = call i8* @llvm.load.relative.i32(i8* [[VTABLE_I8]], i32 4)
+  // CHECK: bitcast i8* [[FN]] to void (%struct.A*)*
+  a->g();
+}
+
+// CHECK-LABEL: define void @_Z6memptrP1AMS_FvvE(
+void memptr(A *a, void (A::*p)()) {
+  // CHECK: memptr.virtual:
+  // CHECK: [[OFFSET:%.*]] = trunc i64 %{{.*}} to i32
+  // CHECK: call i8* @llvm.load.relative.i32(i8* %{{.*}}, i32 [[OFFSET]])
+  (a->*p)();
+}
+
+// CHECK-LABEL: define { i64, i64 } @_Z5ptr_gv(
+// CHECK: ret { i64, i64 } { i64 5, i64 0 }
+void (A::*ptr_g())() { return &A::g; }
+
+// CHECK-LABEL: define %"class.std::type_info"* @_Z7typeid_P1A(
+const std::type_info *typeid_(A *a) {
+  // CHECK: [[PROXY:%.*]] = call i8* @llvm.load.relative.i32(i8* %{{.*}}, i32 -4)
+  // CHECK: [[PROXY_PTR:%.*]] = bitcast i8* [[PROXY]] to %"class.std::type_info"**
+  // CHECK: load %"class.std::type_info"*, %"class.std::type_info"** [[PROXY_PTR]], align 8
+  return &typeid(*a);
+}
+
+// CHECK-LABEL: define i8* @_Z4top_P1A(
+void *top_(A *a) {
+  // CHECK: [[PTR:%.*]] = getelementptr inbounds i8, i8* %{{.*}}, i64 -8
+  // CHECK: [[PTR_I32:%.*]] = bitcast i8* [[PTR]] to i32*
+  // CHECK: [[OFFSET:%.*]] = load i32, i32* [[PTR_I32]], align 4
+  // CHECK: sext i32 [[OFFSET]] to i64
+  return dynamic_cast<void *>(a);
+}
+
+// CHECK-LABEL: define i32 @_Z5vbaseP1C(
+int vbase(C *c) {
+  // CHECK: [[PTR:%.*]] = getelementptr inbounds i8, i8* %{{.*}}, i64 -12
+  // CHECK: [[PTR_I32:%.*]] = bitcast i8* [[PTR]] to i32*
+  // CHECK: [[OFFSET:%.*]] = load i32, i32* [[PTR_I32]], align 4
+  // CHECK: sext i32 [[OFFSET]] to i64
+  return c->b;
+}
+
+struct D {
+  virtual ~D();
+};
+
+// CHECK-LABEL: define void @_Z7gdeleteP1D(
+void gdelete(D *d) {
+  // The offset to the complete object is a 32-bit component as well.
+  // CHECK: [[PTR:%.*]] = getelementptr inbounds i8, i8* %{{.*}}, i64 -8
+  // CHECK: [[PTR_I32:%.*]] = bitcast i8* [[PTR]] to i32*
+  // CHECK: [[OFFSET:%.*]] = load i32, i32* [[PTR_I32]], align 4
+  // CHECK: [[OFFSET_I64:%.*]] = sext i32 [[OFFSET]] to i64
+  // CHECK: getelementptr inbounds i8, i8* %{{.*}}, i64 [[OFFSET_I64]]
+  // CHECK: call i8* @llvm.load.relative.i32(i8* %{{.*}}, i32 0)
+  // CHECK: call void @_ZdlPv(
+  ::delete d;
+}
@@ -28,12 +28,24 @@ struct std::experimental::coroutine_traits<void, global_new_delete_tag> {
 // CHECK-LABEL: f0( 
 extern "C" void f0(global_new_delete_tag) {
   // CHECK: %[[ID:.+]] = call token @llvm.coro.id(i32 16
-  // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
-  // CHECK: call i8* @_Znwm(i64 %[[SIZE]])
+  // CHECK: %[[NEED_ALLOC:.+]] = call i1 @llvm.coro.alloc(token %[[ID]])
+  // CHECK: br i1 %[[NEED_ALLOC]], label %[[ALLOC:.+]], label %[[INIT:.+]]
 
-  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.frame()
-  // CHECK: %[[MEM:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
-  // CHECK: call void @_ZdlPv(i8* %[[MEM]])
+  // CHECK: [[ALLOC]]:
+  // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
+  // CHECK: %[[MEM:.+]] = call i8* @_Znwm(i64 %[[SIZE]])
+  // CHECK: br label %[[INIT]]
+
+  // CHECK: [[INIT]]:
+  // CHECK: %[[PHI:.+]] = phi i8* [ null, %{{.+}} ], [ %[[MEM]], %[[ALLOC]] ]
+  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.begin(token %[[ID]], i8* %[[PHI]])
+  // CHECK: %[[FREE:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
+  // CHECK: %[[NEED_FREE:.+]] = icmp ne i8* %[[FREE]], null
+  // CHECK: br i1 %[[NEED_FREE]], label %[[FREE_BB:.+]], label %[[AFTER_FREE:.+]]
+
+  // CHECK: [[FREE_BB]]:
+  // CHECK: call void @_ZdlPv(i8* %[[FREE]])
+  // CHECK: br label %[[AFTER_FREE]]
   co_await suspend_always{};
 }
 
@@ -53,12 +65,24 @@ struct std::experimental::coroutine_traits<void, promise_new_tag> {
 // CHECK-LABEL: f1( 
 extern "C" void f1(promise_new_tag ) {
   // CHECK: %[[ID:.+]] = call token @llvm.coro.id(i32 16
-  // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
-  // CHECK: call i8* @_ZNSt12experimental16coroutine_traitsIJv15promise_new_tagEE12promise_typenwEm(i64 %[[SIZE]])
+  // CHECK: %[[NEED_ALLOC:.+]] = call i1 @llvm.coro.alloc(token %[[ID]])
+  // CHECK: br i1 %[[NEED_ALLOC]], label %[[ALLOC:.+]], label %[[INIT:.+]]
 
-  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.frame()
-  // CHECK: %[[MEM:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
-  // CHECK: call void @_ZdlPv(i8* %[[MEM]])
+  // CHECK: [[ALLOC]]:
+  // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
+  // CHECK: %[[MEM:.+]] = call i8* @_ZNSt12experimental16coroutine_traitsIJv15promise_new_tagEE12promise_typenwEm(i64 %[[SIZE]])
+  // CHECK: br label %[[INIT]]
+
+  // CHECK: [[INIT]]:
+  // CHECK: %[[PHI:.+]] = phi i8* [ null, %{{.+}} ], [ %[[MEM]], %[[ALLOC]] ]
+  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.begin(token %[[ID]], i8* %[[PHI]])
+  // CHECK: %[[FREE:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
+  // CHECK: %[[NEED_FREE:.+]] = icmp ne i8* %[[FREE]], null
+  // CHECK: br i1 %[[NEED_FREE]], label %[[FREE_BB:.+]], label %[[AFTER_FREE:.+]]
+
+  // CHECK: [[FREE_BB]]:
+  // CHECK: call void @_ZdlPv(i8* %[[FREE]])
+  // CHECK: br label %[[AFTER_FREE]]
   co_await suspend_always{};
 }
 
@@ -78,12 +102,24 @@ struct std::experimental::coroutine_traits<void, promise_delete_tag> {
 // CHECK-LABEL: f2( 
 extern "C" void f2(promise_delete_tag) {
   // CHECK: %[[ID:.+]] = call token @llvm.coro.id(i32 16
-  // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
-  // CHECK: call i8* @_Znwm(i64 %[[SIZE]])
+  // CHECK: %[[NEED_ALLOC:.+]] = call i1 @llvm.coro.alloc(token %[[ID]])
+  // CHECK: br i1 %[[NEED_ALLOC]], label %[[ALLOC:.+]], label %[[INIT:.+]]
 
-  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.frame()
-  // CHECK: %[[MEM:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
-  // CHECK: call void @_ZNSt12experimental16coroutine_traitsIJv18promise_delete_tagEE12promise_typedlEPv(i8* %[[MEM]])
+  // CHECK: [[ALLOC]]:
+  // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
+  // CHECK: %[[MEM:.+]] = call i8* @_Znwm(i64 %[[SIZE]])
+  // CHECK: br label %[[INIT]]
+
+  // CHECK: [[INIT]]:
+  // CHECK: %[[PHI:.+]] = phi i8* [ null, %{{.+}} ], [ %[[MEM]], %[[ALLOC]] ]
+  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.begin(token %[[ID]], i8* %[[PHI]])
+  // CHECK: %[[FREE:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
+  // CHECK: %[[NEED_FREE:.+]] = icmp ne i8* %[[FREE]], null
+  // CHECK: br i1 %[[NEED_FREE]], label %[[FREE_BB:.+]], label %[[AFTER_FREE:.+]]
+
+  // CHECK: [[FREE_BB]]:
+  // CHECK: call void @_ZNSt12experimental16coroutine_traitsIJv18promise_delete_tagEE12promise_typedlEPv(i8* %[[FREE]])
+  // CHECK: br label %[[AFTER_FREE]]
   co_await suspend_always{};
 }
 
@@ -103,12 +139,24 @@ struct std::experimental::coroutine_traits<void, promise_sized_delete_tag> {
 // CHECK-LABEL: f3( 
 extern "C" void f3(promise_sized_delete_tag) {
   // CHECK: %[[ID:.+]] = call token @llvm.coro.id(i32 16
+  // CHECK: %[[NEED_ALLOC:.+]] = call i1 @llvm.coro.alloc(token %[[ID]])
+  // CHECK: br i1 %[[NEED_ALLOC]], label %[[ALLOC:.+]], label %[[INIT:.+]]
+
+  // CHECK: [[ALLOC]]:
   // CHECK: %[[SIZE:.+]] = call i64 @llvm.coro.size.i64()
-  // CHECK: call i8* @_Znwm(i64 %[[SIZE]])
+  // CHECK: %[[MEM:.+]] = call i8* @_Znwm(i64 %[[SIZE]])
+  // CHECK: br label %[[INIT]]
+
+  // CHECK: [[INIT]]:
+  // CHECK: %[[PHI:.+]] = phi i8* [ null, %{{.+}} ], [ %[[MEM]], %[[ALLOC]] ]
+  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.begin(token %[[ID]], i8* %[[PHI]])
+  // CHECK: %[[FREE:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
+  // CHECK: %[[NEED_FREE:.+]] = icmp ne i8* %[[FREE]], null
+  // CHECK: br i1 %[[NEED_FREE]], label %[[FREE_BB:.+]], label %[[AFTER_FREE:.+]]
 
-  // CHECK: %[[FRAME:.+]] = call i8* @llvm.coro.frame()
-  // CHECK: %[[MEM:.+]] = call i8* @llvm.coro.free(token %[[ID]], i8* %[[FRAME]])
+  // CHECK: [[FREE_BB]]:
   // CHECK: %[[SIZE2:.+]] = call i64 @llvm.coro.size.i64()
-  // CHECK: call void @_ZNSt12experimental16coroutine_traitsIJv24promise_sized_delete_tagEE12promise_typedlEPvm(i8* %[[MEM]], i64 %[[SIZE2]])
+  // CHECK: call void @_ZNSt12experimental16coroutine_traitsIJv24promise_sized_delete_tagEE12promise_typedlEPvm(i8* %[[FREE]], i64 %[[SIZE2]])
+  // CHECK: br label %[[AFTER_FREE]]
   co_await suspend_always{};
 }
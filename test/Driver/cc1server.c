@@ -0,0 +1,24 @@
+// RUN: not %clang -cc1server 2>&1 | FileCheck %s
+// CHECK: error: usage: clang -cc1server [-v] <socket path>
+
+// When no server is listening, jobs are run as usual.
+// RUN: rm -f %t.sock
+// RUN: env CLANG_CC1_SERVER=%t.sock %clang -fsyntax-only %s
+
+// The socket must be in a directory nobody else can access.
+// RUN: rm -rf %t.dir && mkdir %t.dir && chmod 755 %t.dir
+// RUN: not %clang -cc1server %t.dir/sock 2>&1 | FileCheck -check-prefix=PUBLIC %s
+// PUBLIC: error: socket path '{{.*}}sock' must be in a directory which only its owner can access
+
+// Jobs are handed to a running server.
+// REQUIRES: shell
+// RUN: chmod 700 %t.dir
+// RUN: %clang -cc1server -v %t.dir/sock 2> %t.log & echo $! > %t.pid
+// RUN: for i in 1 2 3 4 5 6 7 8 9 10; do test -S %t.dir/sock && break; sleep 1; done
+// RUN: env CLANG_CC1_SERVER=%t.dir/sock %clang -fsyntax-only -DFROM_SERVER %s; \
+// RUN:   Res=$?; kill `cat %t.pid`; test $Res = 0
+// RUN: test "`stat -c %%a %t.dir/sock 2>/dev/null || stat -f %%Lp %t.dir/sock`" = 600
+// RUN: FileCheck -check-prefix=SERVER %s < %t.log
+// SERVER: -cc1 {{.*}}-fsyntax-only{{.*}}-D FROM_SERVER
+
+int x;
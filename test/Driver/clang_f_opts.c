@@ -178,6 +178,50 @@
 // CHECK-SLP-VECTORIZE-AGG: "-vectorize-slp-aggressive"
 // CHECK-NO-SLP-VECTORIZE-AGG-NOT: "-vectorize-slp-aggressive"
 
+// RUN: %clang -### -S -fvectorize-range-for %s 2>&1 | FileCheck -check-prefix=CHECK-VECTORIZE-RANGE-FOR %s
+// RUN: %clang -### -S -fvectorize-range-for -fno-vectorize-range-for %s 2>&1 | FileCheck -check-prefix=CHECK-NO-VECTORIZE-RANGE-FOR %s
+// RUN: %clang -### -S -O3 %s 2>&1 | FileCheck -check-prefix=CHECK-NO-VECTORIZE-RANGE-FOR %s
+// CHECK-VECTORIZE-RANGE-FOR: "-fvectorize-range-for"
+// CHECK-NO-VECTORIZE-RANGE-FOR-NOT: "-fvectorize-range-for"
+
+// RUN: %clang -### -S -fexperimental-relative-c++-abi-vtables %s 2>&1 | FileCheck -check-prefix=CHECK-RELATIVE-VTABLES %s
+// RUN: %clang -### -S -fexperimental-relative-c++-abi-vtables -fno-experimental-relative-c++-abi-vtables %s 2>&1 | FileCheck -check-prefix=CHECK-NO-RELATIVE-VTABLES %s
+// CHECK-RELATIVE-VTABLES: "-fexperimental-relative-c++-abi-vtables"
+// CHECK-NO-RELATIVE-VTABLES-NOT: "-fexperimental-relative-c++-abi-vtables"
+
+// RUN: %clang -### -S -fdevirtualize-internal-classes %s 2>&1 | FileCheck -check-prefix=CHECK-DEVIRTUALIZE-INTERNAL %s
+// RUN: %clang -### -S -fdevirtualize-internal-classes -fno-devirtualize-internal-classes %s 2>&1 | FileCheck -check-prefix=CHECK-NO-DEVIRTUALIZE-INTERNAL %s
+// CHECK-DEVIRTUALIZE-INTERNAL: "-fdevirtualize-internal-classes"
+// CHECK-NO-DEVIRTUALIZE-INTERNAL-NOT: "-fdevirtualize-internal-classes"
+
+// RUN: %clang -### -S -ffold-global-initializers %s 2>&1 | FileCheck -check-prefix=CHECK-FOLD-GLOBAL-INIT %s
+// RUN: %clang -### -S -ffold-global-initializers -fno-fold-global-initializers %s 2>&1 | FileCheck -check-prefix=CHECK-NO-FOLD-GLOBAL-INIT %s
+// CHECK-FOLD-GLOBAL-INIT: "-ffold-global-initializers"
+// CHECK-NO-FOLD-GLOBAL-INIT-NOT: "-ffold-global-initializers"
+
+// RUN: %clang -### -S -fshare-landing-pads %s 2>&1 | FileCheck -check-prefix=CHECK-SHARE-LANDING-PADS %s
+// RUN: %clang -### -S -fshare-landing-pads -fno-share-landing-pads %s 2>&1 | FileCheck -check-prefix=CHECK-NO-SHARE-LANDING-PADS %s
+// CHECK-SHARE-LANDING-PADS: "-fshare-landing-pads"
+// CHECK-NO-SHARE-LANDING-PADS-NOT: "-fshare-landing-pads"
+
+// RUN: %clang -### -S -foutline-eh-cleanups %s 2>&1 | FileCheck -check-prefix=CHECK-OUTLINE-EH-CLEANUPS %s
+// RUN: %clang -### -S -foutline-eh-cleanups -fno-outline-eh-cleanups %s 2>&1 | FileCheck -check-prefix=CHECK-NO-OUTLINE-EH-CLEANUPS %s
+// CHECK-OUTLINE-EH-CLEANUPS: "-foutline-eh-cleanups"
+// CHECK-NO-OUTLINE-EH-CLEANUPS-NOT: "-foutline-eh-cleanups"
+
+// RUN: %clang -### -S -fprecise-struct-path-tbaa %s 2>&1 | FileCheck -check-prefix=CHECK-PRECISE-TBAA %s
+// RUN: %clang -### -S -fprecise-struct-path-tbaa -fno-precise-struct-path-tbaa %s 2>&1 | FileCheck -check-prefix=CHECK-NO-PRECISE-TBAA %s
+// CHECK-PRECISE-TBAA: "-fprecise-struct-path-tbaa"
+// CHECK-NO-PRECISE-TBAA-NOT: "-fprecise-struct-path-tbaa"
+
+// RUN: %clang -### -S -fbuiltin-headers-pch %s 2>&1 | FileCheck -check-prefix=CHECK-BUILTIN-HEADERS-PCH %s
+// RUN: %clang -### -S -fbuiltin-headers-pch -fbuiltin-headers-pch-path=/tmp/pch %s 2>&1 | FileCheck -check-prefix=CHECK-BUILTIN-HEADERS-PCH-PATH %s
+// RUN: %clang -### -S -fbuiltin-headers-pch -fno-builtin-headers-pch %s 2>&1 | FileCheck -check-prefix=CHECK-NO-BUILTIN-HEADERS-PCH %s
+// RUN: %clang -### -S -fbuiltin-headers-pch -fmodules %s 2>&1 | FileCheck -check-prefix=CHECK-NO-BUILTIN-HEADERS-PCH %s
+// CHECK-BUILTIN-HEADERS-PCH: "-fbuiltin-headers-pch-path={{.*}}BuiltinHeadersPCH"
+// CHECK-BUILTIN-HEADERS-PCH-PATH: "-fbuiltin-headers-pch-path=/tmp/pch"
+// CHECK-NO-BUILTIN-HEADERS-PCH-NOT: "-fbuiltin-headers-pch-path=
+
 // RUN: %clang -### -S -fextended-identifiers %s 2>&1 | FileCheck -check-prefix=CHECK-EXTENDED-IDENTIFIERS %s
 // RUN: %clang -### -S -fno-extended-identifiers %s 2>&1 | FileCheck -check-prefix=CHECK-NO-EXTENDED-IDENTIFIERS %s
 // CHECK-EXTENDED-IDENTIFIERS: "-cc1"
@@ -482,3 +526,6 @@
 // RUN: %clang -### -S -fno-strict-return %s 2>&1 | FileCheck -check-prefix=CHECK-NO-STRICT-RETURN %s
 // CHECK-STRICT-RETURN-NOT: "-fno-strict-return"
 // CHECK-NO-STRICT-RETURN: "-fno-strict-return"
+
+// RUN: %clang -### -S -fdiagnostics-template-depth=3 %s 2>&1 | FileCheck -check-prefix=CHECK-TEMPLATE-DEPTH %s
+// CHECK-TEMPLATE-DEPTH: "-fdiagnostics-template-depth" "3"
@@ -0,0 +1,56 @@
+// Check that -fcompile-cache-dir reuses the object file and the diagnostics
+// of an earlier compile job, as long as the files it read are unchanged.
+//
+// REQUIRES: shell, x86-registered-target
+//
+// RUN: rm -rf %t && mkdir -p %t/include
+// RUN: echo 'int f(void);' > %t/include/h.h
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/first.o \
+// RUN:     -I%t/include -fcompile-cache-dir=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-WARNING %s
+// RUN: ls %t/cache/*.manifest
+// CHECK-WARNING: warning: compiled
+// CHECK-WARNING-NOT: argument unused
+//
+// Replace the cached object, to tell a reused result from a recompile.
+// RUN: for f in %t/cache/*.o; do echo cached > $f; done
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/second.o \
+// RUN:     -I%t/include -fcompile-cache-dir=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-WARNING %s
+// RUN: grep cached %t/second.o
+//
+// A change to an included file is a miss.
+// RUN: echo 'int f(int);' > %t/include/h.h
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/third.o \
+// RUN:     -I%t/include -fcompile-cache-dir=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-WARNING %s
+// RUN: not grep cached %t/third.o
+//
+// Jobs with outputs other than the object file are not cached, so a second
+// run still writes them.
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/coverage.o --coverage \
+// RUN:     -I%t/include -fcompile-cache-dir=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-WARNING %s
+// RUN: rm %t/coverage.gcno
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/coverage.o --coverage \
+// RUN:     -I%t/include -fcompile-cache-dir=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-WARNING %s
+// RUN: ls %t/coverage.gcno
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/record.o \
+// RUN:     -fsave-optimization-record -I%t/include \
+// RUN:     -fcompile-cache-dir=%t/cache > /dev/null 2>&1
+// RUN: rm %t/record.opt.yaml
+// RUN: %clang -target x86_64-unknown-linux -c %s -o %t/record.o \
+// RUN:     -fsave-optimization-record -I%t/include \
+// RUN:     -fcompile-cache-dir=%t/cache > /dev/null 2>&1
+// RUN: ls %t/record.opt.yaml
+//
+// RUN: %clang -### -c %s -fcompile-cache-dir=%t/cache 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-NO-CC1 %s
+// CHECK-NO-CC1-NOT: fcompile-cache-dir
+
+#include "h.h"
+
+#warning compiled
+
+int g(void) { return 0; }
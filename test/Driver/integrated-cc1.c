@@ -0,0 +1,41 @@
+// RUN: %clang -fintegrated-cc1 -c %s -o %t.o
+// RUN: test -f %t.o
+// RUN: %clang -fintegrated-cc1 -fno-integrated-cc1 -fsyntax-only %s
+
+// -### shows which jobs run in the driver's process.
+// RUN: %clang -fintegrated-cc1 -### -c %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-IN-PROCESS %s
+// CHECK-IN-PROCESS: (in-process)
+// CHECK-IN-PROCESS-NEXT: "-cc1"
+// RUN: %clang -fintegrated-cc1 -fno-integrated-cc1 -### -c %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-SPAWNED %s
+// CHECK-SPAWNED-NOT: (in-process)
+
+// Errors are reported, and the exit code is kept.
+// RUN: not %clang -fintegrated-cc1 -fsyntax-only -DERROR %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-ERROR %s
+// CHECK-ERROR: error: in-process error
+
+// A fatal error ends the job rather than the driver, which reports the status
+// the job would have exited with.
+// RUN: not %clang -fintegrated-cc1 -fno-crash-diagnostics -fsyntax-only \
+// RUN:   -DFATAL %s 2>&1 | FileCheck --check-prefix=CHECK-FATAL %s
+// CHECK-FATAL: fatal error: error in backend: #pragma clang __debug llvm_fatal_error
+// CHECK-FATAL: error: clang frontend command failed with exit code 70
+
+// Each job parses its own -mllvm options.
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s %s \
+// RUN:   -mllvm -asm-macro-max-nesting-depth=10
+// RUN: %clang -fintegrated-cc1 -### -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-UNUSED %s
+// CHECK-UNUSED-NOT: argument unused
+
+#ifdef ERROR
+#error in-process error
+#endif
+
+#ifdef FATAL
+#pragma clang __debug llvm_fatal_error
+#endif
+
+int x;
@@ -64,3 +64,6 @@
 // CHECK-NO-MODULE-FILES-NOT: "-fmodules"
 // CHECK-NO-MODULE-FILES-NOT: "-fmodule-file=foo.pcm"
 // CHECK-NO-MODULE-FILES-NOT: "-fmodule-file=bar.pcm"
+
+// RUN: %clang -fmodules -fmodules-build-threads=4 -### %s 2>&1 | FileCheck -check-prefix=CHECK-BUILD-THREADS %s
+// CHECK-BUILD-THREADS: -fmodules-build-threads=4
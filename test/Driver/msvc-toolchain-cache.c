@@ -0,0 +1,32 @@
+// Check that --toolchain-cache records the detected Visual Studio and
+// Windows SDK installations, and that a later run uses the recorded ones.
+//
+// REQUIRES: shell
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: env -u INCLUDE 'VCINSTALLDIR=C:\fake\VC' %clang_cl -### /c \
+// RUN:     --toolchain-cache=%t/cache -- %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-DETECTED %s
+// CHECK-DETECTED-NOT: argument unused
+// CHECK-DETECTED: "-internal-isystem" "C:{{.*}}fake{{.*}}VC{{.*}}include"
+//
+// RUN: FileCheck --check-prefix=CHECK-FILE %s < %t/cache
+// CHECK-FILE: key msvc{{.*}}VCINSTALLDIR=C:\fake\VC
+// CHECK-FILE-NEXT: vs 1 C:\fake
+// CHECK-FILE-NEXT: sdk
+// CHECK-FILE-NEXT: ucrt
+// CHECK-FILE: end
+//
+// Edit the recorded installation; the next run must pick the edit up.
+// RUN: sed -e '/^vs/s/fake/edited/' %t/cache > %t/cache.edited
+// RUN: mv %t/cache.edited %t/cache
+// RUN: env -u INCLUDE 'VCINSTALLDIR=C:\fake\VC' %clang_cl -### /c \
+// RUN:     --toolchain-cache=%t/cache -- %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-CACHED %s
+// CHECK-CACHED: "-internal-isystem" "C:{{.*}}edited{{.*}}VC{{.*}}include"
+//
+// A different environment is a different entry.
+// RUN: env -u INCLUDE 'VCINSTALLDIR=C:\other\VC' %clang_cl -### /c \
+// RUN:     --toolchain-cache=%t/cache -- %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-OTHER %s
+// CHECK-OTHER: "-internal-isystem" "C:{{.*}}other{{.*}}VC{{.*}}include"
@@ -0,0 +1,33 @@
+// RUN: %clang -### -fparallel-jobs=4 -c %s %s 2>&1 | FileCheck %s
+// CHECK-NOT: argument unused during compilation
+// CHECK: "-cc1"
+// CHECK: "-cc1"
+
+// RUN: not %clang -### -fparallel-jobs=0 -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-ZERO %s
+// CHECK-ZERO: error: invalid integral value '0' in '-fparallel-jobs=0'
+
+// RUN: not %clang -### -fparallel-jobs=many -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-INVALID %s
+// CHECK-INVALID: error: invalid integral value 'many' in '-fparallel-jobs=many'
+
+// Independent jobs run concurrently; a failing job is still reported.
+// RUN: %clang -fparallel-jobs=2 -fsyntax-only %s %s
+// RUN: not %clang -fparallel-jobs=2 -fsyntax-only -DFAIL %s %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-FAIL %s
+// CHECK-FAIL: error: intentional failure
+
+// Without -fparallel-jobs=, jobs run one at a time and the driver stops at
+// the first one that fails, so its error is reported once. This holds for the
+// device jobs of a CUDA compilation for several GPU archs too.
+// RUN: not %clang -fsyntax-only -DFAIL %s %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-SERIAL %s
+// RUN: not %clang -x cuda --cuda-device-only -nocudainc -nocudalib \
+// RUN:     --cuda-gpu-arch=sm_30 --cuda-gpu-arch=sm_35 -fsyntax-only -DFAIL \
+// RUN:     %s 2>&1 | FileCheck -check-prefix=CHECK-SERIAL %s
+// CHECK-SERIAL: error: intentional failure
+// CHECK-SERIAL-NOT: error: intentional failure
+
+#ifdef FAIL
+#error intentional failure
+#endif
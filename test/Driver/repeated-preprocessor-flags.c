@@ -0,0 +1,22 @@
+// Repeated -I, -F and -D flags are only passed to cc1 once.
+// RUN: %clang -### -fsyntax-only %s 2>&1 \
+// RUN:     -Ifoo -Ibar -Ifoo -I foo -Ffw -Ffw \
+// RUN:     -DA -DB=1 -DA -DB=1 \
+// RUN:   | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-I" "foo" "-I" "bar" "-Ffw" "-D" "A" "-D" "B=1"
+// CHECK-NOT: "-I" "foo"
+// CHECK-NOT: "-Ffw"
+// CHECK-NOT: "-D" "A"
+
+// A macro defined again after it changed is passed again.
+// RUN: %clang -### -fsyntax-only %s 2>&1 \
+// RUN:     -DA=1 -DA=2 -DA=1 -DB -UB -DB '-DF(x)=x' -UF '-DF(x)=x' \
+// RUN:   | FileCheck --check-prefix=CHECK-CHANGED %s
+// CHECK-CHANGED: "-D" "A=1" "-D" "A=2" "-D" "A=1" "-D" "B" "-U" "B" "-D" "B" "-D" "F(x)=x" "-U" "F" "-D" "F(x)=x"
+
+// Nothing is dropped with -index-header-map, which applies to the next flag.
+// RUN: %clang -### -fsyntax-only %s 2>&1 \
+// RUN:     -Ifoo -index-header-map -Ifoo \
+// RUN:   | FileCheck --check-prefix=CHECK-MAP %s
+// CHECK-MAP: "-I" "foo" "-index-header-map" "-I" "foo"
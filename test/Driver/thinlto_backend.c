@@ -5,6 +5,10 @@
 // RUN: %clang -O2 -o %t1.o -x ir %t.o -c -fthinlto-index=%t.thinlto.bc -### 2>&1 | FileCheck %s -check-prefix=CHECK-THINLTOBE-ACTION
 // CHECK-THINLTOBE-ACTION: -fthinlto-index=
 
+// -fthinlto-cache-dir should be passed to cc1 along with it
+// RUN: %clang -O2 -o %t1.o -x ir %t.o -c -fthinlto-index=%t.thinlto.bc -fthinlto-cache-dir=%t.cache -### 2>&1 | FileCheck %s -check-prefix=CHECK-THINLTOBE-CACHE
+// CHECK-THINLTOBE-CACHE: -fthinlto-index={{.*}} "-fthinlto-cache-dir={{.*}}.cache"
+
 // Ensure clang driver gives the expected error for incorrect input type
 // RUN: not %clang -O2 -o %t1.o %s -c -fthinlto-index=%t.thinlto.bc 2>&1 | FileCheck %s -check-prefix=CHECK-WARNING
 // CHECK-WARNING: error: invalid argument '-fthinlto-index={{.*}}' only allowed with '-x ir'
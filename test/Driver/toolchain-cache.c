@@ -0,0 +1,40 @@
+// Check that --toolchain-cache records the detected GCC installation, and
+// that a later run uses the recorded one instead of detecting it again.
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp -R %S/Inputs/basic_linux_tree %t/tree
+// RUN: %clang -no-canonical-prefixes -### -o %t.o %s 2>&1 \
+// RUN:     -target x86_64-unknown-linux --sysroot=%t/tree \
+// RUN:     --toolchain-cache=%t/cache \
+// RUN:   | FileCheck --check-prefix=CHECK-DETECTED %s
+// CHECK-DETECTED-NOT: argument unused
+// CHECK-DETECTED: "{{.*}}/tree/usr/lib/gcc/x86_64-unknown-linux/4.6.0{{/|\\\\}}crtbegin.o"
+//
+// RUN: FileCheck --check-prefix=CHECK-FILE %s < %t/cache
+// CHECK-FILE: key{{.*}}x86_64-unknown-linux
+// CHECK-FILE-NEXT: result 1 1 x86_64-unknown-linux 4.6.0 {{.*}}/tree/usr/lib/gcc/x86_64-unknown-linux/4.6.0
+// CHECK-FILE: stamp {{[0-9]+}} {{.*}}/tree/usr/lib/gcc
+// CHECK-FILE: end
+//
+// Edit the recorded installation; the next run must pick the edit up.
+// RUN: sed -e '/^result/s|x86_64-unknown-linux/4.6.0|i386-unknown-linux/4.6.0|g' \
+// RUN:     %t/cache > %t/cache.edited
+// RUN: mv %t/cache.edited %t/cache
+// RUN: %clang -no-canonical-prefixes -### -o %t.o %s 2>&1 \
+// RUN:     -target x86_64-unknown-linux --sysroot=%t/tree \
+// RUN:     --toolchain-cache=%t/cache \
+// RUN:   | FileCheck --check-prefix=CHECK-CACHED %s
+// CHECK-CACHED: "{{.*}}/tree/usr/lib/gcc/i386-unknown-linux/4.6.0{{/|\\\\}}crtbegin.o"
+//
+// A change to a probed directory invalidates the entry.
+// RUN: mkdir %t/tree/usr/lib/gcc/x86_64-unknown-linux/4.1.0
+// RUN: %clang -no-canonical-prefixes -### -o %t.o %s 2>&1 \
+// RUN:     -target x86_64-unknown-linux --sysroot=%t/tree \
+// RUN:     --toolchain-cache=%t/cache \
+// RUN:   | FileCheck --check-prefix=CHECK-DETECTED %s
+//
+// The option is accepted by toolchains that do not detect GCC.
+// RUN: %clang -### -target x86_64-apple-darwin -c %s 2>&1 \
+// RUN:     --toolchain-cache=%t/unused \
+// RUN:   | FileCheck --check-prefix=CHECK-UNUSED %s
+// CHECK-UNUSED-NOT: argument unused
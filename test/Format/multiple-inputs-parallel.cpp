@@ -0,0 +1,18 @@
+// RUN: cp %s %t-1.cpp
+// RUN: cp %s %t-2.cpp
+// RUN: cp %s %t-3.cpp
+// RUN: echo 'int   j ;' > %t-4.cpp
+// RUN: clang-format -style=LLVM -j 3 %t-1.cpp %t-2.cpp %t-3.cpp %t-4.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: clang-format -style=LLVM -j 3 -i %t-1.cpp %t-2.cpp %t-3.cpp
+// RUN: FileCheck -strict-whitespace -input-file=%t-1.cpp %s -check-prefix=INPLACE
+// RUN: FileCheck -strict-whitespace -input-file=%t-3.cpp %s -check-prefix=INPLACE
+
+// The output of every file is written in the order the files were given.
+// CHECK: {{^int\ \*i;}}
+// CHECK: {{^int\ \*i;}}
+// CHECK: {{^int\ \*i;}}
+// CHECK: {{^int\ j;}}
+
+// INPLACE: {{^int\ \*i;}}
+ int   *  i  ;
@@ -0,0 +1,7 @@
+#pragma once
+
+template <typename T> struct Box {
+  T Value;
+};
+
+inline int get() { return Box<int>().Value; }
@@ -0,0 +1,11 @@
+// A comment mentioning # include "not-a-file.h"
+/* # include "also-not-a-file.h"
+ */
+#ifndef MINIMIZE_A_H
+#define MINIMIZE_A_H
+#define HEADER \
+  "minimize-b.h"
+const char *s = "#include \"not-a-file.h\"";
+int f(void) { return '#'; }
+  #include HEADER
+#endif
@@ -0,0 +1,3 @@
+template <typename T> struct S {
+  T get() { return T(); }
+};
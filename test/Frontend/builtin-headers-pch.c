@@ -0,0 +1,25 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -ffreestanding -fsyntax-only -fbuiltin-headers-pch-path=%t -Rbuiltin-headers-pch %s 2>&1 | FileCheck --check-prefix=BUILD %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -ffreestanding -fsyntax-only -fbuiltin-headers-pch-path=%t -Rbuiltin-headers-pch %s 2>&1 | FileCheck --allow-empty --check-prefix=REUSE %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -ffreestanding -emit-llvm -fbuiltin-headers-pch-path=%t -Rbuiltin-headers-pch %s -o - 2>&1 | FileCheck --check-prefix=IR %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -ffreestanding -fsyntax-only -fbuiltin-headers-pch-path=%t -sys-header-deps -MT %s.o -dependency-file %t.d %s
+// RUN: FileCheck --check-prefix=DEPS %s < %t.d
+// RUN: ls %t | FileCheck --check-prefix=CACHE %s
+
+// A different set of headers gets a precompiled header of its own.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -ffreestanding -fsyntax-only -fbuiltin-headers-pch-path=%t -Rbuiltin-headers-pch %S/Inputs/builtin-headers-pch.c 2>&1 | FileCheck --check-prefix=BUILD %s
+
+// BUILD: remark: building precompiled builtin headers '{{.*}}.pch'
+// REUSE-NOT: remark
+// IR-NOT: remark
+// IR: define i32 @f(i64
+// DEPS-DAG: stdint.h
+// DEPS-DAG: stddef.h
+// CACHE: .h
+// CACHE: .pch
+
+/* Comments may come before the headers. */
+#include <stdint.h>
+#include <stddef.h> // and after them.
+
+int32_t f(size_t n) { return (int32_t)n; }
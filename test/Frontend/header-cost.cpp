@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -fheader-cost-file=%t/costs %s
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -fheader-cost-file=%t/costs %s
+// RUN: FileCheck %s < %t/costs
+// RUN: %clang -### -fsyntax-only -fheader-cost-file=%t/costs %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-DRIVER %s
+//
+// The header is entered once per compilation, and instantiates Box<int>.
+// CHECK: # TUs	includes	time (us)	tokens	decls	instantiations	AST bytes	header
+// CHECK-NOT: header-cost.cpp
+// CHECK: {{^}}2	2	{{[0-9]+}}	{{[1-9][0-9]*}}	{{[1-9][0-9]*}}	2	{{[1-9][0-9]*}}	{{.*}}Inputs{{/|\\}}header-cost.h{{$}}
+// CHECK-NOT: header-cost.cpp
+//
+// CHECK-DRIVER: "-cc1"
+// CHECK-DRIVER-SAME: "-fheader-cost-file={{.*}}costs"
+
+#include "header-cost.h"
+#include "header-cost.h"
+
+int f() { return get() + Box<long>().Value; }
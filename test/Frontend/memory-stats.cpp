@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: *** Memory Stats:
+// CHECK-NEXT: Allocator {{ +}}Allocated {{ +}}Slabs {{ +}}Wasted
+// CHECK-NEXT: ASTContext {{ +[0-9]+ +[0-9]+ +[0-9]+$}}
+// CHECK-NEXT: Sema {{ +[0-9]+ +[0-9]+ +[0-9]+$}}
+// CHECK-NEXT: Preprocessor {{ +[0-9]+ +[0-9]+ +[0-9]+$}}
+// CHECK-NEXT: IdentifierTable {{ +[0-9]+ +[0-9]+ +[0-9]+$}}
+// CHECK-NEXT: SourceManager {{ +[0-9]+ +[0-9]+ +[0-9]+$}}
+// CHECK-NEXT: Other {{ +}}Bytes
+// CHECK-NEXT: ASTContext side tables {{ +[0-9]+$}}
+// CHECK: Largest node kinds {{ +}}Count {{ +}}Bytes
+// CHECK: CXXMethodDecl {{ +}}20 {{ +[0-9]+$}}
+
+struct S {
+#define M(N) void f##N();
+  M(0) M(1) M(2) M(3) M(4) M(5) M(6) M(7) M(8) M(9)
+  M(10) M(11) M(12) M(13) M(14) M(15) M(16) M(17) M(18) M(19)
+};
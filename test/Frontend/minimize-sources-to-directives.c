@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -Eonly -minimize-sources-to-directives -I %S/Inputs \
+// RUN:   -dependency-file %t.d -MT out %s
+// RUN: FileCheck -check-prefix=DEPS %s < %t.d
+// RUN: %clang_cc1 -E -minimize-sources-to-directives -I %S/Inputs %s \
+// RUN:   | FileCheck %s
+
+// Only the directives of each file are preprocessed, at their original
+// lines, so the same headers are found.
+#include "minimize-a.h"
+int not_kept;
+#if __LINE__ == 11
+#include "minimize-b.h"
+#endif
+
+// DEPS: out:
+// DEPS: minimize-a.h
+// DEPS: minimize-b.h
+
+// CHECK-NOT: not_kept
+// CHECK-NOT: int b;
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t/a %t/b
+// RUN: echo 'int x;' > %t/b/header.h
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -stat-cache %t/cache %s
+// RUN: not ls %t/cache
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -stat-cache %t/cache \
+// RUN:   -stat-cache-update %s
+// RUN: ls %t/cache
+// RUN: %clang_cc1 -fsyntax-only -I %t/a -I %t/b -stat-cache %t/cache \
+// RUN:   -stat-cache-update %s
+//
+// Adding the header to the directory invalidates the cached miss.
+// RUN: echo '#error found the new header' > %t/a/header.h
+// RUN: not %clang_cc1 -fsyntax-only -I %t/a -I %t/b -stat-cache %t/cache \
+// RUN:   -stat-cache-update %s 2>&1 | FileCheck %s
+// CHECK: error: found the new header
+
+#include "header.h"
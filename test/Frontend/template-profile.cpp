@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -fsyntax-only -ftemplate-profile %s 2>&1 | FileCheck %s
+// RUN: %clang -### -fsyntax-only -ftemplate-profile %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-DRIVER %s
+//
+// CHECK: Template instantiation profile
+// CHECK: Time (ms)   Self (ms)    Count  Self AST (KB)  Template
+// CHECK-DAG: {{^ +[0-9.]+ +[0-9.]+ +3 +[0-9.]+  }}Box{{$}}
+// CHECK-DAG: from {{.*}}template-profile.cpp:25 (2), {{.*}}template-profile.cpp:26 (1)
+// CHECK-DAG: {{^ +[0-9.]+ +[0-9.]+ +2 +[0-9.]+  }}Box{{.*}}::get{{$}}
+// CHECK-DAG: from {{.*}}template-profile.cpp:27 (2){{$}}
+// CHECK-DAG: {{^ +[0-9.]+ +[0-9.]+ +3 +[0-9.]+  }}Fact{{$}}
+// CHECK-DAG: from {{.*}}template-profile.cpp:21 (2), {{.*}}template-profile.cpp:27 (1)
+//
+// CHECK-DRIVER: "-cc1"
+// CHECK-DRIVER-SAME: "-ftemplate-profile"
+
+template <typename T> struct Box {
+  T get() { return T(); }
+};
+
+template <int N> struct Fact { enum { Value = N * Fact<N - 1>::Value }; };
+template <> struct Fact<0> { enum { Value = 1 }; };
+
+int f() {
+  Box<int> A; Box<char> B;
+  Box<long> C;
+  return A.get() + B.get() + Fact<3>::Value;
+}
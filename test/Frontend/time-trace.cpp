@@ -0,0 +1,31 @@
+// REQUIRES: x86-registered-target
+//
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-obj -o %t/out.o \
+// RUN:     -ftime-trace=%t/trace.json -ftime-trace-granularity=0 \
+// RUN:     -I %S/Inputs %s
+// RUN: FileCheck %s < %t/trace.json
+//
+// CHECK: {"traceEvents":[
+// CHECK-DAG: "name":"Source","args":{"detail":"{{.*}}time-trace.h"}
+// CHECK-DAG: "name":"InstantiateClass","args":{"detail":"S<int>"}
+// CHECK-DAG: "name":"InstantiateFunction","args":{"detail":"S<int>::get"}
+// CHECK-DAG: "name":"EmitGlobal","args":{"detail":"use"}
+// CHECK-DAG: "name":"Frontend"
+// CHECK-DAG: "name":"Backend"
+// CHECK-DAG: "name":"CodeGenPasses"
+// CHECK-DAG: "name":"ExecuteCompiler"
+// CHECK-DAG: "name":"Total InstantiateFunction","args":{"count":1,
+// CHECK: "name":"process_name"
+// CHECK-NEXT: ]}
+//
+// RUN: %clang -### -c %s -ftime-trace=%t/trace.json \
+// RUN:     -ftime-trace-granularity=100 2>&1 \
+// RUN:   | FileCheck --check-prefix=CHECK-DRIVER %s
+// CHECK-DRIVER: "-cc1"
+// CHECK-DRIVER-SAME: "-ftime-trace={{.*}}trace.json"
+// CHECK-DRIVER-SAME: "-ftime-trace-granularity=100"
+
+#include "time-trace.h"
+
+int use() { return S<int>().get(); }
@@ -0,0 +1,11 @@
+namespace NS {
+int f();
+struct T {
+  int x;
+  int get() { return x; }
+};
+}
+
+namespace NS {
+int g();
+}
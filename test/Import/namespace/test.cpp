@@ -0,0 +1,6 @@
+// RUN: clang-import-test -import %S/Inputs/NS.cpp -expression %s
+void expr() {
+  NS::T t;
+  t.x = NS::f() + NS::g();
+  int y = t.get();
+}
@@ -0,0 +1,3 @@
+void callee(void);
+
+inline void inHeader(void) { callee(); }
@@ -0,0 +1,15 @@
+// RUN: c-index-test core -print-source-symbols -skip-function-bodies-outside-main-file -- %s -I %S/Inputs | FileCheck %s
+// RUN: c-index-test core -print-source-symbols -- %s -I %S/Inputs | FileCheck -check-prefix=ALL %s
+
+#include "skip-function-bodies.h"
+
+// CHECK: 3:13 | function/C | inHeader |
+// CHECK-NOT: | callee | {{.*}} | Ref,Call
+// ALL: 3:13 | function/C | inHeader |
+// ALL-NEXT: 3:30 | function/C | callee | {{.*}} | Ref,Call
+
+void inMainFile(void) {
+// CHECK: [[@LINE+2]]:3 | function/C | callee | {{.*}} | Ref,Call
+// ALL: [[@LINE+1]]:3 | function/C | callee | {{.*}} | Ref,Call
+  callee();
+}
@@ -0,0 +1,3 @@
+#include "index-store.h"
+
+int distance(struct Point a, struct Point b) { return a.x - b.x; }
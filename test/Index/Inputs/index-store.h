@@ -0,0 +1,5 @@
+struct Point {
+  int x, y;
+};
+
+int distance(struct Point a, struct Point b);
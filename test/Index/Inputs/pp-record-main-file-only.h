@@ -0,0 +1,3 @@
+#define HEADER_MACRO 1
+#define HEADER_USE HEADER_MACRO
+int header_var = HEADER_USE;
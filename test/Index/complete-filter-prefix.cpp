@@ -0,0 +1,27 @@
+struct Widget {
+  int size;
+  int capacity;
+  void resize(int);
+  void reserve(int);
+};
+
+void resetAll();
+
+void test(Widget &w) {
+  w.res;
+  res;
+}
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER_BY_PREFIX=1 c-index-test -code-completion-at=%s:11:8 %s | FileCheck -check-prefix=CHECK-MEMBER %s
+// CHECK-MEMBER-NOT: capacity
+// CHECK-MEMBER: CXXMethod:{ResultType void}{TypedText reserve}
+// CHECK-MEMBER: CXXMethod:{ResultType void}{TypedText resize}
+// CHECK-MEMBER-NOT: {TypedText size}
+
+// Cached global results are filtered as well.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_FILTER_BY_PREFIX=1 c-index-test -code-completion-at=%s:12:6 %s | FileCheck -check-prefix=CHECK-GLOBAL %s
+// CHECK-GLOBAL-NOT: {TypedText test}
+// CHECK-GLOBAL-NOT: {TypedText Widget}
+// CHECK-GLOBAL: FunctionDecl:{ResultType void}{TypedText resetAll}{LeftParen (}{RightParen )}
+// CHECK-GLOBAL-NOT: {TypedText test}
+// CHECK-GLOBAL-NOT: {TypedText Widget}
@@ -0,0 +1,25 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fsyntax-only -index-store-path %t/idx -I %S/Inputs %s -o %t/first.o
+// RUN: %clang_cc1 -fsyntax-only -index-store-path %t/idx -I %S/Inputs %S/Inputs/index-store-other.c -o %t/second.o
+// RUN: ls %t/idx/v1/units | count 2
+// RUN: ls %t/idx/v1/records | count 3
+// RUN: cat %t/idx/v1/records/index-store.c-* | FileCheck -check-prefix=RECORD %s
+// RUN: cat %t/idx/v1/units/first.o-* | FileCheck -check-prefix=UNIT %s
+
+// The header is indexed the same way by both translation units, so both
+// units share its record.
+
+#include "index-store.h"
+
+int origin(struct Point p) {
+  return distance(p, p);
+}
+
+// RECORD: 14:5	function	{{[0-9]+}}	c:@F@origin	origin
+// RECORD: 14:19	struct	{{[0-9]+}}	c:@S@Point	Point
+// RECORD: 15:10	function	{{[0-9]+}}	c:@F@distance	distance{{.*}}c:@F@origin
+
+// UNIT: main	{{.*}}index-store.c
+// UNIT: output	{{.*}}first.o
+// UNIT: file	{{.*}}index-store.c	index-store.c-{{[0-9a-f]+}}
+// UNIT: file	{{.*}}index-store.h	index-store.h-{{[0-9a-f]+}}
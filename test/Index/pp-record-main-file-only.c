@@ -0,0 +1,25 @@
+#include "pp-record-main-file-only.h"
+#define MAIN_MACRO HEADER_MACRO
+int main_var = MAIN_MACRO + HEADER_USE;
+
+// RUN: c-index-test -test-load-source all -I%S/Inputs %s | FileCheck -check-prefix=ALL %s
+// ALL: pp-record-main-file-only.h:1:9: macro definition=HEADER_MACRO
+// ALL: pp-record-main-file-only.h:3:18: macro expansion=HEADER_USE:2:9
+// ALL: pp-record-main-file-only.c:1:1: inclusion directive=pp-record-main-file-only.h
+// ALL: pp-record-main-file-only.c:2:9: macro definition=MAIN_MACRO
+// ALL: pp-record-main-file-only.c:3:16: macro expansion=MAIN_MACRO:2:9
+// ALL: pp-record-main-file-only.c:3:29: macro expansion=HEADER_USE:2:9
+
+// RUN: env CINDEXTEST_MAIN_FILE_PREPROCESSING_RECORD=1 c-index-test -test-load-source all -I%S/Inputs %s | FileCheck -check-prefix=MAIN %s
+// RUN: env CINDEXTEST_MAIN_FILE_PREPROCESSING_RECORD=1 CINDEXTEST_EDITING=1 c-index-test -test-load-source all -I%S/Inputs %s | FileCheck -check-prefix=MAIN %s
+// MAIN: pp-record-main-file-only.h:1:9: macro definition=HEADER_MACRO
+// MAIN-NOT: pp-record-main-file-only.h:3:18: macro expansion
+// MAIN: pp-record-main-file-only.c:1:1: inclusion directive=pp-record-main-file-only.h
+// MAIN: pp-record-main-file-only.c:2:9: macro definition=MAIN_MACRO
+// MAIN: pp-record-main-file-only.c:3:16: macro expansion=MAIN_MACRO:2:9
+// MAIN: pp-record-main-file-only.c:3:29: macro expansion=HEADER_USE:2:9
+
+// The same entities are visited by offset within a region of the main file.
+// RUN: env CINDEXTEST_MAIN_FILE_PREPROCESSING_RECORD=1 c-index-test -test-annotate-tokens=%s:3:1:3:40 -I%S/Inputs %s | FileCheck -check-prefix=TOKENS %s
+// TOKENS: Identifier: "MAIN_MACRO" [3:16 - 3:26] macro expansion=MAIN_MACRO:2:9
+// TOKENS: Identifier: "HEADER_USE" [3:29 - 3:39] macro expansion=HEADER_USE:2:9
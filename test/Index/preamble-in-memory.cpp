@@ -0,0 +1,16 @@
+#include "complete-preamble.h"
+void f() {
+  std::
+}
+
+void g() {
+  std::wibble();
+}
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_STORE_PREAMBLES_IN_MEMORY=1 LIBCLANG_TIMING=1 c-index-test -code-completion-at=%s:3:8 %s -o - 2>&1 | FileCheck -check-prefix=CHECK-CC1 %s
+// CHECK-CC1: Precompiling preamble
+// CHECK-CC1: {ResultType void}{TypedText wibble}{LeftParen (}{RightParen )} (50)
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_STORE_PREAMBLES_IN_MEMORY=1 c-index-test -test-load-source-reparse 3 local %s 2>&1 | FileCheck -check-prefix=CHECK-REPARSE %s
+// CHECK-REPARSE: preamble-in-memory.cpp:6:6: FunctionDecl=g:6:6 (Definition)
+// CHECK-REPARSE: preamble-in-memory.cpp:7:8: DeclRefExpr=wibble:2:8
@@ -0,0 +1,10 @@
+#ifndef SKIP_INDEXED_FILES_T_H
+#define SKIP_INDEXED_FILES_T_H
+
+struct HeaderStruct {
+  int header_field;
+};
+
+void header_function();
+
+#endif
@@ -0,0 +1,5 @@
+#include "t.h"
+
+void main_function3() {
+  header_function();
+}
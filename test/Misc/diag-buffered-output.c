@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -fsyntax-only -Wall %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -Wall -fdiagnostics-buffered-output %s 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -Wall -fdiagnostics-async-output %s 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -Wall -fdiagnostics-async-output \
+// RUN:   -fcolor-diagnostics %s 2>&1 | FileCheck --check-prefix=COLOR %s
+// REQUIRES: ansi-escape-sequences
+
+// Buffered diagnostics come out in order with their snippets, and color
+// codes are kept.
+
+void f(int x) {
+  if (x = 1) {}
+  if (x = 2) {}
+  if (x = 3) {}
+}
+
+// CHECK: diag-buffered-output.c:14:9: warning: using the result of an assignment
+// CHECK-NEXT: {{^}}  if (x = 1) {}
+// CHECK-NEXT: {{^}}      ~~^~~
+// CHECK: diag-buffered-output.c:15:9: warning: using the result of an assignment
+// CHECK: diag-buffered-output.c:16:9: warning: using the result of an assignment
+// CHECK: 3 warnings generated.
+
+// COLOR: diag-buffered-output.c:14:9: {{.}}[0m{{.}}[0;1;35mwarning: {{.}}[0m{{.}}[1musing the result of an assignment
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -fsyntax-only -fdiagnostics-template-depth 1 -DDEPTH=1 -verify %s
+// RUN: %clang_cc1 -fsyntax-only -fdiagnostics-template-depth 2 -DDEPTH=2 -verify %s
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+template <typename T> struct A {};
+template <typename T, typename U = int> struct B {};
+template <typename... Ts> struct C {};
+
+void f(A<B<C<int, char> > > a, A<C<> > e) {
+#if DEPTH == 1
+  a.x; // expected-error {{no member named 'x' in 'A<B<...> >'}}
+#elif DEPTH == 2
+  a.x; // expected-error {{no member named 'x' in 'A<B<C<...> > >'}}
+#else
+  a.x; // expected-error {{no member named 'x' in 'A<B<C<int, char> > >'}}
+#endif
+
+  // An empty list is never abbreviated.
+  e.x; // expected-error {{no member named 'x' in 'A<C<> >'}}
+}
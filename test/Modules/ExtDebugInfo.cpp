@@ -207,4 +207,5 @@ void foo() {
 // CHECK-SAME:           splitDebugFilename:
 // CHECK-SAME:           dwoId:
 // CHECK-PCH: !DICompileUnit({{.*}}splitDebugFilename:
-// CHECK-PCH:                dwoId: 18446744073709551614
+// CHECK-PCH-NOT:            dwoId: 18446744073709551614
+// CHECK-PCH-SAME:           dwoId: {{[0-9]+}}
@@ -0,0 +1,2 @@
+#include "C.h"
+int a(void);
@@ -0,0 +1,11 @@
+struct S {
+  void f();
+};
+
+struct T : S {
+  int n;
+  auto g() const { return n; }
+
+private:
+  void h(int, ...);
+};
@@ -0,0 +1,12 @@
+struct S {
+private:
+  void f();
+};
+
+struct T : S {
+  int n;
+  auto g() const { return n; }
+
+private:
+  void h(int, ...);
+};
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodules-build-threads=2 -I %S/Inputs/build-threads \
+// RUN:            -fsyntax-only %s -Rmodule-build 2>&1 | FileCheck %s
+
+// The sibling import B and the import C of A are built while A is.
+// CHECK: remark: building module 'B' as '{{.*}}' in the background
+// CHECK: remark: building module 'C' as '{{.*}}' in the background
+// CHECK: remark: building module 'A' as
+// CHECK-NOT: error
+
+// Once the modules are built, nothing is scheduled.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodules-build-threads=2 -I %S/Inputs/build-threads \
+// RUN:            -fsyntax-only %s -Rmodule-build -verify
+
+// Without threads, every module is built when it is imported.
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -I %S/Inputs/build-threads -fsyntax-only %s \
+// RUN:            -Rmodule-build 2>&1 | FileCheck --check-prefix=SERIAL %s
+// SERIAL-NOT: in the background
+
+// expected-no-diagnostics
+@import A;
+@import B;
+
+int f(void) { return a() + b() + c(); }
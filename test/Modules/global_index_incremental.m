@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// Create the global module index with a single module in it.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -F %S/Inputs %s -verify
+// RUN: ls %t | grep modules.idx
+// Add another module; the index is updated using what it already knows.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -F %S/Inputs %s -verify -DIMPORT_DEPENDS
+// Use the updated index for identifiers from both modules.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -F %S/Inputs %s -verify -DIMPORT_DEPENDS -print-stats 2>&1 | FileCheck %s
+
+// expected-no-diagnostics
+@import Module;
+#ifdef IMPORT_DEPENDS
+@import DependsOnModule;
+#endif
+
+// CHECK: *** Global Module Index Statistics:
+
+int *get_sub() {
+  return Module_Sub;
+}
@@ -0,0 +1,12 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -x c++ -std=c++14 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -I %S/Inputs/odr-hash %s -verify
+
+#include "first.h"
+#include "second.h"
+
+// Definitions which differ only in the access of a member are not caught by
+// comparing the class's properties; identical definitions must still merge.
+int use(T &t) { return t.g() + t.n + sizeof(S); }
+
+// expected-error@first.h:1 {{'S' has different definitions in different modules; definition in module 'first' is here}}
+// expected-note@second.h:1 {{definition in module 'second' is here}}
@@ -0,0 +1,51 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-name=a -emit-module %S/Inputs/explicit-build/module.modulemap -o %t/a.pcm
+//
+// A manifest which doesn't list the module file has no effect.
+// RUN: echo "1 %t/other.pcm" > %t/unlisted
+// RUN: %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-file=%t/a.pcm -fmodules-trusted-manifest=%t/unlisted \
+// RUN:            -fsyntax-only %s
+//
+// RUN: echo "1 %t/a.pcm" > %t/mismatch
+// RUN: not %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-file=%t/a.pcm -fmodules-trusted-manifest=%t/mismatch \
+// RUN:            -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-MISMATCH %s
+// CHECK-MISMATCH: module file '{{.*}}a.pcm' is out of date and needs to be rebuilt: signature does not match the trusted module manifest
+//
+// A module file listed with its own signature is trusted.
+// RUN: llvm-bcanalyzer -dump %t/a.pcm \
+// RUN:   | sed -n -e 's|.*<SIGNATURE op0=\([0-9]*\)/>.*|\1 %t/a.pcm|p' > %t/trusted
+// RUN: %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-file=%t/a.pcm -fmodules-trusted-manifest=%t/trusted \
+// RUN:            -fsyntax-only %s
+//
+// Explicitly built module files carry no signature; 0 can't stand for one.
+// RUN: echo "0 %t/a.pcm" > %t/zero
+// RUN: not %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-file=%t/a.pcm -fmodules-trusted-manifest=%t/zero \
+// RUN:            -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-ZERO %s
+// CHECK-ZERO: cannot read trusted module manifest '{{.*}}zero': malformed entry '0 {{.*}}a.pcm'
+//
+// The input files of an unsigned AST file are still validated when it is
+// listed in the manifest.
+// RUN: echo "int fromHeader;" > %t/header.h
+// RUN: %clang_cc1 -x c++-header -emit-pch -o %t/header.pch %t/header.h
+// RUN: touch -m -a -t 201101010000 %t/header.h
+// RUN: echo "1 %t/header.pch" > %t/pch
+// RUN: not %clang_cc1 -x c++ -include-pch %t/header.pch -fmodules-trusted-manifest=%t/pch \
+// RUN:            -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-MODIFIED %s
+// CHECK-MODIFIED: file '{{.*}}header.h' has been modified since the precompiled header '{{.*}}header.pch' was built
+//
+// RUN: echo "bogus" > %t/malformed
+// RUN: not %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-file=%t/a.pcm -fmodules-trusted-manifest=%t/malformed \
+// RUN:            -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-MALFORMED %s
+// CHECK-MALFORMED: cannot read trusted module manifest '{{.*}}malformed': malformed entry 'bogus'
+//
+// RUN: not %clang_cc1 -x c++ -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:            -fmodule-file=%t/a.pcm -fmodules-trusted-manifest=%t/missing \
+// RUN:            -fsyntax-only %s 2>&1 | FileCheck --check-prefix=CHECK-MISSING %s
+// CHECK-MISSING: cannot read trusted module manifest '{{.*}}missing'
@@ -0,0 +1,59 @@
+// Test target codegen - host bc file has to be created first.
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple powerpc64le-unknown-unknown -fopenmp-targets=nvptx64-nvidia-cuda -emit-llvm-bc %s -o %t-ppc-host.bc
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple nvptx64-unknown-unknown -fopenmp-targets=nvptx64-nvidia-cuda -emit-llvm %s -fopenmp-is-device -fopenmp-host-ir-file-path %t-ppc-host.bc -o - | FileCheck %s
+// expected-no-diagnostics
+
+// A 'target teams' whose only statement is a 'distribute parallel for' runs
+// in SPMD mode, like the combined 'target teams distribute parallel for'.
+void teams_dpf(int *arr) {
+#pragma omp target teams map(arr[0:10])
+  {
+#pragma omp distribute parallel for
+    for (int i = 0; i < 10; i++)
+      arr[i] += 1;
+  }
+}
+
+// CHECK: define {{.*}}void {{@__omp_offloading_.+teams_dpf.+}}(
+// CHECK-NOT: call {{.*}}void @__kmpc_kernel_init(
+// CHECK: call void @__kmpc_spmd_kernel_init(
+// CHECK: ret void
+
+void teams_dpf_simd(int *arr) {
+#pragma omp target teams map(arr[0:10])
+#pragma omp distribute parallel for simd
+  for (int i = 0; i < 10; i++)
+    arr[i] += 1;
+}
+
+// CHECK: define {{.*}}void {{@__omp_offloading_.+teams_dpf_simd.+}}(
+// CHECK-NOT: call {{.*}}void @__kmpc_kernel_init(
+// CHECK: call void @__kmpc_spmd_kernel_init(
+// CHECK: ret void
+
+// Code around the nested directive is a serial region.
+void teams_serial_dpf(int *arr) {
+#pragma omp target teams map(arr[0:10])
+  {
+    int a = 1;
+#pragma omp distribute parallel for
+    for (int i = 0; i < 10; i++)
+      arr[i] += a;
+  }
+}
+
+// CHECK: define {{.*}}void {{@__omp_offloading_.+teams_serial_dpf.+}}(
+// CHECK-NOT: call void @__kmpc_spmd_kernel_init(
+// CHECK: ret void
+
+// Privatization on the teams is done by the team master.
+void teams_private_dpf(int *arr, int a) {
+#pragma omp target teams map(arr[0:10]) firstprivate(a)
+#pragma omp distribute parallel for
+  for (int i = 0; i < 10; i++)
+    arr[i] += a;
+}
+
+// CHECK: define {{.*}}void {{@__omp_offloading_.+teams_private_dpf.+}}(
+// CHECK-NOT: call void @__kmpc_spmd_kernel_init(
+// CHECK: ret void
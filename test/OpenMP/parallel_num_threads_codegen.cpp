@@ -51,6 +51,12 @@ int main() {
 // CHECK:       call {{.*}}void {{.*}} @__kmpc_fork_call(
 // CHECK:       [[A_VAL:%.+]] = load i8, i8* [[A_ADDR]]
 // CHECK:       [[RES:%.+]] = sext i8 [[A_VAL]] to i32
+// CHECK:       [[ONE:%.+]] = icmp eq i32 [[RES]], 1
+// CHECK:       br i1 [[ONE]], label %[[SERIAL:[^,]+]], label %[[FORK:[^,]+]]
+// CHECK:       [[SERIAL]]:
+// CHECK:       call {{.*}}void @__kmpc_serialized_parallel([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]])
+// CHECK:       call {{.*}}void @__kmpc_end_serialized_parallel([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]])
+// CHECK:       [[FORK]]:
 // CHECK:       call {{.*}}void @__kmpc_push_num_threads([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]], i32 [[RES]])
 // CHECK:       call {{.*}}void {{.*}} @__kmpc_fork_call(
 // CHECK:       invoke{{.*}} [[INT_TY:i[0-9]+]] [[TMAIN_CHAR_5:@.+]]()
@@ -70,13 +76,19 @@ int main() {
 
 // CHECK:       define{{.*}} [[INT_TY]] [[TMAIN_S_1]]()
 // CHECK:       [[GTID:%.+]] = call {{.*}}i32 @__kmpc_global_thread_num([[IDENT_T_TY]]* [[DEF_LOC_2]])
-// CHECK:       call {{.*}}void @__kmpc_push_num_threads([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]], i32 1)
-// CHECK:       call {{.*}}void {{.*}} @__kmpc_fork_call(
+// CHECK-NOT:   call {{.*}}void @__kmpc_push_num_threads([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]], i32 1)
+// CHECK:       call {{.*}}void @__kmpc_serialized_parallel([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]])
+// CHECK:       call {{.*}}void @__kmpc_end_serialized_parallel([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]])
 // CHECK:       {{(invoke|call)}} {{.*}} [[S_TY_CONSTR]]([[S_TY]]* [[S_TEMP:%.+]], [[INTPTR_T_TY]] [[INTPTR_T_TY_ATTR]]23)
 // CHECK:       [[S_CHAR_OP:%.+]] = invoke{{.*}} i8 [[S_TY_CHAR_OP]]([[S_TY]]* [[S_TEMP]])
 // CHECK:       [[RES:%.+]] = sext {{.*}}i8 [[S_CHAR_OP]] to i32
-// CHECK:       call {{.*}}void @__kmpc_push_num_threads([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]], i32 [[RES]])
+// CHECK:       [[ONE:%.+]] = icmp eq i32 [[RES]], 1
 // CHECK:       {{(invoke|call)}} {{.*}} [[S_TY_DESTR]]([[S_TY]]* [[S_TEMP]])
+// CHECK:       br i1 [[ONE]], label %[[SERIAL:[^,]+]], label %[[FORK:[^,]+]]
+// CHECK:       [[SERIAL]]:
+// CHECK:       call {{.*}}void @__kmpc_serialized_parallel([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]])
+// CHECK:       [[FORK]]:
+// CHECK:       call {{.*}}void @__kmpc_push_num_threads([[IDENT_T_TY]]* [[DEF_LOC_2]], i32 [[GTID]], i32 [[RES]])
 // CHECK:       call {{.*}}void {{.*}} @__kmpc_fork_call(
 // CHECK:       ret [[INT_TY]] 0
 // CHECK:       }
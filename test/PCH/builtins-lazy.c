@@ -0,0 +1,40 @@
+// Builtins which the precompiled header never referred to are still
+// recognized after loading it.
+
+// Test this without pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -include %s -emit-llvm -o - %s | FileCheck %s
+
+// Test with pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -include-pch %t -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -include-pch %t -fsyntax-only -verify -DTYPO %s
+
+#ifndef HEADER
+#define HEADER
+
+int header_abs(int x) { return __builtin_abs(x); }
+
+#else
+
+// CHECK-LABEL: define i32 @header_abs(
+// CHECK-LABEL: define i32 @count(
+// CHECK: call i32 @llvm.ctpop.i32(
+int count(unsigned x) { return __builtin_popcount(x); }
+
+#if !__has_builtin(__builtin_ia32_pause)
+#error target builtins should be known
+#endif
+
+// CHECK-LABEL: define void @spin(
+// CHECK: call void @llvm.x86.sse2.pause()
+void spin(void) { __builtin_ia32_pause(); }
+
+// Builtins without an identifier yet are candidates for typo correction.
+#ifdef TYPO
+void typo(void) {
+  __builtin_frame_addres(0); // expected-error {{use of unknown builtin '__builtin_frame_addres'}} \
+                             // expected-note {{did you mean '__builtin_frame_address'?}}
+}
+#endif
+
+#endif
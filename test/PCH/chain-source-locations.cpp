@@ -0,0 +1,36 @@
+// Locations read from a chain of PCH files have to be remapped through
+// several ranges, one for each file. Make sure that alternating between
+// them maps every location to the right place.
+
+// Without PCH
+// RUN: %clang_cc1 -fsyntax-only -verify -include %s -include %s %s
+
+// With PCH
+// RUN: %clang_cc1 -fsyntax-only -verify %s -chain-include %s -chain-include %s
+
+#ifndef HEADER1
+#define HEADER1
+
+struct A {
+  void f(int x);
+};
+
+#elif !defined(HEADER2)
+#define HEADER2
+
+struct B {
+  void g(int y);
+};
+
+#else
+
+void test(A *a, B *b) {
+  a->f(); // expected-error {{too few arguments to function call}}
+          // expected-note@15 {{'f' declared here}}
+  b->g(); // expected-error {{too few arguments to function call}}
+          // expected-note@22 {{'g' declared here}}
+  a->f(); // expected-error {{too few arguments to function call}}
+          // expected-note@15 {{'f' declared here}}
+}
+
+#endif
@@ -0,0 +1,66 @@
+// Test that record layouts written to a PCH with -fserialize-record-layouts
+// are the ones used by the translation units that include it, instead of
+// being computed again.
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -o %t.pch %s
+// RUN: llvm-bcanalyzer -dump %t.pch | FileCheck -check-prefix=CHECK-OFF %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.pch -fsyntax-only -verify %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.pch -fsyntax-only -print-stats %s 2>&1 | FileCheck -check-prefix=STATS-OFF %s
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -fserialize-record-layouts -o %t.layouts.pch %s
+// RUN: llvm-bcanalyzer -dump %t.layouts.pch | FileCheck -check-prefix=CHECK-ON %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.layouts.pch -fsyntax-only -verify %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.layouts.pch -fsyntax-only -print-stats %s 2>&1 | FileCheck -check-prefix=STATS-ON %s
+
+#ifndef HEADER
+#define HEADER
+
+struct Plain {
+  char C;
+  int I;
+};
+
+struct __attribute__((packed)) Packed {
+  char C;
+  int I;
+};
+
+struct Base {
+  virtual void f();
+  short S;
+};
+
+struct Derived : virtual Plain, Base {
+  char D;
+  int Bits : 3;
+};
+
+template <typename T> struct Wrapper {
+  T Value;
+  char Tag;
+};
+extern Wrapper<double> W;
+
+#else
+
+// expected-no-diagnostics
+
+static_assert(sizeof(Plain) == 8 && alignof(Plain) == 4, "");
+static_assert(__builtin_offsetof(Plain, I) == 4, "");
+
+static_assert(sizeof(Packed) == 5 && alignof(Packed) == 1, "");
+static_assert(__builtin_offsetof(Packed, I) == 1, "");
+
+static_assert(sizeof(Derived) == 24 && alignof(Derived) == 8, "");
+
+static_assert(sizeof(W) == 16, "");
+
+#endif
+
+// CHECK-OFF-NOT: <RECORD_LAYOUTS
+// CHECK-ON: <RECORD_LAYOUTS
+
+// Plain, Packed and Derived are laid out from the PCH. Derived doesn't need
+// the layouts of its bases, so they aren't read.
+// STATS-OFF-NOT: record layouts read
+// STATS-ON: 3/{{[0-9]+}} record layouts read
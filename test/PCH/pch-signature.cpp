@@ -0,0 +1,38 @@
+// Test that a PCH in an object file container has a signature, and that
+// rebuilding it from the same sources gives it the same one. Raw PCHs have
+// no use for one and are written without it.
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -o %t.raw.pch %s
+// RUN: llvm-bcanalyzer -dump %t.raw.pch | FileCheck --check-prefix=RAW %s
+
+// RAW: <CONTROL_BLOCK
+// RAW-NOT: <SIGNATURE
+// RAW: </CONTROL_BLOCK>
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -fmodule-format=obj -emit-pch -o %t.1.pch %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -fmodule-format=obj -emit-pch -o %t.2.pch %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -debug-info-kind=standalone \
+// RUN:     -dwarf-ext-refs -fmodule-format=obj -include-pch %t.1.pch %s \
+// RUN:     -emit-llvm -o %t.1.ll
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -debug-info-kind=standalone \
+// RUN:     -dwarf-ext-refs -fmodule-format=obj -include-pch %t.2.pch %s \
+// RUN:     -emit-llvm -o %t.2.ll
+// RUN: cat %t.1.ll %t.2.ll | FileCheck --check-prefix=OBJ %s
+
+// OBJ-NOT: dwoId: 18446744073709551614
+// OBJ: !DICompileUnit({{.*}}dwoId: [[SIG:[0-9]+]]
+// OBJ-NOT: dwoId: 18446744073709551614
+// OBJ: !DICompileUnit({{.*}}dwoId: [[SIG]]
+
+#ifndef HEADER
+#define HEADER
+
+struct S {
+  int I;
+};
+
+#else
+
+S s;
+
+#endif
@@ -0,0 +1,53 @@
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux-gnu -x c++-header -emit-pch %s -o %t
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux-gnu -include-pch %t -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++14 -triple x86_64-unknown-linux-gnu -include-pch %t -emit-llvm -o - %s | FileCheck %s
+
+// Declarations that are loaded together from the PCH, such as the results
+// of a name lookup and the specializations of a template, may be read in
+// the order they were written. The results must be the same.
+
+#ifndef HEADER_INCLUDED
+#define HEADER_INCLUDED
+
+int f(int);
+double f(double);
+template <typename T> T f(T *);
+char f(char);
+
+template <typename T> struct S { static const int value = 0; };
+template <> struct S<int> { static const int value = 1; };
+template <> struct S<char> { static const int value = 2; };
+template <typename T> struct S<T *> { static const int value = 3; };
+template <> struct S<double> { static const int value = 4; };
+
+template <typename T> constexpr int v = 0;
+template <> constexpr int v<int> = 5;
+template <> constexpr int v<char> = 6;
+
+template <typename T> T g(T t) { return t; }
+inline int useG() { return g(1) + g('a'); }
+
+#else
+
+// expected-no-diagnostics
+
+static_assert(sizeof(f(1)) == sizeof(int), "");
+static_assert(sizeof(f(1.0)) == sizeof(double), "");
+static_assert(sizeof(f('a')) == sizeof(char), "");
+static_assert(sizeof(f((long *)0)) == sizeof(long), "");
+
+static_assert(S<int>::value == 1, "");
+static_assert(S<char>::value == 2, "");
+static_assert(S<long *>::value == 3, "");
+static_assert(S<double>::value == 4, "");
+static_assert(S<long>::value == 0, "");
+
+static_assert(v<int> == 5, "");
+static_assert(v<char> == 6, "");
+static_assert(v<long> == 0, "");
+
+// CHECK-DAG: define linkonce_odr i32 @_Z1gIiET_S0_(
+// CHECK-DAG: define linkonce_odr signext i8 @_Z1gIcET_S0_(
+int h() { return useG() + g(2); }
+
+#endif
@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -E -dM -include-pch %t %s | FileCheck --check-prefix=CHECK-EAGER %s
+// RUN: %clang_cc1 -E -dM -include-pch %t -fpch-strict-lazy-loading %s | FileCheck --check-prefix=CHECK-LAZY %s
+// RUN: %clang_cc1 -fsyntax-only -include-pch %t -fpch-strict-lazy-loading -print-stats %s 2>&1 | FileCheck --check-prefix=CHECK-STATS %s
+
+#ifndef HEADER
+#define HEADER
+
+#define USED_MACRO 1
+#define UNUSED_MACRO 2
+
+#else
+
+int x = USED_MACRO;
+
+// CHECK-EAGER-DAG: #define USED_MACRO 1
+// CHECK-EAGER-DAG: #define UNUSED_MACRO 2
+
+// CHECK-LAZY: #define USED_MACRO 1
+// CHECK-LAZY-NOT: UNUSED_MACRO
+
+// CHECK-STATS: AST file pages read
+
+#endif
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 %s
+
+// Disambiguations are remembered by the position they start at, and reused
+// when the same question is asked about the same tokens again; check that
+// their outcome doesn't change.
+
+struct T {
+  T(int);
+};
+
+template <typename U> struct S { typedef U type; };
+
+void f(int a) {
+  // The statement is disambiguated as a declaration, whose declarator is then
+  // parsed again, and is still ambiguous.
+  T(x)(int(a)); // expected-warning {{disambiguated as a function declaration}} expected-note {{add a pair of parentheses}}
+  T (*p)(int) = x;
+
+  // Here the parenthesized part is an initializer.
+  T(y)(a);
+  T z = y;
+
+  S<T(int)>::type *q = x;
+  S<T(int)>::type *r = p;
+}
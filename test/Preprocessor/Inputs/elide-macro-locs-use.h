@@ -0,0 +1 @@
+_Static_assert(USER_ADD(USER_THREE, 1) == 4, "wrong sum");
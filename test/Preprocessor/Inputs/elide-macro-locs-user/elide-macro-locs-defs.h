@@ -0,0 +1,2 @@
+#define USER_ADD(X, Y) ((X) + (Y))
+#define USER_THREE 3
@@ -0,0 +1,8 @@
+#define LINE() __LINE__
+#define CHECK_LINE(N) _Static_assert(LINE() == N, "wrong line")
+#define TWO 2
+#define ADD(X, Y) ((X) + (Y))
+CHECK_LINE(5);
+_Static_assert(ADD(TWO, 1) == 3, "wrong sum");
+#define STR(X) #X
+_Static_assert(sizeof(STR(abc)) == 4, "wrong string");
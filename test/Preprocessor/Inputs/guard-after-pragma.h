@@ -0,0 +1,5 @@
+#pragma GCC system_header
+#ifndef GUARD_AFTER_PRAGMA_H
+#define GUARD_AFTER_PRAGMA_H
+int guarded_after_pragma;
+#endif
@@ -0,0 +1,12 @@
+template <typename T>
+struct ND {
+    void m() { T b; while (b==b); }
+};
+
+#pragma clang diagnostic push
+#pragma clang diagnostic warning "-Wtautological-compare"
+template <typename T>
+struct NE {
+    void m() { T b; while (b==b); } // expected-warning {{always evaluates to true}}
+};
+#pragma clang diagnostic pop
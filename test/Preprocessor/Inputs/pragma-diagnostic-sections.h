@@ -0,0 +1,21 @@
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+template <typename T>
+struct HA {
+    void m() { T b; while (b==b); }
+};
+#pragma clang diagnostic pop
+
+template <typename T>
+struct HB {
+    void m() { T b; while (b==b); } // expected-warning {{always evaluates to true}}
+};
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#include "pragma-diagnostic-sections-nested.h"
+template <typename T>
+struct HC {
+    void m() { T b; while (b==b); }
+};
+#pragma clang diagnostic pop
@@ -0,0 +1,6 @@
+#if SKIPPED_BLOCK_KEEP
+int skipped_a;
+#define SKIPPED_BLOCK_MACRO 1
+int skipped_b;
+#endif
+int kept;
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -print-stats \
+// RUN:   -I %S/Inputs/elide-macro-locs-user -isystem %S/Inputs \
+// RUN:   -felide-system-macro-expansion-locs %s 2>&1 | FileCheck %s
+// expected-no-diagnostics
+
+// Macros defined outside system headers keep their expansion locations even
+// when they are expanded in a system header.
+#include "elide-macro-locs-defs.h"
+#include <elide-macro-locs-use.h>
+
+// CHECK: 0 macro expansions in system headers without expansion locations.
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -isystem %S/Inputs %s
+// RUN: %clang_cc1 -fsyntax-only -verify -isystem %S/Inputs \
+// RUN:   -felide-system-macro-expansion-locs %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats -isystem %S/Inputs %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=EXPANDED %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats -isystem %S/Inputs \
+// RUN:   -felide-system-macro-expansion-locs %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=ELIDED %s
+// expected-no-diagnostics
+
+// Macros expanded in a system header need no expansion locations, but
+// __LINE__, nested expansions and stringification still behave.
+#include <elide-macro-locs.h>
+
+#define ADD_USER(X, Y) ((X) + (Y))
+_Static_assert(ADD_USER(1, 2) == 3, "wrong sum");
+
+// EXPANDED: 0 macro expansions in system headers without expansion locations.
+// EXPANDED: Local Sloc address space: {{[0-9]+}}B in files, {{[0-9]+}}B in {{[0-9]+}} macro expansions, {{[0-9]+}}B in {{[0-9]+}} macro argument expansions.
+// EXPANDED: Top macro expansions by Sloc address space:
+// EXPANDED: B in 1 expansions of {{.*}}elide-macro-locs.h:
+
+// ELIDED: {{[1-9][0-9]*}} macro expansions in system headers without expansion locations.
+// ELIDED: Top macro expansions by Sloc address space:
+// ELIDED: B in 1 expansions of {{.*}}elide-system-macro-expansion-locs.c:15:
@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -index-header-search-dirs \
+// RUN:   -I %S/Inputs/microsoft-header-search -I %S %s
+// RUN: %clang_cc1 -fsyntax-only -index-header-search-dirs -print-stats \
+// RUN:   -I %S/Inputs/microsoft-header-search -I %S %s 2>&1 | FileCheck %s
+
+// The first search directory does not contain file_to_include.h, so it is
+// skipped without a lookup; the second one does.
+#include <file_to_include.h> // expected-warning {{file successfully included}}
+
+// CHECK: 2 directories indexed, 1 lookups skipped.
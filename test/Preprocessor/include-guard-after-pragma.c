@@ -0,0 +1,15 @@
+// RUN: %clang_cc1 -E -I %S/Inputs %s | FileCheck %s
+// RUN: %clang_cc1 -Eonly -print-stats -I %S/Inputs %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=STATS %s
+
+// A '#pragma system_header' ahead of the include guard only affects the
+// header itself, so later inclusions are still skipped.
+#include "guard-after-pragma.h"
+#include "guard-after-pragma.h"
+#include "guard-after-pragma.h"
+
+// CHECK: int guarded_after_pragma;
+// CHECK-NOT: int guarded_after_pragma;
+
+// STATS: 3 #include/#include_next/#import.
+// STATS-NEXT: 2 #includes skipped due to the multi-include optimization.
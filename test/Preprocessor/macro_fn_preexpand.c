@@ -1,5 +1,8 @@
 // RUN: %clang_cc1 %s -E | grep 'pre: 1 1 X'
 // RUN: %clang_cc1 %s -E | grep 'nopre: 1A(X)'
+// RUN: %clang_cc1 %s -E | grep 'noparen: 1 B 2 B 3'
+// RUN: %clang_cc1 %s -E | grep 'paren: 1 x 2 B 3'
+// RUN: %clang_cc1 %s -E | grep 'rescan: x'
 
 /* Preexpansion of argument. */
 #define A(X) 1 X
@@ -10,3 +13,12 @@ pre: A(A(X))
 #define A(X) 1 ## X
 nopre: A(A(X))
 
+/* A function-like macro name without a '(' is left alone by preexpansion, but
+   is still expanded when the result is rescanned. */
+#define B(X) x
+#define C(X, Y) 1 X 2 Y 3
+noparen: C(B, B)
+paren: C(B(0), B)
+
+#define D(M) M(0)
+rescan: D(B)
@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -fsyntax-only -Wall -Wno-uninitialized -I %S/Inputs -verify %s
+
+// Diagnostics in templates are checked against the pragmas active where the
+// template was written, in whichever file that is.
+
+#include "pragma-diagnostic-sections.h"
+
+template <typename T>
+struct MA {
+    void m() { T b; while (b==b); } // expected-warning {{always evaluates to true}}
+};
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-compare"
+template <typename T>
+struct MB {
+    void m() { T b; while (b==b); }
+};
+#pragma clang diagnostic pop
+
+void f() {
+    HA<int>().m();
+    HB<int>().m(); // expected-note {{in instantiation of member function}}
+    HC<int>().m();
+    ND<int>().m();
+    NE<int>().m(); // expected-note {{in instantiation of member function}}
+    MA<int>().m(); // expected-note {{in instantiation of member function}}
+    MB<int>().m();
+}
+
+#pragma clang diagnostic ignored "-Wtautological-compare"
@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -E %s | FileCheck -strict-whitespace %s
+// RUN: %clang_cc1 -E -x c++ %s | FileCheck -strict-whitespace -check-prefix=CHECK -check-prefix=CXX %s
+
+// Punctuators are printed as they were spelled.
+#define ARRAY(n) int a<:n:>
+ARRAY(2);
+// CHECK: int a<:2:>;
+x = y <%%> z;
+// CHECK: x = y <%%> z;
+a >>= b -\
+> c;
+// CHECK: a >>= b -> c;
+p->q(...);
+// CHECK: p->q(...);
+
+#ifdef __cplusplus
+// Operator keywords keep their spelling, even when it is as long as that of
+// the punctuator.
+a or b and c;
+// CXX: a or b and c;
+d or_eq e;
+// CXX: d or_eq e;
+#endif
@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -E -I %S/Inputs %s | FileCheck %s
+// RUN: %clang_cc1 -Eonly -print-stats -I %S/Inputs %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=STATS %s
+
+// The second time the excluded block is skipped, both runs of tokens in it
+// are stepped over using the directive offsets found the first time.
+#include "skipped-block.h"
+#include "skipped-block.h"
+
+// CHECK-NOT: skipped_
+// CHECK: int kept;
+// CHECK-NOT: skipped_
+// CHECK: int kept;
+// CHECK-NOT: skipped_
+
+// STATS: 2 #if/#ifndef#ifdef regions skipped
+// STATS-NEXT: 2 skipped using known directive offsets.
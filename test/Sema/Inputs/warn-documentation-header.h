@@ -0,0 +1,4 @@
+/// \param x The value.
+int headerFunction(int x);
+
+/// \param y Not attached to anything in this header.
@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fsyntax-only -Wconversion -verify %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fsyntax-only -Wconversion -verify %s -print-stats 2>&1 | FileCheck %s
+
+// Conversion warnings are not built when they are ignored, and the state set
+// by pragmas is still honored for each of them.
+
+// CHECK: {{[0-9]+}} diagnostics built and then ignored.
+
+void f(long l, double d) {
+  int a = l; // expected-warning {{implicit conversion loses integer precision}}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wconversion"
+  int b = l;
+  int c = d;
+#pragma clang diagnostic pop
+  int e = d; // expected-warning {{implicit conversion turns floating-point number into integer}}
+  int g = l; // expected-warning {{implicit conversion loses integer precision}}
+}
+
+#pragma clang diagnostic ignored "-Wconversion"
+void h(long l) {
+  int a = l;
+}
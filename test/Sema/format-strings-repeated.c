@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -Wformat-non-iso -verify %s
+// RUN: %clang_cc1 -fsyntax-only -fdiagnostics-parseable-fixits %s 2>&1 | FileCheck %s
+
+// Format strings are only parsed once, but every use of a string is checked
+// against its own arguments, and diagnosed at its own location.
+
+int printf(const char *restrict, ...);
+
+#define LOG(...) printf(__VA_ARGS__)
+
+void test(int i, long l, const char *s) {
+  LOG("%d %s\n", i, s);
+  printf("%d %s\n", l, s); // expected-warning{{format specifies type 'int' but the argument has type 'long'}}
+  LOG("%d %s\n", i, i); // expected-warning{{format specifies type 'char *' but the argument has type 'int'}}
+  LOG("%d %s\n", i);    // expected-warning{{more '%' conversions than data arguments}}
+  printf("%d %s\n", i, s, s); // expected-warning{{data argument not used by format string}}
+
+  // Strings with problems of their own are diagnosed at every use.
+  LOG("%y", i); // expected-warning{{invalid conversion specifier 'y'}}
+  LOG("%y", i); // expected-warning{{invalid conversion specifier 'y'}}
+  LOG("%1$d\n", i); // expected-warning{{positional arguments are not supported by ISO C}}
+  LOG("%1$d\n", i); // expected-warning{{positional arguments are not supported by ISO C}}
+}
+
+// CHECK: fix-it:"{{.*}}":{13:11-13:13}:"%ld"
@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+//
+// Candidates are rejected by comparing their character counts with the
+// typo's before computing an edit distance. Each kind of single edit still
+// has to find its correction.
+
+int counter_total;  // expected-note {{'counter_total' declared here}}
+int widget_size;    // expected-note {{'widget_size' declared here}}
+int alphabet_soup;  // expected-note {{'alphabet_soup' declared here}}
+int maximum_depth;  // expected-note {{'maximum_depth' declared here}}
+int xylophone;
+
+int transposition() {
+  return countre_total; // expected-error {{use of undeclared identifier 'countre_total'; did you mean 'counter_total'?}}
+}
+
+int insertion() {
+  return widget_sizes; // expected-error {{use of undeclared identifier 'widget_sizes'; did you mean 'widget_size'?}}
+}
+
+int deletion() {
+  return alphbet_soup; // expected-error {{use of undeclared identifier 'alphbet_soup'; did you mean 'alphabet_soup'?}}
+}
+
+int substitution() {
+  return maximum_dapth; // expected-error {{use of undeclared identifier 'maximum_dapth'; did you mean 'maximum_depth'?}}
+}
+
+int unrelated() {
+  return zzzzzzzzz; // expected-error-re {{use of undeclared identifier 'zzzzzzzzz'{{$}}}}
+}
+
+// CHECK: typo corrections attempted, {{[0-9]+}} candidate names considered
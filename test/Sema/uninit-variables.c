@@ -531,3 +531,16 @@ void test_analyzer_noreturn_2(int y) {
   }
   ++x; // no-warning
 }
+
+// Variables which are never read aren't tracked; make sure that doesn't get
+// in the way of the ones which are.
+int test_unread_variables(int y) {
+  int a, b, c; // expected-note {{initialize the variable 'c' to silence this warning}}
+  int d;
+  a = y;
+  if (y)
+    b = 1;
+  d = 2;
+  ^{ (void)a; }();
+  return c; // expected-warning {{variable 'c' is uninitialized when used here}}
+}
@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -fsyntax-only -Wdocumentation -I %S/Inputs -verify %s
+
+// Comments are only attached to declarations in the same file.
+
+/// \param a The value.
+#include "warn-documentation-header.h"
+int afterInclude(int b);
+
+/// \param c The value.
+int mismatched(int d); // expected-warning@-1 {{parameter 'c' not found in the function declaration}} expected-note@-1 {{did you mean 'd'?}}
+
+/// \param e The value.
+/// \param f Merged with the line above.
+int merged(int e, int g); // expected-warning@-1 {{parameter 'f' not found in the function declaration}} expected-note@-1 {{did you mean 'g'?}}
+
+struct S {
+  int trailing; ///< \param i Trailing.
+  // expected-warning@-1 {{'\param' command used in a comment that is not attached to a function declaration}}
+};
@@ -396,3 +396,21 @@ void test_with_paren_silencing(int x) {
   else
     calledFun();
 }
+
+// Diagnostic control: all of -Wunreachable-code for a function. The analysis
+// doesn't run for it, but still does for the functions after it.
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunreachable-code-aggressive"
+
+void test_all_unreachable_SUPPRESSED() {
+  raze();
+  calledFun(); // no-warning
+}
+
+#pragma clang diagnostic pop
+
+void test_all_unreachable_after_SUPPRESSED() {
+  raze();
+  calledFun(); // expected-warning {{will never be executed}}
+}
@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only %s -print-stats 2>&1 | FileCheck %s
+
+// The kind of an attribute depends on both its name and its syntax, so
+// reusing the kind of an earlier spelling must not mix them up.
+#define EXPORT __attribute__((visibility("default"), unused))
+
+EXPORT int a;
+EXPORT int b;
+__attribute__((__unused__)) int c;
+[[gnu::unused]] int d;
+[[unused]] int e; // expected-warning {{unknown attribute 'unused' ignored}}
+[[gnu::visibility("hidden")]] int f;
+[[visibility("hidden")]] int g; // expected-warning {{unknown attribute 'visibility' ignored}}
+__attribute__((visibility("hidden"))) int h;
+
+// CHECK: 10 declaration attributes processed.
@@ -0,0 +1,33 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -std=c++14 -fsyntax-only %s -print-stats 2>&1 | FileCheck %s
+
+// Without reusing the results of earlier calls, this would take far more
+// steps than the default limit allows.
+constexpr unsigned long long fib(unsigned n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+static_assert(fib(80) == 23416728348467685ULL, "");
+
+// Calls whose arguments refer to objects are evaluated each time.
+constexpr int deref(const int *p) { return *p; }
+constexpr int one = 1, two = 2;
+static_assert(deref(&one) == 1, "");
+static_assert(deref(&two) == 2, "");
+
+struct S { int a, b; };
+constexpr S swap(S s) { return {s.b, s.a}; }
+static_assert(swap({1, 2}).a == 2, "");
+static_assert(swap(swap({1, 2})).a == 1, "");
+static_assert(swap({3, 4}).a == 4, "");
+
+// A call whose evaluation is not a core constant expression is diagnosed
+// every time, not only the first.
+constexpr int shift(int n) { return 1 << n; }
+constexpr int big1 = shift(40); // expected-error {{constexpr variable 'big1' must be initialized by a constant expression}} \
+                                // expected-note {{shift count 40 >= width of type 'int'}} \
+                                // expected-note {{in call to 'shift(40)'}}
+constexpr int big2 = shift(40); // expected-error {{constexpr variable 'big2' must be initialized by a constant expression}} \
+                                // expected-note {{shift count 40 >= width of type 'int'}} \
+                                // expected-note {{in call to 'shift(40)'}}
+
+// CHECK: {{[1-9][0-9]*}}/{{[0-9]+}} memoized constexpr function calls reused
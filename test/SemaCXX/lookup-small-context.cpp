@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -std=c++11 -fsyntax-only %s -print-stats 2>&1 | FileCheck %s
+
+// Lookups into contexts with only a few declarations are answered by scanning
+// them rather than building a lookup table. They must find the same
+// declarations a lookup table would.
+
+// CHECK: {{[1-9][0-9]*}} lookups answered without building a lookup table
+
+struct Small {
+  int a;
+  enum { Red, Green };
+  void f();
+};
+
+void Small::f() { a = Red; }
+int green = Small::Green;
+int missing = Small::Blue; // expected-error {{no member named 'Blue' in 'Small'}}
+
+// Overloaded names are looked up in a lookup table.
+struct Overloaded {
+  int g(int);
+  double g(double);
+};
+
+double callOverloaded(Overloaded o) { return o.g(1) + o.g(1.0); }
+
+// Members of transparent contexts and inline namespaces are found too.
+namespace N {
+inline namespace V {
+int v;
+}
+extern "C" {
+int cFunction();
+}
+}
+
+int inlineMember = N::v;
+int linkageSpecMember = N::cFunction();
+
+// A large context is not scanned, but still finds its members.
+struct Large {
+  int m1, m2, m3, m4, m5, m6, m7, m8, m9, m10;
+};
+
+int largeMember(Large l) { return l.m10; }
+int largeMissing(Large l) { return l.m11; } // expected-error {{no member named 'm11' in 'Large'}}
@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Method lookups are cached per class; check that the cache notices new
+// categories, extensions, methods and protocols.
+
+@interface Base
+@end
+
+@interface Derived : Base
+@end
+
+@protocol P
+- (int)fromProtocol;
+@end
+
+void before(Derived *d, Base *b) {
+  [d fromCategory]; // expected-warning {{instance method '-fromCategory' not found (return type defaults to 'id')}}
+  [b fromCategory]; // expected-warning {{instance method '-fromCategory' not found (return type defaults to 'id')}}
+  [d fromExtension]; // expected-warning {{instance method '-fromExtension' not found (return type defaults to 'id')}}
+  [d fromProtocol]; // expected-warning {{instance method '-fromProtocol' not found (return type defaults to 'id')}}
+  [Derived classMethod]; // expected-warning {{class method '+classMethod' not found (return type defaults to 'id')}}
+}
+
+@interface Base (Category)
+- (int)fromCategory;
+@end
+
+@interface Derived ()
+- (int)fromExtension;
+@end
+
+@interface Derived (Protocols) <P>
++ (int)classMethod;
+@end
+
+int after(Derived *d, Base *b) {
+  return [d fromCategory] + [b fromCategory] + [d fromExtension] +
+         [d fromProtocol] + [Derived classMethod];
+}
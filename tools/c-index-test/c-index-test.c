@@ -82,6 +82,10 @@ static unsigned getDefaultParsingOptions() {
     options |= CXTranslationUnit_CreatePreambleOnFirstParse;
   if (getenv("CINDEXTEST_KEEP_GOING"))
     options |= CXTranslationUnit_KeepGoing;
+  if (getenv("CINDEXTEST_STORE_PREAMBLES_IN_MEMORY"))
+    options |= CXTranslationUnit_StorePreamblesInMemory;
+  if (getenv("CINDEXTEST_MAIN_FILE_PREPROCESSING_RECORD"))
+    options |= CXTranslationUnit_DetailedPreprocessingRecordMainFileOnly;
 
   return options;
 }
@@ -2177,6 +2181,8 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
   if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
     completionOptions |= CXCodeComplete_IncludeBriefComments;
+  if (getenv("CINDEXTEST_COMPLETION_FILTER_BY_PREFIX"))
+    completionOptions |= CXCodeComplete_FilterByTypedPrefix;
   
   if (timing_only)
     input += strlen("-code-completion-timing=");
@@ -3316,6 +3322,8 @@ static unsigned getIndexOptions(void) {
     index_opts |= CXIndexOpt_IndexFunctionLocalSymbols;
   if (!getenv("CINDEXTEST_DISABLE_SKIPPARSEDBODIES"))
     index_opts |= CXIndexOpt_SkipParsedBodiesInSession;
+  if (getenv("CINDEXTEST_SKIPINDEXEDFILES"))
+    index_opts |= CXIndexOpt_SkipIndexedFilesInSession;
 
   return index_opts;
 }
@@ -44,6 +44,11 @@ Action(cl::desc("Action:"), cl::init(ActionType::None),
                      "print-source-symbols", "Print symbols from source")),
        cl::cat(IndexTestCoreCategory));
 
+static cl::opt<bool>
+SkipFunctionBodiesOutsideMainFile("skip-function-bodies-outside-main-file",
+    cl::desc("Skip parsing function bodies outside the main file"),
+    cl::cat(IndexTestCoreCategory));
+
 static cl::extrahelp MoreHelp(
   "\nAdd \"-- <compiler arguments>\" at the end to setup the compiler "
   "invocation\n"
@@ -147,6 +152,8 @@ static bool printSourceSymbols(ArrayRef<const char *> Args) {
 
   auto DataConsumer = std::make_shared<PrintIndexDataConsumer>(outs());
   IndexingOptions IndexOpts;
+  IndexOpts.SkipFunctionBodiesOutsideMainFile =
+      options::SkipFunctionBodiesOutsideMainFile;
   std::unique_ptr<FrontendAction> IndexAction;
   IndexAction = createIndexingAction(DataConsumer, IndexOpts,
                                      /*WrappedAction=*/nullptr);
@@ -171,6 +171,11 @@ int main(int argc, const char **argv) {
   Tool.appendArgumentsAdjuster(getInsertArgumentAdjuster(
       Analyze ? "--analyze" : "-fsyntax-only", ArgumentInsertPosition::BEGIN));
 
+  // The AST dumping modes write straight to stdout, so only run independent
+  // translation units concurrently when nothing is being printed.
+  if (!ASTList && !ASTDump && !ASTPrint)
+    Tool.setNumThreads(OptionsParser.getNumThreads());
+
   ClangCheckActionFactory CheckFactory;
   std::unique_ptr<FrontendActionFactory> FrontendFactory;
 
@@ -23,6 +23,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -102,6 +103,12 @@ static cl::opt<bool> SortIncludes(
              "SortIncludes style flag"),
     cl::cat(ClangFormatCategory));
 
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("Number of files to format concurrently when\n"
+                        "several <file>s are given."),
+               cl::init(1), cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
@@ -163,6 +170,12 @@ static bool fillRanges(MemoryBuffer *Code,
     return false;
   }
 
+  // Without any ranges, format the whole file. Don't default -offset for
+  // that, several files may be formatted concurrently.
+  if (Offsets.empty() && Lengths.empty()) {
+    Ranges.push_back(tooling::Range(0, Code->getBufferSize()));
+    return false;
+  }
   if (Offsets.empty())
     Offsets.push_back(0);
   if (Offsets.size() != Lengths.size() &&
@@ -196,50 +209,52 @@ static bool fillRanges(MemoryBuffer *Code,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(StringRef Text, raw_ostream &OS) {
   // FIXME: When we sort includes, we need to make sure the stream is correct
   // utf-8.
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r<&", From)) != StringRef::npos) {
-    outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      outs() << "&#13;";
+      OS << "&#13;";
       break;
     case '<':
-      outs() << "&lt;";
+      OS << "&lt;";
       break;
     case '&':
-      outs() << "&amp;";
+      OS << "&amp;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-static void outputReplacementsXML(const Replacements &Replaces) {
+static void outputReplacementsXML(const Replacements &Replaces,
+                                  raw_ostream &OS) {
   for (const auto &R : Replaces) {
-    outs() << "<replacement "
-           << "offset='" << R.getOffset() << "' "
-           << "length='" << R.getLength() << "'>";
-    outputReplacementXML(R.getReplacementText());
-    outs() << "</replacement>\n";
+    OS << "<replacement "
+       << "offset='" << R.getOffset() << "' "
+       << "length='" << R.getLength() << "'>";
+    outputReplacementXML(R.getReplacementText(), OS);
+    OS << "</replacement>\n";
   }
 }
 
 // Returns true on error.
-static bool format(StringRef FileName) {
+static bool format(StringRef FileName, FormatStyleCache &Styles,
+                   raw_ostream &OS, raw_ostream &ErrOS) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
       MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = CodeOrErr.getError()) {
-    errs() << EC.message() << "\n";
+    ErrOS << EC.message() << "\n";
     return true;
   }
   std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
@@ -249,8 +264,8 @@ static bool format(StringRef FileName) {
   if (fillRanges(Code.get(), Ranges))
     return true;
   StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
-  FormatStyle FormatStyle =
-      getStyle(Style, AssumedFileName, FallbackStyle, Code->getBuffer());
+  FormatStyle FormatStyle = Styles.getStyle(Style, AssumedFileName,
+                                            FallbackStyle, Code->getBuffer());
   if (SortIncludes.getNumOccurrences() != 0)
     FormatStyle.SortIncludes = SortIncludes;
   unsigned CursorPosition = Cursor;
@@ -258,7 +273,7 @@ static bool format(StringRef FileName) {
                                        AssumedFileName, &CursorPosition);
   auto ChangedCode = tooling::applyAllReplacements(Code->getBuffer(), Replaces);
   if (!ChangedCode) {
-    llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
+    ErrOS << llvm::toString(ChangedCode.takeError()) << "\n";
     return true;
   }
   // Get new affected ranges after sorting `#includes`.
@@ -268,16 +283,15 @@ static bool format(StringRef FileName) {
                                         AssumedFileName, &IncompleteFormat);
   Replaces = Replaces.merge(FormatChanges);
   if (OutputXML) {
-    outs() << "<?xml version='1.0'?>\n<replacements "
-              "xml:space='preserve' incomplete_format='"
-           << (IncompleteFormat ? "true" : "false") << "'>\n";
+    OS << "<?xml version='1.0'?>\n<replacements "
+          "xml:space='preserve' incomplete_format='"
+       << (IncompleteFormat ? "true" : "false") << "'>\n";
     if (Cursor.getNumOccurrences() != 0)
-      outs() << "<cursor>"
-             << FormatChanges.getShiftedCodePosition(CursorPosition)
-             << "</cursor>\n";
+      OS << "<cursor>" << FormatChanges.getShiftedCodePosition(CursorPosition)
+         << "</cursor>\n";
 
-    outputReplacementsXML(Replaces);
-    outs() << "</replacements>\n";
+    outputReplacementsXML(Replaces, OS);
+    OS << "</replacements>\n";
   } else {
     IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
         new vfs::InMemoryFileSystem);
@@ -292,21 +306,50 @@ static bool format(StringRef FileName) {
     tooling::applyAllReplacements(Replaces, Rewrite);
     if (Inplace) {
       if (FileName == "-")
-        errs() << "error: cannot use -i when reading from stdin.\n";
+        ErrOS << "error: cannot use -i when reading from stdin.\n";
       else if (Rewrite.overwriteChangedFiles())
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": "
-               << FormatChanges.getShiftedCodePosition(CursorPosition)
-               << ", \"IncompleteFormat\": "
-               << (IncompleteFormat ? "true" : "false") << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+        OS << "{ \"Cursor\": "
+           << FormatChanges.getShiftedCodePosition(CursorPosition)
+           << ", \"IncompleteFormat\": "
+           << (IncompleteFormat ? "true" : "false") << " }\n";
+      Rewrite.getEditBuffer(ID).write(OS);
     }
   }
   return false;
 }
 
+// Formats all files on NumThreads threads, writing their output and errors in
+// the order the files were given. Returns true on error.
+static bool formatConcurrently(ArrayRef<std::string> Files,
+                               FormatStyleCache &Styles) {
+  struct Result {
+    std::string Output;
+    std::string Errors;
+    bool Error = false;
+  };
+  std::vector<Result> Results(Files.size());
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned i = 0, e = Files.size(); i != e; ++i)
+      Pool.async([&, i] {
+        raw_string_ostream OS(Results[i].Output);
+        raw_string_ostream ErrOS(Results[i].Errors);
+        Results[i].Error = format(Files[i], Styles, OS, ErrOS);
+      });
+  }
+
+  bool Error = false;
+  for (const Result &R : Results) {
+    outs() << R.Output;
+    errs() << R.Errors;
+    Error |= R.Error;
+  }
+  return Error;
+}
+
 }  // namespace format
 }  // namespace clang
 
@@ -342,13 +385,15 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  // Files in the same directory share their style.
+  clang::format::FormatStyleCache Styles;
   bool Error = false;
   switch (FileNames.size()) {
   case 0:
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", Styles, outs(), errs());
     break;
   case 1:
-    Error = clang::format::format(FileNames[0]);
+    Error = clang::format::format(FileNames[0], Styles, outs(), errs());
     break;
   default:
     if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty()) {
@@ -356,8 +401,12 @@ int main(int argc, const char **argv) {
                 "single file.\n";
       return 1;
     }
+    if (NumThreads > 1) {
+      Error = clang::format::formatConcurrently(FileNames, Styles);
+      break;
+    }
     for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
+      Error |= clang::format::format(FileNames[i], Styles, outs(), errs());
     break;
   }
   return Error ? 1 : 0;
@@ -0,0 +1,120 @@
+//===-- ClangPerfFuzzer.cpp - Fuzz Clang for Slow Inputs ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements a function that runs the lexer, the parser and
+///  semantic analysis, and clang-format on a single input, and treats the
+///  input as a finding if any phase takes longer than its budget. This
+///  function is then linked into the Fuzzer library.
+///
+///  The phases are timed with the -ftime-trace scopes, so the report names
+///  the part of the compiler which was slow, e.g. InstantiateFunction or
+///  ReformatLineSearch. The budget is 1000 milliseconds per phase, and can be
+///  changed with -phase-budget-ms=<N>.
+///
+///  Running the fuzzer on the inputs in slow-inputs/ measures these phases on
+///  known pathological code, as a compile-time regression benchmark.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Format/Format.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Option/Option.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace clang;
+
+static unsigned PhaseBudgetMS = 1000;
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) {
+  for (int I = 1; I < *argc; ++I) {
+    StringRef Arg = (*argv)[I];
+    if (Arg.startswith("-phase-budget-ms="))
+      Arg.substr(strlen("-phase-budget-ms=")).getAsInteger(10, PhaseBudgetMS);
+  }
+  return 0;
+}
+
+static void lex(StringRef Code) {
+  TimeTraceScope TimeScope("Lex");
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = true;
+  Lexer L(SourceLocation(), LangOpts, Code.begin(), Code.begin(), Code.end());
+  Token Tok;
+  do
+    L.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof));
+}
+
+static void parse(StringRef Code) {
+  llvm::opt::ArgStringList CC1Args;
+  CC1Args.push_back("-cc1");
+  CC1Args.push_back("./test.cc");
+  llvm::IntrusiveRefCntPtr<FileManager> Files(
+      new FileManager(FileSystemOptions()));
+  IgnoringDiagConsumer Diags;
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  DiagnosticsEngine Diagnostics(
+      IntrusiveRefCntPtr<clang::DiagnosticIDs>(new DiagnosticIDs()), &*DiagOpts,
+      &Diags, false);
+  std::unique_ptr<clang::CompilerInvocation> Invocation(
+      tooling::newInvocation(&Diagnostics, CC1Args));
+  std::unique_ptr<llvm::MemoryBuffer> Input =
+      llvm::MemoryBuffer::getMemBuffer(Code);
+  Invocation->getPreprocessorOpts().addRemappedFile("./test.cc",
+                                                    Input.release());
+  std::unique_ptr<tooling::ToolAction> action(
+      tooling::newFrontendActionFactory<clang::SyntaxOnlyAction>());
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps =
+      std::make_shared<PCHContainerOperations>();
+  action->runInvocation(Invocation.release(), Files.get(), PCHContainerOps,
+                        &Diags);
+}
+
+static void reformat(StringRef Code) {
+  tooling::Range Range(0, Code.size());
+  format::reformat(format::getLLVMStyle(), Code, Range, "test.cc");
+}
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t *data, size_t size) {
+  // The lexer expects a null-terminated buffer.
+  std::string s((const char *)data, size);
+
+  // Only the totals are needed, so don't keep the events of a single scope.
+  timeTraceProfilerInitialize(/*GranularityUS=*/~0U);
+  lex(s);
+  parse(s);
+  reformat(s);
+
+  uint64_t BudgetUS = uint64_t(PhaseBudgetMS) * 1000;
+  bool Slow = false;
+  timeTraceProfilerForEachTotal(
+      [&](StringRef Name, unsigned Count, uint64_t DurationUS) {
+        if (DurationUS <= BudgetUS)
+          return;
+        llvm::errs() << "slow input: " << Name
+                     << " took " << DurationUS / 1000 << " ms in " << Count
+                     << " scope" << (Count == 1 ? "" : "s") << " (budget "
+                     << PhaseBudgetMS << " ms)\n";
+        Slow = true;
+      });
+  timeTraceProfilerCleanup();
+
+  // Report the input the way libFuzzer reports a crash, so that it is saved.
+  if (Slow)
+    abort();
+  return 0;
+}
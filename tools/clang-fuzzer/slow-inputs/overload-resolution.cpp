@@ -0,0 +1,130 @@
+struct T0 { T0(int); };
+struct T1 { T1(int); };
+struct T2 { T2(int); };
+struct T3 { T3(int); };
+struct T4 { T4(int); };
+struct T5 { T5(int); };
+struct T6 { T6(int); };
+struct T7 { T7(int); };
+struct T8 { T8(int); };
+struct T9 { T9(int); };
+struct T10 { T10(int); };
+struct T11 { T11(int); };
+struct T12 { T12(int); };
+struct T13 { T13(int); };
+struct T14 { T14(int); };
+struct T15 { T15(int); };
+struct T16 { T16(int); };
+struct T17 { T17(int); };
+struct T18 { T18(int); };
+struct T19 { T19(int); };
+struct T20 { T20(int); };
+struct T21 { T21(int); };
+struct T22 { T22(int); };
+struct T23 { T23(int); };
+struct T24 { T24(int); };
+struct T25 { T25(int); };
+struct T26 { T26(int); };
+struct T27 { T27(int); };
+struct T28 { T28(int); };
+struct T29 { T29(int); };
+struct T30 { T30(int); };
+struct T31 { T31(int); };
+struct T32 { T32(int); };
+struct T33 { T33(int); };
+struct T34 { T34(int); };
+struct T35 { T35(int); };
+struct T36 { T36(int); };
+struct T37 { T37(int); };
+struct T38 { T38(int); };
+struct T39 { T39(int); };
+struct T40 { T40(int); };
+struct T41 { T41(int); };
+struct T42 { T42(int); };
+struct T43 { T43(int); };
+struct T44 { T44(int); };
+struct T45 { T45(int); };
+struct T46 { T46(int); };
+struct T47 { T47(int); };
+struct T48 { T48(int); };
+struct T49 { T49(int); };
+struct T50 { T50(int); };
+struct T51 { T51(int); };
+struct T52 { T52(int); };
+struct T53 { T53(int); };
+struct T54 { T54(int); };
+struct T55 { T55(int); };
+struct T56 { T56(int); };
+struct T57 { T57(int); };
+struct T58 { T58(int); };
+struct T59 { T59(int); };
+struct T60 { T60(int); };
+struct T61 { T61(int); };
+struct T62 { T62(int); };
+struct T63 { T63(int); };
+int f(T0, T1);
+int f(T1, T2);
+int f(T2, T3);
+int f(T3, T4);
+int f(T4, T5);
+int f(T5, T6);
+int f(T6, T7);
+int f(T7, T8);
+int f(T8, T9);
+int f(T9, T10);
+int f(T10, T11);
+int f(T11, T12);
+int f(T12, T13);
+int f(T13, T14);
+int f(T14, T15);
+int f(T15, T16);
+int f(T16, T17);
+int f(T17, T18);
+int f(T18, T19);
+int f(T19, T20);
+int f(T20, T21);
+int f(T21, T22);
+int f(T22, T23);
+int f(T23, T24);
+int f(T24, T25);
+int f(T25, T26);
+int f(T26, T27);
+int f(T27, T28);
+int f(T28, T29);
+int f(T29, T30);
+int f(T30, T31);
+int f(T31, T32);
+int f(T32, T33);
+int f(T33, T34);
+int f(T34, T35);
+int f(T35, T36);
+int f(T36, T37);
+int f(T37, T38);
+int f(T38, T39);
+int f(T39, T40);
+int f(T40, T41);
+int f(T41, T42);
+int f(T42, T43);
+int f(T43, T44);
+int f(T44, T45);
+int f(T45, T46);
+int f(T46, T47);
+int f(T47, T48);
+int f(T48, T49);
+int f(T49, T50);
+int f(T50, T51);
+int f(T51, T52);
+int f(T52, T53);
+int f(T53, T54);
+int f(T54, T55);
+int f(T55, T56);
+int f(T56, T57);
+int f(T57, T58);
+int f(T58, T59);
+int f(T59, T60);
+int f(T60, T61);
+int f(T61, T62);
+int f(T62, T63);
+int f(T63, T0);
+int f(int, int);
+int x = f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(f(1, 0), 1), 2), 3), 4), 5), 6), 7), 8), 9), 10), 11), 12), 13), 14), 15), 16), 17), 18), 19), 20), 21), 22), 23);
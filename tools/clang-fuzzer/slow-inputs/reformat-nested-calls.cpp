@@ -0,0 +1,2 @@
+int a;
+int x = function20(argument20, function19(argument19, function18(argument18, function17(argument17, function16(argument16, function15(argument15, function14(argument14, function13(argument13, function12(argument12, function11(argument11, function10(argument10, function9(argument9, function8(argument8, function7(argument7, function6(argument6, function5(argument5, function4(argument4, function3(argument3, function2(argument2, function1(argument1, a, other1), other2), other3), other4), other5), other6), other7), other8), other9), other10), other11), other12), other13), other14), other15), other16), other17), other18), other19), other20);
@@ -0,0 +1,8 @@
+template <int N> struct R {
+  static const int value = R<N - 1>::value + 1;
+  int a[N];
+};
+template <> struct R<0> {
+  static const int value = 0;
+};
+int x = R<1000>::value;
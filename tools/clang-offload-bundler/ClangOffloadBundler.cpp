@@ -41,6 +41,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
@@ -48,6 +49,7 @@
 #include <memory>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
 using namespace llvm;
@@ -180,8 +182,8 @@ public:
   /// Read the marker that closes the current bundle.
   virtual void ReadBundleEnd(MemoryBuffer &Input) = 0;
 
-  /// Read the current bundle and write the result into the stream \a OS.
-  virtual void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) = 0;
+  /// Return the contents of the current bundle, which point into \a Input.
+  virtual StringRef ReadBundle(MemoryBuffer &Input) = 0;
 
   /// Write the header of the bundled file to \a OS based on the information
   /// gathered from \a Inputs.
@@ -347,11 +349,10 @@ public:
     ++CurBundleInfo;
   }
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  StringRef ReadBundle(MemoryBuffer &Input) final {
     assert(CurBundleInfo != BundlesInfo.end() && "Invalid reader info!");
     StringRef FC = Input.getBuffer();
-    OS.write(FC.data() + CurBundleInfo->second.Offset,
-             CurBundleInfo->second.Size);
+    return FC.substr(CurBundleInfo->second.Offset, CurBundleInfo->second.Size);
   }
 
   void WriteHeader(raw_fd_ostream &OS,
@@ -486,7 +487,7 @@ public:
 
   void ReadBundleEnd(MemoryBuffer &Input) final {}
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  StringRef ReadBundle(MemoryBuffer &Input) final {
     // If the current section has size one, that means that the content we are
     // interested in is the file itself. Otherwise it is the content of the
     // section.
@@ -498,9 +499,8 @@ public:
     CurrentSection->getContents(Content);
 
     if (Content.size() < 2)
-      OS.write(Input.getBufferStart(), Input.getBufferSize());
-    else
-      OS.write(Content.data(), Content.size());
+      return Input.getBuffer();
+    return Content;
   }
 
   void WriteHeader(raw_fd_ostream &OS,
@@ -699,15 +699,14 @@ protected:
     ++ReadChars;
   }
 
-  void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+  StringRef ReadBundle(MemoryBuffer &Input) final {
     StringRef FC = Input.getBuffer();
     size_t BundleStart = ReadChars;
 
     // Find end of the bundle.
     size_t BundleEnd = ReadChars = FC.find(BundleEndString, ReadChars);
 
-    StringRef Bundle(&FC.data()[BundleStart], BundleEnd - BundleStart);
-    OS << Bundle;
+    return StringRef(&FC.data()[BundleStart], BundleEnd - BundleStart);
   }
 
   void WriteHeader(raw_fd_ostream &OS,
@@ -814,8 +813,11 @@ static bool BundleFiles() {
 
   unsigned Idx = 0;
   for (auto &I : InputFileNames) {
+    // The inputs are only copied to the output, so there is no need for a
+    // null terminator, which could prevent them from being mapped.
     ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-        MemoryBuffer::getFileOrSTDIN(I);
+        MemoryBuffer::getFileOrSTDIN(I, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
     if (std::error_code EC = CodeOrErr.getError()) {
       errs() << "error: Can't open file " << I << ": " << EC.message() << "\n";
       return true;
@@ -848,6 +850,42 @@ static bool BundleFiles() {
   return false;
 }
 
+/// Write the contents of each of \a Outputs, pairs of file names and contents,
+/// to its file. The files are written concurrently, straight from the mapped
+/// input. Return true if an error was found.
+static bool
+WriteOutputFiles(ArrayRef<std::pair<StringRef, StringRef>> Outputs) {
+  std::vector<std::string> Errors(Outputs.size());
+  {
+    ThreadPool Pool;
+    for (size_t I = 0, E = Outputs.size(); I != E; ++I)
+      Pool.async([&, I] {
+        std::error_code EC;
+        raw_fd_ostream OutputFile(Outputs[I].first, EC, sys::fs::F_None);
+        if (EC) {
+          Errors[I] = "Can't open file " + Outputs[I].first.str() + ": " +
+                      EC.message();
+          return;
+        }
+        OutputFile << Outputs[I].second;
+        OutputFile.close();
+        if (OutputFile.has_error()) {
+          OutputFile.clear_error();
+          Errors[I] = "Can't write file " + Outputs[I].first.str();
+        }
+      });
+    Pool.wait();
+  }
+
+  bool Failed = false;
+  for (const std::string &Error : Errors)
+    if (!Error.empty()) {
+      errs() << "error: " << Error << "\n";
+      Failed = true;
+    }
+  return Failed;
+}
+
 // Unbundle the files. Return true if an error was found.
 static bool UnbundleFiles(StringRef ArchiveFileName="",
       std::vector<std::string> *NewOutputFileNames=nullptr) {
@@ -856,9 +894,11 @@ static bool UnbundleFiles(StringRef ArchiveFileName="",
   if (ArchiveFileName != "")
     InputFile = ArchiveFileName;
 
-  // Open Input file.
+  // Open Input file. The bundles are copied straight out of it, so it is
+  // mapped rather than read when possible.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFile);
+      MemoryBuffer::getFileOrSTDIN(InputFile, /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError()) {
     errs() << "error: Can't open file " << InputFile << ": "
            << EC.message() << "\n";
@@ -897,8 +937,9 @@ static bool UnbundleFiles(StringRef ArchiveFileName="",
     }
   }
 
-  // Read all the bundles that are in the work list. If we find no bundles we
+  // Find all the bundles that are in the work list. If we find no bundles we
   // assume the file is meant for the host target.
+  std::vector<std::pair<StringRef, StringRef>> Outputs;
   bool FoundHostBundle = false;
   while (!Worklist.empty()) {
     StringRef CurTriple = FH.get()->ReadBundleStart(Input);
@@ -914,15 +955,8 @@ static bool UnbundleFiles(StringRef ArchiveFileName="",
       continue;
     }
 
-    // Check if the output file can be opened and copy the bundle to it.
-    std::error_code EC;
-    raw_fd_ostream OutputFile(Output->second, EC, sys::fs::F_None);
-    if (EC) {
-      errs() << "error: Can't open file " << Output->second << ": "
-             << EC.message() << "\n";
-      return true;
-    }
-    FH.get()->ReadBundle(OutputFile, Input);
+    Outputs.push_back(
+        std::make_pair(Output->second, FH.get()->ReadBundle(Input)));
     FH.get()->ReadBundleEnd(Input);
     Worklist.erase(Output);
 
@@ -934,20 +968,10 @@ static bool UnbundleFiles(StringRef ArchiveFileName="",
   // If no bundles were found, assume the input file is the host bundle and
   // create empty files for the remaining targets.
   if (Worklist.size() == TargetNames.size()) {
-    for (auto &E : Worklist) {
-      std::error_code EC;
-      raw_fd_ostream OutputFile(E.second, EC, sys::fs::F_None);
-      if (EC) {
-        errs() << "error: Can't open file " << E.second << ": " << EC.message()
-               << "\n";
-        return true;
-      }
-
-      // If this entry has a host kind, copy the input file to the output file.
-      if (hasHostKind(E.first()))
-        OutputFile.write(Input.getBufferStart(), Input.getBufferSize());
-    }
-    return false;
+    for (auto &E : Worklist)
+      Outputs.push_back(std::make_pair(
+          E.second, hasHostKind(E.first()) ? Input.getBuffer() : StringRef()));
+    return WriteOutputFiles(Outputs);
   }
 
   // If we found elements, we emit an error if none of those were for the host.
@@ -957,17 +981,10 @@ static bool UnbundleFiles(StringRef ArchiveFileName="",
   }
 
   // If we still have any elements in the worklist, create empty files for them.
-  for (auto &E : Worklist) {
-    std::error_code EC;
-    raw_fd_ostream OutputFile(E.second, EC, sys::fs::F_None);
-    if (EC) {
-      errs() << "error: Can't open file " << E.second << ": "  << EC.message()
-             << "\n";
-      return true;
-    }
-  }
+  for (auto &E : Worklist)
+    Outputs.push_back(std::make_pair(E.second, StringRef()));
 
-  return false;
+  return WriteOutputFiles(Outputs);
 }
 
 // Function that assembles an argument.
@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/Arg.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Config/config.h"
 #include "clang/Driver/DriverDiagnostic.h"
@@ -30,7 +31,9 @@
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
@@ -49,6 +52,13 @@ using namespace llvm::opt;
 // Main driver
 //===----------------------------------------------------------------------===//
 
+/// Set by the driver while it runs a -cc1 job in its own process. A fatal
+/// error then returns from the innermost CrashRecoveryContext instead of
+/// exiting, and leaves the status it would have exited with in
+/// CC1FatalErrorStatus.
+bool CC1RunsInProcess = false;
+int CC1FatalErrorStatus = 0;
+
 static void LLVMErrorHandler(void *UserData, const std::string &Message,
                              bool GenCrashDiag) {
   DiagnosticsEngine &Diags = *static_cast<DiagnosticsEngine*>(UserData);
@@ -62,7 +72,15 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
-  exit(GenCrashDiag ? 70 : 1);
+  int Status = GenCrashDiag ? 70 : 1;
+  if (CC1RunsInProcess) {
+    if (llvm::CrashRecoveryContext *CRC =
+            llvm::CrashRecoveryContext::GetCurrent()) {
+      CC1FatalErrorStatus = Status;
+      CRC->HandleCrash();
+    }
+  }
+  exit(Status);
 }
 
 #ifdef LINK_POLLY_INTO_TOOLS
@@ -217,8 +235,29 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
+  const FrontendOptions &FrontendOpts = Clang->getFrontendOpts();
+  if (!FrontendOpts.TimeTracePath.empty())
+    timeTraceProfilerInitialize(FrontendOpts.TimeTraceGranularity);
+
   // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  {
+    TimeTraceScope TimeScope("ExecuteCompiler");
+    Success = ExecuteCompilerInvocation(Clang.get());
+  }
+
+  if (timeTraceProfilerEnabled()) {
+    std::error_code EC;
+    llvm::raw_fd_ostream TraceOS(FrontendOpts.TimeTracePath, EC,
+                                 llvm::sys::fs::F_Text);
+    if (EC) {
+      Clang->getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << FrontendOpts.TimeTracePath << EC.message();
+      Success = false;
+    } else {
+      timeTraceProfilerWrite(TraceOS);
+    }
+    timeTraceProfilerCleanup();
+  }
 
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
@@ -0,0 +1,388 @@
+//===-- cc1server_main.cpp - Clang CC1 Compile Server ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1server functionality, a long-running
+// process which runs clang -cc1 jobs sent to it over a Unix domain socket, and
+// the client used by the driver when CLANG_CC1_SERVER names such a socket.
+//
+// Each job runs in a process forked from the server, so it starts from the
+// server's already loaded and initialized process image, but without any of
+// the state left behind by earlier jobs. The client's standard input, output
+// and error are passed along with each request, so a job's output goes where
+// it would have gone had the driver executed it itself.
+//
+// Anyone who can connect to the server can run any job as the server's user,
+// so the socket must be in a directory only its owner can access, and both
+// ends check that they are run by the same user.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef LLVM_ON_UNIX
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+
+extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
+                    void *MainAddr);
+
+#ifdef LLVM_ON_UNIX
+
+/// The client's standard input, output and error are passed with a request.
+static const int NumPassedFDs = 3;
+
+/// Fill in \p Addr for the socket at \p Path, returning false if the path is
+/// too long for a socket address.
+static bool getSocketAddress(StringRef Path, sockaddr_un &Addr) {
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Addr.sun_path))
+    return false;
+  memcpy(Addr.sun_path, Path.data(), Path.size());
+  return true;
+}
+
+/// Check that the socket at \p Path is in a directory which belongs to this
+/// user and which nobody else can access.
+static bool isInPrivateDirectory(StringRef Path) {
+  SmallString<128> Dir(sys::path::parent_path(Path));
+  if (Dir.empty())
+    Dir = ".";
+  struct stat Status;
+  return ::stat(Dir.c_str(), &Status) == 0 && S_ISDIR(Status.st_mode) &&
+         Status.st_uid == ::geteuid() &&
+         !(Status.st_mode & (S_IRWXG | S_IRWXO));
+}
+
+/// Check that the process at the other end of the connection \p FD is run by
+/// the same user as this one.
+static bool isPeerSameUser(int FD) {
+  uid_t UID;
+#ifdef SO_PEERCRED
+  ucred Cred;
+  socklen_t Len = sizeof(Cred);
+  if (::getsockopt(FD, SOL_SOCKET, SO_PEERCRED, &Cred, &Len) < 0 ||
+      Len != sizeof(Cred))
+    return false;
+  UID = Cred.uid;
+#else
+  gid_t GID;
+  if (::getpeereid(FD, &UID, &GID) < 0)
+    return false;
+#endif
+  return UID == ::geteuid();
+}
+
+static bool writeAll(int FD, const char *Data, size_t Size) {
+  while (Size) {
+    ssize_t Written = ::write(FD, Data, Size);
+    if (Written < 0 && errno == EINTR)
+      continue;
+    if (Written <= 0)
+      return false;
+    Data += Written;
+    Size -= Written;
+  }
+  return true;
+}
+
+static bool readAll(int FD, char *Data, size_t Size) {
+  while (Size) {
+    ssize_t Read = ::read(FD, Data, Size);
+    if (Read < 0 && errno == EINTR)
+      continue;
+    if (Read <= 0)
+      return false;
+    Data += Read;
+    Size -= Read;
+  }
+  return true;
+}
+
+namespace {
+/// Ancillary data large enough to carry the passed file descriptors.
+union PassedFDsControl {
+  cmsghdr Header;
+  char Buffer[CMSG_SPACE(sizeof(int) * NumPassedFDs)];
+};
+}
+
+/// Send a request: the size of \p Payload along with this process' standard
+/// file descriptors, followed by \p Payload itself.
+static bool sendRequest(int FD, StringRef Payload) {
+  uint32_t Size = Payload.size();
+  iovec IOV;
+  IOV.iov_base = &Size;
+  IOV.iov_len = sizeof(Size);
+
+  PassedFDsControl Control;
+  memset(&Control, 0, sizeof(Control));
+  msghdr Msg;
+  memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IOV;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control.Buffer;
+  Msg.msg_controllen = sizeof(Control.Buffer);
+
+  cmsghdr *Header = CMSG_FIRSTHDR(&Msg);
+  Header->cmsg_level = SOL_SOCKET;
+  Header->cmsg_type = SCM_RIGHTS;
+  Header->cmsg_len = CMSG_LEN(sizeof(int) * NumPassedFDs);
+  int FDs[NumPassedFDs] = {0, 1, 2};
+  memcpy(CMSG_DATA(Header), FDs, sizeof(FDs));
+
+  ssize_t Sent;
+  do
+    Sent = ::sendmsg(FD, &Msg, 0);
+  while (Sent < 0 && errno == EINTR);
+  return Sent == sizeof(Size) && writeAll(FD, Payload.data(), Payload.size());
+}
+
+/// Receive a request sent by sendRequest.
+static bool receiveRequest(int FD, std::string &Payload,
+                           int (&FDs)[NumPassedFDs]) {
+  uint32_t Size;
+  iovec IOV;
+  IOV.iov_base = &Size;
+  IOV.iov_len = sizeof(Size);
+
+  PassedFDsControl Control;
+  msghdr Msg;
+  memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IOV;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control.Buffer;
+  Msg.msg_controllen = sizeof(Control.Buffer);
+
+  ssize_t Received;
+  do
+    Received = ::recvmsg(FD, &Msg, 0);
+  while (Received < 0 && errno == EINTR);
+  if (Received != sizeof(Size))
+    return false;
+
+  cmsghdr *Header = CMSG_FIRSTHDR(&Msg);
+  if (!Header || Header->cmsg_level != SOL_SOCKET ||
+      Header->cmsg_type != SCM_RIGHTS ||
+      Header->cmsg_len != CMSG_LEN(sizeof(FDs)))
+    return false;
+  memcpy(FDs, CMSG_DATA(Header), sizeof(FDs));
+
+  Payload.resize(Size);
+  return readAll(FD, &Payload[0], Size);
+}
+
+/// Run the job described by \p Payload, the working directory followed by the
+/// -cc1 arguments, each null terminated, in a new process with the client's
+/// file descriptors \p FDs. Returns its exit code, or -2 if it crashed.
+static int runJob(const std::string &Payload, const int (&FDs)[NumPassedFDs],
+                  const char *Argv0, void *MainAddr) {
+  const char *WorkingDir = Payload.c_str();
+  SmallVector<const char *, 128> Args;
+  for (size_t I = strlen(WorkingDir) + 1; I < Payload.size();
+       I += strlen(Payload.c_str() + I) + 1)
+    Args.push_back(Payload.c_str() + I);
+  if (Args.empty() || StringRef(Args.front()) != "-cc1")
+    return 1;
+
+  pid_t Pid = ::fork();
+  if (Pid < 0)
+    return 1;
+  if (Pid == 0) {
+    for (int I = 0; I != NumPassedFDs; ++I)
+      if (::dup2(FDs[I], I) < 0)
+        ::_exit(1);
+    if (::chdir(WorkingDir) != 0)
+      ::_exit(1);
+    std::exit(cc1_main(makeArrayRef(Args).slice(1), Argv0, MainAddr));
+  }
+
+  int Status;
+  while (::waitpid(Pid, &Status, 0) < 0)
+    if (errno != EINTR)
+      return 1;
+  if (WIFEXITED(Status))
+    return WEXITSTATUS(Status);
+  return -2;
+}
+
+/// Serve a single connection: read its request, run the job and send back
+/// the job's exit code. With \p Verbose, each job's arguments are printed.
+static int handleConnection(int Conn, bool Verbose, const char *Argv0,
+                            void *MainAddr) {
+  std::string Payload;
+  int FDs[NumPassedFDs];
+  if (!isPeerSameUser(Conn) || !receiveRequest(Conn, Payload, FDs))
+    return 1;
+
+  if (Verbose) {
+    for (size_t I = strlen(Payload.c_str()) + 1; I < Payload.size();
+         I += strlen(Payload.c_str() + I) + 1)
+      errs() << ' ' << (Payload.c_str() + I);
+    errs() << '\n';
+  }
+
+  int Result = runJob(Payload, FDs, Argv0, MainAddr);
+  for (int FD : FDs)
+    ::close(FD);
+  return writeAll(Conn, reinterpret_cast<const char *>(&Result),
+                  sizeof(Result))
+             ? 0
+             : 1;
+}
+
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  bool Verbose = !Argv.empty() && StringRef(Argv[0]) == "-v";
+  if (Verbose)
+    Argv = Argv.slice(1);
+  if (Argv.size() != 1) {
+    errs() << "error: usage: clang -cc1server [-v] <socket path>\n";
+    return 1;
+  }
+  StringRef Path = Argv[0];
+
+  // Do the start-up work which every job would otherwise repeat, once.
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+  InitializeAllAsmPrinters();
+  InitializeAllAsmParsers();
+
+  sockaddr_un Addr;
+  if (!getSocketAddress(Path, Addr)) {
+    errs() << "error: socket path '" << Path << "' is too long\n";
+    return 1;
+  }
+
+  if (!isInPrivateDirectory(Path)) {
+    errs() << "error: socket path '" << Path
+           << "' must be in a directory which only its owner can access\n";
+    return 1;
+  }
+
+  // Create the socket accessible to this user only, whatever the umask.
+  ::unlink(Addr.sun_path);
+  int Listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  mode_t OldMask = ::umask(S_IRWXG | S_IRWXO);
+  bool Bound = Listener >= 0 &&
+               ::bind(Listener, reinterpret_cast<sockaddr *>(&Addr),
+                      sizeof(Addr)) == 0;
+  ::umask(OldMask);
+  if (!Bound || ::chmod(Addr.sun_path, S_IRUSR | S_IWUSR) < 0 ||
+      ::listen(Listener, SOMAXCONN) < 0) {
+    errs() << "error: cannot listen on '" << Path << "': " << strerror(errno)
+           << "\n";
+    return 1;
+  }
+
+  // Connection handlers are never waited for, so have them reaped
+  // automatically.
+  ::signal(SIGCHLD, SIG_IGN);
+
+  // Make sure nothing buffered is inherited by, and so written again from,
+  // every handler.
+  outs().flush();
+
+  while (true) {
+    int Conn = ::accept(Listener, nullptr, nullptr);
+    if (Conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      errs() << "error: cannot accept connections on '" << Path
+             << "': " << strerror(errno) << "\n";
+      return 1;
+    }
+
+    // Handle each connection in its own process so that jobs run
+    // concurrently; the handler waits for its job, so it needs SIGCHLD back.
+    pid_t Pid = ::fork();
+    if (Pid == 0) {
+      ::close(Listener);
+      ::signal(SIGCHLD, SIG_DFL);
+      ::_exit(handleConnection(Conn, Verbose, Argv0, MainAddr));
+    }
+    ::close(Conn);
+  }
+}
+
+bool runCC1OnServer(ArrayRef<const char *> Argv, int &Result,
+                    std::string *ErrMsg) {
+  const char *Path = ::getenv("CLANG_CC1_SERVER");
+  sockaddr_un Addr;
+  if (!Path || !getSocketAddress(Path, Addr))
+    return false;
+
+  SmallString<256> WorkingDir;
+  if (sys::fs::current_path(WorkingDir))
+    return false;
+  std::string Payload = WorkingDir.str();
+  Payload.push_back('\0');
+  for (const char *Arg : Argv) {
+    Payload += Arg;
+    Payload.push_back('\0');
+  }
+
+  // If there is no server to take the job, or it never got the whole
+  // request, the job hasn't started and can still be run normally. Never
+  // hand this process' files to a server run by somebody else.
+  int FD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0)
+    return false;
+  if (::connect(FD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) < 0 ||
+      !isPeerSameUser(FD) || !sendRequest(FD, Payload)) {
+    ::close(FD);
+    return false;
+  }
+
+  bool GotResult = readAll(FD, reinterpret_cast<char *>(&Result),
+                           sizeof(Result));
+  ::close(FD);
+  if (!GotResult) {
+    Result = -1;
+    if (ErrMsg)
+      *ErrMsg = "lost connection to the clang -cc1 server";
+  }
+  return true;
+}
+
+#else
+
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  errs() << "error: clang -cc1server is not supported on this platform\n";
+  return 1;
+}
+
+bool runCC1OnServer(ArrayRef<const char *> Argv, int &Result,
+                    std::string *ErrMsg) {
+  return false;
+}
+
+#endif
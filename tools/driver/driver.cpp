@@ -31,6 +31,7 @@
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -198,6 +199,12 @@ extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
                     void *MainAddr);
 extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
+extern int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                          void *MainAddr);
+extern bool CC1RunsInProcess;
+extern int CC1FatalErrorStatus;
+extern bool runCC1OnServer(ArrayRef<const char *> Argv, int &Result,
+                           std::string *ErrMsg);
 
 static void insertTargetAndModeArgs(StringRef Target, StringRef Mode,
                                     SmallVectorImpl<const char *> &ArgVector,
@@ -299,12 +306,43 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
     return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP);
   if (Tool == "as")
     return cc1as_main(argv.slice(2), argv[0], GetExecutablePathVP);
+  if (Tool == "server")
+    return cc1server_main(argv.slice(2), argv[0], GetExecutablePathVP);
 
   // Reject unknown tools.
   llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
   return 1;
 }
 
+/// The argv[0] of the driver, for the -cc1 jobs run in its process.
+static const char *InProcessArgv0;
+
+/// Runs a clang -cc1 job in the driver's own process, for -fintegrated-cc1.
+static bool runCC1InProcess(ArrayRef<const char *> Argv, int &Result,
+                            std::string *ErrMsg) {
+  SmallVector<const char *, 256> CC1Argv;
+  CC1Argv.push_back(InProcessArgv0);
+  CC1Argv.append(Argv.begin(), Argv.end());
+
+  // Every job parses its own -mllvm options.
+  llvm::cl::ResetAllOptionOccurrences();
+
+  // Report a crash like that of a child process, so that the driver still
+  // generates the crash reproducer. A fatal error gives the status the job
+  // would have exited with instead.
+  llvm::CrashRecoveryContext CRC;
+  Result = 1;
+  CC1RunsInProcess = true;
+  CC1FatalErrorStatus = 0;
+  if (!CRC.RunSafely([&] { Result = ExecuteCC1Tool(CC1Argv, ""); })) {
+    Result = CC1FatalErrorStatus ? CC1FatalErrorStatus : -2;
+    // The job never got to uninstall its handler.
+    llvm::remove_fatal_error_handler();
+  }
+  CC1RunsInProcess = false;
+  return true;
+}
+
 int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal(argv_[0]);
   llvm::PrettyStackTraceProgram X(argc_, argv_);
@@ -391,6 +429,17 @@ int main(int argc_, const char **argv_) {
     }
   }
 
+  // The last of -fintegrated-cc1 and -fno-integrated-cc1 wins.
+  bool IntegratedCC1 = false;
+  for (int i = 1, size = argv.size(); i < size; ++i) {
+    if (argv[i] == nullptr)
+      continue;
+    if (StringRef(argv[i]) == "-fintegrated-cc1")
+      IntegratedCC1 = true;
+    else if (StringRef(argv[i]) == "-fno-integrated-cc1")
+      IntegratedCC1 = false;
+  }
+
   // Handle CL and _CL_ which permits additional command line options to be
   // prepended or appended.
   if (ClangCLMode) {
@@ -453,6 +502,19 @@ int main(int argc_, const char **argv_) {
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
 
+  // Hand -cc1 jobs to a running clang -cc1server, if there is one, or run
+  // them in this process with -fintegrated-cc1.
+  if (IntegratedCC1) {
+    InProcessArgv0 = argv[0];
+    llvm::CrashRecoveryContext::Enable();
+    TheDriver.CC1Runner = runCC1InProcess;
+    TheDriver.CC1RunnerName = "in-process";
+  } else if (::getenv("CLANG_CC1_SERVER")) {
+    TheDriver.CC1Runner = runCC1OnServer;
+    TheDriver.CC1RunnerIsThreadSafe = true;
+    TheDriver.CC1RunnerName = "on the cc1 server";
+  }
+
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
   int Res = 0;
   SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
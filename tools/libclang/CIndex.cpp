@@ -39,6 +39,7 @@
 #include "clang/Serialization/SerializationDiagnostic.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Compiler.h"
@@ -79,6 +80,7 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx, ASTUnit *AU) {
   D->Diagnostics = nullptr;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
   D->CommentToXML = nullptr;
+  D->CGNameGen = nullptr;
   return D;
 }
 
@@ -238,6 +240,18 @@ static bool visitPreprocessedEntitiesInRange(SourceRange R,
       FID = FileID();
   }
 
+  // The entities of a local file are found by their offsets, without
+  // comparing locations across the translation unit.
+  if (FID.isValid() && SM.isLocalFileID(FID)) {
+    unsigned BeginOffset = SM.getFileOffset(SM.getFileLoc(R.getBegin()));
+    unsigned EndOffset = SM.getFileOffset(SM.getFileLoc(R.getEnd()));
+    for (const auto &Info :
+         PPRec.getLocalPreprocessedEntitiesInFile(FID, BeginOffset, EndOffset))
+      if (Visitor.visitPreprocessedEntity(Info.Entity))
+        return true;
+    return false;
+  }
+
   const auto &Entities = PPRec.getPreprocessedEntitiesInRange(R);
   return Visitor.visitPreprocessedEntities(Entities.begin(), Entities.end(),
                                            PPRec, FID);
@@ -445,31 +459,25 @@ bool CursorVisitor::visitPreprocessedEntities(InputIterator First,
     if (!FID.isInvalid() && !PPRec.isEntityInFileID(First, FID))
       continue;
 
-    PreprocessedEntity *PPE = *First;
-    if (!PPE)
-      continue;
+    if (visitPreprocessedEntity(*First))
+      return true;
+  }
 
-    if (MacroExpansion *ME = dyn_cast<MacroExpansion>(PPE)) {
-      if (Visit(MakeMacroExpansionCursor(ME, TU)))
-        return true;
+  return false;
+}
 
-      continue;
-    }
+bool CursorVisitor::visitPreprocessedEntity(PreprocessedEntity *PPE) {
+  if (!PPE)
+    return false;
 
-    if (MacroDefinitionRecord *MD = dyn_cast<MacroDefinitionRecord>(PPE)) {
-      if (Visit(MakeMacroDefinitionCursor(MD, TU)))
-        return true;
+  if (MacroExpansion *ME = dyn_cast<MacroExpansion>(PPE))
+    return Visit(MakeMacroExpansionCursor(ME, TU));
 
-      continue;
-    }
-    
-    if (InclusionDirective *ID = dyn_cast<InclusionDirective>(PPE)) {
-      if (Visit(MakeInclusionDirectiveCursor(ID, TU)))
-        return true;
-      
-      continue;
-    }
-  }
+  if (MacroDefinitionRecord *MD = dyn_cast<MacroDefinitionRecord>(PPE))
+    return Visit(MakeMacroDefinitionCursor(MD, TU));
+
+  if (InclusionDirective *ID = dyn_cast<InclusionDirective>(PPE))
+    return Visit(MakeInclusionDirectiveCursor(ID, TU));
 
   return false;
 }
@@ -3352,6 +3360,8 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
     = options & CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   bool SkipFunctionBodies = options & CXTranslationUnit_SkipFunctionBodies;
   bool ForSerialization = options & CXTranslationUnit_ForSerialization;
+  bool StorePreamblesInMemory =
+      options & CXTranslationUnit_StorePreamblesInMemory;
 
   // Configure the diagnostics.
   IntrusiveRefCntPtr<DiagnosticsEngine>
@@ -3413,10 +3423,15 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
     Args->push_back(source_filename);
 
   // Do we need the detailed preprocessing record?
-  if (options & CXTranslationUnit_DetailedPreprocessingRecord) {
+  if (options & (CXTranslationUnit_DetailedPreprocessingRecord |
+                 CXTranslationUnit_DetailedPreprocessingRecordMainFileOnly)) {
     Args->push_back("-Xclang");
     Args->push_back("-detailed-preprocessing-record");
   }
+  if (options & CXTranslationUnit_DetailedPreprocessingRecordMainFileOnly) {
+    Args->push_back("-Xclang");
+    Args->push_back("-detailed-preprocessing-record-main-file-only");
+  }
   
   unsigned NumErrors = Diags->getClient()->getNumErrors();
   std::unique_ptr<ASTUnit> ErrUnit;
@@ -3435,7 +3450,7 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies,
       /*UserFilesAreVolatile=*/true, ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, StorePreamblesInMemory, CXXIdx->getSharedFileContents()));
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -3956,6 +3971,7 @@ void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
     delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
     disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
     delete CTUnit->CommentToXML;
+    delete CTUnit->CGNameGen;
     delete CTUnit;
   }
 }
@@ -3978,6 +3994,10 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   delete static_cast<CXDiagnosticSetImpl*>(TU->Diagnostics);
   TU->Diagnostics = nullptr;
 
+  // Forget the mangled names of the declarations being replaced.
+  delete TU->CGNameGen;
+  TU->CGNameGen = nullptr;
+
   CIndexer *CXXIdx = TU->CIdx;
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
     setThreadBackgroundPriority();
@@ -4255,6 +4275,73 @@ unsigned clang_visitChildrenWithBlock(CXCursor parent,
   return clang_visitChildren(parent, visitWithBlock, block);
 }
 
+namespace {
+struct BatchedVisitData {
+  CXCursorRecord *Records;
+  CXCursor *Cursors;
+  unsigned NumRecords;
+  bool IncludeUSRs;
+
+  /// \brief The number of cursors found so far.
+  unsigned Count = 0;
+  /// \brief The cursors enclosing the current one, with their record index.
+  SmallVector<std::pair<CXCursor, unsigned>, 16> Ancestors;
+  llvm::StringMap<unsigned> USRs;
+};
+} // end anonymous namespace
+
+static enum CXChildVisitResult visitBatched(CXCursor cursor, CXCursor parent,
+                                            CXClientData client_data) {
+  BatchedVisitData &Data = *static_cast<BatchedVisitData *>(client_data);
+  unsigned Index = Data.Count++;
+
+  // The visit is depth-first, so the parent is one of the ancestors of the
+  // previous cursor.
+  while (!Data.Ancestors.empty() &&
+         !clang_equalCursors(Data.Ancestors.back().first, parent))
+    Data.Ancestors.pop_back();
+  unsigned ParentIndex =
+      Data.Ancestors.empty() ? ~0U : Data.Ancestors.back().second;
+  Data.Ancestors.push_back(std::make_pair(cursor, Index));
+
+  if (Index >= Data.NumRecords)
+    return CXChildVisit_Recurse;
+
+  CXCursorRecord &Record = Data.Records[Index];
+  Record.kind = cursor.kind;
+  Record.parent = ParentIndex;
+  Record.usr = ~0U;
+  if (Data.IncludeUSRs) {
+    CXString USR = clang_getCursorUSR(cursor);
+    StringRef USRStr = clang_getCString(USR);
+    if (!USRStr.empty())
+      Record.usr = Data.USRs.insert(std::make_pair(USRStr, Index)).first->second;
+    clang_disposeString(USR);
+  }
+  CXSourceRange Extent = clang_getCursorExtent(cursor);
+  clang_getFileLocation(clang_getRangeStart(Extent), &Record.file, nullptr,
+                        nullptr, &Record.start_offset);
+  clang_getFileLocation(clang_getRangeEnd(Extent), nullptr, nullptr, nullptr,
+                        &Record.end_offset);
+  if (Data.Cursors)
+    Data.Cursors[Index] = cursor;
+  return CXChildVisit_Recurse;
+}
+
+unsigned clang_visitChildrenBatched(CXCursor parent, CXCursorRecord *records,
+                                    CXCursor *cursors, unsigned num_records,
+                                    unsigned options) {
+  if (!records)
+    num_records = 0;
+  BatchedVisitData Data;
+  Data.Records = records;
+  Data.Cursors = cursors;
+  Data.NumRecords = num_records;
+  Data.IncludeUSRs = options & CXCursorRecord_IncludeUSRs;
+  clang_visitChildren(parent, visitBatched, &Data);
+  return Data.Count;
+}
+
 static CXString getDeclSpelling(const Decl *D) {
   if (!D)
     return cxstring::createEmpty();
@@ -4548,6 +4635,16 @@ CXSourceRange clang_Cursor_getSpellingNameRange(CXCursor C,
   return cxloc::translateSourceRange(Ctx, Loc);
 }
 
+/// \brief Returns the translation unit's name generator, creating it on first
+/// use, so that the names it has produced are remembered across calls.
+static index::CodegenNameGenerator &getCodegenNameGenerator(CXCursor C) {
+  CXTranslationUnit TU = getCursorTU(C);
+  if (!TU->CGNameGen)
+    TU->CGNameGen =
+        new index::CodegenNameGenerator(cxtu::getASTUnit(TU)->getASTContext());
+  return *TU->CGNameGen;
+}
+
 CXString clang_Cursor_getMangling(CXCursor C) {
   if (clang_isInvalid(C.kind) || !clang_isDeclaration(C.kind))
     return cxstring::createEmpty();
@@ -4557,9 +4654,7 @@ CXString clang_Cursor_getMangling(CXCursor C) {
   if (!D || !(isa<FunctionDecl>(D) || isa<VarDecl>(D)))
     return cxstring::createEmpty();
 
-  ASTContext &Ctx = D->getASTContext();
-  index::CodegenNameGenerator CGNameGen(Ctx);
-  return cxstring::createDup(CGNameGen.getName(D));
+  return cxstring::createDup(getCodegenNameGenerator(C).getName(D));
 }
 
 CXStringSet *clang_Cursor_getCXXManglings(CXCursor C) {
@@ -4570,9 +4665,8 @@ CXStringSet *clang_Cursor_getCXXManglings(CXCursor C) {
   if (!(isa<CXXRecordDecl>(D) || isa<CXXMethodDecl>(D)))
     return nullptr;
 
-  ASTContext &Ctx = D->getASTContext();
-  index::CodegenNameGenerator CGNameGen(Ctx);
-  std::vector<std::string> Manglings = CGNameGen.getAllManglings(D);
+  std::vector<std::string> Manglings =
+      getCodegenNameGenerator(C).getAllManglings(D);
   return cxstring::createSet(Manglings);
 }
 
@@ -7055,6 +7149,80 @@ void clang_annotateTokens(CXTranslationUnit TU,
   }
 }
 
+unsigned clang_getSemanticTokens(CXTranslationUnit TU, CXFile file,
+                                 unsigned begin_offset, unsigned end_offset,
+                                 CXSemanticToken **tokens) {
+  if (tokens)
+    *tokens = nullptr;
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return 0;
+  }
+  if (!file || !tokens || begin_offset >= end_offset)
+    return 0;
+
+  LOG_FUNC_SECTION {
+    *Log << TU << ' ' << static_cast<const FileEntry *>(file)->getName()
+         << ' ' << begin_offset << '-' << end_offset;
+  }
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  if (!CXXUnit)
+    return 0;
+
+  ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+
+  const FileEntry *File = static_cast<const FileEntry *>(file);
+  SourceLocation Begin = CXXUnit->getLocation(File, begin_offset);
+  SourceLocation End = CXXUnit->getLocation(File, end_offset);
+  if (Begin.isInvalid() || End.isInvalid())
+    return 0;
+
+  SmallVector<CXToken, 32> CXTokens;
+  getTokens(CXXUnit, SourceRange(Begin, End), CXTokens);
+  if (CXTokens.empty())
+    return 0;
+
+  std::vector<CXCursor> Cursors(CXTokens.size(), clang_getNullCursor());
+  auto AnnotateTokensImpl = [&]() {
+    clang_annotateTokensImpl(TU, CXXUnit, CXTokens.data(), CXTokens.size(),
+                             Cursors.data());
+  };
+  llvm::CrashRecoveryContext CRC;
+  if (!RunSafely(CRC, AnnotateTokensImpl, GetSafetyThreadStackSize() * 2)) {
+    fprintf(stderr, "libclang: crash detected while annotating tokens\n");
+    return 0;
+  }
+
+  SourceManager &SM = CXXUnit->getSourceManager();
+  CXSemanticToken *Result = static_cast<CXSemanticToken *>(
+      malloc(sizeof(CXSemanticToken) * CXTokens.size()));
+  CXCursorKind ReferencedKind = CXCursor_InvalidFile;
+  for (unsigned I = 0, N = CXTokens.size(); I != N; ++I) {
+    const CXCursor &C = Cursors[I];
+    // Tokens of the same entity tend to come in runs, e.g. for a qualified
+    // name, so only look up the referenced cursor when the cursor changes.
+    if (I == 0 || !clang_equalCursors(C, Cursors[I - 1]))
+      ReferencedKind = clang_Cursor_isNull(C)
+                           ? CXCursor_InvalidFile
+                           : clang_getCursorReferenced(C).kind;
+
+    CXSemanticToken &Tok = Result[I];
+    Tok.token_kind = static_cast<CXTokenKind>(CXTokens[I].int_data[0]);
+    Tok.cursor_kind = C.kind;
+    Tok.referenced_kind = ReferencedKind;
+    Tok.offset = SM.getFileOffset(
+        SourceLocation::getFromRawEncoding(CXTokens[I].int_data[1]));
+    Tok.length = CXTokens[I].int_data[2];
+  }
+  *tokens = Result;
+  return CXTokens.size();
+}
+
+void clang_disposeSemanticTokens(CXSemanticToken *tokens) {
+  free(tokens);
+}
+
 //===----------------------------------------------------------------------===//
 // Operations for querying linkage of a cursor.
 //===----------------------------------------------------------------------===//
@@ -7795,6 +7963,12 @@ const char *clang_getTUResourceUsageName(CXTUResourceUsageKind kind) {
     case CXTUResourceUsage_Preprocessor_HeaderSearch:
       str = "Preprocessor: header search tables";
       break;
+    case CXTUResourceUsage_StoredDiagnostics:
+      str = "ASTUnit: stored diagnostics";
+      break;
+    case CXTUResourceUsage_GlobalCompletionResultsIndex:
+      str = "Code completion: cached global result index";
+      break;
   }
   return str;
 }
@@ -7835,6 +8009,14 @@ CXTUResourceUsage clang_getCXTUResourceUsage(CXTranslationUnit TU) {
   createCXTUResourceUsageEntry(*entries,
                                CXTUResourceUsage_GlobalCompletionResults,
                                completionBytes);
+  createCXTUResourceUsageEntry(
+      *entries, CXTUResourceUsage_GlobalCompletionResultsIndex,
+      (unsigned long)(astUnit->cached_completion_size() *
+                      sizeof(ASTUnit::CachedCodeCompletionResult)));
+
+  // How much memory is used by the diagnostics kept for the client?
+  createCXTUResourceUsageEntry(*entries, CXTUResourceUsage_StoredDiagnostics,
+    (unsigned long) astUnit->getStoredDiagnosticsMemory());
   
   // How much memory is being used by SourceManager's content cache?
   createCXTUResourceUsageEntry(*entries,
@@ -7897,6 +8079,24 @@ void clang_disposeCXTUResourceUsage(CXTUResourceUsage usage) {
     delete (MemUsageEntries*) usage.data;
 }
 
+unsigned long clang_trimTranslationUnitMemory(CXTranslationUnit TU,
+                                              unsigned options) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return 0;
+  }
+
+  ASTUnit *astUnit = cxtu::getASTUnit(TU);
+  ASTUnit::ConcurrencyCheck Check(*astUnit);
+
+  bool clearDiagnostics = options & CXTrimMemory_Diagnostics;
+  if (clearDiagnostics) {
+    delete static_cast<CXDiagnosticSetImpl*>(TU->Diagnostics);
+    TU->Diagnostics = nullptr;
+  }
+  return (unsigned long) astUnit->trimMemory(clearDiagnostics);
+}
+
 CXSourceRangeList *clang_getSkippedRanges(CXTranslationUnit TU, CXFile file) {
   CXSourceRangeList *skipped = new CXSourceRangeList;
   skipped->count = 0;
@@ -21,6 +21,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/Type.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/ASTUnit.h"
@@ -36,6 +37,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
 #include <cstdlib>
@@ -642,6 +644,47 @@ namespace {
   };
 }
 
+/// \brief Returns the identifier characters right before the given location.
+static std::string getTypedPrefix(ASTUnit &AST, StringRef Filename,
+                                  unsigned Line, unsigned Column,
+                                  ArrayRef<CXUnsavedFile> UnsavedFiles) {
+  StringRef Contents;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  auto Unsaved = std::find_if(UnsavedFiles.begin(), UnsavedFiles.end(),
+                              [&](const CXUnsavedFile &UF) {
+                                return Filename == UF.Filename;
+                              });
+  if (Unsaved != UnsavedFiles.end()) {
+    Contents = getContents(*Unsaved);
+  } else {
+    auto BufferOrErr = AST.getFileManager().getBufferForFile(Filename);
+    if (!BufferOrErr)
+      return std::string();
+    Buffer = std::move(*BufferOrErr);
+    Contents = Buffer->getBuffer();
+  }
+
+  // Find the offset of the location; lines and columns are 1-based.
+  size_t Offset = 0;
+  for (unsigned L = 1; L < Line && Offset != StringRef::npos; ++L) {
+    Offset = Contents.find('\n', Offset);
+    if (Offset != StringRef::npos)
+      ++Offset;
+  }
+  if (Offset == StringRef::npos || Column == 0 ||
+      Offset + Column - 1 > Contents.size())
+    return std::string();
+  size_t End = Offset + Column - 1;
+
+  size_t Begin = End;
+  while (Begin > Offset && isIdentifierBody(Contents[Begin - 1]))
+    --Begin;
+  // Don't treat the tail of a number as a name.
+  while (Begin != End && isDigit(Contents[Begin]))
+    ++Begin;
+  return Contents.slice(Begin, End);
+}
+
 static CXCodeCompleteResults *
 clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                           unsigned complete_line, unsigned complete_column,
@@ -685,6 +728,14 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
     // FIXME: Add logging.
   }
 
+  // Complete at the start of the identifier being typed, and filter by it.
+  std::string Filter;
+  if (options & CXCodeComplete_FilterByTypedPrefix) {
+    Filter = getTypedPrefix(*AST, complete_filename, complete_line,
+                            complete_column, unsaved_files);
+    complete_column -= Filter.size();
+  }
+
   // Parse the resulting source file to find code-completion results.
   AllocatedCXCodeCompleteResults *Results = new AllocatedCXCodeCompleteResults(
       &AST->getFileManager());
@@ -694,6 +745,7 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   // Create a code-completion consumer to capture the results.
   CodeCompleteOptions Opts;
   Opts.IncludeBriefComments = IncludeBriefComments;
+  Opts.Filter = Filter;
   CaptureCompletionResults Capture(Opts, *Results, &TU);
 
   // Perform completion.
@@ -16,6 +16,7 @@
 #define LLVM_CLANG_TOOLS_LIBCLANG_CINDEXER_H
 
 #include "clang-c/Index.h"
+#include "clang/Basic/FileManager.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "llvm/ADT/STLExtras.h"
 #include <utility>
@@ -39,13 +40,14 @@ class CIndexer {
 
   std::string ResourcesPath;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
+  std::shared_ptr<SharedFileContents> FileContents;
 
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
       : OnlyLocalDecls(false), DisplayDiagnostics(false),
-        Options(CXGlobalOpt_None), PCHContainerOps(std::move(PCHContainerOps)) {
-  }
+        Options(CXGlobalOpt_None), PCHContainerOps(std::move(PCHContainerOps)),
+        FileContents(std::make_shared<SharedFileContents>()) {}
 
   /// \brief Whether we only want to see "local" declarations (that did not
   /// come from a previous precompiled header). If false, we want to see all
@@ -62,6 +64,12 @@ public:
     return PCHContainerOps;
   }
 
+  /// \brief The contents of the files read by the translation units of this
+  /// index, shared between them.
+  std::shared_ptr<SharedFileContents> getSharedFileContents() const {
+    return FileContents;
+  }
+
   unsigned getCXGlobalOptFlags() const { return Options; }
   void setCXGlobalOptFlags(unsigned options) { Options = options; }
 
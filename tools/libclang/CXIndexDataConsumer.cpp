@@ -1185,15 +1185,8 @@ void CXIndexDataConsumer::getEntityInfo(const NamedDecl *D,
     EntityInfo.name = SA.copyCStr(StrBuf.str());
   }
 
-  {
-    SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
-    if (Ignore) {
-      EntityInfo.USR = nullptr;
-    } else {
-      EntityInfo.USR = SA.copyCStr(StrBuf.str());
-    }
-  }
+  StringRef USR = USRs.getUSR(D);
+  EntityInfo.USR = USR.empty() ? nullptr : USR.data();
 }
 
 void CXIndexDataConsumer::getContainerInfo(const DeclContext *DC,
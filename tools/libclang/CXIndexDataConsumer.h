@@ -13,9 +13,11 @@
 #include "CXCursor.h"
 #include "Index_Internal.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/AST/DeclObjC.h"
 #include "llvm/ADT/DenseSet.h"
+#include <functional>
 
 namespace clang {
   class FileEntry;
@@ -292,10 +294,15 @@ class CXIndexDataConsumer : public index::IndexDataConsumer {
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
+  /// \brief The entity USRs, generated once per declaration.
+  index::USRCache USRs;
+
   llvm::BumpPtrAllocator StrScratch;
   unsigned StrAdapterCount;
   friend class ScratchAlloc;
 
+  std::function<bool(FileID)> FileFilter;
+
   struct ObjCProtocolListInfo {
     SmallVector<CXIdxObjCProtocolRefInfo, 4> ProtInfos;
     SmallVector<EntityInfo, 4> ProtEntities;
@@ -344,6 +351,12 @@ public:
   void setASTContext(ASTContext &ctx);
   void setPreprocessor(Preprocessor &PP);
 
+  /// \brief Only index the top-level declarations of the files for which
+  /// \p Filter returns true.
+  void setFileFilter(std::function<bool(FileID)> Filter) {
+    FileFilter = std::move(Filter);
+  }
+
   bool shouldSuppressRefs() const {
     return IndexOptions & CXIndexOpt_SuppressRedundantRefs;
   }
@@ -472,6 +485,10 @@ private:
 
   void finish() override;
 
+  bool shouldIndexFile(FileID FID) override {
+    return !FileFilter || FileFilter(FID);
+  }
+
   bool handleDecl(const NamedDecl *D,
                   SourceLocation Loc, CXCursor Cursor,
                   DeclInfo &DInfo,
@@ -22,6 +22,7 @@ namespace clang {
   class ASTUnit;
   class CIndexer;
 namespace index {
+class CodegenNameGenerator;
 class CommentToXMLConverter;
 } // namespace index
 } // namespace clang
@@ -33,6 +34,7 @@ struct CXTranslationUnitImpl {
   void *Diagnostics;
   void *OverridenCursorsPool;
   clang::index::CommentToXMLConverter *CommentToXML;
+  clang::index::CodegenNameGenerator *CGNameGen;
 };
 
 namespace clang {
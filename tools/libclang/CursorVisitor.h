@@ -17,6 +17,7 @@
 #include "clang/AST/TypeLocVisitor.h"
 
 namespace clang {
+  class PreprocessedEntity;
   class PreprocessingRecord;
   class ASTUnit;
 
@@ -192,6 +193,9 @@ public:
                                  PreprocessingRecord &PPRec,
                                  FileID FID = FileID());
 
+  /// \brief Visits the cursor for \p PPE, if it has one.
+  bool visitPreprocessedEntity(PreprocessedEntity *PPE);
+
   bool VisitChildren(CXCursor Parent);
 
   // Declaration visitors
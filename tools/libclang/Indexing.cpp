@@ -16,6 +16,7 @@
 #include "CXString.h"
 #include "CXTranslationUnit.h"
 #include "clang/AST/ASTConsumer.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
@@ -27,11 +28,17 @@
 #include "clang/Lex/PPConditionalDirectiveRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include <atomic>
 #include <cstdio>
+#include <set>
+#include <thread>
+#include <tuple>
 #include <utility>
 
 using namespace clang;
@@ -218,6 +225,79 @@ private:
   }
 };
 
+/// \brief A header whose declarations were indexed, identified by its
+/// unique ID, its modification time and the hash of the predefined macros of
+/// the translation unit that included it.
+typedef std::tuple<uint64_t, uint64_t, time_t, unsigned> IndexedFileKey;
+
+class SessionSkipFileData {
+  llvm::sys::Mutex Mux;
+  std::set<IndexedFileKey> IndexedFiles;
+
+public:
+  SessionSkipFileData() : Mux(/*recursive=*/false) {}
+
+  void copyTo(std::set<IndexedFileKey> &Set) {
+    llvm::MutexGuard MG(Mux);
+    Set = IndexedFiles;
+  }
+
+  void update(ArrayRef<IndexedFileKey> Files) {
+    llvm::MutexGuard MG(Mux);
+    IndexedFiles.insert(Files.begin(), Files.end());
+  }
+};
+
+class TUSkipFileControl {
+  SessionSkipFileData &SessionData;
+  Preprocessor &PP;
+  unsigned MacroContext;
+
+  std::set<IndexedFileKey> IndexedFiles;
+  llvm::DenseMap<FileID, bool> ShouldIndex;
+
+public:
+  TUSkipFileControl(SessionSkipFileData &sessionData, Preprocessor &pp)
+      : SessionData(sessionData), PP(pp),
+        MacroContext(llvm::hash_value(pp.getPredefines())) {
+    SessionData.copyTo(IndexedFiles);
+  }
+
+  bool shouldIndexFile(FileID FID) {
+    auto Known = ShouldIndex.find(FID);
+    if (Known != ShouldIndex.end())
+      return Known->second;
+
+    const SourceManager &SM = PP.getSourceManager();
+    const FileEntry *FE = SM.getFileEntryForID(FID);
+    bool Result = FID == SM.getMainFileID() || !FE ||
+                  !IndexedFiles.count(getKey(FE));
+    ShouldIndex[FID] = Result;
+    return Result;
+  }
+
+  /// \brief Records the guarded headers of the translation unit as indexed.
+  void finished() {
+    const SourceManager &SM = PP.getSourceManager();
+    const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+    SmallVector<IndexedFileKey, 32> NewIndexedFiles;
+    for (auto I = SM.fileinfo_begin(), E = SM.fileinfo_end(); I != E; ++I) {
+      const FileEntry *FE = I->first;
+      if (FE != MainFile &&
+          PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE))
+        NewIndexedFiles.push_back(getKey(FE));
+    }
+    SessionData.update(NewIndexedFiles);
+  }
+
+private:
+  IndexedFileKey getKey(const FileEntry *FE) const {
+    const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+    return IndexedFileKey(ID.getDevice(), ID.getFile(),
+                          FE->getModificationTime(), MacroContext);
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // IndexPPCallbacks
 //===----------------------------------------------------------------------===//
@@ -281,10 +361,12 @@ public:
 class IndexingConsumer : public ASTConsumer {
   CXIndexDataConsumer &DataConsumer;
   TUSkipBodyControl *SKCtrl;
+  TUSkipFileControl *SFCtrl;
 
 public:
-  IndexingConsumer(CXIndexDataConsumer &dataConsumer, TUSkipBodyControl *skCtrl)
-    : DataConsumer(dataConsumer), SKCtrl(skCtrl) { }
+  IndexingConsumer(CXIndexDataConsumer &dataConsumer, TUSkipBodyControl *skCtrl,
+                   TUSkipFileControl *sfCtrl)
+    : DataConsumer(dataConsumer), SKCtrl(skCtrl), SFCtrl(sfCtrl) { }
 
   // ASTConsumer Implementation
 
@@ -296,6 +378,8 @@ public:
   void HandleTranslationUnit(ASTContext &Ctx) override {
     if (SKCtrl)
       SKCtrl->finished();
+    if (SFCtrl)
+      SFCtrl->finished();
   }
 
   bool HandleTopLevelDecl(DeclGroupRef DG) override {
@@ -353,11 +437,14 @@ class IndexingFrontendAction : public ASTFrontendAction {
 
   SessionSkipBodyData *SKData;
   std::unique_ptr<TUSkipBodyControl> SKCtrl;
+  SessionSkipFileData *SFData;
+  std::unique_ptr<TUSkipFileControl> SFCtrl;
 
 public:
   IndexingFrontendAction(std::shared_ptr<CXIndexDataConsumer> dataConsumer,
-                         SessionSkipBodyData *skData)
-      : DataConsumer(std::move(dataConsumer)), SKData(skData) {}
+                         SessionSkipBodyData *skData,
+                         SessionSkipFileData *sfData)
+      : DataConsumer(std::move(dataConsumer)), SKData(skData), SFData(sfData) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override {
@@ -379,7 +466,15 @@ public:
       SKCtrl = llvm::make_unique<TUSkipBodyControl>(*SKData, *PPRec, PP);
     }
 
-    return llvm::make_unique<IndexingConsumer>(*DataConsumer, SKCtrl.get());
+    if (SFData) {
+      SFCtrl = llvm::make_unique<TUSkipFileControl>(*SFData, PP);
+      TUSkipFileControl *Ctrl = SFCtrl.get();
+      DataConsumer->setFileFilter(
+          [Ctrl](FileID FID) { return Ctrl->shouldIndexFile(FID); });
+    }
+
+    return llvm::make_unique<IndexingConsumer>(*DataConsumer, SKCtrl.get(),
+                                               SFCtrl.get());
   }
 
   TranslationUnitKind getTranslationUnitKind() override {
@@ -405,9 +500,11 @@ static IndexingOptions getIndexingOptionsFromCXOptions(unsigned index_options) {
 struct IndexSessionData {
   CXIndex CIdx;
   std::unique_ptr<SessionSkipBodyData> SkipBodyData;
+  std::unique_ptr<SessionSkipFileData> SkipFileData;
 
   explicit IndexSessionData(CXIndex cIdx)
-    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
+    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData),
+      SkipFileData(new SessionSkipFileData) {}
 };
 
 } // anonymous namespace
@@ -418,7 +515,7 @@ static CXErrorCode clang_indexSourceFile_Impl(
     unsigned index_options, const char *source_filename,
     const char *const *command_line_args, int num_command_line_args,
     ArrayRef<CXUnsavedFile> unsaved_files, CXTranslationUnit *out_TU,
-    unsigned TU_options) {
+    unsigned TU_options, std::shared_ptr<SharedStatResults> StatCache) {
   if (out_TU)
     *out_TU = nullptr;
   bool requestedToGetTU = (out_TU != nullptr);
@@ -518,11 +615,18 @@ static CXErrorCode clang_indexSourceFile_Impl(
   CInvok->getHeaderSearchOpts().ModuleFormat =
     CXXIdx->getPCHContainerOperations()->getRawReader().getFormat();
 
+  CInvok->getFileSystemOpts().SharedContents = CXXIdx->getSharedFileContents();
+
   ASTUnit *Unit = ASTUnit::create(CInvok.get(), Diags, CaptureDiagnostics,
                                   /*UserFilesAreVolatile=*/true);
   if (!Unit)
     return CXError_InvalidArguments;
 
+  // The shared stat results are only valid for the real file system.
+  if (StatCache && CInvok->getHeaderSearchOpts().VFSOverlayFiles.empty())
+    Unit->getFileManager().addStatCache(
+        llvm::make_unique<SharedStatCache>(StatCache));
+
   std::unique_ptr<CXTUOwner> CXTU(
       new CXTUOwner(MakeCXTranslationUnit(CXXIdx, Unit)));
 
@@ -540,8 +644,10 @@ static CXErrorCode clang_indexSourceFile_Impl(
   auto DataConsumer =
     std::make_shared<CXIndexDataConsumer>(client_data, CB, index_options,
                                           CXTU->getTU());
+  bool SkipFiles = index_options & CXIndexOpt_SkipIndexedFilesInSession;
   auto InterAction = llvm::make_unique<IndexingFrontendAction>(DataConsumer,
-                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr);
+                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr,
+                         SkipFiles ? IdxSession->SkipFileData.get() : nullptr);
   std::unique_ptr<FrontendAction> IndexAction;
   IndexAction = createIndexingAction(DataConsumer,
                                 getIndexingOptionsFromCXOptions(index_options),
@@ -572,6 +678,10 @@ static CXErrorCode clang_indexSourceFile_Impl(
   if (TU_options & CXTranslationUnit_DetailedPreprocessingRecord) {
     PPOpts.DetailedRecord = true;
   }
+  if (TU_options & CXTranslationUnit_DetailedPreprocessingRecordMainFileOnly) {
+    PPOpts.DetailedRecord = true;
+    PPOpts.DetailedRecordMainFileOnly = true;
+  }
 
   if (!requestedToGetTU && !CInvok->getLangOpts()->Modules)
     PPOpts.DetailedRecord = false;
@@ -849,13 +959,14 @@ int clang_indexSourceFile(CXIndexAction idxAction,
       num_unsaved_files, out_TU, TU_options);
 }
 
-int clang_indexSourceFileFullArgv(
+static int indexSourceFileSafely(
     CXIndexAction idxAction, CXClientData client_data,
     IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
     unsigned index_options, const char *source_filename,
     const char *const *command_line_args, int num_command_line_args,
     struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
-    CXTranslationUnit *out_TU, unsigned TU_options) {
+    CXTranslationUnit *out_TU, unsigned TU_options,
+    std::shared_ptr<SharedStatResults> StatCache) {
   LOG_FUNC_SECTION {
     *Log << source_filename << ": ";
     for (int i = 0; i != num_command_line_args; ++i)
@@ -872,7 +983,7 @@ int clang_indexSourceFileFullArgv(
         index_options, source_filename, command_line_args,
         num_command_line_args,
         llvm::makeArrayRef(unsaved_files, num_unsaved_files), out_TU,
-        TU_options);
+        TU_options, StatCache);
   };
 
   if (getenv("LIBCLANG_NOTHREADS")) {
@@ -912,6 +1023,62 @@ int clang_indexSourceFileFullArgv(
   return result;
 }
 
+int clang_indexSourceFileFullArgv(
+    CXIndexAction idxAction, CXClientData client_data,
+    IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
+    unsigned index_options, const char *source_filename,
+    const char *const *command_line_args, int num_command_line_args,
+    struct CXUnsavedFile *unsaved_files, unsigned num_unsaved_files,
+    CXTranslationUnit *out_TU, unsigned TU_options) {
+  return indexSourceFileSafely(
+      idxAction, client_data, index_callbacks, index_callbacks_size,
+      index_options, source_filename, command_line_args, num_command_line_args,
+      unsaved_files, num_unsaved_files, out_TU, TU_options,
+      /*StatCache=*/nullptr);
+}
+
+int clang_indexSourceFiles(CXIndexAction idxAction, CXClientData *client_data,
+                           unsigned num_threads,
+                           IndexerCallbacks *index_callbacks,
+                           unsigned index_callbacks_size,
+                           unsigned index_options,
+                           const CXIndexSourceFile *source_files,
+                           unsigned num_source_files, unsigned TU_options,
+                           int *results) {
+  LOG_FUNC_SECTION {
+    *Log << num_source_files << " files on " << num_threads << " threads";
+  }
+
+  if (!idxAction || !client_data || num_threads == 0 ||
+      (num_source_files && !source_files))
+    return CXError_InvalidArguments;
+
+  auto StatCache = std::make_shared<SharedStatResults>();
+  std::atomic<unsigned> NextFile(0);
+  auto IndexFiles = [&](CXClientData ThreadClientData) {
+    for (unsigned I = NextFile++; I < num_source_files; I = NextFile++) {
+      const CXIndexSourceFile &File = source_files[I];
+      int Result = indexSourceFileSafely(
+          idxAction, ThreadClientData, index_callbacks, index_callbacks_size,
+          index_options, File.source_filename, File.command_line_args,
+          File.num_command_line_args, File.unsaved_files,
+          File.num_unsaved_files, /*out_TU=*/nullptr, TU_options, StatCache);
+      if (results)
+        results[I] = Result;
+    }
+  };
+
+  // The calling thread indexes too, with the first client data.
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1; I < num_threads; ++I)
+    Threads.emplace_back(IndexFiles, client_data[I]);
+  IndexFiles(client_data[0]);
+  for (std::thread &T : Threads)
+    T.join();
+
+  return CXError_Success;
+}
+
 int clang_indexTranslationUnit(CXIndexAction idxAction,
                                CXClientData client_data,
                                IndexerCallbacks *index_callbacks,
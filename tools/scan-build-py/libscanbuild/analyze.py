@@ -16,6 +16,7 @@ import re
 import os
 import os.path
 import json
+import time
 import argparse
 import logging
 import subprocess
@@ -48,17 +49,17 @@ def analyze_build_main(bin_dir, from_build_command):
     with report_directory(args.output, args.keep_empty) as target_dir:
         if not from_build_command:
             # run analyzer only and generate cover report
-            run_analyzer(args, target_dir)
-            number_of_bugs = document(args, target_dir, True)
+            timings = run_analyzer(args, target_dir)
+            number_of_bugs = document(args, target_dir, True, timings)
             return number_of_bugs if args.status_bugs else 0
         elif args.intercept_first:
             # run build command and capture compiler executions
             exit_code = capture(args, bin_dir)
             # next step to run the analyzer against the captured commands
             if need_analyzer(args.build):
-                run_analyzer(args, target_dir)
+                timings = run_analyzer(args, target_dir)
                 # cover report generation and bug counting
-                number_of_bugs = document(args, target_dir, True)
+                number_of_bugs = document(args, target_dir, True, timings)
                 # remove the compilation database when it was not requested
                 if os.path.exists(args.cdb):
                     os.unlink(args.cdb)
@@ -92,36 +93,118 @@ def need_analyzer(args):
     return len(args) and not re.search('configure|autogen', args[0])
 
 
+def source_path(entry):
+    """ The source file of a compilation database entry, which identifies the
+    entry across runs. """
+
+    return os.path.join(entry['directory'], entry['file'])
+
+
+def read_timings(cache_dir):
+    """ Read the analysis times of the previous runs from the cache. """
+
+    if cache_dir:
+        try:
+            with open(os.path.join(cache_dir, 'timings.json'), 'r') as handle:
+                return json.load(handle)
+        except (IOError, ValueError):
+            pass
+    return dict()
+
+
+def write_timings(cache_dir, timings, results):
+    """ Record the analysis times of this run in the cache. Results which
+    came from the cache say nothing about the cost of an analysis. """
+
+    if not cache_dir:
+        return
+    timings.update((current['file'], current['time']) for current in results
+                   if not current['cached'])
+    with open(os.path.join(cache_dir, 'timings.json'), 'w') as handle:
+        json.dump(timings, handle, indent=4)
+
+
+def schedule(entries, timings):
+    """ Order the entries to analyze the most expensive ones first, so the
+    big translation units don't start late and prolong the whole run.
+
+    The cost of an entry is its analysis time in an earlier run. For an entry
+    without one, its source file size is turned into time at the rate of the
+    entries with known times. """
+
+    def size(entry):
+        try:
+            return os.path.getsize(source_path(entry))
+        except OSError:
+            return 0
+
+    sized = [(entry, size(entry)) for entry in entries]
+    known = [(timings[source_path(entry)], length)
+             for entry, length in sized if source_path(entry) in timings]
+    known_size = sum(length for _, length in known)
+    rate = sum(cost for cost, _ in known) / known_size if known_size else 1.0
+
+    def cost(pair):
+        entry, length = pair
+        return timings.get(source_path(entry), length * rate)
+
+    return [entry for entry, _ in sorted(sized, key=cost, reverse=True)]
+
+
+def run_timed(opts):
+    """ Runs the analyzer against a single entry and measures its wall time.
+    """
+
+    filename = source_path(opts)
+    start = time.time()
+    result = run(opts)
+    return filename, result, time.time() - start
+
+
 def run_analyzer(args, output_dir):
-    """ Runs the analyzer against the given compilation database. """
+    """ Runs the analyzer against the given compilation database. Returns the
+    analysis time of every analyzed entry. """
 
     def exclude(filename):
         """ Return true when any excluded directory prefix the filename. """
         return any(re.match(r'^' + directory, filename)
                    for directory in args.excludes)
 
+    cache_dir = os.path.abspath(args.cache_dir) if args.cache_dir else None
     consts = {
         'clang': args.clang,
         'output_dir': output_dir,
         'output_format': args.output_format,
         'output_failures': args.output_failures,
         'direct_args': analyzer_params(args),
-        'force_debug': args.force_debug
+        'force_debug': args.force_debug,
+        'cache_dir': cache_dir
     }
 
+    if cache_dir and not os.path.isdir(cache_dir):
+        os.makedirs(cache_dir)
+    timings = read_timings(cache_dir)
+
     logging.debug('run analyzer against compilation database')
     with open(args.cdb, 'r') as handle:
-        generator = (dict(cmd, **consts)
-                     for cmd in json.load(handle) if not exclude(cmd['file']))
-        # when verbose output requested execute sequentially
-        pool = multiprocessing.Pool(1 if args.verbose > 2 else None)
-        for current in pool.imap_unordered(run, generator):
-            if current is not None:
-                # display error message from the static analyzer
-                for line in current['error_output']:
-                    logging.info(line.rstrip())
-        pool.close()
-        pool.join()
+        entries = [dict(cmd, **consts)
+                   for cmd in json.load(handle) if not exclude(cmd['file'])]
+    results = []
+    # when verbose output requested execute sequentially
+    pool = multiprocessing.Pool(1 if args.verbose > 2 else None)
+    for filename, current, elapsed in pool.imap_unordered(
+            run_timed, schedule(entries, timings)):
+        if current is not None:
+            results.append({'file': filename, 'time': elapsed,
+                            'cached': current.get('cached', False)})
+            # display error message from the static analyzer
+            for line in current['error_output']:
+                logging.info(line.rstrip())
+    pool.close()
+    pool.join()
+
+    write_timings(cache_dir, timings, results)
+    return results
 
 
 def setup_environment(args, destination, bin_dir):
@@ -458,6 +541,15 @@ def create_parser(from_build_command):
                 Could be usefull when project contains 3rd party libraries.
                 The directory path shall be absolute path as file names in
                 the compilation database.""")
+    advanced.add_argument(
+        '--cache-dir',
+        metavar='<path>',
+        dest='cache_dir',
+        help="""Keep the analysis results in this directory, and reuse them
+                in later runs for the translation units whose preprocessed
+                source and analyzer options did not change. The analysis
+                times are recorded there too, to start the most expensive
+                translation units first in later runs.""")
     advanced.add_argument(
         '--force-analyze-debug-code',
         dest='force_debug',
@@ -63,8 +63,10 @@ def report_directory(hint, keep):
             os.rmdir(name)
 
 
-def document(args, output_dir, use_cdb):
-    """ Generates cover report and returns the number of bugs/crashes. """
+def document(args, output_dir, use_cdb, timings=None):
+    """ Generates cover report and returns the number of bugs/crashes.
+
+    timings -- the analysis time of every translation unit, if known. """
 
     html_reports_available = args.output_format in {'html', 'plist-html'}
 
@@ -87,6 +89,8 @@ def document(args, output_dir, use_cdb):
                 fragments.append(bug_report(output_dir, prefix))
             if crash_count:
                 fragments.append(crash_report(output_dir, prefix))
+            if timings:
+                fragments.append(timing_report(output_dir, prefix, timings))
             assemble_cover(output_dir, prefix, args, fragments)
             # copy additinal files to the report
             copy_resource_files(output_dir)
@@ -283,6 +287,42 @@ def crash_report(output_dir, prefix):
     return name
 
 
+def timing_report(output_dir, prefix, timings):
+    """ Creates a fragment from the analysis time of the translation units,
+    the slowest ones first. """
+
+    name = os.path.join(output_dir, 'timings.html.fragment')
+    with open(name, 'w') as handle:
+        indent = 4
+        handle.write(reindent("""
+        |<h2>Analysis Times</h2>
+        |<p>Total wall time of the analyzer runs: {0:.2f} seconds.</p>
+        |<table class="sortable">
+        |  <thead>
+        |    <tr>
+        |      <td>Source File</td>
+        |      <td class="Q">Seconds</td>
+        |      <td>Cached</td>
+        |    </tr>
+        |  </thead>
+        |  <tbody>""", indent).format(sum(t['time'] for t in timings)))
+        for current in sorted(timings, key=lambda t: t['time'], reverse=True):
+            handle.write(reindent("""
+        |    <tr>
+        |      <td>{source}</td>
+        |      <td class="Q">{time:.2f}</td>
+        |      <td>{cached}</td>
+        |    </tr>""", indent).format(
+                source=escape(chop(prefix, current['file'])),
+                time=current['time'],
+                cached='yes' if current['cached'] else 'no'))
+        handle.write(reindent("""
+        |  </tbody>
+        |</table>""", indent))
+        handle.write(comment('REPORTTIMINGS'))
+    return name
+
+
 def read_crashes(output_dir):
     """ Generate a unique sequence of crashes from given output directory. """
 
@@ -8,6 +8,8 @@
 import re
 import os
 import os.path
+import shutil
+import hashlib
 import tempfile
 import functools
 import subprocess
@@ -194,8 +196,82 @@ def run_analyzer(opts, continuation=report_failure):
     return {'error_output': output, 'exit_code': child.returncode}
 
 
+def cache_key(opts):
+    """ Hash everything the result of an analysis depends on: the preprocessed
+    source, the analyzer options and the analyzer version. Returns None when
+    the source can not be preprocessed. """
+
+    cwd = opts['directory']
+    try:
+        cmd = get_arguments([opts['clang'], '-fsyntax-only', '-E'] +
+                            opts['flags'] + [opts['file']], cwd)
+        with open(os.devnull, 'w') as devnull:
+            preprocessed = subprocess.check_output(cmd, cwd=cwd,
+                                                   stderr=devnull)
+    except Exception:
+        return None
+
+    digest = hashlib.sha1(preprocessed)
+    for item in opts['direct_args'] + [opts['output_format'],
+                                       get_version(opts['clang'])]:
+        digest.update(b'\0' + item.encode('utf-8'))
+    return digest.hexdigest()
+
+
+def copy_reports(source, destination):
+    """ Copy the report files from one output directory to another. """
+
+    for root, _, files in os.walk(source):
+        target = os.path.join(destination, os.path.relpath(root, source))
+        if not os.path.isdir(target):
+            os.makedirs(target)
+        for name in files:
+            shutil.copy(os.path.join(root, name), target)
+
+
+@require(['clang', 'directory', 'flags', 'direct_args', 'file', 'output_dir',
+          'output_format'])
+def use_cache(opts, continuation=run_analyzer):
+    """ Reuse the result of an earlier analysis of the same preprocessed
+    source with the same options, when a cache directory is given.
+
+    Every cache entry is a directory named by the cache key, which has the
+    reports of the analysis and its output. Only successful analyses are
+    cached, failures are always run again. """
+
+    cache_dir = opts.get('cache_dir')
+    key = cache_key(opts) if cache_dir else None
+    if key is None:
+        return continuation(opts)
+
+    entry = os.path.join(cache_dir, key)
+    if os.path.isdir(entry):
+        logging.debug('analysis result found in cache: %s', entry)
+        copy_reports(os.path.join(entry, 'reports'), opts['output_dir'])
+        with open(os.path.join(entry, 'output.txt'), 'r') as handle:
+            return {'error_output': handle.readlines(), 'exit_code': 0,
+                    'cached': True}
+
+    # run the analysis into a new entry, which is only published when
+    # complete, so concurrent runs never see a partial one.
+    staging = tempfile.mkdtemp(prefix='tmp-', dir=cache_dir)
+    try:
+        reports = os.path.join(staging, 'reports')
+        os.mkdir(reports)
+        result = continuation(dict(opts, output_dir=reports))
+        copy_reports(reports, opts['output_dir'])
+        if result['exit_code'] == 0:
+            with open(os.path.join(staging, 'output.txt'), 'w') as handle:
+                handle.writelines(result['error_output'])
+            if not os.path.isdir(entry):
+                os.rename(staging, entry)
+        return result
+    finally:
+        shutil.rmtree(staging, ignore_errors=True)
+
+
 @require(['flags', 'force_debug'])
-def filter_debug_flags(opts, continuation=run_analyzer):
+def filter_debug_flags(opts, continuation=use_cache):
     """ Filter out nondebug macros when requested. """
 
     if opts.pop('force_debug'):
@@ -5,3 +5,37 @@
 # License. See LICENSE.TXT for details.
 
 import libscanbuild.analyze as sut
+import libear
+import unittest
+import os.path
+
+
+class ScheduleTest(unittest.TestCase):
+
+    @staticmethod
+    def schedule(sizes, timings):
+        with libear.TemporaryDirectory() as tmpdir:
+            entries = []
+            for name, size in sizes.items():
+                with open(os.path.join(tmpdir, name), 'w') as handle:
+                    handle.write('x' * size)
+                entries.append({'directory': tmpdir, 'file': name})
+            timings = dict((os.path.join(tmpdir, name), cost)
+                           for name, cost in timings.items())
+            return [entry['file'] for entry in sut.schedule(entries, timings)]
+
+    def test_largest_first_without_timings(self):
+        self.assertEqual(['b.c', 'c.c', 'a.c'],
+                         self.schedule({'a.c': 10, 'b.c': 300, 'c.c': 20},
+                                       {}))
+
+    def test_slowest_first_with_timings(self):
+        self.assertEqual(['a.c', 'c.c', 'b.c'],
+                         self.schedule({'a.c': 10, 'b.c': 300, 'c.c': 20},
+                                       {'a.c': 9.0, 'b.c': 1.0, 'c.c': 2.0}))
+
+    def test_unknown_cost_estimated_from_timings(self):
+        # 1 second per 100 bytes makes 'c.c' cost 5 seconds.
+        self.assertEqual(['a.c', 'c.c', 'b.c'],
+                         self.schedule({'a.c': 1000, 'b.c': 100, 'c.c': 500},
+                                       {'a.c': 10.0, 'b.c': 1.0}))
@@ -155,6 +155,47 @@ class RunAnalyzerTest(unittest.TestCase):
         self.assertTrue(len(fwds['error_output']) > 0)
 
 
+class UseCacheTest(unittest.TestCase):
+
+    def test_second_run_comes_from_cache(self):
+        def analyze(opts):
+            analyze.calls += 1
+            with open(os.path.join(opts['output_dir'], 'report.plist'),
+                      'w') as handle:
+                handle.write('report')
+            return {'error_output': ['warning\n'], 'exit_code': 0}
+        analyze.calls = 0
+
+        with libear.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'test.c')
+            with open(filename, 'w') as handle:
+                handle.write('int main() { return 0; }')
+            cache_dir = os.path.join(tmpdir, 'cache')
+            os.mkdir(cache_dir)
+
+            for output in ['first', 'second']:
+                output_dir = os.path.join(tmpdir, output)
+                os.mkdir(output_dir)
+                opts = {
+                    'clang': 'clang',
+                    'directory': os.getcwd(),
+                    'flags': [],
+                    'direct_args': [],
+                    'file': filename,
+                    'output_dir': output_dir,
+                    'output_format': 'plist',
+                    'cache_dir': cache_dir
+                }
+                result = sut.use_cache(opts, analyze)
+                self.assertEqual(0, result['exit_code'])
+                self.assertEqual(['warning\n'], result['error_output'])
+                self.assertTrue(
+                    os.path.isfile(os.path.join(output_dir, 'report.plist')))
+
+            self.assertEqual(1, analyze.calls)
+            self.assertTrue(result['cached'])
+
+
 class ReportFailureTest(unittest.TestCase):
 
     def assertUnderFailures(self, path):
@@ -78,5 +78,34 @@ TEST(GetParents, ReturnsMultipleParentsInTemplateInstantiations) {
           hasAncestor(cxxRecordDecl(unless(isTemplateInstantiation())))))));
 }
 
+TEST(GetParents, RespectsTraversalScope) {
+  auto AST = tooling::buildASTFromCode(
+      "struct foo { int bar; }; struct baz { int qux; };");
+  auto &Ctx = AST->getASTContext();
+  auto &TU = *Ctx.getTranslationUnitDecl();
+  auto *Foo = cast<CXXRecordDecl>(TU.lookup(&Ctx.Idents.get("foo")).front());
+  auto *Bar = Foo->lookup(&Ctx.Idents.get("bar")).front();
+  auto *Baz = cast<CXXRecordDecl>(TU.lookup(&Ctx.Idents.get("baz")).front());
+  auto *Qux = Baz->lookup(&Ctx.Idents.get("qux")).front();
+
+  // By default, the whole translation unit is traversed.
+  ASSERT_EQ(1u, Ctx.getParents(*Bar).size());
+  EXPECT_EQ(Foo, Ctx.getParents(*Bar)[0].get<Decl>());
+  ASSERT_EQ(1u, Ctx.getParents(*Foo).size());
+  EXPECT_EQ(&TU, Ctx.getParents(*Foo)[0].get<Decl>());
+
+  // Only nodes within the traversal scope have parents.
+  Ctx.setTraversalScope({Foo});
+  ASSERT_EQ(1u, Ctx.getParents(*Bar).size());
+  EXPECT_EQ(Foo, Ctx.getParents(*Bar)[0].get<Decl>());
+  EXPECT_TRUE(Ctx.getParents(*Foo).empty());
+  EXPECT_TRUE(Ctx.getParents(*Qux).empty());
+
+  Ctx.setTraversalScope({Baz});
+  EXPECT_TRUE(Ctx.getParents(*Bar).empty());
+  ASSERT_EQ(1u, Ctx.getParents(*Qux).size());
+  EXPECT_EQ(Baz, Ctx.getParents(*Qux)[0].get<Decl>());
+}
+
 } // end namespace ast_matchers
 } // end namespace clang
@@ -119,6 +119,107 @@ TEST(MatchFinder, CheckProfiling) {
   EXPECT_EQ("MyID", Records.begin()->getKey());
 }
 
+TEST(MatchFinder, CountsMemoization) {
+  MatchFinder::MatchFinderOptions Options;
+  MatchFinder::MatchFinderOptions::MemoizationStatistics Stats;
+  Options.MemoizationStats = &Stats;
+  MatchFinder Finder(std::move(Options));
+
+  struct EmptyCallback : public MatchFinder::MatchCallback {
+    void run(const MatchFinder::MatchResult &Result) override {}
+  } Callback;
+  Finder.addMatcher(expr(hasAncestor(functionDecl(hasName("f")))), &Callback);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(),
+                                     "void f() { int x = 1; x = x + 1; }\n"
+                                     "void g() {}\n"));
+
+  // The expressions in 'f' share their ancestors, whose results are only
+  // computed once, and are dropped once 'f' has been traversed.
+  EXPECT_LT(0u, Stats.Misses);
+  EXPECT_LT(0u, Stats.Hits);
+  EXPECT_EQ(1u, Stats.Evictions);
+}
+
+TEST(NameGuard, IsTheNameOfTheNodeOrCallee) {
+  internal::NameGuard Guard;
+  EXPECT_TRUE(internal::DynTypedMatcher(functionDecl(hasName("::ns::f")))
+                  .getNameGuard(Guard));
+  EXPECT_EQ(internal::NameGuard::NS_Decl, Guard.Source);
+  EXPECT_EQ((std::vector<std::string>{"::ns::f", "ns::f", "f"}), Guard.Names);
+
+  EXPECT_TRUE(internal::DynTypedMatcher(
+                  callExpr(callee(functionDecl(hasAnyName("f", "g")))))
+                  .getNameGuard(Guard));
+  EXPECT_EQ(internal::NameGuard::NS_CalleeDecl, Guard.Source);
+  EXPECT_EQ((std::vector<std::string>{"f", "g"}), Guard.Names);
+
+  EXPECT_FALSE(internal::DynTypedMatcher(
+                   functionDecl(anyOf(hasName("f"), isDefinition())))
+                   .getNameGuard(Guard));
+  EXPECT_FALSE(internal::DynTypedMatcher(functionDecl(unless(hasName("f"))))
+                   .getNameGuard(Guard));
+}
+
+TEST(MatchFinder, DispatchesOnNames) {
+  struct RecordingCallback : public MatchFinder::MatchCallback {
+    RecordingCallback(std::vector<std::string> &Matches, StringRef Label)
+        : Matches(Matches), Label(Label) {}
+    void run(const MatchFinder::MatchResult &Result) override {
+      Matches.push_back(Label);
+    }
+    std::vector<std::string> &Matches;
+    std::string Label;
+  };
+  std::vector<std::string> Matches;
+  RecordingCallback F(Matches, "f"), NsG(Matches, "ns::g"),
+      CallsG(Matches, "calls g"), All(Matches, "all");
+  MatchFinder Finder;
+  Finder.addMatcher(functionDecl(hasName("f"), isDefinition()), &F);
+  Finder.addMatcher(functionDecl(hasName("ns::g")), &NsG);
+  Finder.addMatcher(callExpr(callee(functionDecl(hasName("g")))), &CallsG);
+  Finder.addMatcher(functionDecl(), &All);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(),
+                                     "namespace ns { void g(); }\n"
+                                     "void g();\n"
+                                     "void f() { ns::g(); g(); }\n"));
+
+  // Matchers run in the order they were added, guarded or not.
+  EXPECT_EQ((std::vector<std::string>{"ns::g", "all", "all", "f", "all",
+                                      "calls g", "calls g"}),
+            Matches);
+}
+
+TEST(MatchFinder, OnlyTraversesMatchedFiles) {
+  struct RecordingCallback : public MatchFinder::MatchCallback {
+    void run(const MatchFinder::MatchResult &Result) override {
+      Matches.push_back(
+          Result.Nodes.getNodeAs<NamedDecl>("decl")->getNameAsString());
+    }
+    std::vector<std::string> Matches;
+  } Callback;
+  MatchFinder::MatchFinderOptions Options;
+  Options.ShouldMatchFile = [](const SourceManager &SM, FileID FID) {
+    return FID == SM.getMainFileID();
+  };
+  MatchFinder Finder(std::move(Options));
+  Finder.addMatcher(
+      functionDecl(unless(hasAncestor(functionDecl()))).bind("decl"),
+      &Callback);
+  std::unique_ptr<FrontendActionFactory> Factory(
+      newFrontendActionFactory(&Finder));
+  FileContentMappings M;
+  M.push_back(std::make_pair("/other", "void h();\nvoid f();\n"));
+  ASSERT_TRUE(tooling::runToolOnCodeWithArgs(
+      Factory->create(), "#include \"other\"\nvoid f() {}\nvoid g();\n",
+      {"-I/"}, "input.cc", "clang-tool",
+      std::make_shared<PCHContainerOperations>(), M));
+  EXPECT_EQ((std::vector<std::string>{"f", "g"}), Callback.Matches);
+}
+
 class VerifyStartOfTranslationUnit : public MatchFinder::MatchCallback {
 public:
   VerifyStartOfTranslationUnit() : Called(false) {}
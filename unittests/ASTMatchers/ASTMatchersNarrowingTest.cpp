@@ -1275,6 +1275,23 @@ TEST(Matcher, HasNameSupportsFunctionScope) {
   EXPECT_TRUE(matches(code, fieldDecl(hasName("::a::F(int)::S::m"))));
 }
 
+TEST(Matcher, HasNameMatchesIdentifiersAfterFirstUse) {
+  // After the first node it sees, a matcher compares resolved identifiers;
+  // the nodes before 'C' make sure both ways are taken.
+  std::string code = "class A; class B; class C;"
+                     "namespace a { namespace { inline namespace b {"
+                     "  class A; class B; class C; struct S { class C; };"
+                     "} } }";
+  EXPECT_TRUE(matches(code, recordDecl(hasName("::C"))));
+  EXPECT_TRUE(matches(code, recordDecl(hasName("a::C"))));
+  EXPECT_TRUE(matches(code, recordDecl(hasName("::a::b::C"))));
+  EXPECT_TRUE(matches(code, recordDecl(hasName("a::S::C"))));
+  EXPECT_TRUE(matches(code, recordDecl(hasAnyName("XX", "b::S::C"))));
+  EXPECT_TRUE(notMatches(code, recordDecl(hasName("::b::C"))));
+  EXPECT_TRUE(notMatches(code, recordDecl(hasName("::S::C"))));
+  EXPECT_TRUE(notMatches(code, recordDecl(hasName("a::b::A::C"))));
+}
+
 TEST(Matcher, HasAnyName) {
   const std::string Code = "namespace a { namespace b { class C; } }";
 
@@ -212,6 +212,43 @@ TEST(ParserTest, FullParserTest) {
             Error.toStringFull());
 }
 
+TEST(ParserTest, MatcherExpressionCache) {
+  auto NamedValues = getTestNamedValues();
+  MatcherExpressionCache Cache(&NamedValues);
+  Diagnostics Error;
+  llvm::Optional<DynTypedMatcher> First = Cache.parse(
+      "functionDecl(hasParamA, hasParameter(1, hasName(nameX)))", &Error);
+  ASSERT_TRUE(First.hasValue());
+  EXPECT_EQ(1u, Cache.size());
+
+  // Whitespace between tokens does not matter, but it does in strings.
+  llvm::Optional<DynTypedMatcher> Second = Cache.parse(
+      " functionDecl ( hasParamA ,\n hasParameter( 1, hasName(nameX) ) )",
+      &Error);
+  ASSERT_TRUE(Second.hasValue());
+  EXPECT_EQ(First->getID(), Second->getID());
+  EXPECT_EQ(1u, Cache.size());
+  EXPECT_TRUE(
+      Cache.parse("functionDecl(hasName(\"x \"))", &Error).hasValue());
+  EXPECT_TRUE(Cache.parse("functionDecl(hasName(\"x\"))", &Error).hasValue());
+  EXPECT_EQ(3u, Cache.size());
+  EXPECT_EQ("", Error.toStringFull());
+
+  Matcher<Decl> M = Second->unconditionalConvertTo<Decl>();
+  EXPECT_TRUE(matches("void f(int a, int x);", M));
+  EXPECT_FALSE(matches("void f(int x, int a);", M));
+
+  // Errors are reported every time, and not cached.
+  for (int I = 0; I != 2; ++I) {
+    Diagnostics Errors;
+    EXPECT_FALSE(Cache.parse("is Definition()", &Errors).hasValue());
+    EXPECT_NE("", Errors.toStringFull());
+  }
+  EXPECT_EQ(3u, Cache.size());
+  Cache.clear();
+  EXPECT_EQ(0u, Cache.size());
+}
+
 std::string ParseWithError(StringRef Code) {
   Diagnostics Error;
   VariantValue Value;
@@ -0,0 +1,91 @@
+//===- unittests/Analysis/CallGraphTest.cpp - CallGraph tests -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Analysis/CallGraph.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+#include <string>
+
+namespace clang {
+namespace analysis {
+namespace {
+
+/// Builds the call graph as the top-level declarations arrive, and prints
+/// it once the translation unit is complete.
+class IncrementalCallGraphConsumer : public ASTConsumer {
+  CallGraph CG;
+  std::string &Output;
+
+public:
+  IncrementalCallGraphConsumer(std::string &Output) : Output(Output) {}
+
+  bool HandleTopLevelDecl(DeclGroupRef DG) override {
+    for (Decl *D : DG) {
+      CG.addToCallGraph(D);
+      // Adding a declaration again must not add its calls again.
+      CG.addToCallGraph(D);
+    }
+    return true;
+  }
+
+  void HandleTranslationUnit(ASTContext &) override {
+    llvm::raw_string_ostream OS(Output);
+    CG.print(OS);
+  }
+};
+
+class IncrementalCallGraphAction : public ASTFrontendAction {
+  std::string &Output;
+
+public:
+  IncrementalCallGraphAction(std::string &Output) : Output(Output) {}
+
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                 StringRef) override {
+    return llvm::make_unique<IncrementalCallGraphConsumer>(Output);
+  }
+};
+
+std::string buildIncrementally(const char *Code) {
+  std::string Output;
+  EXPECT_TRUE(tooling::runToolOnCode(new IncrementalCallGraphAction(Output),
+                                     Code));
+  return Output;
+}
+
+TEST(CallGraph, CallsToFunctionsDefinedLater) {
+  std::string Output = buildIncrementally("void g();\n"
+                                          "void f() { g(); g(); }\n"
+                                          "void g() {}\n"
+                                          "void h() { f(); }\n");
+  EXPECT_NE(std::string::npos, Output.find("Function: f calls: g g \n"));
+  EXPECT_NE(std::string::npos, Output.find("Function: h calls: f \n"));
+  EXPECT_NE(std::string::npos, Output.find("Function: g calls: \n"));
+}
+
+TEST(CallGraph, CallsToUndefinedFunctions) {
+  std::string Output = buildIncrementally("void g();\n"
+                                          "void f() { g(); }\n");
+  EXPECT_NE(std::string::npos, Output.find("Function: f calls: \n"));
+}
+
+TEST(CallGraph, MethodsDefinedOutOfLine) {
+  std::string Output = buildIncrementally("void g() {}\n"
+                                          "struct S { void m(); };\n"
+                                          "void S::m() { g(); }\n");
+  EXPECT_NE(std::string::npos, Output.find("Function: m calls: g \n"));
+}
+
+} // namespace
+} // namespace analysis
+} // namespace clang
@@ -10,8 +10,11 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -246,6 +249,120 @@ TEST_F(FileManagerTest, addRemoveStatCache) {
   manager.removeStatCache(statCache);
 }
 
+// FileManagers sharing their contents read each file once, for as long as a
+// buffer with its contents is alive.
+TEST(SharedFileContentsTest, SharesBuffers) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/a/shared.h", 0, MemoryBuffer::getMemBuffer("int x;\n"));
+
+  FileSystemOptions Opts;
+  Opts.SharedContents = std::make_shared<SharedFileContents>();
+  FileManager First(Opts, FS);
+  FileManager Second(Opts, FS);
+  const FileEntry *FirstEntry = First.getFile("/a/shared.h");
+  const FileEntry *SecondEntry = Second.getFile("/a/shared.h");
+  ASSERT_TRUE(FirstEntry != nullptr);
+  ASSERT_TRUE(SecondEntry != nullptr);
+
+  auto FirstBuffer = First.getBufferForFile(FirstEntry);
+  auto SecondBuffer = Second.getBufferForFile(SecondEntry);
+  ASSERT_TRUE(bool(FirstBuffer));
+  ASSERT_TRUE(bool(SecondBuffer));
+  EXPECT_EQ("int x;\n", (*SecondBuffer)->getBuffer());
+  EXPECT_EQ((*FirstBuffer)->getBufferStart(),
+            (*SecondBuffer)->getBufferStart());
+
+  // Once no buffer refers to them, the contents are read again.
+  FirstBuffer->reset();
+  SecondBuffer->reset();
+  EXPECT_FALSE(Opts.SharedContents->lookup(*FirstEntry));
+}
+
+// Missing paths recorded by a PersistentStatCacheWriter are answered from the
+// cache for as long as their directory is unchanged.
+TEST(PersistentStatCacheTest, SkipsKnownMissingPaths) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/a/present.h", 0, MemoryBuffer::getMemBuffer(""));
+
+  PersistentStatCacheWriter Writer;
+  FileData Data;
+  EXPECT_TRUE(FileSystemStatCache::get("/a/missing.h", Data, true, nullptr,
+                                       &Writer, *FS));
+  EXPECT_FALSE(FileSystemStatCache::get("/a/present.h", Data, true, nullptr,
+                                        &Writer, *FS));
+
+  SmallString<128> CachePath;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("stat-cache", "bin", CachePath));
+  ASSERT_FALSE(Writer.write(CachePath));
+
+  // The file system is not consulted for a trusted entry, so a file which
+  // appeared without changing its directory stamp is still reported missing.
+  std::unique_ptr<PersistentStatCache> Cache =
+      PersistentStatCache::create(CachePath);
+  ASSERT_TRUE(Cache != nullptr);
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Unchanged(
+      new vfs::InMemoryFileSystem);
+  Unchanged->addFile("/a/present.h", 0, MemoryBuffer::getMemBuffer(""));
+  Unchanged->addFile("/a/missing.h", 0, MemoryBuffer::getMemBuffer(""));
+  EXPECT_TRUE(FileSystemStatCache::get("/a/missing.h", Data, true, nullptr,
+                                       Cache.get(), *Unchanged));
+  EXPECT_FALSE(FileSystemStatCache::get("/a/present.h", Data, true, nullptr,
+                                        Cache.get(), *Unchanged));
+
+  // Once the directory changes, the entry is ignored.
+  Cache = PersistentStatCache::create(CachePath);
+  ASSERT_TRUE(Cache != nullptr);
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Changed(
+      new vfs::InMemoryFileSystem);
+  Changed->addFile("/a/missing.h", 1, MemoryBuffer::getMemBuffer(""));
+  EXPECT_FALSE(FileSystemStatCache::get("/a/missing.h", Data, true, nullptr,
+                                        Cache.get(), *Changed));
+
+  // Updating the cache keeps only the entries which are still valid.
+  PersistentStatCacheWriter Updater;
+  Updater.addValidEntries(*Cache, *Changed);
+  ASSERT_FALSE(Updater.write(CachePath));
+  Cache = PersistentStatCache::create(CachePath);
+  ASSERT_TRUE(Cache != nullptr);
+  unsigned NumEntries = 0;
+  Cache->forEachEntry([&](StringRef, uint64_t) { ++NumEntries; });
+  EXPECT_EQ(0u, NumEntries);
+
+  sys::fs::remove(CachePath);
+}
+
+// The results of 'stat' calls on absolute paths made through one
+// SharedStatCache are seen by the others sharing its results.
+TEST(SharedStatCacheTest, SharesAbsolutePaths) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/a/present.h", 0, MemoryBuffer::getMemBuffer(""));
+  FS->addFile("relative.h", 0, MemoryBuffer::getMemBuffer(""));
+
+  auto Results = std::make_shared<SharedStatResults>();
+  SharedStatCache First(Results);
+  FileData Data;
+  EXPECT_FALSE(FileSystemStatCache::get("/a/present.h", Data, true, nullptr,
+                                        &First, *FS));
+  EXPECT_TRUE(FileSystemStatCache::get("/a/missing.h", Data, true, nullptr,
+                                       &First, *FS));
+  EXPECT_FALSE(FileSystemStatCache::get("relative.h", Data, true, nullptr,
+                                        &First, *FS));
+
+  // Another cache sees the recorded results even where its file system
+  // differs, but relative paths are always looked up.
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Other(
+      new vfs::InMemoryFileSystem);
+  Other->addFile("/a/missing.h", 0, MemoryBuffer::getMemBuffer(""));
+  SharedStatCache Second(Results);
+  EXPECT_FALSE(FileSystemStatCache::get("/a/present.h", Data, true, nullptr,
+                                        &Second, *Other));
+  EXPECT_EQ("/a/present.h", Data.Name);
+  EXPECT_TRUE(FileSystemStatCache::get("/a/missing.h", Data, true, nullptr,
+                                       &Second, *Other));
+  EXPECT_TRUE(FileSystemStatCache::get("relative.h", Data, true, nullptr,
+                                       &Second, *Other));
+}
+
 #endif  // !LLVM_ON_WIN32
 
 } // anonymous namespace
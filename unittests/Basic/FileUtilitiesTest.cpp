@@ -0,0 +1,61 @@
+//===- unittests/Basic/FileUtilitiesTest.cpp - File utility tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FileUtilities.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+TEST(FileUtilitiesTest, WritesAtomically) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("file-utilities", Dir));
+  SmallString<128> Path(Dir);
+  sys::path::append(Path, "file");
+
+  ASSERT_FALSE(writeFileAtomically(Path, "old"));
+  ASSERT_FALSE(writeFileAtomically(Path, "new"));
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("new", (*Buffer)->getBuffer());
+
+  // No temporary file is left behind.
+  std::error_code EC;
+  unsigned NumFiles = 0;
+  for (sys::fs::directory_iterator It(Dir, EC), End; It != End && !EC;
+       It.increment(EC))
+    ++NumFiles;
+  EXPECT_EQ(1u, NumFiles);
+
+  SmallString<128> MissingPath(Dir);
+  sys::path::append(MissingPath, "missing", "file");
+  EXPECT_TRUE(bool(writeFileAtomically(MissingPath, "contents")));
+
+  sys::fs::remove(Path);
+  sys::fs::remove(Dir);
+}
+
+TEST(FileUtilitiesTest, HashedFileNames) {
+  EXPECT_EQ("cache-abc.o", getHashedFileName("cache", "abc", ".o"));
+  EXPECT_EQ("cache-abc", getHashedFileName("cache", "abc"));
+
+  std::string A = getMainFileHashedName("/a/main.c", ".summary");
+  std::string B = getMainFileHashedName("/b/main.c", ".summary");
+  EXPECT_NE(A, B);
+  EXPECT_TRUE(StringRef(A).startswith("main.c-"));
+  EXPECT_TRUE(StringRef(A).endswith(".summary"));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,91 @@
+//===- unittests/Basic/SanitizerBlacklistTest.cpp - Blacklist tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/SanitizerBlacklist.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+class SanitizerBlacklistTest : public ::testing::Test {
+protected:
+  SanitizerBlacklistTest()
+      : FileMgr(FileMgrOpts), DiagID(new DiagnosticIDs()),
+        Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+        SourceMgr(Diags, FileMgr) {}
+
+  void SetUp() override {
+    int FD;
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("blacklist", "txt", FD,
+                                                    BlacklistPath));
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << "src:/blacklisted.c\n"
+       << "src:/init.c=init\n";
+  }
+
+  void TearDown() override { llvm::sys::fs::remove(BlacklistPath); }
+
+  FileID createFileID(StringRef Name) {
+    StringRef Source = "int x;\n";
+    const FileEntry *File = FileMgr.getVirtualFile(Name, Source.size(), 0);
+    SourceMgr.overrideFileContents(File,
+                                   llvm::MemoryBuffer::getMemBuffer(Source));
+    return SourceMgr.createFileID(File, SourceLocation(), SrcMgr::C_User);
+  }
+
+  SmallString<128> BlacklistPath;
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+};
+
+TEST_F(SanitizerBlacklistTest, FileIDs) {
+  SanitizerBlacklist Blacklist({BlacklistPath.str()}, SourceMgr);
+  FileID Blacklisted = createFileID("/blacklisted.c");
+  FileID Other = createFileID("/other.c");
+
+  // Asking again gives the same answer, whether or not it was cached.
+  for (unsigned I = 0; I != 2; ++I) {
+    EXPECT_TRUE(Blacklist.isBlacklistedFileID(Blacklisted));
+    EXPECT_FALSE(Blacklist.isBlacklistedFileID(Other));
+    EXPECT_TRUE(Blacklist.isBlacklistedLocation(
+        SourceMgr.getLocForStartOfFile(Blacklisted).getLocWithOffset(4)));
+    EXPECT_FALSE(
+        Blacklist.isBlacklistedLocation(SourceMgr.getLocForStartOfFile(Other)));
+  }
+  EXPECT_FALSE(Blacklist.isBlacklistedLocation(SourceLocation()));
+
+  // Another FileID for the same file has the same answer.
+  EXPECT_TRUE(Blacklist.isBlacklistedFileID(createFileID("/blacklisted.c")));
+}
+
+TEST_F(SanitizerBlacklistTest, FileIDsByCategory) {
+  SanitizerBlacklist Blacklist({BlacklistPath.str()}, SourceMgr);
+  FileID Init = createFileID("/init.c");
+
+  // The answer for one category is not reused for another.
+  EXPECT_TRUE(Blacklist.isBlacklistedFileID(Init, "init"));
+  EXPECT_FALSE(Blacklist.isBlacklistedFileID(Init));
+  EXPECT_TRUE(Blacklist.isBlacklistedFileID(Init, "init"));
+  EXPECT_FALSE(Blacklist.isBlacklistedFileID(createFileID("/blacklisted.c"),
+                                             "init"));
+}
+
+} // anonymous namespace
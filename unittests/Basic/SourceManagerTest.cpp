@@ -171,6 +171,34 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineNumberInLargeBuffer) {
+  // Enough lines that the line table is computed in several steps.
+  const unsigned NumLines = 20000;
+  std::string Source;
+  for (unsigned I = 0; I != NumLines; ++I)
+    Source += "int x;\n";
+  const unsigned LineLength = 7;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+
+  for (unsigned Line : {1U, 15000U, 200U, 15001U, 9999U, NumLines}) {
+    bool Invalid = false;
+    EXPECT_EQ(Line, SourceMgr.getLineNumber(
+                        MainFileID, (Line - 1) * LineLength + 4, &Invalid));
+    EXPECT_TRUE(!Invalid);
+  }
+
+  // Lines past the ones computed so far are found on demand.
+  SourceLocation Start = SourceMgr.getLocForStartOfFile(MainFileID);
+  EXPECT_EQ(Start.getLocWithOffset(19000 * LineLength + 2),
+            SourceMgr.translateLineCol(MainFileID, 19001, 3));
+  EXPECT_EQ(Start.getLocWithOffset(Source.size() - 1),
+            SourceMgr.translateLineCol(MainFileID, NumLines + 2, 1));
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -361,6 +389,85 @@ TEST_F(SourceManagerTest, isBeforeInTranslationUnitWithMacroInInclude) {
   EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(Macros[7].Loc, Macros[8].Loc));
 }
 
+TEST_F(SourceManagerTest, isBeforeInTranslationUnitAcrossIncludes) {
+  const char *headerA =
+    "#define A1 0\n"
+    "#include \"/test-header-b.h\"\n"
+    "#define A2 A1\n"
+    "A2\n";
+
+  const char *headerB =
+    "#define B 0\n";
+
+  const char *main =
+    "#define M1 0\n"
+    "#include \"/test-header-a.h\"\n"
+    "#define M2 0\n"
+    "#include \"/test-header-b.h\"\n"
+    "#define M3 0\n";
+
+  SourceMgr.setMainFileID(
+      SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(main)));
+  for (auto Header : {std::make_pair("/test-header-a.h", headerA),
+                      std::make_pair("/test-header-b.h", headerB)}) {
+    std::unique_ptr<llvm::MemoryBuffer> Buf =
+        llvm::MemoryBuffer::getMemBuffer(Header.second);
+    const FileEntry *File =
+        FileMgr.getVirtualFile(Header.first, Buf->getBufferSize(), 0);
+    SourceMgr.overrideFileContents(File, std::move(Buf));
+  }
+
+  VoidModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(new HeaderSearchOptions, SourceMgr, Diags, LangOpts,
+                          &*Target);
+  Preprocessor PP(new PreprocessorOptions(), Diags, LangOpts, SourceMgr,
+                  HeaderInfo, ModLoader,
+                  /*IILookup =*/nullptr,
+                  /*OwnsHeaderSearch =*/false);
+  PP.Initialize(*Target);
+
+  std::vector<MacroAction> Macros;
+  PP.addPPCallbacks(llvm::make_unique<MacroTracker>(Macros));
+
+  PP.EnterMainSourceFile();
+
+  std::vector<Token> toks;
+  while (1) {
+    Token tok;
+    PP.Lex(tok);
+    if (tok.is(tok::eof))
+      break;
+    toks.push_back(tok);
+  }
+  ASSERT_EQ(1U, toks.size());
+
+  // M1, A1, B, A2, the A2 and A1 expansions, M2, B and M3, in the order of
+  // the translation unit across the main file and both headers.
+  ASSERT_EQ(9U, Macros.size());
+  ASSERT_EQ("A2", Macros[4].Name);
+  ASSERT_FALSE(Macros[4].isDefinition);
+  ASSERT_EQ("A1", Macros[5].Name);
+  ASSERT_FALSE(Macros[5].isDefinition);
+  ASSERT_EQ("M3", Macros[8].Name);
+
+  for (unsigned I = 0; I != Macros.size(); ++I) {
+    for (unsigned J = 0; J != Macros.size(); ++J) {
+      if (I == J)
+        continue;
+      EXPECT_EQ(I < J, SourceMgr.isBeforeInTranslationUnit(Macros[I].Loc,
+                                                           Macros[J].Loc))
+          << Macros[I].Name << " vs. " << Macros[J].Name;
+    }
+  }
+
+  // The token expanded from A2 comes after what the second header defined
+  // for the first one, and before the rest of the main file.
+  EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(Macros[2].Loc,
+                                                  toks[0].getLocation()));
+  EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(toks[0].getLocation(),
+                                                  Macros[6].Loc));
+}
+
 #endif
 
 } // anonymous namespace
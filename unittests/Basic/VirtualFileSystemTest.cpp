@@ -1016,6 +1016,37 @@ TEST_F(VFSFromYAMLTest, MultiComponentPath) {
   EXPECT_FALSE(FS->status("//root/").getError());
 }
 
+TEST_F(VFSFromYAMLTest, LargeDirectory) {
+  IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
+  Lower->addRegularFile("//root/other");
+
+  std::string YAML = "{ 'roots': [\n"
+                     "  { 'type': 'directory', 'name': '//root/dir',\n"
+                     "    'contents': [\n";
+  for (unsigned I = 0; I != 1000; ++I)
+    YAML += "      { 'type': 'file', 'name': 'file" + std::to_string(I) +
+            "', 'external-contents': '//root/other' },\n";
+  // The same directory again, with other contents.
+  YAML += "      { 'type': 'directory', 'name': 'sub',\n"
+          "        'contents': [ { 'type': 'file', 'name': 'a',\n"
+          "                        'external-contents': '//root/other' }]},\n"
+          "      { 'type': 'directory', 'name': 'sub',\n"
+          "        'contents': [ { 'type': 'file', 'name': 'b',\n"
+          "                        'external-contents': '//root/other' }]}]}]\n"
+          "}";
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = getFromYAMLString(YAML, Lower);
+  ASSERT_TRUE(nullptr != FS.get());
+
+  EXPECT_FALSE(FS->status("//root/dir/file0").getError());
+  EXPECT_FALSE(FS->status("//root/dir/file999").getError());
+  EXPECT_EQ(FS->status("//root/dir/file1000").getError(),
+            llvm::errc::no_such_file_or_directory);
+  EXPECT_FALSE(FS->status("//root/dir/sub/a").getError());
+  EXPECT_FALSE(FS->status("//root/dir/sub/b").getError());
+  EXPECT_EQ(FS->status("//root/dir/sub/c").getError(),
+            llvm::errc::no_such_file_or_directory);
+}
+
 TEST_F(VFSFromYAMLTest, TrailingSlashes) {
   IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
   Lower->addRegularFile("//root/other");
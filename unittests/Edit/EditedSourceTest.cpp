@@ -0,0 +1,130 @@
+//===- unittests/Edit/EditedSourceTest.cpp - EditedSource tests -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Edit/EditedSource.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Edit/Commit.h"
+#include "clang/Edit/EditsReceiver.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+#include <tuple>
+
+using namespace clang;
+
+namespace {
+
+/// Records the rewrites of an EditedSource, to apply them to its source.
+class RecordingReceiver : public edit::EditsReceiver {
+  const SourceManager &SM;
+  std::vector<std::tuple<unsigned, unsigned, std::string>> Rewrites;
+
+public:
+  explicit RecordingReceiver(const SourceManager &SM) : SM(SM) {}
+
+  void insert(SourceLocation Loc, StringRef Text) override {
+    Rewrites.emplace_back(SM.getFileOffset(Loc), 0, Text.str());
+  }
+
+  void replace(CharSourceRange Range, StringRef Text) override {
+    unsigned Begin = SM.getFileOffset(Range.getBegin());
+    unsigned End = SM.getFileOffset(Range.getEnd());
+    Rewrites.emplace_back(Begin, End - Begin, Text.str());
+  }
+
+  std::string apply(StringRef Source) const {
+    std::string Result = Source.str();
+    // The rewrites are received in source order; apply them from the end so
+    // that the earlier offsets stay valid.
+    for (auto I = Rewrites.rbegin(), E = Rewrites.rend(); I != E; ++I)
+      Result.replace(std::get<0>(*I), std::get<1>(*I), std::get<2>(*I));
+    return Result;
+  }
+};
+
+class EditedSourceTest : public ::testing::Test {
+protected:
+  EditedSourceTest()
+      : FileMgr(FileMgrOpts), DiagID(new DiagnosticIDs()),
+        Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+        SourceMgr(Diags, FileMgr) {}
+
+  FileID createMainFile(StringRef Source) {
+    FileID FID =
+        SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(Source));
+    SourceMgr.setMainFileID(FID);
+    return FID;
+  }
+
+  SourceLocation getLoc(FileID FID, unsigned Offset) {
+    return SourceMgr.getLocForStartOfFile(FID).getLocWithOffset(Offset);
+  }
+
+  std::string getRewrittenSource(edit::EditedSource &Editor,
+                                 StringRef Source) {
+    RecordingReceiver Receiver(SourceMgr);
+    Editor.applyRewrites(Receiver);
+    return Receiver.apply(Source);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+};
+
+TEST_F(EditedSourceTest, InsertionsOutOfOrder) {
+  StringRef Source = "f(a,b,c,d);\n";
+  FileID FID = createMainFile(Source);
+  edit::EditedSource Editor(SourceMgr, LangOpts);
+
+  // Each insertion goes before all of the previous ones.
+  const char *Texts[] = {"1", "2", "3", "4"};
+  unsigned Offsets[] = {8, 6, 4, 2};
+  for (unsigned I = 0; I != 4; ++I) {
+    edit::Commit Commit(Editor);
+    EXPECT_TRUE(Commit.insert(getLoc(FID, Offsets[I]), Texts[I]));
+    EXPECT_TRUE(Editor.commit(Commit));
+  }
+
+  // Insertions at an offset that already has an edit are merged.
+  edit::Commit Commit(Editor);
+  EXPECT_TRUE(Commit.insert(getLoc(FID, 4), "5"));
+  EXPECT_TRUE(Editor.commit(Commit));
+
+  EXPECT_EQ("f(4a,35b,2c,1d);\n", getRewrittenSource(Editor, Source));
+}
+
+TEST_F(EditedSourceTest, RemovalCoveringEdits) {
+  StringRef Source = "f(a,b,c,d);\n";
+  FileID FID = createMainFile(Source);
+  edit::EditedSource Editor(SourceMgr, LangOpts);
+
+  edit::Commit First(Editor);
+  EXPECT_TRUE(First.insert(getLoc(FID, 8), "X"));
+  EXPECT_TRUE(First.insert(getLoc(FID, 2), "Y"));
+  EXPECT_TRUE(First.insert(getLoc(FID, 6), "Q"));
+  EXPECT_TRUE(Editor.commit(First));
+
+  // Removing "b,c," drops the insertion within it, and keeps the ones at its
+  // ends.
+  edit::Commit Second(Editor);
+  EXPECT_TRUE(Second.remove(
+      CharSourceRange::getCharRange(getLoc(FID, 4), getLoc(FID, 8))));
+  EXPECT_TRUE(Editor.commit(Second));
+
+  EXPECT_EQ("f(Ya,Xd);\n", getRewrittenSource(Editor, Source));
+}
+
+} // anonymous namespace
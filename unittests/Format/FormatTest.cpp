@@ -10967,6 +10967,49 @@ TEST(FormatStyle, GetStyleOfFile) {
   ASSERT_EQ(Style3, getGoogleStyle());
 }
 
+TEST(FormatStyle, GetCachedStyleOfFile) {
+  FormatStyleCache Cache;
+  vfs::InMemoryFileSystem FS;
+  ASSERT_TRUE(
+      FS.addFile("/a/.clang-format", 0,
+                 llvm::MemoryBuffer::getMemBuffer("BasedOnStyle: LLVM")));
+  ASSERT_TRUE(
+      FS.addFile("/a/sub/test.cpp", 0, llvm::MemoryBuffer::getMemBuffer("")));
+  ASSERT_TRUE(
+      FS.addFile("/a/sub/test.js", 0, llvm::MemoryBuffer::getMemBuffer("")));
+  EXPECT_EQ(getLLVMStyle(),
+            Cache.getStyle("file", "/a/sub/test.cpp", "Google", "", &FS));
+  EXPECT_EQ(getLLVMStyle(),
+            Cache.getStyle("file", "/a/sub/other.cpp", "Google", "", &FS));
+
+  // Files of another language get the style for their language.
+  EXPECT_EQ(FormatStyle::LK_JavaScript,
+            Cache.getStyle("file", "/a/sub/test.js", "Google", "", &FS)
+                .Language);
+
+  // A changed configuration file is read again.
+  vfs::InMemoryFileSystem ChangedFS;
+  ASSERT_TRUE(ChangedFS.addFile(
+      "/a/.clang-format", 1,
+      llvm::MemoryBuffer::getMemBuffer("BasedOnStyle: Mozilla")));
+  EXPECT_EQ(getMozillaStyle(), Cache.getStyle("file", "/a/sub/test.cpp",
+                                              "Google", "", &ChangedFS));
+
+  // The fallback style used for an invalid configuration file isn't cached.
+  vfs::InMemoryFileSystem InvalidFS;
+  ASSERT_TRUE(InvalidFS.addFile(
+      "/b/.clang-format", 0,
+      llvm::MemoryBuffer::getMemBuffer("BasedOnStyle: LLVM\nIndentWidth: x")));
+  EXPECT_EQ(getGoogleStyle(),
+            Cache.getStyle("file", "/b/test.cpp", "Google", "", &InvalidFS));
+  vfs::InMemoryFileSystem FixedFS;
+  ASSERT_TRUE(
+      FixedFS.addFile("/b/.clang-format", 1,
+                      llvm::MemoryBuffer::getMemBuffer("BasedOnStyle: LLVM")));
+  EXPECT_EQ(getLLVMStyle(),
+            Cache.getStyle("file", "/b/test.cpp", "Google", "", &FixedFS));
+}
+
 TEST_F(ReplacementTest, FormatCodeAfterReplacements) {
   // Column limit is 20.
   std::string Code = "Type *a =\n"
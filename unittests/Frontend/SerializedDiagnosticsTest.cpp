@@ -0,0 +1,87 @@
+//===- unittests/Frontend/SerializedDiagnosticsTest.cpp -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Driver/DriverDiagnostic.h"
+#include "clang/Frontend/SerializedDiagnosticPrinter.h"
+#include "clang/Frontend/SerializedDiagnosticReader.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class CountingReader : public serialized_diags::SerializedDiagnosticReader {
+public:
+  std::vector<std::string> Messages;
+  unsigned NumFlagRecords = 0;
+
+protected:
+  std::error_code visitDiagFlagRecord(unsigned ID, StringRef Name) override {
+    EXPECT_EQ("unused-command-line-argument", Name);
+    ++NumFlagRecords;
+    return std::error_code();
+  }
+
+  std::error_code
+  visitDiagnosticRecord(unsigned Severity,
+                        const serialized_diags::Location &Location,
+                        unsigned Category, unsigned Flag,
+                        StringRef Message) override {
+    EXPECT_NE(0u, Flag);
+    Messages.push_back(Message);
+    return std::error_code();
+  }
+};
+
+std::string writeDiagnostics(StringRef Argument) {
+  SmallString<128> Path;
+  EXPECT_FALSE(sys::fs::createTemporaryFile("sdiags", "dia", Path));
+  auto Consumer = serialized_diags::create(Path, new DiagnosticOptions());
+  DiagnosticsEngine Diags(new DiagnosticIDs(), new DiagnosticOptions,
+                          Consumer.get(), /*ShouldOwnClient=*/false);
+  Diags.Report(diag::warn_drv_unused_argument) << Argument;
+  Consumer->finish();
+  return Path.str();
+}
+
+TEST(SerializedDiagnosticsTest, MergesFiles) {
+  std::vector<std::string> Inputs = {writeDiagnostics("-a"),
+                                     writeDiagnostics("-b")};
+  SmallString<128> Output;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("sdiags-merged", "dia", Output));
+
+  EXPECT_FALSE(serialized_diags::mergeFiles(Inputs, Output));
+
+  CountingReader Reader;
+  EXPECT_FALSE(Reader.readDiagnostics(Output));
+  ASSERT_EQ(2u, Reader.Messages.size());
+  EXPECT_EQ("argument unused during compilation: '-a'", Reader.Messages[0]);
+  EXPECT_EQ("argument unused during compilation: '-b'", Reader.Messages[1]);
+  // The flag shared by both inputs is only written once.
+  EXPECT_EQ(1u, Reader.NumFlagRecords);
+
+  for (const std::string &Input : Inputs)
+    sys::fs::remove(Input);
+  sys::fs::remove(Output);
+}
+
+TEST(SerializedDiagnosticsTest, MergeReportsMissingInput) {
+  SmallString<128> Output;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("sdiags-merged", "dia", Output));
+  EXPECT_EQ(serialized_diags::SDError::CouldNotLoad,
+            serialized_diags::mergeFiles({"/nonexistent/input.dia"}, Output));
+  sys::fs::remove(Output);
+}
+
+} // anonymous namespace
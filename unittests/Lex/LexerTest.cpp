@@ -380,4 +380,22 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, LongRunsCrossingBlockBoundaries) {
+  // Identifiers, whitespace, comments and string literals long enough to be
+  // scanned in several blocks, with the interesting character at each offset
+  // within the final block.
+  for (unsigned Len = 1; Len != 40; ++Len) {
+    std::string Run(Len, 'x');
+    std::string Spaces(Len, ' ');
+    std::string Source = "int " + Run + "_9" + Spaces + "= // " + Run +
+                         "\n" + "\"" + Run + "\\\"" + Run + "\";";
+    std::vector<Token> Toks = CheckLex(
+        Source, {tok::kw_int, tok::identifier, tok::equal,
+                 tok::string_literal, tok::semi});
+    ASSERT_EQ(5u, Toks.size());
+    EXPECT_EQ(Len + 2, Toks[1].getLength());
+    EXPECT_EQ(2 * Len + 4, Toks[3].getLength());
+  }
+}
+
 } // anonymous namespace
@@ -48,4 +48,49 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+static std::string getText(const RewriteBuffer &Buf) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  return OS.str();
+}
+
+TEST(RewriteBuffer, RemoveLineIfEmpty) {
+  StringRef Input = "int a;\n  int b;  \nint c;\n";
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+
+  // Split the buffer into several rope pieces.
+  Buf.InsertTextAfter(Input.find("int c"), "x");
+  Buf.InsertTextAfter(Input.find("  int b"), "  ");
+
+  // Removing part of a line leaves the rest of it.
+  Buf.RemoveText(Input.find("int a"), 3, /*removeLineIfEmpty=*/true);
+  EXPECT_EQ(" a;\n    int b;  \nxint c;\n", getText(Buf));
+
+  // Removing all but blanks removes the whole line.
+  Buf.RemoveText(Input.find("int b"), 6, /*removeLineIfEmpty=*/true);
+  EXPECT_EQ(" a;\nxint c;\n", getText(Buf));
+}
+
+TEST(RewriteRope, Find) {
+  // Enough separate insertions to give the tree interior nodes.
+  RewriteRope Rope;
+  std::string Expected;
+  for (unsigned i = 0; i != 200; ++i) {
+    std::string Str = std::to_string(i) + ";";
+    Rope.insert(Expected.size() / 2, Str.data(), Str.data() + Str.size());
+    Expected.insert(Expected.size() / 2, Str);
+  }
+  ASSERT_EQ(Expected.size(), Rope.size());
+
+  for (unsigned i = 0; i != Expected.size(); ++i) {
+    RewriteRope::iterator I = Rope.find(i);
+    ASSERT_TRUE(I != Rope.end());
+    EXPECT_EQ(Expected[i], *I);
+    EXPECT_EQ(Expected[i], I.piece()[I.getPieceOffset()]);
+  }
+  EXPECT_TRUE(Rope.find(Rope.size()) == Rope.end());
+}
+
 } // anonymous namespace
@@ -10,10 +10,13 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Tooling/BinaryCompilationDatabase.h"
 #include "clang/Tooling/FileMatchTrie.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -195,6 +198,121 @@ TEST(JSONCompilationDatabase, ArgumentsPreferredOverCommand) {
    EXPECT_EQ(Arguments, FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+TEST(JSONCompilationDatabase, DecodesEscapedValues) {
+  std::string ErrorMessage;
+  CompileCommand FoundCommand = findCompileArgsInJsonDatabase(
+      "//net/dir/file",
+      "[{\"directory\":\"//net/\\u0064ir\","
+      "\"arguments\":[\"clang\", \"-DX=\\\"a, b\\\"\", 'c\\d'],"
+      "\"file\":\"file\","
+      "\"output\":\"out\\to\"}]",
+      ErrorMessage);
+  EXPECT_EQ("//net/dir", FoundCommand.Directory) << ErrorMessage;
+  EXPECT_EQ("out\to", FoundCommand.Output) << ErrorMessage;
+  ASSERT_EQ(3u, FoundCommand.CommandLine.size()) << ErrorMessage;
+  EXPECT_EQ("clang", FoundCommand.CommandLine[0]);
+  EXPECT_EQ("-DX=\"a, b\"", FoundCommand.CommandLine[1]);
+  EXPECT_EQ("c\\d", FoundCommand.CommandLine[2]);
+}
+
+TEST(BinaryCompilationDatabase, RoundTripsJSONDatabase) {
+  std::string ErrorMessage;
+  std::unique_ptr<CompilationDatabase> JSONDatabase(
+      JSONCompilationDatabase::loadFromBuffer(
+          "[{\"directory\":\"//net/dir\","
+          "\"arguments\":[\"clang\", \"-c\", \"file1\"],"
+          "\"file\":\"file1\", \"output\":\"file1.o\"},"
+          " {\"directory\":\"//net/dir\","
+          "\"arguments\":[\"clang\", \"-O2\", \"file1\"],"
+          "\"file\":\"file1\"},"
+          " {\"directory\":\"//net/other\","
+          "\"arguments\":[\"clang\", \"-c\", \"//net/dir/file2\"],"
+          "\"file\":\"//net/dir/file2\"}]",
+          ErrorMessage, JSONCommandLineSyntax::Gnu));
+  ASSERT_TRUE(JSONDatabase) << ErrorMessage;
+
+  SmallString<128> Path;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("compile_commands", "bin", Path));
+  ASSERT_FALSE(BinaryCompilationDatabase::writeToFile(*JSONDatabase, Path,
+                                                      ErrorMessage))
+      << ErrorMessage;
+  std::unique_ptr<BinaryCompilationDatabase> Database =
+      BinaryCompilationDatabase::loadFromFile(Path, ErrorMessage);
+  llvm::sys::fs::remove(Path);
+  ASSERT_TRUE(Database) << ErrorMessage;
+
+  std::vector<CompileCommand> Commands = Database->getAllCompileCommands();
+  std::vector<CompileCommand> Expected = JSONDatabase->getAllCompileCommands();
+  ASSERT_EQ(Expected.size(), Commands.size());
+  for (unsigned I = 0, E = Expected.size(); I != E; ++I) {
+    EXPECT_EQ(Expected[I].Directory, Commands[I].Directory);
+    EXPECT_EQ(Expected[I].Filename, Commands[I].Filename);
+    EXPECT_EQ(Expected[I].CommandLine, Commands[I].CommandLine);
+    EXPECT_EQ(Expected[I].Output, Commands[I].Output);
+  }
+
+  std::vector<std::string> Files = Database->getAllFiles();
+  ASSERT_EQ(2u, Files.size());
+
+  SmallString<128> File1;
+  llvm::sys::path::native("//net/dir/file1", File1);
+  Commands = Database->getCompileCommands(File1);
+  ASSERT_EQ(2u, Commands.size());
+  EXPECT_EQ("file1.o", Commands[0].Output);
+  EXPECT_EQ("-O2", Commands[1].CommandLine[1]);
+
+  Commands = Database->getCompileCommands("//net/dir/file2");
+  ASSERT_EQ(1u, Commands.size());
+  EXPECT_EQ("//net/other", Commands[0].Directory);
+  EXPECT_TRUE(Database->getCompileCommands("//net/dir/file3").empty());
+}
+
+TEST(BinaryCompilationDatabase, TakesPrecedenceOverJSONDatabase) {
+  SmallString<128> Directory;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("compile-commands", Directory));
+  SmallString<128> JSONPath(Directory), BinaryPath(Directory);
+  llvm::sys::path::append(JSONPath, "compile_commands.json");
+  llvm::sys::path::append(BinaryPath, "compile_commands.bin");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(JSONPath, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "[{\"directory\":\"//net/dir\","
+          "\"command\":\"clang -c json.cc\",\"file\":\"json.cc\"}]";
+  }
+
+  std::string ErrorMessage;
+  std::unique_ptr<CompilationDatabase> Source(
+      JSONCompilationDatabase::loadFromBuffer(
+          "[{\"directory\":\"//net/dir\","
+          "\"command\":\"clang -c binary.cc\",\"file\":\"binary.cc\"}]",
+          ErrorMessage, JSONCommandLineSyntax::Gnu));
+  ASSERT_TRUE(Source) << ErrorMessage;
+  ASSERT_FALSE(
+      BinaryCompilationDatabase::writeToFile(*Source, BinaryPath, ErrorMessage))
+      << ErrorMessage;
+
+  std::unique_ptr<CompilationDatabase> Database =
+      CompilationDatabase::loadFromDirectory(Directory, ErrorMessage);
+  ASSERT_TRUE(Database) << ErrorMessage;
+  std::vector<CompileCommand> Commands = Database->getAllCompileCommands();
+  ASSERT_EQ(1u, Commands.size());
+  EXPECT_EQ("binary.cc", llvm::sys::path::filename(Commands[0].Filename));
+
+  // Without the binary database, the JSON one is read.
+  llvm::sys::fs::remove(BinaryPath);
+  Database = CompilationDatabase::loadFromDirectory(Directory, ErrorMessage);
+  ASSERT_TRUE(Database) << ErrorMessage;
+  Commands = Database->getAllCompileCommands();
+  ASSERT_EQ(1u, Commands.size());
+  EXPECT_EQ("json.cc", llvm::sys::path::filename(Commands[0].Filename));
+
+  llvm::sys::fs::remove(JSONPath);
+  llvm::sys::fs::remove(Directory);
+}
+
 struct FakeComparator : public PathComparator {
   ~FakeComparator() override {}
   bool equivalent(StringRef FileA, StringRef FileB) const override {
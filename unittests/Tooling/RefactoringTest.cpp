@@ -28,6 +28,7 @@
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -501,6 +502,65 @@ TEST_F(ReplacementTest, FailOrderDependentReplacements) {
   EXPECT_EQ("line1\nother\nline3\nline4", Context.getRewrittenText(ID));
 }
 
+TEST(ReplacementsTest, AddAllUnsorted) {
+  Replacements Replaces;
+  auto Err = Replaces.addAll({Replacement("x.cc", 6, 2, "gh"),
+                              Replacement("x.cc", 0, 2, "ab"),
+                              Replacement("x.cc", 8, 0, "-"),
+                              Replacement("x.cc", 2, 4, "cdef"),
+                              Replacement("x.cc", 8, 0, "-")});
+  EXPECT_TRUE(!Err);
+  llvm::consumeError(std::move(Err));
+  auto Result = applyAllReplacements("01234567", Replaces);
+  EXPECT_TRUE(static_cast<bool>(Result));
+  EXPECT_EQ("abcdefgh--", *Result);
+
+  Replacements Expected;
+  for (const auto &R : {Replacement("x.cc", 0, 2, "ab"),
+                        Replacement("x.cc", 2, 4, "cdef"),
+                        Replacement("x.cc", 6, 2, "gh"),
+                        Replacement("x.cc", 8, 0, "-"),
+                        Replacement("x.cc", 8, 0, "-")})
+    llvm::consumeError(Expected.add(R));
+  EXPECT_EQ(Expected, Replaces);
+}
+
+TEST(ReplacementsTest, AddAllFailsOnConflict) {
+  Replacements Replaces;
+  Replacement First("x.cc", 2, 2, "ab");
+  Replacement Second("x.cc", 2, 2, "cd");
+  EXPECT_TRUE(checkReplacementError(Replaces.addAll({Second, First}),
+                                    replacement_error::overlap_conflict,
+                                    First, Second));
+
+  Replacement OtherFile("y.cc", 8, 0, "a");
+  EXPECT_TRUE(checkReplacementError(Replaces.addAll({OtherFile}),
+                                    replacement_error::wrong_file_path,
+                                    First, OtherFile));
+}
+
+TEST(ReplacementsTest, ApplyAllReplacementsToCode) {
+  Replacements Replaces;
+  auto Err = Replaces.addAll({Replacement("x.cc", 0, 0, "<"),
+                              Replacement("x.cc", 1, 1, ""),
+                              Replacement("x.cc", 3, 0, ">")});
+  EXPECT_TRUE(!Err);
+  llvm::consumeError(std::move(Err));
+  auto Result = applyAllReplacements("abc", Replaces);
+  EXPECT_TRUE(static_cast<bool>(Result));
+  EXPECT_EQ("<ac>", *Result);
+
+  Replacements OutOfRange(Replacement("x.cc", 2, 5, ""));
+  Result = applyAllReplacements("abc", OutOfRange);
+  EXPECT_FALSE(static_cast<bool>(Result));
+  llvm::consumeError(Result.takeError());
+
+  Replacements PastTheEnd(Replacement("x.cc", 10, 0, "x"));
+  Result = applyAllReplacements("abc", PastTheEnd);
+  EXPECT_FALSE(static_cast<bool>(Result));
+  llvm::consumeError(Result.takeError());
+}
+
 TEST_F(ReplacementTest, InvalidSourceLocationFailsApplyAll) {
   Replacements Replaces =
       toReplacements({Replacement(Context.Sources, SourceLocation(), 5, "2")});
@@ -1089,5 +1149,84 @@ TEST(DeduplicateByFileTest, NonExistingFilePath) {
   EXPECT_TRUE(FileToReplaces.empty());
 }
 
+namespace {
+/// Renames the variable declared in the main file to itself followed by "2",
+/// and the one declared in the header to the name in the main file.
+class RenameVarsConsumer : public ASTConsumer {
+  RefactoringTool &Tool;
+
+public:
+  explicit RenameVarsConsumer(RefactoringTool &Tool) : Tool(Tool) {}
+
+  void HandleTranslationUnit(ASTContext &Context) override {
+    const SourceManager &SM = Context.getSourceManager();
+    const VarDecl *MainVar = nullptr, *HeaderVar = nullptr;
+    for (const Decl *D : Context.getTranslationUnitDecl()->decls())
+      if (const auto *VD = dyn_cast<VarDecl>(D))
+        (SM.isInMainFile(VD->getLocation()) ? MainVar : HeaderVar) = VD;
+    ASSERT_TRUE(MainVar && HeaderVar);
+
+    std::string Name = MainVar->getName();
+    Replacement MainR(SM, MainVar->getLocation(), Name.size(), Name + "2");
+    Replacement HeaderR(SM, HeaderVar->getLocation(), 1, Name);
+    std::map<std::string, Replacements> &Replaces = Tool.getReplacements();
+    llvm::consumeError(Replaces[MainR.getFilePath()].add(MainR));
+    llvm::consumeError(Replaces[HeaderR.getFilePath()].add(HeaderR));
+  }
+};
+
+class RenameVarsAction : public ASTFrontendAction {
+  RefactoringTool &Tool;
+
+public:
+  explicit RenameVarsAction(RefactoringTool &Tool) : Tool(Tool) {}
+
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                 StringRef) override {
+    return llvm::make_unique<RenameVarsConsumer>(Tool);
+  }
+};
+
+class RenameVarsActionFactory : public FrontendActionFactory {
+  RefactoringTool &Tool;
+
+public:
+  explicit RenameVarsActionFactory(RefactoringTool &Tool) : Tool(Tool) {}
+
+  FrontendAction *create() override { return new RenameVarsAction(Tool); }
+};
+} // end anonymous namespace
+
+TEST(RefactoringToolTest, MergesReplacementsOfParallelRunInOrder) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  Sources.push_back("/c.cc");
+  RefactoringTool Tool(Compilations, Sources);
+  Tool.setNumThreads(3);
+  Tool.mapVirtualFile("/h.h", "int h;\n");
+  Tool.mapVirtualFile("/a.cc", "#include \"h.h\"\nint a;\n");
+  Tool.mapVirtualFile("/b.cc", "#include \"h.h\"\nint b;\n");
+  Tool.mapVirtualFile("/c.cc", "#include \"h.h\"\nint c;\n");
+
+  RenameVarsActionFactory Factory(Tool);
+  EXPECT_EQ(0, Tool.run(&Factory));
+
+  // Every translation unit renames the variable in the header, and the first
+  // one wins as it would when running on one thread.
+  std::map<std::string, std::string> Texts;
+  for (const auto &FileAndReplaces : Tool.getReplacements()) {
+    ASSERT_EQ(1u, FileAndReplaces.second.size());
+    Texts[llvm::sys::path::filename(FileAndReplaces.first)] =
+        FileAndReplaces.second.begin()->getReplacementText();
+  }
+  EXPECT_EQ(4u, Texts.size());
+  EXPECT_EQ("a", Texts["h.h"]);
+  EXPECT_EQ("a2", Texts["a.cc"]);
+  EXPECT_EQ("b2", Texts["b.cc"]);
+  EXPECT_EQ("c2", Texts["c.cc"]);
+}
+
 } // end namespace tooling
 } // end namespace clang
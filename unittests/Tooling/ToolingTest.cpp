@@ -14,13 +14,16 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Lex/HeaderSearch.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 #include <algorithm>
 #include <string>
@@ -171,6 +174,48 @@ TEST(ToolInvocation, TestMapVirtualFile) {
   EXPECT_TRUE(Invocation.run());
 }
 
+TEST(ToolInvocation, TestSharedLookupCache) {
+  auto Cache = std::make_shared<SharedLookupFileCache>();
+  auto RunWith = [&](FileManager &Files, StringRef MainFile) {
+    std::vector<std::string> Args;
+    Args.push_back("tool-executable");
+    Args.push_back("-Ifirst");
+    Args.push_back("-Isecond");
+    Args.push_back("-fsyntax-only");
+    Args.push_back(MainFile);
+    clang::tooling::ToolInvocation Invocation(Args, new SyntaxOnlyAction,
+                                              &Files);
+    Invocation.setSharedLookupCache(Cache);
+    return Invocation.run();
+  };
+  auto CreateFiles = [](ArrayRef<std::pair<StringRef, StringRef>> Contents) {
+    llvm::IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFileSystem(
+        new vfs::OverlayFileSystem(vfs::getRealFileSystem()));
+    llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
+        new vfs::InMemoryFileSystem);
+    OverlayFileSystem->pushOverlay(InMemoryFileSystem);
+    for (const auto &File : Contents)
+      InMemoryFileSystem->addFile(
+          File.first, 0, llvm::MemoryBuffer::getMemBuffer(File.second));
+    return llvm::IntrusiveRefCntPtr<FileManager>(
+        new FileManager(FileSystemOptions(), OverlayFileSystem));
+  };
+
+  llvm::IntrusiveRefCntPtr<FileManager> Files = CreateFiles(
+      {{"a.cpp", "#include <abc>\nint x = fromSecond;\n"},
+       {"b.cpp", "#include <abc>\nint y = fromSecond;\n"},
+       {"second/abc", "int fromSecond;\n"}});
+  EXPECT_TRUE(RunWith(*Files, "a.cpp"));
+  EXPECT_TRUE(RunWith(*Files, "b.cpp"));
+
+  // Lookups made with another FileManager do not use the cached results.
+  llvm::IntrusiveRefCntPtr<FileManager> OtherFiles = CreateFiles(
+      {{"c.cpp", "#include <abc>\nint z = fromFirst;\n"},
+       {"first/abc", "int fromFirst;\n"},
+       {"second/abc", "int fromSecond;\n"}});
+  EXPECT_TRUE(RunWith(*OtherFiles, "c.cpp"));
+}
+
 TEST(ToolInvocation, TestVirtualModulesCompilation) {
   // FIXME: Currently, this only tests that we don't exit with an error if a
   // mapped module.map is found on the include path. In the future, expand this
@@ -499,6 +544,99 @@ TEST(ClangToolTest, BuildASTs) {
   EXPECT_EQ(2u, ASTs.size());
 }
 
+TEST(ClangToolTest, RunInParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  Sources.push_back("/c.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.setNumThreads(2);
+
+  Tool.mapVirtualFile("/a.cc", "void a() {}");
+  Tool.mapVirtualFile("/b.cc", "void b() {}");
+  Tool.mapVirtualFile("/c.cc", "void c() {}");
+
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(0, Tool.run(Action.get()));
+
+  std::vector<std::unique_ptr<ASTUnit>> ASTs;
+  EXPECT_EQ(0, Tool.buildASTs(ASTs));
+  EXPECT_EQ(3u, ASTs.size());
+}
+
+TEST(ClangToolTest, RunInParallelReportsFailures) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.setNumThreads(2);
+
+  Tool.mapVirtualFile("/a.cc", "void a() {}");
+  Tool.mapVirtualFile("/b.cc", "int x = undeclared;");
+
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(1, Tool.run(Action.get()));
+}
+
+TEST(ClangToolTest, SharedPCH) {
+  SmallString<128> Directory;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("shared-pch", Directory));
+  SmallString<128> Header(Directory);
+  llvm::sys::path::append(Header, "shared.h");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Header, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "#ifndef SHARED_H\n#define SHARED_H\nint shared();\n#endif\n";
+  }
+
+  FixedCompilationDatabase Compilations(
+      "/", std::vector<std::string>(1, ("-I" + Directory).str()));
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.setSharedPCHDirectory(Directory);
+
+  Tool.mapVirtualFile("/a.cc", "#include <shared.h>\nint a = shared();");
+  Tool.mapVirtualFile("/b.cc", "// b\n#include <shared.h>\nint b = shared();");
+
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(0, Tool.run(Action.get()));
+
+  // A tool with the same options but other shared includes gets its own
+  // precompiled header in the same directory.
+  ClangTool OtherTool(Compilations, Sources);
+  OtherTool.setSharedPCHDirectory(Directory);
+  OtherTool.mapVirtualFile("/a.cc", "#include <shared.h>\n#include <shared.h>\n"
+                                    "int a = shared();");
+  OtherTool.mapVirtualFile("/b.cc", "#include <shared.h>\n#include <shared.h>\n"
+                                    "int b = shared();");
+  EXPECT_EQ(0, OtherTool.run(Action.get()));
+
+  std::vector<std::string> Files;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Directory, EC), E; !EC && I != E;
+       I.increment(EC))
+    Files.push_back(I->path());
+  EXPECT_EQ(2, std::count_if(Files.begin(), Files.end(), [](StringRef File) {
+              return llvm::sys::path::extension(File) == ".pch";
+            }));
+  EXPECT_EQ(0, std::count_if(Files.begin(), Files.end(), [](StringRef File) {
+              return llvm::sys::path::extension(File) == ".tmp";
+            }));
+  for (const std::string &File : Files)
+    llvm::sys::fs::remove(File);
+  llvm::sys::fs::remove(Directory);
+}
+
 struct TestDiagnosticConsumer : public DiagnosticConsumer {
   TestDiagnosticConsumer() : NumDiagnosticsSeen(0) {}
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
@@ -13,6 +13,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <map>
@@ -460,6 +461,95 @@ TEST_F(LibclangParseTest, AllSkippedRanges) {
   clang_disposeSourceRangeList(Ranges);
 }
 
+TEST_F(LibclangParseTest, clang_visitChildrenBatched) {
+  std::string Main = "main.cpp";
+  WriteFile(Main,
+    "struct S { int a; };\n"
+    "int f(S s) { return s.a; }\n");
+  ClangTU = clang_parseTranslationUnit(Index, Main.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  CXCursor TUCursor = clang_getTranslationUnitCursor(ClangTU);
+
+  // Without room for records, only the size of the subtree is computed.
+  unsigned Count = clang_visitChildrenBatched(TUCursor, nullptr, nullptr, 0,
+                                              CXCursorRecord_None);
+  ASSERT_LT(0U, Count);
+
+  std::vector<CXCursorRecord> Records(Count);
+  std::vector<CXCursor> Cursors(Count);
+  EXPECT_EQ(Count, clang_visitChildrenBatched(TUCursor, Records.data(),
+                                              Cursors.data(), Count,
+                                              CXCursorRecord_IncludeUSRs));
+
+  // The records must describe the same tree as a recursive visit.
+  auto Visit = [](CXCursor C, CXCursor Parent, CXClientData ClientData) {
+    auto &Parents = *static_cast<std::vector<CXCursor> *>(ClientData);
+    Parents.push_back(Parent);
+    return CXChildVisit_Recurse;
+  };
+  std::vector<CXCursor> Parents;
+  clang_visitChildren(TUCursor, Visit, &Parents);
+  ASSERT_EQ(Count, Parents.size());
+  for (unsigned I = 0; I != Count; ++I) {
+    EXPECT_EQ(clang_getCursorKind(Cursors[I]), Records[I].kind);
+    if (Records[I].parent == ~0U)
+      EXPECT_TRUE(clang_equalCursors(TUCursor, Parents[I]));
+    else
+      EXPECT_TRUE(clang_equalCursors(Cursors[Records[I].parent], Parents[I]));
+  }
+
+  // Declarations have USRs, expressions don't.
+  unsigned FieldDecl = ~0U, MemberRef = ~0U;
+  for (unsigned I = 0; I != Count; ++I) {
+    if (Records[I].kind == CXCursor_FieldDecl)
+      FieldDecl = I;
+    else if (Records[I].kind == CXCursor_MemberRefExpr)
+      MemberRef = I;
+  }
+  ASSERT_NE(~0U, FieldDecl);
+  ASSERT_NE(~0U, MemberRef);
+  EXPECT_EQ(FieldDecl, Records[FieldDecl].usr);
+  EXPECT_EQ(~0U, Records[MemberRef].usr);
+  EXPECT_EQ(41U, Records[MemberRef].start_offset);
+  EXPECT_EQ(44U, Records[MemberRef].end_offset);
+}
+
+TEST_F(LibclangParseTest, clang_getSemanticTokens) {
+  std::string Main = "main.cpp";
+  const char *Contents = "int x;\n"
+                         "int f() { return x; }\n";
+  WriteFile(Main, Contents);
+  ClangTU = clang_parseTranslationUnit(Index, Main.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  CXFile File = clang_getFile(ClangTU, Main.c_str());
+
+  CXSemanticToken *Tokens;
+  unsigned NumTokens =
+      clang_getSemanticTokens(ClangTU, File, 0, strlen(Contents), &Tokens);
+  ASSERT_EQ(12U, NumTokens);
+
+  // "int"
+  EXPECT_EQ(CXToken_Keyword, Tokens[0].token_kind);
+  EXPECT_EQ(0U, Tokens[0].offset);
+  EXPECT_EQ(3U, Tokens[0].length);
+  // "x" in the declaration.
+  EXPECT_EQ(CXToken_Identifier, Tokens[1].token_kind);
+  EXPECT_EQ(CXCursor_VarDecl, Tokens[1].cursor_kind);
+  EXPECT_EQ(CXCursor_VarDecl, Tokens[1].referenced_kind);
+  // "x" in the return statement.
+  EXPECT_EQ(CXToken_Identifier, Tokens[9].token_kind);
+  EXPECT_EQ(24U, Tokens[9].offset);
+  EXPECT_EQ(CXCursor_DeclRefExpr, Tokens[9].cursor_kind);
+  EXPECT_EQ(CXCursor_VarDecl, Tokens[9].referenced_kind);
+  clang_disposeSemanticTokens(Tokens);
+
+  // Only the tokens starting in the range are returned.
+  NumTokens = clang_getSemanticTokens(ClangTU, File, 7, 12, &Tokens);
+  ASSERT_EQ(2U, NumTokens);
+  EXPECT_EQ(CXCursor_FunctionDecl, Tokens[1].cursor_kind);
+  clang_disposeSemanticTokens(Tokens);
+}
+
 class LibclangReparseTest : public LibclangParseTest {
 public:
   void DisplayDiagnostics() {
@@ -572,3 +662,81 @@ TEST_F(LibclangReparseTest, clang_parseTranslationUnit2FullArgv) {
   EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
   DisplayDiagnostics();
 }
+
+TEST_F(LibclangParseTest, clang_indexSourceFiles) {
+  std::string Header = "header.h";
+  WriteFile(Header, "#ifndef HEADER_H\n#define HEADER_H\n"
+                    "int header_var;\n#endif\n");
+  std::vector<std::string> Sources;
+  for (unsigned I = 0; I != 4; ++I) {
+    std::string Source = "source" + std::to_string(I) + ".c";
+    WriteFile(Source, "#include \"header.h\"\nint source_var" +
+                          std::to_string(I) + ";\n");
+    Sources.push_back(Source);
+  }
+
+  // Each thread only sees its own client data, so no locking is needed.
+  typedef std::vector<std::string> ThreadDecls;
+  IndexerCallbacks Callbacks = {};
+  Callbacks.indexDeclaration = [](CXClientData ClientData,
+                                  const CXIdxDeclInfo *Info) {
+    static_cast<ThreadDecls *>(ClientData)->push_back(Info->entityInfo->name);
+  };
+
+  std::vector<CXIndexSourceFile> Files(Sources.size());
+  for (unsigned I = 0; I != Sources.size(); ++I)
+    Files[I].source_filename = Sources[I].c_str();
+  ThreadDecls Decls[2];
+  CXClientData ClientData[2] = {&Decls[0], &Decls[1]};
+  int Results[4] = {-1, -1, -1, -1};
+
+  CXIndexAction Action = clang_IndexAction_create(Index);
+  EXPECT_EQ(0, clang_indexSourceFiles(Action, ClientData, 2, &Callbacks,
+                                      sizeof(Callbacks), 0, Files.data(),
+                                      Files.size(), 0, Results));
+  clang_IndexAction_dispose(Action);
+
+  for (int Result : Results)
+    EXPECT_EQ(0, Result);
+  std::multiset<std::string> AllDecls(Decls[0].begin(), Decls[0].end());
+  AllDecls.insert(Decls[1].begin(), Decls[1].end());
+  EXPECT_EQ(4U, AllDecls.count("header_var"));
+  for (unsigned I = 0; I != 4; ++I)
+    EXPECT_EQ(1U, AllDecls.count("source_var" + std::to_string(I)));
+}
+
+TEST_F(LibclangReparseTest, TrimMemory) {
+  std::string Filename = "main.cpp";
+  WriteFile(Filename, "int global;\nint f() { return undeclared; }\n");
+  TUFlags |= CXTranslationUnit_CacheCompletionResults;
+  ClangTU = clang_parseTranslationUnit(Index, Filename.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ReparseTU(0, nullptr));
+  ASSERT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+
+  auto getUsage = [&](CXTUResourceUsageKind Kind) {
+    CXTUResourceUsage Usage = clang_getCXTUResourceUsage(ClangTU);
+    unsigned long Amount = 0;
+    for (unsigned I = 0; I != Usage.numEntries; ++I)
+      if (Usage.entries[I].kind == Kind)
+        Amount = Usage.entries[I].amount;
+    clang_disposeCXTUResourceUsage(Usage);
+    return Amount;
+  };
+  EXPECT_LT(0UL, getUsage(CXTUResourceUsage_GlobalCompletionResults));
+  EXPECT_LT(0UL, getUsage(CXTUResourceUsage_StoredDiagnostics));
+
+  // By default, only state that doesn't change results is dropped.
+  EXPECT_LT(0UL, clang_trimTranslationUnitMemory(ClangTU, CXTrimMemory_None));
+  EXPECT_EQ(0UL, getUsage(CXTUResourceUsage_GlobalCompletionResults));
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+
+  EXPECT_LT(0UL,
+            clang_trimTranslationUnitMemory(ClangTU, CXTrimMemory_Diagnostics));
+  EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
+
+  // Reparsing brings everything back.
+  ASSERT_TRUE(ReparseTU(0, nullptr));
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+  EXPECT_LT(0UL, getUsage(CXTUResourceUsage_GlobalCompletionResults));
+}
@@ -0,0 +1,104 @@
+#!/usr/bin/env python
+
+"""
+Script to compose the whole-program call graph from the call graphs of many
+translation units, and to find the functions which are never called.
+
+The call graphs are written by the analyzer when it is given a directory:
+
+  clang --analyze -Xclang -analyzer-config -Xclang callgraph-dir=DIR
+
+Every line of a call graph describes a function defined in the translation
+unit: its USR, its name, its location, its linkage and the USRs of the
+functions it calls. Functions defined in many translation units, e.g. inline
+functions in headers, have the callees of all of their definitions.
+"""
+
+import argparse
+import os
+import sys
+
+
+class Function(object):
+    def __init__(self, fields):
+        self.USR = fields[0]
+        self.Name = fields[1]
+        self.Location = fields[2]
+        self.External = fields[3] == 'external'
+        self.Callees = set()
+
+
+def readCallGraphs(Paths):
+    Files = []
+    for Path in Paths:
+        if os.path.isdir(Path):
+            Files.extend(os.path.join(Path, Name)
+                         for Name in sorted(os.listdir(Path))
+                         if Name.endswith('.callgraph'))
+        else:
+            Files.append(Path)
+
+    Functions = {}
+    for File in Files:
+        with open(File, 'r') as F:
+            for Line in F:
+                Fields = Line.rstrip('\n').split('\t')
+                if len(Fields) != 5:
+                    continue
+                Fn = Functions.setdefault(Fields[0], Function(Fields))
+                Fn.Callees.update(Callee for Callee in Fields[4].split(',')
+                                  if Callee)
+    return Functions
+
+
+def findReachable(Functions, Roots):
+    Reachable = set()
+    Worklist = [USR for USR in Roots if USR in Functions]
+    while Worklist:
+        USR = Worklist.pop()
+        if USR in Reachable:
+            continue
+        Reachable.add(USR)
+        Worklist.extend(Callee for Callee in Functions[USR].Callees
+                        if Callee in Functions and Callee not in Reachable)
+    return Reachable
+
+
+def main():
+    Parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    Parser.add_argument('callgraphs', nargs='+',
+                        help='call graph files, or directories of them')
+    Parser.add_argument('--root', action='append', default=[],
+                        help='name of a function called from outside of the '
+                             'program (default: main)')
+    Parser.add_argument('--external-roots', action='store_true',
+                        help='treat all externally visible functions as '
+                             'called, e.g. for libraries')
+    Parser.add_argument('--dump', action='store_true',
+                        help='print the whole-program call graph instead')
+    Args = Parser.parse_args()
+
+    Functions = readCallGraphs(Args.callgraphs)
+
+    if Args.dump:
+        for Fn in sorted(Functions.values(), key=lambda Fn: Fn.Name):
+            Names = sorted(Functions[Callee].Name for Callee in Fn.Callees
+                           if Callee in Functions)
+            print('%s: %s' % (Fn.Name, ' '.join(Names)))
+        return 0
+
+    RootNames = set(Args.root or ['main'])
+    Roots = [Fn.USR for Fn in Functions.values()
+             if Fn.Name in RootNames or (Args.external_roots and Fn.External)]
+    Reachable = findReachable(Functions, Roots)
+
+    Unreachable = [Fn for Fn in Functions.values() if Fn.USR not in Reachable]
+    Unreachable.sort(key=lambda Fn: Fn.Location)
+    for Fn in Unreachable:
+        print('%s: %s is never called' % (Fn.Location, Fn.Name))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,154 @@
+#!/usr/bin/env python
+
+"""
+Script to find code clones across the clone indexes of many translation units.
+
+The indexes are written by the clone checker when it is given a directory:
+
+  clang --analyze -Xclang -analyzer-checker=alpha.clone.CloneChecker \
+        -Xclang -analyzer-config -Xclang alpha.clone.CloneChecker:IndexDir=DIR
+
+Every line of an index describes a statement sequence: its hash code, its
+complexity, its location and the hash codes of its parts. Sequences with the
+same hash code are reported as clones. Sequences which share most of their
+parts are found with locality-sensitive hashing (MinHash with banding), and
+reported as near-miss clones, so no two sequences are ever compared unless
+they are likely to be similar.
+"""
+
+import argparse
+import os
+import sys
+from collections import defaultdict
+
+# A prime larger than any part hash code, for the MinHash permutations.
+PRIME = (1 << 89) - 1
+
+
+class Sequence(object):
+    def __init__(self, fields):
+        self.Hash = fields[0]
+        self.Complexity = int(fields[1])
+        self.Location = '%s:%s-%s' % (fields[2], fields[3], fields[4])
+        self.Parts = frozenset(int(Part, 16) for Part in fields[5].split(',')
+                               if Part)
+
+
+def readIndexes(Paths):
+    """ Read all sequences of the given index files and directories, each
+    location only once, as headers show up in many translation units. """
+    Files = []
+    for Path in Paths:
+        if os.path.isdir(Path):
+            Files.extend(os.path.join(Path, Name)
+                         for Name in sorted(os.listdir(Path))
+                         if Name.endswith('.idx'))
+        else:
+            Files.append(Path)
+
+    Sequences = {}
+    for File in Files:
+        with open(File, 'r') as F:
+            for Line in F:
+                Fields = Line.rstrip('\n').split('\t')
+                if len(Fields) != 6:
+                    continue
+                S = Sequence(Fields)
+                Sequences.setdefault(S.Location, S)
+    return list(Sequences.values())
+
+
+def findExactClones(Sequences):
+    Groups = defaultdict(list)
+    for S in Sequences:
+        Groups[S.Hash].append(S)
+    return [G for G in Groups.values() if len(G) > 1]
+
+
+def jaccard(A, B):
+    return float(len(A & B)) / len(A | B)
+
+
+def findNearMissClones(Sequences, Bands, Rows, Threshold):
+    # Permutation i maps x to (a * x + b) mod PRIME.
+    Permutations = [(2 * i + 3, 7 * i + 1) for i in range(Bands * Rows)]
+
+    Candidates = [S for S in Sequences if len(S.Parts) > 1]
+    Buckets = defaultdict(list)
+    for Index, S in enumerate(Candidates):
+        Signature = [min((A * Part + B) % PRIME for Part in S.Parts)
+                     for A, B in Permutations]
+        for Band in range(Bands):
+            Key = (Band, tuple(Signature[Band * Rows:(Band + 1) * Rows]))
+            Buckets[Key].append(Index)
+
+    # Join the similar sequences of every bucket into groups.
+    Parent = list(range(len(Candidates)))
+
+    def find(I):
+        while Parent[I] != I:
+            Parent[I] = Parent[Parent[I]]
+            I = Parent[I]
+        return I
+
+    Compared = set()
+    for Members in Buckets.values():
+        for I in range(len(Members)):
+            for J in range(I + 1, len(Members)):
+                Pair = (Members[I], Members[J])
+                if Pair in Compared:
+                    continue
+                Compared.add(Pair)
+                A, B = Candidates[Pair[0]], Candidates[Pair[1]]
+                # Sequences with the same hash code are exact clones.
+                if A.Hash == B.Hash:
+                    continue
+                if jaccard(A.Parts, B.Parts) >= Threshold:
+                    Parent[find(Pair[0])] = find(Pair[1])
+
+    Groups = defaultdict(list)
+    for Index, S in enumerate(Candidates):
+        Groups[find(Index)].append(S)
+    return [G for G in Groups.values()
+            if len(set(S.Hash for S in G)) > 1]
+
+
+def printGroups(Title, Groups):
+    Groups.sort(key=lambda G: -max(S.Complexity for S in G))
+    print('%s: %d' % (Title, len(Groups)))
+    for G in Groups:
+        print('')
+        for S in sorted(G, key=lambda S: S.Location):
+            print('  %s (complexity %d)' % (S.Location, S.Complexity))
+    print('')
+
+
+def main():
+    Parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    Parser.add_argument('indexes', nargs='+',
+                        help='index files, or directories of index files')
+    Parser.add_argument('--min-complexity', type=int, default=10,
+                        help='ignore sequences below this complexity')
+    Parser.add_argument('--near-miss', action='store_true',
+                        help='also report near-miss clones')
+    Parser.add_argument('--similarity', type=float, default=0.8,
+                        help='fraction of shared parts of near-miss clones')
+    Parser.add_argument('--bands', type=int, default=16,
+                        help='number of MinHash bands')
+    Parser.add_argument('--rows', type=int, default=4,
+                        help='number of MinHash rows per band')
+    Args = Parser.parse_args()
+
+    Sequences = [S for S in readIndexes(Args.indexes)
+                 if S.Complexity >= Args.min_complexity]
+    printGroups('Clone groups', findExactClones(Sequences))
+    if Args.near_miss:
+        printGroups('Near-miss clone groups',
+                    findNearMissClones(Sequences, Args.bands, Args.rows,
+                                       Args.similarity))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,56 @@
+/* Preprocessor metaprogramming: repetition through nested macro expansion,
+   token pasting, X-macros and function-like macros which expand to many
+   tokens. Most of the time is spent in the lexer and the preprocessor. */
+
+#define CAT(a, b) CAT_(a, b)
+#define CAT_(a, b) a##b
+#define STRINGIFY(x) STRINGIFY_(x)
+#define STRINGIFY_(x) #x
+
+#define REPEAT_2(m, n) m(n##0) m(n##1)
+#define REPEAT_4(m, n) REPEAT_2(m, n##0) REPEAT_2(m, n##1)
+#define REPEAT_8(m, n) REPEAT_4(m, n##0) REPEAT_4(m, n##1)
+#define REPEAT_16(m, n) REPEAT_8(m, n##0) REPEAT_8(m, n##1)
+#define REPEAT_32(m, n) REPEAT_16(m, n##0) REPEAT_16(m, n##1)
+#define REPEAT_64(m, n) REPEAT_32(m, n##0) REPEAT_32(m, n##1)
+#define REPEAT_128(m, n) REPEAT_64(m, n##0) REPEAT_64(m, n##1)
+#define REPEAT_256(m, n) REPEAT_128(m, n##0) REPEAT_128(m, n##1)
+#define REPEAT_512(m, n) REPEAT_256(m, n##0) REPEAT_256(m, n##1)
+#define REPEAT_1024(m, n) REPEAT_512(m, n##0) REPEAT_512(m, n##1)
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(x, lo, hi) MIN(MAX(x, lo), hi)
+#define MIX(x) CLAMP(CLAMP(x, 0, 255), CLAMP(x >> 1, 1, 127), CLAMP(x, 2, 63))
+
+#define DECLARE_GLOBAL(n) int CAT(global_, n) = MIX(sizeof(STRINGIFY(n)));
+REPEAT_1024(DECLARE_GLOBAL, b)
+
+#define DECLARE_FUNCTION(n)                                                    \
+  static int CAT(function_, n)(int x) {                                        \
+    return MIX(x) + MIX(x + 1) + MIX(x * 2) + CAT(global_, n);                 \
+  }
+REPEAT_1024(DECLARE_FUNCTION, b)
+
+#define CALL_FUNCTION(n) total += CAT(function_, n)(total);
+int macros(void) {
+  int total = 0;
+  REPEAT_1024(CALL_FUNCTION, b)
+  return total;
+}
+
+#define COLORS(X)                                                              \
+  X(Red, 0xff0000) X(Green, 0x00ff00) X(Blue, 0x0000ff) X(White, 0xffffff)     \
+  X(Black, 0x000000) X(Cyan, 0x00ffff) X(Magenta, 0xff00ff)                    \
+  X(Yellow, 0xffff00)
+
+#define COLOR_ENUM(name, value) Color##name = value,
+enum Color { COLORS(COLOR_ENUM) };
+
+#define COLOR_NAME(name, value)                                                \
+  case Color##name:                                                            \
+    return STRINGIFY(name);
+const char *colorName(enum Color c) {
+  switch (c) { COLORS(COLOR_NAME) }
+  return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+namespace geometry {
+
+template <typename T> struct Vec {
+  T X, Y, Z;
+  Vec operator+(const Vec &O) const { return {X + O.X, Y + O.Y, Z + O.Z}; }
+  Vec operator-(const Vec &O) const { return {X - O.X, Y - O.Y, Z - O.Z}; }
+  Vec operator*(T S) const { return {X * S, Y * S, Z * S}; }
+  T dot(const Vec &O) const { return X * O.X + Y * O.Y + Z * O.Z; }
+  Vec cross(const Vec &O) const {
+    return {Y * O.Z - Z * O.Y, Z * O.X - X * O.Z, X * O.Y - Y * O.X};
+  }
+};
+
+template <typename T, int N> struct Matrix {
+  T M[N][N];
+  Matrix operator*(const Matrix &O) const {
+    Matrix R = {};
+    for (int I = 0; I != N; ++I)
+      for (int J = 0; J != N; ++J)
+        for (int K = 0; K != N; ++K)
+          R.M[I][J] += M[I][K] * O.M[K][J];
+    return R;
+  }
+};
+
+typedef Vec<float> Vec3f;
+typedef Vec<double> Vec3d;
+typedef Matrix<float, 4> Mat4f;
+typedef Matrix<double, 4> Mat4d;
+
+} // namespace geometry
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "Geometry.h"
+#include "Shapes.h"
+
+namespace scene {
+
+template <typename T, int Capacity> class FixedList {
+public:
+  bool push(const T &V) {
+    if (Size == Capacity)
+      return false;
+    Items[Size++] = V;
+    return true;
+  }
+  int size() const { return Size; }
+  T &operator[](int I) { return Items[I]; }
+
+private:
+  T Items[Capacity];
+  int Size = 0;
+};
+
+struct Node {
+  shapes::Shape *Shape = nullptr;
+  geometry::Mat4f Transform = {};
+  FixedList<Node *, 8> Children;
+};
+
+class Scene {
+public:
+  Node *root() { return &Root; }
+
+  template <typename F> void walk(F Fn) { walk(&Root, Fn); }
+
+  float totalArea() {
+    float Total = 0;
+    walk([&](Node *N) {
+      if (N->Shape)
+        Total += N->Shape->area();
+    });
+    return Total;
+  }
+
+private:
+  template <typename F> static void walk(Node *N, F &Fn) {
+    Fn(N);
+    for (int I = 0; I != N->Children.size(); ++I)
+      walk(N->Children[I], Fn);
+  }
+
+  Node Root;
+};
+
+} // namespace scene
+
+#endif
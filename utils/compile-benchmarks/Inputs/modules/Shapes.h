@@ -0,0 +1,41 @@
+#ifndef SHAPES_H
+#define SHAPES_H
+
+#include "Geometry.h"
+
+namespace shapes {
+
+using geometry::Vec3f;
+
+class Shape {
+public:
+  virtual ~Shape() {}
+  virtual float area() const = 0;
+  virtual bool contains(const Vec3f &P) const = 0;
+  virtual Shape *clone() const = 0;
+};
+
+#define SHAPE(Name, AreaExpr)                                                  \
+  class Name : public Shape {                                                  \
+  public:                                                                      \
+    Vec3f Origin, Extent;                                                      \
+    float area() const override { return AreaExpr; }                           \
+    bool contains(const Vec3f &P) const override {                             \
+      Vec3f D = P - Origin;                                                    \
+      return D.dot(D) <= Extent.dot(Extent);                                   \
+    }                                                                          \
+    Shape *clone() const override { return new Name(*this); }                  \
+  };
+
+SHAPE(Sphere, 4 * 3.14159f * Extent.dot(Extent))
+SHAPE(Box, Extent.X * Extent.Y * Extent.Z)
+SHAPE(Cylinder, 3.14159f * Extent.X * Extent.X * Extent.Z)
+SHAPE(Cone, 3.14159f * Extent.X * Extent.X * Extent.Z / 3)
+SHAPE(Torus, 2 * 3.14159f * 3.14159f * Extent.X * Extent.Y * Extent.Y)
+SHAPE(Plane, Extent.cross(Origin).dot(Extent))
+
+#undef SHAPE
+
+} // namespace shapes
+
+#endif
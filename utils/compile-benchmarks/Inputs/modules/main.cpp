@@ -0,0 +1,26 @@
+// Imports the modules described by module.modulemap. The modules-build
+// benchmark builds them from an empty module cache, modules-use loads them
+// from a cache filled before the benchmark.
+
+#include "Scene.h"
+#include "Shapes.h"
+
+float render(scene::Scene &S, const geometry::Vec3f &Eye) {
+  shapes::Sphere Ball;
+  Ball.Extent = {1, 1, 1};
+  shapes::Box Crate;
+  Crate.Origin = Eye;
+  S.root()->Shape = &Ball;
+
+  scene::Node Child;
+  Child.Shape = Crate.clone();
+  S.root()->Children.push(&Child);
+
+  float Hits = 0;
+  S.walk([&](scene::Node *N) {
+    if (N->Shape && N->Shape->contains(Eye))
+      ++Hits;
+  });
+  geometry::Mat4f M = S.root()->Transform * Child.Transform;
+  return Hits + S.totalArea() + M.M[0][0];
+}
@@ -0,0 +1,107 @@
+// Objective-C classes with properties, protocols, categories, blocks and
+// many message sends, compiled with ARC. No system headers are used, so the
+// root class is declared here.
+
+typedef signed char BOOL;
+typedef unsigned long NSUInteger;
+
+__attribute__((objc_root_class))
+@interface NSObject
++ (instancetype)alloc;
+- (instancetype)init;
+- (BOOL)isEqual:(id)other;
+- (NSUInteger)hash;
+@end
+
+@protocol Drawable
+- (void)drawAtX:(int)x y:(int)y;
+@optional
+- (int)layer;
+@end
+
+@interface Item : NSObject <Drawable>
+@property (nonatomic, strong) Item *next;
+@property (nonatomic, weak) Item *parent;
+@property (nonatomic, copy) void (^action)(Item *);
+@property (nonatomic) int x, y, width, height;
+@property (atomic) int revision;
+- (instancetype)initWithX:(int)x y:(int)y;
+@end
+
+@implementation Item
+- (instancetype)initWithX:(int)x y:(int)y {
+  if ((self = [super init])) {
+    _x = x;
+    _y = y;
+  }
+  return self;
+}
+- (void)drawAtX:(int)x y:(int)y {
+  self.revision = self.revision + 1;
+  if (self.action)
+    self.action(self);
+  [self.next drawAtX:x + self.width y:y + self.height];
+}
+@end
+
+@interface Item (Geometry)
+- (int)area;
+- (BOOL)containsX:(int)x y:(int)y;
+- (Item *)unionWith:(Item *)other;
+@end
+
+@implementation Item (Geometry)
+- (int)area {
+  return self.width * self.height;
+}
+- (BOOL)containsX:(int)x y:(int)y {
+  return x >= self.x && y >= self.y && x < self.x + self.width &&
+         y < self.y + self.height;
+}
+- (Item *)unionWith:(Item *)other {
+  int x = self.x < other.x ? self.x : other.x;
+  int y = self.y < other.y ? self.y : other.y;
+  Item *result = [[Item alloc] initWithX:x y:y];
+  result.width = (self.x + self.width > other.x + other.width
+                      ? self.x + self.width
+                      : other.x + other.width) - x;
+  result.height = (self.y + self.height > other.y + other.height
+                       ? self.y + self.height
+                       : other.y + other.height) - y;
+  result.parent = self;
+  return result;
+}
+@end
+
+#define CAT(a, b) CAT_(a, b)
+#define CAT_(a, b) a##b
+#define REPEAT_2(m, n) m(n##0) m(n##1)
+#define REPEAT_4(m, n) REPEAT_2(m, n##0) REPEAT_2(m, n##1)
+#define REPEAT_8(m, n) REPEAT_4(m, n##0) REPEAT_4(m, n##1)
+#define REPEAT_16(m, n) REPEAT_8(m, n##0) REPEAT_8(m, n##1)
+#define REPEAT_32(m, n) REPEAT_16(m, n##0) REPEAT_16(m, n##1)
+#define REPEAT_64(m, n) REPEAT_32(m, n##0) REPEAT_32(m, n##1)
+#define REPEAT_128(m, n) REPEAT_64(m, n##0) REPEAT_64(m, n##1)
+#define REPEAT_256(m, n) REPEAT_128(m, n##0) REPEAT_128(m, n##1)
+
+// Many subclasses, each overriding methods and sending messages through
+// properties, which exercises method lookup and ARC code generation.
+#define DECLARE_SUBCLASS(n)                                                    \
+  @interface CAT(Item_, n) : Item                                              \
+  @property (nonatomic, strong) Item *CAT(child_, n);                          \
+  @end                                                                         \
+  @implementation CAT(Item_, n)                                                \
+  - (void)drawAtX:(int)x y:(int)y {                                            \
+    Item *child = self.CAT(child_, n);                                         \
+    if ([child containsX:x y:y])                                               \
+      self.CAT(child_, n) = [child unionWith:self];                            \
+    [super drawAtX:x y:y];                                                     \
+    self.action = ^(Item *item) {                                              \
+      item.width = child.area + self.area;                                     \
+    };                                                                         \
+  }                                                                            \
+  - (int)layer {                                                               \
+    return self.CAT(child_, n).revision;                                       \
+  }                                                                            \
+  @end
+REPEAT_256(DECLARE_SUBCLASS, b)
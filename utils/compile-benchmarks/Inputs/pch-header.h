@@ -0,0 +1,136 @@
+// A large header of the kind which is usually precompiled: class templates,
+// inline functions and many declarations which the main file only partly
+// uses. The pch-build benchmark measures writing it, pch-use reading it.
+
+typedef decltype(sizeof(0)) size_t;
+
+void *operator new(size_t, void *p) noexcept;
+
+namespace bench {
+
+template <typename T> T &&move(T &t) { return static_cast<T &&>(t); }
+
+template <typename T> class vector {
+public:
+  vector() : Begin(nullptr), End(nullptr), Capacity(nullptr) {}
+  ~vector() { clear(); }
+
+  size_t size() const { return End - Begin; }
+  bool empty() const { return Begin == End; }
+  T &operator[](size_t I) { return Begin[I]; }
+  const T &operator[](size_t I) const { return Begin[I]; }
+  T *begin() { return Begin; }
+  T *end() { return End; }
+
+  void push_back(const T &V) {
+    if (End == Capacity)
+      grow();
+    new (End++) T(V);
+  }
+  void pop_back() { (--End)->~T(); }
+  void clear() {
+    while (End != Begin)
+      pop_back();
+  }
+
+private:
+  void grow();
+  T *Begin, *End, *Capacity;
+};
+
+template <typename K, typename V> class map {
+public:
+  struct node {
+    K Key;
+    V Value;
+    node *Left, *Right;
+  };
+
+  V &operator[](const K &Key) {
+    node **N = &Root;
+    while (*N) {
+      if (Key < (*N)->Key)
+        N = &(*N)->Left;
+      else if ((*N)->Key < Key)
+        N = &(*N)->Right;
+      else
+        return (*N)->Value;
+    }
+    *N = allocate(Key);
+    return (*N)->Value;
+  }
+
+  template <typename F> void for_each(F Fn) { visit(Root, Fn); }
+
+private:
+  template <typename F> static void visit(node *N, F &Fn) {
+    if (!N)
+      return;
+    visit(N->Left, Fn);
+    Fn(N->Key, N->Value);
+    visit(N->Right, Fn);
+  }
+  node *allocate(const K &Key);
+  node *Root = nullptr;
+};
+
+class string {
+public:
+  string() : Data(nullptr), Length(0) {}
+  string(const char *S) : Data(S), Length(0) {
+    while (S[Length])
+      ++Length;
+  }
+  size_t size() const { return Length; }
+  char operator[](size_t I) const { return Data[I]; }
+  bool operator<(const string &O) const {
+    for (size_t I = 0; I != Length && I != O.Length; ++I)
+      if (Data[I] != O.Data[I])
+        return Data[I] < O.Data[I];
+    return Length < O.Length;
+  }
+
+private:
+  const char *Data;
+  size_t Length;
+};
+
+} // namespace bench
+
+#define PCH_CAT(a, b) PCH_CAT_(a, b)
+#define PCH_CAT_(a, b) a##b
+#define PCH_REPEAT_2(m, n) m(n##0) m(n##1)
+#define PCH_REPEAT_4(m, n) PCH_REPEAT_2(m, n##0) PCH_REPEAT_2(m, n##1)
+#define PCH_REPEAT_8(m, n) PCH_REPEAT_4(m, n##0) PCH_REPEAT_4(m, n##1)
+#define PCH_REPEAT_16(m, n) PCH_REPEAT_8(m, n##0) PCH_REPEAT_8(m, n##1)
+#define PCH_REPEAT_32(m, n) PCH_REPEAT_16(m, n##0) PCH_REPEAT_16(m, n##1)
+#define PCH_REPEAT_64(m, n) PCH_REPEAT_32(m, n##0) PCH_REPEAT_32(m, n##1)
+#define PCH_REPEAT_128(m, n) PCH_REPEAT_64(m, n##0) PCH_REPEAT_64(m, n##1)
+#define PCH_REPEAT_256(m, n) PCH_REPEAT_128(m, n##0) PCH_REPEAT_128(m, n##1)
+#define PCH_REPEAT_512(m, n) PCH_REPEAT_256(m, n##0) PCH_REPEAT_256(m, n##1)
+
+// Many classes with virtual functions and inline members, of which the main
+// file only uses a few.
+#define PCH_DECLARE_CLASS(n)                                                   \
+  namespace bench {                                                            \
+  class PCH_CAT(Widget_, n) {                                                  \
+  public:                                                                      \
+    virtual ~PCH_CAT(Widget_, n)();                                            \
+    virtual int draw(int X, int Y) const;                                      \
+    int width() const { return Width; }                                        \
+    int height() const { return Height; }                                      \
+    void resize(int W, int H) {                                                \
+      Width = W;                                                               \
+      Height = H;                                                              \
+    }                                                                          \
+    vector<string> &labels() { return Labels; }                                \
+    map<string, int> &properties() { return Properties; }                      \
+                                                                               \
+  private:                                                                     \
+    int Width = 0, Height = 0;                                                 \
+    vector<string> Labels;                                                     \
+    map<string, int> Properties;                                               \
+  };                                                                           \
+  int PCH_CAT(widgetFunction_, n)(PCH_CAT(Widget_, n) & W, int Scale);         \
+  }
+PCH_REPEAT_512(PCH_DECLARE_CLASS, b)
@@ -0,0 +1,20 @@
+// Uses a small part of pch-header.h, which is included through a PCH.
+
+namespace bench {
+
+int useWidgets(Widget_b000000000 &A, Widget_b111111111 &B,
+               Widget_b010101010 &C) {
+  A.resize(10, 20);
+  B.resize(A.width(), A.height());
+  C.labels().push_back("label");
+  C.properties()["answer"] = 42;
+
+  int Total = 0;
+  C.properties().for_each(
+      [&](const string &Key, int Value) { Total += Key.size() + Value; });
+  for (string &S : C.labels())
+    Total += S.size();
+  return Total + A.draw(1, 2) + B.draw(3, 4);
+}
+
+} // namespace bench
@@ -0,0 +1,108 @@
+// Template metaprogramming: type lists, a recursive tuple, compile-time
+// integer sequences and overload resolution through SFINAE. Most of the time
+// is spent instantiating class and function templates.
+
+typedef decltype(sizeof(0)) size_t;
+
+template <typename T, T V> struct integral_constant {
+  static constexpr T value = V;
+};
+typedef integral_constant<bool, true> true_type;
+typedef integral_constant<bool, false> false_type;
+
+template <bool B, typename T = void> struct enable_if {};
+template <typename T> struct enable_if<true, T> { typedef T type; };
+
+template <typename T, typename U> struct is_same : false_type {};
+template <typename T> struct is_same<T, T> : true_type {};
+
+template <typename T> T &&declval();
+
+template <size_t... Is> struct index_sequence {};
+template <size_t N, size_t... Is>
+struct make_index_sequence_impl
+    : make_index_sequence_impl<N - 1, N - 1, Is...> {};
+template <size_t... Is> struct make_index_sequence_impl<0, Is...> {
+  typedef index_sequence<Is...> type;
+};
+template <size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+template <typename... Ts> struct type_list {};
+
+template <typename List, typename T> struct push_back;
+template <typename... Ts, typename T> struct push_back<type_list<Ts...>, T> {
+  typedef type_list<Ts..., T> type;
+};
+
+template <size_t I> struct tag {
+  static constexpr size_t value = I;
+};
+
+template <size_t N, typename List = type_list<>> struct make_tags
+    : make_tags<N - 1, typename push_back<List, tag<N - 1>>::type> {};
+template <typename List> struct make_tags<0, List> { typedef List type; };
+
+template <size_t I, typename T> struct tuple_leaf {
+  T value;
+  T &get() { return value; }
+};
+
+template <typename Seq, typename... Ts> struct tuple_impl;
+template <size_t... Is, typename... Ts>
+struct tuple_impl<index_sequence<Is...>, Ts...> : tuple_leaf<Is, Ts>... {};
+
+template <typename... Ts>
+struct tuple : tuple_impl<make_index_sequence<sizeof...(Ts)>, Ts...> {};
+
+template <size_t I, typename T> T &get(tuple_leaf<I, T> &leaf) {
+  return leaf.get();
+}
+
+template <typename... Ts> struct tuple_from_list;
+template <typename... Ts> struct tuple_from_list<type_list<Ts...>> {
+  typedef tuple<Ts...> type;
+};
+
+// Overload resolution between many candidates, each of which needs a
+// substitution to be ruled out.
+template <typename T>
+auto describe(T t) -> typename enable_if<T::value % 3 == 0, int>::type {
+  return 3;
+}
+template <typename T>
+auto describe(T t) -> typename enable_if<T::value % 3 == 1, int>::type {
+  return 1;
+}
+template <typename T>
+auto describe(T t) -> typename enable_if<T::value % 3 == 2, int>::type {
+  return 2;
+}
+
+template <typename T> constexpr T fib(T n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+template <typename... Ts, size_t... Is>
+int sum_tags(tuple<Ts...> &t, index_sequence<Is...>) {
+  int total = 0;
+  int expand[] = {0, (total += describe(get<Is>(t)) + (int)Ts::value, 0)...};
+  (void)expand;
+  return total;
+}
+
+template <size_t N> int run() {
+  typedef typename tuple_from_list<typename make_tags<N>::type>::type Tuple;
+  Tuple t;
+  static_assert(fib<size_t>(N % 20) >= 0, "");
+  return sum_tags(t, make_index_sequence<N>());
+}
+
+template <size_t... Ns> int run_all(index_sequence<Ns...>) {
+  int total = 0;
+  int expand[] = {0, (total += run<Ns + 1>(), 0)...};
+  (void)expand;
+  return total;
+}
+
+int templates() { return run_all(make_index_sequence<200>()); }
@@ -0,0 +1,296 @@
+#!/usr/bin/env python
+#===- run-benchmarks.py - Clang compile-time benchmarks ------*- python -*--===#
+#
+#                     The LLVM Compiler Infrastructure
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE.TXT for details.
+#
+#===------------------------------------------------------------------------===#
+
+"""Compiles the benchmark inputs and reports, for each of them, the time spent
+in each phase of the compiler, its peak resident set size and the amount of
+memory allocated for the AST."""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import time
+
+# The -ftime-trace totals shown in the table. Every other total is only
+# written to the JSON results.
+PHASES = [
+  ('Frontend', ['Frontend']),
+  ('Inst', ['InstantiateClass', 'InstantiateFunction']),
+  ('ReadAST', ['ReadAST']),
+  ('CodeGen', ['EmitGlobal']),
+  ('Backend', ['Backend']),
+]
+
+# The statistics printed by -print-stats which are collected, and the key
+# they are reported under. A module build prints them once per AST context,
+# so all of the occurrences are added up.
+STATS = [
+  ('ast_bytes_used', re.compile(r'^Bytes used: (\d+)$')),
+  ('ast_bytes_allocated', re.compile(r'^Bytes allocated: (\d+)$')),
+  ('ast_memory_regions', re.compile(r'^Number of memory regions: (\d+)$')),
+  ('decls', re.compile(r'^\s*(\d+) decls total\.$')),
+  ('stmts', re.compile(r'^\s*(\d+) stmts/exprs total\.$')),
+  ('types', re.compile(r'^\s*(\d+) types total\.$')),
+]
+
+LINUX = ['-target', 'x86_64-unknown-linux-gnu']
+DARWIN = ['-target', 'x86_64-apple-macosx10.12']
+
+def generateLargeFunction(path, statements):
+  """Writes a C file with one function which has the given number of
+  statements, split between a switch and straight-line arithmetic."""
+  with open(path, 'w') as f:
+    f.write('int generated(int x, int *p) {\n  int a = x, b = 1, c = 2;\n')
+    f.write('  switch (x) {\n')
+    for i in range(statements // 2):
+      f.write('  case %d: a = a * %d + b; b ^= a >> %d; p[%d] = b; break;\n' %
+              (i, i % 17 + 3, i % 7 + 1, i % 64))
+    f.write('  }\n')
+    for i in range(statements // 2):
+      f.write('  c = (c + p[%d]) * %d - (a ^ %d);\n' %
+              (i % 64, i % 13 + 1, i))
+    f.write('  return a + b + c;\n}\n')
+
+class Benchmark(object):
+  def __init__(self, name, args, setup=None, before_each=None):
+    self.name = name
+    # The driver arguments; '{inputs}' and '{work}' are replaced by the input
+    # and the working directory.
+    self.args = args
+    # Untimed driver invocations run once before the benchmark.
+    self.setup = setup or []
+    # A function of the working directory called before every run.
+    self.before_each = before_each
+
+def clearModuleCache(work):
+  path = os.path.join(work, 'modules-cold')
+  if os.path.isdir(path):
+    shutil.rmtree(path)
+
+PCH_ARGS = ['-x', 'c++-header', '-std=c++14', '{inputs}/pch-header.h',
+            '-o', '{work}/pch-header.pch']
+MODULE_ARGS = ['-std=c++14', '-fmodules', '-fimplicit-module-maps',
+               '-I', '{inputs}/modules', '-c', '{inputs}/modules/main.cpp']
+
+BENCHMARKS = [
+  Benchmark('templates',
+            LINUX + ['-std=c++14', '-c', '{inputs}/templates.cpp',
+                     '-o', '{work}/templates.o']),
+  Benchmark('macros',
+            LINUX + ['-c', '{inputs}/macros.c', '-o', '{work}/macros.o']),
+  Benchmark('pch-build', LINUX + PCH_ARGS),
+  Benchmark('pch-use',
+            LINUX + ['-std=c++14', '-include-pch', '{work}/pch-header.pch',
+                     '-c', '{inputs}/pch-main.cpp', '-o', '{work}/pch-main.o'],
+            setup=[LINUX + PCH_ARGS]),
+  Benchmark('modules-build',
+            LINUX + MODULE_ARGS +
+            ['-fmodules-cache-path={work}/modules-cold',
+             '-o', '{work}/modules-build.o'],
+            before_each=clearModuleCache),
+  Benchmark('modules-use',
+            LINUX + MODULE_ARGS +
+            ['-fmodules-cache-path={work}/modules-warm',
+             '-o', '{work}/modules-use.o'],
+            setup=[LINUX + MODULE_ARGS +
+                   ['-fmodules-cache-path={work}/modules-warm',
+                    '-o', '{work}/modules-use.o']]),
+  Benchmark('objc',
+            DARWIN + ['-fobjc-arc', '-c', '{inputs}/objc.m',
+                      '-o', '{work}/objc.o']),
+  Benchmark('generated-O0',
+            LINUX + ['-O0', '-c', '{work}/generated.c',
+                     '-o', '{work}/generated-O0.o']),
+  Benchmark('generated-O2',
+            LINUX + ['-O2', '-c', '{work}/generated.c',
+                     '-o', '{work}/generated-O2.o']),
+]
+
+def expand(args, inputs, work):
+  return [a.replace('{inputs}', inputs).replace('{work}', work) for a in args]
+
+def getCC1Command(clang, args):
+  """Returns the -cc1 command line the driver would run for the arguments,
+  so that the frontend can be measured without the driver process."""
+  output = subprocess.check_output([clang, '-###'] + args,
+                                   stderr=subprocess.STDOUT)
+  if not isinstance(output, str):
+    output = output.decode('utf-8')
+  commands = [line for line in output.splitlines() if '"-cc1"' in line]
+  if len(commands) != 1:
+    raise RuntimeError('expected a single -cc1 job for: %s' % ' '.join(args))
+  return shlex.split(commands[0])
+
+def runOnce(command, log):
+  """Runs the command and returns its wall time in seconds and its rusage."""
+  with open(log, 'w') as stderr:
+    start = time.time()
+    process = subprocess.Popen(command, stdout=stderr, stderr=stderr)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.time() - start
+    # The process was reaped by wait4; don't let Popen wait for it again.
+    process.returncode = status
+  if status != 0:
+    with open(log) as f:
+      sys.stderr.write(f.read())
+    raise RuntimeError('command failed: %s' % ' '.join(command))
+  return elapsed, usage
+
+def readTotals(trace):
+  with open(trace) as f:
+    events = json.load(f)['traceEvents']
+  totals = {}
+  for event in events:
+    name = event.get('name', '')
+    if name.startswith('Total '):
+      totals[name[len('Total '):]] = event['dur'] / 1000.0
+  return totals
+
+def readStats(log):
+  stats = dict((key, 0) for key, _ in STATS)
+  with open(log) as f:
+    for line in f:
+      line = line.rstrip('\n')
+      for key, regex in STATS:
+        match = regex.match(line)
+        if match:
+          stats[key] += int(match.group(1))
+  return stats
+
+def maxRSSInKB(usage):
+  # ru_maxrss is in bytes on Darwin and in kilobytes everywhere else.
+  if sys.platform == 'darwin':
+    return usage.ru_maxrss // 1024
+  return usage.ru_maxrss
+
+def runBenchmark(benchmark, clang, inputs, work, repeat):
+  for setup in benchmark.setup:
+    subprocess.check_call([clang] + expand(setup, inputs, work))
+
+  trace = os.path.join(work, benchmark.name + '.json')
+  log = os.path.join(work, benchmark.name + '.log')
+  args = expand(benchmark.args, inputs, work)
+  command = getCC1Command(clang, args + ['-ftime-trace=' + trace,
+                                         '-Xclang', '-print-stats'])
+  best = None
+  for _ in range(repeat):
+    if benchmark.before_each:
+      benchmark.before_each(work)
+    elapsed, usage = runOnce(command, log)
+    result = {
+      'wall_ms': elapsed * 1000.0,
+      'user_ms': usage.ru_utime * 1000.0,
+      'sys_ms': usage.ru_stime * 1000.0,
+      'max_rss_kb': maxRSSInKB(usage),
+      'phases_ms': readTotals(trace),
+    }
+    result.update(readStats(log))
+    # Report the fastest run; it is the one least disturbed by the machine.
+    if best is None or result['wall_ms'] < best['wall_ms']:
+      best = result
+  return best
+
+def phaseTime(result, names):
+  return sum(result['phases_ms'].get(name, 0.0) for name in names)
+
+def printTable(results):
+  header = '%-14s %9s' % ('Benchmark', 'Wall (ms)')
+  for label, _ in PHASES:
+    header += ' %9s' % label
+  header += ' %10s %10s %9s' % ('RSS (MB)', 'AST (KB)', 'Nodes')
+  print(header)
+  print('-' * len(header))
+  for name, result in results:
+    line = '%-14s %9.1f' % (name, result['wall_ms'])
+    for _, names in PHASES:
+      line += ' %9.1f' % phaseTime(result, names)
+    line += ' %10.1f %10.1f %9d' % (
+        result['max_rss_kb'] / 1024.0, result['ast_bytes_used'] / 1024.0,
+        result['decls'] + result['stmts'] + result['types'])
+    print(line)
+
+def compare(before_path, after_path):
+  with open(before_path) as f:
+    before = json.load(f)['benchmarks']
+  with open(after_path) as f:
+    after = json.load(f)['benchmarks']
+  keys = [('wall_ms', 'Wall'), ('max_rss_kb', 'RSS'),
+          ('ast_bytes_used', 'AST')]
+  header = '%-14s' % 'Benchmark'
+  for _, label in keys:
+    header += ' %9s' % label
+  print(header)
+  print('-' * len(header))
+  for name in sorted(before):
+    if name not in after:
+      continue
+    line = '%-14s' % name
+    for key, _ in keys:
+      old, new = before[name][key], after[name][key]
+      line += ' %+8.1f%%' % ((new - old) * 100.0 / old if old else 0.0)
+    print(line)
+  return 0
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('--clang', help='the clang binary to benchmark')
+  parser.add_argument('--repeat', type=int, default=5,
+                      help='number of runs of each benchmark')
+  parser.add_argument('--work-dir', default='compile-benchmarks',
+                      help='directory for the outputs of the compiler')
+  parser.add_argument('--filter', default='',
+                      help='only run the benchmarks matching this regex')
+  parser.add_argument('--json', help='write the results to this file')
+  parser.add_argument('--generated-statements', type=int, default=20000,
+                      help='number of statements in the generated function')
+  parser.add_argument('--compare', nargs=2, metavar=('BEFORE', 'AFTER'),
+                      help='compare two JSON result files and exit')
+  parser.add_argument('inputs', nargs='?',
+                      default=os.path.join(os.path.dirname(__file__),
+                                           'Inputs'),
+                      help='directory containing the benchmark inputs')
+  args = parser.parse_args()
+
+  if args.compare:
+    return compare(*args.compare)
+  if not args.clang:
+    parser.error('--clang is required')
+
+  inputs = os.path.abspath(args.inputs)
+  work = os.path.abspath(args.work_dir)
+  if not os.path.isdir(work):
+    os.makedirs(work)
+  generateLargeFunction(os.path.join(work, 'generated.c'),
+                        args.generated_statements)
+
+  results = []
+  for benchmark in BENCHMARKS:
+    if not re.search(args.filter, benchmark.name):
+      continue
+    print('Running %s...' % benchmark.name, file=sys.stderr)
+    results.append((benchmark.name,
+                    runBenchmark(benchmark, args.clang, inputs, work,
+                                 max(args.repeat, 1))))
+
+  printTable(results)
+  if args.json:
+    with open(args.json, 'w') as f:
+      json.dump({'clang': args.clang, 'repeat': args.repeat,
+                 'benchmarks': dict(results)}, f, indent=2, sort_keys=True)
+  return 0
+
+if __name__ == '__main__':
+  sys.exit(main())